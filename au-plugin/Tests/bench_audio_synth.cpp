@@ -0,0 +1,153 @@
+/**
+ * @file bench_audio_synth.cpp
+ * @brief Scalar renderer benchmark: legacy per-sample loop vs. prepare/render
+ *
+ * Reports ns/sample for one 4-mode voice at 44.1/48/96 kHz, rendering one
+ * control interval per call (as the engine does). The "legacy" column is
+ * the original audio_synth_render() loop that recomputed cabsf/cargf and
+ * the phase increment for every sample, with the original range-reduced
+ * Taylor fast_sin().
+ *
+ * Configure with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include "../src/esp32_port/modal_node.h"
+#include "../src/esp32_port/audio_synth.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/**
+ * @brief Original fast_sin(): normalization loops + 5th-order Taylor
+ */
+static float legacyFastSin(float x) {
+    while (x > M_PI) x -= 2.0f * M_PI;
+    while (x < -M_PI) x += 2.0f * M_PI;
+
+    float x2 = x * x;
+    float x3 = x * x2;
+    float x5 = x3 * x2;
+
+    return x - (x3 / 6.0f) + (x5 / 120.0f);
+}
+
+/**
+ * @brief Original audio_synth_render() inner loop (reference "before")
+ */
+static void legacyRender(audio_synth_t* synth, float* outL, float* outR, uint32_t num_frames) {
+    const modal_node_t* node = synth->node;
+    const float sample_rate = synth->params.sample_rate;
+
+    for (uint32_t sample_idx = 0; sample_idx < num_frames; sample_idx++) {
+        float sample_sum = 0.0f;
+
+        for (int k = 0; k < MAX_MODES; k++) {
+            if (!node->modes[k].params.active) continue;
+
+            const float* a = reinterpret_cast<const float*>(&node->modes[k].a);
+            float amplitude_raw = sqrtf(a[0] * a[0] + a[1] * a[1]);
+            amplitude_raw *= node->modes[k].params.weight;
+
+            synth->amplitude_smooth[k] +=
+                SMOOTH_ALPHA * (amplitude_raw - synth->amplitude_smooth[k]);
+
+            float amplitude = synth->amplitude_smooth[k] *
+                              synth->params.mode_gains[k] *
+                              synth->params.master_gain *
+                              MAX_AMPLITUDE_SCALE;
+            if (amplitude > MAX_AMPLITUDE_SCALE) amplitude = MAX_AMPLITUDE_SCALE;
+
+            float omega = node->modes[k].params.omega;
+            float freq_hz = omega / (2.0f * M_PI);
+            float phase_inc = 2.0f * M_PI * freq_hz / sample_rate;
+
+            uint32_t phase_acc = synth->params.phase_accumulator[k];
+            float phase = (phase_acc / 4294967296.0f) * 2.0f * M_PI;
+            phase += atan2f(a[1], a[0]);
+
+            sample_sum += amplitude * legacyFastSin(phase);
+
+            phase_acc += (uint32_t)(phase_inc * 4294967296.0f / (2.0f * M_PI));
+            synth->params.phase_accumulator[k] = phase_acc;
+        }
+
+        outL[sample_idx] = sample_sum;
+        outR[sample_idx] = sample_sum;
+    }
+}
+
+typedef void (*RenderFn)(audio_synth_t*, float*, float*, uint32_t);
+
+/**
+ * @brief Time a renderer, return ns per output sample
+ */
+static double benchmark(RenderFn render, float sample_rate, double seconds) {
+    modal_node_t node;
+    modal_node_init(&node, 0, PERSONALITY_SELF_OSCILLATOR);
+    float base_omega = freq_to_omega(220.0f);
+    modal_node_set_mode(&node, 0, base_omega * 1.0f, 0.5f, 1.0f);
+    modal_node_set_mode(&node, 1, base_omega * 1.01f, 0.6f, 0.7f);
+    modal_node_set_mode(&node, 2, base_omega * 2.0f, 0.8f, 0.5f);
+    modal_node_set_mode(&node, 3, base_omega * 3.0f, 1.0f, 0.3f);
+    modal_node_start(&node);
+
+    audio_synth_t synth;
+    audio_synth_init(&synth, &node, sample_rate);
+
+    const uint32_t block = static_cast<uint32_t>(sample_rate / CONTROL_RATE_HZ);
+    const uint32_t num_blocks = static_cast<uint32_t>(seconds * CONTROL_RATE_HZ);
+    float* outL = new float[block];
+    float* outR = new float[block];
+    volatile float sink = 0.0f;
+
+    // Reach steady oscillation before timing
+    for (int i = 0; i < 2000; i++) modal_node_step(&node);
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t b = 0; b < num_blocks; b++) {
+        render(&synth, outL, outR, block);
+        sink = sink + outL[block - 1];
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    delete[] outL;
+    delete[] outR;
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    return ns / (static_cast<double>(num_blocks) * block);
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Modal Attractors - audio_synth Benchmark" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "One voice, 4 modes, one control interval per call" << std::endl;
+    std::cout << std::endl;
+
+    const float sample_rates[] = {44100.0f, 48000.0f, 96000.0f};
+    const double seconds = 20.0;  // Audio seconds rendered per measurement
+
+    std::cout << std::setw(12) << "Rate (Hz)"
+              << std::setw(16) << "legacy ns/smp"
+              << std::setw(16) << "prepared ns/smp"
+              << std::setw(10) << "speedup" << std::endl;
+
+    for (float sample_rate : sample_rates) {
+        double before = benchmark(legacyRender, sample_rate, seconds);
+        double after = benchmark(audio_synth_render, sample_rate, seconds);
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(12) << sample_rate
+                  << std::setw(16) << before
+                  << std::setw(16) << after
+                  << std::setw(9) << before / after << "x" << std::endl;
+    }
+
+    return 0;
+}
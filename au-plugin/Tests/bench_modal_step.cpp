@@ -0,0 +1,140 @@
+/**
+ * @file bench_modal_step.cpp
+ * @brief Control-rate step benchmark: per-node cexpf() vs. modal_bank_step()
+ *        vs. the specialized step kernels
+ *
+ * Reports ns per control tick for 16 and 64 voices of each personality.
+ * The "legacy" column is the original modal_node_step() loop, which
+ * evaluated cexpf(λ·dt) and a C complex multiply for every mode on every
+ * step; "bank" steps all voices with one modal_bank_step() call;
+ * "kernel" uses the 4-mode kernel from modal_step_kernel_select().
+ *
+ * Configure with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <vector>
+#include "../src/esp32_port/modal_node.h"
+#include "../src/dsp_core/ModalKernels.h"
+
+/**
+ * @brief Original modal_node_step() (reference "before", no excitation)
+ */
+static void legacyStep(modal_node_t* node) {
+    if (!node->running) return;
+
+    for (int k = 0; k < MAX_MODES; k++) {
+        if (!node->modes[k].params.active) continue;
+
+        mode_state_t* mode = &node->modes[k];
+        std::complex<float>* a = reinterpret_cast<std::complex<float>*>(&mode->a);
+        float omega = mode->params.omega;
+        float gamma = mode->params.gamma;
+
+        float effective_gamma = gamma;
+        if (node->personality == PERSONALITY_SELF_OSCILLATOR) {
+            float energy = std::abs(*a);
+            effective_gamma = -gamma + 3.0f * gamma * (energy * energy);
+        }
+
+        std::complex<float> lambda(-effective_gamma, omega);
+        std::complex<float>* a_dot = reinterpret_cast<std::complex<float>*>(&mode->a_dot);
+        *a_dot = lambda * *a;
+        *a = *a * std::exp(lambda * CONTROL_DT);
+    }
+
+    node->step_count++;
+}
+
+static void setupNodes(std::vector<modal_node_t>& nodes, node_personality_t personality) {
+    for (size_t i = 0; i < nodes.size(); i++) {
+        modal_node_t* node = &nodes[i];
+        modal_node_init(node, static_cast<uint8_t>(i), personality);
+        float omega = freq_to_omega(110.0f + 7.0f * i);
+        modal_node_set_mode(node, 0, omega * 1.0f, 0.5f, 1.0f);
+        modal_node_set_mode(node, 1, omega * 1.01f, 0.6f, 0.7f);
+        modal_node_set_mode(node, 2, omega * 2.0f, 0.8f, 0.5f);
+        modal_node_set_mode(node, 3, omega * 3.0f, 1.0f, 0.3f);
+        modal_node_start(node);
+    }
+}
+
+/**
+ * @brief Time one control tick over all voices, return ns per tick
+ */
+enum class StepPath {
+    Legacy,
+    Bank,
+    Kernel
+};
+
+static double benchmark(StepPath path, node_personality_t personality, uint32_t num_voices,
+                        uint32_t num_ticks) {
+    std::vector<modal_node_t> nodes(num_voices);
+    std::vector<modal_node_t*> pointers(num_voices);
+    setupNodes(nodes, personality);
+    for (uint32_t i = 0; i < num_voices; i++) pointers[i] = &nodes[i];
+
+    modal_step_kernel_t kernel = modal_step_kernel_select(MAX_MODES, personality);
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t t = 0; t < num_ticks; t++) {
+        if (path == StepPath::Kernel) {
+            kernel(pointers.data(), num_voices);
+        } else if (path == StepPath::Bank) {
+            modal_bank_step(pointers.data(), num_voices);
+        } else {
+            for (uint32_t i = 0; i < num_voices; i++) legacyStep(pointers[i]);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    // Keep the state observable
+    volatile float sink = modal_node_get_amplitude(&nodes[0]);
+    (void)sink;
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / num_ticks;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Modal Attractors - Modal Step Benchmark" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "One control tick, 4 modes per voice" << std::endl;
+    std::cout << std::endl;
+
+    const uint32_t voice_counts[] = {16, 64};
+    const node_personality_t personalities[] = {PERSONALITY_RESONATOR, PERSONALITY_SELF_OSCILLATOR};
+    const uint32_t num_ticks = 50000;
+
+    std::cout << std::setw(18) << "Personality"
+              << std::setw(8) << "Voices"
+              << std::setw(16) << "legacy ns/tick"
+              << std::setw(14) << "bank ns/tick"
+              << std::setw(16) << "kernel ns/tick"
+              << std::setw(10) << "speedup" << std::endl;
+
+    for (node_personality_t personality : personalities) {
+        for (uint32_t num_voices : voice_counts) {
+            double before = benchmark(StepPath::Legacy, personality, num_voices, num_ticks);
+            double bank = benchmark(StepPath::Bank, personality, num_voices, num_ticks);
+            double after = benchmark(StepPath::Kernel, personality, num_voices, num_ticks);
+
+            std::cout << std::fixed << std::setprecision(0)
+                      << std::setw(18)
+                      << (personality == PERSONALITY_RESONATOR ? "resonator" : "self-oscillator")
+                      << std::setw(8) << num_voices
+                      << std::setw(16) << before
+                      << std::setw(14) << bank
+                      << std::setw(16) << after
+                      << std::setprecision(2)
+                      << std::setw(9) << before / after << "x" << std::endl;
+        }
+    }
+
+    return 0;
+}
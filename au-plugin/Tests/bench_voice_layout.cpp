@@ -0,0 +1,211 @@
+/**
+ * @file bench_voice_layout.cpp
+ * @brief Voice memory layout benchmark: scattered heap voices vs. arena
+ *
+ * Runs the per-tick voice loop (updateModal + render constants) over 32
+ * and 64 voices laid out either as individually new'ed objects scattered
+ * between other allocations (the old VoiceAllocator layout) or in one
+ * contiguous arena. Caches are flushed between ticks, as a host that runs
+ * other plugins between our callbacks would. Reports ns per tick and, on
+ * Linux where perf events are available, cache misses per tick.
+ *
+ * Configure with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+#include "../src/dsp_core/ModalVoice.h"
+#include "../src/dsp_core/SimdTypes.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Hardware cache-miss counter (no-op where unavailable)
+ */
+class CacheMissCounter {
+public:
+    CacheMissCounter() : fd_(-1) {
+#ifdef __linux__
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~CacheMissCounter() {
+#ifdef __linux__
+        if (fd_ >= 0) close(fd_);
+#endif
+    }
+
+    bool available() const { return fd_ >= 0; }
+
+    void start() {
+#ifdef __linux__
+        if (fd_ >= 0) ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    void stop() {
+#ifdef __linux__
+        if (fd_ >= 0) ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+    }
+
+    uint64_t read() const {
+        uint64_t count = 0;
+#ifdef __linux__
+        if (fd_ >= 0 && ::read(fd_, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+        return count;
+    }
+
+private:
+    int fd_;
+};
+
+struct LayoutResult {
+    double ns_per_tick;
+    double misses_per_tick;
+};
+
+/**
+ * @brief Time the per-tick voice loop over a voice pointer table
+ */
+static LayoutResult runTicks(ModalVoice** voices, uint32_t num_voices, uint32_t num_ticks) {
+    // Larger than last-level cache on typical desktop parts
+    const size_t flush_size = 32 * 1024 * 1024;
+    std::vector<unsigned char> flush(flush_size, 1);
+    volatile unsigned sink = 0;
+
+    CacheMissCounter counter;
+    double total_ns = 0.0;
+
+    for (uint32_t t = 0; t < num_ticks; t++) {
+        for (size_t i = 0; i < flush_size; i += 64) flush[i]++;
+
+        counter.start();
+        auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t v = 0; v < num_voices; v++) {
+            voices[v]->updateModal();
+            audio_synth_block_t block;
+            audio_synth_prepare(voices[v]->getSynth(), &block);
+            sink = sink + block.num_modes;
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        counter.stop();
+        total_ns += std::chrono::duration<double, std::nano>(end - start).count();
+    }
+
+    LayoutResult result;
+    result.ns_per_tick = total_ns / num_ticks;
+    result.misses_per_tick = counter.available()
+        ? static_cast<double>(counter.read()) / num_ticks : -1.0;
+    return result;
+}
+
+static void startVoices(ModalVoice** voices, uint32_t num_voices) {
+    for (uint32_t v = 0; v < num_voices; v++) {
+        voices[v]->initialize(48000.0f);
+        voices[v]->setPersonality(PERSONALITY_SELF_OSCILLATOR);
+        voices[v]->noteOn(static_cast<uint8_t>(36 + v), 0.8f);
+    }
+}
+
+/**
+ * @brief Old layout: one new per voice, interleaved with unrelated allocations
+ */
+static LayoutResult benchScattered(uint32_t num_voices, uint32_t num_ticks) {
+    srand(1);
+    ModalVoice** voices = new ModalVoice*[num_voices];
+    std::vector<char*> clutter;
+    for (uint32_t v = 0; v < num_voices; v++) {
+        voices[v] = new ModalVoice(static_cast<uint8_t>(v));
+        clutter.push_back(new char[1024 + (rand() % 8) * 512]);
+    }
+    startVoices(voices, num_voices);
+
+    LayoutResult result = runTicks(voices, num_voices, num_ticks);
+
+    for (uint32_t v = 0; v < num_voices; v++) delete voices[v];
+    for (char* c : clutter) delete[] c;
+    delete[] voices;
+    return result;
+}
+
+/**
+ * @brief VoiceAllocator layout: placement new into one aligned arena
+ */
+static LayoutResult benchArena(uint32_t num_voices, uint32_t num_ticks) {
+    srand(1);
+    size_t stride = (sizeof(ModalVoice) + SIMD_ALIGNMENT - 1) / SIMD_ALIGNMENT * SIMD_ALIGNMENT;
+    unsigned char* arena = new (std::align_val_t(SIMD_ALIGNMENT)) unsigned char[stride * num_voices];
+
+    ModalVoice** voices = new ModalVoice*[num_voices];
+    for (uint32_t v = 0; v < num_voices; v++) {
+        voices[v] = new (arena + v * stride) ModalVoice(static_cast<uint8_t>(v));
+    }
+    startVoices(voices, num_voices);
+
+    LayoutResult result = runTicks(voices, num_voices, num_ticks);
+
+    for (uint32_t v = 0; v < num_voices; v++) voices[v]->~ModalVoice();
+    ::operator delete[](arena, std::align_val_t(SIMD_ALIGNMENT));
+    delete[] voices;
+    return result;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Modal Attractors - Voice Layout Benchmark" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "Per-tick voice loop, cold cache, sizeof(ModalVoice) = "
+              << sizeof(ModalVoice) << " bytes" << std::endl;
+    std::cout << std::endl;
+
+    const uint32_t voice_counts[] = {32, 64};
+    const uint32_t num_ticks = 200;
+
+    std::cout << std::setw(8) << "Voices"
+              << std::setw(18) << "scattered ns/tick"
+              << std::setw(14) << "arena ns/tick"
+              << std::setw(18) << "scattered misses"
+              << std::setw(14) << "arena misses" << std::endl;
+
+    for (uint32_t num_voices : voice_counts) {
+        LayoutResult scattered = benchScattered(num_voices, num_ticks);
+        LayoutResult arena = benchArena(num_voices, num_ticks);
+
+        std::cout << std::fixed << std::setprecision(0)
+                  << std::setw(8) << num_voices
+                  << std::setw(18) << scattered.ns_per_tick
+                  << std::setw(14) << arena.ns_per_tick;
+        if (scattered.misses_per_tick >= 0.0 && arena.misses_per_tick >= 0.0) {
+            std::cout << std::setw(18) << scattered.misses_per_tick
+                      << std::setw(14) << arena.misses_per_tick;
+        } else {
+            std::cout << std::setw(18) << "n/a" << std::setw(14) << "n/a";
+        }
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
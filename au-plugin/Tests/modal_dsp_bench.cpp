@@ -0,0 +1,512 @@
+/**
+ * @file modal_dsp_bench.cpp
+ * @brief Regression benchmark suite for the DSP core
+ *
+ * Micro benchmarks (modal_node_step, modal_bank_step over decayed tails,
+ * audio_synth_render, VoiceAllocator render at 1/8/16/64 voices and with
+ * per-mode buses,
+ * TopologyEngine::updateCoupling for every topology at 16/64 voices) and macro benchmarks
+ * (full engine render at 32–2048 frame blocks, at half and double
+ * internal render rate, and a released-notes decay tail). The tail cases start in the range where, without the amplitude
+ * floor and FTZ/DAZ, every operation would hit a denormal. Each case auto-scales its iteration count to a minimum run
+ * time, repeats, and reports the median; all state is seeded, so runs
+ * are comparable across commits.
+ *
+ * Usage: modal_dsp_bench [--json] [--filter <substring>] [--min-time <s>]
+ *                        [--repetitions <n>]
+ *
+ * --json writes Google Benchmark style JSON ({"context", "benchmarks"})
+ * to stdout, so existing comparison tooling can diff two runs.
+ *
+ * Configure with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+ *
+ * -ffast-math executables start with FTZ/DAZ set (crtfastmath), which a
+ * plugin inside a host does not get; main() clears them so the decay
+ * tail cases see the host's floating-point environment.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include "../src/esp32_port/modal_node.h"
+#include "../src/esp32_port/audio_synth.h"
+#include "../src/dsp_core/VoiceAllocator.h"
+#include "../src/dsp_core/TopologyEngine.h"
+#include "../src/dsp_core/SimdTypes.h"
+#include "../src/au_wrapper/ModalAttractorsAU.h"
+#include "../src/au_wrapper/ModalParameters.h"
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#endif
+
+#ifndef MODAL_BENCH_BUILD_TYPE
+#define MODAL_BENCH_BUILD_TYPE "unknown"
+#endif
+
+#define BENCH_SAMPLE_RATE 48000.0f
+#define BENCH_SEED 1234u
+
+/**
+ * @brief Runner options (from the command line)
+ */
+struct BenchOptions {
+    bool json = false;
+    std::string filter;
+    double min_time = 0.2;      ///< Seconds per repetition
+    uint32_t repetitions = 5;
+};
+
+/**
+ * @brief One benchmark result (median over repetitions)
+ */
+struct BenchResult {
+    std::string name;
+    uint64_t iterations;
+    double real_ns;             ///< Wall time per iteration
+    double cpu_ns;              ///< Process CPU time per iteration
+    double items_per_second;    ///< Samples (or steps) per second, 0 if n/a
+};
+
+/**
+ * @brief Benchmark case: body runs `iterations` times, items counted per iteration
+ */
+struct BenchCase {
+    std::string name;
+    uint64_t items_per_iteration;
+    std::function<void(uint64_t iterations)> run;
+};
+
+static double medianOf(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+static BenchResult runCase(const BenchCase& bench, const BenchOptions& options) {
+    // Scale iterations until one run takes at least min_time
+    uint64_t iterations = 1;
+    for (;;) {
+        auto start = std::chrono::steady_clock::now();
+        bench.run(iterations);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (seconds >= options.min_time || iterations >= (1ull << 40)) break;
+
+        double scale = seconds > 0.0 ? options.min_time * 1.4 / seconds : 10.0;
+        iterations = static_cast<uint64_t>(iterations * std::min(std::max(scale, 1.5), 10.0)) + 1;
+    }
+
+    std::vector<double> real_ns;
+    std::vector<double> cpu_ns;
+    for (uint32_t r = 0; r < options.repetitions; r++) {
+        std::clock_t cpu_start = std::clock();
+        auto start = std::chrono::steady_clock::now();
+        bench.run(iterations);
+        auto end = std::chrono::steady_clock::now();
+        std::clock_t cpu_end = std::clock();
+
+        real_ns.push_back(std::chrono::duration<double, std::nano>(end - start).count() / iterations);
+        cpu_ns.push_back((cpu_end - cpu_start) * 1e9 / CLOCKS_PER_SEC / iterations);
+    }
+
+    BenchResult result;
+    result.name = bench.name;
+    result.iterations = iterations;
+    result.real_ns = medianOf(real_ns);
+    result.cpu_ns = medianOf(cpu_ns);
+    result.items_per_second = bench.items_per_iteration
+        ? bench.items_per_iteration * 1e9 / result.real_ns : 0.0;
+    return result;
+}
+
+// ============================================================================
+// Fixtures
+// ============================================================================
+
+static volatile float g_sink = 0.0f;    // Keeps results observable
+
+static void setupNode(modal_node_t* node, uint8_t id, node_personality_t personality) {
+    modal_node_init(node, id, personality);
+    modal_node_seed(node, BENCH_SEED);
+    float omega = freq_to_omega(110.0f + 7.0f * id);
+    modal_node_set_mode(node, 0, omega * 1.0f, 0.5f, 1.0f);
+    modal_node_set_mode(node, 1, omega * 1.01f, 0.6f, 0.7f);
+    modal_node_set_mode(node, 2, omega * 2.0f, 0.8f, 0.5f);
+    modal_node_set_mode(node, 3, omega * 3.0f, 1.0f, 0.3f);
+    modal_node_start(node);
+}
+
+/**
+ * @brief Allocator with num_voices sounding self-oscillators
+ */
+static VoiceAllocator* makeAllocator(uint32_t num_voices, uint32_t block_size) {
+    VoiceAllocator* allocator = new VoiceAllocator(num_voices);
+    allocator->initialize(BENCH_SAMPLE_RATE, block_size);
+    allocator->setSeed(BENCH_SEED);
+    allocator->setPersonality(PERSONALITY_SELF_OSCILLATOR);
+    for (uint32_t v = 0; v < num_voices; v++) {
+        allocator->noteOn(static_cast<uint8_t>(24 + v), 100);
+    }
+    for (int i = 0; i < 100; i++) allocator->updateVoices();
+    return allocator;
+}
+
+static const char* topologyName(TopologyType type) {
+    switch (type) {
+        case TopologyType::Ring: return "ring";
+        case TopologyType::SmallWorld: return "small_world";
+        case TopologyType::Clustered: return "clustered";
+        case TopologyType::HubSpoke: return "hub_spoke";
+        case TopologyType::Random: return "random";
+        case TopologyType::Complete: return "complete";
+        case TopologyType::None: return "none";
+    }
+    return "unknown";
+}
+
+// ============================================================================
+// Benchmarks
+// ============================================================================
+
+static void addNodeStep(std::vector<BenchCase>& cases, node_personality_t personality, const char* name) {
+    cases.push_back({std::string("modal_node_step/") + name, 1, [personality](uint64_t iterations) {
+        modal_node_t node;
+        setupNode(&node, 1, personality);
+        for (uint64_t i = 0; i < iterations; i++) modal_node_step(&node);
+        g_sink = g_sink + modal_node_get_amplitude(&node);
+    }});
+}
+
+static void addBankStepDecayTail(std::vector<BenchCase>& cases, uint32_t num_nodes) {
+    cases.push_back({"modal_bank_step/decay_tail/" + std::to_string(num_nodes), num_nodes,
+                     [num_nodes](uint64_t iterations) {
+        // Slowly decaying resonators already just above FLT_MIN
+        std::vector<modal_node_t> nodes(num_nodes);
+        std::vector<modal_node_t*> ptrs(num_nodes);
+        for (uint32_t i = 0; i < num_nodes; i++) {
+            setupNode(&nodes[i], static_cast<uint8_t>(i), PERSONALITY_RESONATOR);
+            for (int k = 0; k < MAX_MODES; k++) {
+                modal_node_set_mode(&nodes[i], k, nodes[i].modes[k].params.omega, 0.05f,
+                                    nodes[i].modes[k].params.weight);
+                nodes[i].modes[k].a = 1e-37f * (1 + k);
+            }
+            ptrs[i] = &nodes[i];
+        }
+        for (uint64_t i = 0; i < iterations; i++) modal_bank_step(ptrs.data(), num_nodes);
+        g_sink = g_sink + modal_node_get_amplitude(&nodes[0]);
+    }});
+}
+
+static void addSynthRender(std::vector<BenchCase>& cases) {
+    const uint32_t frames = static_cast<uint32_t>(BENCH_SAMPLE_RATE / CONTROL_RATE_HZ);
+    cases.push_back({"audio_synth_render/96", frames, [frames](uint64_t iterations) {
+        modal_node_t node;
+        setupNode(&node, 1, PERSONALITY_SELF_OSCILLATOR);
+        for (int i = 0; i < 1000; i++) modal_node_step(&node);
+
+        audio_synth_t synth;
+        audio_synth_init(&synth, &node, BENCH_SAMPLE_RATE);
+        std::vector<float> outL(frames), outR(frames);
+        for (uint64_t i = 0; i < iterations; i++) {
+            audio_synth_render(&synth, outL.data(), outR.data(), frames);
+        }
+        g_sink = g_sink + outL[frames - 1];
+    }});
+}
+
+static void addAllocatorRender(std::vector<BenchCase>& cases, uint32_t num_voices) {
+    const uint32_t frames = static_cast<uint32_t>(BENCH_SAMPLE_RATE / CONTROL_RATE_HZ);
+    cases.push_back({"voice_allocator_render/" + std::to_string(num_voices), frames,
+                     [num_voices, frames](uint64_t iterations) {
+        VoiceAllocator* allocator = makeAllocator(num_voices, frames);
+        float* outL = vbuffer_alloc(frames);
+        float* outR = vbuffer_alloc(frames);
+        for (uint64_t i = 0; i < iterations; i++) {
+            allocator->renderAudio(outL, outR, frames);
+        }
+        g_sink = g_sink + outL[frames - 1];
+        vbuffer_free(outL);
+        vbuffer_free(outR);
+        delete allocator;
+    }});
+}
+
+static void addAllocatorModeBuses(std::vector<BenchCase>& cases, uint32_t num_voices) {
+    const uint32_t frames = static_cast<uint32_t>(BENCH_SAMPLE_RATE / CONTROL_RATE_HZ);
+    cases.push_back({"voice_allocator_render/" + std::to_string(num_voices) + "/mode_buses", frames,
+                     [num_voices, frames](uint64_t iterations) {
+        VoiceAllocator* allocator = makeAllocator(num_voices, frames);
+        float* outL = vbuffer_alloc(frames);
+        float* outR = vbuffer_alloc(frames);
+        float* mode_out[MAX_MODES];
+        for (int k = 0; k < MAX_MODES; k++) mode_out[k] = vbuffer_alloc(frames);
+        for (uint64_t i = 0; i < iterations; i++) {
+            allocator->renderAudio(outL, outR, frames, mode_out, MAX_MODES);
+        }
+        g_sink = g_sink + outL[frames - 1] + mode_out[MAX_MODES - 1][frames - 1];
+        for (int k = 0; k < MAX_MODES; k++) vbuffer_free(mode_out[k]);
+        vbuffer_free(outL);
+        vbuffer_free(outR);
+        delete allocator;
+    }});
+}
+
+static void addPitchBend(std::vector<BenchCase>& cases, uint32_t num_voices) {
+    cases.push_back({"voice_allocator_pitch_bend/" + std::to_string(num_voices), num_voices,
+                     [num_voices](uint64_t iterations) {
+        VoiceAllocator* allocator = makeAllocator(num_voices, 256);
+        for (uint64_t i = 0; i < iterations; i++) {
+            allocator->setPitchBend(static_cast<float>(i & 255) / 128.0f - 1.0f);
+        }
+        g_sink = g_sink + allocator->getVoice(0)->getBaseOmega();
+        delete allocator;
+    }});
+}
+
+static void addCoupling(std::vector<BenchCase>& cases, TopologyType type, uint32_t num_voices) {
+    cases.push_back({std::string("topology_update_coupling/") + topologyName(type) + "/" +
+                     std::to_string(num_voices), 0, [type, num_voices](uint64_t iterations) {
+        VoiceAllocator* allocator = makeAllocator(num_voices, 96);
+        TopologyEngine topology(num_voices);
+        topology.setSeed(BENCH_SEED);
+        topology.generateTopology(type, 0.3f);
+        for (uint64_t i = 0; i < iterations; i++) {
+            topology.updateCoupling(allocator->getVoices(), num_voices,
+                                    allocator->getActiveVoices(), allocator->getActiveVoiceCount());
+        }
+        g_sink = g_sink + allocator->getVoice(0)->getAmplitude();
+        delete allocator;
+    }});
+}
+
+static void addEngineRender(std::vector<BenchCase>& cases, uint32_t block_size, uint32_t num_notes,
+                            int render_rate = kRenderRate_Host) {
+    const char* rate_name = render_rate == kRenderRate_Half ? "rate_half/"
+                          : render_rate == kRenderRate_Double ? "rate_double/" : "";
+    cases.push_back({"engine_render/" + std::string(rate_name) + std::to_string(block_size) + "/" +
+                     std::to_string(num_notes) + "_notes",
+                     block_size, [block_size, num_notes, render_rate](uint64_t iterations) {
+        ModalAttractorsEngine engine;
+        modal_attractors_engine_init(&engine, BENCH_SAMPLE_RATE, 32, render_rate);
+        modal_attractors_engine_set_seed(&engine, BENCH_SEED);
+        modal_attractors_engine_set_parameter(&engine, kParam_Personality, 1.0f);
+        for (uint32_t n = 0; n < num_notes; n++) {
+            modal_attractors_engine_note_on(&engine, static_cast<uint8_t>(36 + n), 100);
+        }
+
+        std::vector<float> outL(block_size), outR(block_size);
+        for (uint64_t i = 0; i < iterations; i++) {
+            modal_attractors_engine_render(&engine, outL.data(), outR.data(), block_size);
+        }
+        g_sink = g_sink + outL[block_size - 1];
+        modal_attractors_engine_cleanup(&engine);
+    }});
+}
+
+static void addEngineAutomation(std::vector<BenchCase>& cases, uint32_t block_size, uint32_t num_notes) {
+    cases.push_back({"engine_render/automation/" + std::to_string(block_size), block_size,
+                     [block_size, num_notes](uint64_t iterations) {
+        ModalAttractorsEngine engine;
+        modal_attractors_engine_init(&engine, BENCH_SAMPLE_RATE, 32);
+        modal_attractors_engine_set_seed(&engine, BENCH_SEED);
+        modal_attractors_engine_set_parameter(&engine, kParam_Personality, 1.0f);
+        for (uint32_t n = 0; n < num_notes; n++) {
+            modal_attractors_engine_note_on(&engine, static_cast<uint8_t>(36 + n), 100);
+        }
+
+        // Every mode parameter automated, 8 points per block each
+        const uint32_t points = 8;
+        std::vector<float> outL(block_size), outR(block_size);
+        for (uint64_t i = 0; i < iterations; i++) {
+            for (uint32_t p = 0; p < points; p++) {
+                float t = static_cast<float>((i * points + p) & 1023) / 1024.0f;
+                uint32_t offset = p * block_size / points;
+                for (uint32_t k = 0; k < MAX_MODES; k++) {
+                    uint32_t base = kParam_Mode0_Frequency + 3 * k;
+                    modal_attractors_engine_set_parameter(&engine, base, (k + 1) * (1.0f + 0.01f * t), offset);
+                    modal_attractors_engine_set_parameter(&engine, base + 1, 0.5f + 0.2f * t, offset);
+                    modal_attractors_engine_set_parameter(&engine, base + 2, 1.0f - 0.5f * t, offset);
+                }
+            }
+            modal_attractors_engine_render(&engine, outL.data(), outR.data(), block_size);
+        }
+        g_sink = g_sink + outL[block_size - 1];
+        modal_attractors_engine_cleanup(&engine);
+    }});
+}
+
+static void addEngineDecayTail(std::vector<BenchCase>& cases, uint32_t block_size, uint32_t num_notes) {
+    cases.push_back({"engine_render/decay_tail/" + std::to_string(block_size), block_size,
+                     [block_size, num_notes](uint64_t iterations) {
+        ModalAttractorsEngine engine;
+        modal_attractors_engine_init(&engine, BENCH_SAMPLE_RATE, 32);
+        modal_attractors_engine_set_seed(&engine, BENCH_SEED);
+        for (uint32_t n = 0; n < num_notes; n++) {
+            modal_attractors_engine_note_on(&engine, static_cast<uint8_t>(36 + n), 100);
+        }
+
+        // Half a second sounding, then released: the measured blocks are the tail
+        std::vector<float> outL(block_size), outR(block_size);
+        const uint32_t attack_blocks = static_cast<uint32_t>(0.5f * BENCH_SAMPLE_RATE / block_size);
+        for (uint32_t i = 0; i < attack_blocks; i++) {
+            modal_attractors_engine_render(&engine, outL.data(), outR.data(), block_size);
+        }
+        for (uint32_t n = 0; n < num_notes; n++) {
+            modal_attractors_engine_note_off(&engine, static_cast<uint8_t>(36 + n));
+        }
+
+        for (uint64_t i = 0; i < iterations; i++) {
+            modal_attractors_engine_render(&engine, outL.data(), outR.data(), block_size);
+        }
+        g_sink = g_sink + outL[block_size - 1];
+        modal_attractors_engine_cleanup(&engine);
+    }});
+}
+
+static std::vector<BenchCase> allCases() {
+    std::vector<BenchCase> cases;
+
+    addNodeStep(cases, PERSONALITY_RESONATOR, "resonator");
+    addNodeStep(cases, PERSONALITY_SELF_OSCILLATOR, "self_oscillator");
+    addBankStepDecayTail(cases, 64);
+    addSynthRender(cases);
+
+    const uint32_t voice_counts[] = {1, 8, 16, 64};
+    for (uint32_t num_voices : voice_counts) addAllocatorRender(cases, num_voices);
+    addAllocatorModeBuses(cases, 64);
+    addPitchBend(cases, 64);
+
+    const TopologyType topologies[] = {
+        TopologyType::Ring, TopologyType::SmallWorld, TopologyType::Clustered,
+        TopologyType::HubSpoke, TopologyType::Random, TopologyType::Complete,
+        TopologyType::None
+    };
+    for (TopologyType type : topologies) addCoupling(cases, type, 16);
+    for (TopologyType type : topologies) addCoupling(cases, type, 64);
+
+    const uint32_t block_sizes[] = {32, 64, 128, 256, 512, 1024, 2048};
+    for (uint32_t block_size : block_sizes) addEngineRender(cases, block_size, 16);
+    addEngineRender(cases, 256, 16, kRenderRate_Half);
+    addEngineRender(cases, 256, 16, kRenderRate_Double);
+    addEngineDecayTail(cases, 256, 16);
+    addEngineAutomation(cases, 256, 16);
+
+    return cases;
+}
+
+// ============================================================================
+// Output
+// ============================================================================
+
+static void printTableHeader() {
+    std::cout << std::left << std::setw(44) << "Benchmark" << std::right
+              << std::setw(14) << "Time (ns)"
+              << std::setw(14) << "CPU (ns)"
+              << std::setw(14) << "Iterations"
+              << std::setw(16) << "Items/s" << std::endl;
+    std::cout << std::string(102, '-') << std::endl;
+}
+
+static void printTableRow(const BenchResult& r) {
+    std::cout << std::left << std::setw(44) << r.name << std::right
+              << std::fixed << std::setprecision(1)
+              << std::setw(14) << r.real_ns
+              << std::setw(14) << r.cpu_ns
+              << std::setw(14) << r.iterations;
+    if (r.items_per_second > 0.0) {
+        std::cout << std::setw(16) << std::setprecision(3) << std::scientific << r.items_per_second;
+    }
+    std::cout << std::defaultfloat << std::endl;
+}
+
+static void printJson(const std::vector<BenchResult>& results, const BenchOptions& options) {
+    char date[64];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+
+    std::cout << "{\n  \"context\": {\n"
+              << "    \"date\": \"" << date << "\",\n"
+              << "    \"library_build_type\": \"" << MODAL_BENCH_BUILD_TYPE << "\",\n"
+              << "    \"simd_width\": " << SIMD_WIDTH << ",\n"
+#ifdef MODAL_ENGINE_STATS
+              << "    \"engine_stats\": true,\n"
+#else
+              << "    \"engine_stats\": false,\n"
+#endif
+              << "    \"sample_rate\": " << BENCH_SAMPLE_RATE << ",\n"
+              << "    \"repetitions\": " << options.repetitions << "\n"
+              << "  },\n  \"benchmarks\": [\n";
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        std::cout << "    {\"name\": \"" << r.name << "\", "
+                  << "\"iterations\": " << r.iterations << ", "
+                  << std::setprecision(6) << std::fixed
+                  << "\"real_time\": " << r.real_ns << ", "
+                  << "\"cpu_time\": " << r.cpu_ns << ", "
+                  << "\"time_unit\": \"ns\"";
+        if (r.items_per_second > 0.0) {
+            std::cout << ", \"items_per_second\": " << std::setprecision(1) << r.items_per_second;
+        }
+        std::cout << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    std::cout << "  ]\n}" << std::endl;
+}
+
+static bool parseOptions(int argc, char* argv[], BenchOptions* options) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) {
+            options->json = true;
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            options->filter = argv[++i];
+        } else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            options->min_time = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            options->repetitions = std::max(1, atoi(argv[++i]));
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--json] [--filter <substring>] [--min-time <s>] [--repetitions <n>]"
+                      << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, &options)) return EXIT_FAILURE;
+
+#if defined(__SSE__) || defined(_M_X64)
+    _mm_setcsr(_mm_getcsr() & ~0x8040u);   // Gradual underflow, as in a host process
+#endif
+
+    if (!options.json) {
+        std::cout << "========================================" << std::endl;
+        std::cout << "Modal Attractors - DSP Benchmark Suite" << std::endl;
+        std::cout << "========================================" << std::endl;
+        std::cout << "Build: " << MODAL_BENCH_BUILD_TYPE << ", median of "
+                  << options.repetitions << " repetitions" << std::endl;
+        std::cout << std::endl;
+        printTableHeader();
+    }
+
+    std::vector<BenchResult> results;
+    for (const BenchCase& bench : allCases()) {
+        if (!options.filter.empty() && bench.name.find(options.filter) == std::string::npos) continue;
+
+        BenchResult result = runCase(bench, options);
+        results.push_back(result);
+        if (!options.json) printTableRow(result);
+    }
+
+    if (options.json) printJson(results, options);
+    return EXIT_SUCCESS;
+}
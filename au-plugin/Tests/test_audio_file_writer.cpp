@@ -0,0 +1,155 @@
+/**
+ * @file test_audio_file_writer.cpp
+ * @brief Tests for the streaming AudioFileWriter
+ *
+ * Writes a known ramp in every sample format, on the caller's thread and
+ * with the background writer, in odd-sized blocks that straddle chunk
+ * boundaries, then reads the file back and checks the patched header
+ * and every sample.
+ */
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include "../src/offline/AudioFileWriter.h"
+
+static int g_failures = 0;
+
+static void check(bool condition, const char* description) {
+    if (condition) {
+        std::cout << "  ✓ " << description << std::endl;
+    } else {
+        std::cout << "  ✗ FAILED: " << description << std::endl;
+        g_failures++;
+    }
+}
+
+static uint32_t get16(const std::vector<uint8_t>& d, size_t pos) {
+    return d[pos] | d[pos + 1] << 8;
+}
+
+static uint32_t get32(const std::vector<uint8_t>& d, size_t pos) {
+    return d[pos] | d[pos + 1] << 8 | d[pos + 2] << 16 | static_cast<uint32_t>(d[pos + 3]) << 24;
+}
+
+/**
+ * @brief Test signal: ramp across [-1.2, 1.2] (exercises clipping), per-channel offset
+ */
+static float testSample(uint32_t channel, uint32_t frame, uint32_t num_frames) {
+    return -1.2f + 2.4f * frame / (num_frames - 1) - 0.1f * channel;
+}
+
+/**
+ * @brief Find a RIFF sub-chunk, return offset of its payload (0 if missing)
+ */
+static size_t findChunk(const std::vector<uint8_t>& d, const char* id, uint32_t* size) {
+    size_t pos = 12;
+    while (pos + 8 <= d.size()) {
+        uint32_t chunk_size = get32(d, pos + 4);
+        if (memcmp(&d[pos], id, 4) == 0) {
+            *size = chunk_size;
+            return pos + 8;
+        }
+        pos += 8 + chunk_size + (chunk_size & 1);
+    }
+    return 0;
+}
+
+static void testFormat(AudioSampleFormat format, uint32_t num_channels, bool background, const char* label) {
+    std::cout << label << std::endl;
+
+    const char* path = "test_audio_file_writer.wav";
+    const uint32_t num_frames = 1001;   // Odd, not a multiple of the chunk or block size
+    const uint32_t chunk_frames = 128;
+    const uint32_t block = 37;
+
+    std::vector<std::vector<float>> signal(num_channels, std::vector<float>(num_frames));
+    for (uint32_t c = 0; c < num_channels; c++) {
+        for (uint32_t i = 0; i < num_frames; i++) signal[c][i] = testSample(c, i, num_frames);
+    }
+
+    AudioFileWriter writer;
+    bool ok = writer.open(path, 44100, num_channels, format, background, chunk_frames);
+    for (uint32_t pos = 0; pos < num_frames && ok; pos += block) {
+        const float* channels[AUDIO_WRITER_MAX_CHANNELS];
+        for (uint32_t c = 0; c < num_channels; c++) channels[c] = signal[c].data() + pos;
+        ok = writer.write(channels, std::min(block, num_frames - pos));
+    }
+    check(ok && writer.getFramesWritten() == num_frames, "all blocks accepted");
+    check(writer.close() && !writer.isOpen(), "close succeeds");
+
+    std::ifstream file(path, std::ios::binary);
+    std::vector<uint8_t> d((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    remove(path);
+
+    const uint32_t bytes = format == AudioSampleFormat::PCM16 ? 2 : format == AudioSampleFormat::PCM24 ? 3 : 4;
+    const uint32_t data_bytes = num_frames * num_channels * bytes;
+    uint32_t fmt_size = 0, data_size = 0, fact_size = 0;
+    size_t fmt = d.size() >= 12 ? findChunk(d, "fmt ", &fmt_size) : 0;
+    size_t data = d.size() >= 12 ? findChunk(d, "data", &data_size) : 0;
+    size_t fact = d.size() >= 12 ? findChunk(d, "fact", &fact_size) : 0;
+
+    check(d.size() >= 12 && memcmp(&d[0], "RIFF", 4) == 0 && get32(d, 4) == d.size() - 8,
+          "RIFF size patched to file length");
+    check(fmt && get16(d, fmt) == (format == AudioSampleFormat::Float32 ? 3u : 1u) &&
+          get16(d, fmt + 2) == num_channels && get32(d, fmt + 4) == 44100 &&
+          get16(d, fmt + 12) == num_channels * bytes && get16(d, fmt + 14) == bytes * 8,
+          "fmt chunk describes the format");
+    check(data && data_size == data_bytes, "data size patched");
+    if (format == AudioSampleFormat::Float32) {
+        check(fact && get32(d, fact) == num_frames, "fact chunk holds the frame count");
+    }
+    if (!data || data + data_bytes > d.size()) {
+        check(false, "samples present");
+        return;
+    }
+
+    bool samples_ok = true;
+    for (uint32_t i = 0; i < num_frames && samples_ok; i++) {
+        for (uint32_t c = 0; c < num_channels; c++) {
+            size_t pos = data + (static_cast<size_t>(i) * num_channels + c) * bytes;
+            float expected = signal[c][i];
+            float clipped = std::fmax(-1.0f, std::fmin(1.0f, expected));
+            if (format == AudioSampleFormat::PCM16) {
+                int16_t s = static_cast<int16_t>(get16(d, pos));
+                samples_ok = std::fabs(s / 32767.0f - clipped) <= 1.0f / 32767.0f;
+            } else if (format == AudioSampleFormat::PCM24) {
+                int32_t s = static_cast<int32_t>(d[pos] << 8 | d[pos + 1] << 16 | d[pos + 2] << 24) >> 8;
+                samples_ok = std::fabs(s / 8388607.0f - clipped) <= 1.0f / 8388607.0f;
+            } else {
+                float s;
+                memcpy(&s, &d[pos], sizeof(float));
+                samples_ok = s == expected;
+            }
+            if (!samples_ok) break;
+        }
+    }
+    check(samples_ok, "every sample round-trips");
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Modal Attractors - Audio File Writer Tests" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    testFormat(AudioSampleFormat::PCM16, 2, false, "16-bit stereo");
+    testFormat(AudioSampleFormat::PCM24, 1, false, "24-bit mono (odd data size)");
+    testFormat(AudioSampleFormat::Float32, 2, false, "32-bit float stereo");
+    testFormat(AudioSampleFormat::PCM16, 2, true, "16-bit stereo, background writer");
+    testFormat(AudioSampleFormat::PCM24, 3, true, "24-bit 3 channels, background writer");
+    testFormat(AudioSampleFormat::Float32, 2, true, "32-bit float stereo, background writer");
+
+    std::cout << std::endl;
+    if (g_failures == 0) {
+        std::cout << "All audio file writer tests passed" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::cout << g_failures << " audio file writer test(s) failed" << std::endl;
+    return EXIT_FAILURE;
+}
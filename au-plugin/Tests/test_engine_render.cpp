@@ -0,0 +1,609 @@
+/**
+ * @file test_engine_render.cpp
+ * @brief Render-path regression tests for ModalAttractorsEngine
+ *
+ * Checks engine-level behavior that the single-voice test cannot see:
+ * - Control-rate scheduling is independent of host buffer size
+ * - Queued note events start at their sample offset
+ * - Topology changes are swapped in, or morphed into, by the render thread
+ * - Renders are reproducible after modal_attractors_engine_set_seed()
+ * - Mode bus renders keep the stereo mix and split it by mode
+ * - Planar channel renders overwrite or accumulate into caller buffers
+ * - Half and double internal render rates keep pitch, level and timing
+ * - Polyphony changes swap voice pools without interrupting held notes
+ * - Render statistics can be polled while rendering (ENABLE_ENGINE_STATS)
+ */
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "../src/au_wrapper/ModalAttractorsAU.h"
+#include "../src/au_wrapper/ModalParameters.h"
+#include "../src/dsp_core/VoiceAllocator.h"
+#include "../src/dsp_core/TopologyEngine.h"
+#include "../src/dsp_core/HalfbandResampler.h"
+
+static int g_failures = 0;
+
+static void check(bool condition, const char* description) {
+    if (condition) {
+        std::cout << "  ✓ " << description << std::endl;
+    } else {
+        std::cout << "  ✗ FAILED: " << description << std::endl;
+        g_failures++;
+    }
+}
+
+/**
+ * @brief Render one second and return the number of control steps taken
+ */
+static uint32_t stepsPerSecond(float sample_rate, uint32_t buffer_size,
+                               int render_rate = kRenderRate_Host) {
+    ModalAttractorsEngine engine;
+    modal_attractors_engine_init(&engine, sample_rate, 4, render_rate);
+
+    // Self-oscillator never releases, so age counts every control tick
+    modal_attractors_engine_set_parameter(&engine, kParam_Personality, 1.0f);
+    modal_attractors_engine_note_on(&engine, 60, 100);
+
+    float* outL = new float[buffer_size];
+    float* outR = new float[buffer_size];
+
+    uint32_t total_frames = static_cast<uint32_t>(sample_rate);
+    uint32_t rendered = 0;
+    while (rendered < total_frames) {
+        uint32_t frames = std::min(buffer_size, total_frames - rendered);
+        modal_attractors_engine_render(&engine, outL, outR, frames);
+        rendered += frames;
+    }
+
+    uint32_t steps = 0;
+    for (uint32_t i = 0; i < engine.max_polyphony; i++) {
+        ModalVoice* voice = engine.voice_allocator->getVoice(i);
+        if (voice->isActive()) {
+            steps = voice->getAge();
+        }
+    }
+
+    delete[] outL;
+    delete[] outR;
+    modal_attractors_engine_cleanup(&engine);
+    return steps;
+}
+
+static void testControlRateIndependentOfBufferSize() {
+    std::cout << "Control rate vs. host buffer size" << std::endl;
+
+    const float sample_rates[] = {44100.0f, 48000.0f, 96000.0f};
+    const uint32_t buffer_sizes[] = {1, 64, 333, 1024, 4096};
+
+    for (float sample_rate : sample_rates) {
+        for (uint32_t buffer_size : buffer_sizes) {
+            uint32_t steps = stepsPerSecond(sample_rate, buffer_size);
+
+            char description[128];
+            snprintf(description, sizeof(description),
+                     "%.0f Hz, %u-frame buffers: %u steps/s",
+                     sample_rate, buffer_size, steps);
+            check(steps == CONTROL_RATE_HZ, description);
+        }
+    }
+}
+
+static void testSampleAccurateNoteOn() {
+    std::cout << "Sample-accurate note on" << std::endl;
+
+    ModalAttractorsEngine engine;
+    modal_attractors_engine_init(&engine, 48000.0f, 4);
+    modal_attractors_engine_set_parameter(&engine, kParam_Personality, 1.0f);
+
+    const uint32_t num_frames = 512;
+    const uint32_t note_offset = 300;
+    float outL[num_frames];
+    float outR[num_frames];
+
+    modal_attractors_engine_note_on(&engine, 60, 100, note_offset);
+    check(engine.voice_allocator->getActiveVoiceCount() == 0, "note queued, not applied on caller thread");
+
+    modal_attractors_engine_render(&engine, outL, outR, num_frames);
+
+    bool silent_before = true;
+    for (uint32_t i = 0; i < note_offset; i++) {
+        if (outL[i] != 0.0f) silent_before = false;
+    }
+    bool sound_after = false;
+    for (uint32_t i = note_offset; i < num_frames; i++) {
+        if (outL[i] != 0.0f) sound_after = true;
+    }
+
+    check(silent_before, "silent before note offset");
+    check(sound_after, "sound after note offset");
+    check(engine.voice_allocator->getActiveVoiceCount() == 1, "voice active after render");
+
+    modal_attractors_engine_cleanup(&engine);
+}
+
+static void testTopologySwap() {
+    std::cout << "Topology swap" << std::endl;
+
+    ModalAttractorsEngine engine;
+    modal_attractors_engine_init(&engine, 48000.0f, 4);
+
+    float outL[256];
+    float outR[256];
+
+    // Two changes before a render: only the last one is swapped in
+    modal_attractors_engine_set_parameter(&engine, kParam_Topology, 3.0f);
+    modal_attractors_engine_set_parameter(&engine, kParam_Topology, 5.0f);
+    check(engine.topology_engine->getTopologyType() == TopologyType::Ring, "ring until next render");
+
+    modal_attractors_engine_render(&engine, outL, outR, 256);
+    check(engine.topology_engine->getTopologyType() == TopologyType::Complete, "complete after render");
+    check(engine.topology_engine->getEdgeCount() == 12, "complete graph over 4 voices has 12 edges");
+    check(engine.topology_exchange->retired.load() != nullptr, "replaced topology parked for caller");
+
+    // Next change collects the retired topology
+    modal_attractors_engine_set_parameter(&engine, kParam_Topology, 0.0f);
+    check(engine.topology_exchange->retired.load() == nullptr, "retired topology reclaimed");
+
+    modal_attractors_engine_render(&engine, outL, outR, 256);
+    check(engine.topology_engine->getTopologyType() == TopologyType::Ring, "ring after second swap");
+
+    // With a morph time the change fades in over control ticks
+    modal_attractors_engine_set_parameter(&engine, kParam_TopologyMorphTime, 0.05f);
+    modal_attractors_engine_render(&engine, outL, outR, 256);
+    modal_attractors_engine_set_parameter(&engine, kParam_Topology, 6.0f);
+    modal_attractors_engine_render(&engine, outL, outR, 256);
+    check(engine.topology_engine->isMorphing() && engine.topology_engine->getEdgeCount() == 8,
+          "morph to none keeps fading ring edges");
+    for (int i = 0; i < 10; i++) modal_attractors_engine_render(&engine, outL, outR, 256);
+    check(!engine.topology_engine->isMorphing() && engine.topology_engine->getEdgeCount() == 0,
+          "morph finished after morph time");
+
+    modal_attractors_engine_cleanup(&engine);
+}
+
+/**
+ * @brief Render a short phrase after seeding, return sum of squares
+ */
+static double renderSeeded(uint32_t seed, float* out, uint32_t num_frames) {
+    ModalAttractorsEngine engine;
+    modal_attractors_engine_init(&engine, 48000.0f, 8);
+    modal_attractors_engine_set_seed(&engine, seed);
+
+    float outR[256];
+    double energy = 0.0;
+    for (uint32_t offset = 0; offset < num_frames; offset += 256) {
+        if (offset % 2048 == 0) {
+            modal_attractors_engine_note_on(&engine, static_cast<uint8_t>(48 + offset / 2048), 100, 17);
+        }
+        modal_attractors_engine_render(&engine, out + offset, outR, 256);
+        for (uint32_t n = 0; n < 256; n++) energy += out[offset + n] * out[offset + n];
+    }
+
+    modal_attractors_engine_cleanup(&engine);
+    return energy;
+}
+
+static void testSeedReproducible() {
+    std::cout << "Seeded render" << std::endl;
+
+    const uint32_t num_frames = 16384;
+    float* first = new float[num_frames];
+    float* second = new float[num_frames];
+    float* other = new float[num_frames];
+
+    double energy = renderSeeded(1234, first, num_frames);
+    srand(99);  // Global rand() state must not matter
+    renderSeeded(1234, second, num_frames);
+    renderSeeded(4321, other, num_frames);
+
+    bool identical = true;
+    bool differs = false;
+    for (uint32_t n = 0; n < num_frames; n++) {
+        if (first[n] != second[n]) identical = false;
+        if (first[n] != other[n]) differs = true;
+    }
+
+    check(energy > 0.0, "phrase produces sound");
+    check(identical, "same seed renders bit-identical output");
+    check(differs, "different seed renders different output");
+
+    delete[] first;
+    delete[] second;
+    delete[] other;
+}
+
+static void testModeBusRender() {
+    std::cout << "Mode bus render" << std::endl;
+
+    const uint32_t block = 256;
+    const uint32_t num_blocks = 64;
+    ModalAttractorsEngine plain, routed;
+    ModalAttractorsEngine* engines[2] = {&plain, &routed};
+    for (ModalAttractorsEngine* engine : engines) {
+        modal_attractors_engine_init(engine, 48000.0f, 8);
+        modal_attractors_engine_set_seed(engine, 77);
+        modal_attractors_engine_set_parameter(engine, kParam_MasterGain, 0.5f);
+    }
+
+    float plainL[block], plainR[block], outL[block], outR[block];
+    float modes[MAX_MODES][block];
+    float* mode_out[MAX_MODES] = {modes[0], modes[1], modes[2], modes[3]};
+
+    double err = 0.0, ref = 0.0, sum_err = 0.0;
+    double mode_energy[MAX_MODES] = {};
+    for (uint32_t b = 0; b < num_blocks; b++) {
+        if (b % 8 == 0) {
+            for (ModalAttractorsEngine* engine : engines) {
+                modal_attractors_engine_note_on(engine, static_cast<uint8_t>(48 + b / 8), 100, 17);
+            }
+        }
+        modal_attractors_engine_render(&plain, plainL, plainR, block);
+        modal_attractors_engine_render_modes(&routed, outL, outR, mode_out, MAX_MODES, block);
+
+        for (uint32_t n = 0; n < block; n++) {
+            float sum = 0.0f;
+            for (int k = 0; k < MAX_MODES; k++) {
+                sum += modes[k][n];
+                mode_energy[k] += modes[k][n] * modes[k][n];
+            }
+            err += (outL[n] - plainL[n]) * (outL[n] - plainL[n]) +
+                   (outR[n] - plainR[n]) * (outR[n] - plainR[n]);
+            ref += plainL[n] * plainL[n] + plainR[n] * plainR[n];
+            sum_err += (sum - outL[n]) * (sum - outL[n]);
+        }
+    }
+
+    bool every_mode = true;
+    for (int k = 0; k < MAX_MODES; k++) every_mode = every_mode && mode_energy[k] > 0.0;
+
+    char description[128];
+    snprintf(description, sizeof(description), "stereo matches the plain render: relative error %.2e",
+             sqrt(err / (ref > 0.0 ? ref : 1.0)));
+    check(ref > 0.0 && err <= 1e-12 * ref, description);
+    check(sum_err <= 1e-12 * ref, "mode buses sum to the centered mix (master gain included)");
+    check(every_mode, "every mode bus carries signal");
+
+    for (ModalAttractorsEngine* engine : engines) modal_attractors_engine_cleanup(engine);
+}
+
+static void testChannelRender() {
+    std::cout << "Planar channel render" << std::endl;
+
+    const uint32_t block = 300;     // Not a multiple of the control period
+    const uint32_t num_channels = 2 + MAX_MODES;
+    ModalAttractorsEngine reference, overwrite, accumulate;
+    ModalAttractorsEngine* engines[3] = {&reference, &overwrite, &accumulate};
+    for (ModalAttractorsEngine* engine : engines) {
+        modal_attractors_engine_init(engine, 48000.0f, 8);
+        modal_attractors_engine_set_seed(engine, 21);
+    }
+
+    float expected[num_channels][block], written[num_channels][block], mixed[num_channels][block];
+    float* expected_ptr[num_channels];
+    float* written_ptr[num_channels];
+    float* mixed_ptr[num_channels];
+    for (uint32_t c = 0; c < num_channels; c++) {
+        expected_ptr[c] = expected[c];
+        written_ptr[c] = written[c];
+        mixed_ptr[c] = mixed[c];
+    }
+
+    bool overwrite_exact = true, accumulate_matches = true;
+    for (uint32_t b = 0; b < 40; b++) {
+        if (b % 10 == 0) {
+            for (ModalAttractorsEngine* engine : engines) {
+                modal_attractors_engine_note_on(engine, static_cast<uint8_t>(55 + b / 10), 100, 123);
+            }
+        }
+
+        // Stale data must be overwritten; an existing mix must be added to
+        for (uint32_t c = 0; c < num_channels; c++) {
+            for (uint32_t n = 0; n < block; n++) {
+                written[c][n] = 1e6f;
+                mixed[c][n] = 0.25f * c - 0.5f;
+            }
+        }
+        modal_attractors_engine_render_modes(&reference, expected[0], expected[1],
+                                             expected_ptr + 2, MAX_MODES, block);
+        modal_attractors_engine_render_channels(&overwrite, written_ptr, num_channels, block);
+        modal_attractors_engine_render_channels(&accumulate, mixed_ptr, num_channels, block, true);
+
+        for (uint32_t c = 0; c < num_channels; c++) {
+            for (uint32_t n = 0; n < block; n++) {
+                overwrite_exact &= written[c][n] == expected[c][n];
+                // The add may fuse with the gain multiply (-ffast-math)
+                accumulate_matches &= fabsf(mixed[c][n] - ((0.25f * c - 0.5f) + expected[c][n])) <= 1e-6f;
+            }
+        }
+    }
+    check(overwrite_exact, "overwrite matches render_modes bit for bit");
+    check(accumulate_matches, "accumulate adds the same signal to the caller's mix");
+
+    float untouched = 3.0f;
+    float* one[1] = {&untouched};
+    modal_attractors_engine_render_channels(&overwrite, one, 1, 1);
+    check(untouched == 3.0f, "fewer than two channels renders nothing");
+
+    for (ModalAttractorsEngine* engine : engines) modal_attractors_engine_cleanup(engine);
+}
+
+/**
+ * @brief Render a held A4 (mode 0 only) from frame 300, in odd-sized blocks
+ */
+static std::vector<float> renderHeldNote(float sample_rate, int render_rate, uint32_t num_frames,
+                                         uint32_t block, double* mode_sum_error) {
+    ModalAttractorsEngine engine;
+    modal_attractors_engine_init(&engine, sample_rate, 4, render_rate);
+    modal_attractors_engine_set_parameter(&engine, kParam_Personality, 1.0f);
+    modal_attractors_engine_set_parameter(&engine, kParam_Mode1_Weight, 0.0f);
+    modal_attractors_engine_set_parameter(&engine, kParam_Mode2_Weight, 0.0f);
+    modal_attractors_engine_set_parameter(&engine, kParam_Mode3_Weight, 0.0f);
+    modal_attractors_engine_note_on(&engine, 69, 100, 300 * sample_rate / 48000.0f);
+
+    std::vector<float> left(num_frames), right(block), modes(MAX_MODES * block);
+    float* mode_out[MAX_MODES];
+    for (uint32_t k = 0; k < MAX_MODES; k++) mode_out[k] = modes.data() + k * block;
+
+    double sum_err = 0.0, ref = 0.0;
+    for (uint32_t pos = 0; pos < num_frames; pos += block) {
+        uint32_t frames = std::min(block, num_frames - pos);
+        modal_attractors_engine_render_modes(&engine, left.data() + pos, right.data(),
+                                             mode_out, MAX_MODES, frames);
+        for (uint32_t n = 0; n < frames; n++) {
+            float sum = 0.0f;
+            for (uint32_t k = 0; k < MAX_MODES; k++) sum += mode_out[k][n];
+            sum_err += (sum - left[pos + n]) * (sum - left[pos + n]);
+            ref += left[pos + n] * left[pos + n];
+        }
+    }
+    if (mode_sum_error) *mode_sum_error = ref > 0.0 ? sqrt(sum_err / ref) : 1.0;
+
+    modal_attractors_engine_cleanup(&engine);
+    return left;
+}
+
+static double rms(const std::vector<float>& x, size_t from) {
+    double energy = 0.0;
+    for (size_t n = from; n < x.size(); n++) energy += x[n] * x[n];
+    return sqrt(energy / (x.size() - from));
+}
+
+static void testRenderRates() {
+    std::cout << "Internal render rates" << std::endl;
+
+    const uint32_t buffer_sizes[] = {1, 333, 4096};
+    for (int rate : {kRenderRate_Half, kRenderRate_Double}) {
+        for (uint32_t buffer_size : buffer_sizes) {
+            uint32_t steps = stepsPerSecond(44100.0f, buffer_size, rate);
+
+            char description[128];
+            snprintf(description, sizeof(description), "%s rate, %u-frame buffers: %u steps/s",
+                     rate == kRenderRate_Half ? "half" : "double", buffer_size, steps);
+            check(steps == CONTROL_RATE_HZ, description);
+        }
+    }
+
+    const uint32_t num_frames = 24000;
+    std::vector<float> host = renderHeldNote(48000.0f, kRenderRate_Host, num_frames, 333, nullptr);
+
+    for (int rate : {kRenderRate_Half, kRenderRate_Double}) {
+        const bool half = rate == kRenderRate_Half;
+        const char* name = half ? "half" : "double";
+        double mode_sum_error;
+        std::vector<float> out = renderHeldNote(48000.0f, rate, num_frames, 333, &mode_sum_error);
+
+        // Same as rendering at the internal rate and resampling the result
+        std::vector<float> direct = renderHeldNote(half ? 24000.0f : 96000.0f, kRenderRate_Host,
+                                                   half ? num_frames / 2 : num_frames * 2, 4096, nullptr);
+        std::vector<float> expected(num_frames);
+        HalfbandResampler resampler;
+        if (half) {
+            resampler.upsample(direct.data(), expected.data(), num_frames / 2);
+        } else {
+            resampler.downsample(direct.data(), expected.data(), num_frames);
+        }
+        double err = 0.0, ref = 0.0;
+        for (uint32_t n = 0; n < num_frames; n++) {
+            err += (out[n] - expected[n]) * (out[n] - expected[n]);
+            ref += expected[n] * expected[n];
+        }
+
+        uint32_t onset = 0;
+        while (onset < num_frames && out[onset] == 0.0f) onset++;
+        float level_db = static_cast<float>(20.0 * log10(rms(out, num_frames / 2) / rms(host, num_frames / 2)));
+
+        char description[128];
+        snprintf(description, sizeof(description),
+                 "%s rate: matches an internal-rate render resampled (relative error %.1e)",
+                 name, sqrt(err / (ref > 0.0 ? ref : 1.0)));
+        check(ref > 0.0 && err <= 1e-8 * ref, description);
+        snprintf(description, sizeof(description), "%s rate: level within 0.5 dB of host (%+.2f dB)", name, level_db);
+        check(fabsf(level_db) < 0.5f, description);
+        snprintf(description, sizeof(description), "%s rate: silent before the note offset (frame %u)", name, onset);
+        check(onset >= 300, description);
+        snprintf(description, sizeof(description), "%s rate: mode buses sum to the mix (relative error %.1e)",
+                 name, mode_sum_error);
+        check(mode_sum_error < 1e-5, description);
+    }
+}
+
+/**
+ * @brief Render a held, uncoupled chord, changing polyphony halfway if asked
+ */
+static std::vector<float> renderChord(uint32_t new_polyphony) {
+    ModalAttractorsEngine engine;
+    modal_attractors_engine_init(&engine, 48000.0f, 4);
+    modal_attractors_engine_set_parameter(&engine, kParam_Personality, 1.0f);
+    modal_attractors_engine_set_parameter(&engine, kParam_CouplingStrength, 0.0f);
+    modal_attractors_engine_set_parameter(&engine, kParam_StereoWidth, 0.5f);
+    for (uint8_t note : {60, 64, 67}) modal_attractors_engine_note_on(&engine, note, 100);
+
+    const uint32_t block = 250, num_blocks = 96;
+    std::vector<float> left(block * num_blocks), right(block);
+    for (uint32_t b = 0; b < num_blocks; b++) {
+        if (b == num_blocks / 2 && new_polyphony) {
+            modal_attractors_engine_set_parameter(&engine, kParam_Polyphony, static_cast<float>(new_polyphony));
+        }
+        modal_attractors_engine_render(&engine, left.data() + b * block, right.data(), block);
+    }
+
+    modal_attractors_engine_cleanup(&engine);
+    return left;
+}
+
+static void testPolyphonyChange() {
+    std::cout << "Runtime polyphony change" << std::endl;
+
+    // Without coupling the carried-over voices render exactly as before
+    std::vector<float> reference = renderChord(0);
+    const uint32_t sizes[] = {8, 3};
+    for (uint32_t polyphony : sizes) {
+        std::vector<float> changed = renderChord(polyphony);
+        float max_error = 0.0f;
+        for (size_t n = 0; n < reference.size(); n++) {
+            max_error = std::fmax(max_error, std::fabs(changed[n] - reference[n]));
+        }
+
+        char description[128];
+        snprintf(description, sizeof(description),
+                 "4 -> %u voices: held chord continues unchanged (max error %.1e)", polyphony, max_error);
+        check(max_error < 1e-6f, description);
+    }
+
+    ModalAttractorsEngine engine;
+    modal_attractors_engine_init(&engine, 48000.0f, 4);
+    modal_attractors_engine_set_parameter(&engine, kParam_Personality, 1.0f);
+    float outL[256];
+    float outR[256];
+
+    for (uint8_t note : {60, 62, 64}) modal_attractors_engine_note_on(&engine, note, 100);
+    modal_attractors_engine_render(&engine, outL, outR, 256);
+
+    // Built on this thread, swapped in by the next render
+    VoiceAllocator* old_allocator = engine.voice_allocator;
+    modal_attractors_engine_set_parameter(&engine, kParam_Polyphony, 8.0f);
+    modal_attractors_engine_set_parameter(&engine, kParam_Topology, 5.0f);
+    check(engine.voice_allocator == old_allocator, "old pool renders until the next control tick");
+
+    modal_attractors_engine_render(&engine, outL, outR, 256);
+    check(engine.voice_allocator->getMaxPolyphony() == 8 && engine.topology_engine->getNumVoices() == 8,
+          "8-voice pool and topology swapped in");
+    check(engine.voice_allocator->getActiveVoiceCount() == 3, "sounding voices carried over");
+    check(engine.topology_engine->getTopologyType() == TopologyType::Complete &&
+          engine.topology_engine->getEdgeCount() == 56, "topology change waited for the new voice count");
+
+    for (uint8_t note : {65, 67, 69, 71, 72}) {
+        modal_attractors_engine_note_on(&engine, note, 100);
+        modal_attractors_engine_render(&engine, outL, outR, 256);
+    }
+    check(engine.voice_allocator->getActiveVoiceCount() == 8 && engine.voice_allocator->getStealCount() == 0,
+          "8 notes sound without stealing");
+
+    // Shrinking keeps held notes before released ones, then the youngest
+    modal_attractors_engine_note_off(&engine, 72);
+    modal_attractors_engine_set_parameter(&engine, kParam_Polyphony, 2.0f);
+    check(engine.pool_exchange->retired.load() == nullptr, "retired pool reclaimed");
+    modal_attractors_engine_render(&engine, outL, outR, 256);
+
+    VoiceAllocator* allocator = engine.voice_allocator;
+    bool kept_youngest = allocator->getActiveVoiceCount() == 2;
+    for (uint32_t i = 0; i < allocator->getActiveVoiceCount(); i++) {
+        uint8_t note = allocator->getVoice(allocator->getActiveVoices()[i])->getMIDINote();
+        kept_youngest = kept_youngest && (note == 69 || note == 71);
+    }
+    check(kept_youngest, "2 voices: the two youngest held notes kept");
+
+    modal_attractors_engine_note_off(&engine, 71);
+    modal_attractors_engine_render(&engine, outL, outR, 256);
+    bool released = false;
+    for (uint32_t i = 0; i < 2; i++) {
+        ModalVoice* voice = allocator->getVoice(i);
+        if (voice->getMIDINote() == 71) released = voice->getState() == ModalVoice::State::Release;
+    }
+    check(released, "note off reaches a carried-over voice");
+
+    modal_attractors_engine_cleanup(&engine);
+}
+
+#ifdef MODAL_ENGINE_STATS
+static void testRenderStats() {
+    std::cout << "Render statistics" << std::endl;
+
+    ModalAttractorsEngine engine;
+    modal_attractors_engine_init(&engine, 48000.0f, 4);
+
+    EngineStatsSnapshot stats;
+    check(!modal_attractors_engine_get_stats(&engine, &stats), "no stats before the first block");
+
+    // Six notes on four voices: two steals
+    for (uint8_t note = 60; note < 66; note++) modal_attractors_engine_note_on(&engine, note, 100);
+
+    // Poll from another thread while rendering; every snapshot must be whole
+    std::atomic<bool> rendering(true);
+    std::atomic<uint32_t> torn(0);
+    std::atomic<uint32_t> polls(0);
+    std::thread poller([&]() {
+        EngineStatsSnapshot s;
+        while (rendering.load()) {
+            if (!modal_attractors_engine_get_stats(&engine, &s)) continue;
+            polls++;
+            float stages = s.control_us + s.coupling_us + s.render_us;
+            if (s.block_frames != 128 || stages > s.block_us * 1.01f + 1.0f) torn++;
+        }
+    });
+
+    float outL[128];
+    float outR[128];
+    for (int b = 0; b < 1000; b++) {
+        modal_attractors_engine_render(&engine, outL, outR, 128);
+    }
+    rendering = false;
+    poller.join();
+
+    check(modal_attractors_engine_get_stats(&engine, &stats), "stats available after rendering");
+    check(stats.block_count == 1000 && stats.block_frames == 128, "block count and size");
+    check(stats.render_us > 0.0f && stats.block_us >= stats.render_us, "stage times recorded");
+    check(fabsf(stats.budget_us - 128 * 1e6f / 48000.0f) < 0.01f, "budget is the block's real-time duration");
+    check(stats.load > 0.0f && stats.load_p99 <= stats.load_max && stats.load <= stats.load_max,
+          "load, p99 and max consistent");
+    check(stats.active_voices == 4 && stats.steal_count == 2, "voice and steal counts");
+    check(torn == 0, "concurrent polls never saw a torn snapshot");
+    std::cout << "  (" << polls.load() << " concurrent polls)" << std::endl;
+
+    modal_attractors_engine_cleanup(&engine);
+}
+#endif
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Modal Attractors - Engine Render Tests" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    testControlRateIndependentOfBufferSize();
+    testSampleAccurateNoteOn();
+    testTopologySwap();
+    testSeedReproducible();
+    testModeBusRender();
+    testChannelRender();
+    testRenderRates();
+    testPolyphonyChange();
+#ifdef MODAL_ENGINE_STATS
+    testRenderStats();
+#endif
+
+    std::cout << std::endl;
+    if (g_failures == 0) {
+        std::cout << "All engine tests passed" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::cout << g_failures << " engine test(s) failed" << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,156 @@
+/**
+ * @file test_halfband_resampler.cpp
+ * @brief Tests for the polyphase half-band 2× resampler
+ *
+ * Checks unity DC gain, passband accuracy against the ideal delayed sine
+ * (HALFBAND_LATENCY samples at the high rate), stopband rejection when
+ * decimating, and that results do not depend on the block size.
+ */
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include "../src/dsp_core/HalfbandResampler.h"
+
+static int g_failures = 0;
+
+static void check(bool condition, const char* description) {
+    if (condition) {
+        std::cout << "  ✓ " << description << std::endl;
+    } else {
+        std::cout << "  ✗ FAILED: " << description << std::endl;
+        g_failures++;
+    }
+}
+
+static const double kPi = 3.14159265358979323846;
+
+/**
+ * @brief Sine at cycles_per_sample, starting at sample 0
+ */
+static std::vector<float> sine(double cycles_per_sample, uint32_t num_samples) {
+    std::vector<float> x(num_samples);
+    for (uint32_t n = 0; n < num_samples; n++) {
+        x[n] = static_cast<float>(sin(2.0 * kPi * cycles_per_sample * n));
+    }
+    return x;
+}
+
+static std::vector<float> upsample(const std::vector<float>& in, uint32_t block) {
+    HalfbandResampler resampler;
+    std::vector<float> out(2 * in.size());
+    for (uint32_t pos = 0; pos < in.size(); pos += block) {
+        uint32_t n = std::min(block, static_cast<uint32_t>(in.size()) - pos);
+        resampler.upsample(in.data() + pos, out.data() + 2 * pos, n);
+    }
+    return out;
+}
+
+static std::vector<float> downsample(const std::vector<float>& in, uint32_t block) {
+    HalfbandResampler resampler;
+    std::vector<float> out(in.size() / 2);
+    for (uint32_t pos = 0; pos < out.size(); pos += block) {
+        uint32_t n = std::min(block, static_cast<uint32_t>(out.size()) - pos);
+        resampler.downsample(in.data() + 2 * pos, out.data() + pos, n);
+    }
+    return out;
+}
+
+static void testDcGain() {
+    std::cout << "DC gain" << std::endl;
+
+    std::vector<float> ones(256, 1.0f);
+    std::vector<float> up = upsample(ones, 256);
+    std::vector<float> down = downsample(ones, 128);
+
+    float up_error = 0.0f, down_error = 0.0f;
+    for (uint32_t n = 2 * HALFBAND_LATENCY; n < up.size(); n++) up_error = std::fmax(up_error, std::fabs(up[n] - 1.0f));
+    for (uint32_t n = HALFBAND_LATENCY; n < down.size(); n++) down_error = std::fmax(down_error, std::fabs(down[n] - 1.0f));
+
+    check(up_error < 1e-5f, "upsampled DC settles to 1");
+    check(down_error < 1e-5f, "decimated DC settles to 1");
+}
+
+static void testPassband() {
+    std::cout << "Passband accuracy" << std::endl;
+
+    // Up: low-rate tone at 0.8 of its Nyquist (19.2 kHz at 48 kHz)
+    const double f_low = 0.4;
+    const uint32_t num_in = 2048;
+    std::vector<float> up = upsample(sine(f_low, num_in), 64);
+    float up_error = 0.0f;
+    for (uint32_t n = 4 * HALFBAND_PHASE_TAPS; n < up.size(); n++) {
+        double ideal = sin(2.0 * kPi * (f_low / 2.0) * (static_cast<double>(n) - HALFBAND_LATENCY));
+        up_error = std::fmax(up_error, static_cast<float>(std::fabs(up[n] - ideal)));
+    }
+
+    // Down: high-rate tone at the same frequency
+    const double f_high = 0.2;
+    std::vector<float> down = downsample(sine(f_high, 2 * num_in), 64);
+    float down_error = 0.0f;
+    for (uint32_t m = 2 * HALFBAND_PHASE_TAPS; m < down.size(); m++) {
+        double ideal = sin(2.0 * kPi * f_high * (2.0 * m + 1.0 - HALFBAND_LATENCY));
+        down_error = std::fmax(down_error, static_cast<float>(std::fabs(down[m] - ideal)));
+    }
+
+    char description[128];
+    snprintf(description, sizeof(description), "upsampled tone matches delayed ideal (max error %.1e)", up_error);
+    check(up_error < 1e-3f, description);
+    snprintf(description, sizeof(description), "decimated tone matches delayed ideal (max error %.1e)", down_error);
+    check(down_error < 1e-3f, description);
+}
+
+static void testStopband() {
+    std::cout << "Stopband rejection" << std::endl;
+
+    // Tones above 0.3 of the high rate would alias into the low band
+    const double tones[] = {0.3, 0.4, 0.49};
+    for (double f : tones) {
+        std::vector<float> down = downsample(sine(f, 4096), 64);
+        double energy = 0.0;
+        for (uint32_t m = 2 * HALFBAND_PHASE_TAPS; m < down.size(); m++) energy += down[m] * down[m];
+        double rms = sqrt(energy / (down.size() - 2 * HALFBAND_PHASE_TAPS));
+        double db = 20.0 * log10(rms * sqrt(2.0) + 1e-12);
+
+        char description[128];
+        snprintf(description, sizeof(description), "%.2f·fs tone attenuated %.0f dB", f, -db);
+        check(db < -60.0, description);
+    }
+}
+
+static void testBlockSizeInvariance() {
+    std::cout << "Block size invariance" << std::endl;
+
+    std::vector<float> x = sine(0.13, 1000);
+    std::vector<float> up_ref = upsample(x, 1000);
+    std::vector<float> down_ref = downsample(x, 500);
+
+    bool same = true;
+    const uint32_t blocks[] = {1, 7, 64, 333};
+    for (uint32_t block : blocks) {
+        same = same && upsample(x, block) == up_ref && downsample(x, block) == down_ref;
+    }
+    check(same, "1, 7, 64 and 333-sample blocks are bit-identical");
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Modal Attractors - Half-band Resampler Tests" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    testDcGain();
+    testPassband();
+    testStopband();
+    testBlockSizeInvariance();
+
+    std::cout << std::endl;
+    if (g_failures == 0) {
+        std::cout << "All half-band resampler tests passed" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::cout << g_failures << " half-band resampler test(s) failed" << std::endl;
+    return EXIT_FAILURE;
+}
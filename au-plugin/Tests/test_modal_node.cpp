@@ -0,0 +1,441 @@
+/**
+ * @file test_modal_node.cpp
+ * @brief Tests for the batched modal_bank_step() kernel
+ *
+ * Steps resonators and self-oscillators (with and without an active poke
+ * envelope) through modal_bank_step() and through a reference copy of the
+ * original per-mode cexpf() integrator, and compares mode amplitudes.
+ * Also checks that modal_node_set_mode() refreshes the cached propagator
+ * (and that modal_node_set_frequencies() computes the same ones),
+ * that stopped nodes are left untouched, that per-node noise is
+ * reproducible from a seed, that the specialized step kernels
+ * (ModalKernels.h) track modal_bank_step() for every instantiation, and
+ * that decaying tails flush to zero without passing through denormals.
+ */
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <complex>
+#include <vector>
+#include <algorithm>
+#include "../src/esp32_port/modal_node.h"
+#include "../src/dsp_core/ModalKernels.h"
+
+static int g_failures = 0;
+
+static void check(bool condition, const char* description) {
+    if (condition) {
+        std::cout << "  ✓ " << description << std::endl;
+    } else {
+        std::cout << "  ✗ FAILED: " << description << std::endl;
+        g_failures++;
+    }
+}
+
+/**
+ * @brief Reference mode state (as the original modal_node_step saw it)
+ */
+struct ReferenceNode {
+    std::complex<float> a[MAX_MODES];
+    float omega[MAX_MODES];
+    float gamma[MAX_MODES];
+    float weight[MAX_MODES];
+    bool active[MAX_MODES];
+    bool self_oscillator;
+    excitation_envelope_t excitation;
+};
+
+static std::complex<float> modeAmplitude(const modal_node_t& node, int k) {
+    const float* a = reinterpret_cast<const float*>(&node.modes[k].a);
+    return std::complex<float>(a[0], a[1]);
+}
+
+static ReferenceNode snapshot(const modal_node_t& node) {
+    ReferenceNode ref;
+    for (int k = 0; k < MAX_MODES; k++) {
+        ref.a[k] = modeAmplitude(node, k);
+        ref.omega[k] = node.modes[k].params.omega;
+        ref.gamma[k] = node.modes[k].params.gamma;
+        ref.weight[k] = node.modes[k].params.weight;
+        ref.active[k] = node.modes[k].params.active;
+    }
+    ref.self_oscillator = node.personality == PERSONALITY_SELF_OSCILLATOR;
+    ref.excitation = node.excitation;
+    return ref;
+}
+
+/**
+ * @brief Original modal_node_step(): cexpf(λ·dt) for every mode, every step
+ *
+ * Phase hints must be >= 0 (no random phase), so both paths see the same input.
+ */
+static void referenceStep(ReferenceNode& ref) {
+    if (ref.excitation.active) {
+        ref.excitation.elapsed_ms += CONTROL_DT * 1000.0f;
+        if (ref.excitation.elapsed_ms >= ref.excitation.duration_ms) {
+            ref.excitation.active = false;
+        }
+    }
+
+    for (int k = 0; k < MAX_MODES; k++) {
+        if (!ref.active[k]) continue;
+
+        float effective_gamma = ref.gamma[k];
+        if (ref.self_oscillator) {
+            float energy = std::abs(ref.a[k]);
+            effective_gamma = -ref.gamma[k] + 3.0f * ref.gamma[k] * energy * energy;
+        }
+
+        std::complex<float> excitation(0.0f, 0.0f);
+        if (ref.excitation.active) {
+            float t_norm = ref.excitation.elapsed_ms / ref.excitation.duration_ms;
+            float envelope = 0.5f * (1.0f - cosf(static_cast<float>(M_PI) * t_norm));
+            float strength = ref.excitation.strength * ref.weight[k];
+            excitation = strength * envelope * std::polar(1.0f, ref.excitation.phase_hint);
+        }
+
+        std::complex<float> lambda(-effective_gamma, ref.omega[k]);
+        ref.a[k] = ref.a[k] * std::exp(lambda * CONTROL_DT) + excitation * CONTROL_DT;
+    }
+}
+
+static void setupNode(modal_node_t* node, uint8_t id, node_personality_t personality) {
+    modal_node_init(node, id, personality);
+    float omega = freq_to_omega(110.0f * (1 + id % 7));
+    modal_node_set_mode(node, 0, omega * 1.0f, 0.5f, 1.0f);
+    modal_node_set_mode(node, 1, omega * 1.01f, 0.6f, 0.7f);
+    modal_node_set_mode(node, 2, omega * 2.0f, 0.8f, 0.5f);
+    if (id % 3 != 0) modal_node_set_mode(node, 3, omega * 3.0f, 1.0f, 0.3f);
+    modal_node_start(node);
+}
+
+static void poke(modal_node_t* node, float strength, float phase) {
+    poke_event_t event;
+    event.source_node_id = 0;
+    event.strength = strength;
+    event.phase_hint = phase;
+    for (int k = 0; k < MAX_MODES; k++) event.mode_weights[k] = 1.0f;
+    modal_node_apply_poke(node, &event);
+}
+
+/**
+ * @brief Largest mode amplitude error relative to the reference, over all nodes
+ */
+static float maxError(const std::vector<modal_node_t>& nodes, const std::vector<ReferenceNode>& refs) {
+    float max_err = 0.0f;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        for (int k = 0; k < MAX_MODES; k++) {
+            float err = std::abs(modeAmplitude(nodes[i], k) - refs[i].a[k]);
+            float scale = std::max(std::abs(refs[i].a[k]), 1e-3f);
+            max_err = std::max(max_err, err / scale);
+        }
+    }
+    return max_err;
+}
+
+static void testMatchesReference(node_personality_t personality, uint32_t num_nodes) {
+    const char* name = personality == PERSONALITY_RESONATOR ? "resonator" : "self-oscillator";
+    std::cout << "modal_bank_step vs. reference, " << num_nodes << " " << name << "s" << std::endl;
+
+    std::vector<modal_node_t> nodes(num_nodes);
+    std::vector<modal_node_t*> pointers(num_nodes);
+    std::vector<ReferenceNode> refs(num_nodes);
+    for (uint32_t i = 0; i < num_nodes; i++) {
+        setupNode(&nodes[i], static_cast<uint8_t>(i), personality);
+        // Apply the kick, then snapshot, so the reference starts from the same state
+        poke(&nodes[i], 0.8f, 0.3f * i);
+        pointers[i] = &nodes[i];
+        refs[i] = snapshot(nodes[i]);
+    }
+
+    float max_during_poke = 0.0f;
+    for (int step = 0; step < 1000; step++) {
+        modal_bank_step(pointers.data(), num_nodes);
+        for (uint32_t i = 0; i < num_nodes; i++) referenceStep(refs[i]);
+        if (step == 10) max_during_poke = maxError(nodes, refs);
+    }
+    float max_after = maxError(nodes, refs);
+
+    char description[128];
+    snprintf(description, sizeof(description),
+             "during poke envelope: relative error %.2e", max_during_poke);
+    check(max_during_poke < 1e-4f, description);
+    snprintf(description, sizeof(description),
+             "after 1000 steps: relative error %.2e", max_after);
+    check(max_after < 1e-3f, description);
+    check(nodes[0].step_count == 1000, "step count advanced");
+}
+
+static void testPropagatorRefresh() {
+    std::cout << "Cached propagator" << std::endl;
+
+    modal_node_t node;
+    setupNode(&node, 1, PERSONALITY_RESONATOR);
+    for (int step = 0; step < 50; step++) modal_node_step(&node);
+
+    // Retune mid-flight; the reference sees only the new parameters
+    modal_node_set_mode(&node, 0, freq_to_omega(330.0f), 2.0f, 1.0f);
+    ReferenceNode ref = snapshot(node);
+
+    for (int step = 0; step < 50; step++) {
+        modal_node_step(&node);
+        referenceStep(ref);
+    }
+
+    float err = std::abs(modeAmplitude(node, 0) - ref.a[0]) / std::abs(ref.a[0]);
+    check(err < 1e-4f, "set_mode refreshes propagator");
+}
+
+static float cfloatDistance(const modal_cfloat_t& x, const modal_cfloat_t& y) {
+    const float* a = reinterpret_cast<const float*>(&x);
+    const float* b = reinterpret_cast<const float*>(&y);
+    return std::hypot(a[0] - b[0], a[1] - b[1]);
+}
+
+static void testSetFrequencies() {
+    std::cout << "Batched retune" << std::endl;
+
+    modal_node_t node, expected;
+    setupNode(&node, 1, PERSONALITY_RESONATOR);
+    node.modes[3].params.active = false;
+    expected = node;
+
+    const float omega[MAX_MODES] = {
+        freq_to_omega(110.0f), freq_to_omega(333.3f), freq_to_omega(1250.0f), freq_to_omega(4000.0f)
+    };
+    modal_node_set_frequencies(&node, omega);
+
+    float max_err = 0.0f;
+    bool params_kept = true;
+    for (int k = 0; k < MAX_MODES; k++) {
+        const mode_params_t& p = expected.modes[k].params;
+        modal_node_set_mode(&expected, k, omega[k], p.gamma, p.weight);
+        max_err = std::fmax(max_err, cfloatDistance(node.modes[k].propagator, expected.modes[k].propagator));
+        max_err = std::fmax(max_err, cfloatDistance(node.modes[k].rotation, expected.modes[k].rotation));
+        params_kept &= node.modes[k].params.omega == omega[k] &&
+                       node.modes[k].params.gamma == p.gamma && node.modes[k].params.weight == p.weight;
+    }
+    char description[120];
+    snprintf(description, sizeof(description),
+             "propagators match modal_node_set_mode (max error %.1e)", max_err);
+    check(max_err < 1e-6f, description);
+    check(params_kept && !node.modes[3].params.active, "  damping, weight and active flags kept");
+}
+
+static void testStoppedNodesUntouched() {
+    std::cout << "Stopped nodes" << std::endl;
+
+    modal_node_t nodes[3];
+    modal_node_t* pointers[3];
+    for (int i = 0; i < 3; i++) {
+        setupNode(&nodes[i], static_cast<uint8_t>(i + 1), PERSONALITY_SELF_OSCILLATOR);
+        pointers[i] = &nodes[i];
+    }
+    modal_node_stop(&nodes[1]);
+    std::complex<float> before = modeAmplitude(nodes[1], 0);
+
+    for (int step = 0; step < 20; step++) modal_bank_step(pointers, 3);
+
+    check(modeAmplitude(nodes[1], 0) == before, "stopped node amplitude unchanged");
+    check(nodes[1].step_count == 0 && nodes[0].step_count == 20 && nodes[2].step_count == 20,
+          "only running nodes counted steps");
+}
+
+/**
+ * @brief Step a self-oscillator poked with random phase, return mode 0
+ */
+static std::complex<float> randomPokeRun(uint8_t node_id, uint32_t seed) {
+    modal_node_t node;
+    setupNode(&node, node_id, PERSONALITY_SELF_OSCILLATOR);
+    modal_node_seed(&node, seed);
+    poke(&node, 0.8f, -1.0f);
+    for (int step = 0; step < 20; step++) modal_node_step(&node);
+    return modeAmplitude(node, 0);
+}
+
+static void testSeededNoise() {
+    std::cout << "Per-node noise" << std::endl;
+
+    modal_node_t a, b;
+    modal_node_init(&a, 3, PERSONALITY_RESONATOR);
+    modal_node_init(&b, 3, PERSONALITY_RESONATOR);
+    check(modeAmplitude(a, 0) == modeAmplitude(b, 0), "init noise reproducible");
+    modal_node_init(&b, 4, PERSONALITY_RESONATOR);
+    check(modeAmplitude(a, 0) != modeAmplitude(b, 0), "init noise differs per node id");
+
+    // Other callers of rand() must not affect the node
+    std::complex<float> first = randomPokeRun(5, 42);
+    srand(7);
+    (void)rand();
+    check(randomPokeRun(5, 42) == first, "random-phase poke reproducible from seed");
+    check(randomPokeRun(5, 43) != first, "different seed, different phases");
+    check(randomPokeRun(6, 42) != first, "same seed, different node id, different phases");
+}
+
+/**
+ * @brief Node with modes [0, num_modes) active
+ */
+static void setupPrefixNode(modal_node_t* node, uint8_t id, node_personality_t personality,
+                            uint32_t num_modes) {
+    modal_node_init(node, id, personality);
+    float omega = freq_to_omega(110.0f * (1 + id % 5));
+    for (uint32_t k = 0; k < num_modes; k++) {
+        modal_node_set_mode(node, k, omega * (k + 1), 0.5f + 0.2f * k, 1.0f - 0.2f * k);
+    }
+    modal_node_start(node);
+}
+
+static void testSpecializedKernels() {
+    std::cout << "Specialized step kernels vs. modal_bank_step" << std::endl;
+
+    const node_personality_t personalities[] = {PERSONALITY_RESONATOR, PERSONALITY_SELF_OSCILLATOR};
+    bool all_selected = true;
+    float max_err = 0.0f;
+    bool fallback_exact = true;
+
+    for (node_personality_t personality : personalities) {
+        for (uint32_t num_modes = 1; num_modes <= MAX_MODES; num_modes++) {
+            modal_step_kernel_t kernel = modal_step_kernel_select(num_modes, personality);
+            all_selected = all_selected && kernel != modal_bank_step;
+
+            // Node 6 has a mode gap and node 7 the other personality: both
+            // must take the generic path inside the kernel
+            const uint32_t num_nodes = 8;
+            modal_node_t generic[num_nodes], special[num_nodes];
+            modal_node_t* generic_ptrs[num_nodes];
+            modal_node_t* special_ptrs[num_nodes];
+            for (uint32_t i = 0; i < num_nodes; i++) {
+                setupPrefixNode(&generic[i], static_cast<uint8_t>(i), personality, num_modes);
+                if (i == 6 && num_modes < MAX_MODES) {
+                    modal_node_set_mode(&generic[i], MAX_MODES - 1, freq_to_omega(700.0f), 1.0f, 0.5f);
+                } else if (i == 6) {
+                    generic[i].modes[1].params.active = false;
+                }
+                if (i == 7) {
+                    generic[i].personality = personality == PERSONALITY_RESONATOR
+                        ? PERSONALITY_SELF_OSCILLATOR : PERSONALITY_RESONATOR;
+                }
+                poke(&generic[i], 0.8f, -1.0f);     // Random phase: exercises the envelope fallback
+                special[i] = generic[i];
+                generic_ptrs[i] = &generic[i];
+                special_ptrs[i] = &special[i];
+            }
+
+            for (int step = 0; step < 1000; step++) {
+                modal_bank_step(generic_ptrs, num_nodes);
+                kernel(special_ptrs, num_nodes);
+                if (step == 100) {
+                    poke(&generic[2], 0.5f, 1.0f);
+                    poke(&special[2], 0.5f, 1.0f);
+                }
+            }
+
+            for (uint32_t i = 0; i < num_nodes; i++) {
+                for (int k = 0; k < MAX_MODES; k++) {
+                    std::complex<float> a = modeAmplitude(generic[i], k);
+                    float err = std::abs(modeAmplitude(special[i], k) - a) / std::max(std::abs(a), 1e-3f);
+                    max_err = std::max(max_err, err);
+                    if (i >= 6 && modeAmplitude(special[i], k) != a) fallback_exact = false;
+                }
+                if (special[i].step_count != generic[i].step_count) max_err = 1.0f;
+            }
+        }
+    }
+
+    char description[128];
+    check(all_selected, "every mode count and personality has a kernel");
+    snprintf(description, sizeof(description),
+             "matching nodes after 1000 steps: relative error %.2e", max_err);
+    check(max_err < 1e-4f, description);
+    check(fallback_exact, "non-matching nodes take the generic path exactly");
+
+    modal_node_t gap;
+    setupPrefixNode(&gap, 1, PERSONALITY_RESONATOR, 2);
+    modal_node_set_mode(&gap, 3, freq_to_omega(440.0f), 1.0f, 1.0f);
+    check(modal_node_active_prefix(&gap) == 0 && modal_step_kernel_select(0, PERSONALITY_RESONATOR) == modal_bank_step,
+          "mode gap selects the generic kernel");
+}
+
+/**
+ * @brief True if any mode amplitude component is subnormal
+ */
+static bool hasSubnormal(const modal_node_t& node) {
+    for (int k = 0; k < MAX_MODES; k++) {
+        std::complex<float> a = modeAmplitude(node, k);
+        if (std::fpclassify(a.real()) == FP_SUBNORMAL || std::fpclassify(a.imag()) == FP_SUBNORMAL) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void testAmplitudeFloor() {
+    std::cout << "Amplitude floor" << std::endl;
+
+    // Fast-decaying resonator: |a| crosses the floor within ~700 steps
+    modal_node_t generic, special;
+    modal_node_init(&generic, 1, PERSONALITY_RESONATOR);
+    for (int k = 0; k < MAX_MODES; k++) {
+        modal_node_set_mode(&generic, k, freq_to_omega(220.0f * (k + 1)), 20.0f + 5.0f * k, 1.0f);
+    }
+    modal_node_start(&generic);
+    poke(&generic, 1.0f, 0.0f);
+    special = generic;
+
+    modal_node_t* generic_ptr = &generic;
+    modal_node_t* special_ptr = &special;
+    modal_step_kernel_t kernel = modal_step_kernel_select(MAX_MODES, PERSONALITY_RESONATOR);
+
+    bool subnormal = false;
+    for (int step = 0; step < 5000; step++) {
+        modal_bank_step(&generic_ptr, 1);
+        kernel(&special_ptr, 1);
+        subnormal = subnormal || hasSubnormal(generic) || hasSubnormal(special);
+    }
+
+    bool zero = true;
+    for (int k = 0; k < MAX_MODES; k++) {
+        zero = zero && modeAmplitude(generic, k) == std::complex<float>(0.0f, 0.0f) &&
+               modeAmplitude(special, k) == std::complex<float>(0.0f, 0.0f);
+    }
+    check(!subnormal, "no subnormal amplitudes during the decay");
+    check(zero, "decayed modes reach exactly zero (generic and kernel)");
+
+    // A self-oscillator grows away from rest, so a tiny start is kept
+    modal_node_t oscillator;
+    modal_node_init(&oscillator, 2, PERSONALITY_SELF_OSCILLATOR);
+    modal_node_set_mode(&oscillator, 0, freq_to_omega(220.0f), 20.0f, 1.0f);
+    modal_node_start(&oscillator);
+    oscillator.modes[0].a = 0.1f * MODAL_AMPLITUDE_FLOOR;
+    modal_node_t* oscillator_ptr = &oscillator;
+    for (int step = 0; step < 200; step++) modal_bank_step(&oscillator_ptr, 1);
+    check(std::abs(modeAmplitude(oscillator, 0)) > MODAL_AMPLITUDE_FLOOR,
+          "self-oscillator below the floor still starts");
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Modal Attractors - Modal Node Tests" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    testMatchesReference(PERSONALITY_RESONATOR, 1);
+    testMatchesReference(PERSONALITY_RESONATOR, 37);           // Spans several packed passes
+    testMatchesReference(PERSONALITY_SELF_OSCILLATOR, 37);
+    testPropagatorRefresh();
+    testSetFrequencies();
+    testStoppedNodesUntouched();
+    testSeededNoise();
+    testSpecializedKernels();
+    testAmplitudeFloor();
+
+    std::cout << std::endl;
+    if (g_failures == 0) {
+        std::cout << "All modal node tests passed" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::cout << g_failures << " modal node test(s) failed" << std::endl;
+    return EXIT_FAILURE;
+}
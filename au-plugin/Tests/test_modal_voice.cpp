@@ -9,57 +9,9 @@
  */
 
 #include <iostream>
-#include <fstream>
 #include <cmath>
-#include <cstring>
 #include "../src/dsp_core/ModalVoice.h"
-
-// WAV file header structure
-struct WAVHeader {
-    char riff[4] = {'R', 'I', 'F', 'F'};
-    uint32_t file_size;
-    char wave[4] = {'W', 'A', 'V', 'E'};
-    char fmt[4] = {'f', 'm', 't', ' '};
-    uint32_t fmt_size = 16;
-    uint16_t audio_format = 1;  // PCM
-    uint16_t num_channels = 2;  // Stereo
-    uint32_t sample_rate;
-    uint32_t byte_rate;
-    uint16_t block_align;
-    uint16_t bits_per_sample = 16;
-    char data[4] = {'d', 'a', 't', 'a'};
-    uint32_t data_size;
-};
-
-void writeWAV(const char* filename, float* left, float* right, uint32_t num_samples, float sample_rate) {
-    std::ofstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open file: " << filename << std::endl;
-        return;
-    }
-
-    // Prepare header
-    WAVHeader header;
-    header.sample_rate = static_cast<uint32_t>(sample_rate);
-    header.byte_rate = header.sample_rate * header.num_channels * header.bits_per_sample / 8;
-    header.block_align = header.num_channels * header.bits_per_sample / 8;
-    header.data_size = num_samples * header.num_channels * header.bits_per_sample / 8;
-    header.file_size = 36 + header.data_size;
-
-    // Write header
-    file.write(reinterpret_cast<char*>(&header), sizeof(WAVHeader));
-
-    // Write samples (interleaved stereo, 16-bit PCM)
-    for (uint32_t i = 0; i < num_samples; i++) {
-        int16_t sample_l = static_cast<int16_t>(left[i] * 32767.0f);
-        int16_t sample_r = static_cast<int16_t>(right[i] * 32767.0f);
-        file.write(reinterpret_cast<char*>(&sample_l), sizeof(int16_t));
-        file.write(reinterpret_cast<char*>(&sample_r), sizeof(int16_t));
-    }
-
-    file.close();
-    std::cout << "Wrote " << num_samples << " samples to " << filename << std::endl;
-}
+#include "../src/offline/AudioFileWriter.h"
 
 int main(int argc, char* argv[]) {
     std::cout << "========================================" << std::endl;
@@ -99,14 +51,14 @@ int main(int argc, char* argv[]) {
     std::cout << "  Mode 3: " << base_freq * 3.0f << " Hz, damping=1.0, weight=0.3" << std::endl;
     std::cout << std::endl;
 
-    // Allocate output buffers
-    float* output_left = new float[NUM_SAMPLES];
-    float* output_right = new float[NUM_SAMPLES];
+    // Allocate block buffers; audio streams straight to the WAV file
     float* temp_left = new float[BUFFER_SIZE];
     float* temp_right = new float[BUFFER_SIZE];
 
-    memset(output_left, 0, NUM_SAMPLES * sizeof(float));
-    memset(output_right, 0, NUM_SAMPLES * sizeof(float));
+    AudioFileWriter wav;
+    if (!wav.open("test_output.wav", static_cast<uint32_t>(SAMPLE_RATE), 2, AudioSampleFormat::PCM16)) {
+        std::cerr << "Failed to open file: test_output.wav" << std::endl;
+    }
 
     // Trigger note at t=0
     std::cout << "Triggering note on (MIDI 57, velocity 100)..." << std::endl;
@@ -115,6 +67,8 @@ int main(int argc, char* argv[]) {
     // Render audio in blocks
     std::cout << "Rendering audio..." << std::endl;
     uint32_t samples_rendered = 0;
+    float rms = 0.0f;
+    float peak = 0.0f;
 
     while (samples_rendered < NUM_SAMPLES) {
         uint32_t samples_to_render = std::min(BUFFER_SIZE, NUM_SAMPLES - samples_rendered);
@@ -125,9 +79,13 @@ int main(int argc, char* argv[]) {
         // Render audio block
         voice.renderAudio(temp_left, temp_right, samples_to_render);
 
-        // Copy to output buffer
-        memcpy(output_left + samples_rendered, temp_left, samples_to_render * sizeof(float));
-        memcpy(output_right + samples_rendered, temp_right, samples_to_render * sizeof(float));
+        // Write block and accumulate statistics (left channel)
+        wav.writeStereo(temp_left, temp_right, samples_to_render);
+        for (uint32_t i = 0; i < samples_to_render; i++) {
+            rms += temp_left[i] * temp_left[i];
+            float abs_val = fabsf(temp_left[i]);
+            if (abs_val > peak) peak = abs_val;
+        }
 
         samples_rendered += samples_to_render;
 
@@ -141,15 +99,13 @@ int main(int argc, char* argv[]) {
     std::cout << "Rendering complete!" << std::endl;
     std::cout << std::endl;
 
-    // Write to WAV file
-    std::cout << "Writing output to test_output.wav..." << std::endl;
-    writeWAV("test_output.wav", output_left, output_right, NUM_SAMPLES, SAMPLE_RATE);
-
-    // Calculate RMS amplitude
-    float rms = 0.0f;
-    for (uint32_t i = 0; i < NUM_SAMPLES; i++) {
-        rms += output_left[i] * output_left[i];
+    // Finish WAV file
+    if (wav.close()) {
+        std::cout << "Wrote " << wav.getFramesWritten() << " samples to test_output.wav" << std::endl;
+    } else {
+        std::cerr << "Failed to write test_output.wav" << std::endl;
     }
+
     rms = sqrtf(rms / NUM_SAMPLES);
 
     std::cout << std::endl;
@@ -157,14 +113,7 @@ int main(int argc, char* argv[]) {
     std::cout << "Test Results" << std::endl;
     std::cout << "========================================" << std::endl;
     std::cout << "RMS amplitude: " << rms << std::endl;
-    std::cout << "Peak amplitude: ";
-
-    float peak = 0.0f;
-    for (uint32_t i = 0; i < NUM_SAMPLES; i++) {
-        float abs_val = fabsf(output_left[i]);
-        if (abs_val > peak) peak = abs_val;
-    }
-    std::cout << peak << std::endl;
+    std::cout << "Peak amplitude: " << peak << std::endl;
 
     // Check if output is non-zero
     if (rms > 0.001f) {
@@ -174,8 +123,6 @@ int main(int argc, char* argv[]) {
     }
 
     // Cleanup
-    delete[] output_left;
-    delete[] output_right;
     delete[] temp_left;
     delete[] temp_right;
 
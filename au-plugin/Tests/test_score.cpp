@@ -0,0 +1,130 @@
+/**
+ * @file test_score.cpp
+ * @brief Tests for offline score loading (CSV and Standard MIDI File)
+ *
+ * Parses the experiments' CSV format and small hand-built MIDI images
+ * (running status, zero-velocity note offs, tempo changes, two tracks)
+ * and checks the resulting event times and order.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <sstream>
+#include <vector>
+#include "../src/offline/Score.h"
+
+static int g_failures = 0;
+
+static void check(bool condition, const char* description) {
+    if (condition) {
+        std::cout << "  ✓ " << description << std::endl;
+    } else {
+        std::cout << "  ✗ FAILED: " << description << std::endl;
+        g_failures++;
+    }
+}
+
+static bool near(double a, double b) {
+    return std::fabs(a - b) < 1e-6;
+}
+
+static void testCsv() {
+    std::cout << "CSV score" << std::endl;
+
+    std::istringstream text(
+        "t_on,dur,node,note,velocity\n"
+        "0.50,0.25,1,64,0.5\n"
+        "0.00,0.50,0,57,1.0\n"
+        "\n"
+        "1.00,0.00,2,69,0.7\n"      // Zero duration: skipped
+        "0.50,0.50,3,57,0.8\n");    // Retrigger right at note 57's off
+    Score score;
+    std::string error;
+    check(score.loadCsv(text, &error), "parses");
+
+    const std::vector<ScoreEvent>& events = score.getEvents();
+    check(events.size() == 6, "3 notes → 6 events");
+    check(events.size() == 6 && events[0].note == 57 && events[0].note_on && events[0].velocity == 127,
+          "first event: note 57 on at velocity 127");
+    check(events.size() == 6 && near(events[1].time, 0.5) && !events[1].note_on && events[1].note == 57,
+          "note off sorts before note ons at the same time");
+    check(events.size() == 6 && events[2].note_on && events[2].velocity == 64,
+          "velocity 0.5 → 64");
+    check(near(score.getDuration(), 1.0), "duration is the last note off");
+
+    std::istringstream bad("time,note\n0,60\n");
+    check(!score.loadCsv(bad, &error) && !error.empty(), "missing columns rejected with an error");
+}
+
+static void appendTrack(std::vector<uint8_t>& file, const std::vector<uint8_t>& events) {
+    const uint8_t id[] = {'M', 'T', 'r', 'k'};
+    file.insert(file.end(), id, id + 4);
+    uint32_t length = static_cast<uint32_t>(events.size());
+    file.push_back(length >> 24);
+    file.push_back(length >> 16);
+    file.push_back(length >> 8);
+    file.push_back(length);
+    file.insert(file.end(), events.begin(), events.end());
+}
+
+static std::vector<uint8_t> midiHeader(uint16_t format, uint16_t num_tracks, uint16_t division) {
+    return {'M', 'T', 'h', 'd', 0, 0, 0, 6,
+            0, static_cast<uint8_t>(format),
+            0, static_cast<uint8_t>(num_tracks),
+            static_cast<uint8_t>(division >> 8), static_cast<uint8_t>(division)};
+}
+
+static void testMidi() {
+    std::cout << "Standard MIDI File" << std::endl;
+
+    // Format 1, 480 ticks per quarter. Track 0: tempo 1 s/quarter after one
+    // beat at the default 120 BPM. Track 1: notes with running status.
+    std::vector<uint8_t> file = midiHeader(1, 2, 480);
+    appendTrack(file, {
+        0x83, 0x60, 0xFF, 0x51, 0x03, 0x0F, 0x42, 0x40,    // +480: tempo 1,000,000 µs
+        0x00, 0xFF, 0x2F, 0x00
+    });
+    appendTrack(file, {
+        0x00, 0x90, 60, 100,            // 0: note 60 on
+        0x83, 0x60, 60, 0,              // +480 (0.5 s): running status, velocity 0 = off
+        0x00, 62, 90,                   // 0.5 s: note 62 on
+        0x83, 0x60, 0x80, 62, 64,       // +480 at 1 s/quarter (1.5 s): note 62 off
+        0x00, 0xFF, 0x2F, 0x00
+    });
+
+    Score score;
+    std::string error;
+    check(score.loadMidi(file.data(), file.size(), &error), "parses");
+
+    const std::vector<ScoreEvent>& events = score.getEvents();
+    check(events.size() == 4, "4 note events");
+    check(events.size() == 4 && events[0].note == 60 && events[0].note_on && events[0].velocity == 100,
+          "note 60 on at 0 s");
+    check(events.size() == 4 && near(events[1].time, 0.5) && !events[1].note_on,
+          "zero-velocity note on is a note off at 0.5 s");
+    check(events.size() == 4 && events[2].note == 62 && events[2].velocity == 90,
+          "running status note on");
+    check(events.size() == 4 && near(events[3].time, 1.5), "tempo change applies from its tick");
+
+    std::vector<uint8_t> truncated(file.begin(), file.end() - 6);
+    check(!score.loadMidi(truncated.data(), truncated.size(), &error), "truncated file rejected");
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Modal Attractors - Score Tests" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    testCsv();
+    testMidi();
+
+    std::cout << std::endl;
+    if (g_failures == 0) {
+        std::cout << "All score tests passed" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::cout << g_failures << " score test(s) failed" << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,366 @@
+/**
+ * @file test_topology.cpp
+ * @brief Tests for TopologyEngine adjacency and coupling
+ *
+ * Checks edge counts and row normalization of the generated topologies,
+ * seeded generation, in-place edge edits and morphs, and that
+ * updateCoupling() applies the complex diffusive ring coupling, computed
+ * independently from the voices' mode amplitudes, to every mode.
+ */
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <complex>
+#include <algorithm>
+#include <thread>
+#include "../src/dsp_core/TopologyEngine.h"
+#include "../src/dsp_core/VoiceAllocator.h"
+
+static int g_failures = 0;
+
+static void check(bool condition, const char* description) {
+    if (condition) {
+        std::cout << "  ✓ " << description << std::endl;
+    } else {
+        std::cout << "  ✗ FAILED: " << description << std::endl;
+        g_failures++;
+    }
+}
+
+/**
+ * @brief Every non-empty row sums to 1 and edges are symmetric
+ */
+static bool isNormalizedAndSymmetric(const TopologyEngine& topology, uint32_t num_voices) {
+    for (uint32_t i = 0; i < num_voices; i++) {
+        float sum = 0.0f;
+        for (uint32_t j = 0; j < num_voices; j++) {
+            float w = topology.getCouplingWeight(i, j);
+            sum += w;
+            if ((w > 0.0f) != (topology.getCouplingWeight(j, i) > 0.0f)) return false;
+        }
+        if (topology.getDegree(i) > 0 && fabsf(sum - 1.0f) > 1e-5f) return false;
+    }
+    return true;
+}
+
+static void testEdgeCounts() {
+    std::cout << "Topology edge counts" << std::endl;
+
+    const uint32_t sizes[] = {8, 64, 256};
+    for (uint32_t n : sizes) {
+        TopologyEngine topology(n);
+        char description[160];
+
+        topology.generateTopology(TopologyType::Ring, 0.3f);
+        snprintf(description, sizeof(description), "ring, %u voices: %u edges", n,
+                 topology.getEdgeCount());
+        check(topology.getEdgeCount() == 2 * n && isNormalizedAndSymmetric(topology, n), description);
+
+        topology.generateTopology(TopologyType::HubSpoke, 0.3f);
+        snprintf(description, sizeof(description), "hub-spoke, %u voices: %u edges", n,
+                 topology.getEdgeCount());
+        check(topology.getEdgeCount() == 2 * (n - 1) && topology.getDegree(0) == n - 1 &&
+              isNormalizedAndSymmetric(topology, n), description);
+
+        topology.generateTopology(TopologyType::Complete, 0.3f);
+        snprintf(description, sizeof(description), "complete, %u voices: %u edges", n,
+                 topology.getEdgeCount());
+        check(topology.getEdgeCount() == n * (n - 1) && isNormalizedAndSymmetric(topology, n),
+              description);
+
+        topology.setTopologyParameter(0.2f);
+        topology.generateTopology(TopologyType::SmallWorld, 0.3f);
+        snprintf(description, sizeof(description), "small-world, %u voices: %u edges", n,
+                 topology.getEdgeCount());
+        check(topology.getEdgeCount() <= 2 * n && isNormalizedAndSymmetric(topology, n), description);
+
+        topology.generateTopology(TopologyType::None, 0.3f);
+        check(topology.getEdgeCount() == 0, "  none: no edges");
+    }
+}
+
+/**
+ * @brief Same normalized weights in both topologies
+ */
+static bool sameWeights(const TopologyEngine& a, const TopologyEngine& b, uint32_t num_voices) {
+    for (uint32_t i = 0; i < num_voices; i++) {
+        for (uint32_t j = 0; j < num_voices; j++) {
+            if (fabsf(a.getCouplingWeight(i, j) - b.getCouplingWeight(i, j)) > 1e-6f) return false;
+        }
+    }
+    return true;
+}
+
+static void testSeededGeneration() {
+    std::cout << "Seeded generation" << std::endl;
+
+    const uint32_t n = 32;
+    TopologyEngine a(n), b(n), c(n);
+    a.setTopologyParameter(0.3f);
+    b.setTopologyParameter(0.3f);
+    c.setTopologyParameter(0.3f);
+    a.setSeed(7);
+    b.setSeed(7);
+    c.setSeed(8);
+
+    a.generateTopology(TopologyType::Random, 0.3f);
+    rand();     // Global rand() has no effect
+    b.generateTopology(TopologyType::Random, 0.3f);
+    c.generateTopology(TopologyType::Random, 0.3f);
+    check(sameWeights(a, b, n), "same seed gives the same random graph");
+    check(!sameWeights(a, c, n), "different seed gives a different graph");
+
+    b.generateTopology(TopologyType::Ring, 0.3f);
+    b.generateTopology(TopologyType::Random, 0.3f);
+    check(sameWeights(a, b, n), "regenerating after another type gives the same graph");
+}
+
+static void testEdgeEdits() {
+    std::cout << "Edge edits" << std::endl;
+
+    const uint32_t n = 8;
+    TopologyEngine topology(n);
+    topology.generateTopology(TopologyType::Ring, 0.3f);
+
+    check(topology.setEdgeWeight(0, 4, 2.0f), "add edge 4 → 0");
+    check(topology.getEdgeCount() == 2 * n + 1 && topology.getDegree(0) == 3, "edge count and degree grow");
+    check(fabsf(topology.getCouplingWeight(0, 4) - 0.5f) < 1e-6f &&
+          fabsf(topology.getCouplingWeight(0, 1) - 0.25f) < 1e-6f, "row 0 renormalized by raw weight");
+    check(topology.getCouplingWeight(4, 0) == 0.0f, "edit is directed");
+    check(fabsf(topology.getCouplingWeight(1, 0) - 0.5f) < 1e-6f, "other rows untouched");
+
+    topology.setEdgeWeight(0, 1, 4.0f);
+    check(fabsf(topology.getCouplingWeight(0, 1) - 4.0f / 7.0f) < 1e-6f &&
+          topology.getEdgeWeight(0, 1) == 4.0f, "reweight keeps raw weight");
+
+    check(topology.removeEdge(0, 4) && topology.removeEdge(0, 5), "remove edge (absent edge is a no-op)");
+    check(topology.getEdgeCount() == 2 * n && fabsf(topology.getCouplingWeight(0, 1) - 0.8f) < 1e-6f,
+          "removal renormalizes row 0");
+
+    topology.setUndirectedEdgeWeight(2, 6, 1.0f);
+    check(isNormalizedAndSymmetric(topology, n), "undirected edit keeps rows normalized and symmetric");
+    check(!topology.setEdgeWeight(3, 3, 1.0f) && !topology.setEdgeWeight(0, n, 1.0f),
+          "self loops and out-of-range voices rejected");
+}
+
+static void testMorph() {
+    std::cout << "Topology morph" << std::endl;
+
+    const uint32_t n = 8;
+    TopologyEngine topology(n), ring(n), complete(n), none(n);
+    topology.generateTopology(TopologyType::Ring, 0.3f);
+    ring.generateTopology(TopologyType::Ring, 0.3f);
+    complete.generateTopology(TopologyType::Complete, 0.3f);
+    none.generateTopology(TopologyType::None, 0.3f);
+
+    const float duration = 0.1f;
+    check(topology.morphTo(complete, duration) && topology.isMorphing(), "morph starts");
+    check(sameWeights(topology, ring, n), "weights unchanged before the first step");
+
+    // Steps move each weight by at most |to - from| · dt / duration
+    float max_step = 0.0f;
+    bool normalized = true;
+    float previous = topology.getCouplingWeight(0, 1);
+    uint32_t steps = 0;
+    while (topology.isMorphing() && steps < 1000) {
+        topology.advanceMorph(CONTROL_DT);
+        float w = topology.getCouplingWeight(0, 1);
+        max_step = std::max(max_step, fabsf(w - previous));
+        previous = w;
+        normalized = normalized && isNormalizedAndSymmetric(topology, n);
+        steps++;
+    }
+
+    char description[160];
+    snprintf(description, sizeof(description), "finishes after %u control steps", steps);
+    check(steps == static_cast<uint32_t>(lroundf(duration / CONTROL_DT)), description);
+    check(normalized, "rows stay normalized throughout");
+    check(max_step <= (0.5f - 1.0f / 7.0f) * CONTROL_DT / duration + 1e-6f, "weights change smoothly");
+    check(sameWeights(topology, complete, n) && topology.getEdgeCount() == n * (n - 1),
+          "ends on target weights");
+
+    // Fade out to no coupling, then back in from it: total weight ramps
+    topology.morphTo(none, duration);
+    topology.advanceMorph(duration * 0.5f);
+    float sum = 0.0f;
+    for (uint32_t j = 0; j < n; j++) sum += topology.getCouplingWeight(0, j);
+    check(fabsf(sum - 0.5f) < 1e-5f, "half way to none: row weight 0.5");
+    topology.advanceMorph(duration);
+    check(topology.getEdgeCount() == 0, "faded-out edges removed");
+
+    topology.morphTo(ring, duration);
+    topology.advanceMorph(duration * 0.25f);
+    check(fabsf(topology.getCouplingWeight(3, 4) - 0.125f) < 1e-6f, "fade in from no edges ramps");
+
+    // Re-targeting mid-morph continues from the current weights
+    float before = topology.getCouplingWeight(3, 4);
+    topology.morphTo(complete, duration);
+    check(topology.getCouplingWeight(3, 4) == before, "re-targeting starts from current weights");
+
+    // Edits end the morph on the edited row only
+    topology.setEdgeWeight(3, 0, 0.0f);
+    check(topology.getDegree(3) == n - 2 && fabsf(topology.getCouplingWeight(3, 4) - 1.0f / (n - 2)) < 1e-6f,
+          "edit lands row on target, then applies");
+    check(topology.isMorphing() && topology.getCouplingWeight(5, 4) == before, "other rows keep morphing");
+
+    topology.morphTo(ring, 0.0f);
+    check(!topology.isMorphing() && sameWeights(topology, ring, n), "zero duration switches immediately");
+
+    TopologyEngine other(n + 1);
+    check(!topology.morphTo(other, duration), "voice count mismatch rejected");
+}
+
+/**
+ * @brief Complex amplitude of mode k (C99 complex layout {re, im})
+ */
+static std::complex<float> modeAmplitude(const ModalVoice* voice, int k) {
+    const float* a = reinterpret_cast<const float*>(&voice->getNode()->modes[k].a);
+    return std::complex<float>(a[0], a[1]);
+}
+
+/**
+ * @brief Allocator with seven self-oscillating voices and one silent slot
+ */
+static void playChord(VoiceAllocator& allocator, uint32_t num_voices) {
+    allocator.initialize(48000.0f);
+    allocator.setPersonality(PERSONALITY_SELF_OSCILLATOR);
+    for (uint32_t v = 0; v < num_voices - 1; v++) {
+        allocator.noteOn(static_cast<uint8_t>(48 + v), 100);
+    }
+    for (int i = 0; i < 50; i++) allocator.updateVoices();
+}
+
+static void testRingCoupling() {
+    std::cout << "Ring coupling" << std::endl;
+
+    const uint32_t num_voices = 8;
+    const float strength = 0.4f;
+
+    // One slot left silent: its ring neighbors must not hear it
+    VoiceAllocator allocator(num_voices);
+    playChord(allocator, num_voices);
+
+    TopologyEngine topology(num_voices);
+    topology.generateTopology(TopologyType::Ring, strength);
+
+    ModalVoice** voices = allocator.getVoices();
+    std::complex<float> before[num_voices][MAX_MODES];
+    uint32_t silent = 0;
+    for (uint32_t v = 0; v < num_voices; v++) {
+        for (int k = 0; k < MAX_MODES; k++) before[v][k] = modeAmplitude(voices[v], k);
+        if (!voices[v]->isAwake()) silent++;
+    }
+
+    topology.updateCoupling(voices, num_voices, allocator.getActiveVoices(),
+                            allocator.getActiveVoiceCount());
+
+    float max_err = 0.0f;
+    float max_phase_kick = 0.0f;
+    for (uint32_t i = 0; i < num_voices; i++) {
+        if (!voices[i]->isAwake()) continue;
+        const uint32_t neighbors[2] = {(i + num_voices - 1) % num_voices, (i + 1) % num_voices};
+        float scale = voices[i]->getNode()->coupling_strength * CONTROL_DT;
+        for (int k = 0; k < MAX_MODES; k++) {
+            std::complex<float> input = 0.0f;
+            for (uint32_t j : neighbors) {
+                if (voices[j]->isAwake()) input += strength * 0.5f * (before[j][k] - before[i][k]);
+            }
+            std::complex<float> expected = before[i][k] + scale * input;
+            max_err = std::max(max_err, std::abs(modeAmplitude(voices[i], k) - expected));
+            max_phase_kick = std::max(max_phase_kick, std::abs(input.imag()) * scale);
+        }
+    }
+
+    char description[160];
+    snprintf(description, sizeof(description),
+             "every mode moves by the complex diffusive ring input (max error %.2e)", max_err);
+    check(silent == 1 && max_err < 1e-6f, description);
+    check(max_phase_kick > 0.0f, "coupling keeps the phase of the difference");
+}
+
+static void testPhasedCoupling() {
+    std::cout << "Snapshot / compute / apply phases" << std::endl;
+
+    const uint32_t num_voices = 8;
+    VoiceAllocator reference(num_voices), phased(num_voices);
+    playChord(reference, num_voices);
+    playChord(phased, num_voices);
+
+    TopologyEngine topology(num_voices);
+    topology.setSeed(7);
+    topology.generateTopology(TopologyType::Random, 0.6f);
+
+    const uint16_t* active = phased.getActiveVoices();
+    const uint32_t num_active = phased.getActiveVoiceCount();
+    const uint32_t half = num_active / 2;
+
+    bool identical = true;
+    for (int tick = 0; tick < 20; tick++) {
+        topology.updateCoupling(reference.getVoices(), num_voices, reference.getActiveVoices(),
+                                reference.getActiveVoiceCount());
+
+        // Second half first, on two threads: the result must not change
+        topology.snapshotCoupling(phased.getVoices(), num_voices);
+        std::thread upper([&] { topology.computeCoupling(active, half, num_active - half); });
+        std::thread lower([&] { topology.computeCoupling(active, 0, half); });
+        upper.join();
+        lower.join();
+        topology.applyCoupling(phased.getVoices(), active, num_active);
+
+        for (uint32_t v = 0; v < num_voices; v++) {
+            for (int k = 0; k < MAX_MODES; k++) {
+                identical &= modeAmplitude(reference.getVoices()[v], k) ==
+                             modeAmplitude(phased.getVoices()[v], k);
+            }
+        }
+        reference.updateVoices();
+        phased.updateVoices();
+    }
+    check(identical, "split, reordered, threaded compute matches updateCoupling bit for bit");
+
+    // Inputs come from the snapshot, not from voices already updated this tick
+    ModalVoice** voices = phased.getVoices();
+    std::complex<float> snapshot[num_voices][MAX_MODES];
+    for (uint32_t v = 0; v < num_voices; v++) {
+        for (int k = 0; k < MAX_MODES; k++) snapshot[v][k] = modeAmplitude(voices[v], k);
+    }
+    topology.snapshotCoupling(voices, num_voices);
+    topology.computeCoupling(active, 0, num_active);
+    topology.applyCoupling(voices, active, num_active);
+
+    float max_err = 0.0f;
+    for (uint32_t n = 0; n < num_active; n++) {
+        uint32_t i = active[n];
+        float scale = voices[i]->getNode()->coupling_strength * CONTROL_DT;
+        for (int k = 0; k < MAX_MODES; k++) {
+            std::complex<float> expected = snapshot[i][k] + scale * topology.getCouplingInput(i, k);
+            max_err = std::max(max_err, std::abs(modeAmplitude(voices[i], k) - expected));
+        }
+    }
+    check(max_err < 1e-6f, "each voice moves by exactly its computed input");
+    check(!topology.snapshotCoupling(voices, num_voices - 1), "mismatched voice count is rejected");
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Modal Attractors - Topology Tests" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    testEdgeCounts();
+    testSeededGeneration();
+    testEdgeEdits();
+    testMorph();
+    testRingCoupling();
+    testPhasedCoupling();
+
+    std::cout << std::endl;
+    if (g_failures == 0) {
+        std::cout << "All topology tests passed" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::cout << g_failures << " topology test(s) failed" << std::endl;
+    return EXIT_FAILURE;
+}
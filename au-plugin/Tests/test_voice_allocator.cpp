@@ -0,0 +1,459 @@
+/**
+ * @file test_voice_allocator.cpp
+ * @brief Tests for VoiceAllocator voice bookkeeping
+ *
+ * Checks that the active-index list always matches the voices' own
+ * state through note on/off, natural release, stealing and retrigger,
+ * that each stealing policy picks the expected voice, that a stolen note
+ * fades out instead of cutting, that the CPU budget sheds voices with a
+ * fade and settles under a moderate overload, that held resonators go dormant and wake,
+ * that the pitch tables and cached mode ratios tune voices correctly, and
+ * that mode parameter automation ramps linearly at control rate.
+ */
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include "../src/dsp_core/VoiceAllocator.h"
+#include "../src/dsp_core/TopologyEngine.h"
+#include "../src/dsp_core/PitchTables.h"
+
+static int g_failures = 0;
+
+static void check(bool condition, const char* description) {
+    if (condition) {
+        std::cout << "  ✓ " << description << std::endl;
+    } else {
+        std::cout << "  ✗ FAILED: " << description << std::endl;
+        g_failures++;
+    }
+}
+
+/**
+ * @brief Active list holds exactly the active voices, each once
+ */
+static bool activeListConsistent(VoiceAllocator& allocator) {
+    uint32_t num_active = allocator.getActiveVoiceCount();
+    const uint16_t* active = allocator.getActiveVoices();
+
+    // Note voices, then the steal fade voices
+    uint32_t expected = 0;
+    for (uint32_t i = 0; allocator.getVoice(i); i++) {
+        if (allocator.getVoice(i)->isActive()) expected++;
+    }
+    if (expected != num_active) return false;
+
+    for (uint32_t n = 0; n < num_active; n++) {
+        ModalVoice* voice = allocator.getVoice(active[n]);
+        if (!voice || !voice->isActive()) return false;
+        for (uint32_t m = n + 1; m < num_active; m++) {
+            if (active[m] == active[n]) return false;
+        }
+    }
+    return true;
+}
+
+static void testNoteOnOffRelease() {
+    std::cout << "Note on / release" << std::endl;
+
+    VoiceAllocator allocator(64);
+    allocator.initialize(48000.0f);
+
+    for (uint8_t note = 60; note < 68; note++) allocator.noteOn(note, 100);
+    check(allocator.getActiveVoiceCount() == 8 && activeListConsistent(allocator),
+          "8 notes on: 8 active voices of 64");
+
+    allocator.noteOn(62, 80);
+    check(allocator.getActiveVoiceCount() == 8, "retrigger reuses the voice");
+
+    for (uint8_t note = 60; note < 64; note++) allocator.noteOff(note);
+    check(allocator.getActiveVoiceCount() == 8, "released voices sound until quiet");
+
+    // Resonator release decays below threshold well within 10 s
+    for (int i = 0; i < 5000 && allocator.getActiveVoiceCount() > 4; i++) {
+        allocator.updateVoices();
+        if (!activeListConsistent(allocator)) break;
+    }
+    check(allocator.getActiveVoiceCount() == 4 && activeListConsistent(allocator),
+          "quiet voices leave the active list");
+
+    for (uint8_t note = 70; note < 74; note++) allocator.noteOn(note, 100);
+    check(allocator.getActiveVoiceCount() == 8 && activeListConsistent(allocator),
+          "freed voices are reallocated");
+
+    allocator.allNotesOff();
+    for (int i = 0; i < 5000 && allocator.getActiveVoiceCount() > 0; i++) allocator.updateVoices();
+    check(allocator.getActiveVoiceCount() == 0 && activeListConsistent(allocator),
+          "all notes off: every voice returns to the free list");
+}
+
+static void testStealing() {
+    std::cout << "Voice stealing" << std::endl;
+
+    VoiceAllocator allocator(4);
+    allocator.initialize(48000.0f);
+    allocator.setPersonality(PERSONALITY_SELF_OSCILLATOR);
+
+    for (uint8_t note = 60; note < 64; note++) {
+        allocator.noteOn(note, 100);
+        allocator.updateVoices();
+    }
+
+    ModalVoice* stolen = allocator.noteOn(72, 100);
+    check(stolen != nullptr && stolen->getMIDINote() == 72 && activeListConsistent(allocator),
+          "fifth note steals a voice");
+    check(allocator.getActiveVoiceCount() == 5 && allocator.getVoice(4)->isFading() &&
+          allocator.getVoice(4)->getMIDINote() == 60,
+          "  stolen note fades out in a steal fade voice");
+
+    // Note 60 was the oldest; its note-off must not release the new note
+    allocator.noteOff(60);
+    check(stolen->getState() != ModalVoice::State::Release, "  stolen note's note-off is ignored");
+
+    for (int i = 0; i < 100; i++) allocator.updateVoices();
+    check(allocator.getActiveVoiceCount() == 4 && activeListConsistent(allocator),
+          "  fade voice freed once silent");
+}
+
+/**
+ * @brief Render one voice into a block after num_blocks blocks of note 60
+ */
+static void renderAfter(VoiceAllocator& allocator, int num_blocks, float* out, uint32_t block_size) {
+    float scratch[96];
+    for (int b = 0; b < num_blocks; b++) {
+        allocator.updateVoices();
+        allocator.renderAudio(out, scratch, block_size);
+    }
+}
+
+static void testStealFade() {
+    std::cout << "Steal without a click" << std::endl;
+
+    // Same self-oscillating note in both; one has it stolen mid-note
+    const uint32_t block_size = 96;
+    VoiceAllocator stealing(1);
+    VoiceAllocator reference(1);
+    VoiceAllocator* allocators[2] = {&stealing, &reference};
+    for (VoiceAllocator* allocator : allocators) {
+        allocator->initialize(48000.0f, block_size);
+        allocator->setPersonality(PERSONALITY_SELF_OSCILLATOR);
+        allocator->noteOn(60, 127);
+    }
+
+    float out[96];
+    float ref[96];
+    renderAfter(stealing, 200, out, block_size);
+    renderAfter(reference, 200, ref, block_size);
+
+    float peak = 0.0f;
+    for (uint32_t n = 0; n < block_size; n++) peak = std::max(peak, std::fabs(ref[n]));
+
+    stealing.noteOn(72, 127);
+    renderAfter(stealing, 1, out, block_size);
+    renderAfter(reference, 1, ref, block_size);
+
+    // The old note continues where it was; the new one rises from silence
+    float jump = std::fabs(out[0] - ref[0]);
+    char description[96];
+    snprintf(description, sizeof(description),
+             "old note continues through the steal (step %.4f of peak %.3f)", jump, peak);
+    check(peak > 0.0f && jump < 0.1f * peak, description);
+    check(stealing.getStealCount() == 1, "  counted as a steal");
+}
+
+/**
+ * @brief Four self-oscillators (notes 60..63, note 60 oldest), notes 61 and 63 released
+ */
+static void setupStealScenario(VoiceAllocator& allocator) {
+    allocator.initialize(48000.0f, 96);
+    allocator.setPersonality(PERSONALITY_SELF_OSCILLATOR);
+
+    const uint8_t velocities[] = {100, 30, 127, 90};
+    for (uint8_t n = 0; n < 4; n++) {
+        allocator.noteOn(60 + n, velocities[n]);
+        for (int i = 0; i < 5; i++) allocator.updateVoices();
+    }
+    allocator.noteOff(61);
+    allocator.noteOff(63);
+    allocator.updateVoices();
+}
+
+static uint8_t stolenNote(StealPolicy policy) {
+    VoiceAllocator allocator(4);
+    setupStealScenario(allocator);
+    allocator.setStealPolicy(policy);
+    allocator.setNotePriority(62, 10);
+
+    // Snapshot notes before the steal overwrites the voice
+    uint8_t notes[4];
+    for (uint32_t i = 0; i < 4; i++) notes[i] = allocator.getVoice(i)->getMIDINote();
+
+    ModalVoice* voice = allocator.noteOn(72, 100);
+    for (uint32_t i = 0; i < 4; i++) {
+        if (allocator.getVoice(i) == voice) return notes[i];
+    }
+    return 0;
+}
+
+static void testStealPolicies() {
+    std::cout << "Stealing policies" << std::endl;
+
+    // Quietest: the self-oscillators settle to the same level, so compare
+    // against the allocator's own view right before the steal
+    VoiceAllocator probe(4);
+    setupStealScenario(probe);
+    uint8_t quietest_note = 0;
+    float quietest = 2.0f;
+    for (uint32_t i = 0; i < 4; i++) {
+        ModalVoice* voice = probe.getVoice(i);
+        if (voice->getAmplitude() < quietest) {
+            quietest = voice->getAmplitude();
+            quietest_note = voice->getMIDINote();
+        }
+    }
+
+    check(stolenNote(StealPolicy::Oldest) == 60, "oldest steals note 60");
+    check(stolenNote(StealPolicy::ReleasedFirst) == 61, "released-first steals oldest released (61)");
+    check(stolenNote(StealPolicy::LowestPriority) == 62, "lowest priority steals note 62");
+    check(stolenNote(StealPolicy::Quietest) == quietest_note, "quietest steals the quietest voice");
+}
+
+static void testCpuBudget() {
+    std::cout << "CPU budget" << std::endl;
+
+    VoiceAllocator allocator(8);
+    allocator.initialize(48000.0f, 96);
+    allocator.setPersonality(PERSONALITY_SELF_OSCILLATOR);
+    for (uint8_t note = 60; note < 68; note++) allocator.noteOn(note, 100);
+
+    float outL[96];
+    float outR[96];
+
+    // Any measurable render time exceeds this budget (each drop waits for
+    // the shed voice's fade and a few renders to measure again)
+    allocator.setCpuBudget(1e-9f);
+    for (int b = 0; b < 400; b++) {
+        allocator.updateVoices();
+        allocator.renderAudio(outL, outR, 96);
+    }
+    check(allocator.getVoiceCap() == 1, "cap shrinks to one voice");
+    check(allocator.getActiveVoiceCount() == 1 && activeListConsistent(allocator),
+          "  voices over the cap faded out and freed");
+
+    allocator.noteOn(70, 100);
+    check(allocator.getStealCount() == 1 && allocator.getActiveVoiceCount() == 2 &&
+          allocator.getVoice(8)->isFading(), "  note on at the cap steals");
+    for (int i = 0; i < 100; i++) allocator.updateVoices();
+
+    allocator.setCpuBudget(0.0f);
+    check(allocator.getVoiceCap() == 8, "disabling the budget restores the cap");
+    allocator.noteOn(71, 100);
+    check(allocator.getActiveVoiceCount() == 2, "  new notes take free voices again");
+}
+
+/**
+ * @brief Report a modelled render time per event sub-block, a control tick
+ *        per block (every active voice, fading or not, costs voice_load)
+ * @return Lowest voice cap seen
+ */
+static uint32_t reportSubBlocks(VoiceAllocator& allocator, int num_blocks, float voice_load) {
+    uint32_t min_cap = allocator.getVoiceCap();
+    for (int b = 0; b < num_blocks; b++) {
+        allocator.updateVoices();
+        for (int s = 0; s < 4; s++) {
+            double seconds = voice_load * allocator.getActiveVoiceCount() * 24 / 48000.0;
+            allocator.updateVoiceCap(seconds, 24);
+            min_cap = std::min(min_cap, allocator.getVoiceCap());
+        }
+    }
+    return min_cap;
+}
+
+static void testCpuBudgetModerate() {
+    std::cout << "CPU budget, moderate overload" << std::endl;
+
+    VoiceAllocator allocator(8);
+    allocator.initialize(48000.0f, 96);
+    allocator.setPersonality(PERSONALITY_SELF_OSCILLATOR);
+    for (uint8_t note = 60; note < 68; note++) allocator.noteOn(note, 100);
+
+    // Four of the eight voices fit; several renders a tick must not each
+    // drop the cap while the shed voices fade
+    allocator.setCpuBudget(0.48f);
+    uint32_t min_cap = reportSubBlocks(allocator, 1000, 0.1f);
+
+    char description[96];
+    snprintf(description, sizeof(description), "cap settles at the voices that fit (lowest %u, now %u of 8)",
+             min_cap, allocator.getVoiceCap());
+    check(min_cap == 4 && allocator.getVoiceCap() == 4, description);
+    check(allocator.getShedCount() == 4 && allocator.getActiveVoiceCount() == 4 &&
+          activeListConsistent(allocator), "  voices over the cap shed");
+}
+
+/**
+ * @brief Step until the voice goes dormant (at most 20 s of control ticks)
+ */
+static bool runUntilDormant(VoiceAllocator& allocator, ModalVoice* voice) {
+    for (int i = 0; i < 10000 && !voice->isDormant(); i++) allocator.updateVoices();
+    return voice->isDormant();
+}
+
+static void testDormantVoices() {
+    std::cout << "Dormant voices" << std::endl;
+
+    VoiceAllocator allocator(4);
+    allocator.initialize(48000.0f, 96);
+    allocator.setSilenceThreshold(0.02f);
+
+    ModalVoice* voice = allocator.noteOn(60, 100);
+    check(runUntilDormant(allocator, voice), "held resonator goes dormant");
+    check(allocator.getActiveVoiceCount() == 1 && activeListConsistent(allocator),
+          "  dormant voice keeps its slot");
+
+    uint32_t step_count = voice->getNode()->step_count;
+    float outL[96];
+    float outR[96];
+    allocator.updateVoices();
+    allocator.renderAudio(outL, outR, 96);
+    bool silent = true;
+    for (int n = 0; n < 96; n++) {
+        if (outL[n] != 0.0f) silent = false;
+    }
+    check(silent && voice->getNode()->step_count == step_count, "  not stepped or rendered");
+
+    allocator.noteOn(60, 100);
+    check(voice->isAwake(), "  retrigger wakes it");
+
+    check(runUntilDormant(allocator, voice), "  goes dormant again");
+    allocator.noteOff(60);
+    for (int i = 0; i < 10 && allocator.getActiveVoiceCount() > 0; i++) allocator.updateVoices();
+    check(allocator.getActiveVoiceCount() == 0 && activeListConsistent(allocator),
+          "  note off releases a dormant voice");
+
+    // Coupling from a freshly struck neighbor wakes a dormant voice...
+    TopologyEngine topology(4);
+    topology.generateTopology(TopologyType::Complete, 1.0f);
+
+    voice = allocator.noteOn(60, 100);
+    check(runUntilDormant(allocator, voice), "  dormant before coupling");
+    allocator.noteOn(67, 127);
+    allocator.updateVoices();
+
+    topology.updateCoupling(allocator.getVoices(), 4,
+                            allocator.getActiveVoices(), allocator.getActiveVoiceCount());
+    check(voice->isDormant(), "  coupling kick below threshold ignored");
+
+    voice->setSilenceThreshold(1e-6f);
+    topology.updateCoupling(allocator.getVoices(), 4,
+                            allocator.getActiveVoices(), allocator.getActiveVoiceCount());
+    check(voice->isAwake(), "  coupling kick above threshold wakes it");
+}
+
+static float relativeError(float value, double expected) {
+    return static_cast<float>(std::fabs(value - expected) / expected);
+}
+
+static void testTuning() {
+    std::cout << "Pitch tables and mode tuning" << std::endl;
+
+    const double two_pi = 6.283185307179586;
+    float note_err = 0.0f;
+    for (int n = 0; n <= 127; n++) {
+        double expected = two_pi * 440.0 * std::pow(2.0, (n - 69) / 12.0);
+        note_err = std::max(note_err, relativeError(pitch_note_omega(static_cast<uint8_t>(n)), expected));
+    }
+    float bend_err = 0.0f;
+    for (float pitch = 0.0f; pitch <= 127.0f; pitch += 0.0137f) {
+        double expected = two_pi * 440.0 * std::pow(2.0, (pitch - 69.0) / 12.0);
+        bend_err = std::max(bend_err, relativeError(pitch_to_omega(pitch), expected));
+    }
+    char description[160];
+    snprintf(description, sizeof(description), "note table matches 2^((n-69)/12) (max error %.1e)", note_err);
+    check(note_err < 2e-7f, description);
+    snprintf(description, sizeof(description), "fractional pitch lookup (max error %.1e)", bend_err);
+    check(bend_err < 5e-7f, description);
+    check(pitch_to_omega(-3.0f) == pitch_note_omega(0) && pitch_to_omega(200.0f) == pitch_note_omega(127),
+          "  pitch clamps to the note range");
+
+    VoiceAllocator allocator(2);
+    allocator.initialize(48000.0f);
+    allocator.setModeParameters(2, 2.5f, 0.8f, 0.5f);
+    ModalVoice* voice = allocator.noteOn(57, 100);
+    allocator.setPitchBend(0.5f);
+
+    const modal_node_t* node = voice->getNode();
+    double base = two_pi * 440.0 * std::pow(2.0, (57 + 0.5 * 2.0 - 69) / 12.0);
+    check(relativeError(voice->getBaseOmega(), base) < 5e-7f, "  bend moves the base frequency");
+    check(relativeError(node->modes[2].params.omega, base * 2.5) < 5e-7f &&
+          relativeError(node->modes[1].params.omega, base * 1.01) < 5e-7f,
+          "  mode ratios survive note on and bend");
+
+    voice->setPitchBend(1.0f, 12.0f);
+    check(relativeError(voice->getBaseOmega(), 2.0 * two_pi * 440.0 * std::pow(2.0, (57 - 69) / 12.0)) < 5e-7f,
+          "  bend range honored");
+}
+
+static void testModeRamps() {
+    std::cout << "Mode parameter ramps" << std::endl;
+
+    VoiceAllocator allocator(4);
+    allocator.initialize(48000.0f);
+    ModalVoice* voice = allocator.noteOn(60, 100);
+    const float ratio = allocator.getModeParameter(2, MODE_PARAM_RATIO);
+
+    // A burst of automation between ticks: only the last value counts
+    for (int i = 1; i <= 50; i++) allocator.setModeParameterTargets(2, 2.0f + i * 0.01f, 0.4f, 0.9f);
+    check(allocator.getModeParameter(2, MODE_PARAM_RATIO) == ratio && allocator.isModeRampActive(),
+          "targets are recorded without touching the voices");
+
+    bool linear = true;
+    for (int tick = 1; tick < MODE_PARAM_RAMP_TICKS; tick++) {
+        allocator.updateVoices();
+        float expected = ratio + (2.5f - ratio) * tick / MODE_PARAM_RAMP_TICKS;
+        linear &= std::fabs(allocator.getModeParameter(2, MODE_PARAM_RATIO) - expected) < 1e-5f;
+        linear &= std::fabs(voice->getNode()->modes[2].params.omega - voice->getBaseOmega() * expected) <
+                  1e-3f;
+    }
+    check(linear, "  ramps linearly, voices follow every tick");
+
+    allocator.updateVoices();
+    const mode_params_t& params = voice->getNode()->modes[2].params;
+    check(!allocator.isModeRampActive() && allocator.getModeParameter(2, MODE_PARAM_RATIO) == 2.5f &&
+          params.gamma == 0.4f && params.weight == 0.9f,
+          "  lands exactly on the targets after MODE_PARAM_RAMP_TICKS");
+
+    ModalVoice* idle = allocator.getVoice(3);
+    check(idle->getNode()->modes[2].params.gamma == 0.4f, "  idle voices retuned too");
+
+    allocator.setModeParameterTargets(0, 1.5f, 0.5f, 1.0f);
+    allocator.setModeParameters(0, 1.25f, 0.5f, 1.0f);
+    allocator.updateVoices();
+    check(allocator.getModeParameter(0, MODE_PARAM_RATIO) == 1.25f, "immediate set cancels the ramp");
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Modal Attractors - Voice Allocator Tests" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    testNoteOnOffRelease();
+    testStealing();
+    testStealPolicies();
+    testStealFade();
+    testCpuBudget();
+    testCpuBudgetModerate();
+    testDormantVoices();
+    testTuning();
+    testModeRamps();
+
+    std::cout << std::endl;
+    if (g_failures == 0) {
+        std::cout << "All voice allocator tests passed" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::cout << g_failures << " voice allocator test(s) failed" << std::endl;
+    return EXIT_FAILURE;
+}
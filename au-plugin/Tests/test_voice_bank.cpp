@@ -0,0 +1,534 @@
+/**
+ * @file test_voice_bank.cpp
+ * @brief Accuracy tests for the SIMD VoiceBank renderer and sine kernels
+ *
+ * Renders the same voices through VoiceAllocator (VoiceBank path) and
+ * through a scalar reference of the per-sample audio_synth_render() loop
+ * evaluated with sinf(), and compares the mixes. The scalar renderer and
+ * the oscillator sine kernels are checked against the same reference, the
+ * worker-pool render path against the single-threaded one, the output
+ * gain stage against an ungained render, the per-mode buses against
+ * the stereo and centered mixes, and accumulating renders against
+ * overwriting ones.
+ */
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include "../src/dsp_core/VoiceAllocator.h"
+#include "../src/dsp_core/SimdTypes.h"
+#include "../src/esp32_port/sine_kernel.h"
+
+static int g_failures = 0;
+
+static void check(bool condition, const char* description) {
+    if (condition) {
+        std::cout << "  ✓ " << description << std::endl;
+    } else {
+        std::cout << "  ✗ FAILED: " << description << std::endl;
+        g_failures++;
+    }
+}
+
+/**
+ * @brief Scalar reference oscillator state (one per voice × mode)
+ */
+struct ReferenceOscillator {
+    uint32_t phase_acc = 0;
+    float amplitude_smooth = 0.0f;
+};
+
+/**
+ * @brief Per-sample reference renderer (audio_synth_render math, exact sine)
+ */
+static void referenceRender(const modal_node_t* node, ReferenceOscillator* osc,
+                            float sample_rate, float* out, uint32_t num_frames) {
+    for (uint32_t n = 0; n < num_frames; n++) {
+        float sum = 0.0f;
+        for (int k = 0; k < MAX_MODES; k++) {
+            if (!node->modes[k].params.active) continue;
+
+            const float* a = reinterpret_cast<const float*>(&node->modes[k].a);
+            float target = sqrtf(a[0] * a[0] + a[1] * a[1]) * node->modes[k].params.weight;
+            osc[k].amplitude_smooth += SMOOTH_ALPHA * (target - osc[k].amplitude_smooth);
+
+            float amplitude = fminf(osc[k].amplitude_smooth * MAX_AMPLITUDE_SCALE,
+                                    MAX_AMPLITUDE_SCALE);
+            double phase = osc[k].phase_acc / 4294967296.0 * 2.0 * M_PI + atan2f(a[1], a[0]);
+            sum += amplitude * static_cast<float>(sin(phase));
+
+            double inc = node->modes[k].params.omega / sample_rate / (2.0 * M_PI);
+            osc[k].phase_acc += static_cast<uint32_t>(inc * 4294967296.0);
+        }
+        out[n] += sum;
+    }
+}
+
+static void testMatchesScalarReference(node_personality_t personality,
+                                       uint32_t num_voices, uint32_t block_size) {
+    const float sample_rate = 48000.0f;
+    const uint32_t num_blocks = 1000;
+
+    VoiceAllocator allocator(num_voices);
+    allocator.initialize(sample_rate, block_size);
+    allocator.setPersonality(personality);
+
+    for (uint32_t v = 0; v < num_voices; v++) {
+        allocator.noteOn(static_cast<uint8_t>(36 + 4 * v), 100);
+    }
+
+    ReferenceOscillator* reference = new ReferenceOscillator[num_voices * MAX_MODES];
+    float* outL = new float[block_size];
+    float* outR = new float[block_size];
+    float* expected = new float[block_size];
+
+    double err = 0.0;
+    double ref = 0.0;
+    bool stereo_identical = true;
+
+    for (uint32_t b = 0; b < num_blocks; b++) {
+        allocator.updateVoices();
+        allocator.renderAudio(outL, outR, block_size);
+
+        memset(expected, 0, block_size * sizeof(float));
+        for (uint32_t v = 0; v < num_voices; v++) {
+            ModalVoice* voice = allocator.getVoice(v);
+            if (!voice->isActive()) continue;
+            referenceRender(voice->getNode(), &reference[v * MAX_MODES],
+                            sample_rate, expected, block_size);
+        }
+
+        for (uint32_t n = 0; n < block_size; n++) {
+            err += (outL[n] - expected[n]) * (outL[n] - expected[n]);
+            ref += expected[n] * expected[n];
+            if (outL[n] != outR[n]) stereo_identical = false;
+        }
+    }
+
+    double rel_err = sqrt(err / (ref > 0.0 ? ref : 1.0));
+
+    char description[160];
+    snprintf(description, sizeof(description),
+             "%s, %u voices, %u-frame blocks: relative error %.2e",
+             personality == PERSONALITY_RESONATOR ? "resonator" : "self-oscillator",
+             num_voices, block_size, rel_err);
+    check(ref > 0.0 && rel_err < 1e-3, description);
+    check(stereo_identical, "  left and right channels identical");
+
+    delete[] reference;
+    delete[] outL;
+    delete[] outR;
+    delete[] expected;
+}
+
+static void testSineKernels() {
+    sine_table_init();
+
+    // Sweep the full accumulator range with an odd stride (hits all table cells)
+    double table_err = 0.0;
+    double poly_err = 0.0;
+    double q15_err = 0.0;
+    for (uint64_t p = 0; p < 4294967296ull; p += 65537) {
+        uint32_t phase = static_cast<uint32_t>(p);
+        double exact = sin(phase / 4294967296.0 * 2.0 * M_PI);
+        table_err = fmax(table_err, fabs(sine_from_phase(phase) - exact));
+        poly_err = fmax(poly_err, fabs(vsin_phase(vsplat_u(phase))[0] - exact));
+        q15_err = fmax(q15_err, fabs(sine_q15_from_phase(phase) / 32767.0 - exact));
+    }
+
+    double radians_err = 0.0;
+    for (float x = -100.0f; x < 100.0f; x += 0.001f) {
+        radians_err = fmax(radians_err, fabs(fast_sin(x) - sin(static_cast<double>(x))));
+    }
+
+    char description[160];
+    snprintf(description, sizeof(description), "sine_from_phase max error %.2e", table_err);
+    check(table_err < 1e-5, description);
+    snprintf(description, sizeof(description), "vsin_phase max error %.2e", poly_err);
+    check(poly_err < 1e-5, description);
+    snprintf(description, sizeof(description), "sine_q15_from_phase max error %.1f LSB", q15_err * 32767.0);
+    check(q15_err * 32767.0 < 2.0, description);
+    snprintf(description, sizeof(description), "fast_sin max error %.2e (|x| < 100)", radians_err);
+    check(radians_err < 1e-4, description);
+}
+
+static void testScalarMatchesReference() {
+    const float sample_rate = 48000.0f;
+    const uint32_t block_size = 96;
+    const uint32_t num_blocks = 1000;
+
+    modal_node_t node;
+    modal_node_init(&node, 0, PERSONALITY_SELF_OSCILLATOR);
+    float base_omega = freq_to_omega(220.0f);
+    modal_node_set_mode(&node, 0, base_omega * 1.0f, 0.5f, 1.0f);
+    modal_node_set_mode(&node, 1, base_omega * 1.01f, 0.6f, 0.7f);
+    modal_node_set_mode(&node, 2, base_omega * 2.0f, 0.8f, 0.5f);
+    modal_node_set_mode(&node, 3, base_omega * 3.0f, 1.0f, 0.3f);
+    modal_node_start(&node);
+
+    audio_synth_t synth;
+    audio_synth_init(&synth, &node, sample_rate);
+
+    ReferenceOscillator reference[MAX_MODES];
+    float outL[block_size];
+    float outR[block_size];
+    float expected[block_size];
+
+    double err = 0.0;
+    double ref = 0.0;
+    for (uint32_t b = 0; b < num_blocks; b++) {
+        modal_node_step(&node);
+        audio_synth_render(&synth, outL, outR, block_size);
+
+        memset(expected, 0, sizeof(expected));
+        referenceRender(&node, reference, sample_rate, expected, block_size);
+
+        for (uint32_t n = 0; n < block_size; n++) {
+            err += (outL[n] - expected[n]) * (outL[n] - expected[n]);
+            ref += expected[n] * expected[n];
+        }
+    }
+
+    double rel_err = sqrt(err / (ref > 0.0 ? ref : 1.0));
+
+    char description[160];
+    snprintf(description, sizeof(description),
+             "audio_synth_render, 4 modes: relative error %.2e", rel_err);
+    check(ref > 0.0 && rel_err < 1e-3, description);
+}
+
+/**
+ * @brief Allocator with one sounding self-oscillator per voice
+ *
+ * Node noise is seeded per voice, so repeated calls produce identical
+ * voice state.
+ */
+static VoiceAllocator* makeSelfOscillators(uint32_t num_voices, float sample_rate,
+                                           uint32_t block_size, float stereo_width = 0.0f,
+                                           float mode_spread = 0.0f) {
+    VoiceAllocator* allocator = new VoiceAllocator(num_voices);
+    allocator->initialize(sample_rate, block_size);
+    allocator->setPersonality(PERSONALITY_SELF_OSCILLATOR);
+    allocator->setStereoWidth(stereo_width);
+    allocator->setModeSpread(mode_spread);
+    for (uint32_t v = 0; v < num_voices; v++) {
+        allocator->noteOn(static_cast<uint8_t>(24 + v), 100);
+    }
+    return allocator;
+}
+
+static void testWorkerPoolMatchesSingleThread(uint32_t num_voices, uint32_t num_workers,
+                                             uint32_t min_parallel_voices, bool stereo = false) {
+    const float sample_rate = 48000.0f;
+    const uint32_t block_size = 96;
+    const uint32_t num_blocks = 500;
+    const float width = stereo ? 1.0f : 0.0f;
+    const float spread = stereo ? 0.5f : 0.0f;
+
+    VoiceAllocator* single = makeSelfOscillators(num_voices, sample_rate, block_size, width, spread);
+    VoiceAllocator* threaded = makeSelfOscillators(num_voices, sample_rate, block_size, width, spread);
+    threaded->setRenderThreads(num_workers, min_parallel_voices);
+
+    float* expectedL = new float[block_size];
+    float* expectedR = new float[block_size];
+    float* outL = new float[block_size];
+    float* outR = new float[block_size];
+
+    double err = 0.0;
+    double ref = 0.0;
+    for (uint32_t b = 0; b < num_blocks; b++) {
+        single->updateVoices();
+        threaded->updateVoices();
+        single->renderAudio(expectedL, expectedR, block_size);
+        threaded->renderAudio(outL, outR, block_size);
+
+        for (uint32_t n = 0; n < block_size; n++) {
+            err += (outL[n] - expectedL[n]) * (outL[n] - expectedL[n]) +
+                   (outR[n] - expectedR[n]) * (outR[n] - expectedR[n]);
+            ref += expectedL[n] * expectedL[n] + expectedR[n] * expectedR[n];
+        }
+    }
+
+    double rel_err = sqrt(err / (ref > 0.0 ? ref : 1.0));
+
+    char description[160];
+    snprintf(description, sizeof(description),
+             "%u voices, %u workers, threshold %u%s: relative error %.2e",
+             num_voices, num_workers, min_parallel_voices, stereo ? ", panned" : "", rel_err);
+    check(ref > 0.0 && rel_err < 1e-6, description);
+
+    delete single;
+    delete threaded;
+    delete[] expectedL;
+    delete[] expectedR;
+    delete[] outL;
+    delete[] outR;
+}
+
+/**
+ * @brief Panned voices scale the centered render by constant-power gains
+ */
+static void testStereoPanning() {
+    const float sample_rate = 48000.0f;
+    const uint32_t block_size = 64;
+    const uint32_t num_blocks = 200;
+
+    // Same single voice three times: centered, panned by note, mode spread
+    VoiceAllocator center(1), panned(1), spread(1);
+    VoiceAllocator* allocators[3] = {&center, &panned, &spread};
+    for (VoiceAllocator* allocator : allocators) {
+        allocator->initialize(sample_rate, block_size);
+        allocator->setPersonality(PERSONALITY_SELF_OSCILLATOR);
+    }
+    panned.setStereoWidth(1.0f);
+    spread.setModeSpread(1.0f);
+
+    center.noteOn(78, 100);
+    panned.noteOn(78, 100);     // 18 semitones above middle C: pan 0.5
+    spread.noteOn(60, 100);
+    check(panned.getVoice(0)->getPan() == 0.5f && center.getVoice(0)->getPan() == 0.0f,
+          "voice panned by note");
+
+    const float theta = 1.5f * static_cast<float>(M_PI) * 0.25f;
+    const float gain_l = sqrtf(2.0f) * cosf(theta);
+    const float gain_r = sqrtf(2.0f) * sinf(theta);
+
+    float cL[block_size], cR[block_size], pL[block_size], pR[block_size];
+    double err = 0.0, ref = 0.0;
+    bool mono_identical = true;
+    bool spread_differs = false;
+    for (uint32_t b = 0; b < num_blocks; b++) {
+        for (VoiceAllocator* allocator : allocators) allocator->updateVoices();
+
+        center.renderAudio(cL, cR, block_size);
+        panned.renderAudio(pL, pR, block_size);
+        for (uint32_t n = 0; n < block_size; n++) {
+            mono_identical = mono_identical && cL[n] == cR[n];
+            err += (pL[n] - gain_l * cL[n]) * (pL[n] - gain_l * cL[n]) +
+                   (pR[n] - gain_r * cR[n]) * (pR[n] - gain_r * cR[n]);
+            ref += pL[n] * pL[n] + pR[n] * pR[n];
+        }
+
+        spread.renderAudio(pL, pR, block_size);
+        for (uint32_t n = 0; n < block_size; n++) spread_differs = spread_differs || pL[n] != pR[n];
+    }
+
+    double rel_err = sqrt(err / (ref > 0.0 ? ref : 1.0));
+    char description[160];
+    snprintf(description, sizeof(description),
+             "pan 0.5 = centered render × (%.3f, %.3f): relative error %.2e", gain_l, gain_r, rel_err);
+    check(ref > 0.0 && rel_err < 1e-6, description);
+    check(mono_identical, "zero width and spread: left and right identical");
+    check(spread_differs, "mode spread alone widens a centered voice");
+}
+
+/**
+ * @brief Mode buses: stereo unchanged, buses sum to the dry (centered) mix
+ */
+static void testModeBuses(bool stereo, uint32_t num_workers) {
+    const float sample_rate = 48000.0f;
+    const uint32_t block_size = 96;
+    const uint32_t num_blocks = 300;
+    const uint32_t num_voices = 32;
+    const float width = stereo ? 1.0f : 0.0f;
+    const float spread = stereo ? 0.5f : 0.0f;
+
+    VoiceAllocator* plain = makeSelfOscillators(num_voices, sample_rate, block_size, width, spread);
+    VoiceAllocator* centered = makeSelfOscillators(num_voices, sample_rate, block_size);
+    VoiceAllocator* routed = makeSelfOscillators(num_voices, sample_rate, block_size, width, spread);
+    if (num_workers > 0) routed->setRenderThreads(num_workers, 1);
+
+    float plainL[block_size], plainR[block_size], centerL[block_size], centerR[block_size];
+    float outL[block_size], outR[block_size];
+    float modes[MAX_MODES][block_size];
+    float* mode_out[MAX_MODES] = {modes[0], modes[1], modes[2], modes[3]};
+
+    double stereo_err = 0.0, stereo_ref = 0.0, sum_err = 0.0, sum_ref = 0.0;
+    double mode_energy[MAX_MODES] = {};
+    for (uint32_t b = 0; b < num_blocks; b++) {
+        plain->updateVoices();
+        centered->updateVoices();
+        routed->updateVoices();
+        plain->renderAudio(plainL, plainR, block_size);
+        centered->renderAudio(centerL, centerR, block_size);
+        routed->renderAudio(outL, outR, block_size, mode_out, MAX_MODES);
+
+        for (uint32_t n = 0; n < block_size; n++) {
+            stereo_err += (outL[n] - plainL[n]) * (outL[n] - plainL[n]) +
+                          (outR[n] - plainR[n]) * (outR[n] - plainR[n]);
+            stereo_ref += plainL[n] * plainL[n] + plainR[n] * plainR[n];
+
+            float sum = 0.0f;
+            for (int k = 0; k < MAX_MODES; k++) {
+                sum += modes[k][n];
+                mode_energy[k] += modes[k][n] * modes[k][n];
+            }
+            sum_err += (sum - centerL[n]) * (sum - centerL[n]);
+            sum_ref += centerL[n] * centerL[n];
+        }
+    }
+
+    bool every_mode = true;
+    for (int k = 0; k < MAX_MODES; k++) every_mode = every_mode && mode_energy[k] > 0.0;
+
+    const char* label = stereo ? "panned" : "centered";
+    char description[160];
+    snprintf(description, sizeof(description), "%s, %u workers: stereo unchanged, relative error %.2e",
+             label, num_workers, sqrt(stereo_err / (stereo_ref > 0.0 ? stereo_ref : 1.0)));
+    check(stereo_ref > 0.0 && stereo_err <= 1e-12 * stereo_ref, description);
+    snprintf(description, sizeof(description), "%s, %u workers: mode buses sum to the dry mix, relative error %.2e",
+             label, num_workers, sqrt(sum_err / (sum_ref > 0.0 ? sum_ref : 1.0)));
+    check(sum_ref > 0.0 && sum_err <= 1e-12 * sum_ref, description);
+    check(every_mode, "every mode bus carries its mode");
+
+    delete plain;
+    delete centered;
+    delete routed;
+}
+
+static void testAccumulate(bool mode_buses, uint32_t num_workers) {
+    std::cout << "Accumulate into caller buffers (" << (mode_buses ? "mode buses, " : "")
+              << num_workers << " workers)" << std::endl;
+
+    const uint32_t num_voices = 32;
+    const uint32_t block_size = 128;
+    VoiceAllocator* overwrite = makeSelfOscillators(num_voices, 48000.0f, block_size, 1.0f, 0.5f);
+    VoiceAllocator* accumulate = makeSelfOscillators(num_voices, 48000.0f, block_size, 1.0f, 0.5f);
+    overwrite->setRenderThreads(num_workers, 8);
+    accumulate->setRenderThreads(num_workers, 8);
+
+    const uint32_t num_channels = 2 + MAX_MODES;
+    const uint32_t num_mode_out = mode_buses ? MAX_MODES : 0;
+    float* expected[num_channels];
+    float* mixed[num_channels];
+    for (uint32_t c = 0; c < num_channels; c++) {
+        expected[c] = new float[block_size];
+        mixed[c] = new float[block_size];
+    }
+
+    // The add may fuse with the gain multiply, and workers sum their
+    // partial mixes in claim order, so neither is bit exact
+    const float tolerance = num_workers > 0 ? 1e-5f : 1e-6f;
+    bool exact = true;
+    for (uint32_t b = 0; b < 50; b++) {
+        overwrite->updateVoices();
+        accumulate->updateVoices();
+        for (uint32_t c = 0; c < num_channels; c++) {
+            for (uint32_t n = 0; n < block_size; n++) mixed[c][n] = 0.125f * (c + 1);
+        }
+        overwrite->renderAudio(expected[0], expected[1], block_size, expected + 2, num_mode_out);
+        accumulate->renderAudio(mixed[0], mixed[1], block_size, mixed + 2, num_mode_out, true);
+
+        for (uint32_t c = 0; c < 2 + num_mode_out; c++) {
+            for (uint32_t n = 0; n < block_size; n++) {
+                exact &= fabsf(mixed[c][n] - (0.125f * (c + 1) + expected[c][n])) <= tolerance;
+            }
+        }
+    }
+    check(exact, "outputs are the existing contents plus the overwriting render");
+
+    delete overwrite;
+    delete accumulate;
+    for (uint32_t c = 0; c < num_channels; c++) {
+        delete[] expected[c];
+        delete[] mixed[c];
+    }
+}
+
+static void testOutputGain() {
+    const float sample_rate = 48000.0f;
+    const uint32_t block_size = 64;
+
+    VoiceAllocator unity(1), gained(1);
+    VoiceAllocator* allocators[2] = {&unity, &gained};
+    for (VoiceAllocator* allocator : allocators) {
+        allocator->initialize(sample_rate, block_size);
+        allocator->setPersonality(PERSONALITY_SELF_OSCILLATOR);
+        allocator->noteOn(64, 100);
+    }
+    gained.setOutputGain(0.5f, false);
+
+    float uL[block_size], uR[block_size], gL[block_size], gR[block_size];
+    bool exact = true;
+    for (uint32_t b = 0; b < 50; b++) {
+        for (VoiceAllocator* allocator : allocators) allocator->updateVoices();
+        unity.renderAudio(uL, uR, block_size);
+        gained.renderAudio(gL, gR, block_size);
+        for (uint32_t n = 0; n < block_size; n++) {
+            exact = exact && gL[n] == 0.5f * uL[n] && gR[n] == 0.5f * uR[n];
+        }
+    }
+    check(exact, "unsmoothed gain 0.5 halves every sample exactly");
+
+    // Smoothed change: glides over several blocks, within the old/new bounds
+    gained.setOutputGain(0.25f);
+    bool bounded = true;
+    float first_block_gain = 0.0f;
+    for (uint32_t b = 0; b < 200; b++) {
+        for (VoiceAllocator* allocator : allocators) allocator->updateVoices();
+        unity.renderAudio(uL, uR, block_size);
+        gained.renderAudio(gL, gR, block_size);
+        if (b == 0) first_block_gain = gained.getOutputGain();
+        for (uint32_t n = 0; n < block_size; n++) {
+            bounded = bounded && fabsf(gL[n]) <= 0.5f * fabsf(uL[n]) + 1e-7f &&
+                      fabsf(gL[n]) >= 0.25f * fabsf(uL[n]) - 1e-7f;
+        }
+    }
+    exact = true;
+    for (uint32_t n = 0; n < block_size; n++) exact = exact && gL[n] == 0.25f * uL[n];
+
+    char description[128];
+    snprintf(description, sizeof(description),
+             "smoothed change ramps (gain after one block %.3f)", first_block_gain);
+    check(first_block_gain < 0.5f && first_block_gain > 0.25f, description);
+    check(bounded, "ramped samples stay between old and new gain");
+    check(exact, "ramp settles on the exact target gain");
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Modal Attractors - Voice Bank Tests" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    std::cout << "Sine kernels" << std::endl;
+    testSineKernels();
+
+    std::cout << "audio_synth_render vs. scalar reference" << std::endl;
+    testScalarMatchesReference();
+
+    std::cout << "VoiceBank vs. scalar reference" << std::endl;
+    testMatchesScalarReference(PERSONALITY_RESONATOR, 1, 96);
+    testMatchesScalarReference(PERSONALITY_SELF_OSCILLATOR, 4, 96);
+    testMatchesScalarReference(PERSONALITY_SELF_OSCILLATOR, 16, 37);
+
+    std::cout << "Worker pool vs. single-threaded render" << std::endl;
+    testWorkerPoolMatchesSingleThread(64, 3, 16);
+    testWorkerPoolMatchesSingleThread(64, 1, 1);
+    testWorkerPoolMatchesSingleThread(8, 3, 16);   // Below threshold: inline
+    testWorkerPoolMatchesSingleThread(64, 3, 16, true);
+
+    std::cout << "Stereo panning" << std::endl;
+    testStereoPanning();
+
+    std::cout << "Output gain" << std::endl;
+    testOutputGain();
+
+    std::cout << "Mode buses" << std::endl;
+    testModeBuses(false, 0);
+    testModeBuses(true, 0);
+    testModeBuses(true, 3);
+    testAccumulate(false, 0);
+    testAccumulate(true, 0);
+    testAccumulate(true, 3);
+
+    std::cout << std::endl;
+    if (g_failures == 0) {
+        std::cout << "All voice bank tests passed" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::cout << g_failures << " voice bank test(s) failed" << std::endl;
+    return EXIT_FAILURE;
+}
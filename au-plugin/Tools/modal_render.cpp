@@ -0,0 +1,416 @@
+/**
+ * @file modal_render.cpp
+ * @brief Offline batch renderer: score + parameter set → WAV
+ *
+ * Renders scores (CSV or Standard MIDI File, see Score.h) through
+ * ModalAttractorsEngine as fast as the machine allows. Each render owns
+ * its engine, so a batch of renders runs in parallel across all cores.
+ * Audio is streamed to disk through AudioFileWriter; memory use does not
+ * grow with render length.
+ *
+ * Usage:
+ *   modal_render [options] <score> -o <out.wav>
+ *   modal_render [options] --batch <jobs.txt>
+ *
+ * A batch file has one render per line, "<score> <out.wav> [name=value ...]";
+ * per-line settings override --set. Blank lines and '#' comments are skipped.
+ *
+ * --mode-buses writes 2 + MAX_MODES channels: the stereo mix, then one
+ * dry bus per mode. Blocks are rendered straight into the planar buffers
+ * handed to the writer (modal_attractors_engine_render_channels).
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/au_wrapper/ModalAttractorsAU.h"
+#include "../src/au_wrapper/ModalParameters.h"
+#include "../src/esp32_port/modal_node.h"
+#include "../src/offline/AudioFileWriter.h"
+#include "../src/offline/Score.h"
+
+#define RENDER_DEFAULT_SAMPLE_RATE 48000.0f
+#define RENDER_DEFAULT_POLYPHONY 16
+#define RENDER_DEFAULT_BLOCK 4096
+#define RENDER_DEFAULT_TAIL_SEC 2.0
+
+// ============================================================================
+// Options and jobs
+// ============================================================================
+
+/**
+ * @brief Parameter assignment (engine parameter ID → value)
+ */
+struct ParamSetting {
+    uint32_t param_id;
+    float value;
+};
+
+struct RenderJob {
+    std::string score_path;
+    std::string output_path;
+    std::vector<ParamSetting> params;   ///< Applied in order, after the globals
+};
+
+struct RenderOptions {
+    float sample_rate = RENDER_DEFAULT_SAMPLE_RATE;
+    uint32_t polyphony = RENDER_DEFAULT_POLYPHONY;
+    int render_rate = kRenderRate_Default;
+    uint32_t block_size = RENDER_DEFAULT_BLOCK;
+    double tail_sec = RENDER_DEFAULT_TAIL_SEC;
+    bool has_seed = false;
+    uint32_t seed = 0;
+    AudioSampleFormat format = AudioSampleFormat::Float32;
+    uint32_t num_jobs = 0;              ///< 0 = hardware threads
+    bool mode_buses = false;            ///< Append one channel per mode
+    std::vector<ParamSetting> params;   ///< --set, applied to every job
+};
+
+/**
+ * @brief Render result summary
+ */
+struct RenderReport {
+    uint64_t frames;
+    double seconds;     ///< Wall time
+    float peak;
+};
+
+static const struct {
+    const char* name;
+    uint32_t param_id;
+} kParamNames[] = {
+    {"master_gain", kParam_MasterGain},
+    {"coupling", kParam_CouplingStrength},
+    {"topology", kParam_Topology},
+    {"mode0_freq", kParam_Mode0_Frequency}, {"mode0_damping", kParam_Mode0_Damping}, {"mode0_weight", kParam_Mode0_Weight},
+    {"mode1_freq", kParam_Mode1_Frequency}, {"mode1_damping", kParam_Mode1_Damping}, {"mode1_weight", kParam_Mode1_Weight},
+    {"mode2_freq", kParam_Mode2_Frequency}, {"mode2_damping", kParam_Mode2_Damping}, {"mode2_weight", kParam_Mode2_Weight},
+    {"mode3_freq", kParam_Mode3_Frequency}, {"mode3_damping", kParam_Mode3_Damping}, {"mode3_weight", kParam_Mode3_Weight},
+    {"poke_strength", kParam_PokeStrength},
+    {"poke_duration", kParam_PokeDuration},
+    {"personality", kParam_Personality},
+    {"topology_morph", kParam_TopologyMorphTime},
+    {"stereo_width", kParam_StereoWidth},
+    {"mode_spread", kParam_ModeSpread},
+};
+
+static bool parseSetting(const std::string& text, ParamSetting* setting) {
+    size_t eq = text.find('=');
+    if (eq == std::string::npos) return false;
+
+    std::string name = text.substr(0, eq);
+    for (const auto& entry : kParamNames) {
+        if (name == entry.name) {
+            setting->param_id = entry.param_id;
+            setting->value = static_cast<float>(atof(text.c_str() + eq + 1));
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool loadBatch(const char* path, std::vector<RenderJob>& jobs) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Cannot open batch file " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+        line_number++;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+
+        std::istringstream fields(line);
+        RenderJob job;
+        if (!(fields >> job.score_path)) continue;
+        if (!(fields >> job.output_path)) {
+            std::cerr << path << ":" << line_number << ": missing output file" << std::endl;
+            return false;
+        }
+
+        std::string token;
+        while (fields >> token) {
+            ParamSetting setting;
+            if (!parseSetting(token, &setting)) {
+                std::cerr << path << ":" << line_number << ": unknown setting " << token << std::endl;
+                return false;
+            }
+            job.params.push_back(setting);
+        }
+        jobs.push_back(job);
+    }
+    return true;
+}
+
+// ============================================================================
+// Rendering
+// ============================================================================
+
+static void applyParams(ModalAttractorsEngine* engine, const std::vector<ParamSetting>& params) {
+    for (const ParamSetting& p : params) {
+        modal_attractors_engine_set_parameter(engine, p.param_id, p.value);
+    }
+}
+
+static bool renderJob(const RenderJob& job, const RenderOptions& options,
+                      RenderReport* report, std::string* error) {
+    Score score;
+    if (!score.loadFile(job.score_path.c_str(), error)) {
+        *error = job.score_path + ": " + *error;
+        return false;
+    }
+
+    // Disk writes overlap with rendering on the writer's own thread
+    AudioFileWriter wav;
+    uint32_t sample_rate = static_cast<uint32_t>(lroundf(options.sample_rate));
+    const uint32_t num_channels = 2 + (options.mode_buses ? MAX_MODES : 0);
+    if (!wav.open(job.output_path.c_str(), sample_rate, num_channels, options.format, true)) {
+        *error = "cannot write " + job.output_path;
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    ModalAttractorsEngine engine;
+    modal_attractors_engine_init(&engine, options.sample_rate, options.polyphony, options.render_rate);
+    if (options.has_seed) modal_attractors_engine_set_seed(&engine, options.seed);
+    applyParams(&engine, options.params);
+    applyParams(&engine, job.params);
+
+    const std::vector<ScoreEvent>& events = score.getEvents();
+    const uint64_t total_frames =
+        static_cast<uint64_t>(std::ceil((score.getDuration() + options.tail_sec) * options.sample_rate));
+
+    std::vector<float> buffers(num_channels * options.block_size);
+    float* channels[2 + MAX_MODES];
+    for (uint32_t c = 0; c < num_channels; c++) channels[c] = buffers.data() + c * options.block_size;
+    uint32_t queued = static_cast<uint32_t>(options.params.size() + job.params.size()) + 1;
+    size_t next_event = 0;
+    float peak = 0.0f;
+    bool ok = true;
+
+    for (uint64_t pos = 0; pos < total_frames && ok; ) {
+        uint32_t num_frames = static_cast<uint32_t>(std::min<uint64_t>(options.block_size, total_frames - pos));
+
+        // Queue this block's events; if the queue would overflow, end the
+        // block at the first event that does not fit
+        for (; next_event < events.size(); next_event++) {
+            const ScoreEvent& event = events[next_event];
+            uint64_t frame = static_cast<uint64_t>(std::llround(event.time * options.sample_rate));
+            if (frame >= pos + num_frames) break;
+            if (queued >= ENGINE_EVENT_QUEUE_SIZE - 1) {
+                num_frames = frame > pos ? static_cast<uint32_t>(frame - pos) : 1;
+                break;
+            }
+
+            uint32_t offset = frame > pos ? static_cast<uint32_t>(frame - pos) : 0;
+            if (event.note_on) {
+                modal_attractors_engine_note_on(&engine, event.note, event.velocity, offset);
+            } else {
+                modal_attractors_engine_note_off(&engine, event.note, offset);
+            }
+            queued++;
+        }
+
+        modal_attractors_engine_render_channels(&engine, channels, num_channels, num_frames);
+        for (uint32_t i = 0; i < num_frames; i++) {
+            peak = std::max(peak, std::max(fabsf(channels[0][i]), fabsf(channels[1][i])));
+        }
+        ok = wav.write(channels, num_frames);
+
+        pos += num_frames;
+        queued = 0;
+    }
+
+    modal_attractors_engine_cleanup(&engine);
+    ok = wav.close() && ok;
+    if (!ok) {
+        *error = "write failed: " + job.output_path;
+        return false;
+    }
+
+    report->frames = total_frames;
+    report->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    report->peak = peak;
+    return true;
+}
+
+/**
+ * @brief Render all jobs on num_threads threads; returns the number that failed
+ */
+static uint32_t renderAll(const std::vector<RenderJob>& jobs, const RenderOptions& options,
+                          uint32_t num_threads) {
+    std::atomic<size_t> next_job(0);
+    std::atomic<uint32_t> failures(0);
+    std::mutex print_mutex;
+
+    auto worker = [&]() {
+        for (size_t j = next_job.fetch_add(1); j < jobs.size(); j = next_job.fetch_add(1)) {
+            RenderReport report = {0, 0.0, 0.0f};
+            std::string error;
+            bool ok = renderJob(jobs[j], options, &report, &error);
+
+            std::lock_guard<std::mutex> lock(print_mutex);
+            if (!ok) {
+                std::cerr << "  ✗ " << error << std::endl;
+                failures++;
+                continue;
+            }
+            double audio_sec = report.frames / options.sample_rate;
+            float peak_db = report.peak > 0.0f ? 20.0f * log10f(report.peak) : -INFINITY;
+            std::cout << "  ✓ " << jobs[j].output_path << ": "
+                      << std::fixed << std::setprecision(1) << audio_sec << " s in "
+                      << std::setprecision(2) << report.seconds << " s ("
+                      << std::setprecision(0) << audio_sec / std::max(report.seconds, 1e-9) << "x), peak "
+                      << std::setprecision(1) << peak_db << " dBFS" << std::endl;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32_t t = 1; t < num_threads; t++) threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads) thread.join();
+
+    return failures;
+}
+
+// ============================================================================
+// Command line
+// ============================================================================
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options] <score> -o <out.wav>\n"
+              << "       " << program << " [options] --batch <jobs.txt>\n"
+              << "\n"
+              << "Options:\n"
+              << "  -o <file>            Output WAV (stereo, see --mode-buses)\n"
+              << "  --format <f>         Sample format: f32 (default), 24 or 16\n"
+              << "  --mode-buses         Also write one channel per mode after L/R\n"
+              << "  --batch <file>       Render list: <score> <out.wav> [name=value ...] per line\n"
+              << "  --set <name>=<value> Engine parameter, repeatable\n"
+              << "  --sample-rate <hz>   Sample rate (default 48000)\n"
+              << "  --polyphony <n>      Voices (default 16)\n"
+              << "  --render-rate <r>    Internal voice rate: half, host (default) or double\n"
+              << "  --seed <n>           Noise and topology seed\n"
+              << "  --tail <sec>         Render time after the last event (default 2)\n"
+              << "  --block <frames>     Frames per render call (default 4096)\n"
+              << "  -j, --jobs <n>       Parallel renders (default: hardware threads)\n"
+              << "\n"
+              << "Parameters:";
+    for (const auto& entry : kParamNames) std::cerr << " " << entry.name;
+    std::cerr << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    RenderOptions options;
+    std::vector<RenderJob> jobs;
+    std::string score_path, output_path, batch_path;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (arg == "-o" && has_value) {
+            output_path = argv[++i];
+        } else if (arg == "--format" && has_value) {
+            std::string format = argv[++i];
+            if (format == "f32") {
+                options.format = AudioSampleFormat::Float32;
+            } else if (format == "24") {
+                options.format = AudioSampleFormat::PCM24;
+            } else if (format == "16") {
+                options.format = AudioSampleFormat::PCM16;
+            } else {
+                printUsage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--batch" && has_value) {
+            batch_path = argv[++i];
+        } else if (arg == "--set" && has_value) {
+            ParamSetting setting;
+            if (!parseSetting(argv[++i], &setting)) {
+                std::cerr << "Unknown setting " << argv[i] << std::endl;
+                printUsage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            options.params.push_back(setting);
+        } else if (arg == "--sample-rate" && has_value) {
+            options.sample_rate = static_cast<float>(atof(argv[++i]));
+        } else if (arg == "--polyphony" && has_value) {
+            options.polyphony = static_cast<uint32_t>(std::max(1, atoi(argv[++i])));
+        } else if (arg == "--render-rate" && has_value) {
+            std::string rate = argv[++i];
+            if (rate == "half") {
+                options.render_rate = kRenderRate_Half;
+            } else if (rate == "host") {
+                options.render_rate = kRenderRate_Host;
+            } else if (rate == "double") {
+                options.render_rate = kRenderRate_Double;
+            } else {
+                printUsage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--seed" && has_value) {
+            options.has_seed = true;
+            options.seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 0));
+        } else if (arg == "--tail" && has_value) {
+            options.tail_sec = std::max(0.0, atof(argv[++i]));
+        } else if (arg == "--block" && has_value) {
+            options.block_size = static_cast<uint32_t>(std::max(1, atoi(argv[++i])));
+        } else if (arg == "--mode-buses") {
+            options.mode_buses = true;
+        } else if ((arg == "-j" || arg == "--jobs") && has_value) {
+            options.num_jobs = static_cast<uint32_t>(std::max(1, atoi(argv[++i])));
+        } else if (arg[0] != '-' && score_path.empty()) {
+            score_path = arg;
+        } else {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!batch_path.empty()) {
+        if (!loadBatch(batch_path.c_str(), jobs)) return EXIT_FAILURE;
+    }
+    if (!score_path.empty()) {
+        if (output_path.empty()) {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        jobs.push_back({score_path, output_path, {}});
+    }
+    if (jobs.empty() || options.sample_rate <= 0.0f) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    uint32_t num_threads = options.num_jobs ? options.num_jobs
+                                            : std::max(1u, std::thread::hardware_concurrency());
+    num_threads = std::min<uint32_t>(num_threads, static_cast<uint32_t>(jobs.size()));
+
+    std::cout << "Rendering " << jobs.size() << " score" << (jobs.size() == 1 ? "" : "s")
+              << " on " << num_threads << " thread" << (num_threads == 1 ? "" : "s") << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    uint32_t failures = renderAll(jobs, options, num_threads);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << jobs.size() - failures << "/" << jobs.size() << " rendered in "
+              << std::fixed << std::setprecision(2) << seconds << " s" << std::endl;
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file EngineEvents.h
+ * @brief Events passed from the host/control thread into the render thread
+ *
+ * Note and parameter calls on ModalAttractorsEngine only enqueue events;
+ * modal_attractors_engine_render() applies them at their sample offset.
+ * Topologies are built on the calling thread and handed over through
+ * TopologyExchange, so the render thread never runs a generator; voice
+ * pools for a new polyphony go through VoicePoolExchange the same way.
+ */
+
+#ifndef ENGINE_EVENTS_H
+#define ENGINE_EVENTS_H
+
+#include "../dsp_core/SpscRing.h"
+#include <atomic>
+#include <cstdint>
+
+class TopologyEngine;
+class VoiceAllocator;
+
+/**
+ * @brief Event queue capacity (events per render block, worst case)
+ */
+#define ENGINE_EVENT_QUEUE_SIZE 1024
+
+/**
+ * @brief Event types
+ */
+enum class EngineEventType : uint8_t {
+    NoteOn,
+    NoteOff,
+    Parameter,
+    Seed
+};
+
+/**
+ * @brief Timestamped engine event
+ */
+struct EngineEvent {
+    EngineEventType type;
+    uint8_t note;               ///< MIDI note (note events)
+    uint8_t velocity;           ///< MIDI velocity (note on)
+    uint32_t param_id;          ///< Parameter ID (parameter events), or seed
+    float value;                ///< Parameter value
+    uint32_t sample_offset;     ///< Frame within the next render block
+};
+
+typedef SpscRing<EngineEvent, ENGINE_EVENT_QUEUE_SIZE> EngineEventQueue;
+
+/**
+ * @brief Hand-over slots for topologies built off the render thread
+ *
+ * The producer publishes into pending (replacing and deleting one the
+ * render thread has not taken yet). The render thread takes pending only
+ * while retired is empty, morphs its own topology towards it, and parks
+ * it in retired for the producer to delete. Neither side ever blocks.
+ */
+struct TopologyExchange {
+    std::atomic<TopologyEngine*> pending{nullptr};
+    std::atomic<TopologyEngine*> retired{nullptr};
+};
+
+/**
+ * @brief Voices and coupling network for one polyphony, built together
+ */
+struct VoicePool {
+    VoiceAllocator* allocator;
+    TopologyEngine* topology;
+};
+
+/**
+ * @brief Hand-over slots for voice pools built off the render thread
+ *
+ * Same protocol as TopologyExchange. The render thread swaps a taken
+ * pool in whole, after carrying its sounding voices over, and parks the
+ * pool it replaced in retired.
+ */
+struct VoicePoolExchange {
+    std::atomic<VoicePool*> pending{nullptr};
+    std::atomic<VoicePool*> retired{nullptr};
+};
+
+#endif // ENGINE_EVENTS_H
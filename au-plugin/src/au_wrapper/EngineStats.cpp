@@ -0,0 +1,65 @@
+/**
+ * @file EngineStats.cpp
+ * @brief Sequence-lock publication of per-block render statistics
+ */
+
+#include "EngineStats.h"
+
+#ifdef MODAL_ENGINE_STATS
+
+#include <algorithm>
+#include <cstring>
+
+#define STATS_READ_ATTEMPTS 64  // Reader retries before giving up on a racing writer
+
+void EngineStats::record(const EngineStatsSnapshot& block) {
+    uint32_t words[kNumWords];
+    memcpy(words, &block, sizeof(words));
+
+    uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (uint32_t w = 0; w < kNumWords; w++) {
+        words_[w].store(words[w], std::memory_order_relaxed);
+    }
+    load_history_[(block.block_count - 1) % ENGINE_STATS_WINDOW].store(block.load, std::memory_order_relaxed);
+
+    sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+bool EngineStats::read(EngineStatsSnapshot* out) const {
+    uint32_t words[kNumWords];
+    float loads[ENGINE_STATS_WINDOW];
+
+    for (int attempt = 0; attempt < STATS_READ_ATTEMPTS; attempt++) {
+        uint32_t before = sequence_.load(std::memory_order_acquire);
+        if (before == 0) return false;   // Nothing recorded yet
+        if (before & 1) continue;        // Write in progress
+
+        for (uint32_t w = 0; w < kNumWords; w++) {
+            words[w] = words_[w].load(std::memory_order_relaxed);
+        }
+        for (uint32_t i = 0; i < ENGINE_STATS_WINDOW; i++) {
+            loads[i] = load_history_[i].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) != before) continue;
+
+        memcpy(out, words, sizeof(words));
+
+        // Window statistics over the blocks recorded so far
+        uint32_t count = std::min<uint32_t>(out->block_count, ENGINE_STATS_WINDOW);
+        if (count == 0) count = 1;
+        out->load_max = *std::max_element(loads, loads + count);
+        uint32_t rank = (count * 99 + 99) / 100 - 1;
+        std::nth_element(loads, loads + rank, loads + count);
+        out->load_p99 = loads[rank];
+        return true;
+    }
+
+    return false;
+}
+
+#endif // MODAL_ENGINE_STATS
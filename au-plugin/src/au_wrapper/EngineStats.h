@@ -0,0 +1,109 @@
+/**
+ * @file EngineStats.h
+ * @brief Lock-free render instrumentation for ModalAttractorsEngine
+ *
+ * The render thread records one EngineStatsSnapshot per block (stage
+ * timings, voice counts, steal counts); any other thread can poll the
+ * latest one with modal_attractors_engine_get_stats(). Publication is a
+ * sequence lock over atomic words, so neither side ever blocks, and the
+ * reader also derives max/p99 load over the last ENGINE_STATS_WINDOW
+ * blocks from a ring the writer fills in O(1).
+ *
+ * Built only with MODAL_ENGINE_STATS (CMake option ENABLE_ENGINE_STATS);
+ * without it the engine carries no timers and get_stats returns false.
+ */
+
+#ifndef ENGINE_STATS_H
+#define ENGINE_STATS_H
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Blocks covered by load_max / load_p99
+ */
+#define ENGINE_STATS_WINDOW 256
+
+/**
+ * @brief Per-block render statistics (times in microseconds)
+ *
+ * load = block_us / budget_us, where budget_us is the real-time duration
+ * of the block; load_max and load_p99 cover the last ENGINE_STATS_WINDOW
+ * blocks (filled in by the reader).
+ */
+struct EngineStatsSnapshot {
+    uint32_t block_count;       ///< Blocks recorded since init, from 1 (wraps)
+    uint32_t block_frames;      ///< Frames in the last block
+    float control_us;           ///< Event application + modal step
+    float coupling_us;          ///< Topology coupling
+    float render_us;            ///< Voice bank render, output mix and master gain
+    float block_us;             ///< Whole render call
+    float budget_us;            ///< Real-time duration of the block
+    float load;                 ///< block_us / budget_us
+    float load_max;             ///< Max load over the window
+    float load_p99;             ///< 99th percentile load over the window
+    uint32_t active_voices;     ///< Voices holding a slot
+    uint32_t steal_count;       ///< Voices stolen by note on (since init)
+    uint32_t shed_count;        ///< Voices faded by the CPU budget (since init)
+};
+
+#ifdef MODAL_ENGINE_STATS
+
+#include <chrono>
+
+/**
+ * @brief Monotonic clock for stage timing
+ */
+static inline uint64_t engine_stats_now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+class EngineStats {
+public:
+    EngineStats() {
+        for (uint32_t w = 0; w < kNumWords; w++) words_[w].store(0, std::memory_order_relaxed);
+        for (uint32_t i = 0; i < ENGINE_STATS_WINDOW; i++) {
+            load_history_[i].store(0.0f, std::memory_order_relaxed);
+        }
+    }
+
+    EngineStats(const EngineStats&) = delete;
+    EngineStats& operator=(const EngineStats&) = delete;
+
+    /**
+     * @brief Publish one block (render thread only)
+     */
+    void record(const EngineStatsSnapshot& block);
+
+    /**
+     * @brief Copy the latest block and window statistics (any thread)
+     * @return False if nothing was recorded yet or the writer kept racing
+     */
+    bool read(EngineStatsSnapshot* out) const;
+
+private:
+    static const uint32_t kNumWords = sizeof(EngineStatsSnapshot) / sizeof(uint32_t);
+    static_assert(sizeof(EngineStatsSnapshot) % sizeof(uint32_t) == 0,
+                  "EngineStatsSnapshot must be a whole number of 32-bit words");
+
+    alignas(64) std::atomic<uint32_t> sequence_{0};   ///< Odd while writing
+    std::atomic<uint32_t> words_[kNumWords];           ///< Latest snapshot
+    std::atomic<float> load_history_[ENGINE_STATS_WINDOW];
+};
+
+/**
+ * @brief Time a stage: BEGIN declares a start stamp, END adds µs to field
+ */
+#define ENGINE_STATS_BEGIN(stamp) const uint64_t stamp = engine_stats_now_ns()
+#define ENGINE_STATS_END(stamp, field) \
+    ((field) += static_cast<float>(engine_stats_now_ns() - (stamp)) * 1e-3f)
+
+#else
+
+#define ENGINE_STATS_BEGIN(stamp) ((void)0)
+#define ENGINE_STATS_END(stamp, field) ((void)0)
+
+#endif // MODAL_ENGINE_STATS
+
+#endif // ENGINE_STATS_H
@@ -15,6 +15,9 @@
 #define MODAL_ATTRACTORS_AU_H
 
 #include <cstdint>
+#include "EngineEvents.h"
+#include "EngineStats.h"
+#include "ModalParameters.h"
 
 // NOTE: This file is a C++ header skeleton. The actual AU implementation
 // would be in Objective-C++ (.mm file) and would include:
@@ -34,6 +37,7 @@
 // Forward declarations
 class VoiceAllocator;
 class TopologyEngine;
+class HalfbandResampler;
 
 /**
  * @brief C++ wrapper for AU plugin state
@@ -43,15 +47,48 @@ class TopologyEngine;
  */
 struct ModalAttractorsEngine {
     VoiceAllocator* voice_allocator;
-    TopologyEngine* topology_engine;
+    TopologyEngine* topology_engine;     // Owned by the render thread
+
+    // Control → render thread hand-over (see EngineEvents.h)
+    EngineEventQueue* events;             // Note/parameter events
+    TopologyExchange* topology_exchange;  // Topologies built off-thread
+    VoicePoolExchange* pool_exchange;     // Voice pools for a new polyphony
+
+#ifdef MODAL_ENGINE_STATS
+    // Render instrumentation (see EngineStats.h)
+    EngineStats* stats;                   // Published once per block
+    EngineStatsSnapshot stats_block;      // Block being measured (render thread)
+#endif
 
     float sample_rate;
-    uint32_t max_polyphony;
+    uint32_t max_polyphony;          // Requested (calling thread); the render
+                                     // thread uses its allocator's
+
+    // Internal render rate (kParam_RenderRate, fixed at init). Voices,
+    // control ticks and event offsets run at internal_rate; other rates
+    // render in chunks and resample every output bus to the host rate
+    int render_rate;                 // kRenderRate_*
+    int rate_shift;                  // log2(internal_rate / sample_rate): -1, 0 or 1
+    float internal_rate;             // Voice sample rate (Hz)
+    HalfbandResampler* resamplers;   // One per output channel (non-host rates)
+    float* resample_input;           // Internal-rate chunk, per output channel
+    float* resample_output;          // Host-rate chunk plus carried sample, per channel
+    uint32_t resample_carry;         // Half rate: interpolated frames not yet output (0 or 1)
+    uint32_t resample_channels;      // Channels resampled by the previous block
 
-    // Parameter cache (updated from AU parameter changes)
+    // Control-rate scheduling (integer phase in units of 1/CONTROL_RATE_HZ
+    // samples, so ticks land exactly CONTROL_RATE_HZ times per second)
+    uint32_t control_period;         // Internal rate, rounded to whole Hz
+    uint32_t control_phase;          // Phase within current control period
+    uint32_t max_block_size;         // Largest voice render sub-block (frames)
+
+    // Parameter cache (updated on the render thread as events apply,
+    // except topology_type and topology_seed which belong to the calling thread)
     float master_gain;
     float coupling_strength;
     int topology_type;
+    uint32_t topology_seed;
+    float topology_morph_time;       // Seconds to morph into a new topology
     int personality;
 
     // Per-mode parameters (4 modes)
@@ -63,18 +100,31 @@ struct ModalAttractorsEngine {
     float poke_strength;
     float poke_duration_ms;
 
+    // Stereo placement (applies to notes started afterwards)
+    float stereo_width;
+    float mode_spread;
+
     bool initialized;
 };
 
 /**
  * @brief Initialize the DSP engine
+ *
+ * With kRenderRate_Half the voices cost half as much (modes above a
+ * quarter of the host rate alias); with kRenderRate_Double they cost
+ * twice as much and partials up to the host Nyquist rate are rendered
+ * without aliasing. Both add modal_attractors_engine_get_latency() frames
+ * of delay.
+ *
  * @param engine Engine state struct
- * @param sample_rate Sample rate in Hz
+ * @param sample_rate Host sample rate in Hz
  * @param max_polyphony Maximum number of voices
+ * @param render_rate Internal render rate (kRenderRate_*)
  */
 void modal_attractors_engine_init(ModalAttractorsEngine* engine,
                                   float sample_rate,
-                                  uint32_t max_polyphony);
+                                  uint32_t max_polyphony,
+                                  int render_rate = kRenderRate_Default);
 
 /**
  * @brief Clean up engine resources
@@ -84,21 +134,32 @@ void modal_attractors_engine_cleanup(ModalAttractorsEngine* engine);
 
 /**
  * @brief Process MIDI note on
+ *
+ * Note and parameter calls are queued and applied by the next render call
+ * at sample_offset frames into its block (offsets past the block end are
+ * applied at its last frame). They are lock-free and may be called from
+ * one thread other than the render thread (single producer). Events are
+ * dropped if more than ENGINE_EVENT_QUEUE_SIZE are pending.
+ *
  * @param engine Engine state
  * @param note MIDI note number
  * @param velocity MIDI velocity (0-127)
+ * @param sample_offset Frame within the next render block
  */
 void modal_attractors_engine_note_on(ModalAttractorsEngine* engine,
                                      uint8_t note,
-                                     uint8_t velocity);
+                                     uint8_t velocity,
+                                     uint32_t sample_offset = 0);
 
 /**
  * @brief Process MIDI note off
  * @param engine Engine state
  * @param note MIDI note number
+ * @param sample_offset Frame within the next render block
  */
 void modal_attractors_engine_note_off(ModalAttractorsEngine* engine,
-                                      uint8_t note);
+                                      uint8_t note,
+                                      uint32_t sample_offset = 0);
 
 /**
  * @brief Render audio
@@ -112,14 +173,105 @@ void modal_attractors_engine_render(ModalAttractorsEngine* engine,
                                     float* outR,
                                     uint32_t num_frames);
 
+/**
+ * @brief Render audio plus one deinterleaved bus per mode
+ *
+ * mode_out[k] receives mode k of every voice (dry, before panning, after
+ * master gain), rendered in the same pass over the voices as the stereo
+ * mix, which matches modal_attractors_engine_render() up to float
+ * summation order. With num_mode_out = 0 this is exactly
+ * modal_attractors_engine_render().
+ *
+ * @param engine Engine state
+ * @param outL Left channel output
+ * @param outR Right channel output
+ * @param mode_out Mode bus outputs (num_frames each)
+ * @param num_mode_out Entries in mode_out (<= MAX_MODES; modes past it
+ *                     are only in the stereo mix)
+ * @param num_frames Number of frames to render
+ */
+void modal_attractors_engine_render_modes(ModalAttractorsEngine* engine,
+                                          float* outL,
+                                          float* outR,
+                                          float* const* mode_out,
+                                          uint32_t num_mode_out,
+                                          uint32_t num_frames);
+
+/**
+ * @brief Render into caller-owned planar channels (AudioBufferList style)
+ *
+ * Channels 0 and 1 are the stereo mix, channels 2 .. 2 + MAX_MODES - 1
+ * the mode buses of modal_attractors_engine_render_modes(); extra
+ * channels are left untouched. With accumulate the engine adds into the
+ * buffers, so a host or offline renderer can mix straight into buffers
+ * it already holds, with no clear or copy on either side.
+ *
+ * @param engine Engine state
+ * @param channels num_channels pointers to num_frames samples each
+ * @param num_channels Channel count (at least 2; fewer renders nothing)
+ * @param num_frames Number of frames to render
+ * @param accumulate Add into the channels instead of overwriting them
+ */
+void modal_attractors_engine_render_channels(ModalAttractorsEngine* engine,
+                                             float* const* channels,
+                                             uint32_t num_channels,
+                                             uint32_t num_frames,
+                                             bool accumulate = false);
+
 /**
  * @brief Update parameter
+ *
+ * Queued like note events. kParam_Topology is the exception: the new
+ * topology is generated here, on the calling thread (allocates), and the
+ * render thread morphs into it over kParam_TopologyMorphTime starting at
+ * its next control tick (immediately if 0).
+ *
+ * kParam_Polyphony is handled the same way: a voice pool and topology for
+ * the new voice count are built here, and the render thread swaps them in
+ * at its next control tick, carrying sounding voices over without a gap
+ * (see VoiceAllocator::adoptVoices). Topology changes made before that
+ * tick wait for the swap.
+ *
  * @param engine Engine state
  * @param param_id Parameter ID
  * @param value Parameter value
+ * @param sample_offset Frame within the next render block
  */
 void modal_attractors_engine_set_parameter(ModalAttractorsEngine* engine,
                                            uint32_t param_id,
-                                           float value);
+                                           float value,
+                                           uint32_t sample_offset = 0);
+
+/**
+ * @brief Reseed every voice's noise generator (queued like note events)
+ *
+ * Rendering the same event sequence after the same seed reproduces the
+ * output exactly, including random poke phases. Topologies generated by
+ * later kParam_Topology calls use the seed too (taken immediately).
+ *
+ * @param engine Engine state
+ * @param seed Seed value
+ * @param sample_offset Frame within the next render block
+ */
+void modal_attractors_engine_set_seed(ModalAttractorsEngine* engine,
+                                      uint32_t seed,
+                                      uint32_t sample_offset = 0);
+
+/**
+ * @brief Output delay added by the render rate's resampler (host frames)
+ * @param engine Engine state
+ * @return 0 at kRenderRate_Host
+ */
+uint32_t modal_attractors_engine_get_latency(const ModalAttractorsEngine* engine);
+
+/**
+ * @brief Poll render statistics of the latest block (lock-free, any thread)
+ *
+ * @param engine Engine state
+ * @param stats Output snapshot
+ * @return False if built without ENABLE_ENGINE_STATS or nothing rendered yet
+ */
+bool modal_attractors_engine_get_stats(const ModalAttractorsEngine* engine,
+                                       EngineStatsSnapshot* stats);
 
 #endif // MODAL_ATTRACTORS_AU_H
@@ -10,11 +10,140 @@
 #include "ModalParameters.h"
 #include "../dsp_core/VoiceAllocator.h"
 #include "../dsp_core/TopologyEngine.h"
+#include "../dsp_core/RealtimeGuard.h"
+#include "../dsp_core/DenormalGuard.h"
+#include "../dsp_core/HalfbandResampler.h"
 #include <cstring>
+#include <cmath>
+#include <algorithm>
+
+/**
+ * @brief Output channels: stereo mix plus one bus per mode
+ */
+#define ENGINE_RENDER_CHANNELS (2 + MAX_MODES)
+
+/**
+ * @brief Host frames per resampled chunk (bounds the scratch buffers)
+ */
+#define ENGINE_RESAMPLE_CHUNK 256
+
+/**
+ * @brief Scratch stride per channel: a chunk at twice the host rate, or a
+ *        host-rate chunk plus the sample carried over at half rate
+ */
+#define ENGINE_RESAMPLE_STRIDE (2 * ENGINE_RESAMPLE_CHUNK)
+
+/**
+ * @brief Which internal frames of one render call a queued event maps to
+ *
+ * Event offsets are host frames into the host block. At the host rate one
+ * call covers the whole block; resampled renders cover one chunk of it in
+ * internal frames.
+ */
+struct EngineBlockClock {
+    uint32_t host_first;    ///< First host frame covered
+    uint32_t host_end;      ///< One past the last host frame covered
+    uint32_t host_last;     ///< Last frame of the host block (later offsets clamp here)
+    uint32_t last_frame;    ///< Last internal frame of the call
+    int rate_shift;         ///< log2(internal rate / host rate)
+};
+
+/**
+ * @brief Internal frame an event is due at, or UINT32_MAX if in a later call
+ */
+static uint32_t engine_event_frame(const EngineBlockClock& clock, uint32_t sample_offset) {
+    uint32_t host = std::min(sample_offset, clock.host_last);
+    if (host >= clock.host_end) return UINT32_MAX;
+
+    uint32_t frame = host > clock.host_first ? host - clock.host_first : 0;
+    frame = clock.rate_shift >= 0 ? frame << clock.rate_shift : frame >> -clock.rate_shift;
+    return std::min(frame, clock.last_frame);
+}
+
+/**
+ * @brief Start morphing into a topology published by modal_attractors_engine_set_parameter
+ */
+static void engine_swap_topology(ModalAttractorsEngine* engine) {
+    TopologyExchange* exchange = engine->topology_exchange;
+
+    // Previous one not yet collected by the producer: try next tick
+    if (exchange->retired.load(std::memory_order_acquire)) return;
+
+    TopologyEngine* next = exchange->pending.exchange(nullptr, std::memory_order_acq_rel);
+    if (!next) return;
+
+    // Built for a polyphony whose voice pool is published but not swapped
+    // in yet: put it back for the next tick, unless a newer one replaced it
+    if (next->getNumVoices() != engine->voice_allocator->getMaxPolyphony()) {
+        TopologyEngine* expected = nullptr;
+        if (!engine->pool_exchange->pending.load(std::memory_order_acquire) ||
+            !exchange->pending.compare_exchange_strong(expected, next, std::memory_order_acq_rel)) {
+            exchange->retired.store(next, std::memory_order_release);
+        }
+        return;
+    }
+
+    // Weights are copied (no allocation); the target goes back for freeing
+    engine->topology_engine->morphTo(*next, engine->topology_morph_time);
+    exchange->retired.store(next, std::memory_order_release);
+}
+
+/**
+ * @brief Free a voice pool and everything in it
+ */
+static void engine_delete_pool(VoicePool* pool) {
+    if (!pool) return;
+    delete pool->allocator;
+    delete pool->topology;
+    delete pool;
+}
+
+/**
+ * @brief Swap in a voice pool published for a new polyphony
+ *
+ * The new allocator adopts the sounding voices (no allocation) and the
+ * new topology takes the current coupling strength; the replaced pair
+ * goes back to the producer for freeing.
+ */
+static void engine_swap_voice_pool(ModalAttractorsEngine* engine) {
+    VoicePoolExchange* exchange = engine->pool_exchange;
+    if (exchange->retired.load(std::memory_order_acquire)) return;
+
+    VoicePool* next = exchange->pending.exchange(nullptr, std::memory_order_acq_rel);
+    if (!next) return;
+
+    next->allocator->adoptVoices(*engine->voice_allocator);
+    next->topology->setCouplingStrength(engine->coupling_strength);
+
+    std::swap(engine->voice_allocator, next->allocator);
+    std::swap(engine->topology_engine, next->topology);
+    exchange->retired.store(next, std::memory_order_release);
+}
+
+/**
+ * @brief Advance modal dynamics and coupling by one control tick
+ */
+static void engine_control_tick(ModalAttractorsEngine* engine) {
+    engine_swap_voice_pool(engine);
+    engine_swap_topology(engine);
+
+    VoiceAllocator* allocator = engine->voice_allocator;
+    ENGINE_STATS_BEGIN(control_start);
+    allocator->updateVoices();
+    ENGINE_STATS_END(control_start, engine->stats_block.control_us);
+
+    ENGINE_STATS_BEGIN(coupling_start);
+    engine->topology_engine->advanceMorph(CONTROL_DT);
+    engine->topology_engine->updateCoupling(allocator->getVoices(), allocator->getMaxPolyphony(),
+                                            allocator->getActiveVoices(),
+                                            allocator->getActiveVoiceCount());
+    ENGINE_STATS_END(coupling_start, engine->stats_block.coupling_us);
+}
 
 void modal_attractors_engine_init(ModalAttractorsEngine* engine,
                                   float sample_rate,
-                                  uint32_t max_polyphony) {
+                                  uint32_t max_polyphony,
+                                  int render_rate) {
     if (!engine) return;
 
     memset(engine, 0, sizeof(ModalAttractorsEngine));
@@ -22,17 +151,44 @@ void modal_attractors_engine_init(ModalAttractorsEngine* engine,
     engine->sample_rate = sample_rate;
     engine->max_polyphony = max_polyphony;
 
+    // Internal rate: voices render here, resampled to the host rate
+    engine->render_rate = std::max(kRenderRate_Min, std::min(kRenderRate_Max, render_rate));
+    engine->rate_shift = engine->render_rate - kRenderRate_Host;
+    engine->internal_rate = engine->rate_shift > 0 ? sample_rate * 2.0f
+                          : engine->rate_shift < 0 ? sample_rate * 0.5f
+                          : sample_rate;
+    if (engine->rate_shift != 0) {
+        engine->resamplers = new HalfbandResampler[ENGINE_RENDER_CHANNELS];
+        engine->resample_input = new float[ENGINE_RENDER_CHANNELS * ENGINE_RESAMPLE_STRIDE]();
+        engine->resample_output = new float[ENGINE_RENDER_CHANNELS * ENGINE_RESAMPLE_STRIDE]();
+    }
+
+    // First render call starts with a control tick
+    engine->control_period = static_cast<uint32_t>(lroundf(engine->internal_rate));
+    engine->control_phase = engine->control_period;
+
+    // Render sub-blocks never exceed one control interval
+    engine->max_block_size = (engine->control_period + CONTROL_RATE_HZ - 1) / CONTROL_RATE_HZ;
+
     // Create DSP components
     engine->voice_allocator = new VoiceAllocator(max_polyphony);
     engine->topology_engine = new TopologyEngine(max_polyphony);
+    engine->events = new EngineEventQueue();
+    engine->topology_exchange = new TopologyExchange();
+    engine->pool_exchange = new VoicePoolExchange();
+#ifdef MODAL_ENGINE_STATS
+    engine->stats = new EngineStats();
+#endif
 
     // Initialize
-    engine->voice_allocator->initialize(sample_rate);
+    engine->voice_allocator->initialize(engine->internal_rate, engine->max_block_size);
 
     // Set default parameters
     engine->master_gain = kMasterGain_Default;
     engine->coupling_strength = kCouplingStrength_Default;
     engine->topology_type = kTopology_Default;
+    engine->topology_seed = MODAL_DEFAULT_SEED;
+    engine->topology_morph_time = kTopologyMorphTime_Default;
     engine->personality = kPersonality_Default;
 
     // Initialize default mode parameters (harmonic series with slight detuning)
@@ -54,6 +210,11 @@ void modal_attractors_engine_init(ModalAttractorsEngine* engine,
     // Initialize default poke parameters
     engine->poke_strength = kPokeStrength_Default;
     engine->poke_duration_ms = kPokeDuration_Default;
+    engine->stereo_width = kStereoWidth_Default;
+    engine->mode_spread = kModeSpread_Default;
+
+    // Master gain is applied (smoothed) by the voice bank's output mix
+    engine->voice_allocator->setOutputGain(engine->master_gain, false);
 
     // Set default topology
     engine->topology_engine->generateTopology(
@@ -86,65 +247,421 @@ void modal_attractors_engine_cleanup(ModalAttractorsEngine* engine) {
         engine->topology_engine = nullptr;
     }
 
+    if (engine->topology_exchange) {
+        delete engine->topology_exchange->pending.load();
+        delete engine->topology_exchange->retired.load();
+        delete engine->topology_exchange;
+        engine->topology_exchange = nullptr;
+    }
+
+    if (engine->pool_exchange) {
+        engine_delete_pool(engine->pool_exchange->pending.load());
+        engine_delete_pool(engine->pool_exchange->retired.load());
+        delete engine->pool_exchange;
+        engine->pool_exchange = nullptr;
+    }
+
+    delete engine->events;
+    engine->events = nullptr;
+
+    delete[] engine->resamplers;
+    delete[] engine->resample_input;
+    delete[] engine->resample_output;
+    engine->resamplers = nullptr;
+    engine->resample_input = nullptr;
+    engine->resample_output = nullptr;
+
+#ifdef MODAL_ENGINE_STATS
+    delete engine->stats;
+    engine->stats = nullptr;
+#endif
+
     engine->initialized = false;
 }
 
+/**
+ * @brief Queue an event for the render thread (drops it if the queue is full)
+ */
+static void engine_post_event(ModalAttractorsEngine* engine, EngineEventType type,
+                              uint8_t note, uint8_t velocity,
+                              uint32_t param_id, float value, uint32_t sample_offset) {
+    EngineEvent event;
+    event.type = type;
+    event.note = note;
+    event.velocity = velocity;
+    event.param_id = param_id;
+    event.value = value;
+    event.sample_offset = sample_offset;
+    engine->events->push(event);
+}
+
+static void engine_apply_parameter(ModalAttractorsEngine* engine, uint32_t param_id, float value);
+
+/**
+ * @brief Apply queued events due at or before frame offset (render thread)
+ */
+static void engine_apply_events(ModalAttractorsEngine* engine, uint32_t offset,
+                                const EngineBlockClock& clock) {
+    const EngineEvent* event;
+    while ((event = engine->events->front()) != nullptr) {
+        if (engine_event_frame(clock, event->sample_offset) > offset) break;
+
+        switch (event->type) {
+            case EngineEventType::NoteOn:
+                engine->voice_allocator->noteOn(event->note, event->velocity);
+                break;
+
+            case EngineEventType::NoteOff:
+                engine->voice_allocator->noteOff(event->note);
+                break;
+
+            case EngineEventType::Parameter:
+                engine_apply_parameter(engine, event->param_id, event->value);
+                break;
+
+            case EngineEventType::Seed:
+                engine->voice_allocator->setSeed(event->param_id);
+                break;
+        }
+
+        engine->events->pop();
+    }
+}
+
 void modal_attractors_engine_note_on(ModalAttractorsEngine* engine,
                                      uint8_t note,
-                                     uint8_t velocity) {
+                                     uint8_t velocity,
+                                     uint32_t sample_offset) {
     if (!engine || !engine->initialized) return;
 
-    engine->voice_allocator->noteOn(note, velocity);
+    engine_post_event(engine, EngineEventType::NoteOn, note, velocity, 0, 0.0f, sample_offset);
 }
 
 void modal_attractors_engine_note_off(ModalAttractorsEngine* engine,
-                                      uint8_t note) {
+                                      uint8_t note,
+                                      uint32_t sample_offset) {
     if (!engine || !engine->initialized) return;
 
-    engine->voice_allocator->noteOff(note);
+    engine_post_event(engine, EngineEventType::NoteOff, note, 0, 0, 0.0f, sample_offset);
 }
 
-void modal_attractors_engine_render(ModalAttractorsEngine* engine,
-                                    float* outL,
-                                    float* outR,
-                                    uint32_t num_frames) {
+void modal_attractors_engine_set_seed(ModalAttractorsEngine* engine,
+                                      uint32_t seed,
+                                      uint32_t sample_offset) {
+    if (!engine || !engine->initialized) return;
+
+    engine->topology_seed = seed;
+    engine_post_event(engine, EngineEventType::Seed, 0, 0, seed, 0.0f, sample_offset);
+}
+
+/**
+ * @brief Render num_frames internal-rate frames, running control ticks and events
+ */
+static void engine_render_frames(ModalAttractorsEngine* engine, float* outL, float* outR,
+                                 float* const* mode_out, uint32_t num_mode_out,
+                                 uint32_t num_frames, bool accumulate,
+                                 const EngineBlockClock& clock) {
+    // Split the block at control-tick boundaries so the modal dynamics
+    // run at CONTROL_RATE_HZ regardless of the host buffer size, and at
+    // queued event offsets so notes and parameters land sample-accurately
+    float* sub_mode_out[MAX_MODES];
+    uint32_t offset = 0;
+    while (offset < num_frames) {
+        ENGINE_STATS_BEGIN(events_start);
+        engine_apply_events(engine, offset, clock);
+        ENGINE_STATS_END(events_start, engine->stats_block.control_us);
+
+        if (engine->control_phase >= engine->control_period) {
+            engine->control_phase -= engine->control_period;
+            engine_control_tick(engine);
+        }
+
+        // Samples until the next tick (rounded up)
+        uint32_t until_tick = (engine->control_period - engine->control_phase
+                               + CONTROL_RATE_HZ - 1) / CONTROL_RATE_HZ;
+        uint32_t sub_frames = std::min(until_tick, num_frames - offset);
+
+        // ...or until the next queued event
+        const EngineEvent* next = engine->events->front();
+        if (next) {
+            uint32_t event_offset = engine_event_frame(clock, next->sample_offset);
+            if (event_offset > offset) sub_frames = std::min(sub_frames, event_offset - offset);
+        }
+
+        // Render audio
+        ENGINE_STATS_BEGIN(render_start);
+        for (uint32_t k = 0; k < num_mode_out; k++) sub_mode_out[k] = mode_out[k] + offset;
+        engine->voice_allocator->renderAudio(outL + offset, outR + offset, sub_frames,
+                                             sub_mode_out, num_mode_out, accumulate);
+        ENGINE_STATS_END(render_start, engine->stats_block.render_us);
+
+        engine->control_phase += sub_frames * CONTROL_RATE_HZ;
+        offset += sub_frames;
+    }
+}
+
+/**
+ * @brief Copy or add a resampled chunk into a caller buffer
+ */
+static void engine_emit(float* out, const float* in, uint32_t num_frames, bool accumulate) {
+    if (accumulate) {
+        for (uint32_t i = 0; i < num_frames; i++) out[i] += in[i];
+    } else {
+        memcpy(out, in, num_frames * sizeof(float));
+    }
+}
+
+/**
+ * @brief Render at half or twice the host rate and resample every bus
+ *
+ * Works in chunks of ENGINE_RESAMPLE_CHUNK host frames. At half rate a
+ * chunk of n frames needs ceil(n / 2) internal frames minus the frame
+ * carried over; the odd interpolated frame is carried to the next chunk.
+ */
+static void engine_render_resampled(ModalAttractorsEngine* engine, float* outL, float* outR,
+                                    float* const* mode_out, uint32_t num_mode_out,
+                                    uint32_t num_frames, bool accumulate) {
+    const uint32_t num_channels = 2 + num_mode_out;
+    float* input[ENGINE_RENDER_CHANNELS];
+    float* output[ENGINE_RENDER_CHANNELS];
+    float* host_out[ENGINE_RENDER_CHANNELS] = {outL, outR};
+    for (uint32_t c = 0; c < num_channels; c++) {
+        input[c] = engine->resample_input + c * ENGINE_RESAMPLE_STRIDE;
+        output[c] = engine->resample_output + c * ENGINE_RESAMPLE_STRIDE;
+        if (c >= 2) host_out[c] = mode_out[c - 2];
+    }
+
+    // Buses not rendered last block restart from silence
+    for (uint32_t c = engine->resample_channels; c < num_channels; c++) {
+        engine->resamplers[c].reset();
+        output[c][0] = 0.0f;
+    }
+    engine->resample_channels = num_channels;
+
+    EngineBlockClock clock;
+    clock.host_last = num_frames - 1;
+    clock.rate_shift = engine->rate_shift;
+
+    for (uint32_t done = 0; done < num_frames;) {
+        uint32_t chunk = std::min(static_cast<uint32_t>(ENGINE_RESAMPLE_CHUNK), num_frames - done);
+        uint32_t carry = engine->resample_carry;
+        uint32_t internal_frames = engine->rate_shift > 0 ? 2 * chunk : (chunk - carry + 1) / 2;
+
+        clock.host_first = done;
+        clock.host_end = done + chunk;
+        clock.last_frame = internal_frames > 0 ? internal_frames - 1 : 0;
+        if (internal_frames > 0) {
+            engine_render_frames(engine, input[0], input[1], input + 2, num_mode_out,
+                                 internal_frames, false, clock);
+        } else {
+            // The carried frame covers this one-frame chunk; events in it
+            // take effect from the next internal frame
+            engine_apply_events(engine, 0, clock);
+        }
+
+        ENGINE_STATS_BEGIN(resample_start);
+        for (uint32_t c = 0; c < num_channels; c++) {
+            if (engine->rate_shift > 0) {
+                engine->resamplers[c].downsample(input[c], output[c], chunk);
+                engine_emit(host_out[c] + done, output[c], chunk, accumulate);
+            } else {
+                float* stream = output[c];
+                engine->resamplers[c].upsample(input[c], stream + carry, internal_frames);
+                engine_emit(host_out[c] + done, stream, chunk, accumulate);
+                stream[0] = stream[chunk];
+            }
+        }
+        ENGINE_STATS_END(resample_start, engine->stats_block.render_us);
+
+        if (engine->rate_shift < 0) engine->resample_carry = carry + 2 * internal_frames - chunk;
+        done += chunk;
+    }
+}
+
+/**
+ * @brief Render into stereo and optional mode bus outputs (all entry points)
+ */
+static void engine_render(ModalAttractorsEngine* engine, float* outL, float* outR,
+                          float* const* mode_out, uint32_t num_mode_out,
+                          uint32_t num_frames, bool accumulate) {
+    if (!mode_out) num_mode_out = 0;
+    if (num_mode_out > MAX_MODES) num_mode_out = MAX_MODES;
+
     if (!engine || !engine->initialized) {
-        // Return silence
+        // Return silence (nothing to add when accumulating)
+        if (accumulate) return;
         memset(outL, 0, num_frames * sizeof(float));
         memset(outR, 0, num_frames * sizeof(float));
+        for (uint32_t k = 0; k < num_mode_out; k++) memset(mode_out[k], 0, num_frames * sizeof(float));
         return;
     }
 
-    // Update voices at control rate
-    // (simplified - in real implementation, only update at control rate intervals)
-    engine->voice_allocator->updateVoices();
-
-    // Update coupling between voices
-    ModalVoice** voices = new ModalVoice*[engine->max_polyphony];
-    for (uint32_t i = 0; i < engine->max_polyphony; i++) {
-        voices[i] = engine->voice_allocator->getVoice(i);
+    MODAL_REALTIME_SCOPE();
+    MODAL_DENORMAL_SCOPE();
+    ENGINE_STATS_BEGIN(block_start);
+
+    if (engine->rate_shift == 0) {
+        EngineBlockClock clock = {0, num_frames, num_frames - 1, num_frames - 1, 0};
+        engine_render_frames(engine, outL, outR, mode_out, num_mode_out,
+                             num_frames, accumulate, clock);
+    } else {
+        engine_render_resampled(engine, outL, outR, mode_out, num_mode_out,
+                                num_frames, accumulate);
     }
-    engine->topology_engine->updateCoupling(voices, engine->max_polyphony);
-    delete[] voices;
 
-    // Render audio
-    engine->voice_allocator->renderAudio(outL, outR, num_frames);
+#ifdef MODAL_ENGINE_STATS
+    EngineStatsSnapshot* block = &engine->stats_block;
+    ENGINE_STATS_END(block_start, block->block_us);
+    block->block_count++;
+    block->block_frames = num_frames;
+    block->budget_us = num_frames * 1e6f / engine->sample_rate;
+    block->load = block->budget_us > 0.0f ? block->block_us / block->budget_us : 0.0f;
+    block->active_voices = engine->voice_allocator->getActiveVoiceCount();
+    block->steal_count = engine->voice_allocator->getStealCount();
+    block->shed_count = engine->voice_allocator->getShedCount();
+    engine->stats->record(*block);
+
+    // Stage accumulators restart for the next block
+    block->control_us = 0.0f;
+    block->coupling_us = 0.0f;
+    block->render_us = 0.0f;
+    block->block_us = 0.0f;
+#endif
+}
+
+void modal_attractors_engine_render(ModalAttractorsEngine* engine,
+                                    float* outL,
+                                    float* outR,
+                                    uint32_t num_frames) {
+    engine_render(engine, outL, outR, nullptr, 0, num_frames, false);
+}
+
+void modal_attractors_engine_render_modes(ModalAttractorsEngine* engine,
+                                          float* outL,
+                                          float* outR,
+                                          float* const* mode_out,
+                                          uint32_t num_mode_out,
+                                          uint32_t num_frames) {
+    engine_render(engine, outL, outR, mode_out, num_mode_out, num_frames, false);
+}
+
+void modal_attractors_engine_render_channels(ModalAttractorsEngine* engine,
+                                             float* const* channels,
+                                             uint32_t num_channels,
+                                             uint32_t num_frames,
+                                             bool accumulate) {
+    if (!channels || num_channels < 2) return;
+
+    engine_render(engine, channels[0], channels[1], channels + 2, num_channels - 2,
+                  num_frames, accumulate);
+}
+
+uint32_t modal_attractors_engine_get_latency(const ModalAttractorsEngine* engine) {
+    if (!engine || !engine->initialized) return 0;
+
+    // HALFBAND_LATENCY is counted at the high rate: the host rate when
+    // upsampling, twice it when decimating
+    if (engine->rate_shift < 0) return HALFBAND_LATENCY;
+    if (engine->rate_shift > 0) return (HALFBAND_LATENCY + 1) / 2;
+    return 0;
+}
+
+bool modal_attractors_engine_get_stats(const ModalAttractorsEngine* engine,
+                                       EngineStatsSnapshot* stats) {
+#ifdef MODAL_ENGINE_STATS
+    if (!engine || !engine->initialized || !stats) return false;
+    return engine->stats->read(stats);
+#else
+    (void)engine;
+    (void)stats;
+    return false;
+#endif
+}
 
-    // Apply master gain
-    for (uint32_t i = 0; i < num_frames; i++) {
-        outL[i] *= engine->master_gain;
-        outR[i] *= engine->master_gain;
+/**
+ * @brief Map Topology parameter value to topology type
+ */
+static TopologyType topology_from_index(int index) {
+    switch (index) {
+        case 0: return TopologyType::Ring;
+        case 1: return TopologyType::SmallWorld;
+        case 2: return TopologyType::Clustered;
+        case 3: return TopologyType::HubSpoke;
+        case 4: return TopologyType::Random;
+        case 5: return TopologyType::Complete;
+        case 6: return TopologyType::None;
+        default: return TopologyType::Ring;
     }
 }
 
+/**
+ * @brief Build a voice pool for a new polyphony and publish it (calling thread)
+ *
+ * Allocates the voices, render state and topology here; the render
+ * thread only swaps pointers and copies the sounding voices over.
+ */
+static void engine_set_polyphony(ModalAttractorsEngine* engine, int polyphony) {
+    uint32_t num_voices = static_cast<uint32_t>(std::max(kPolyphony_Min, std::min(kPolyphony_Max, polyphony)));
+    if (num_voices == engine->max_polyphony) return;
+    engine->max_polyphony = num_voices;
+
+    VoicePoolExchange* exchange = engine->pool_exchange;
+    engine_delete_pool(exchange->retired.exchange(nullptr, std::memory_order_acq_rel));
+
+    VoicePool* pool = new VoicePool();
+    pool->allocator = new VoiceAllocator(num_voices);
+    pool->allocator->initialize(engine->internal_rate, engine->max_block_size);
+    pool->topology = new TopologyEngine(num_voices);
+    pool->topology->setSeed(engine->topology_seed);
+    pool->topology->generateTopology(topology_from_index(engine->topology_type), kCouplingStrength_Default);
+
+    // A topology still pending was built for the old voice count; the
+    // pool's one already has the latest type
+    TopologyExchange* topologies = engine->topology_exchange;
+    delete topologies->retired.exchange(nullptr, std::memory_order_acq_rel);
+    delete topologies->pending.exchange(nullptr, std::memory_order_acq_rel);
+
+    // Replaces (and frees) one the render thread has not picked up yet
+    engine_delete_pool(exchange->pending.exchange(pool, std::memory_order_acq_rel));
+}
+
 void modal_attractors_engine_set_parameter(ModalAttractorsEngine* engine,
                                            uint32_t param_id,
-                                           float value) {
+                                           float value,
+                                           uint32_t sample_offset) {
     if (!engine || !engine->initialized) return;
 
+    if (param_id == kParam_Polyphony) {
+        engine_set_polyphony(engine, static_cast<int>(lroundf(value)));
+        return;
+    }
+
+    if (param_id != kParam_Topology) {
+        engine_post_event(engine, EngineEventType::Parameter, 0, 0, param_id, value, sample_offset);
+        return;
+    }
+
+    // Topology: generate here (allocates, O(edges log edges)), morph on render thread
+    TopologyExchange* exchange = engine->topology_exchange;
+    delete exchange->retired.exchange(nullptr, std::memory_order_acq_rel);
+
+    engine->topology_type = static_cast<int>(value);
+    TopologyEngine* topology = new TopologyEngine(engine->max_polyphony);
+    topology->setSeed(engine->topology_seed);
+    topology->generateTopology(topology_from_index(engine->topology_type), kCouplingStrength_Default);
+
+    // Replaces (and frees) one the render thread has not picked up yet
+    delete exchange->pending.exchange(topology, std::memory_order_acq_rel);
+}
+
+/**
+ * @brief Apply a parameter change (render thread)
+ */
+static void engine_apply_parameter(ModalAttractorsEngine* engine, uint32_t param_id, float value) {
     switch (param_id) {
         case kParam_MasterGain:
             engine->master_gain = value;
+            engine->voice_allocator->setOutputGain(value);
             break;
 
         case kParam_CouplingStrength:
@@ -152,23 +669,6 @@ void modal_attractors_engine_set_parameter(ModalAttractorsEngine* engine,
             engine->topology_engine->setCouplingStrength(value);
             break;
 
-        case kParam_Topology: {
-            engine->topology_type = static_cast<int>(value);
-            // Map int to topology type
-            TopologyType topo = TopologyType::Ring;
-            switch (engine->topology_type) {
-                case 0: topo = TopologyType::Ring; break;
-                case 1: topo = TopologyType::SmallWorld; break;
-                case 2: topo = TopologyType::Clustered; break;
-                case 3: topo = TopologyType::HubSpoke; break;
-                case 4: topo = TopologyType::Random; break;
-                case 5: topo = TopologyType::Complete; break;
-                case 6: topo = TopologyType::None; break;
-            }
-            engine->topology_engine->generateTopology(topo, engine->coupling_strength);
-            break;
-        }
-
         case kParam_Personality: {
             engine->personality = static_cast<int>(value);
             // Map int to personality type
@@ -181,79 +681,81 @@ void modal_attractors_engine_set_parameter(ModalAttractorsEngine* engine,
             break;
         }
 
+        // Mode parameters only move targets; the allocator ramps them and
+        // retunes the voices once per control tick
         // Mode 0 parameters
         case kParam_Mode0_Frequency:
             engine->mode_freq_multipliers[0] = value;
-            engine->voice_allocator->setModeParameters(0, value,
+            engine->voice_allocator->setModeParameterTargets(0, value,
                 engine->mode_dampings[0], engine->mode_weights[0]);
             break;
 
         case kParam_Mode0_Damping:
             engine->mode_dampings[0] = value;
-            engine->voice_allocator->setModeParameters(0,
+            engine->voice_allocator->setModeParameterTargets(0,
                 engine->mode_freq_multipliers[0], value, engine->mode_weights[0]);
             break;
 
         case kParam_Mode0_Weight:
             engine->mode_weights[0] = value;
-            engine->voice_allocator->setModeParameters(0,
+            engine->voice_allocator->setModeParameterTargets(0,
                 engine->mode_freq_multipliers[0], engine->mode_dampings[0], value);
             break;
 
         // Mode 1 parameters
         case kParam_Mode1_Frequency:
             engine->mode_freq_multipliers[1] = value;
-            engine->voice_allocator->setModeParameters(1, value,
+            engine->voice_allocator->setModeParameterTargets(1, value,
                 engine->mode_dampings[1], engine->mode_weights[1]);
             break;
 
         case kParam_Mode1_Damping:
             engine->mode_dampings[1] = value;
-            engine->voice_allocator->setModeParameters(1,
+            engine->voice_allocator->setModeParameterTargets(1,
                 engine->mode_freq_multipliers[1], value, engine->mode_weights[1]);
             break;
 
         case kParam_Mode1_Weight:
             engine->mode_weights[1] = value;
-            engine->voice_allocator->setModeParameters(1,
+            engine->voice_allocator->setModeParameterTargets(1,
                 engine->mode_freq_multipliers[1], engine->mode_dampings[1], value);
             break;
 
         // Mode 2 parameters
         case kParam_Mode2_Frequency:
             engine->mode_freq_multipliers[2] = value;
-            engine->voice_allocator->setModeParameters(2, value,
+            engine->voice_allocator->setModeParameterTargets(2, value,
                 engine->mode_dampings[2], engine->mode_weights[2]);
             break;
 
         case kParam_Mode2_Damping:
             engine->mode_dampings[2] = value;
-            engine->voice_allocator->setModeParameters(2,
+            engine->voice_allocator->setModeParameterTargets(2,
                 engine->mode_freq_multipliers[2], value, engine->mode_weights[2]);
             break;
 
         case kParam_Mode2_Weight:
             engine->mode_weights[2] = value;
-            engine->voice_allocator->setModeParameters(2,
+            engine->voice_allocator->setModeParameterTargets(2,
                 engine->mode_freq_multipliers[2], engine->mode_dampings[2], value);
             break;
 
         // Mode 3 parameters
         case kParam_Mode3_Frequency:
             engine->mode_freq_multipliers[3] = value;
-            engine->voice_allocator->setModeParameters(3, value,
+            engine->voice_allocator->setModeParameterTargets(3, value,
                 engine->mode_dampings[3], engine->mode_weights[3]);
             break;
 
         case kParam_Mode3_Damping:
             engine->mode_dampings[3] = value;
-            engine->voice_allocator->setModeParameters(3,
+            engine->voice_allocator->setModeParameterTargets(3,
                 engine->mode_freq_multipliers[3], value, engine->mode_weights[3]);
             break;
 
         case kParam_Mode3_Weight:
             engine->mode_weights[3] = value;
-            engine->voice_allocator->setModeParameters(3,
+            engine->voice_allocator->setModeParameterTargets(3,
                 engine->mode_freq_multipliers[3], engine->mode_dampings[3], value);
             break;
 
@@ -268,9 +770,26 @@ void modal_attractors_engine_set_parameter(ModalAttractorsEngine* engine,
             engine->voice_allocator->setPokeDuration(value);
             break;
 
-        // Note: Polyphony cannot be changed at runtime (would require reallocation)
+        case kParam_TopologyMorphTime:
+            engine->topology_morph_time = value;
+            break;
+
+        case kParam_StereoWidth:
+            engine->stereo_width = value;
+            engine->voice_allocator->setStereoWidth(value);
+            break;
+
+        case kParam_ModeSpread:
+            engine->mode_spread = value;
+            engine->voice_allocator->setModeSpread(value);
+            break;
+
+        // Polyphony swaps voice pools (modal_attractors_engine_set_parameter)
         case kParam_Polyphony:
-            // Ignore - polyphony is set at initialization only
+            break;
+
+        // Render rate re-initializes every voice (modal_attractors_engine_init)
+        case kParam_RenderRate:
             break;
 
         default:
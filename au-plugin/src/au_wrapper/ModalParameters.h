@@ -46,6 +46,16 @@ enum {
     kParam_Polyphony,
     kParam_Personality,
 
+    // Topology parameters
+    kParam_TopologyMorphTime,
+
+    // Stereo parameters
+    kParam_StereoWidth,
+    kParam_ModeSpread,
+
+    // Quality parameters
+    kParam_RenderRate,
+
     kNumParams
 };
 
@@ -90,7 +100,7 @@ enum {
 #define kPokeDuration_Max 50.0f
 #define kPokeDuration_Default 10.0f
 
-// Polyphony: 1 to 32 voices
+// Polyphony: 1 to 32 voices (changes swap in a new voice pool, see set_parameter)
 #define kPolyphony_Min 1
 #define kPolyphony_Max 32
 #define kPolyphony_Default 16
@@ -100,6 +110,30 @@ enum {
 #define kPersonality_Max 1
 #define kPersonality_Default 0
 
+// Topology morph time: 0.0 to 10.0 seconds (0 = switch immediately)
+#define kTopologyMorphTime_Min 0.0f
+#define kTopologyMorphTime_Max 10.0f
+#define kTopologyMorphTime_Default 0.0f
+
+// Stereo width (keyboard panning): 0.0 (mono) to 1.0
+#define kStereoWidth_Min 0.0f
+#define kStereoWidth_Max 1.0f
+#define kStereoWidth_Default 0.0f
+
+// Mode spread around the voice pan: 0.0 to 1.0
+#define kModeSpread_Min 0.0f
+#define kModeSpread_Max 1.0f
+#define kModeSpread_Default 0.0f
+
+// Internal render rate: voices render at half, the host or twice the host
+// rate and the output buses are resampled (set at initialization only)
+#define kRenderRate_Half 0
+#define kRenderRate_Host 1
+#define kRenderRate_Double 2
+#define kRenderRate_Min kRenderRate_Half
+#define kRenderRate_Max kRenderRate_Double
+#define kRenderRate_Default kRenderRate_Host
+
 // ============================================================================
 // Parameter Names
 // ============================================================================
@@ -111,5 +145,9 @@ enum {
 #define kParamName_PokeDuration "Poke Duration"
 #define kParamName_Polyphony "Polyphony"
 #define kParamName_Personality "Personality"
+#define kParamName_TopologyMorphTime "Topology Morph Time"
+#define kParamName_StereoWidth "Stereo Width"
+#define kParamName_ModeSpread "Mode Spread"
+#define kParamName_RenderRate "Render Rate"
 
 #endif // MODAL_PARAMETERS_H
@@ -0,0 +1,92 @@
+/**
+ * @file HalfbandResampler.cpp
+ * @brief Polyphase half-band 2× interpolator / decimator
+ *
+ * Prototype h[n] = sin(πn/2)/(πn) · blackman(n) for odd |n| < 2H, with
+ * h[0] = 1/2 and h[even] = 0. taps_ holds the odd-n taps, normalized to
+ * sum to 1/2 so the two branches add up to unity DC gain.
+ */
+
+#include "HalfbandResampler.h"
+#include <cmath>
+#include <cstring>
+
+HalfbandResampler::HalfbandResampler() {
+    const double pi = 3.14159265358979323846;
+    const double half_width = 2.0 * HALFBAND_HALF_LENGTH;
+
+    double sum = 0.0;
+    double taps[HALFBAND_PHASE_TAPS];
+    for (uint32_t i = 0; i < HALFBAND_PHASE_TAPS; i++) {
+        double n = 2.0 * i - (HALFBAND_PHASE_TAPS - 1);
+        double window = 0.42 + 0.5 * cos(pi * n / half_width) + 0.08 * cos(2.0 * pi * n / half_width);
+        taps[i] = sin(pi * n / 2.0) / (pi * n) * window;
+        sum += taps[i];
+    }
+    for (uint32_t i = 0; i < HALFBAND_PHASE_TAPS; i++) {
+        taps_[i] = static_cast<float>(0.5 * taps[i] / sum);
+    }
+
+    reset();
+}
+
+void HalfbandResampler::reset() {
+    memset(fir_work_, 0, sizeof(fir_work_));
+    memset(delay_work_, 0, sizeof(delay_work_));
+}
+
+void HalfbandResampler::filter(const float* in, float* out, uint32_t n) const {
+    for (uint32_t i = 0; i < n; i++) out[i] = 0.0f;
+    for (uint32_t t = 0; t < HALFBAND_PHASE_TAPS; t++) {
+        const float tap = taps_[t];
+        const float* x = in + t;
+        for (uint32_t i = 0; i < n; i++) out[i] += tap * x[i];
+    }
+}
+
+void HalfbandResampler::upsample(const float* in, float* out, uint32_t num_in) {
+    const uint32_t history = HALFBAND_PHASE_TAPS - 1;
+    float filtered[HALFBAND_BLOCK];
+
+    while (num_in > 0) {
+        uint32_t n = num_in < HALFBAND_BLOCK ? num_in : HALFBAND_BLOCK;
+        memcpy(fir_work_ + history, in, n * sizeof(float));
+        filter(fir_work_, filtered, n);
+
+        // Zero-stuffed input: one phase sees every tap, the other only the centre (×2 gain)
+        for (uint32_t i = 0; i < n; i++) {
+            out[2 * i] = 2.0f * filtered[i];
+            out[2 * i + 1] = fir_work_[i + HALFBAND_HALF_LENGTH];
+        }
+
+        memmove(fir_work_, fir_work_ + n, history * sizeof(float));
+        in += n;
+        out += 2 * n;
+        num_in -= n;
+    }
+}
+
+void HalfbandResampler::downsample(const float* in, float* out, uint32_t num_out) {
+    const uint32_t history = HALFBAND_PHASE_TAPS - 1;
+    const uint32_t delay = HALFBAND_HALF_LENGTH - 1;
+    float filtered[HALFBAND_BLOCK];
+
+    while (num_out > 0) {
+        uint32_t n = num_out < HALFBAND_BLOCK ? num_out : HALFBAND_BLOCK;
+        for (uint32_t i = 0; i < n; i++) {
+            delay_work_[delay + i] = in[2 * i];
+            fir_work_[history + i] = in[2 * i + 1];
+        }
+        filter(fir_work_, filtered, n);
+
+        for (uint32_t i = 0; i < n; i++) {
+            out[i] = filtered[i] + 0.5f * delay_work_[i];
+        }
+
+        memmove(fir_work_, fir_work_ + n, history * sizeof(float));
+        memmove(delay_work_, delay_work_ + n, delay * sizeof(float));
+        in += 2 * n;
+        out += n;
+        num_out -= n;
+    }
+}
@@ -0,0 +1,86 @@
+/**
+ * @file HalfbandResampler.h
+ * @brief Polyphase half-band 2× interpolator / decimator for one channel
+ *
+ * The engine can render its voices at half or twice the host rate and
+ * convert the summed buses, so resampling costs a few taps per output
+ * sample per bus instead of scaling with the voice count.
+ *
+ * The filter is a Blackman-windowed half-band lowpass at a quarter of the
+ * high rate. Every other tap of a half-band filter is zero except the
+ * centre (0.5), so each polyphase branch is either a HALFBAND_PHASE_TAPS
+ * dot product or a pure delay:
+ * - upsample(): each input sample yields one filtered and one delayed output
+ * - downsample(): each input pair yields one output, filtering the odd
+ *   samples and adding the delayed even one
+ * Both directions have unity DC gain and a group delay of HALFBAND_LATENCY
+ * samples at the high rate. Input is filtered in blocks of HALFBAND_BLOCK
+ * with the taps in the outer loop, so the inner loop runs across output
+ * samples and vectorizes.
+ */
+
+#ifndef HALFBAND_RESAMPLER_H
+#define HALFBAND_RESAMPLER_H
+
+#include <cstdint>
+
+/**
+ * @brief Nonzero taps per side of the centre tap
+ */
+#define HALFBAND_HALF_LENGTH 16
+
+/**
+ * @brief Taps of the filtering polyphase branch
+ */
+#define HALFBAND_PHASE_TAPS (2 * HALFBAND_HALF_LENGTH)
+
+/**
+ * @brief Group delay in high-rate samples
+ */
+#define HALFBAND_LATENCY (2 * HALFBAND_HALF_LENGTH - 1)
+
+/**
+ * @brief Branch samples filtered per pass
+ */
+#define HALFBAND_BLOCK 64
+
+class HalfbandResampler {
+public:
+    HalfbandResampler();
+
+    /**
+     * @brief Clear the filter history (output restarts from silence)
+     */
+    void reset();
+
+    /**
+     * @brief Interpolate by 2
+     * @param in num_in low-rate samples
+     * @param out 2 · num_in high-rate samples
+     * @param num_in Input sample count
+     */
+    void upsample(const float* in, float* out, uint32_t num_in);
+
+    /**
+     * @brief Decimate by 2
+     * @param in 2 · num_out high-rate samples
+     * @param out num_out low-rate samples
+     * @param num_out Output sample count
+     */
+    void downsample(const float* in, float* out, uint32_t num_out);
+
+private:
+    /**
+     * @brief Filtering branch: out[i] = Σ taps_[t] · in[i + t] (in starts with the history)
+     */
+    void filter(const float* in, float* out, uint32_t n) const;
+
+    float taps_[HALFBAND_PHASE_TAPS];   ///< Odd taps of the prototype (symmetric)
+
+    // Branch inputs: the last samples of the previous pass, then the
+    // current block
+    float fir_work_[HALFBAND_PHASE_TAPS - 1 + HALFBAND_BLOCK];      ///< Filtered branch
+    float delay_work_[HALFBAND_HALF_LENGTH - 1 + HALFBAND_BLOCK];   ///< Even high-rate samples (downsample)
+};
+
+#endif // HALFBAND_RESAMPLER_H
@@ -0,0 +1,138 @@
+/**
+ * @file ModalKernels.cpp
+ * @brief Specialized step kernels and kernel selection
+ *
+ * Same integration as modal_bank_step() for a node without excitation:
+ *   a(t+dt) = a(t)·exp(λ·dt),  ȧ = λ·a,  λ = -γ_eff + iω
+ * with γ_eff = -γ + 3γ|a|² for self-oscillators, and the same
+ * MODAL_AMPLITUDE_FLOOR flush for decaying modes.
+ */
+
+#include "ModalKernels.h"
+#include <cmath>
+
+/**
+ * @brief Complex amplitude storage viewed as {re, im} (C99 complex layout)
+ */
+static inline float* cfloat_parts(modal_cfloat_t* c) {
+    return reinterpret_cast<float*>(c);
+}
+
+static inline const float* cfloat_parts(const modal_cfloat_t* c) {
+    return reinterpret_cast<const float*>(c);
+}
+
+/**
+ * @brief Node matches a kernel: given personality, exactly modes [0, N) active
+ */
+template <uint32_t N, node_personality_t Personality>
+static inline bool matches(const modal_node_t* node) {
+    if (node->personality != Personality) return false;
+    for (uint32_t k = 0; k < MAX_MODES; k++) {
+        if (node->modes[k].params.active != (k < N)) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Step one matching node with constant mode count
+ */
+template <uint32_t N, node_personality_t Personality>
+static inline void stepNode(modal_node_t* node) {
+    float a_re[N], a_im[N], p_re[N], p_im[N], lambda_re[N];
+
+    for (uint32_t k = 0; k < N; k++) {
+        const float* a = cfloat_parts(&node->modes[k].a);
+        a_re[k] = a[0];
+        a_im[k] = a[1];
+    }
+
+    if (Personality == PERSONALITY_SELF_OSCILLATOR) {
+        // Van der Pol-like damping: decay recomputed from |a| every step
+        float decay[N];
+        for (uint32_t k = 0; k < N; k++) {
+            float gamma = node->modes[k].params.gamma;
+            float energy_sq = a_re[k] * a_re[k] + a_im[k] * a_im[k];
+            lambda_re[k] = -(-gamma + 3.0f * gamma * energy_sq);
+        }
+        for (uint32_t k = 0; k < N; k++) {
+            decay[k] = expf(lambda_re[k] * CONTROL_DT);
+        }
+        for (uint32_t k = 0; k < N; k++) {
+            const float* rotation = cfloat_parts(&node->modes[k].rotation);
+            p_re[k] = decay[k] * rotation[0];
+            p_im[k] = decay[k] * rotation[1];
+        }
+    } else {
+        for (uint32_t k = 0; k < N; k++) {
+            const float* propagator = cfloat_parts(&node->modes[k].propagator);
+            lambda_re[k] = -node->modes[k].params.gamma;
+            p_re[k] = propagator[0];
+            p_im[k] = propagator[1];
+        }
+    }
+
+    for (uint32_t k = 0; k < N; k++) {
+        float omega = node->modes[k].params.omega;
+        float* a = cfloat_parts(&node->modes[k].a);
+        float* a_dot = cfloat_parts(&node->modes[k].a_dot);
+
+        a_dot[0] = lambda_re[k] * a_re[k] - omega * a_im[k];
+        a_dot[1] = omega * a_re[k] + lambda_re[k] * a_im[k];
+
+        float next_re = a_re[k] * p_re[k] - a_im[k] * p_im[k];
+        float next_im = a_re[k] * p_im[k] + a_im[k] * p_re[k];
+        float floor_sq = (lambda_re[k] < 0.0f) ? MODAL_AMPLITUDE_FLOOR_SQ : 0.0f;
+        bool flush = next_re * next_re + next_im * next_im < floor_sq;
+        a[0] = flush ? 0.0f : next_re;
+        a[1] = flush ? 0.0f : next_im;
+    }
+
+    node->step_count++;
+}
+
+template <uint32_t N, node_personality_t Personality>
+static void stepKernel(modal_node_t* const* nodes, uint32_t num_nodes) {
+    for (uint32_t i = 0; i < num_nodes; i++) {
+        modal_node_t* node = nodes[i];
+        if (!node->running) continue;
+
+        // Poke envelopes (a few steps after note on) and other
+        // configurations take the generic path
+        if (node->excitation.active || !matches<N, Personality>(node)) {
+            modal_bank_step(&node, 1);
+            continue;
+        }
+
+        stepNode<N, Personality>(node);
+    }
+}
+
+/**
+ * @brief Instantiated kernels, indexed [num_modes - 1][personality]
+ */
+static const modal_step_kernel_t kStepKernels[MAX_MODES][2] = {
+    {stepKernel<1, PERSONALITY_RESONATOR>, stepKernel<1, PERSONALITY_SELF_OSCILLATOR>},
+    {stepKernel<2, PERSONALITY_RESONATOR>, stepKernel<2, PERSONALITY_SELF_OSCILLATOR>},
+    {stepKernel<3, PERSONALITY_RESONATOR>, stepKernel<3, PERSONALITY_SELF_OSCILLATOR>},
+    {stepKernel<4, PERSONALITY_RESONATOR>, stepKernel<4, PERSONALITY_SELF_OSCILLATOR>},
+};
+
+static_assert(MAX_MODES == 4, "kStepKernels instantiates one row per mode count");
+
+uint32_t modal_node_active_prefix(const modal_node_t* node) {
+    uint32_t n = 0;
+    while (n < MAX_MODES && node->modes[n].params.active) n++;
+    for (uint32_t k = n; k < MAX_MODES; k++) {
+        if (node->modes[k].params.active) return 0;
+    }
+    return n;
+}
+
+modal_step_kernel_t modal_step_kernel_select(uint32_t num_modes, node_personality_t personality) {
+    if (num_modes == 0 || num_modes > MAX_MODES) return modal_bank_step;
+    if (personality != PERSONALITY_RESONATOR && personality != PERSONALITY_SELF_OSCILLATOR) {
+        return modal_bank_step;
+    }
+    return kStepKernels[num_modes - 1][personality];
+}
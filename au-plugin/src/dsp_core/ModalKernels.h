@@ -0,0 +1,45 @@
+/**
+ * @file ModalKernels.h
+ * @brief Compile-time specialized control-rate step kernels
+ *
+ * modal_bank_step() handles any mix of personalities and active modes,
+ * so it branches on both for every mode. The kernels here are template
+ * instantiations for a fixed active mode count (modes [0, N) active,
+ * the rest off) and a fixed personality, so the mode loops have constant
+ * trip counts the compiler fully unrolls and vectorizes, including the
+ * per-mode expf() of self-oscillators.
+ *
+ * A kernel is chosen once per configuration with modal_step_kernel_select()
+ * (VoiceAllocator does this at init and on personality changes). Nodes
+ * that do not match the kernel's configuration, or are still inside a
+ * poke envelope, are stepped by modal_bank_step(), so every kernel gives
+ * the same result as the generic path for any input.
+ */
+
+#ifndef MODAL_KERNELS_H
+#define MODAL_KERNELS_H
+
+#include "../esp32_port/modal_node.h"
+#include <cstdint>
+
+/**
+ * @brief Step kernel signature (same contract as modal_bank_step)
+ */
+typedef void (*modal_step_kernel_t)(modal_node_t* const* nodes, uint32_t num_nodes);
+
+/**
+ * @brief Count active modes if they form a prefix [0, N)
+ * @param node Node to inspect
+ * @return N, or 0 if no mode is active or the active modes have gaps
+ */
+uint32_t modal_node_active_prefix(const modal_node_t* node);
+
+/**
+ * @brief Pick the step kernel for a configuration
+ * @param num_modes Active mode count (modes [0, num_modes))
+ * @param personality Node personality
+ * @return Specialized kernel, or modal_bank_step when none is instantiated
+ */
+modal_step_kernel_t modal_step_kernel_select(uint32_t num_modes, node_personality_t personality);
+
+#endif // MODAL_KERNELS_H
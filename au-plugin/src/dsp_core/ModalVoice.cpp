@@ -4,6 +4,7 @@
  */
 
 #include "ModalVoice.h"
+#include "PitchTables.h"
 #include <cmath>
 #include <cstring>
 
@@ -13,8 +14,14 @@ ModalVoice::ModalVoice(uint8_t voice_id)
     , midi_note_(60)
     , velocity_(0.0f)
     , pitch_bend_(0.0f)
+    , bend_range_(2.0f)
+    , base_omega_(0.0f)
+    , pan_(0.0f)
+    , mode_spread_(0.0f)
     , poke_strength_(0.5f)      // Default poke strength
     , poke_duration_ms_(10.0f)  // Default poke duration
+    , silence_threshold_(DEFAULT_SILENCE_THRESHOLD)
+    , fading_(false)
     , age_(0)
     , samples_since_update_(0)
     , samples_per_update_(0)
@@ -22,6 +29,7 @@ ModalVoice::ModalVoice(uint8_t voice_id)
 {
     // Initialize node with resonator personality by default
     modal_node_init(&node_, voice_id, PERSONALITY_RESONATOR);
+    for (int k = 0; k < MAX_MODES; k++) mode_ratio_[k] = 1.0f;
 }
 
 ModalVoice::~ModalVoice() {
@@ -39,11 +47,11 @@ void ModalVoice::initialize(float sample_rate) {
     audio_synth_init(&synth_, &node_, sample_rate);
 
     // Set default mode configuration (4 harmonically related modes)
-    float base_freq = midi_to_freq(midi_note_);
-    setMode(0, base_freq * 1.0f, 0.5f, 1.0f);      // Fundamental
-    setMode(1, base_freq * 1.01f, 0.6f, 0.7f);     // Slight detune
-    setMode(2, base_freq * 2.0f, 0.8f, 0.5f);      // Second harmonic
-    setMode(3, base_freq * 3.0f, 1.0f, 0.3f);      // Third harmonic
+    base_omega_ = pitch_note_omega(midi_note_);
+    setModeTuning(0, 1.0f, 0.5f, 1.0f);      // Fundamental
+    setModeTuning(1, 1.01f, 0.6f, 0.7f);     // Slight detune
+    setModeTuning(2, 2.0f, 0.8f, 0.5f);      // Second harmonic
+    setModeTuning(3, 3.0f, 1.0f, 0.3f);      // Third harmonic
 
     // Start node
     modal_node_start(&node_);
@@ -54,6 +62,7 @@ void ModalVoice::noteOn(uint8_t midi_note, float velocity) {
     velocity_ = velocity;
     state_ = State::Attack;
     age_ = 0;
+    fading_ = false;
 
     // Update frequencies based on new note
     updateFrequencies();
@@ -81,16 +90,38 @@ void ModalVoice::noteOff() {
     state_ = State::Release;
 }
 
+void ModalVoice::fadeOut() {
+    if (state_ == State::Inactive) return;
+
+    state_ = State::Release;
+    fading_ = true;
+}
+
 void ModalVoice::setPitchBend(float bend_amount, float bend_range) {
     pitch_bend_ = bend_amount;
+    bend_range_ = bend_range;
     updateFrequencies();
 }
 
 void ModalVoice::updateModal() {
     if (state_ == State::Inactive) return;
 
-    // Step modal dynamics
-    modal_node_step(&node_);
+    // Step modal dynamics (dormant voices are frozen)
+    if (state_ != State::Dormant) {
+        modal_node_step(&node_);
+    }
+
+    finishModalUpdate();
+}
+
+void ModalVoice::finishModalUpdate() {
+    if (state_ == State::Inactive) return;
+
+    if (fading_) {
+        for (int k = 0; k < MAX_MODES; k++) {
+            node_.modes[k].a *= FADE_OUT_DECAY;
+        }
+    }
 
     // Update state machine
     updateState();
@@ -100,7 +131,7 @@ void ModalVoice::updateModal() {
 }
 
 void ModalVoice::renderAudio(float* outL, float* outR, uint32_t num_frames) {
-    if (state_ == State::Inactive) {
+    if (!isAwake()) {
         // Silent voice - write zeros
         memset(outL, 0, num_frames * sizeof(float));
         memset(outR, 0, num_frames * sizeof(float));
@@ -114,15 +145,27 @@ void ModalVoice::renderAudio(float* outL, float* outR, uint32_t num_frames) {
     samples_since_update_ += num_frames;
 }
 
-void ModalVoice::applyCoupling(const float coupling_inputs[MAX_MODES]) {
-    // Apply coupling inputs to node
-    // This modulates the mode amplitudes based on neighbor voices
+void ModalVoice::applyCoupling(const std::complex<float> coupling_inputs[MAX_MODES]) {
+    const float scale = node_.coupling_strength * CONTROL_DT;
+
+    // Dormant: wake only if some mode would get a kick above threshold
+    if (state_ == State::Dormant) {
+        float max_kick = 0.0f;
+        for (int k = 0; k < MAX_MODES; k++) {
+            if (!node_.modes[k].params.active) continue;
+            max_kick = fmaxf(max_kick, std::abs(coupling_inputs[k]) * fabsf(scale));
+        }
+        if (max_kick < silence_threshold_) return;
+        state_ = State::Attack;
+    }
+
+    // Add coupling as excitation, keeping its phase
     for (int k = 0; k < MAX_MODES; k++) {
         if (!node_.modes[k].params.active) continue;
 
-        // Add coupling as excitation
-        float coupling_strength = node_.coupling_strength * coupling_inputs[k];
-        node_.modes[k].a += coupling_strength * CONTROL_DT;
+        float* a = reinterpret_cast<float*>(&node_.modes[k].a);  // {re, im}
+        a[0] += scale * coupling_inputs[k].real();
+        a[1] += scale * coupling_inputs[k].imag();
     }
 }
 
@@ -133,10 +176,29 @@ float ModalVoice::getAmplitude() const {
 void ModalVoice::setMode(uint8_t mode_idx, float freq_hz, float damping, float weight) {
     if (mode_idx >= MAX_MODES) return;
 
+    // Keep the ratio so later bends and notes move the mode proportionally
     float omega = freq_to_omega(freq_hz);
+    mode_ratio_[mode_idx] = base_omega_ > 0.0f ? omega / base_omega_ : 1.0f;
     modal_node_set_mode(&node_, mode_idx, omega, damping, weight);
 }
 
+void ModalVoice::setModeTuning(uint8_t mode_idx, float ratio, float damping, float weight) {
+    if (mode_idx >= MAX_MODES) return;
+
+    mode_ratio_[mode_idx] = ratio;
+    modal_node_set_mode(&node_, mode_idx, base_omega_ * ratio, damping, weight);
+}
+
+void ModalVoice::setModeTunings(const float ratio[MAX_MODES], const float damping[MAX_MODES],
+                                const float weight[MAX_MODES]) {
+    for (int k = 0; k < MAX_MODES; k++) {
+        mode_ratio_[k] = ratio[k];
+        node_.modes[k].params.gamma = damping[k];   // Propagators rebuilt below
+        node_.modes[k].params.weight = weight[k];
+    }
+    updateFrequencies();
+}
+
 void ModalVoice::setPersonality(node_personality_t personality) {
     node_.personality = personality;
 }
@@ -146,33 +208,38 @@ void ModalVoice::setPokeParameters(float strength, float duration_ms) {
     poke_duration_ms_ = duration_ms;
 }
 
+void ModalVoice::copyStateFrom(const ModalVoice& other) {
+    uint8_t voice_id = voice_id_;
+    *this = other;
+
+    voice_id_ = voice_id;
+    node_.node_id = voice_id;
+    synth_.node = &node_;
+}
+
 void ModalVoice::reset() {
     modal_node_reset(&node_);
     state_ = State::Inactive;
     age_ = 0;
+    fading_ = false;
     samples_since_update_ = 0;
 }
 
 void ModalVoice::updateFrequencies() {
-    // Calculate base frequency with pitch bend
-    float base_freq = midi_to_freq(midi_note_);
+    // Base ω from the note and bend tables, then each mode by its ratio
+    base_omega_ = pitch_to_omega(midi_note_ + pitch_bend_ * bend_range_);
 
-    // Apply pitch bend (±2 semitones by default)
-    float bend_factor = powf(2.0f, pitch_bend_ * 2.0f / 12.0f);
-    base_freq *= bend_factor;
-
-    // Update all mode frequencies proportionally
-    // Mode 0: fundamental
-    setMode(0, base_freq * 1.0f, node_.modes[0].params.gamma, node_.modes[0].params.weight);
-
-    // Mode 1: slight detune
-    setMode(1, base_freq * 1.01f, node_.modes[1].params.gamma, node_.modes[1].params.weight);
-
-    // Mode 2: second harmonic
-    setMode(2, base_freq * 2.0f, node_.modes[2].params.gamma, node_.modes[2].params.weight);
+    float omega[MAX_MODES];
+    for (int k = 0; k < MAX_MODES; k++) omega[k] = base_omega_ * mode_ratio_[k];
+    modal_node_set_frequencies(&node_, omega);
+}
 
-    // Mode 3: third harmonic
-    setMode(3, base_freq * 3.0f, node_.modes[3].params.gamma, node_.modes[3].params.weight);
+bool ModalVoice::isSilent() const {
+    float level = getAmplitude();
+    for (int k = 0; k < MAX_MODES; k++) {
+        level += synth_.amplitude_smooth[k];
+    }
+    return level < silence_threshold_;
 }
 
 void ModalVoice::updateState() {
@@ -186,10 +253,17 @@ void ModalVoice::updateState() {
             // Transition to sustain if self-oscillator, else stay in attack
             if (node_.personality == PERSONALITY_SELF_OSCILLATOR) {
                 state_ = State::Sustain;
+            } else if (!node_.excitation.active && isSilent()) {
+                // Held resonator decayed below threshold: stop spending on it
+                state_ = State::Dormant;
             }
             // Resonator stays in attack until release
             break;
 
+        case State::Dormant:
+            // Woken by noteOn() or applyCoupling()
+            break;
+
         case State::Sustain:
             // Continue sustaining
             break;
@@ -197,7 +271,7 @@ void ModalVoice::updateState() {
         case State::Release:
             // Check if voice is quiet enough to deactivate
             float amp = getAmplitude();
-            if (amp < 0.001f) {
+            if (amp < 0.001f || isSilent()) {
                 state_ = State::Inactive;
                 reset();
             }
@@ -17,6 +17,16 @@
 #include <cstdint>
 #include <complex>
 
+/**
+ * @brief Default silence threshold for dormant voices (summed mode amplitude)
+ */
+#define DEFAULT_SILENCE_THRESHOLD 1e-4f
+
+/**
+ * @brief Mode amplitude factor per control tick during fadeOut() (-6 dB/tick)
+ */
+#define FADE_OUT_DECAY 0.5f
+
 class ModalVoice {
 public:
     /**
@@ -26,7 +36,8 @@ public:
         Inactive,   ///< Voice not playing
         Attack,     ///< Note on, attack phase
         Sustain,    ///< Sustaining (self-oscillator only)
-        Release     ///< Note off, release phase
+        Release,    ///< Note off, release phase
+        Dormant     ///< Held but below silence threshold: not stepped or rendered
     };
 
     /**
@@ -58,6 +69,21 @@ public:
      */
     void noteOff();
 
+    /**
+     * @brief Release with a short fade instead of the natural decay
+     *
+     * Mode amplitudes are scaled by FADE_OUT_DECAY every control tick, so
+     * the voice reaches the release floor within ~20 ms; the per-sample
+     * amplitude smoothing keeps the fade click-free.
+     */
+    void fadeOut();
+
+    /**
+     * @brief Check if voice is fading out (see fadeOut)
+     * @return True while fading
+     */
+    bool isFading() const { return fading_; }
+
     /**
      * @brief Apply pitch bend
      * @param bend_amount Pitch bend amount (-1.0 to +1.0)
@@ -70,6 +96,14 @@ public:
      */
     void updateModal();
 
+    /**
+     * @brief Finish a control update after the node was stepped externally
+     *
+     * updateModal() minus the modal_node_step(), for callers that step
+     * many voices at once with modal_bank_step().
+     */
+    void finishModalUpdate();
+
     /**
      * @brief Render audio block
      * @param outL Left channel output
@@ -80,9 +114,15 @@ public:
 
     /**
      * @brief Apply coupling input from other voices
-     * @param coupling_inputs Array of 4 coupling inputs (one per mode)
+     *
+     * Each active mode's amplitude moves by
+     * node coupling strength × input × CONTROL_DT. A dormant voice ignores
+     * input whose per-mode kick stays below the silence threshold, and
+     * wakes on anything larger.
+     *
+     * @param coupling_inputs Complex coupling input per mode
      */
-    void applyCoupling(const float coupling_inputs[MAX_MODES]);
+    void applyCoupling(const std::complex<float> coupling_inputs[MAX_MODES]);
 
     /**
      * @brief Get voice state
@@ -98,6 +138,20 @@ public:
         return state_ != State::Inactive;
     }
 
+    /**
+     * @brief Check if voice is held but dormant
+     * @return True if skipped by step, render and coupling
+     */
+    bool isDormant() const { return state_ == State::Dormant; }
+
+    /**
+     * @brief Check if voice needs stepping and rendering
+     * @return True if active and not dormant
+     */
+    bool isAwake() const {
+        return state_ != State::Inactive && state_ != State::Dormant;
+    }
+
     /**
      * @brief Get MIDI note number
      * @return Current MIDI note
@@ -131,6 +185,24 @@ public:
         return std::complex<float>(c.re, c.im);
     }
 
+    /**
+     * @brief Get underlying modal node (read-only, for batch renderers)
+     * @return Pointer to node state
+     */
+    const modal_node_t* getNode() const { return &node_; }
+
+    /**
+     * @brief Get underlying modal node (for batched modal_bank_step)
+     * @return Pointer to node state
+     */
+    modal_node_t* getMutableNode() { return &node_; }
+
+    /**
+     * @brief Get audio synthesis state (read-only, for batch renderers)
+     * @return Pointer to synth state
+     */
+    const audio_synth_t* getSynth() const { return &synth_; }
+
     /**
      * @brief Set mode parameters
      * @param mode_idx Mode index (0-3)
@@ -140,6 +212,38 @@ public:
      */
     void setMode(uint8_t mode_idx, float freq_hz, float damping, float weight);
 
+    /**
+     * @brief Set mode parameters relative to the voice's pitch
+     *
+     * The ratio is kept across notes and pitch bends, so retuning costs a
+     * multiply per mode instead of a frequency conversion.
+     *
+     * @param mode_idx Mode index (0-3)
+     * @param ratio Frequency as a multiple of the bent note frequency
+     * @param damping Damping coefficient
+     * @param weight Audio weight (0.0-1.0)
+     */
+    void setModeTuning(uint8_t mode_idx, float ratio, float damping, float weight);
+
+    /**
+     * @brief Set every mode's ratio, damping and weight in one pass
+     *
+     * Equivalent to setModeTuning() per mode, but the propagators are
+     * rebuilt together (see modal_node_set_frequencies). Active flags are
+     * kept.
+     *
+     * @param ratio Frequency multiple of the bent note frequency, per mode
+     * @param damping Damping coefficient per mode
+     * @param weight Audio weight per mode
+     */
+    void setModeTunings(const float ratio[MAX_MODES], const float damping[MAX_MODES],
+                        const float weight[MAX_MODES]);
+
+    /**
+     * @brief Get the bent note's angular frequency (rad/s, mode ratio 1)
+     */
+    float getBaseOmega() const { return base_omega_; }
+
     /**
      * @brief Set node personality
      * @param personality Resonator or self-oscillator
@@ -153,6 +257,62 @@ public:
      */
     void setPokeParameters(float strength, float duration_ms);
 
+    /**
+     * @brief Set silence threshold for dormancy
+     *
+     * A held resonator whose summed mode and smoothed synth amplitudes fall
+     * below the threshold (with no poke in progress) goes dormant until
+     * retriggered or woken by coupling. 0 disables dormancy.
+     *
+     * @param threshold Summed amplitude threshold
+     */
+    void setSilenceThreshold(float threshold) { silence_threshold_ = threshold; }
+
+    /**
+     * @brief Get silence threshold
+     * @return Summed amplitude threshold
+     */
+    float getSilenceThreshold() const { return silence_threshold_; }
+
+    /**
+     * @brief Set stereo placement (read by VoiceBank)
+     * @param pan Voice pan (-1 = left, 0 = center, +1 = right)
+     * @param mode_spread Spread of the modes around pan (0 = all at pan, 1 = full)
+     */
+    void setStereoPosition(float pan, float mode_spread) {
+        pan_ = pan;
+        mode_spread_ = mode_spread;
+    }
+
+    /**
+     * @brief Get voice pan
+     * @return Pan (-1 to +1)
+     */
+    float getPan() const { return pan_; }
+
+    /**
+     * @brief Get mode spread
+     * @return Spread (0-1)
+     */
+    float getModeSpread() const { return mode_spread_; }
+
+    /**
+     * @brief Seed the node's noise generator
+     * @param seed Seed value (streams differ per voice id)
+     */
+    void setSeed(uint32_t seed) { modal_node_seed(&node_, seed); }
+
+    /**
+     * @brief Take over another voice's complete state (note, modes, settings)
+     *
+     * Used to move a sounding voice into another allocator. The voice keeps
+     * its own id, so pokes and later reseeds stay specific to this slot;
+     * the noise generator continues the other voice's stream.
+     *
+     * @param other Voice to copy (same sample rate)
+     */
+    void copyStateFrom(const ModalVoice& other);
+
     /**
      * @brief Reset voice state
      */
@@ -167,10 +327,17 @@ private:
     uint8_t midi_note_;             ///< Current MIDI note
     float velocity_;                ///< Note velocity (0.0-1.0)
     float pitch_bend_;              ///< Pitch bend amount (-1.0 to +1.0)
+    float bend_range_;              ///< Pitch bend range in semitones
+    float base_omega_;              ///< ω of note + bend (rad/s)
+    float mode_ratio_[MAX_MODES];   ///< Mode frequency / base frequency
+    float pan_;                     ///< Stereo pan (-1.0 to +1.0)
+    float mode_spread_;             ///< Mode spread around pan (0.0-1.0)
 
     // Poke/excitation parameters
     float poke_strength_;           ///< Poke strength multiplier
     float poke_duration_ms_;        ///< Poke duration in milliseconds
+    float silence_threshold_;       ///< Dormancy threshold (0 = never dormant)
+    bool fading_;                   ///< Fast fade-out in progress
 
     uint32_t age_;                  ///< Voice age counter
     uint32_t samples_since_update_; ///< Sample counter for control rate
@@ -187,6 +354,11 @@ private:
      * @brief Update voice state machine
      */
     void updateState();
+
+    /**
+     * @brief Check summed mode and smoothed synth amplitudes against threshold
+     */
+    bool isSilent() const;
 };
 
 #endif // MODAL_VOICE_H
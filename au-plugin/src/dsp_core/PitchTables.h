@@ -0,0 +1,109 @@
+/**
+ * @file PitchTables.h
+ * @brief Compile-time MIDI note and pitch-bend lookup tables
+ *
+ * Note-on, pitch bend and mode-ratio changes all need ω = 2π·440·2^((p-69)/12)
+ * for a fractional pitch p. Instead of powf() per call, pitch_to_omega()
+ * splits p into a note (128-entry ω table) and a fraction of a semitone
+ * (PITCH_FINE_STEPS-entry ratio table, linearly interpolated), so any pitch
+ * costs two loads and three multiply-adds. Interpolation error is below
+ * float resolution (~1e-7 relative at 64 steps per semitone).
+ *
+ * The tables are built by constexpr code in double precision, so they are
+ * identical on every target and cost nothing at startup.
+ */
+
+#ifndef PITCH_TABLES_H
+#define PITCH_TABLES_H
+
+#include <cstdint>
+
+/**
+ * @brief Fine ratio table resolution (entries per semitone)
+ */
+#define PITCH_FINE_STEPS 64
+
+/**
+ * @brief Highest MIDI note in the note table
+ */
+#define PITCH_MAX_NOTE 127
+
+namespace pitch_detail {
+
+constexpr double kLn2 = 0.69314718055994530942;
+constexpr double kTwoPi = 6.28318530717958647692;
+
+/**
+ * @brief exp(x) by Taylor series (accurate to double for |x| < 1)
+ */
+constexpr double exp_series(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int n = 1; n < 30; n++) {
+        term *= x / n;
+        sum += term;
+    }
+    return sum;
+}
+
+/**
+ * @brief 2^(semitones / 12) with range reduction to one octave
+ */
+constexpr double semitone_ratio(int semitones, double fraction) {
+    int octave = 0;
+    while (semitones < 0) { semitones += 12; octave--; }
+    while (semitones >= 12) { semitones -= 12; octave++; }
+    double ratio = exp_series(kLn2 * (semitones + fraction) / 12.0);
+    for (; octave > 0; octave--) ratio *= 2.0;
+    for (; octave < 0; octave++) ratio *= 0.5;
+    return ratio;
+}
+
+struct Tables {
+    float note_omega[PITCH_MAX_NOTE + 1];   ///< ω of each MIDI note (rad/s)
+    float fine_ratio[PITCH_FINE_STEPS + 1]; ///< 2^(i / (12 · PITCH_FINE_STEPS))
+};
+
+constexpr Tables build() {
+    Tables t{};
+    for (int n = 0; n <= PITCH_MAX_NOTE; n++) {
+        t.note_omega[n] = static_cast<float>(kTwoPi * 440.0 * semitone_ratio(n - 69, 0.0));
+    }
+    for (int i = 0; i <= PITCH_FINE_STEPS; i++) {
+        t.fine_ratio[i] = static_cast<float>(semitone_ratio(0, static_cast<double>(i) / PITCH_FINE_STEPS));
+    }
+    return t;
+}
+
+inline constexpr Tables kTables = build();
+
+} // namespace pitch_detail
+
+/**
+ * @brief Angular frequency of a MIDI note (rad/s)
+ * @param note MIDI note (clamped to 127)
+ */
+inline float pitch_note_omega(uint8_t note) {
+    return pitch_detail::kTables.note_omega[note > PITCH_MAX_NOTE ? PITCH_MAX_NOTE : note];
+}
+
+/**
+ * @brief Angular frequency of a fractional MIDI pitch (rad/s)
+ * @param pitch Note plus bend in semitones (clamped to [0, 127])
+ */
+inline float pitch_to_omega(float pitch) {
+    if (!(pitch > 0.0f)) pitch = 0.0f;
+    if (pitch > static_cast<float>(PITCH_MAX_NOTE)) pitch = static_cast<float>(PITCH_MAX_NOTE);
+
+    // Note 127 reads the last fine entry of note 126
+    int note = static_cast<int>(pitch);
+    if (note == PITCH_MAX_NOTE) note--;
+    float fine = (pitch - static_cast<float>(note)) * PITCH_FINE_STEPS;
+    int step = static_cast<int>(fine);
+    if (step == PITCH_FINE_STEPS) step--;
+    float t = fine - static_cast<float>(step);
+
+    const float* r = pitch_detail::kTables.fine_ratio + step;
+    return pitch_detail::kTables.note_omega[note] * (r[0] + t * (r[1] - r[0]));
+}
+
+#endif // PITCH_TABLES_H
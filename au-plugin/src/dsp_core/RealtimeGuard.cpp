@@ -0,0 +1,90 @@
+/**
+ * @file RealtimeGuard.cpp
+ * @brief Allocation check for real-time sections (debug builds only)
+ *
+ * The replacement operators live in the same translation unit as
+ * realtime_guard_enter(), so linking the render path pulls them in
+ * from the static library.
+ */
+
+#include "RealtimeGuard.h"
+
+#ifdef MODAL_RT_ALLOC_CHECK
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static thread_local int g_realtime_depth = 0;
+
+void realtime_guard_enter() {
+    g_realtime_depth++;
+}
+
+void realtime_guard_exit() {
+    g_realtime_depth--;
+}
+
+static void check_realtime(const char* what) {
+    if (g_realtime_depth > 0) {
+        fprintf(stderr, "RealtimeGuard: %s called inside render\n", what);
+        abort();
+    }
+}
+
+static void* checked_alloc(std::size_t size) {
+    check_realtime("operator new");
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(std::size_t size) { return checked_alloc(size); }
+void* operator new[](std::size_t size) { return checked_alloc(size); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    check_realtime("operator new");
+    return malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    check_realtime("operator new[]");
+    return malloc(size ? size : 1);
+}
+
+void operator delete(void* ptr) noexcept {
+    if (ptr) check_realtime("operator delete");
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    if (ptr) check_realtime("operator delete[]");
+    free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept { operator delete(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { operator delete[](ptr); }
+
+static void* checked_aligned_alloc(std::size_t size, std::align_val_t align) {
+    check_realtime("aligned operator new");
+    std::size_t alignment = static_cast<std::size_t>(align);
+    std::size_t rounded = (size + alignment - 1) / alignment * alignment;
+    void* ptr = aligned_alloc(alignment, rounded ? rounded : alignment);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    return checked_aligned_alloc(size, align);
+}
+
+void* operator new[](std::size_t size, std::align_val_t align) {
+    return checked_aligned_alloc(size, align);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept { operator delete(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { operator delete[](ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { operator delete(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { operator delete[](ptr); }
+
+#endif // MODAL_RT_ALLOC_CHECK
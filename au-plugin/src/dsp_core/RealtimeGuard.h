@@ -0,0 +1,46 @@
+/**
+ * @file RealtimeGuard.h
+ * @brief Debug check that the render path never allocates
+ *
+ * When built with MODAL_RT_ALLOC_CHECK (CMake option ENABLE_RT_ALLOC_CHECK),
+ * global operator new/delete are replaced and abort with a message if they
+ * are called while a ScopedRealtimeGuard is alive on the current thread.
+ * Without the option, the guard compiles to nothing.
+ */
+
+#ifndef REALTIME_GUARD_H
+#define REALTIME_GUARD_H
+
+#ifdef MODAL_RT_ALLOC_CHECK
+
+/**
+ * @brief Mark the current thread as inside a real-time section
+ */
+void realtime_guard_enter();
+
+/**
+ * @brief Leave the real-time section entered by realtime_guard_enter()
+ */
+void realtime_guard_exit();
+
+/**
+ * @brief RAII real-time section (nests)
+ */
+class ScopedRealtimeGuard {
+public:
+    ScopedRealtimeGuard() { realtime_guard_enter(); }
+    ~ScopedRealtimeGuard() { realtime_guard_exit(); }
+
+    ScopedRealtimeGuard(const ScopedRealtimeGuard&) = delete;
+    ScopedRealtimeGuard& operator=(const ScopedRealtimeGuard&) = delete;
+};
+
+#define MODAL_REALTIME_SCOPE() ScopedRealtimeGuard realtime_guard_scope_
+
+#else
+
+#define MODAL_REALTIME_SCOPE() ((void)0)
+
+#endif // MODAL_RT_ALLOC_CHECK
+
+#endif // REALTIME_GUARD_H
@@ -0,0 +1,210 @@
+/**
+ * @file RenderWorkerPool.cpp
+ * @brief Real-time worker pool implementation
+ */
+
+#include "RenderWorkerPool.h"
+#include "RealtimeGuard.h"
+#include "DenormalGuard.h"
+#include <chrono>
+
+#if defined(__APPLE__) || defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Work word layout
+#define WORK_GENERATION_SHIFT 40
+#define WORK_COUNT_SHIFT 20
+#define WORK_FIELD_MASK 0xFFFFFu
+#define WORK_GENERATION_MASK 0xFFFFFFu
+#define UNUSED_GENERATION 0xFFFFFFFFu  // Never a valid (masked) generation
+
+// Idle backoff: spin, then yield, then nap (iteration thresholds)
+#define IDLE_SPIN_ITERATIONS 256
+#define IDLE_YIELD_ITERATIONS 4096
+#define IDLE_NAP_US 100
+
+static inline uint64_t make_work(uint32_t generation, uint32_t num_chunks, uint32_t next) {
+    return (static_cast<uint64_t>(generation & WORK_GENERATION_MASK) << WORK_GENERATION_SHIFT) |
+           (static_cast<uint64_t>(num_chunks & WORK_FIELD_MASK) << WORK_COUNT_SHIFT) |
+           (next & WORK_FIELD_MASK);
+}
+
+static inline uint32_t work_generation(uint64_t work) {
+    return static_cast<uint32_t>(work >> WORK_GENERATION_SHIFT) & WORK_GENERATION_MASK;
+}
+
+static inline uint32_t work_count(uint64_t work) {
+    return static_cast<uint32_t>(work >> WORK_COUNT_SHIFT) & WORK_FIELD_MASK;
+}
+
+static inline uint32_t work_next(uint64_t work) {
+    return static_cast<uint32_t>(work) & WORK_FIELD_MASK;
+}
+
+static inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/**
+ * @brief Best effort real-time priority for the calling thread
+ */
+static void raise_thread_priority() {
+#if defined(__APPLE__)
+    pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0);
+#elif defined(__linux__)
+    sched_param param;
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO) + 1;
+    pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);  // Needs privileges; ignored otherwise
+#endif
+}
+
+RenderWorkerPool::RenderWorkerPool(uint32_t num_workers, uint32_t max_block_size)
+    : num_workers_(num_workers)
+    , max_block_size_(max_block_size)
+    , threads_(nullptr)
+    , work_(0)
+    , completed_(0)
+    , running_(true)
+    , job_bank_(nullptr)
+    , job_frames_(0)
+    , generation_(0)
+{
+    participants_ = new Participant[num_workers + 1];
+    for (uint32_t p = 0; p <= num_workers; p++) {
+        participants_[p].mix = vbuffer_alloc(VoiceBank::mixBufferSize(max_block_size));
+        participants_[p].scratch = vbuffer_alloc(VoiceBank::scratchBufferSize(max_block_size));
+        participants_[p].used_generation.store(UNUSED_GENERATION, std::memory_order_relaxed);
+    }
+
+    threads_ = new std::thread[num_workers];
+    for (uint32_t w = 0; w < num_workers; w++) {
+        threads_[w] = std::thread(&RenderWorkerPool::workerLoop, this, w + 1);
+    }
+}
+
+RenderWorkerPool::~RenderWorkerPool() {
+    running_.store(false, std::memory_order_release);
+    for (uint32_t w = 0; w < num_workers_; w++) {
+        threads_[w].join();
+    }
+    delete[] threads_;
+
+    for (uint32_t p = 0; p <= num_workers_; p++) {
+        vbuffer_free(participants_[p].mix);
+        vbuffer_free(participants_[p].scratch);
+    }
+    delete[] participants_;
+}
+
+void RenderWorkerPool::workerLoop(uint32_t participant) {
+    raise_thread_priority();
+    MODAL_REALTIME_SCOPE();
+    MODAL_DENORMAL_SCOPE();
+
+    uint32_t idle = 0;
+    while (running_.load(std::memory_order_acquire)) {
+        uint64_t work = work_.load(std::memory_order_acquire);
+        if (work_next(work) < work_count(work) &&
+            runChunks(participant, work_generation(work))) {
+            idle = 0;
+            continue;
+        }
+
+        idle++;
+        if (idle < IDLE_SPIN_ITERATIONS) {
+            cpu_relax();
+        } else if (idle < IDLE_YIELD_ITERATIONS) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(IDLE_NAP_US));
+        }
+    }
+}
+
+bool RenderWorkerPool::runChunks(uint32_t participant, uint32_t generation) {
+    Participant& self = participants_[participant];
+    bool rendered = false;
+
+    for (;;) {
+        // Claim the next chunk of this job (fails once the job moves on)
+        uint64_t work = work_.load(std::memory_order_acquire);
+        uint32_t chunk;
+        for (;;) {
+            if (work_generation(work) != generation) return rendered;
+            chunk = work_next(work);
+            if (chunk >= work_count(work)) return rendered;
+            if (work_.compare_exchange_weak(work, work + 1,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_acquire)) {
+                break;
+            }
+        }
+
+        // Job parameters are stable until this chunk is reported complete
+        VoiceBank* bank = job_bank_;
+        uint32_t num_frames = job_frames_;
+
+        if (self.used_generation.load(std::memory_order_relaxed) != generation) {
+            bank->clearMix(self.mix, num_frames);
+            self.used_generation.store(generation, std::memory_order_relaxed);
+        }
+
+        bank->renderRange(chunk * RENDER_CHUNK_OSCILLATORS, RENDER_CHUNK_OSCILLATORS,
+                          self.mix, self.scratch, num_frames);
+        rendered = true;
+
+        completed_.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void RenderWorkerPool::render(VoiceBank& bank, float* outL, float* outR, uint32_t num_frames,
+                              float* const* mode_out, uint32_t num_mode_out, bool accumulate) {
+    if (num_frames > max_block_size_) num_frames = max_block_size_;
+
+    uint32_t num_osc = bank.getActiveOscillatorCount();
+    uint32_t num_chunks = (num_osc + RENDER_CHUNK_OSCILLATORS - 1) / RENDER_CHUNK_OSCILLATORS;
+    if (num_chunks > WORK_FIELD_MASK) num_chunks = 0;  // Cannot encode; render inline
+
+    if (num_workers_ == 0 || num_chunks <= 1) {
+        bank.render(outL, outR, num_frames, mode_out, num_mode_out, accumulate);
+        return;
+    }
+
+    // Publish job (parameters first, then the work word)
+    generation_ = (generation_ + 1) & WORK_GENERATION_MASK;
+    job_bank_ = &bank;
+    job_frames_ = num_frames;
+    completed_.store(0, std::memory_order_relaxed);
+    work_.store(make_work(generation_, num_chunks, 0), std::memory_order_release);
+
+    // Render alongside the workers, then wait for chunks they claimed
+    runChunks(0, generation_);
+    while (completed_.load(std::memory_order_acquire) < num_chunks) {
+        cpu_relax();
+    }
+
+    // Sum accumulation buffers of every thread that took part
+    float* mix = nullptr;
+    for (uint32_t p = 0; p <= num_workers_; p++) {
+        Participant& part = participants_[p];
+        if (part.used_generation.load(std::memory_order_relaxed) != generation_) continue;
+
+        // No chunk of this job is in flight, so the flag can be reset here
+        // (keeps a long-idle thread's buffer out of a wrapped generation)
+        part.used_generation.store(UNUSED_GENERATION, std::memory_order_relaxed);
+
+        if (!mix) {
+            mix = part.mix;
+            continue;
+        }
+        bank.accumulateMix(mix, part.mix, num_frames);
+    }
+
+    bank.resolveMix(mix, outL, outR, num_frames, mode_out, num_mode_out, accumulate);
+}
@@ -0,0 +1,104 @@
+/**
+ * @file RenderWorkerPool.h
+ * @brief Fixed pool of real-time worker threads for VoiceBank rendering
+ *
+ * The prepared VoiceBank render list is split into chunks of oscillators.
+ * The calling (audio) thread and the workers claim chunks from a single
+ * atomic work word with compare-and-swap, render them into their own
+ * accumulation buffer, and the caller sums the buffers once every chunk
+ * is done. No mutexes or condition variables are used: idle workers spin,
+ * then yield, then nap. The caller renders too, so a napping worker only
+ * costs parallelism, never latency.
+ *
+ * Threads and buffers are created in the constructor (not real-time safe);
+ * render() does not allocate.
+ */
+
+#ifndef RENDER_WORKER_POOL_H
+#define RENDER_WORKER_POOL_H
+
+#include "VoiceBank.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+/**
+ * @brief Oscillators per work chunk (4 voices × MAX_MODES)
+ */
+#define RENDER_CHUNK_OSCILLATORS 16
+
+class RenderWorkerPool {
+public:
+    /**
+     * @brief Start worker threads
+     * @param num_workers Worker threads (the caller of render() also works)
+     * @param max_block_size Largest block render() is called with
+     */
+    RenderWorkerPool(uint32_t num_workers, uint32_t max_block_size);
+
+    /**
+     * @brief Stop and join worker threads
+     */
+    ~RenderWorkerPool();
+
+    RenderWorkerPool(const RenderWorkerPool&) = delete;
+    RenderWorkerPool& operator=(const RenderWorkerPool&) = delete;
+
+    /**
+     * @brief Render a prepared bank across the pool
+     *
+     * Same result as VoiceBank::render(), up to summation order.
+     *
+     * @param bank Bank prepared for this block
+     * @param outL Left channel output
+     * @param outR Right channel output
+     * @param num_frames Number of frames (<= max_block_size)
+     * @param mode_out Mode bus outputs, or nullptr (see VoiceBank::render)
+     * @param num_mode_out Entries in mode_out
+     * @param accumulate Add into the outputs instead of overwriting them
+     */
+    void render(VoiceBank& bank, float* outL, float* outR, uint32_t num_frames,
+                float* const* mode_out = nullptr, uint32_t num_mode_out = 0,
+                bool accumulate = false);
+
+    /**
+     * @brief Get number of worker threads
+     * @return Worker count (excluding the calling thread)
+     */
+    uint32_t getNumWorkers() const { return num_workers_; }
+
+private:
+    /**
+     * @brief Per-thread accumulation state (own cache lines)
+     */
+    struct alignas(64) Participant {
+        float* mix;                             ///< Mono accumulation buffer
+        float* scratch;                         ///< Kernel scratch
+        std::atomic<uint32_t> used_generation;  ///< Last job this thread rendered in
+    };
+
+    uint32_t num_workers_;                  ///< Worker threads
+    uint32_t max_block_size_;               ///< Buffer capacity (frames)
+    std::thread* threads_;                  ///< Worker threads [num_workers]
+    Participant* participants_;             ///< [0] = caller, [1..] = workers
+
+    // Work word: generation (24 bits) | chunk count (20 bits) | next chunk (20 bits)
+    alignas(64) std::atomic<uint64_t> work_;
+    alignas(64) std::atomic<uint32_t> completed_;   ///< Chunks finished in current job
+    std::atomic<bool> running_;                     ///< Cleared to stop workers
+
+    // Job parameters, stable while the job has unclaimed or running chunks
+    VoiceBank* job_bank_;
+    uint32_t job_frames_;
+    uint32_t generation_;
+
+    void workerLoop(uint32_t participant);
+
+    /**
+     * @brief Claim and render chunks of job generation until none remain
+     * @return True if at least one chunk was rendered
+     */
+    bool runChunks(uint32_t participant, uint32_t generation);
+};
+
+#endif // RENDER_WORKER_POOL_H
@@ -0,0 +1,61 @@
+/**
+ * @file SpscRing.h
+ * @brief Lock-free single-producer / single-consumer ring buffer
+ *
+ * Fixed capacity, no allocation after construction. One thread may push
+ * and one (other) thread may peek/pop; both sides are wait-free.
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstdint>
+
+template <typename T, uint32_t Capacity>
+class SpscRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscRing capacity must be a power of two");
+
+public:
+    SpscRing() : head_(0), tail_(0) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * @brief Append an item (producer thread only)
+     * @return False if the ring is full (item dropped)
+     */
+    bool push(const T& item) {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= Capacity) return false;
+
+        items_[head & (Capacity - 1)] = item;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Oldest item, or nullptr if empty (consumer thread only)
+     */
+    const T* front() const {
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) return nullptr;
+        return &items_[tail & (Capacity - 1)];
+    }
+
+    /**
+     * @brief Remove the oldest item (consumer thread only, ring not empty)
+     */
+    void pop() {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    alignas(64) std::atomic<uint32_t> head_;   ///< Next write index (producer)
+    alignas(64) std::atomic<uint32_t> tail_;   ///< Next read index (consumer)
+    T items_[Capacity];
+};
+
+#endif // SPSC_RING_H
@@ -4,65 +4,335 @@
  */
 
 #include "TopologyEngine.h"
-#include <cstring>
-#include <cstdlib>
+#include "SimdTypes.h"
 #include <cmath>
 #include <complex>
+#include <cstring>
 #include <algorithm>
 
+/**
+ * @brief One lane per mode (128-bit: SSE / NEON)
+ */
+typedef float mode_vec_t __attribute__((vector_size(MAX_MODES * sizeof(float))));
+
+/**
+ * @brief Floats per snapshot source record: masked re, masked im and mask rows
+ */
+static const uint32_t kSnapshotStride = 3 * MAX_MODES;
+
+/**
+ * @brief Floats per snapshot receiver record: unmasked re and im rows
+ */
+static const uint32_t kSnapshotSelfStride = 2 * MAX_MODES;
+
+static inline mode_vec_t load_modes(const float* p) {
+    mode_vec_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+
 TopologyEngine::TopologyEngine(uint32_t num_voices)
     : num_voices_(num_voices)
     , coupling_strength_(0.3f)
     , topology_type_(TopologyType::None)
     , topology_param_(0.1f)
+    , num_edges_(0)
+    , morphing_(false)
+    , morph_position_(0.0f)
+    , morph_rate_(0.0f)
+    , num_build_edges_(0)
+    , snapshot_valid_(false)
+    , seed_(MODAL_DEFAULT_SEED)
+    , rng_state_(1)
 {
-    allocateMatrix();
+    // Worst case is the complete graph; small-world rewiring emits up to
+    // 6 entries per voice (ring + remove/add pairs)
+    row_capacity_ = num_voices_ > 0 ? num_voices_ - 1 : 0;
+    build_capacity_ = num_voices_ * row_capacity_ + 6 * num_voices_;
+
+    const uint32_t slots = num_voices_ * row_capacity_;
+    row_length_ = new uint32_t[num_voices_]();
+    edge_source_ = new uint32_t[slots];
+    edge_raw_ = new float[slots];
+    edge_weight_ = new float[slots];
+    edge_from_ = new float[slots];
+    edge_to_ = new float[slots];
+    row_morphing_ = new uint8_t[num_voices_]();
+
+    scratch_source_ = new uint32_t[row_capacity_];
+    scratch_raw_ = new float[row_capacity_];
+    scratch_from_ = new float[row_capacity_];
+    scratch_to_ = new float[row_capacity_];
+
+    build_edges_ = new Edge[build_capacity_];
+
+    snapshot_ = vbuffer_alloc(num_voices_ * kSnapshotStride);
+    snapshot_self_ = vbuffer_alloc(num_voices_ * kSnapshotSelfStride);
+    receiving_ = new uint8_t[num_voices_]();
+    coupling_input_ = new std::complex<float>[num_voices_ * MAX_MODES]();
 }
 
 TopologyEngine::~TopologyEngine() {
-    if (coupling_matrix_) {
-        for (uint32_t i = 0; i < num_voices_; i++) {
-            delete[] coupling_matrix_[i];
+    delete[] row_length_;
+    delete[] edge_source_;
+    delete[] edge_raw_;
+    delete[] edge_weight_;
+    delete[] edge_from_;
+    delete[] edge_to_;
+    delete[] row_morphing_;
+    delete[] scratch_source_;
+    delete[] scratch_raw_;
+    delete[] scratch_from_;
+    delete[] scratch_to_;
+    delete[] build_edges_;
+    vbuffer_free(snapshot_);
+    vbuffer_free(snapshot_self_);
+    delete[] receiving_;
+    delete[] coupling_input_;
+}
+
+uint32_t TopologyEngine::nextRandom() {
+    uint32_t x = rng_state_;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state_ = x;
+    return x;
+}
+
+void TopologyEngine::setEdge(uint32_t i, uint32_t j, float weight) {
+    if (i >= num_voices_ || j >= num_voices_ || i == j) return;
+    if (num_build_edges_ >= build_capacity_) return;
+
+    Edge& e = build_edges_[num_build_edges_];
+    e.row = i;
+    e.col = j;
+    e.seq = num_build_edges_;
+    e.weight = weight;
+    num_build_edges_++;
+}
+
+void TopologyEngine::buildAdjacency() {
+    // Group by (row, col); the last write for each pair wins
+    std::sort(build_edges_, build_edges_ + num_build_edges_,
+              [](const Edge& a, const Edge& b) {
+                  if (a.row != b.row) return a.row < b.row;
+                  if (a.col != b.col) return a.col < b.col;
+                  return a.seq < b.seq;
+              });
+
+    std::fill(row_length_, row_length_ + num_voices_, 0u);
+    num_edges_ = 0;
+
+    for (uint32_t n = 0; n < num_build_edges_; n++) {
+        const Edge& e = build_edges_[n];
+
+        // Skip superseded writes for the same pair
+        if (n + 1 < num_build_edges_ &&
+            build_edges_[n + 1].row == e.row && build_edges_[n + 1].col == e.col) {
+            continue;
         }
-        delete[] coupling_matrix_;
+        if (e.weight <= 0.0f) continue;
+
+        uint32_t slot = e.row * row_capacity_ + row_length_[e.row]++;
+        edge_source_[slot] = e.col;
+        edge_raw_[slot] = e.weight;
+        num_edges_++;
     }
-}
 
-void TopologyEngine::allocateMatrix() {
-    coupling_matrix_ = new float*[num_voices_];
+    num_build_edges_ = 0;
+
     for (uint32_t i = 0; i < num_voices_; i++) {
-        coupling_matrix_[i] = new float[num_voices_];
-        memset(coupling_matrix_[i], 0, num_voices_ * sizeof(float));
+        normalizeRow(i);
+        row_morphing_[i] = 0;
     }
+    morphing_ = false;
+}
+
+void TopologyEngine::normalizeRow(uint32_t i) {
+    // Sum of connections = 1.0 (diffusive coupling)
+    const uint32_t begin = i * row_capacity_;
+    const uint32_t end = begin + row_length_[i];
+
+    float sum = 0.0f;
+    for (uint32_t e = begin; e < end; e++) sum += edge_raw_[e];
+
+    const float scale = sum > 0.0f ? 1.0f / sum : 0.0f;
+    for (uint32_t e = begin; e < end; e++) edge_weight_[e] = edge_raw_[e] * scale;
+}
+
+void TopologyEngine::finishRowMorph(uint32_t i) {
+    // Drop edges that faded out (absent from the target)
+    const uint32_t begin = i * row_capacity_;
+    uint32_t kept = begin;
+    for (uint32_t e = begin; e < begin + row_length_[i]; e++) {
+        if (edge_raw_[e] <= 0.0f) continue;
+        edge_source_[kept] = edge_source_[e];
+        edge_raw_[kept] = edge_raw_[e];
+        kept++;
+    }
+
+    num_edges_ -= row_length_[i] - (kept - begin);
+    row_length_[i] = kept - begin;
+    row_morphing_[i] = 0;
+    normalizeRow(i);
+}
+
+uint32_t TopologyEngine::getDegree(uint32_t voice) const {
+    if (voice >= num_voices_) return 0;
+    return row_length_[voice];
+}
+
+float TopologyEngine::getCouplingWeight(uint32_t i, uint32_t j) const {
+    if (i >= num_voices_) return 0.0f;
+
+    const uint32_t* begin = edge_source_ + i * row_capacity_;
+    const uint32_t* end = begin + row_length_[i];
+    const uint32_t* it = std::lower_bound(begin, end, j);
+    if (it == end || *it != j) return 0.0f;
+
+    return edge_weight_[it - edge_source_];
 }
 
-void TopologyEngine::clearMatrix() {
+float TopologyEngine::getEdgeWeight(uint32_t i, uint32_t j) const {
+    if (i >= num_voices_) return 0.0f;
+
+    const uint32_t* begin = edge_source_ + i * row_capacity_;
+    const uint32_t* end = begin + row_length_[i];
+    const uint32_t* it = std::lower_bound(begin, end, j);
+    if (it == end || *it != j) return 0.0f;
+
+    return edge_raw_[it - edge_source_];
+}
+
+bool TopologyEngine::setEdgeWeight(uint32_t i, uint32_t j, float weight) {
+    if (i >= num_voices_ || j >= num_voices_ || i == j) return false;
+
+    if (row_morphing_[i]) finishRowMorph(i);
+
+    const uint32_t begin = i * row_capacity_;
+    const uint32_t end = begin + row_length_[i];
+    const uint32_t slot = static_cast<uint32_t>(
+        std::lower_bound(edge_source_ + begin, edge_source_ + end, j) - edge_source_);
+    const bool present = slot < end && edge_source_[slot] == j;
+
+    if (weight > 0.0f) {
+        if (!present) {
+            // Open a slot, keeping the row sorted (j != i, so the row has room)
+            std::copy_backward(edge_source_ + slot, edge_source_ + end, edge_source_ + end + 1);
+            std::copy_backward(edge_raw_ + slot, edge_raw_ + end, edge_raw_ + end + 1);
+            edge_source_[slot] = j;
+            row_length_[i]++;
+            num_edges_++;
+        }
+        edge_raw_[slot] = weight;
+    } else {
+        if (!present) return true;
+        std::copy(edge_source_ + slot + 1, edge_source_ + end, edge_source_ + slot);
+        std::copy(edge_raw_ + slot + 1, edge_raw_ + end, edge_raw_ + slot);
+        row_length_[i]--;
+        num_edges_--;
+    }
+
+    normalizeRow(i);
+    return true;
+}
+
+bool TopologyEngine::morphTo(const TopologyEngine& target, float duration_sec) {
+    if (&target == this) return true;
+    if (target.num_voices_ != num_voices_) return false;
+
+    topology_type_ = target.topology_type_;
+    morphing_ = false;
+
     for (uint32_t i = 0; i < num_voices_; i++) {
-        memset(coupling_matrix_[i], 0, num_voices_ * sizeof(float));
+        const uint32_t base = i * row_capacity_;
+        const uint32_t len = row_length_[i];
+        const uint32_t target_len = target.row_length_[i];
+
+        // Merge current and target rows (both sorted by source)
+        uint32_t a = 0, b = 0, n = 0;
+        bool changed = false;
+        while (a < len || b < target_len) {
+            uint32_t src_a = a < len ? edge_source_[base + a] : num_voices_;
+            uint32_t src_b = b < target_len ? target.edge_source_[base + b] : num_voices_;
+            uint32_t src = std::min(src_a, src_b);
+
+            scratch_source_[n] = src;
+            scratch_from_[n] = src_a == src ? edge_weight_[base + a++] : 0.0f;
+            if (src_b == src) {
+                scratch_raw_[n] = target.edge_raw_[base + b];
+                scratch_to_[n] = target.edge_weight_[base + b];
+                b++;
+            } else {
+                scratch_raw_[n] = 0.0f;
+                scratch_to_[n] = 0.0f;
+            }
+            changed |= scratch_from_[n] != scratch_to_[n];
+            n++;
+        }
+
+        std::copy(scratch_source_, scratch_source_ + n, edge_source_ + base);
+        std::copy(scratch_raw_, scratch_raw_ + n, edge_raw_ + base);
+        std::copy(scratch_from_, scratch_from_ + n, edge_from_ + base);
+        std::copy(scratch_to_, scratch_to_ + n, edge_to_ + base);
+        std::copy(scratch_from_, scratch_from_ + n, edge_weight_ + base);
+        num_edges_ += n - len;
+        row_length_[i] = n;
+
+        if (changed && duration_sec > 0.0f) {
+            row_morphing_[i] = 1;
+            morphing_ = true;
+        } else {
+            finishRowMorph(i);
+        }
     }
+
+    morph_position_ = 0.0f;
+    morph_rate_ = duration_sec > 0.0f ? 1.0f / duration_sec : 0.0f;
+    return true;
 }
 
-void TopologyEngine::normalizeMatrix() {
-    // Normalize each row so that sum of connections = 1.0 (diffusive coupling)
+void TopologyEngine::advanceMorph(float dt) {
+    if (!morphing_) return;
+
+    morph_position_ += dt * morph_rate_;
+    const bool done = morph_position_ >= 1.0f - 1e-5f;  // Float accumulation of dt
+    const float t = done ? 1.0f : morph_position_;
+
     for (uint32_t i = 0; i < num_voices_; i++) {
-        float sum = 0.0f;
-        for (uint32_t j = 0; j < num_voices_; j++) {
-            sum += coupling_matrix_[i][j];
+        if (!row_morphing_[i]) continue;
+
+        if (done) {
+            finishRowMorph(i);
+            continue;
         }
 
-        if (sum > 0.0f) {
-            for (uint32_t j = 0; j < num_voices_; j++) {
-                coupling_matrix_[i][j] /= sum;
-            }
+        // Convex blend of two normalized rows stays normalized
+        const uint32_t begin = i * row_capacity_;
+        for (uint32_t e = begin; e < begin + row_length_[i]; e++) {
+            edge_weight_[e] = edge_from_[e] + (edge_to_[e] - edge_from_[e]) * t;
         }
     }
+
+    if (done) morphing_ = false;
 }
 
 void TopologyEngine::generateTopology(TopologyType type, float coupling_strength) {
     topology_type_ = type;
     coupling_strength_ = coupling_strength;
 
-    clearMatrix();
+    num_build_edges_ = 0;
+
+    // Restart the stream: same seed and type, same graph
+    uint32_t h = seed_;
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    rng_state_ = h ? h : 0x6D2B79F5u;
 
     switch (type) {
         case TopologyType::Ring:
@@ -91,53 +361,99 @@ void TopologyEngine::generateTopology(TopologyType type, float coupling_strength
 
         case TopologyType::None:
         default:
-            // No coupling - matrix stays zero
+            // No coupling - no edges
             break;
     }
 
-    normalizeMatrix();
+    buildAdjacency();
 }
 
-void TopologyEngine::updateCoupling(ModalVoice** voices, uint32_t num_voices) {
-    if (!voices || num_voices != num_voices_) return;
-
-    // Apply coupling for each voice
-    for (uint32_t i = 0; i < num_voices; i++) {
-        if (!voices[i]->isActive()) continue;
+void TopologyEngine::updateCoupling(ModalVoice** voices, uint32_t num_voices,
+                                    const uint16_t* active_voices, uint32_t num_active) {
+    if (!voices || num_edges_ == 0) return;
+    if (!snapshotCoupling(voices, num_voices)) return;
+    computeCoupling(active_voices, 0, num_active);
+    applyCoupling(voices, active_voices, num_active);
+}
 
-        // Calculate coupling inputs for this voice
-        float coupling_inputs[MAX_MODES] = {0.0f};
+bool TopologyEngine::snapshotCoupling(ModalVoice* const* voices, uint32_t num_voices) {
+    snapshot_valid_ = voices && num_voices == num_voices_;
+    if (!snapshot_valid_) return false;
+
+    // Masked rows make silent sources zero records for the edge loop
+    for (uint32_t j = 0; j < num_voices; j++) {
+        const modal_node_t* node = voices[j]->getNode();
+        const bool awake = voices[j]->isAwake();
+        float* record = snapshot_ + j * kSnapshotStride;
+        float* self = snapshot_self_ + j * kSnapshotSelfStride;
+        for (int k = 0; k < MAX_MODES; k++) {
+            const float* a = reinterpret_cast<const float*>(&node->modes[k].a);  // {re, im}
+            float m = (awake && node->modes[k].params.active) ? 1.0f : 0.0f;
+            record[k] = m * a[0];
+            record[MAX_MODES + k] = m * a[1];
+            record[2 * MAX_MODES + k] = m;
+            self[k] = a[0];
+            self[MAX_MODES + k] = a[1];
+        }
+        receiving_[j] = voices[j]->isActive();  // Dormant ones decide whether to wake
+    }
+    return true;
+}
 
-        for (uint32_t j = 0; j < num_voices; j++) {
-            if (i == j || !voices[j]->isActive()) continue;
+void TopologyEngine::computeCoupling(const uint16_t* active_voices, uint32_t first, uint32_t count) {
+    if (!snapshot_valid_) return;
+
+    for (uint32_t n = first; n < first + count; n++) {
+        uint32_t i = active_voices[n];
+        if (i >= num_voices_ || !receiving_[i]) continue;
+
+        // Row i × snapshot records: Σ w·m·a and Σ w·m, all modes per lane
+        mode_vec_t sum_re = {}, sum_im = {}, sum_w = {};
+        const uint32_t begin = i * row_capacity_;
+        const uint32_t end = begin + row_length_[i];
+        for (uint32_t e = begin; e < end; e++) {
+            const float* record = snapshot_ + edge_source_[e] * kSnapshotStride;
+            const mode_vec_t w = mode_vec_t{} + edge_weight_[e];
+            sum_re += w * load_modes(record);
+            sum_im += w * load_modes(record + MAX_MODES);
+            sum_w += w * load_modes(record + 2 * MAX_MODES);
+        }
 
-            float coupling_weight = coupling_matrix_[i][j];
-            if (coupling_weight > 0.0f) {
-                // Get mode 0 amplitude from neighbor voice
-                std::complex<float> neighbor_amp = voices[j]->getMode0Amplitude();
+        // Diffusive: Σ w·m·(a_j - a_i) = Σ w·m·a_j - a_i·Σ w·m
+        const float* self = snapshot_self_ + i * kSnapshotSelfStride;
+        const mode_vec_t strength = mode_vec_t{} + coupling_strength_;
+        mode_vec_t in_re = strength * (sum_re - sum_w * load_modes(self));
+        mode_vec_t in_im = strength * (sum_im - sum_w * load_modes(self + MAX_MODES));
 
-                // Diffusive coupling: (neighbor - self) * weight
-                std::complex<float> self_amp = voices[i]->getMode0Amplitude();
-                std::complex<float> diff = neighbor_amp - self_amp;
+        std::complex<float>* input = coupling_input_ + i * MAX_MODES;
+        for (int k = 0; k < MAX_MODES; k++) input[k] = std::complex<float>(in_re[k], in_im[k]);
+    }
+}
 
-                // Apply to mode 0 (can extend to all modes)
-                coupling_inputs[0] += std::abs(diff) * coupling_weight * coupling_strength_;
-            }
-        }
+void TopologyEngine::applyCoupling(ModalVoice** voices, const uint16_t* active_voices,
+                                   uint32_t num_active) {
+    if (!snapshot_valid_) return;
 
-        // Apply coupling inputs to voice
-        voices[i]->applyCoupling(coupling_inputs);
+    for (uint32_t n = 0; n < num_active; n++) {
+        uint32_t i = active_voices[n];
+        if (i >= num_voices_ || !receiving_[i]) continue;
+        voices[i]->applyCoupling(coupling_input_ + i * MAX_MODES);
     }
 }
 
+std::complex<float> TopologyEngine::getCouplingInput(uint32_t voice, uint32_t mode) const {
+    if (voice >= num_voices_ || mode >= MAX_MODES) return 0.0f;
+    return coupling_input_[voice * MAX_MODES + mode];
+}
+
 void TopologyEngine::generateRing() {
     // Connect each voice to its two neighbors in a ring
     for (uint32_t i = 0; i < num_voices_; i++) {
         uint32_t left = (i - 1 + num_voices_) % num_voices_;
         uint32_t right = (i + 1) % num_voices_;
 
-        coupling_matrix_[i][left] = 1.0f;
-        coupling_matrix_[i][right] = 1.0f;
+        setEdge(i, left, 1.0f);
+        setEdge(i, right, 1.0f);
     }
 }
 
@@ -145,24 +461,20 @@ void TopologyEngine::generateSmallWorld(float rewire_prob) {
     // Start with ring topology
     generateRing();
 
-    // Rewire each edge with probability rewire_prob
+    // Rewire each ring edge (i, i + 1) with probability rewire_prob
     for (uint32_t i = 0; i < num_voices_; i++) {
-        for (uint32_t j = i + 1; j < num_voices_; j++) {
-            if (coupling_matrix_[i][j] > 0.0f) {
-                // Edge exists - rewire with probability rewire_prob
-                float rand_val = static_cast<float>(rand()) / RAND_MAX;
-                if (rand_val < rewire_prob) {
-                    // Remove old edge
-                    coupling_matrix_[i][j] = 0.0f;
-                    coupling_matrix_[j][i] = 0.0f;
-
-                    // Add random edge
-                    uint32_t new_target = rand() % num_voices_;
-                    if (new_target != i) {
-                        coupling_matrix_[i][new_target] = 1.0f;
-                        coupling_matrix_[new_target][i] = 1.0f;
-                    }
-                }
+        uint32_t j = (i + 1) % num_voices_;
+        if (j == i) continue;
+
+        float rand_val = randomUniform();
+        if (rand_val < rewire_prob) {
+            // Remove old edge
+            setUndirectedEdge(i, j, 0.0f);
+
+            // Add random edge
+            uint32_t new_target = nextRandom() % num_voices_;
+            if (new_target != i) {
+                setUndirectedEdge(i, new_target, 1.0f);
             }
         }
     }
@@ -180,7 +492,7 @@ void TopologyEngine::generateClustered(uint32_t cluster_size) {
         for (uint32_t i = cluster_start; i < cluster_end; i++) {
             for (uint32_t j = cluster_start; j < cluster_end; j++) {
                 if (i != j) {
-                    coupling_matrix_[i][j] = 1.0f;
+                    setEdge(i, j, 1.0f);
                 }
             }
         }
@@ -189,8 +501,7 @@ void TopologyEngine::generateClustered(uint32_t cluster_size) {
         if (cluster_idx < num_clusters - 1) {
             uint32_t next_cluster_start = (cluster_idx + 1) * cluster_size;
             if (next_cluster_start < num_voices_) {
-                coupling_matrix_[cluster_start][next_cluster_start] = 0.5f;
-                coupling_matrix_[next_cluster_start][cluster_start] = 0.5f;
+                setUndirectedEdge(cluster_start, next_cluster_start, 0.5f);
             }
         }
     }
@@ -202,8 +513,7 @@ void TopologyEngine::generateHubSpoke(uint32_t hub_idx) {
 
     for (uint32_t i = 0; i < num_voices_; i++) {
         if (i != hub_idx) {
-            coupling_matrix_[hub_idx][i] = 1.0f;
-            coupling_matrix_[i][hub_idx] = 1.0f;
+            setUndirectedEdge(hub_idx, i, 1.0f);
         }
     }
 }
@@ -212,10 +522,9 @@ void TopologyEngine::generateRandom(float connection_prob) {
     // Add edges with probability connection_prob
     for (uint32_t i = 0; i < num_voices_; i++) {
         for (uint32_t j = i + 1; j < num_voices_; j++) {
-            float rand_val = static_cast<float>(rand()) / RAND_MAX;
+            float rand_val = randomUniform();
             if (rand_val < connection_prob) {
-                coupling_matrix_[i][j] = 1.0f;
-                coupling_matrix_[j][i] = 1.0f;
+                setUndirectedEdge(i, j, 1.0f);
             }
         }
     }
@@ -226,7 +535,7 @@ void TopologyEngine::generateComplete() {
     for (uint32_t i = 0; i < num_voices_; i++) {
         for (uint32_t j = 0; j < num_voices_; j++) {
             if (i != j) {
-                coupling_matrix_[i][j] = 1.0f;
+                setEdge(i, j, 1.0f);
             }
         }
     }
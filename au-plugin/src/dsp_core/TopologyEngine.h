@@ -9,6 +9,26 @@
  * - Hub-and-spoke (Star)
  * - Random (Erdős–Rényi)
  * - Complete graph (all-to-all)
+ *
+ * Generators emit directed edges into a build list; generateTopology()
+ * resolves them into a row-normalized sparse adjacency, so updateCoupling()
+ * costs O(edges) rather than O(N²). Each row has a fixed slot capacity
+ * (N - 1) and keeps its raw weights, so individual edges can be added,
+ * removed or reweighted in place with only the edited row renormalized,
+ * and morphTo() can cross-fade to another topology at control rate.
+ * None of the edit, morph or coupling calls allocate.
+ *
+ * Coupling is complex and diffusive on every mode, in three phases per
+ * control tick: snapshotCoupling() copies all mode amplitudes into one
+ * contiguous buffer, computeCoupling() runs the sparse matrix × vector
+ * product from that snapshot into a separate input buffer, and
+ * applyCoupling() adds the inputs to the voices. Nothing a voice sees
+ * depends on the order voices are visited, and disjoint row ranges of
+ * computeCoupling() can run on different threads.
+ *
+ * Generators draw from a per-engine xorshift32 stream restarted from the
+ * seed on every generateTopology(), so a (type, parameter, seed) triple
+ * always gives the same graph.
  */
 
 #ifndef TOPOLOGY_ENGINE_H
@@ -51,11 +71,131 @@ public:
     void generateTopology(TopologyType type, float coupling_strength);
 
     /**
-     * @brief Update coupling between voices
+     * @brief Set the seed used by the random generators
+     *
+     * Takes effect at the next generateTopology(). Defaults to
+     * MODAL_DEFAULT_SEED.
+     *
+     * @param seed Seed value (any value, including 0)
+     */
+    void setSeed(uint32_t seed) {
+        seed_ = seed;
+    }
+
+    /**
+     * @brief Set the raw weight of edge j → i and renormalize row i
+     *
+     * A weight <= 0 removes the edge. Ends a morph in progress on row i
+     * first (the row jumps to its target weights). O(degree of i).
+     *
+     * @param i Receiving voice
+     * @param j Source voice
+     * @param weight Raw (unnormalized) weight
+     * @return False if i or j is out of range or i == j
+     */
+    bool setEdgeWeight(uint32_t i, uint32_t j, float weight);
+
+    /**
+     * @brief Set the raw weight in both directions (renormalizes rows i and j)
+     */
+    bool setUndirectedEdgeWeight(uint32_t i, uint32_t j, float weight) {
+        return setEdgeWeight(i, j, weight) && setEdgeWeight(j, i, weight);
+    }
+
+    /**
+     * @brief Remove edge j → i
+     */
+    bool removeEdge(uint32_t i, uint32_t j) {
+        return setEdgeWeight(i, j, 0.0f);
+    }
+
+    /**
+     * @brief Get raw (unnormalized) weight of edge j → i
+     * @return Raw weight (0 if not connected)
+     */
+    float getEdgeWeight(uint32_t i, uint32_t j) const;
+
+    /**
+     * @brief Start a morph towards another topology
+     *
+     * Each row's normalized weights are interpolated linearly from their
+     * current values (mid-morph values if a morph is running) to the
+     * target's over duration_sec, driven by advanceMorph(). Rows whose
+     * weights already match are left alone. A row fading in from no edges
+     * ramps its total coupling up from zero instead of jumping. The
+     * target's raw weights take over, and edges absent from the target
+     * are removed, when the morph ends.
+     *
+     * @param target Topology with the same number of voices
+     * @param duration_sec Morph time (<= 0 switches immediately)
+     * @return False if the voice counts differ
+     */
+    bool morphTo(const TopologyEngine& target, float duration_sec);
+
+    /**
+     * @brief Advance a running morph (call once per control tick)
+     * @param dt Time step in seconds
+     */
+    void advanceMorph(float dt);
+
+    /**
+     * @brief Check whether a morph is running
+     */
+    bool isMorphing() const {
+        return morphing_;
+    }
+
+    /**
+     * @brief Update coupling between voices (all three phases)
+     *
+     * For every mode k of receiving voice i:
+     *   input_ik = strength · Σ_j w_ij · m_jk · (a_jk - a_ik)
+     * with m_jk = 1 if voice j is awake and its mode k active, else 0, so
+     * inactive or dormant neighbors (and neighbors lacking the mode) are
+     * silent. Only voices in the active list receive coupling.
+     *
      * @param voices Array of voice pointers
      * @param num_voices Number of voices
+     * @param active_voices Indices of active voices
+     * @param num_active Number of entries in active_voices
+     */
+    void updateCoupling(ModalVoice** voices, uint32_t num_voices,
+                        const uint16_t* active_voices, uint32_t num_active);
+
+    /**
+     * @brief Phase 1: snapshot every voice's mode amplitudes
+     * @param voices Array of voice pointers
+     * @param num_voices Number of voices (must match the engine's)
+     * @return False if the voice count does not match (later phases skip)
+     */
+    bool snapshotCoupling(ModalVoice* const* voices, uint32_t num_voices);
+
+    /**
+     * @brief Phase 2: coupling inputs for a range of the active list
+     *
+     * Reads only the snapshot and the adjacency, and writes only the
+     * inputs of the voices in its range, so disjoint ranges may run
+     * concurrently. Not safe against concurrent topology edits or morphs.
+     *
+     * @param active_voices Indices of active voices (as for updateCoupling)
+     * @param first First entry of active_voices
+     * @param count Number of entries
+     */
+    void computeCoupling(const uint16_t* active_voices, uint32_t first, uint32_t count);
+
+    /**
+     * @brief Phase 3: apply computed inputs to the voices
+     * @param voices Array of voice pointers (as snapshotted)
+     * @param active_voices Indices of active voices (as computed)
+     * @param num_active Number of entries in active_voices
      */
-    void updateCoupling(ModalVoice** voices, uint32_t num_voices);
+    void applyCoupling(ModalVoice** voices, const uint16_t* active_voices, uint32_t num_active);
+
+    /**
+     * @brief Get the input last computed for a voice's mode
+     * @return Complex input (0 if out of range)
+     */
+    std::complex<float> getCouplingInput(uint32_t voice, uint32_t mode) const;
 
     /**
      * @brief Set coupling strength
@@ -73,6 +213,14 @@ public:
         return coupling_strength_;
     }
 
+    /**
+     * @brief Get number of voices in the network
+     * @return Voice count given to the constructor
+     */
+    uint32_t getNumVoices() const {
+        return num_voices_;
+    }
+
     /**
      * @brief Get current topology type
      * @return Topology type
@@ -97,27 +245,126 @@ public:
         return topology_param_;
     }
 
+    /**
+     * @brief Get number of directed edges in the current topology
+     *
+     * Includes edges still fading out while a morph runs.
+     *
+     * @return Edge count
+     */
+    uint32_t getEdgeCount() const {
+        return num_edges_;
+    }
+
+    /**
+     * @brief Get number of outgoing edges of a voice
+     * @param voice Voice index
+     * @return Degree (0 if out of range)
+     */
+    uint32_t getDegree(uint32_t voice) const;
+
+    /**
+     * @brief Get normalized coupling weight from voice j into voice i
+     * @param i Receiving voice
+     * @param j Source voice
+     * @return Weight (0 if not connected)
+     */
+    float getCouplingWeight(uint32_t i, uint32_t j) const;
+
 private:
+    /**
+     * @brief Directed edge as emitted by the generators
+     */
+    struct Edge {
+        uint32_t row;               ///< Receiving voice
+        uint32_t col;               ///< Source voice
+        uint32_t seq;               ///< Emission order (later writes win)
+        float weight;               ///< Raw weight (0 removes the edge)
+    };
+
     uint32_t num_voices_;           ///< Number of voices
-    float** coupling_matrix_;       ///< Coupling matrix [num_voices][num_voices]
     float coupling_strength_;       ///< Global coupling strength
     TopologyType topology_type_;    ///< Current topology type
     float topology_param_;          ///< Topology-specific parameter
 
+    // Padded rows: row i's edges are slots [i * row_capacity_, + row_length_[i]),
+    // sorted by source voice
+    uint32_t row_capacity_;         ///< Slots per row (num_voices - 1)
+    uint32_t* row_length_;          ///< Edges per row [num_voices]
+    uint32_t num_edges_;            ///< Sum of row_length_
+    uint32_t* edge_source_;         ///< Source voice per slot
+    float* edge_raw_;               ///< Raw weight per slot (morph: target's)
+    float* edge_weight_;            ///< Normalized weight per slot
+
+    // Morph state (valid for rows with row_morphing_ set)
+    float* edge_from_;              ///< Normalized weight at morph start
+    float* edge_to_;                ///< Normalized weight at morph end
+    uint8_t* row_morphing_;         ///< Row is interpolating [num_voices]
+    bool morphing_;                 ///< Any row is interpolating
+    float morph_position_;          ///< Morph progress (0-1)
+    float morph_rate_;              ///< Progress per second
+
+    // One merged row while a morph starts
+    uint32_t* scratch_source_;
+    float* scratch_raw_;
+    float* scratch_from_;
+    float* scratch_to_;
+
+    Edge* build_edges_;             ///< Generator output [build_capacity_]
+    uint32_t num_build_edges_;      ///< Entries in build_edges_
+    uint32_t build_capacity_;       ///< Capacity of build_edges_
+
+    // Coupling snapshot: per voice {m·Re(a), m·Im(a), m} × MAX_MODES, one
+    // contiguous, aligned source record [num_voices * kSnapshotStride], and
+    // the voice's own {Re(a), Im(a)} × MAX_MODES [num_voices * kSnapshotSelfStride]
+    float* snapshot_;
+    float* snapshot_self_;
+    uint8_t* receiving_;            ///< Voice takes coupling this tick [num_voices]
+    bool snapshot_valid_;           ///< Last snapshot matched num_voices_
+    std::complex<float>* coupling_input_;  ///< Computed inputs [num_voices * MAX_MODES]
+
+    uint32_t seed_;                 ///< Generator seed
+    uint32_t rng_state_;            ///< Generator xorshift32 state
+
+    /**
+     * @brief Set edge weight for j → i (overrides earlier writes)
+     */
+    void setEdge(uint32_t i, uint32_t j, float weight);
+
+    /**
+     * @brief Set weight in both directions
+     */
+    void setUndirectedEdge(uint32_t i, uint32_t j, float weight) {
+        setEdge(i, j, weight);
+        setEdge(j, i, weight);
+    }
+
+    /**
+     * @brief Resolve build list into rows and normalize them (diffusive coupling)
+     */
+    void buildAdjacency();
+
     /**
-     * @brief Allocate coupling matrix
+     * @brief Normalize row i's raw weights so they sum to 1
      */
-    void allocateMatrix();
+    void normalizeRow(uint32_t i);
 
     /**
-     * @brief Clear coupling matrix (set all to zero)
+     * @brief End row i's morph: target weights, faded-out edges removed
      */
-    void clearMatrix();
+    void finishRowMorph(uint32_t i);
 
     /**
-     * @brief Normalize coupling matrix rows (diffusive coupling)
+     * @brief Next generator random value (xorshift32)
      */
-    void normalizeMatrix();
+    uint32_t nextRandom();
+
+    /**
+     * @brief Uniform random value in [0, 1)
+     */
+    float randomUniform() {
+        return (nextRandom() >> 8) * (1.0f / 16777216.0f);
+    }
 
     /**
      * @brief Generate ring topology
@@ -4,61 +4,111 @@
  */
 
 #include "VoiceAllocator.h"
+#include "SimdTypes.h"
+#include <new>
 #include <cstring>
 #include <cmath>
 #include <algorithm>
+#include <chrono>
 
 VoiceAllocator::VoiceAllocator(uint32_t max_polyphony)
     : max_polyphony_(max_polyphony)
+    , num_voices_(max_polyphony + STEAL_FADE_VOICES)
+    , num_active_(0)
+    , num_free_(0)
+    , num_fade_free_(0)
+    , step_kernel_(modal_bank_step)
     , pitch_bend_(0.0f)
+    , mode_ramp_ticks_(0)
     , poke_strength_(0.5f)
     , poke_duration_ms_(10.0f)
+    , stereo_width_(0.0f)
+    , mode_spread_(0.0f)
+    , max_block_size_(0)
+    , worker_pool_(nullptr)
+    , num_render_workers_(0)
+    , parallel_min_voices_(DEFAULT_PARALLEL_MIN_VOICES)
+    , steal_policy_(StealPolicy::Oldest)
+    , cpu_budget_(0.0f)
+    , render_load_(0.0f)
+    , voice_cap_(max_polyphony)
+    , cap_settle_renders_(0)
+    , cap_shed_pending_(false)
+    , steal_count_(0)
+    , shed_count_(0)
+    , seed_(MODAL_DEFAULT_SEED)
     , sample_rate_(48000.0f)
     , initialized_(false)
 {
-    // Allocate voice pool
-    voices_ = new ModalVoice*[max_polyphony];
+    // Allocate voice pool as one contiguous, cache-line aligned arena
+    voice_stride_ = (sizeof(ModalVoice) + SIMD_ALIGNMENT - 1) / SIMD_ALIGNMENT * SIMD_ALIGNMENT;
+    voice_arena_ = new (std::align_val_t(SIMD_ALIGNMENT)) unsigned char[voice_stride_ * num_voices_];
+
+    voices_ = new ModalVoice*[num_voices_];
+    for (uint32_t i = 0; i < num_voices_; i++) {
+        voices_[i] = new (voice_arena_ + i * voice_stride_) ModalVoice(static_cast<uint8_t>(i));
+    }
+
+    // All voices start free; pushed in reverse so voice 0 is allocated first.
+    // Steal fade voices follow the note voices and have their own stack.
+    active_voices_ = new uint16_t[num_voices_];
+    active_slot_ = new uint16_t[num_voices_];
+    free_voices_ = new uint16_t[max_polyphony];
+    step_nodes_ = new modal_node_t*[num_voices_];
     for (uint32_t i = 0; i < max_polyphony; i++) {
-        voices_[i] = new ModalVoice(static_cast<uint8_t>(i));
+        free_voices_[num_free_++] = static_cast<uint16_t>(max_polyphony - 1 - i);
+    }
+    for (uint32_t i = 0; i < STEAL_FADE_VOICES; i++) {
+        fade_voices_[num_fade_free_++] = static_cast<uint16_t>(max_polyphony + STEAL_FADE_VOICES - 1 - i);
     }
 
     // Initialize note mapping to -1 (no voice assigned)
     memset(note_to_voice_, -1, sizeof(note_to_voice_));
+    memset(note_priority_, DEFAULT_NOTE_PRIORITY, sizeof(note_priority_));
 
     // Initialize default mode parameters (harmonic series with detuning)
-    mode_freq_multipliers_[0] = 1.0f;
-    mode_freq_multipliers_[1] = 1.01f;
-    mode_freq_multipliers_[2] = 2.0f;
-    mode_freq_multipliers_[3] = 3.0f;
-
-    mode_dampings_[0] = 0.5f;
-    mode_dampings_[1] = 0.6f;
-    mode_dampings_[2] = 0.8f;
-    mode_dampings_[3] = 1.0f;
-
-    mode_weights_[0] = 1.0f;
-    mode_weights_[1] = 0.7f;
-    mode_weights_[2] = 0.5f;
-    mode_weights_[3] = 0.3f;
+    static const float kDefaultModeParams[MODE_PARAM_COUNT][MAX_MODES] = {
+        {1.0f, 1.01f, 2.0f, 3.0f},      // Frequency multipliers
+        {0.5f, 0.6f, 0.8f, 1.0f},       // Dampings
+        {1.0f, 0.7f, 0.5f, 0.3f},       // Weights
+    };
+    memcpy(mode_params_, kDefaultModeParams, sizeof(mode_params_));
+    memcpy(mode_param_targets_, kDefaultModeParams, sizeof(mode_param_targets_));
+    memset(mode_param_steps_, 0, sizeof(mode_param_steps_));
 }
 
 VoiceAllocator::~VoiceAllocator() {
-    // Delete all voices
+    delete worker_pool_;
+
+    // Destroy all voices (constructed in place in the arena)
     if (voices_) {
-        for (uint32_t i = 0; i < max_polyphony_; i++) {
-            delete voices_[i];
+        for (uint32_t i = 0; i < num_voices_; i++) {
+            voices_[i]->~ModalVoice();
         }
         delete[] voices_;
     }
+    ::operator delete[](voice_arena_, std::align_val_t(SIMD_ALIGNMENT));
+
+    delete[] active_voices_;
+    delete[] active_slot_;
+    delete[] free_voices_;
+    delete[] step_nodes_;
 }
 
-void VoiceAllocator::initialize(float sample_rate) {
+void VoiceAllocator::initialize(float sample_rate, uint32_t max_block_size) {
     sample_rate_ = sample_rate;
 
+    // Allocate render state up front (never reallocated on the audio thread)
+    if (max_block_size == 0) max_block_size = DEFAULT_MAX_BLOCK_SIZE;
+    max_block_size_ = max_block_size;
+    bank_.initialize(num_voices_, max_block_size_, sample_rate);
+    setRenderThreads(num_render_workers_, parallel_min_voices_);
+
     // Initialize all voices
-    for (uint32_t i = 0; i < max_polyphony_; i++) {
+    for (uint32_t i = 0; i < num_voices_; i++) {
         voices_[i]->initialize(sample_rate);
     }
+    selectStepKernel();
 
     initialized_ = true;
 }
@@ -67,46 +117,52 @@ ModalVoice* VoiceAllocator::noteOn(uint8_t midi_note, uint8_t velocity) {
     if (!initialized_ || midi_note > 127) return nullptr;
 
     // Check if this note is already playing
-    int8_t existing_voice = note_to_voice_[midi_note];
+    int16_t existing_voice = note_to_voice_[midi_note];
     if (existing_voice >= 0) {
         // Re-trigger existing voice
         ModalVoice* voice = voices_[existing_voice];
         float vel_normalized = velocity / 127.0f;
         voice->noteOn(midi_note, vel_normalized);
         voice->setPitchBend(pitch_bend_);
+        voice->setStereoPosition(notePan(midi_note), mode_spread_);
         return voice;
     }
 
-    // Find free voice
-    ModalVoice* voice = findFreeVoice();
-    if (!voice) {
-        // No free voices, steal oldest
-        voice = stealOldestVoice();
+    // Find free voice, unless the CPU budget cap is reached
+    int32_t voice_idx = -1;
+    if (voice_cap_ >= max_polyphony_ || countSoundingVoices() < voice_cap_) {
+        voice_idx = findFreeVoice();
+    }
+    if (voice_idx < 0) {
+        // No free voices (or at the cap), steal one
+        voice_idx = stealVoice();
     }
 
-    if (voice) {
-        // Allocate voice
-        float vel_normalized = velocity / 127.0f;
-        voice->noteOn(midi_note, vel_normalized);
-        voice->setPitchBend(pitch_bend_);
+    if (voice_idx < 0) return nullptr;
 
-        // Update mapping
-        for (uint32_t i = 0; i < max_polyphony_; i++) {
-            if (voices_[i] == voice) {
-                note_to_voice_[midi_note] = static_cast<int8_t>(i);
-                break;
-            }
-        }
-    }
+    // Allocate voice
+    ModalVoice* voice = voices_[voice_idx];
+    float vel_normalized = velocity / 127.0f;
+    voice->noteOn(midi_note, vel_normalized);
+    voice->setPitchBend(pitch_bend_);
+    voice->setStereoPosition(notePan(midi_note), mode_spread_);
+
+    // Update mapping
+    note_to_voice_[midi_note] = static_cast<int16_t>(voice_idx);
 
     return voice;
 }
 
+float VoiceAllocator::notePan(uint8_t midi_note) const {
+    float pan = stereo_width_ * (midi_note - 60) / STEREO_PAN_NOTE_RANGE;
+    return std::min(std::max(pan, -1.0f), 1.0f);
+}
+
 void VoiceAllocator::noteOff(uint8_t midi_note) {
     if (midi_note > 127) return;
 
-    int8_t voice_idx = note_to_voice_[midi_note];
-    if (voice_idx >= 0 && voice_idx < static_cast<int8_t>(max_polyphony_)) {
+    int16_t voice_idx = note_to_voice_[midi_note];
+    if (voice_idx >= 0 && static_cast<uint32_t>(voice_idx) < max_polyphony_) {
         voices_[voice_idx]->noteOff();
         note_to_voice_[midi_note] = -1;
     }
@@ -114,10 +170,8 @@ void VoiceAllocator::noteOff(uint8_t midi_note) {
 
 void VoiceAllocator::allNotesOff() {
     // Release all active voices
-    for (uint32_t i = 0; i < max_polyphony_; i++) {
-        if (voices_[i]->isActive()) {
-            voices_[i]->noteOff();
-        }
+    for (uint32_t n = 0; n < num_active_; n++) {
+        voices_[active_voices_[n]]->noteOff();
     }
 
     // Clear note mapping
@@ -128,10 +182,8 @@ void VoiceAllocator::setPitchBend(float bend_amount) {
     pitch_bend_ = bend_amount;
 
     // Apply to all active voices
-    for (uint32_t i = 0; i < max_polyphony_; i++) {
-        if (voices_[i]->isActive()) {
-            voices_[i]->setPitchBend(bend_amount);
-        }
+    for (uint32_t n = 0; n < num_active_; n++) {
+        voices_[active_voices_[n]]->setPitchBend(bend_amount);
     }
 }
 
@@ -140,25 +192,70 @@ void VoiceAllocator::setPersonality(node_personality_t personality) {
     for (uint32_t i = 0; i < max_polyphony_; i++) {
         voices_[i]->setPersonality(personality);
     }
+    selectStepKernel();
+}
+
+void VoiceAllocator::selectStepKernel() {
+    // All voices share one mode layout and personality; voices that differ
+    // anyway fall back to the generic path inside the kernel
+    const modal_node_t* node = voices_[0]->getNode();
+    step_kernel_ = modal_step_kernel_select(modal_node_active_prefix(node), node->personality);
 }
 
 void VoiceAllocator::setModeParameters(uint8_t mode_idx, float freq_multiplier, float damping, float weight) {
     if (mode_idx >= 4) return;
 
-    // Store parameters
-    mode_freq_multipliers_[mode_idx] = freq_multiplier;
-    mode_dampings_[mode_idx] = damping;
-    mode_weights_[mode_idx] = weight;
+    // Store parameters (cancels any ramp on this mode)
+    const float values[MODE_PARAM_COUNT] = {freq_multiplier, damping, weight};
+    for (uint32_t p = 0; p < MODE_PARAM_COUNT; p++) {
+        mode_params_[p][mode_idx] = values[p];
+        mode_param_targets_[p][mode_idx] = values[p];
+        mode_param_steps_[p][mode_idx] = 0.0f;
+    }
 
-    // Apply to all voices
-    // Note: This updates mode parameters, but voices will recalculate frequencies
-    // based on their current MIDI note when updateFrequencies() is called
+    // Apply to all voices; each keeps the ratio for later notes and bends
     for (uint32_t i = 0; i < max_polyphony_; i++) {
-        // Get the voice's base frequency (440Hz * 2^((note-69)/12))
-        uint8_t midi_note = voices_[i]->getMIDINote();
-        float base_freq = 440.0f * powf(2.0f, (midi_note - 69) / 12.0f);
-        float freq = base_freq * freq_multiplier;
-        voices_[i]->setMode(mode_idx, freq, damping, weight);
+        voices_[i]->setModeTuning(mode_idx, freq_multiplier, damping, weight);
+    }
+}
+
+void VoiceAllocator::setModeParameterTargets(uint8_t mode_idx, float freq_multiplier,
+                                             float damping, float weight) {
+    if (mode_idx >= MAX_MODES) return;
+
+    mode_param_targets_[MODE_PARAM_RATIO][mode_idx] = freq_multiplier;
+    mode_param_targets_[MODE_PARAM_DAMPING][mode_idx] = damping;
+    mode_param_targets_[MODE_PARAM_WEIGHT][mode_idx] = weight;
+
+    // Every ramp restarts from where it is, so all land together
+    const float inv_ticks = 1.0f / MODE_PARAM_RAMP_TICKS;
+    for (uint32_t p = 0; p < MODE_PARAM_COUNT; p++) {
+        for (uint32_t k = 0; k < MAX_MODES; k++) {
+            mode_param_steps_[p][k] = (mode_param_targets_[p][k] - mode_params_[p][k]) * inv_ticks;
+        }
+    }
+    mode_ramp_ticks_ = MODE_PARAM_RAMP_TICKS;
+}
+
+float VoiceAllocator::getModeParameter(uint8_t mode_idx, uint32_t param) const {
+    if (mode_idx >= MAX_MODES || param >= MODE_PARAM_COUNT) return 0.0f;
+    return mode_params_[param][mode_idx];
+}
+
+void VoiceAllocator::advanceModeRamps() {
+    if (--mode_ramp_ticks_ == 0) {
+        memcpy(mode_params_, mode_param_targets_, sizeof(mode_params_));  // Land exactly
+        memset(mode_param_steps_, 0, sizeof(mode_param_steps_));
+    } else {
+        for (uint32_t p = 0; p < MODE_PARAM_COUNT; p++) {
+            for (uint32_t k = 0; k < MAX_MODES; k++) mode_params_[p][k] += mode_param_steps_[p][k];
+        }
+    }
+
+    // Idle voices too, so the next note starts at the current values
+    for (uint32_t i = 0; i < max_polyphony_; i++) {
+        voices_[i]->setModeTunings(mode_params_[MODE_PARAM_RATIO], mode_params_[MODE_PARAM_DAMPING],
+                                   mode_params_[MODE_PARAM_WEIGHT]);
     }
 }
 
@@ -178,96 +275,360 @@ void VoiceAllocator::setPokeDuration(float duration_ms) {
     }
 }
 
+void VoiceAllocator::setSilenceThreshold(float threshold) {
+    for (uint32_t i = 0; i < max_polyphony_; i++) {
+        voices_[i]->setSilenceThreshold(threshold);
+    }
+}
+
+void VoiceAllocator::setSeed(uint32_t seed) {
+    seed_ = seed;
+    for (uint32_t i = 0; i < max_polyphony_; i++) {
+        voices_[i]->setSeed(seed);
+    }
+}
+
+void VoiceAllocator::setNotePriority(uint8_t midi_note, uint8_t priority) {
+    if (midi_note > 127) return;
+    note_priority_[midi_note] = priority;
+}
+
+void VoiceAllocator::setCpuBudget(float fraction) {
+    cpu_budget_ = fraction > 0.0f ? fraction : 0.0f;
+    render_load_ = 0.0f;
+    voice_cap_ = max_polyphony_;
+    cap_settle_renders_ = 0;
+    cap_shed_pending_ = false;
+}
+
+void VoiceAllocator::setRenderThreads(uint32_t num_workers, uint32_t min_parallel_voices) {
+    num_render_workers_ = num_workers;
+    parallel_min_voices_ = min_parallel_voices;
+
+    delete worker_pool_;
+    worker_pool_ = nullptr;
+
+    // Pool buffers are sized by initialize(); created there if called before
+    if (num_workers > 0 && max_block_size_ > 0) {
+        worker_pool_ = new RenderWorkerPool(num_workers, max_block_size_);
+    }
+}
+
+bool VoiceAllocator::keepBefore(const ModalVoice* a, const ModalVoice* b) {
+    bool a_held = a->getState() != ModalVoice::State::Release;
+    bool b_held = b->getState() != ModalVoice::State::Release;
+    if (a_held != b_held) return a_held;
+    return a->getAge() < b->getAge();
+}
+
+void VoiceAllocator::adoptVoices(const VoiceAllocator& from) {
+    if (!initialized_ || !from.initialized_ || &from == this) return;
+
+    // Allocator-wide settings
+    pitch_bend_ = from.pitch_bend_;
+    memcpy(mode_params_, from.mode_params_, sizeof(mode_params_));
+    memcpy(mode_param_targets_, from.mode_param_targets_, sizeof(mode_param_targets_));
+    memcpy(mode_param_steps_, from.mode_param_steps_, sizeof(mode_param_steps_));
+    mode_ramp_ticks_ = from.mode_ramp_ticks_;
+    memcpy(note_priority_, from.note_priority_, sizeof(note_priority_));
+    poke_strength_ = from.poke_strength_;
+    poke_duration_ms_ = from.poke_duration_ms_;
+    stereo_width_ = from.stereo_width_;
+    mode_spread_ = from.mode_spread_;
+    steal_policy_ = from.steal_policy_;
+    cpu_budget_ = from.cpu_budget_;
+    render_load_ = from.render_load_;
+    voice_cap_ = max_polyphony_;
+    cap_settle_renders_ = 0;
+    cap_shed_pending_ = false;
+    steal_count_ = from.steal_count_;
+    shed_count_ = from.shed_count_;
+    seed_ = from.seed_;
+    bank_.copyOutputGain(from.bank_);
+
+    // Pick the voices to keep (source indices, collected in active_voices_)
+    uint32_t num_keep = 0;
+    for (uint32_t n = 0; n < from.num_active_; n++) {
+        uint16_t src = from.active_voices_[n];
+        if (num_keep < max_polyphony_) {
+            active_voices_[num_keep++] = src;
+            continue;
+        }
+
+        // Full: replace the kept voice least worth keeping, if this one beats it
+        uint32_t worst = 0;
+        for (uint32_t m = 1; m < num_keep; m++) {
+            if (keepBefore(from.voices_[active_voices_[worst]], from.voices_[active_voices_[m]])) worst = m;
+        }
+        if (keepBefore(from.voices_[src], from.voices_[active_voices_[worst]])) active_voices_[worst] = src;
+    }
+
+    // Kept voices take slots [0, num_keep) with their render state and notes
+    memset(note_to_voice_, -1, sizeof(note_to_voice_));
+    for (uint32_t i = 0; i < num_keep; i++) {
+        uint16_t src = active_voices_[i];
+        voices_[i]->copyStateFrom(*from.voices_[src]);
+        bank_.copyVoiceState(i, from.bank_, src);
+
+        uint8_t note = voices_[i]->getMIDINote();
+        if (from.note_to_voice_[note] == src) note_to_voice_[note] = static_cast<int16_t>(i);
+
+        active_voices_[i] = static_cast<uint16_t>(i);
+        active_slot_[i] = static_cast<uint16_t>(i);
+    }
+    num_active_ = num_keep;
+
+    // Idle voices get the shared configuration, silenced, with their own noise stream
+    num_free_ = 0;
+    for (uint32_t i = max_polyphony_; i-- > num_keep; ) {
+        voices_[i]->copyStateFrom(*from.voices_[0]);
+        voices_[i]->reset();
+        voices_[i]->setSeed(seed_);
+        free_voices_[num_free_++] = static_cast<uint16_t>(i);
+    }
+    num_fade_free_ = 0;
+    for (uint32_t i = num_voices_; i-- > max_polyphony_; ) {
+        voices_[i]->reset();
+        fade_voices_[num_fade_free_++] = static_cast<uint16_t>(i);
+    }
+
+    selectStepKernel();
+}
+
 void VoiceAllocator::updateVoices() {
     if (!initialized_) return;
 
-    // Update all active voices at control rate
-    for (uint32_t i = 0; i < max_polyphony_; i++) {
-        if (voices_[i]->isActive()) {
-            voices_[i]->updateModal();
+    if (voice_cap_ < max_polyphony_) shedVoices();
+    if (mode_ramp_ticks_ > 0) advanceModeRamps();
+
+    // Step all awake voices' modes in one pass of the specialized kernel
+    // (dormant ones are frozen)
+    uint32_t num_step = 0;
+    for (uint32_t n = 0; n < num_active_; n++) {
+        ModalVoice* voice = voices_[active_voices_[n]];
+        if (voice->isAwake()) step_nodes_[num_step++] = voice->getMutableNode();
+    }
+    step_kernel_(step_nodes_, num_step);
+
+    // Then per-voice state machines
+    for (uint32_t n = 0; n < num_active_; ) {
+        uint16_t voice_idx = active_voices_[n];
+        voices_[voice_idx]->finishModalUpdate();
+
+        // Released voice went quiet: the last entry moves into slot n
+        if (!voices_[voice_idx]->isActive()) {
+            releaseVoiceSlot(voice_idx);
+            continue;
         }
+        n++;
     }
 }
 
-void VoiceAllocator::renderAudio(float* outL, float* outR, uint32_t num_frames) {
+void VoiceAllocator::renderAudio(float* outL, float* outR, uint32_t num_frames,
+                                 float* const* mode_out, uint32_t num_mode_out, bool accumulate) {
+    if (!mode_out) num_mode_out = 0;
+    if (num_mode_out > MAX_MODES) num_mode_out = MAX_MODES;
+
     if (!initialized_) {
-        // Return silence
+        // Return silence (nothing to add when accumulating)
+        if (accumulate) return;
         memset(outL, 0, num_frames * sizeof(float));
         memset(outR, 0, num_frames * sizeof(float));
+        for (uint32_t k = 0; k < num_mode_out; k++) memset(mode_out[k], 0, num_frames * sizeof(float));
         return;
     }
 
-    // Clear output buffers
-    memset(outL, 0, num_frames * sizeof(float));
-    memset(outR, 0, num_frames * sizeof(float));
-
-    // Temporary buffers for each voice
-    float* tempL = new float[num_frames];
-    float* tempR = new float[num_frames];
-
-    // Mix all active voices
-    for (uint32_t i = 0; i < max_polyphony_; i++) {
-        if (voices_[i]->isActive()) {
-            // Render voice
-            voices_[i]->renderAudio(tempL, tempR, num_frames);
-
-            // Mix into output
-            for (uint32_t j = 0; j < num_frames; j++) {
-                outL[j] += tempL[j];
-                outR[j] += tempR[j];
-            }
+    // Timed only under a CPU budget; otherwise the clock is never read
+    bool timed = cpu_budget_ > 0.0f;
+    std::chrono::steady_clock::time_point start;
+    if (timed) start = std::chrono::steady_clock::now();
+
+    // Gather modal state once, then render in scratch-sized chunks
+    bank_.setModeBuses(num_mode_out > 0);
+    bank_.prepare(voices_, active_voices_, num_active_);
+
+    bool parallel = worker_pool_ && num_active_ >= parallel_min_voices_;
+
+    float* chunk_mode_out[MAX_MODES];
+    for (uint32_t offset = 0; offset < num_frames; offset += max_block_size_) {
+        uint32_t chunk = std::min(max_block_size_, num_frames - offset);
+        for (uint32_t k = 0; k < num_mode_out; k++) chunk_mode_out[k] = mode_out[k] + offset;
+        if (parallel) {
+            worker_pool_->render(bank_, outL + offset, outR + offset, chunk,
+                                 chunk_mode_out, num_mode_out, accumulate);
+        } else {
+            bank_.render(outL + offset, outR + offset, chunk, chunk_mode_out, num_mode_out, accumulate);
         }
     }
 
-    // Clean up
-    delete[] tempL;
-    delete[] tempR;
+    if (timed) {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        updateVoiceCap(elapsed.count(), num_frames);
+    }
 }
 
 ModalVoice* VoiceAllocator::getVoice(uint32_t voice_idx) {
-    if (voice_idx >= max_polyphony_) return nullptr;
+    if (voice_idx >= num_voices_) return nullptr;
     return voices_[voice_idx];
 }
 
-uint32_t VoiceAllocator::getActiveVoiceCount() const {
-    uint32_t count = 0;
-    for (uint32_t i = 0; i < max_polyphony_; i++) {
-        if (voices_[i]->isActive()) {
-            count++;
+int32_t VoiceAllocator::findFreeVoice() {
+    if (num_free_ == 0) return -1;
+
+    uint16_t voice_idx = free_voices_[--num_free_];
+    activateVoice(voice_idx);
+    return voice_idx;
+}
+
+void VoiceAllocator::activateVoice(uint16_t voice_idx) {
+    active_slot_[voice_idx] = static_cast<uint16_t>(num_active_);
+    active_voices_[num_active_++] = voice_idx;
+}
+
+int32_t VoiceAllocator::stealVoice() {
+    int32_t victim = (steal_policy_ == StealPolicy::ReleasedFirst)
+        ? selectVictim(StealPolicy::Oldest, true, false)
+        : selectVictim(steal_policy_, false, false);
+
+    // The victim's slot is reused immediately; the old note is played out
+    // by a fade voice, carrying its phase and smoothed level
+    if (victim >= 0) {
+        ModalVoice* voice = voices_[victim];
+        if (note_to_voice_[voice->getMIDINote()] == victim) {
+            note_to_voice_[voice->getMIDINote()] = -1;
+        }
+        if (voice->isAwake() && num_fade_free_ > 0) {
+            uint16_t fade_idx = fade_voices_[--num_fade_free_];
+            voices_[fade_idx]->copyStateFrom(*voice);
+            voices_[fade_idx]->fadeOut();
+            bank_.copyVoiceState(fade_idx, bank_, static_cast<uint32_t>(victim));
+            activateVoice(fade_idx);
         }
+        voice->reset();
+        bank_.clearVoiceState(static_cast<uint32_t>(victim));  // New note rises from silence
+        steal_count_++;
     }
-    return count;
+
+    return victim;
 }
 
-ModalVoice* VoiceAllocator::findFreeVoice() {
-    // Find first inactive voice
-    for (uint32_t i = 0; i < max_polyphony_; i++) {
-        if (!voices_[i]->isActive()) {
-            return voices_[i];
+int32_t VoiceAllocator::selectVictim(StealPolicy policy, bool released_first, bool skip_fading) const {
+    int32_t best = -1;
+    bool best_released = false;
+    float best_amplitude = 0.0f;
+    uint32_t best_age = 0;
+    uint8_t best_priority = 0;
+
+    for (uint32_t n = 0; n < num_active_; n++) {
+        uint16_t voice_idx = active_voices_[n];
+        const ModalVoice* voice = voices_[voice_idx];
+        if (voice_idx >= max_polyphony_) continue;  // Steal fade voice
+        if (skip_fading && voice->isFading()) continue;
+
+        bool released = voice->getState() == ModalVoice::State::Release;
+        float amplitude = (policy == StealPolicy::Quietest) ? voice->getAmplitude() : 0.0f;
+        uint32_t age = voice->getAge();
+        uint8_t priority = note_priority_[voice->getMIDINote()];
+
+        bool better;
+        if (best < 0) {
+            better = true;
+        } else if (released_first && released != best_released) {
+            better = released;
+        } else if (policy == StealPolicy::Quietest) {
+            better = amplitude < best_amplitude;
+        } else if (policy == StealPolicy::LowestPriority && priority != best_priority) {
+            better = priority < best_priority;
+        } else {
+            better = age > best_age;
+        }
+
+        if (better) {
+            best = voice_idx;
+            best_released = released;
+            best_amplitude = amplitude;
+            best_age = age;
+            best_priority = priority;
         }
     }
-    return nullptr;
+
+    return best;
 }
 
-ModalVoice* VoiceAllocator::stealOldestVoice() {
-    // Find oldest active voice
-    ModalVoice* oldest = nullptr;
-    uint32_t max_age = 0;
+uint32_t VoiceAllocator::countSoundingVoices() const {
+    uint32_t count = 0;
+    for (uint32_t n = 0; n < num_active_; n++) {
+        const ModalVoice* voice = voices_[active_voices_[n]];
+        if (voice->isAwake() && !voice->isFading()) count++;
+    }
+    return count;
+}
 
-    for (uint32_t i = 0; i < max_polyphony_; i++) {
-        if (voices_[i]->isActive()) {
-            uint32_t age = voices_[i]->getAge();
-            if (age > max_age) {
-                max_age = age;
-                oldest = voices_[i];
-            }
+void VoiceAllocator::shedVoices() {
+    uint32_t sounding = countSoundingVoices();
+    while (sounding > voice_cap_) {
+        int32_t victim = selectVictim(StealPolicy::Quietest, true, true);
+        if (victim < 0) break;
+
+        ModalVoice* voice = voices_[victim];
+        if (note_to_voice_[voice->getMIDINote()] == victim) {
+            note_to_voice_[voice->getMIDINote()] = -1;
         }
+        voice->fadeOut();
+        shed_count_++;
+        sounding--;
+    }
+}
+
+bool VoiceAllocator::shedInProgress() const {
+    if (countSoundingVoices() > voice_cap_) return true;  // updateVoices() not run yet
+    for (uint32_t n = 0; n < num_active_; n++) {
+        if (voices_[active_voices_[n]]->isFading()) return true;
     }
+    return false;
+}
+
+void VoiceAllocator::updateVoiceCap(double render_seconds, uint32_t num_frames) {
+    if (num_frames == 0) return;
 
-    // Force release the oldest voice
-    if (oldest) {
-        oldest->reset();
+    float block_load = static_cast<float>(render_seconds * sample_rate_ / num_frames);
+
+    // Renders (one per event sub-block) keep coming while shed voices fade:
+    // the load only means something again once they are gone
+    if (cap_shed_pending_) {
+        if (shedInProgress()) return;
+        cap_shed_pending_ = false;
+        cap_settle_renders_ = CPU_BUDGET_SETTLE_RENDERS;
+        render_load_ = block_load;
+        return;
+    }
+    render_load_ += CPU_LOAD_SMOOTHING * (block_load - render_load_);
+    if (cap_settle_renders_ > 0) {
+        cap_settle_renders_--;
+        return;
+    }
+
+    if (render_load_ > cpu_budget_) {
+        // Shrink below what is sounding now, so shedding takes effect
+        uint32_t sounding = std::min(voice_cap_, countSoundingVoices());
+        voice_cap_ = sounding > 1 ? sounding - 1 : 1;
+        cap_shed_pending_ = true;
+    } else if (render_load_ < cpu_budget_ * CPU_BUDGET_HYSTERESIS && voice_cap_ < max_polyphony_) {
+        voice_cap_++;
+    }
+}
+
+void VoiceAllocator::releaseVoiceSlot(uint32_t voice_idx) {
+    // Swap-remove from the active list
+    uint16_t slot = active_slot_[voice_idx];
+    uint16_t last = active_voices_[--num_active_];
+    active_voices_[slot] = last;
+    active_slot_[last] = slot;
+
+    if (voice_idx >= max_polyphony_) {
+        fade_voices_[num_fade_free_++] = static_cast<uint16_t>(voice_idx);
+        return;
     }
 
-    return oldest;
+    free_voices_[num_free_++] = static_cast<uint16_t>(voice_idx);
 }
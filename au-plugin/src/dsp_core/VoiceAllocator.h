@@ -5,21 +5,98 @@
  * Manages a pool of ModalVoice instances for polyphonic synthesis.
  * Handles:
  * - Note on/off events
- * - Voice stealing (when all voices are in use)
+ * - Voice stealing (when all voices are in use), with selectable policy
+ * - Optional CPU budget that sheds voices when rendering runs too long
  * - MIDI note → voice mapping
+ * - Mode parameter automation, ramped at control rate
+ *
+ * Sounding voices are tracked in a dense active-index list and idle
+ * voices in a free-list stack, so per-block work scales with the voices
+ * actually playing rather than max_polyphony.
  */
 
 #ifndef VOICE_ALLOCATOR_H
 #define VOICE_ALLOCATOR_H
 
 #include "ModalVoice.h"
+#include "VoiceBank.h"
+#include "RenderWorkerPool.h"
+#include "ModalKernels.h"
 #include <cstdint>
+#include <cstddef>
 
 /**
  * @brief Default maximum polyphony
  */
 #define DEFAULT_MAX_POLYPHONY 16
 
+/**
+ * @brief Default maximum frames per renderAudio() call
+ *
+ * Larger requests are rendered in chunks of this size.
+ */
+#define DEFAULT_MAX_BLOCK_SIZE 4096
+
+/**
+ * @brief Default active voice count at which multi-threaded rendering starts
+ */
+#define DEFAULT_PARALLEL_MIN_VOICES 16
+
+/**
+ * @brief Semitones from middle C (60) to a hard pan at full stereo width
+ */
+#define STEREO_PAN_NOTE_RANGE 36.0f
+
+/**
+ * @brief Control ticks a mode parameter change ramps over (20 ms at 500 Hz)
+ */
+#define MODE_PARAM_RAMP_TICKS 10
+
+/**
+ * @brief Rows of the mode parameter arrays
+ */
+#define MODE_PARAM_RATIO 0       // Frequency multiplier
+#define MODE_PARAM_DAMPING 1     // Damping coefficient
+#define MODE_PARAM_WEIGHT 2      // Audio weight
+#define MODE_PARAM_COUNT 3
+
+/**
+ * @brief Default per-note stealing priority (see setNotePriority)
+ */
+#define DEFAULT_NOTE_PRIORITY 64
+
+/**
+ * @brief CPU budget controller: load smoothing and raise hysteresis
+ *
+ * The voice cap drops by one while the smoothed render load is above
+ * budget, and rises by one per render while it is below
+ * budget × CPU_BUDGET_HYSTERESIS. After a drop the cap holds until the
+ * shed voices have faded out, then for CPU_BUDGET_SETTLE_RENDERS renders
+ * while the load is measured again without them.
+ */
+#define CPU_LOAD_SMOOTHING 0.1f
+#define CPU_BUDGET_HYSTERESIS 0.8f
+#define CPU_BUDGET_SETTLE_RENDERS 20
+
+/**
+ * @brief Voices beyond max_polyphony that play out stolen notes' fades
+ *
+ * A stolen voice is copied into one of these and faded there, so its slot
+ * restarts at once without cutting the old note. With all of them busy a
+ * steal cuts the victim.
+ */
+#define STEAL_FADE_VOICES 4
+
+/**
+ * @brief Which voice noteOn() takes when no voice is free
+ */
+enum class StealPolicy {
+    Oldest,          ///< Longest since note on
+    Quietest,        ///< Lowest current amplitude
+    ReleasedFirst,   ///< Oldest released voice, else oldest
+    LowestPriority   ///< Lowest per-note priority, ties to oldest
+};
+
 class VoiceAllocator {
 public:
     /**
@@ -35,9 +112,14 @@ public:
 
     /**
      * @brief Initialize allocator
+     *
+     * Allocates all render scratch memory, so renderAudio() never touches
+     * the heap afterwards.
+     *
      * @param sample_rate Sample rate in Hz
+     * @param max_block_size Largest block renderAudio() renders in one pass
      */
-    void initialize(float sample_rate);
+    void initialize(float sample_rate, uint32_t max_block_size = DEFAULT_MAX_BLOCK_SIZE);
 
     /**
      * @brief Handle MIDI note on
@@ -71,7 +153,7 @@ public:
     void setPersonality(node_personality_t personality);
 
     /**
-     * @brief Set mode parameters for all voices
+     * @brief Set mode parameters for all voices immediately
      * @param mode_idx Mode index (0-3)
      * @param freq_multiplier Frequency multiplier relative to base
      * @param damping Damping coefficient
@@ -79,6 +161,34 @@ public:
      */
     void setModeParameters(uint8_t mode_idx, float freq_multiplier, float damping, float weight);
 
+    /**
+     * @brief Ramp mode parameters toward new values (for automation)
+     *
+     * Only records the targets, so any number of changes between control
+     * ticks costs O(1) each. updateVoices() moves every parameter linearly
+     * toward its target, reaching it MODE_PARAM_RAMP_TICKS ticks after the
+     * latest change, and retunes all voices in one pass per tick while a
+     * ramp is running.
+     *
+     * @param mode_idx Mode index (0-3)
+     * @param freq_multiplier Target frequency multiplier
+     * @param damping Target damping coefficient
+     * @param weight Target audio weight
+     */
+    void setModeParameterTargets(uint8_t mode_idx, float freq_multiplier, float damping, float weight);
+
+    /**
+     * @brief Get a mode parameter's current (ramped) value
+     * @param mode_idx Mode index (0-3)
+     * @param param MODE_PARAM_RATIO, MODE_PARAM_DAMPING or MODE_PARAM_WEIGHT
+     */
+    float getModeParameter(uint8_t mode_idx, uint32_t param) const;
+
+    /**
+     * @brief Check whether mode parameters are still ramping
+     */
+    bool isModeRampActive() const { return mode_ramp_ticks_ > 0; }
+
     /**
      * @brief Set poke strength for future note-on events
      * @param strength Poke strength (0.0-1.0)
@@ -91,6 +201,150 @@ public:
      */
     void setPokeDuration(float duration_ms);
 
+    /**
+     * @brief Set keyboard stereo width for future note-on events
+     *
+     * Voices are panned by note: middle C in the center, notes
+     * STEREO_PAN_NOTE_RANGE semitones below/above at width fully left/right.
+     *
+     * @param width Stereo width (0 = mono, 1 = full)
+     */
+    void setStereoWidth(float width) { stereo_width_ = width; }
+
+    /**
+     * @brief Set mode spread for future note-on events
+     *
+     * Spreads each voice's modes around its pan (see VoiceBank).
+     *
+     * @param spread Mode spread (0 = all modes at the voice pan, 1 = full)
+     */
+    void setModeSpread(float spread) { mode_spread_ = spread; }
+
+    /**
+     * @brief Set gain applied to the rendered mix (see VoiceBank::setOutputGain)
+     * @param gain Output gain
+     * @param smooth False to jump to the new gain immediately
+     */
+    void setOutputGain(float gain, bool smooth = true) { bank_.setOutputGain(gain, smooth); }
+
+    /**
+     * @brief Get the output gain currently applied (mid-ramp while smoothing)
+     */
+    float getOutputGain() const { return bank_.getOutputGain(); }
+
+    /**
+     * @brief Set dormancy threshold for all voices (see ModalVoice::setSilenceThreshold)
+     * @param threshold Summed amplitude threshold (0 disables dormancy)
+     */
+    void setSilenceThreshold(float threshold);
+
+    /**
+     * @brief Seed all voices' noise generators (see modal_node_seed)
+     * @param seed Seed value
+     */
+    void setSeed(uint32_t seed);
+
+    /**
+     * @brief Set voice stealing policy
+     * @param policy Policy used when noteOn() finds no free voice
+     */
+    void setStealPolicy(StealPolicy policy) { steal_policy_ = policy; }
+
+    /**
+     * @brief Get voice stealing policy
+     * @return Current policy
+     */
+    StealPolicy getStealPolicy() const { return steal_policy_; }
+
+    /**
+     * @brief Set stealing priority of a MIDI note (StealPolicy::LowestPriority)
+     * @param midi_note MIDI note number (0-127)
+     * @param priority Priority (higher is kept longer)
+     */
+    void setNotePriority(uint8_t midi_note, uint8_t priority);
+
+    /**
+     * @brief Cap sounding voices by measured render time
+     *
+     * renderAudio() times itself against the real-time duration of the
+     * block. While the smoothed load exceeds the budget the voice cap
+     * shrinks; updateVoices() fades out voices over the cap (released
+     * voices first, quietest first) and noteOn() steals rather than exceed
+     * it. The cap recovers once the load falls back below the budget.
+     *
+     * @param fraction Budget as a fraction of block duration (0 disables)
+     */
+    void setCpuBudget(float fraction);
+
+    /**
+     * @brief Get smoothed render load
+     * @return Render time / block duration (EMA)
+     */
+    float getRenderLoad() const { return render_load_; }
+
+    /**
+     * @brief Update smoothed load and voice cap after a timed render
+     *
+     * renderAudio() calls this itself while a budget is set; a caller that
+     * times rendering elsewhere can report it here instead.
+     *
+     * @param render_seconds Time the render took
+     * @param num_frames Frames rendered
+     */
+    void updateVoiceCap(double render_seconds, uint32_t num_frames);
+
+    /**
+     * @brief Get current voice cap (max_polyphony unless the budget is exceeded)
+     * @return Maximum sounding voices
+     */
+    uint32_t getVoiceCap() const { return voice_cap_; }
+
+    /**
+     * @brief Get number of voices stolen by noteOn() since construction
+     * @return Steal count (wraps)
+     */
+    uint32_t getStealCount() const { return steal_count_; }
+
+    /**
+     * @brief Get number of voices faded out by the CPU budget since construction
+     * @return Shed count (wraps)
+     */
+    uint32_t getShedCount() const { return shed_count_; }
+
+    /**
+     * @brief Enable multi-threaded rendering (not real-time safe)
+     *
+     * Starts a RenderWorkerPool with num_workers threads. renderAudio()
+     * uses it while at least min_parallel_voices voices are active, and
+     * renders single-threaded otherwise. Coupling and modal updates stay
+     * on the caller's thread and run before the fan-out.
+     *
+     * @param num_workers Worker threads (0 disables multi-threading)
+     * @param min_parallel_voices Active voices needed to use the pool
+     */
+    void setRenderThreads(uint32_t num_workers,
+                          uint32_t min_parallel_voices = DEFAULT_PARALLEL_MIN_VOICES);
+
+    /**
+     * @brief Take over another allocator's sounding voices and settings
+     *
+     * Lets the polyphony change without a gap: a new allocator is built
+     * and initialized off the audio thread, then adopts the running one
+     * between control ticks. Voices, phases and smoothed amplitudes carry
+     * over, so sounding notes continue seamlessly. If more voices are
+     * sounding than this allocator holds, held notes are kept before
+     * released ones and younger before older; the rest stop. Idle voices
+     * take the running voices' personality, tuning and poke settings.
+     * Voice stealing, CPU budget, mode ramps, pitch bend, stereo and
+     * output gain settings carry over too; the worker pool does not.
+     *
+     * Real-time safe (no allocation). Both allocators must be initialized
+     * at the same sample rate.
+     *
+     * @param from Allocator currently rendering
+     */
+    void adoptVoices(const VoiceAllocator& from);
+
     /**
      * @brief Update all active voices (control rate)
      *
@@ -100,19 +354,45 @@ public:
 
     /**
      * @brief Render audio from all active voices
+     *
+     * All voices are rendered together through the SIMD VoiceBank, split
+     * across the worker pool when enabled (see setRenderThreads). Centered
+     * oscillators share one mono bus; panned ones are accumulated straight
+     * into stereo in the same pass.
+     *
+     * With mode outputs, mode k of every voice is also written (dry,
+     * before panning, after output gain) to mode_out[k] in the same pass;
+     * the stereo output is unchanged up to summation order.
+     *
+     * With accumulate, every output is added to rather than overwritten
+     * (and left untouched before initialize()).
+     *
      * @param outL Left channel output buffer
      * @param outR Right channel output buffer
      * @param num_frames Number of frames to render
+     * @param mode_out Mode bus output buffers, or nullptr for stereo only
+     * @param num_mode_out Entries in mode_out (<= MAX_MODES)
+     * @param accumulate Add into the outputs instead of overwriting them
      */
-    void renderAudio(float* outL, float* outR, uint32_t num_frames);
+    void renderAudio(float* outL, float* outR, uint32_t num_frames,
+                     float* const* mode_out = nullptr, uint32_t num_mode_out = 0,
+                     bool accumulate = false);
 
     /**
      * @brief Get voice by index
-     * @param voice_idx Voice index [0..max_polyphony-1]
+     * @param voice_idx Voice index [0..max_polyphony-1], or a steal fade
+     *        voice [max_polyphony..max_polyphony+STEAL_FADE_VOICES-1]
      * @return Pointer to voice, or nullptr if invalid index
      */
     ModalVoice* getVoice(uint32_t voice_idx);
 
+    /**
+     * @brief Get the voice pointer table
+     * @return Array of max_polyphony voice pointers, then the steal fade
+     *         voices (owned by the allocator)
+     */
+    ModalVoice** getVoices() { return voices_; }
+
     /**
      * @brief Get maximum polyphony
      * @return Maximum number of voices
@@ -123,38 +403,152 @@ public:
      * @brief Get number of active voices
      * @return Number of currently active voices
      */
-    uint32_t getActiveVoiceCount() const;
+    uint32_t getActiveVoiceCount() const { return num_active_; }
+
+    /**
+     * @brief Get indices of active voices (unordered)
+     * @return Array of getActiveVoiceCount() voice indices
+     */
+    const uint16_t* getActiveVoices() const { return active_voices_; }
+
+    /**
+     * @brief Get the control-rate step kernel in use (see ModalKernels.h)
+     * @return Kernel selected for the voices' mode count and personality
+     */
+    modal_step_kernel_t getStepKernel() const { return step_kernel_; }
 
 private:
-    ModalVoice** voices_;              ///< Voice pool
+    ModalVoice** voices_;              ///< Voice pointer table (into voice_arena_)
     uint32_t max_polyphony_;           ///< Maximum polyphony
+    uint32_t num_voices_;              ///< max_polyphony_ + STEAL_FADE_VOICES
+
+    // Voices are constructed in place in one cache-line aligned block,
+    // one voice per stride, so per-block voice loops stream through memory
+    unsigned char* voice_arena_;       ///< Contiguous voice storage
+    size_t voice_stride_;              ///< Bytes per voice (cache-line multiple)
 
-    int8_t note_to_voice_[128];        ///< MIDI note → voice mapping (-1 = none)
+    // Voice bookkeeping (allocated once in the constructor)
+    uint16_t* active_voices_;          ///< Dense list of active voice indices
+    uint16_t* active_slot_;            ///< Voice index → position in active_voices_
+    uint32_t num_active_;              ///< Entries in active_voices_
+    uint16_t* free_voices_;            ///< Stack of inactive voice indices
+    uint32_t num_free_;                ///< Entries in free_voices_
+    uint16_t fade_voices_[STEAL_FADE_VOICES];  ///< Stack of idle steal fade voices
+    uint32_t num_fade_free_;           ///< Entries in fade_voices_
+    modal_node_t** step_nodes_;        ///< Nodes of awake voices, for step_kernel_
+    modal_step_kernel_t step_kernel_;  ///< Step kernel for the current configuration
+
+    int16_t note_to_voice_[128];       ///< MIDI note → voice mapping (-1 = none)
+    uint8_t note_priority_[128];       ///< Per-note stealing priority
     float pitch_bend_;                 ///< Current pitch bend amount
 
-    // Mode parameters (stored as multipliers for per-voice application)
-    float mode_freq_multipliers_[4];   ///< Frequency multipliers per mode
-    float mode_dampings_[4];           ///< Damping coefficients per mode
-    float mode_weights_[4];            ///< Audio weights per mode
+    // Mode parameters, rows indexed by MODE_PARAM_* (frequencies are
+    // multipliers, applied per voice relative to its pitch)
+    float mode_params_[MODE_PARAM_COUNT][MAX_MODES];         ///< Current values
+    float mode_param_targets_[MODE_PARAM_COUNT][MAX_MODES];  ///< Automation targets
+    float mode_param_steps_[MODE_PARAM_COUNT][MAX_MODES];    ///< Per-tick increments
+    uint32_t mode_ramp_ticks_;         ///< Ticks until every target is reached
 
     // Poke parameters (applied at note-on)
     float poke_strength_;              ///< Poke strength for excitation
     float poke_duration_ms_;           ///< Poke duration in milliseconds
 
+    // Stereo placement (applied at note-on, so sounding voices never jump)
+    float stereo_width_;               ///< Keyboard pan width (0 = mono)
+    float mode_spread_;                ///< Mode spread around the voice pan
+
+    // Oscillator bank renderer (allocated once in initialize())
+    VoiceBank bank_;                   ///< SoA render state for all voices
+    uint32_t max_block_size_;          ///< Largest block rendered in one pass
+
+    // Optional multi-threaded rendering
+    RenderWorkerPool* worker_pool_;    ///< Worker pool (nullptr = single-threaded)
+    uint32_t num_render_workers_;      ///< Requested worker threads
+    uint32_t parallel_min_voices_;     ///< Active voices needed to use the pool
+
+    // Voice stealing and CPU budget
+    StealPolicy steal_policy_;         ///< noteOn() stealing policy
+    float cpu_budget_;                 ///< Render load budget (0 = disabled)
+    float render_load_;                ///< Smoothed render time / block duration
+    uint32_t voice_cap_;               ///< Max sounding voices under the budget
+    uint32_t cap_settle_renders_;      ///< Renders left before the cap may drop again
+    bool cap_shed_pending_;            ///< Cap dropped; waiting for the fades to end
+    uint32_t steal_count_;             ///< Voices stolen by noteOn()
+    uint32_t shed_count_;              ///< Voices faded by shedVoices()
+    uint32_t seed_;                    ///< Last setSeed() value (for adopted idle voices)
+
     float sample_rate_;                ///< Current sample rate
     bool initialized_;                 ///< Initialization flag
 
     /**
-     * @brief Find free voice for allocation
-     * @return Pointer to free voice, or nullptr if none available
+     * @brief Pop a free voice and move it to the active list
+     * @return Voice index, or -1 if none available
+     */
+    int32_t findFreeVoice();
+
+    /**
+     * @brief Steal a voice by steal_policy_ (stays in the active list)
+     *
+     * The old note continues in a steal fade voice when one is idle.
+     *
+     * @return Voice index, or -1 if no voice is active
+     */
+    int32_t stealVoice();
+
+    /**
+     * @brief Pick a victim among active voices (steal fade voices excluded)
+     * @param policy Ordering among candidates
+     * @param released_first Prefer voices already in release
+     * @param skip_fading Ignore voices already fading out
+     * @return Voice index, or -1 if no candidate
+     */
+    int32_t selectVictim(StealPolicy policy, bool released_first, bool skip_fading) const;
+
+    /**
+     * @brief Count active voices that are awake and not fading out
+     */
+    uint32_t countSoundingVoices() const;
+
+    /**
+     * @brief Fade out voices over the CPU budget cap (control rate)
+     */
+    void shedVoices();
+
+    /**
+     * @brief Check if voices over the cap are still to shed or fading out
+     */
+    bool shedInProgress() const;
+
+    /**
+     * @brief Append voice to the active list
+     */
+    void activateVoice(uint16_t voice_idx);
+
+    /**
+     * @brief Voice pan for a note under stereo_width_
+     */
+    float notePan(uint8_t midi_note) const;
+
+    /**
+     * @brief Advance mode parameter ramps one tick and retune all voices
+     */
+    void advanceModeRamps();
+
+    /**
+     * @brief Pick step_kernel_ from voice 0's mode count and personality
+     */
+    void selectStepKernel();
+
+    /**
+     * @brief Whether adoptVoices() keeps voice a rather than voice b
      */
-    ModalVoice* findFreeVoice();
+    static bool keepBefore(const ModalVoice* a, const ModalVoice* b);
 
     /**
-     * @brief Steal oldest voice
-     * @return Pointer to stolen voice
+     * @brief Move voice from the active list back onto its free stack
+     * @param voice_idx Voice index (must be in the active list)
      */
-    ModalVoice* stealOldestVoice();
+    void releaseVoiceSlot(uint32_t voice_idx);
 };
 
 #endif // VOICE_ALLOCATOR_H
@@ -0,0 +1,484 @@
+/**
+ * @file VoiceBank.cpp
+ * @brief Structure-of-arrays oscillator bank implementation
+ *
+ * The kernel vectorizes across samples of one oscillator:
+ *   phase[n]  = acc + offset + n·inc               (wrapping uint32)
+ *   smooth[n] = target + (smooth₀ - target)·r^(n+1),  r = 1 - SMOOTH_ALPHA
+ *   out[n]   += min(smooth[n]·gain, MAX_AMPLITUDE_SCALE) · sin(phase[n])
+ * which is the closed form of the per-sample loop in audio_synth_render().
+ * Panned oscillators add out[n]·g_L and out[n]·g_R to the left/right
+ * buses instead, with g_L = √2·cos(θ), g_R = √2·sin(θ), θ = (pan + 1)·π/4.
+ * Routed through mode buses, a panned oscillator adds out[n] to its mode
+ * bus and out[n]·(g - 1) to each side, so mode buses + sides = stereo.
+ */
+
+#include "VoiceBank.h"
+#include "SimdTypes.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#ifdef USE_ACCELERATE
+#include <Accelerate/Accelerate.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#ifndef M_SQRT2
+#define M_SQRT2 1.41421356237309504880
+#endif
+
+// Smoothing residue below which the ramp is treated as settled
+#define SMOOTH_SETTLE_EPSILON 1e-9f
+
+// Output gain distance below which the glide snaps to its target
+#define OUTPUT_GAIN_SETTLE_EPSILON 1e-6f
+
+// Mix buffer bus layout (see VoiceBank::mixBufferSize)
+#define MIX_BUS_LEFT 1
+#define MIX_BUS_RIGHT 2
+#define MIX_BUS_MODE0 3
+
+/**
+ * @brief Mode pan offsets at full mode spread: fundamental centered,
+ *        partials alternating sides and widening with mode index
+ */
+static const float kModePanOffset[MAX_MODES] = {0.0f, -0.5f, 0.75f, -1.0f};
+
+VoiceBank::VoiceBank()
+    : max_voices_(0)
+    , max_block_size_(0)
+    , sample_rate_(48000.0f)
+    , amp_target_(nullptr)
+    , amp_smooth_(nullptr)
+    , gain_(nullptr)
+    , phase_(nullptr)
+    , phase_inc_(nullptr)
+    , phase_offset_(nullptr)
+    , pan_left_(nullptr)
+    , pan_right_(nullptr)
+    , panned_(nullptr)
+    , active_(nullptr)
+    , num_active_(0)
+    , has_panned_(false)
+    , mode_buses_(false)
+    , output_gain_(1.0f)
+    , output_gain_target_(1.0f)
+    , mix_stride_(0)
+    , mix_(nullptr)
+    , scratch_(nullptr)
+{
+}
+
+VoiceBank::~VoiceBank() {
+    release();
+}
+
+void VoiceBank::release() {
+    delete[] amp_target_;
+    delete[] amp_smooth_;
+    delete[] gain_;
+    delete[] phase_;
+    delete[] phase_inc_;
+    delete[] phase_offset_;
+    delete[] pan_left_;
+    delete[] pan_right_;
+    delete[] panned_;
+    delete[] active_;
+    vbuffer_free(mix_);
+    vbuffer_free(scratch_);
+
+    amp_target_ = amp_smooth_ = gain_ = nullptr;
+    phase_ = phase_inc_ = phase_offset_ = active_ = nullptr;
+    pan_left_ = pan_right_ = nullptr;
+    panned_ = nullptr;
+    mix_ = scratch_ = nullptr;
+    num_active_ = 0;
+    has_panned_ = false;
+}
+
+void VoiceBank::initialize(uint32_t max_voices, uint32_t max_block_size, float sample_rate) {
+    release();
+
+    max_voices_ = max_voices;
+    max_block_size_ = max_block_size;
+    sample_rate_ = sample_rate;
+
+    uint32_t num_osc = max_voices * MAX_MODES;
+    amp_target_ = new float[num_osc]();
+    amp_smooth_ = new float[num_osc]();
+    gain_ = new float[num_osc]();
+    phase_ = new uint32_t[num_osc]();
+    phase_inc_ = new uint32_t[num_osc]();
+    phase_offset_ = new uint32_t[num_osc]();
+    pan_left_ = new float[num_osc]();
+    pan_right_ = new float[num_osc]();
+    panned_ = new uint8_t[num_osc]();
+    active_ = new uint32_t[num_osc]();
+
+    // Padded to whole vectors so the kernel needs no scalar tail
+    mix_stride_ = vbuffer_frames(max_block_size);
+    mix_ = vbuffer_alloc(mixBufferSize(max_block_size));
+    scratch_ = vbuffer_alloc(scratchBufferSize(max_block_size));
+}
+
+void VoiceBank::prepare(ModalVoice* const* voices, const uint16_t* active_voices, uint32_t num_active) {
+    num_active_ = 0;
+    has_panned_ = false;
+    for (uint32_t n = 0; n < num_active; n++) {
+        uint32_t i = active_voices[n];
+        if (i >= max_voices_ || !voices[i]->isAwake()) continue;
+
+        const audio_synth_t* synth = voices[i]->getSynth();
+        if (synth->params.muted) continue;
+
+        // Same control-rate constants as the scalar renderer
+        audio_synth_block_t block;
+        audio_synth_prepare(synth, &block);
+
+        const float voice_pan = voices[i]->getPan();
+        const float mode_spread = voices[i]->getModeSpread();
+
+        for (int m = 0; m < block.num_modes; m++) {
+            int k = block.mode_index[m];
+            const audio_synth_mode_block_t* mode = &block.modes[k];
+            uint32_t osc = i * MAX_MODES + k;
+
+            amp_target_[osc] = mode->amp_target;
+            gain_[osc] = mode->gain;
+            phase_inc_[osc] = mode->phase_inc;
+            phase_offset_[osc] = mode->phase_offset;
+
+            float pan = voice_pan + mode_spread * kModePanOffset[k];
+            pan = std::min(std::max(pan, -1.0f), 1.0f);
+            if (pan == 0.0f) {
+                pan_left_[osc] = pan_right_[osc] = 1.0f;
+                panned_[osc] = 0;
+            } else {
+                float theta = (pan + 1.0f) * static_cast<float>(M_PI) * 0.25f;
+                pan_left_[osc] = static_cast<float>(M_SQRT2) * cosf(theta);
+                pan_right_[osc] = static_cast<float>(M_SQRT2) * sinf(theta);
+                panned_[osc] = 1;
+                has_panned_ = true;
+            }
+
+            active_[num_active_++] = osc;
+        }
+    }
+}
+
+void VoiceBank::render(float* outL, float* outR, uint32_t num_frames,
+                       float* const* mode_out, uint32_t num_mode_out, bool accumulate) {
+    if (num_frames > max_block_size_) num_frames = max_block_size_;
+
+    clearMix(mix_, num_frames);
+    renderRange(0, num_active_, mix_, scratch_, num_frames);
+    resolveMix(mix_, outL, outR, num_frames, mode_out, num_mode_out, accumulate);
+}
+
+void VoiceBank::renderRange(uint32_t first, uint32_t count, float* mix, float* scratch,
+                            uint32_t num_frames) {
+    if (num_frames > max_block_size_) num_frames = max_block_size_;
+    if (first > num_active_) first = num_active_;
+    if (count > num_active_ - first) count = num_active_ - first;
+
+    if (mode_buses_) {
+        for (uint32_t i = first; i < first + count; i++) {
+            uint32_t osc = active_[i];
+            if (panned_[osc]) {
+                renderOscillator<true, true>(osc, mix, scratch, num_frames);
+            } else {
+                renderOscillator<false, true>(osc, mix, scratch, num_frames);
+            }
+        }
+        return;
+    }
+
+    for (uint32_t i = first; i < first + count; i++) {
+        uint32_t osc = active_[i];
+        if (panned_[osc]) {
+            renderOscillator<true, false>(osc, mix, scratch, num_frames);
+        } else {
+            renderOscillator<false, false>(osc, mix, scratch, num_frames);
+        }
+    }
+}
+
+uint32_t VoiceBank::usedBuses(uint32_t* buses) const {
+    uint32_t count = 0;
+    if (!mode_buses_) buses[count++] = 0;
+    if (has_panned_) {
+        buses[count++] = MIX_BUS_LEFT;
+        buses[count++] = MIX_BUS_RIGHT;
+    }
+    if (mode_buses_) {
+        for (uint32_t k = 0; k < MAX_MODES; k++) buses[count++] = MIX_BUS_MODE0 + k;
+    }
+    return count;
+}
+
+void VoiceBank::clearMix(float* mix, uint32_t num_frames) const {
+    const size_t bytes = vbuffer_frames(num_frames) * sizeof(float);
+    uint32_t buses[MIX_BUS_MODE0 + MAX_MODES];
+    const uint32_t num_buses = usedBuses(buses);
+    for (uint32_t b = 0; b < num_buses; b++) {
+        memset(mix + buses[b] * mix_stride_, 0, bytes);
+    }
+}
+
+void VoiceBank::accumulateMix(float* dst, const float* src, uint32_t num_frames) const {
+    const uint32_t padded = vbuffer_frames(num_frames);
+    uint32_t buses[MIX_BUS_MODE0 + MAX_MODES];
+    const uint32_t num_buses = usedBuses(buses);
+    for (uint32_t b = 0; b < num_buses; b++) {
+        float* d = dst + buses[b] * mix_stride_;
+        const float* s = src + buses[b] * mix_stride_;
+        for (uint32_t n = 0; n < padded; n += SIMD_WIDTH) {
+            vstore(d + n, vload(d + n) + vload(s + n));
+        }
+    }
+}
+
+void VoiceBank::copyVoiceState(uint32_t dst_voice, const VoiceBank& src, uint32_t src_voice) {
+    if (dst_voice >= max_voices_ || src_voice >= src.max_voices_) return;
+
+    // Everything else is rebuilt from the voice by the next prepare()
+    uint32_t dst = dst_voice * MAX_MODES;
+    uint32_t from = src_voice * MAX_MODES;
+    for (uint32_t k = 0; k < MAX_MODES; k++) {
+        amp_smooth_[dst + k] = src.amp_smooth_[from + k];
+        phase_[dst + k] = src.phase_[from + k];
+    }
+}
+
+void VoiceBank::clearVoiceState(uint32_t voice) {
+    if (voice >= max_voices_) return;
+
+    uint32_t first = voice * MAX_MODES;
+    for (uint32_t k = 0; k < MAX_MODES; k++) {
+        amp_smooth_[first + k] = 0.0f;
+        phase_[first + k] = 0;
+    }
+}
+
+void VoiceBank::setOutputGain(float gain, bool smooth) {
+    output_gain_target_ = gain;
+    if (!smooth) output_gain_ = gain;
+}
+
+/**
+ * @brief Store or add one output sample
+ */
+template <bool Accumulate>
+static inline void emit(float* out, uint32_t n, float value) {
+    if (Accumulate) {
+        out[n] += value;
+    } else {
+        out[n] = value;
+    }
+}
+
+void VoiceBank::resolveMix(const float* mix, float* outL, float* outR, uint32_t num_frames,
+                           float* const* mode_out, uint32_t num_mode_out, bool accumulate) {
+    // Exponential glide sampled at block ends, linear within the block
+    const float start = output_gain_;
+    float end = output_gain_target_;
+    if (start != end && num_frames > 0) {
+        float decay = expf(-1000.0f * num_frames / (OUTPUT_GAIN_SMOOTH_MS * sample_rate_));
+        float next = end + (start - end) * decay;
+        if (fabsf(next - end) > OUTPUT_GAIN_SETTLE_EPSILON) end = next;
+    }
+    output_gain_ = end;
+
+    const float step = num_frames > 0 ? (end - start) / num_frames : 0.0f;
+    if (mode_buses_) {
+        if (accumulate) {
+            resolveModeBuses<true>(mix, outL, outR, num_frames, start, step, mode_out, num_mode_out);
+        } else {
+            resolveModeBuses<false>(mix, outL, outR, num_frames, start, step, mode_out, num_mode_out);
+        }
+    } else if (accumulate) {
+        resolveStereo<true>(mix, outL, outR, num_frames, start, step);
+    } else {
+        resolveStereo<false>(mix, outL, outR, num_frames, start, step);
+    }
+}
+
+template <bool Accumulate>
+void VoiceBank::resolveStereo(const float* mix, float* outL, float* outR, uint32_t num_frames,
+                              float start, float step) const {
+    const float* left = mix + MIX_BUS_LEFT * mix_stride_;
+    const float* right = mix + MIX_BUS_RIGHT * mix_stride_;
+
+    if (step == 0.0f) {
+        if (has_panned_) {
+            for (uint32_t n = 0; n < num_frames; n++) {
+                emit<Accumulate>(outL, n, (mix[n] + left[n]) * start);
+                emit<Accumulate>(outR, n, (mix[n] + right[n]) * start);
+            }
+        } else {
+            // Mono source, duplicated to L/R
+            for (uint32_t n = 0; n < num_frames; n++) {
+                float sample = mix[n] * start;
+                emit<Accumulate>(outL, n, sample);
+                emit<Accumulate>(outR, n, sample);
+            }
+        }
+        return;
+    }
+
+    if (has_panned_) {
+        for (uint32_t n = 0; n < num_frames; n++) {
+            float gain = start + step * (n + 1);
+            emit<Accumulate>(outL, n, (mix[n] + left[n]) * gain);
+            emit<Accumulate>(outR, n, (mix[n] + right[n]) * gain);
+        }
+    } else {
+        for (uint32_t n = 0; n < num_frames; n++) {
+            float sample = mix[n] * (start + step * (n + 1));
+            emit<Accumulate>(outL, n, sample);
+            emit<Accumulate>(outR, n, sample);
+        }
+    }
+}
+
+template <bool Accumulate>
+void VoiceBank::resolveModeBuses(const float* mix, float* outL, float* outR, uint32_t num_frames,
+                                 float start, float step,
+                                 float* const* mode_out, uint32_t num_mode_out) const {
+    const float* left = mix + MIX_BUS_LEFT * mix_stride_;
+    const float* right = mix + MIX_BUS_RIGHT * mix_stride_;
+    const float* bus[MAX_MODES];
+    for (uint32_t k = 0; k < MAX_MODES; k++) bus[k] = mix + (MIX_BUS_MODE0 + k) * mix_stride_;
+    if (num_mode_out > MAX_MODES) num_mode_out = MAX_MODES;
+
+    static_assert(MAX_MODES == 4, "stereo sum below adds four mode buses");
+    for (uint32_t n = 0; n < num_frames; n++) {
+        float gain = start + step * (n + 1);
+        float center = (bus[0][n] + bus[1][n]) + (bus[2][n] + bus[3][n]);
+        if (has_panned_) {
+            emit<Accumulate>(outL, n, (center + left[n]) * gain);
+            emit<Accumulate>(outR, n, (center + right[n]) * gain);
+        } else {
+            emit<Accumulate>(outL, n, center * gain);
+            emit<Accumulate>(outR, n, center * gain);
+        }
+    }
+    for (uint32_t k = 0; k < num_mode_out; k++) {
+        float* out = mode_out[k];
+        for (uint32_t n = 0; n < num_frames; n++) emit<Accumulate>(out, n, bus[k][n] * (start + step * (n + 1)));
+    }
+}
+
+template <bool Panned, bool ModeBus>
+void VoiceBank::renderOscillator(uint32_t osc, float* mix, float* scratch, uint32_t num_frames) {
+    float* bus_l = mix + MIX_BUS_LEFT * mix_stride_;
+    float* bus_r = mix + MIX_BUS_RIGHT * mix_stride_;
+    float* center = ModeBus ? mix + (MIX_BUS_MODE0 + osc % MAX_MODES) * mix_stride_ : mix;
+
+    // On mode buses the dry signal reaches both sides through the mode
+    // bus, so the side buses only carry the difference
+    const float side_offset = ModeBus ? 1.0f : 0.0f;
+    const float r = 1.0f - SMOOTH_ALPHA;
+    const float target = amp_target_[osc];
+    const float gain = gain_[osc];
+    const float delta = amp_smooth_[osc] - target;
+    const uint32_t inc = phase_inc_[osc];
+    const uint32_t start = phase_[osc] + phase_offset_[osc];
+    const uint32_t padded = vbuffer_frames(num_frames);
+
+    // Frames until the smoothing residue is negligible (and before r^n
+    // could decay into denormals); past that the amplitude is constant
+    uint32_t ramp_frames = 0;
+    if (fabsf(delta) * gain > SMOOTH_SETTLE_EPSILON) {
+        float settle = logf(SMOOTH_SETTLE_EPSILON / (fabsf(delta) * gain)) / logf(r);
+        ramp_frames = vbuffer_frames(static_cast<uint32_t>(settle) + 1);
+        if (ramp_frames > padded) ramp_frames = padded;
+    }
+
+    vuint phase = vsplat_u(start) + vlane_index() * inc;
+    const vuint phase_step = vsplat_u(inc * SIMD_WIDTH);
+
+    vfloat power;  // r^(n+1) per lane
+    power[0] = r;
+    for (int j = 1; j < SIMD_WIDTH; j++) power[j] = power[j - 1] * r;
+    const float power_step = power[SIMD_WIDTH - 1];
+
+    const vfloat max_amp = vsplat(MAX_AMPLITUDE_SCALE);
+    const vfloat steady = vmin(vsplat(target * gain), max_amp);
+
+#ifdef USE_ACCELERATE
+    // Accelerate: build amplitude and phase (radians) rows, then vvsinf + vDSP_vma
+    float* amp_row = scratch;
+    float* phase_row = scratch + padded;
+    const float to_radians = static_cast<float>(M_PI) / 2147483648.0f;
+
+    for (uint32_t n = 0; n < padded; n += SIMD_WIDTH) {
+        vfloat amp = steady;
+        if (n < ramp_frames) {
+            amp = vmin((vsplat(target) + power * delta) * gain, max_amp);
+            power *= power_step;
+        }
+        vstore(amp_row + n, amp);
+        vstore(phase_row + n, __builtin_convertvector((vint)phase, vfloat) * to_radians);
+        phase += phase_step;
+    }
+
+    int count = static_cast<int>(num_frames);
+    vvsinf(phase_row, phase_row, &count);
+    if (Panned) {
+        const float side_l = pan_left_[osc] - side_offset;
+        const float side_r = pan_right_[osc] - side_offset;
+        vDSP_vmul(phase_row, 1, amp_row, 1, phase_row, 1, num_frames);
+        vDSP_vsma(phase_row, 1, &side_l, bus_l, 1, bus_l, 1, num_frames);
+        vDSP_vsma(phase_row, 1, &side_r, bus_r, 1, bus_r, 1, num_frames);
+        if (ModeBus) vDSP_vadd(phase_row, 1, center, 1, center, 1, num_frames);
+    } else {
+        vDSP_vma(phase_row, 1, amp_row, 1, center, 1, center, 1, num_frames);
+    }
+#else
+    (void)scratch;  // Only the Accelerate path needs row scratch
+
+    uint32_t n = 0;
+    if (!Panned) {
+        for (; n < ramp_frames; n += SIMD_WIDTH) {
+            vfloat amp = vmin((vsplat(target) + power * delta) * gain, max_amp);
+            vstore(center + n, vload(center + n) + amp * vsin_phase(phase));
+            power *= power_step;
+            phase += phase_step;
+        }
+        for (; n < padded; n += SIMD_WIDTH) {
+            vstore(center + n, vload(center + n) + steady * vsin_phase(phase));
+            phase += phase_step;
+        }
+    } else {
+        // One sine per sample, added to both side buses
+        const vfloat gain_l = vsplat(pan_left_[osc] - side_offset);
+        const vfloat gain_r = vsplat(pan_right_[osc] - side_offset);
+        for (; n < ramp_frames; n += SIMD_WIDTH) {
+            vfloat amp = vmin((vsplat(target) + power * delta) * gain, max_amp);
+            vfloat sample = amp * vsin_phase(phase);
+            vstore(bus_l + n, vload(bus_l + n) + sample * gain_l);
+            vstore(bus_r + n, vload(bus_r + n) + sample * gain_r);
+            if (ModeBus) vstore(center + n, vload(center + n) + sample);
+            power *= power_step;
+            phase += phase_step;
+        }
+        for (; n < padded; n += SIMD_WIDTH) {
+            vfloat sample = steady * vsin_phase(phase);
+            vstore(bus_l + n, vload(bus_l + n) + sample * gain_l);
+            vstore(bus_r + n, vload(bus_r + n) + sample * gain_r);
+            if (ModeBus) vstore(center + n, vload(center + n) + sample);
+            phase += phase_step;
+        }
+    }
+#endif
+
+    // Carry state to the next block
+    float residue = (num_frames < ramp_frames) ? delta * powf(r, static_cast<float>(num_frames)) : 0.0f;
+    amp_smooth_[osc] = target + residue;
+    phase_[osc] += inc * num_frames;
+}
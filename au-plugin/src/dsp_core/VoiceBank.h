@@ -0,0 +1,276 @@
+/**
+ * @file VoiceBank.h
+ * @brief Structure-of-arrays oscillator bank for polyphonic rendering
+ *
+ * Replaces per-voice audio_synth_render() calls in the polyphonic path.
+ * Every (voice, mode) pair is one oscillator slot; its render state
+ * (target and smoothed amplitude, gain, phase accumulator, increment,
+ * phase offset) lives in contiguous arrays so the kernel can stream
+ * through all sounding oscillators with SIMD (see SimdTypes.h), or with
+ * Accelerate when built with ENABLE_SIMD on macOS.
+ *
+ * Oscillators at the center accumulate into one mono bus, which is
+ * copied to both outputs; panned oscillators (voice pan plus mode spread)
+ * are accumulated straight into left/right buses in the same pass, with
+ * constant-power gains normalized to unity at the center. With nothing
+ * panned the left/right buses are never touched, so the mono case costs
+ * what it did before stereo. The output gain (engine master gain) is
+ * applied, smoothed, while the buses are written to the outputs, so the
+ * output is only walked once.
+ *
+ * With mode buses enabled (setModeBuses), centered oscillators accumulate
+ * into one bus per mode index instead of the shared center bus, and
+ * panned ones add their dry signal there too, with their side gains
+ * offset by one; the stereo mix is then the sum of the mode buses plus
+ * the sides, and resolveMix() can write each mode bus to its own output
+ * in the same pass. Disabled, none of this is touched.
+ *
+ * Usage: prepare() once per control tick (reads modal state),
+ * then render() for the audio frames until the next tick.
+ */
+
+#ifndef VOICE_BANK_H
+#define VOICE_BANK_H
+
+#include "ModalVoice.h"
+#include "SimdTypes.h"
+#include <cstdint>
+
+/**
+ * @brief Output gain smoothing time constant (ms)
+ */
+#define OUTPUT_GAIN_SMOOTH_MS 5.0f
+
+class VoiceBank {
+public:
+    /**
+     * @brief Constructor
+     */
+    VoiceBank();
+
+    /**
+     * @brief Destructor
+     */
+    ~VoiceBank();
+
+    /**
+     * @brief Allocate oscillator state and scratch
+     * @param max_voices Number of voice slots
+     * @param max_block_size Largest block render() is called with
+     * @param sample_rate Sample rate in Hz
+     */
+    void initialize(uint32_t max_voices, uint32_t max_block_size, float sample_rate);
+
+    /**
+     * @brief Gather modal state of all active voices into the bank
+     *
+     * Voice i owns oscillator slots [i * MAX_MODES, (i + 1) * MAX_MODES).
+     * Voices not in the active list, dormant voices and inactive modes are
+     * left out of the render list, so their phase and smoothing state is
+     * held until they sound again.
+     *
+     * @param voices Voice pointer table
+     * @param active_voices Indices of active voices (each < max_voices)
+     * @param num_active Number of entries in active_voices
+     */
+    void prepare(ModalVoice* const* voices, const uint16_t* active_voices, uint32_t num_active);
+
+    /**
+     * @brief Route oscillators through per-mode buses (call before prepare)
+     * @param enabled True to keep mode buses for resolveMix()'s mode outputs
+     */
+    void setModeBuses(bool enabled) { mode_buses_ = enabled; }
+
+    /**
+     * @brief Check whether oscillators are routed through mode buses
+     */
+    bool hasModeBuses() const { return mode_buses_; }
+
+    /**
+     * @brief Render all prepared oscillators
+     * @param outL Left channel output
+     * @param outR Right channel output
+     * @param num_frames Number of frames (<= max_block_size)
+     * @param mode_out Mode bus outputs (mode k to mode_out[k]), or nullptr
+     * @param num_mode_out Entries in mode_out (<= MAX_MODES; 0 unless
+     *                     setModeBuses(true))
+     * @param accumulate Add into the outputs instead of overwriting them
+     */
+    void render(float* outL, float* outR, uint32_t num_frames,
+                float* const* mode_out = nullptr, uint32_t num_mode_out = 0,
+                bool accumulate = false);
+
+    /**
+     * @brief Render part of the render list, accumulating into a mix buffer
+     *
+     * Oscillators in disjoint ranges have disjoint state, so ranges may be
+     * rendered concurrently from different threads, each with its own
+     * mix and scratch buffer.
+     *
+     * @param first First render list entry
+     * @param count Number of entries
+     * @param mix Accumulation buffer cleared with clearMix() (SIMD aligned,
+     *            mixBufferSize(getMaxBlockSize()) floats)
+     * @param scratch Scratch buffer (SIMD aligned, see scratchBufferSize)
+     * @param num_frames Number of frames (<= max_block_size)
+     */
+    void renderRange(uint32_t first, uint32_t count, float* mix, float* scratch,
+                     uint32_t num_frames);
+
+    /**
+     * @brief Zero the buses of a mix buffer that this block uses
+     */
+    void clearMix(float* mix, uint32_t num_frames) const;
+
+    /**
+     * @brief Add mix buffer src into dst (both rendered this block)
+     */
+    void accumulateMix(float* dst, const float* src, uint32_t num_frames) const;
+
+    /**
+     * @brief Write a mix buffer's buses to the outputs with the output gain
+     *        (advances the gain ramp)
+     *
+     * Mode outputs (see render()) get the same gain as the stereo mix.
+     * With accumulate the outputs are added to, so a host can mix the
+     * engine into a buffer it already holds without clearing or copying.
+     */
+    void resolveMix(const float* mix, float* outL, float* outR, uint32_t num_frames,
+                    float* const* mode_out = nullptr, uint32_t num_mode_out = 0,
+                    bool accumulate = false);
+
+    /**
+     * @brief Set the gain resolveMix() applies
+     *
+     * Changes glide exponentially (OUTPUT_GAIN_SMOOTH_MS time constant),
+     * as a linear ramp within each block, so automation does not click.
+     *
+     * @param gain Output gain
+     * @param smooth False to jump to the new gain immediately
+     */
+    void setOutputGain(float gain, bool smooth = true);
+
+    /**
+     * @brief Get the gain currently applied (mid-ramp while smoothing)
+     */
+    float getOutputGain() const { return output_gain_; }
+
+    /**
+     * @brief Continue another bank's voice: copy its oscillators' phase and
+     *        smoothed amplitude into voice slot dst_voice
+     * @param dst_voice Voice slot in this bank
+     * @param src Bank the voice was rendered by (same sample rate)
+     * @param src_voice Voice slot in src
+     */
+    void copyVoiceState(uint32_t dst_voice, const VoiceBank& src, uint32_t src_voice);
+
+    /**
+     * @brief Start a voice slot from silence (phase 0, smoothed amplitude 0)
+     * @param voice Voice slot
+     */
+    void clearVoiceState(uint32_t voice);
+
+    /**
+     * @brief Take over another bank's output gain and any ramp in progress
+     */
+    void copyOutputGain(const VoiceBank& src) {
+        output_gain_ = src.output_gain_;
+        output_gain_target_ = src.output_gain_target_;
+    }
+
+    /**
+     * @brief Floats needed for a renderRange() mix buffer
+     *        (center, left, right, then MAX_MODES mode buses)
+     */
+    static uint32_t mixBufferSize(uint32_t max_block_size) {
+        return (3 + MAX_MODES) * vbuffer_frames(max_block_size);
+    }
+
+    /**
+     * @brief Floats needed for a renderRange() scratch buffer
+     */
+    static uint32_t scratchBufferSize(uint32_t max_block_size) {
+        return 2 * vbuffer_frames(max_block_size);
+    }
+
+    /**
+     * @brief Get largest block render() accepts
+     * @return Frames
+     */
+    uint32_t getMaxBlockSize() const { return max_block_size_; }
+
+    /**
+     * @brief Get number of oscillators in the current render list
+     * @return Active oscillator count
+     */
+    uint32_t getActiveOscillatorCount() const { return num_active_; }
+
+    /**
+     * @brief Check whether any prepared oscillator is off center
+     * @return True if the left/right buses are in use this block
+     */
+    bool hasPannedOscillators() const { return has_panned_; }
+
+private:
+    uint32_t max_voices_;           ///< Voice slots
+    uint32_t max_block_size_;       ///< Scratch capacity (frames)
+    float sample_rate_;             ///< Sample rate (Hz)
+
+    // Per-oscillator state [max_voices * MAX_MODES]
+    float* amp_target_;             ///< Weighted |a_k| target
+    float* amp_smooth_;             ///< One-pole smoothed amplitude
+    float* gain_;                   ///< Mode gain × master gain × headroom
+    uint32_t* phase_;               ///< Phase accumulator
+    uint32_t* phase_inc_;           ///< Phase increment per sample
+    uint32_t* phase_offset_;        ///< arg(a_k) as accumulator offset
+    float* pan_left_;               ///< Left bus gain (1 at center)
+    float* pan_right_;              ///< Right bus gain (1 at center)
+    uint8_t* panned_;               ///< Oscillator renders into left/right buses
+
+    uint32_t* active_;              ///< Render list (oscillator slots)
+    uint32_t num_active_;           ///< Entries in render list
+    bool has_panned_;               ///< Any entry has panned_ set
+    bool mode_buses_;               ///< Centered oscillators go to mode buses
+
+    float output_gain_;             ///< Gain at the end of the last block
+    float output_gain_target_;      ///< Gain being smoothed towards
+
+    uint32_t mix_stride_;           ///< Floats per bus in a mix buffer
+    float* mix_;                    ///< Mix scratch (SIMD aligned)
+    float* scratch_;                ///< Per-oscillator scratch (Accelerate)
+
+    /**
+     * @brief Render one oscillator, accumulating into the center bus or,
+     *        if Panned, the left/right buses of mix; with ModeBus, its mode
+     *        bus takes the place of the center bus
+     */
+    template <bool Panned, bool ModeBus>
+    void renderOscillator(uint32_t osc, float* mix, float* scratch, uint32_t num_frames);
+
+    /**
+     * @brief List the mix buffer buses in use this block
+     * @param buses Receives bus indices (at least 3 + MAX_MODES entries)
+     * @return Number of buses
+     */
+    uint32_t usedBuses(uint32_t* buses) const;
+
+    /**
+     * @brief resolveMix() without mode buses: center plus sides
+     */
+    template <bool Accumulate>
+    void resolveStereo(const float* mix, float* outL, float* outR, uint32_t num_frames,
+                       float start, float step) const;
+
+    /**
+     * @brief resolveMix() with mode buses: stereo from their sum plus the
+     *        sides, requested mode buses to mode_out
+     */
+    template <bool Accumulate>
+    void resolveModeBuses(const float* mix, float* outL, float* outR, uint32_t num_frames,
+                          float start, float step,
+                          float* const* mode_out, uint32_t num_mode_out) const;
+
+    void release();
+};
+
+#endif // VOICE_BANK_H
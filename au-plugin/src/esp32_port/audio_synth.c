@@ -10,6 +10,7 @@
  */
 
 #include "audio_synth.h"
+#include "sine_kernel.h"
 #include <math.h>
 #include <string.h>
 
@@ -21,30 +22,18 @@
 #define M_PI 3.14159265358979323846
 #endif
 
-#define SMOOTH_ALPHA 0.12f  // Smoothing factor (matches Python SMOOTH)
-#define MAX_AMPLITUDE_SCALE 0.7f  // Headroom (matches Python MAX_AMPLITUDE)
-
 // ============================================================================
 // Fast Math Helpers
 // ============================================================================
 
 /**
- * @brief Fast sine approximation using Taylor series
+ * @brief Fast sine via the wavetable kernel
  *
- * Accurate enough for audio (error < 0.1%)
- * Much faster than sinf() on ESP32, still useful on macOS
+ * Radians are wrapped into accumulator units (no normalization loop),
+ * then looked up in the interpolated sine table (error < 1e-5).
  */
 float fast_sin(float x) {
-    // Normalize to [-π, π]
-    while (x > M_PI) x -= 2.0f * M_PI;
-    while (x < -M_PI) x += 2.0f * M_PI;
-
-    // Taylor series: sin(x) ≈ x - x³/6 + x⁵/120
-    float x2 = x * x;
-    float x3 = x * x2;
-    float x5 = x3 * x2;
-
-    return x - (x3 / 6.0f) + (x5 / 120.0f);
+    return sine_from_phase(sine_phase_from_radians(x));
 }
 
 /**
@@ -65,6 +54,8 @@ void audio_synth_init(audio_synth_t* synth,
                      float sample_rate) {
     memset(synth, 0, sizeof(audio_synth_t));
 
+    sine_table_init();
+
     synth->node = node;
     synth->params.sample_rate = sample_rate;
     synth->params.master_gain = 1.0f;
@@ -88,6 +79,35 @@ void audio_synth_set_sample_rate(audio_synth_t* synth, float sample_rate) {
 // Audio Generation
 // ============================================================================
 
+void audio_synth_prepare(const audio_synth_t* synth, audio_synth_block_t* block) {
+    const modal_node_t* node = synth->node;
+    const float phase_scale = 4294967296.0f / (2.0f * (float)M_PI);
+    const float inc_scale = phase_scale / synth->params.sample_rate;
+
+    block->num_modes = 0;
+    for (int k = 0; k < MAX_MODES; k++) {
+        // Skip inactive modes
+        if (!node->modes[k].params.active) {
+            continue;
+        }
+
+        audio_synth_mode_block_t* mode = &block->modes[k];
+
+        // Mode amplitude (|a_k|) with mode weight
+        mode->amp_target = cabsf(node->modes[k].a) * node->modes[k].params.weight;
+        mode->gain = synth->params.mode_gains[k] *
+                     synth->params.master_gain *
+                     MAX_AMPLITUDE_SCALE;
+
+        // Phase from complex amplitude (arg(a_k) for phase coherence) and
+        // increment from omega[k], in accumulator units (wrap via 64-bit)
+        mode->phase_offset = (uint32_t)(int64_t)(cargf(node->modes[k].a) * phase_scale);
+        mode->phase_inc = (uint32_t)(int64_t)(node->modes[k].params.omega * inc_scale);
+
+        block->mode_index[block->num_modes++] = (uint8_t)k;
+    }
+}
+
 void audio_synth_render(audio_synth_t* synth,
                        float* outL,
                        float* outR,
@@ -106,71 +126,46 @@ void audio_synth_render(audio_synth_t* synth,
         return;
     }
 
-    const modal_node_t* node = synth->node;
-    const float sample_rate = synth->params.sample_rate;
-
-    // Generate stereo audio
-    // Mix all modes together for both channels
-    for (uint32_t sample_idx = 0; sample_idx < num_frames; sample_idx++) {
-        float sample_sum = 0.0f;
+    // Control-rate stage: sample modal state once for this block
+    audio_synth_block_t block;
+    audio_synth_prepare(synth, &block);
 
-        for (int k = 0; k < MAX_MODES; k++) {
-            // Skip inactive modes
-            if (!node->modes[k].params.active) {
-                continue;
-            }
+    // Audio-rate stage: ramp amplitudes and advance phases
+    memset(outL, 0, num_frames * sizeof(float));
 
-            // Get mode amplitude (|a_k|)
-            float amplitude_raw = cabsf(node->modes[k].a);
+    for (int m = 0; m < block.num_modes; m++) {
+        int k = block.mode_index[m];
+        const audio_synth_mode_block_t* mode = &block.modes[k];
 
-            // Apply mode weight
-            amplitude_raw *= node->modes[k].params.weight;
+        const float target = mode->amp_target;
+        const float gain = mode->gain;
+        const uint32_t inc = mode->phase_inc;
+        float smooth = synth->amplitude_smooth[k];
+        uint32_t phase_acc = synth->params.phase_accumulator[k] + mode->phase_offset;
 
+        for (uint32_t sample_idx = 0; sample_idx < num_frames; sample_idx++) {
             // Smooth amplitude to avoid clicks
-            synth->amplitude_smooth[k] +=
-                SMOOTH_ALPHA * (amplitude_raw - synth->amplitude_smooth[k]);
-
-            // Final amplitude with gains
-            float amplitude = synth->amplitude_smooth[k] *
-                            synth->params.mode_gains[k] *
-                            synth->params.master_gain *
-                            MAX_AMPLITUDE_SCALE;
+            smooth += SMOOTH_ALPHA * (target - smooth);
 
-            // Clip to safe range
+            // Final amplitude with gains, clipped to safe range
+            float amplitude = smooth * gain;
             if (amplitude > MAX_AMPLITUDE_SCALE) {
                 amplitude = MAX_AMPLITUDE_SCALE;
             }
 
-            // Get mode frequency (omega[k] in rad/s)
-            float omega = node->modes[k].params.omega;
-            float freq_hz = omega / (2.0f * M_PI);
+            outL[sample_idx] += amplitude * sine_from_phase(phase_acc);
 
-            // Phase increment (adapted for variable sample rate)
-            float phase_inc = 2.0f * M_PI * freq_hz / sample_rate;
-
-            // Get phase from accumulator
-            uint32_t phase_acc = synth->params.phase_accumulator[k];
-            float phase = (phase_acc / 4294967296.0f) * 2.0f * M_PI;
-
-            // Get phase from complex amplitude (use arg(a_k) for phase coherence)
-            float mode_phase = cargf(node->modes[k].a);
-            phase += mode_phase;
-
-            // Generate sample with fast sine
-            float sample_f = amplitude * fast_sin(phase);
-
-            // Add to mix
-            sample_sum += sample_f;
-
-            // Advance phase accumulator
-            phase_acc += (uint32_t)(phase_inc * 4294967296.0f / (2.0f * M_PI));
-            synth->params.phase_accumulator[k] = phase_acc;
+            phase_acc += inc;
         }
 
-        // Write to stereo output (mono source, duplicated to L/R)
-        outL[sample_idx] = sample_sum;
-        outR[sample_idx] = sample_sum;
+        // Release tails approach 0 geometrically; stop before denormals
+        if (fabsf(smooth) < MODAL_AMPLITUDE_FLOOR) smooth = 0.0f;
+        synth->amplitude_smooth[k] = smooth;
+        synth->params.phase_accumulator[k] += inc * num_frames;
     }
+
+    // Mono source, duplicated to L/R
+    memcpy(outR, outL, num_frames * sizeof(float));
 }
 
 // ============================================================================
@@ -31,6 +31,9 @@ extern "C" {
 #define NUM_AUDIO_CHANNELS 2      // Stereo output for AU
 #define BITS_PER_SAMPLE 32        // Float samples for AU
 
+#define SMOOTH_ALPHA 0.12f        // Amplitude smoothing factor (matches Python SMOOTH)
+#define MAX_AMPLITUDE_SCALE 0.7f  // Headroom (matches Python MAX_AMPLITUDE)
+
 // ============================================================================
 // Type Definitions
 // ============================================================================
@@ -46,6 +49,25 @@ typedef struct {
     bool muted;                           ///< Mute flag
 } audio_synth_params_t;
 
+/**
+ * @brief Per-mode render constants (valid for one control tick)
+ */
+typedef struct {
+    float amp_target;       ///< Smoothing target |a_k| × weight
+    float gain;             ///< Mode gain × master gain × headroom
+    uint32_t phase_offset;  ///< arg(a_k) in accumulator units
+    uint32_t phase_inc;     ///< Accumulator increment per sample
+} audio_synth_mode_block_t;
+
+/**
+ * @brief Render constants for all modes (output of audio_synth_prepare)
+ */
+typedef struct {
+    audio_synth_mode_block_t modes[MAX_MODES];
+    uint8_t mode_index[MAX_MODES];  ///< Active modes, in render order
+    uint8_t num_modes;              ///< Number of active modes
+} audio_synth_block_t;
+
 /**
  * @brief Audio synthesis state
  */
@@ -71,11 +93,24 @@ void audio_synth_init(audio_synth_t* synth,
                      const modal_node_t* node,
                      float sample_rate);
 
+/**
+ * @brief Compute per-mode render constants from current modal state
+ *
+ * Everything that only changes at control rate (|a_k|, arg(a_k), phase
+ * increment) is computed here once, so the per-sample loop only ramps
+ * amplitudes and advances phase accumulators.
+ *
+ * @param synth Pointer to synthesis state
+ * @param block Output render constants
+ */
+void audio_synth_prepare(const audio_synth_t* synth, audio_synth_block_t* block);
+
 /**
  * @brief Generate audio samples (stereo float)
  *
  * Reads current modal state and generates audio samples.
- * Called by AU render callback.
+ * Called by AU render callback. Modal state is sampled once at the start
+ * of the call (see audio_synth_prepare), so call once per control tick.
  *
  * @param synth Pointer to synthesis state
  * @param outL Left channel output buffer
@@ -134,7 +169,9 @@ void audio_synth_reset_phase(audio_synth_t* synth);
 /**
  * @brief Fast sine approximation
  *
- * Uses Taylor series for low-latency synthesis.
+ * Wraps any phase into accumulator units and uses the wavetable kernel
+ * (sine_kernel.h). Renderers index the kernel with their accumulators
+ * directly; this is for callers holding radians.
  *
  * @param phase Phase in radians
  * @return Sine value [-1, 1]
@@ -24,6 +24,8 @@
 #define MIDI_A4 69
 #define FREQ_A4 440.0f
 
+#define BANK_STEP_NODES 16  // Nodes packed per modal_bank_step() pass
+
 // ============================================================================
 // Utility Functions
 // ============================================================================
@@ -42,6 +44,36 @@ float random_phase(void) {
     return ((float)rand() / RAND_MAX) * 2.0f * M_PI;
 }
 
+// ============================================================================
+// Per-node Noise
+// ============================================================================
+
+/**
+ * @brief Advance xorshift32 state, return next value
+ */
+static inline uint32_t node_rand(modal_node_t* node) {
+    uint32_t x = node->rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    node->rng_state = x;
+    return x;
+}
+
+/**
+ * @brief Uniform float in [0, 1) from the node's generator
+ */
+static inline float node_rand_unit(modal_node_t* node) {
+    return (node_rand(node) >> 8) * (1.0f / 16777216.0f);
+}
+
+/**
+ * @brief Random phase in [0, 2π) from the node's generator
+ */
+static inline float node_random_phase(modal_node_t* node) {
+    return node_rand_unit(node) * 2.0f * M_PI;
+}
+
 // ============================================================================
 // Complex Math Helpers
 // ============================================================================
@@ -83,11 +115,12 @@ void modal_node_init(modal_node_t* node, uint8_t node_id, node_personality_t per
 
     node->node_id = node_id;
     node->personality = personality;
+    modal_node_seed(node, MODAL_DEFAULT_SEED);
 
     // Initialize all modes to small noise
     for (int k = 0; k < MAX_MODES; k++) {
-        float real = ((float)rand() / RAND_MAX - 0.5f) * 0.01f;
-        float imag = ((float)rand() / RAND_MAX - 0.5f) * 0.01f;
+        float real = (node_rand_unit(node) - 0.5f) * 0.01f;
+        float imag = (node_rand_unit(node) - 0.5f) * 0.01f;
         node->modes[k].a = real + I * imag;
         node->modes[k].a_dot = 0.0f;
         node->modes[k].params.active = false;
@@ -100,6 +133,17 @@ void modal_node_init(modal_node_t* node, uint8_t node_id, node_personality_t per
     node->step_count = 0;
 }
 
+void modal_node_seed(modal_node_t* node, uint32_t seed) {
+    // Mix seed and node id (murmur3 finalizer) so nearby seeds/ids decorrelate
+    uint32_t h = seed ^ (node->node_id * 0x9E3779B9u);
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    node->rng_state = h ? h : 0x6D2B79F5u;
+}
+
 void modal_node_set_mode(modal_node_t* node, uint8_t mode_idx,
                          float omega, float gamma, float weight) {
     if (mode_idx >= MAX_MODES) return;
@@ -109,6 +153,29 @@ void modal_node_set_mode(modal_node_t* node, uint8_t mode_idx,
     mode->params.gamma = gamma;
     mode->params.weight = weight;
     mode->params.active = true;
+
+    // Linear propagator, constant until omega/gamma change:
+    // exp((-γ+iω)·dt) = exp(-γ·dt)·exp(iω·dt), sharing the rotation
+    mode->rotation = cexp_i(omega * CONTROL_DT);
+    mode->propagator = expf(-gamma * CONTROL_DT) * mode->rotation;
+}
+
+void modal_node_set_frequencies(modal_node_t* node, const float omega[MAX_MODES]) {
+    // Constant trip count over planar arrays, so the transcendentals vectorize
+    float theta[MAX_MODES], decay[MAX_MODES], re[MAX_MODES], im[MAX_MODES];
+    for (int k = 0; k < MAX_MODES; k++) {
+        theta[k] = omega[k] * CONTROL_DT;
+        decay[k] = expf(-node->modes[k].params.gamma * CONTROL_DT);
+    }
+    for (int k = 0; k < MAX_MODES; k++) re[k] = cosf(theta[k]);
+    for (int k = 0; k < MAX_MODES; k++) im[k] = sinf(theta[k]);
+
+    for (int k = 0; k < MAX_MODES; k++) {
+        mode_state_t* mode = &node->modes[k];
+        mode->params.omega = omega[k];
+        mode->rotation = re[k] + I * im[k];
+        mode->propagator = decay[k] * re[k] + I * (decay[k] * im[k]);
+    }
 }
 
 void modal_node_set_neighbors(modal_node_t* node,
@@ -119,8 +186,30 @@ void modal_node_set_neighbors(modal_node_t* node,
 }
 
 void modal_node_step(modal_node_t* node) {
-    if (!node->running) return;
+    modal_bank_step(&node, 1);
+}
 
+/**
+ * @brief Packed mode state for one modal_bank_step() pass
+ */
+typedef struct {
+    float a_re[BANK_STEP_NODES * MAX_MODES];
+    float a_im[BANK_STEP_NODES * MAX_MODES];
+    float p_re[BANK_STEP_NODES * MAX_MODES];    ///< Propagator exp(λ·dt)
+    float p_im[BANK_STEP_NODES * MAX_MODES];
+    float u_re[BANK_STEP_NODES * MAX_MODES];    ///< Excitation u·dt
+    float u_im[BANK_STEP_NODES * MAX_MODES];
+    float floor_sq[BANK_STEP_NODES * MAX_MODES];  ///< Flush |a|² below this (0 = never)
+} bank_step_batch_t;
+
+/**
+ * @brief Advance excitation envelope and pack one node's modes
+ *
+ * Inactive modes get an identity propagator, so the packed pass can
+ * advance every slot unconditionally. Decaying modes get the amplitude
+ * floor; growing ones (a self-oscillator starting from rest) never flush.
+ */
+static void pack_node(modal_node_t* node, bank_step_batch_t* batch, uint32_t base) {
     // Update excitation envelope if active
     if (node->excitation.active) {
         node->excitation.elapsed_ms += CONTROL_DT * 1000.0f;
@@ -130,60 +219,113 @@ void modal_node_step(modal_node_t* node) {
         }
     }
 
-    // Integrate each mode
-    for (int k = 0; k < MAX_MODES; k++) {
-        if (!node->modes[k].params.active) continue;
+    // Envelope shape: Hann window
+    float envelope = 0.0f;
+    if (node->excitation.active) {
+        float t_norm = node->excitation.elapsed_ms / node->excitation.duration_ms;
+        envelope = 0.5f * (1.0f - cosf(M_PI * t_norm));
+    }
 
+    for (int k = 0; k < MAX_MODES; k++) {
         mode_state_t* mode = &node->modes[k];
+        uint32_t j = base + k;
+
+        float a_re = crealf(mode->a);
+        float a_im = cimagf(mode->a);
+        batch->a_re[j] = a_re;
+        batch->a_im[j] = a_im;
+
+        if (!mode->params.active) {
+            batch->p_re[j] = 1.0f;
+            batch->p_im[j] = 0.0f;
+            batch->u_re[j] = 0.0f;
+            batch->u_im[j] = 0.0f;
+            batch->floor_sq[j] = 0.0f;
+            continue;
+        }
+
         float omega = mode->params.omega;
         float gamma = mode->params.gamma;
 
         // Personality-specific dynamics
         float effective_gamma = gamma;
         if (node->personality == PERSONALITY_SELF_OSCILLATOR) {
-            // Self-oscillator: negative damping at low energy, positive at high
-            float energy = cabsf(mode->a);
-            float saturation_level = 1.0f;
-
-            // Van der Pol-like: γ_eff = -γ + β*|a|²
-            effective_gamma = -gamma + 3.0f * gamma * (energy * energy) / (saturation_level * saturation_level);
+            // Van der Pol-like: γ_eff = -γ + β*|a|² (saturation level 1)
+            float energy_sq = a_re * a_re + a_im * a_im;
+            effective_gamma = -gamma + 3.0f * gamma * energy_sq;
+
+            // exp((-γ_eff + iω)dt) = exp(-γ_eff·dt) · exp(iω·dt)
+            float decay = expf(-effective_gamma * CONTROL_DT);
+            batch->p_re[j] = decay * crealf(mode->rotation);
+            batch->p_im[j] = decay * cimagf(mode->rotation);
+        } else {
+            batch->p_re[j] = crealf(mode->propagator);
+            batch->p_im[j] = cimagf(mode->propagator);
         }
 
-        // Linear dynamics: ȧ = (-γ + iω)a
-        float complex linear_term = (-effective_gamma + I * omega) * mode->a;
-
         // Excitation term (if envelope active)
-        float complex excitation_term = 0.0f;
+        float u_re = 0.0f;
+        float u_im = 0.0f;
         if (node->excitation.active) {
-            // Envelope shape: Hann window
-            float t_norm = node->excitation.elapsed_ms / node->excitation.duration_ms;
-            float envelope = 0.5f * (1.0f - cosf(M_PI * t_norm));
-
             // Excitation with phase hint
             float phase = node->excitation.phase_hint;
             if (phase < 0.0f) {
-                phase = random_phase();
+                phase = node_random_phase(node);
             }
 
-            float strength = node->excitation.strength * mode->params.weight;
-            excitation_term = strength * envelope * cexp_i(phase);
+            float strength = node->excitation.strength * mode->params.weight * envelope;
+            u_re = strength * cosf(phase);
+            u_im = strength * sinf(phase);
         }
 
-        // Total derivative
-        mode->a_dot = linear_term + excitation_term;
+        // Total derivative: ȧ = (-γ + iω)a + u
+        mode->a_dot = (-effective_gamma * a_re - omega * a_im + u_re) +
+                      I * (omega * a_re - effective_gamma * a_im + u_im);
 
-        // Exact exponential integration for linear part (more stable than Euler)
-        // For ȧ = λa, exact solution over dt: a(t+dt) = a(t) * exp(λ*dt)
-        // We approximate: a_new ≈ a * exp(λ*dt) + excitation_contribution
+        batch->u_re[j] = u_re * CONTROL_DT;
+        batch->u_im[j] = u_im * CONTROL_DT;
+        batch->floor_sq[j] = (effective_gamma > 0.0f) ? MODAL_AMPLITUDE_FLOOR_SQ : 0.0f;
+    }
+}
 
-        float complex lambda = -effective_gamma + I * omega;
-        float complex exp_lambda_dt = cexpf(lambda * CONTROL_DT);
+void modal_bank_step(modal_node_t* const* nodes, uint32_t num_nodes) {
+    bank_step_batch_t batch;
+    modal_node_t* packed[BANK_STEP_NODES];
+
+    uint32_t i = 0;
+    while (i < num_nodes) {
+        // Pack up to BANK_STEP_NODES running nodes
+        uint32_t count = 0;
+        for (; i < num_nodes && count < BANK_STEP_NODES; i++) {
+            if (!nodes[i]->running) continue;
+            pack_node(nodes[i], &batch, count * MAX_MODES);
+            packed[count++] = nodes[i];
+        }
 
-        // Update: exact for linear + simple addition for excitation
-        mode->a = mode->a * exp_lambda_dt + excitation_term * CONTROL_DT;
-    }
+        // Exact exponential integration for the linear part plus simple
+        // addition for excitation: a(t+dt) = a(t)·exp(λ·dt) + u·dt.
+        // Decayed tails flush to exactly 0 instead of sinking into denormals.
+        const uint32_t num_modes = count * MAX_MODES;
+        for (uint32_t j = 0; j < num_modes; j++) {
+            float a_re = batch.a_re[j];
+            float a_im = batch.a_im[j];
+            float next_re = a_re * batch.p_re[j] - a_im * batch.p_im[j] + batch.u_re[j];
+            float next_im = a_re * batch.p_im[j] + a_im * batch.p_re[j] + batch.u_im[j];
+            bool flush = next_re * next_re + next_im * next_im < batch.floor_sq[j];
+            batch.a_re[j] = flush ? 0.0f : next_re;
+            batch.a_im[j] = flush ? 0.0f : next_im;
+        }
 
-    node->step_count++;
+        for (uint32_t n = 0; n < count; n++) {
+            modal_node_t* node = packed[n];
+            for (int k = 0; k < MAX_MODES; k++) {
+                if (!node->modes[k].params.active) continue;
+                uint32_t j = n * MAX_MODES + k;
+                node->modes[k].a = batch.a_re[j] + I * batch.a_im[j];
+            }
+            node->step_count++;
+        }
+    }
 }
 
 void modal_node_apply_poke(modal_node_t* node, const poke_event_t* poke) {
@@ -199,7 +341,7 @@ void modal_node_apply_poke(modal_node_t* node, const poke_event_t* poke) {
         if (!node->modes[k].params.active) continue;
 
         float weight = poke->mode_weights[k];
-        float phase = (poke->phase_hint < 0.0f) ? random_phase() : poke->phase_hint;
+        float phase = (poke->phase_hint < 0.0f) ? node_random_phase(node) : poke->phase_hint;
 
         // Small immediate kick
         float kick_strength = poke->strength * weight * 0.1f;
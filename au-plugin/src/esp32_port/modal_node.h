@@ -18,7 +18,9 @@
 #include <stdbool.h>
 
 // Complex number support - use C99 complex.h internally
+#ifndef __cplusplus
 #include <complex.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -43,6 +45,18 @@ typedef struct {
     float im;  ///< Imaginary part
 } modal_complexf_t;
 
+/**
+ * @brief Internal C99 complex float storage type
+ *
+ * C++ translation units cannot use the C99 `complex` macro, so they see the
+ * same storage through the `_Complex` keyword (supported by GCC and Clang).
+ */
+#ifdef __cplusplus
+typedef float _Complex modal_cfloat_t;
+#else
+typedef float complex modal_cfloat_t;
+#endif
+
 // ============================================================================
 // Constants
 // ============================================================================
@@ -51,6 +65,9 @@ typedef struct {
 #define MAX_NEIGHBORS 8
 #define CONTROL_RATE_HZ 500  // 500 Hz control rate (2ms timestep)
 #define CONTROL_DT (1.0f / CONTROL_RATE_HZ)
+#define MODAL_DEFAULT_SEED 0x4D4F4441u  // Seed used by modal_node_init()
+#define MODAL_AMPLITUDE_FLOOR 1e-12f    // Decaying modes below |a| flush to 0
+#define MODAL_AMPLITUDE_FLOOR_SQ (MODAL_AMPLITUDE_FLOOR * MODAL_AMPLITUDE_FLOOR)
 
 // ============================================================================
 // Type Definitions
@@ -78,9 +95,11 @@ typedef struct {
  * @brief Modal state (complex amplitude and dynamics)
  */
 typedef struct {
-    float complex a;        ///< Complex amplitude a(t) = |a|e^(iφ)
-    float complex a_dot;    ///< Time derivative (for integration)
-    mode_params_t params;   ///< Mode parameters
+    modal_cfloat_t a;           ///< Complex amplitude a(t) = |a|e^(iφ)
+    modal_cfloat_t a_dot;       ///< Time derivative (for integration)
+    modal_cfloat_t propagator;  ///< Cached exp((-γ+iω)·dt), set by modal_node_set_mode
+    modal_cfloat_t rotation;    ///< Cached exp(iω·dt) (self-oscillator phase advance)
+    mode_params_t params;       ///< Mode parameters
 } mode_state_t;
 
 /**
@@ -112,6 +131,7 @@ typedef struct {
     float audio_gain;                   ///< Master output gain [0,1]
 
     uint32_t step_count;                ///< Simulation step counter
+    uint32_t rng_state;                 ///< Per-node xorshift32 state (never 0)
     bool running;                       ///< Node running flag
 } modal_node_t;
 
@@ -138,9 +158,36 @@ typedef struct {
  */
 void modal_node_init(modal_node_t* node, uint8_t node_id, node_personality_t personality);
 
+/**
+ * @brief Seed the node's noise generator
+ *
+ * Initial mode noise, random poke phases and excitation phases all come
+ * from a per-node generator, so nodes share no hidden state and renders
+ * are reproducible. modal_node_init() seeds with MODAL_DEFAULT_SEED; the
+ * same seed gives every node_id a different stream.
+ *
+ * @param node Pointer to node structure
+ * @param seed Seed value (any value, including 0)
+ */
+void modal_node_seed(modal_node_t* node, uint32_t seed);
+
+/**
+ * @brief Retune all modes, keeping damping, weight and active flags
+ *
+ * Same propagators as modal_node_set_mode() with each mode's current
+ * gamma, computed for all modes together.
+ *
+ * @param node Pointer to node structure
+ * @param omega Angular frequency per mode (rad/s)
+ */
+void modal_node_set_frequencies(modal_node_t* node, const float omega[MAX_MODES]);
+
 /**
  * @brief Configure a single mode
  *
+ * Also refreshes the mode's cached propagator; omega/gamma must only be
+ * changed through this function.
+ *
  * @param node Pointer to node structure
  * @param mode_idx Mode index [0..MAX_MODES-1]
  * @param omega Angular frequency (rad/s)
@@ -171,6 +218,20 @@ void modal_node_set_neighbors(modal_node_t* node,
  */
 void modal_node_step(modal_node_t* node);
 
+/**
+ * @brief Simulate one timestep for several nodes (call at CONTROL_RATE_HZ)
+ *
+ * Same result as calling modal_node_step() on each node in order. Modes
+ * of all nodes are advanced together in one pass over packed arrays,
+ * using the propagators cached by modal_node_set_mode(); only
+ * self-oscillators, whose effective damping depends on |a|, recompute
+ * their decay each step.
+ *
+ * @param nodes Array of node pointers
+ * @param num_nodes Number of nodes
+ */
+void modal_bank_step(modal_node_t* const* nodes, uint32_t num_nodes);
+
 /**
  * @brief Apply poke excitation to node
  *
@@ -252,6 +313,8 @@ float freq_to_omega(float freq_hz);
 /**
  * @brief Generate random phase in [0, 2π)
  *
+ * Uses the C library rand(); the node core uses its own generator instead.
+ *
  * @return Random phase in radians
  */
 float random_phase(void);
@@ -0,0 +1,34 @@
+/**
+ * @file sine_kernel.c
+ * @brief Wavetable sine oscillator kernel
+ */
+
+#include "sine_kernel.h"
+#include <math.h>
+#include <stdbool.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+float sine_table[SINE_TABLE_SIZE + 1];
+int16_t sine_table_q15[SINE_TABLE_SIZE + 1];
+
+static bool sine_table_ready = false;
+
+void sine_table_init(void) {
+    if (sine_table_ready) return;
+
+    for (int i = 0; i < SINE_TABLE_SIZE; i++) {
+        sine_table[i] = (float)sin(2.0 * M_PI * i / SINE_TABLE_SIZE);
+    }
+
+    // Guard entry so interpolation at the last index needs no wrap
+    sine_table[SINE_TABLE_SIZE] = sine_table[0];
+
+    for (int i = 0; i <= SINE_TABLE_SIZE; i++) {
+        sine_table_q15[i] = (int16_t)lrintf(sine_table[i] * 32767.0f);
+    }
+
+    sine_table_ready = true;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file sine_kernel.h
+ * @brief Wavetable sine oscillator kernel driven by 32-bit phase accumulators
+ *
+ * The top SINE_TABLE_BITS of the accumulator index a one-cycle table and
+ * the remaining bits interpolate linearly between neighbouring entries,
+ * so a full cycle maps onto the uint32 range with no range-reduction
+ * loop and no float phase conversion. Peak error is ≈ 5e-6 (-106 dB).
+ *
+ * sine_q15_from_phase() reads a Q15 copy of the table with integer-only
+ * interpolation for the fixed-point renderer (error ≈ 1 LSB).
+ *
+ * Shared between the ESP32 firmware and the AU port (keep in sync).
+ */
+
+#ifndef SINE_KERNEL_H
+#define SINE_KERNEL_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SINE_TABLE_BITS 10
+#define SINE_TABLE_SIZE (1 << SINE_TABLE_BITS)
+#define SINE_FRAC_BITS (32 - SINE_TABLE_BITS)
+
+/**
+ * @brief One sine cycle plus guard entry (filled by sine_table_init)
+ */
+extern float sine_table[SINE_TABLE_SIZE + 1];
+
+/**
+ * @brief Q15 copy of sine_table (filled by sine_table_init)
+ */
+extern int16_t sine_table_q15[SINE_TABLE_SIZE + 1];
+
+/**
+ * @brief Fill the sine table (idempotent, call before rendering)
+ */
+void sine_table_init(void);
+
+/**
+ * @brief sin(2π · phase / 2³²)
+ *
+ * @param phase Phase accumulator value (full uint32 range = one cycle)
+ * @return Sine value [-1, 1]
+ */
+static inline float sine_from_phase(uint32_t phase) {
+    uint32_t idx = phase >> SINE_FRAC_BITS;
+    float frac = (float)(phase & ((1u << SINE_FRAC_BITS) - 1)) *
+                 (1.0f / (float)(1u << SINE_FRAC_BITS));
+    float a = sine_table[idx];
+    return a + (sine_table[idx + 1] - a) * frac;
+}
+
+/**
+ * @brief sin(2π · phase / 2³²) in Q15, integer arithmetic only
+ *
+ * Interpolates with the top 15 fraction bits so the product fits in
+ * 32 bits.
+ *
+ * @param phase Phase accumulator value (full uint32 range = one cycle)
+ * @return Sine value [-32767, 32767]
+ */
+static inline int32_t sine_q15_from_phase(uint32_t phase) {
+    uint32_t idx = phase >> SINE_FRAC_BITS;
+    int32_t frac = (int32_t)((phase >> (SINE_FRAC_BITS - 15)) & 0x7FFF);
+    int32_t a = sine_table_q15[idx];
+    return a + (((sine_table_q15[idx + 1] - a) * frac) >> 15);
+}
+
+/**
+ * @brief Convert radians to phase accumulator units (wraps, any range)
+ *
+ * @param radians Phase in radians
+ * @return Phase accumulator value
+ */
+static inline uint32_t sine_phase_from_radians(float radians) {
+    return (uint32_t)(int64_t)(radians * (2147483648.0f / 3.14159265358979f));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SINE_KERNEL_H
@@ -0,0 +1,253 @@
+/**
+ * @file AudioFileWriter.cpp
+ * @brief Double-buffered streaming WAV writer
+ */
+
+#include "AudioFileWriter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#define WAV_FORMAT_PCM 1
+#define WAV_FORMAT_IEEE_FLOAT 3
+#define WAV_PCM_HEADER_BYTES 44      // RIFF + fmt (16) + data
+#define WAV_FLOAT_HEADER_BYTES 58    // RIFF + fmt (18) + fact + data
+
+static void put16(unsigned char* p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+static void put32(unsigned char* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (v >> (8 * i)) & 0xFF;
+}
+
+static inline float clip(float x) {
+    return std::min(std::max(x, -1.0f), 1.0f);
+}
+
+AudioFileWriter::AudioFileWriter()
+    : file_(nullptr)
+    , sample_rate_(0)
+    , num_channels_(0)
+    , format_(AudioSampleFormat::Float32)
+    , bytes_per_sample_(0)
+    , chunk_frames_(0)
+    , frames_written_(0)
+    , failed_(false)
+    , fill_(nullptr)
+    , fill_frames_(0)
+    , thread_(nullptr)
+    , pending_(nullptr)
+    , pending_bytes_(0)
+    , stop_(false)
+{
+    buffers_[0] = nullptr;
+    buffers_[1] = nullptr;
+}
+
+AudioFileWriter::~AudioFileWriter() {
+    close();
+}
+
+bool AudioFileWriter::open(const char* path,
+                           uint32_t sample_rate,
+                           uint32_t num_channels,
+                           AudioSampleFormat format,
+                           bool background,
+                           uint32_t chunk_frames) {
+    close();
+    if (num_channels == 0 || num_channels > AUDIO_WRITER_MAX_CHANNELS || chunk_frames == 0) return false;
+
+    file_ = fopen(path, "wb");
+    if (!file_) return false;
+    setvbuf(file_, nullptr, _IONBF, 0);     // Chunks are already large
+
+    sample_rate_ = sample_rate;
+    num_channels_ = num_channels;
+    format_ = format;
+    bytes_per_sample_ = format == AudioSampleFormat::PCM16 ? 2 : format == AudioSampleFormat::PCM24 ? 3 : 4;
+    chunk_frames_ = chunk_frames;
+    frames_written_ = 0;
+    failed_ = false;
+
+    size_t chunk_bytes = static_cast<size_t>(chunk_frames) * num_channels * bytes_per_sample_;
+    buffers_[0] = new unsigned char[chunk_bytes];
+    buffers_[1] = new unsigned char[chunk_bytes];
+    fill_ = buffers_[0];
+    fill_frames_ = 0;
+
+    if (!writeHeader(0)) failed_ = true;
+
+    if (background) {
+        stop_ = false;
+        pending_ = nullptr;
+        thread_ = new std::thread(&AudioFileWriter::writerLoop, this);
+    }
+    return !failed_;
+}
+
+bool AudioFileWriter::write(const float* const* channels, uint32_t num_frames) {
+    if (!file_) return false;
+
+    uint32_t done = 0;
+    while (done < num_frames) {
+        uint32_t n = std::min(num_frames - done, chunk_frames_ - fill_frames_);
+        convert(channels, done, n);
+        fill_frames_ += n;
+        done += n;
+        if (fill_frames_ == chunk_frames_) submitChunk();
+    }
+
+    frames_written_ += num_frames;
+    return !failed_;
+}
+
+bool AudioFileWriter::writeStereo(const float* left, const float* right, uint32_t num_frames) {
+    if (num_channels_ != 2) return false;
+    const float* channels[2] = {left, right};
+    return write(channels, num_frames);
+}
+
+bool AudioFileWriter::close() {
+    if (!file_) return true;
+
+    if (fill_frames_ > 0) submitChunk();
+
+    if (thread_) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cond_.notify_all();
+        thread_->join();
+        delete thread_;
+        thread_ = nullptr;
+    }
+
+    // RIFF chunks are word aligned: pad an odd-sized data chunk
+    uint64_t data_bytes = frames_written_ * num_channels_ * bytes_per_sample_;
+    if (data_bytes & 1) {
+        unsigned char pad = 0;
+        if (fwrite(&pad, 1, 1, file_) != 1) failed_ = true;
+    }
+
+    if (fseek(file_, 0, SEEK_SET) != 0 || !writeHeader(data_bytes)) failed_ = true;
+    if (fclose(file_) != 0) failed_ = true;
+    file_ = nullptr;
+
+    delete[] buffers_[0];
+    delete[] buffers_[1];
+    buffers_[0] = nullptr;
+    buffers_[1] = nullptr;
+    fill_ = nullptr;
+
+    return !failed_;
+}
+
+void AudioFileWriter::convert(const float* const* channels, uint32_t offset, uint32_t num_frames) {
+    const uint32_t stride = num_channels_ * bytes_per_sample_;
+    unsigned char* out = fill_ + static_cast<size_t>(fill_frames_) * stride;
+
+    for (uint32_t c = 0; c < num_channels_; c++) {
+        const float* in = channels[c] + offset;
+        unsigned char* dst = out + c * bytes_per_sample_;
+
+        switch (format_) {
+            case AudioSampleFormat::PCM16:
+                for (uint32_t i = 0; i < num_frames; i++, dst += stride) {
+                    int32_t s = static_cast<int32_t>(lrintf(clip(in[i]) * 32767.0f));
+                    put16(dst, static_cast<uint32_t>(s));
+                }
+                break;
+
+            case AudioSampleFormat::PCM24:
+                for (uint32_t i = 0; i < num_frames; i++, dst += stride) {
+                    int32_t s = static_cast<int32_t>(lrintf(clip(in[i]) * 8388607.0f));
+                    dst[0] = s & 0xFF;
+                    dst[1] = (s >> 8) & 0xFF;
+                    dst[2] = (s >> 16) & 0xFF;
+                }
+                break;
+
+            case AudioSampleFormat::Float32:
+                for (uint32_t i = 0; i < num_frames; i++, dst += stride) {
+                    memcpy(dst, &in[i], sizeof(float));   // Little-endian hosts
+                }
+                break;
+        }
+    }
+}
+
+void AudioFileWriter::submitChunk() {
+    size_t bytes = static_cast<size_t>(fill_frames_) * num_channels_ * bytes_per_sample_;
+    fill_frames_ = 0;
+
+    if (!thread_) {
+        if (fwrite(fill_, 1, bytes, file_) != bytes) failed_ = true;
+        return;
+    }
+
+    // Hand fill_ to the writer once it has finished the previous chunk,
+    // then fill the other buffer
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this] { return pending_ == nullptr; });
+        pending_ = fill_;
+        pending_bytes_ = bytes;
+    }
+    cond_.notify_all();
+    fill_ = (fill_ == buffers_[0]) ? buffers_[1] : buffers_[0];
+}
+
+void AudioFileWriter::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cond_.wait(lock, [this] { return pending_ != nullptr || stop_; });
+        if (!pending_) break;   // Stopped with nothing left to write
+
+        unsigned char* chunk = pending_;
+        size_t bytes = pending_bytes_;
+        lock.unlock();
+        if (fwrite(chunk, 1, bytes, file_) != bytes) failed_ = true;
+        lock.lock();
+
+        pending_ = nullptr;
+        cond_.notify_all();
+    }
+}
+
+bool AudioFileWriter::writeHeader(uint64_t data_bytes) {
+    const bool is_float = format_ == AudioSampleFormat::Float32;
+    const uint32_t header_bytes = is_float ? WAV_FLOAT_HEADER_BYTES : WAV_PCM_HEADER_BYTES;
+    const uint32_t data_size = static_cast<uint32_t>(std::min<uint64_t>(data_bytes, 0xFFFFFFFEu - header_bytes));
+    const uint32_t block_align = num_channels_ * bytes_per_sample_;
+
+    unsigned char h[WAV_FLOAT_HEADER_BYTES];
+    unsigned char* p = h;
+
+    memcpy(p, "RIFF", 4);
+    put32(p + 4, header_bytes - 8 + data_size + (data_size & 1));
+    memcpy(p + 8, "WAVEfmt ", 8);
+    put32(p + 16, is_float ? 18 : 16);
+    put16(p + 20, is_float ? WAV_FORMAT_IEEE_FLOAT : WAV_FORMAT_PCM);
+    put16(p + 22, num_channels_);
+    put32(p + 24, sample_rate_);
+    put32(p + 28, sample_rate_ * block_align);
+    put16(p + 32, block_align);
+    put16(p + 34, bytes_per_sample_ * 8);
+    p += 36;
+
+    if (is_float) {
+        put16(p, 0);                        // cbSize
+        memcpy(p + 2, "fact", 4);
+        put32(p + 6, 4);
+        put32(p + 10, data_size / block_align);
+        p += 14;
+    }
+
+    memcpy(p, "data", 4);
+    put32(p + 4, data_size);
+
+    return fwrite(h, 1, header_bytes, file_) == header_bytes;
+}
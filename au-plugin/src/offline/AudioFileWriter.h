@@ -0,0 +1,139 @@
+/**
+ * @file AudioFileWriter.h
+ * @brief Streaming WAV writer with bounded memory
+ *
+ * Frames are converted and interleaved into one of two fixed chunk
+ * buffers; a full chunk is written to disk while the other one fills.
+ * With a background thread the disk write overlaps with rendering, and
+ * write() only waits if the disk falls a whole chunk behind. Memory is
+ * two chunks regardless of file length. The RIFF sizes are written as
+ * zero at open() and patched by close().
+ *
+ * Not real-time safe (file I/O and, in background mode, a mutex); a
+ * live recorder should feed it from a non-audio thread.
+ */
+
+#ifndef AUDIO_FILE_WRITER_H
+#define AUDIO_FILE_WRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief Default frames per chunk buffer
+ */
+#define AUDIO_WRITER_DEFAULT_CHUNK_FRAMES 16384
+
+/**
+ * @brief Maximum channels per file
+ */
+#define AUDIO_WRITER_MAX_CHANNELS 8
+
+/**
+ * @brief Sample encodings
+ */
+enum class AudioSampleFormat {
+    PCM16,       ///< 16-bit integer PCM
+    PCM24,       ///< 24-bit integer PCM (packed)
+    Float32      ///< 32-bit IEEE float
+};
+
+class AudioFileWriter {
+public:
+    AudioFileWriter();
+
+    /**
+     * @brief Destructor (closes the file if still open)
+     */
+    ~AudioFileWriter();
+
+    AudioFileWriter(const AudioFileWriter&) = delete;
+    AudioFileWriter& operator=(const AudioFileWriter&) = delete;
+
+    /**
+     * @brief Create a WAV file and allocate the chunk buffers
+     * @param path Output path
+     * @param sample_rate Sample rate in Hz
+     * @param num_channels Channels (1..AUDIO_WRITER_MAX_CHANNELS)
+     * @param format Sample encoding
+     * @param background Write chunks on a background thread
+     * @param chunk_frames Frames per chunk buffer
+     * @return True on success
+     */
+    bool open(const char* path,
+              uint32_t sample_rate,
+              uint32_t num_channels = 2,
+              AudioSampleFormat format = AudioSampleFormat::Float32,
+              bool background = false,
+              uint32_t chunk_frames = AUDIO_WRITER_DEFAULT_CHUNK_FRAMES);
+
+    /**
+     * @brief Append planar frames
+     *
+     * Samples are clipped to [-1, 1] for the integer formats.
+     *
+     * @param channels num_channels pointers to num_frames samples each
+     * @param num_frames Frames to append
+     * @return False once any write has failed (sticky)
+     */
+    bool write(const float* const* channels, uint32_t num_frames);
+
+    /**
+     * @brief Append stereo frames (num_channels must be 2)
+     */
+    bool writeStereo(const float* left, const float* right, uint32_t num_frames);
+
+    /**
+     * @brief Flush, patch the header and close
+     *
+     * Files over 4 GiB of audio keep the maximum RIFF sizes; readers that
+     * honor the file length still see every frame.
+     *
+     * @return True if every write and the header patch succeeded
+     */
+    bool close();
+
+    /**
+     * @brief Check whether a file is open
+     */
+    bool isOpen() const { return file_ != nullptr; }
+
+    /**
+     * @brief Get frames appended since open()
+     */
+    uint64_t getFramesWritten() const { return frames_written_; }
+
+private:
+    FILE* file_;
+    uint32_t sample_rate_;
+    uint32_t num_channels_;
+    AudioSampleFormat format_;
+    uint32_t bytes_per_sample_;
+    uint32_t chunk_frames_;
+    uint64_t frames_written_;
+    std::atomic<bool> failed_;          ///< Sticky I/O error (set by either thread)
+
+    // Double buffer: fill_ is converted into, the other is on its way to disk
+    unsigned char* buffers_[2];
+    unsigned char* fill_;               ///< Buffer being filled
+    uint32_t fill_frames_;              ///< Frames in fill_
+
+    // Background writer
+    std::thread* thread_;               ///< nullptr = write on the caller's thread
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    unsigned char* pending_;            ///< Chunk handed to the writer thread
+    size_t pending_bytes_;
+    bool stop_;
+
+    void writerLoop();
+    void submitChunk();
+    void convert(const float* const* channels, uint32_t offset, uint32_t num_frames);
+    bool writeHeader(uint64_t data_bytes);
+};
+
+#endif // AUDIO_FILE_WRITER_H
@@ -0,0 +1,277 @@
+/**
+ * @file Score.cpp
+ * @brief CSV and Standard MIDI File score loading
+ */
+
+#include "Score.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#define MIDI_DEFAULT_TEMPO_US 500000   // 120 BPM, until the first tempo event
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static bool fail(std::string* error, const std::string& message) {
+    if (error) *error = message;
+    return false;
+}
+
+static std::string trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(begin, end - begin + 1);
+}
+
+static std::vector<std::string> splitCsv(const std::string& line) {
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    std::string field;
+    while (std::getline(ss, field, ',')) fields.push_back(trim(field));
+    return fields;
+}
+
+/**
+ * @brief Big-endian reader over a byte buffer (bounds-checked)
+ */
+struct MidiReader {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+
+    bool has(size_t n) const { return pos + n <= size; }
+    uint8_t u8() { return data[pos++]; }
+    uint16_t u16() { uint16_t v = static_cast<uint16_t>(data[pos] << 8 | data[pos + 1]); pos += 2; return v; }
+    uint32_t u32() {
+        uint32_t v = static_cast<uint32_t>(data[pos]) << 24 | static_cast<uint32_t>(data[pos + 1]) << 16 |
+                     static_cast<uint32_t>(data[pos + 2]) << 8 | data[pos + 3];
+        pos += 4;
+        return v;
+    }
+
+    /**
+     * @brief Read a variable-length quantity (at most 4 bytes)
+     */
+    bool varlen(uint32_t* value) {
+        *value = 0;
+        for (int i = 0; i < 4; i++) {
+            if (!has(1)) return false;
+            uint8_t byte = u8();
+            *value = (*value << 7) | (byte & 0x7F);
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+};
+
+/**
+ * @brief Track event before tick → seconds conversion
+ */
+struct MidiRawEvent {
+    uint64_t tick;
+    uint32_t tempo_us;      ///< Tempo events only (0 otherwise)
+    uint8_t note;
+    uint8_t velocity;
+    bool is_tempo;
+    bool note_on;
+};
+
+static bool parseTrack(MidiReader& reader, size_t end, std::vector<MidiRawEvent>& events,
+                       std::string* error) {
+    uint64_t tick = 0;
+    uint8_t running_status = 0;
+
+    while (reader.pos < end) {
+        uint32_t delta;
+        if (!reader.varlen(&delta)) return fail(error, "truncated delta time");
+        tick += delta;
+
+        if (!reader.has(1)) return fail(error, "truncated event");
+        uint8_t status = reader.data[reader.pos];
+        if (status & 0x80) {
+            reader.pos++;
+        } else if (running_status) {
+            status = running_status;
+        } else {
+            return fail(error, "data byte without running status");
+        }
+
+        if (status == 0xFF) {
+            // Meta event: only tempo matters; end of track stops the track
+            if (!reader.has(1)) return fail(error, "truncated meta event");
+            uint8_t type = reader.u8();
+            uint32_t length;
+            if (!reader.varlen(&length) || reader.pos + length > end) return fail(error, "truncated meta event");
+            if (type == 0x51 && length == 3) {
+                uint32_t tempo = static_cast<uint32_t>(reader.data[reader.pos]) << 16 |
+                                 static_cast<uint32_t>(reader.data[reader.pos + 1]) << 8 |
+                                 reader.data[reader.pos + 2];
+                events.push_back({tick, tempo, 0, 0, true, false});
+            }
+            reader.pos += length;
+            if (type == 0x2F) break;
+            running_status = 0;
+        } else if (status == 0xF0 || status == 0xF7) {
+            // SysEx: skipped
+            uint32_t length;
+            if (!reader.varlen(&length) || reader.pos + length > end) return fail(error, "truncated sysex");
+            reader.pos += length;
+            running_status = 0;
+        } else {
+            uint8_t kind = status & 0xF0;
+            size_t data_bytes = (kind == 0xC0 || kind == 0xD0) ? 1 : 2;
+            if (reader.pos + data_bytes > end) return fail(error, "truncated channel event");
+            uint8_t d1 = reader.data[reader.pos] & 0x7F;
+            uint8_t d2 = data_bytes == 2 ? (reader.data[reader.pos + 1] & 0x7F) : 0;
+            reader.pos += data_bytes;
+            running_status = status;
+
+            if (kind == 0x90 && d2 > 0) {
+                events.push_back({tick, 0, d1, d2, false, true});
+            } else if (kind == 0x80 || kind == 0x90) {
+                events.push_back({tick, 0, d1, 0, false, false});
+            }
+        }
+    }
+
+    reader.pos = end;
+    return true;
+}
+
+// ============================================================================
+// Score
+// ============================================================================
+
+bool Score::loadFile(const char* path, std::string* error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return fail(error, std::string("cannot open ") + path);
+
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.size() >= 4 && data[0] == 'M' && data[1] == 'T' && data[2] == 'h' && data[3] == 'd') {
+        return loadMidi(data.data(), data.size(), error);
+    }
+
+    std::istringstream text(std::string(data.begin(), data.end()));
+    return loadCsv(text, error);
+}
+
+bool Score::loadCsv(std::istream& in, std::string* error) {
+    events_.clear();
+
+    std::string line;
+    if (!std::getline(in, line)) return fail(error, "empty score");
+
+    std::vector<std::string> header = splitCsv(line);
+    int col_t_on = -1, col_dur = -1, col_note = -1, col_velocity = -1;
+    for (size_t c = 0; c < header.size(); c++) {
+        if (header[c] == "t_on") col_t_on = static_cast<int>(c);
+        else if (header[c] == "dur") col_dur = static_cast<int>(c);
+        else if (header[c] == "note") col_note = static_cast<int>(c);
+        else if (header[c] == "velocity") col_velocity = static_cast<int>(c);
+    }
+    if (col_t_on < 0 || col_dur < 0 || col_note < 0) {
+        return fail(error, "CSV header needs t_on, dur and note columns");
+    }
+
+    int line_number = 1;
+    while (std::getline(in, line)) {
+        line_number++;
+        if (trim(line).empty()) continue;
+
+        std::vector<std::string> fields = splitCsv(line);
+        int needed = std::max(std::max(col_t_on, col_dur), std::max(col_note, col_velocity));
+        if (static_cast<int>(fields.size()) <= needed) {
+            return fail(error, "line " + std::to_string(line_number) + ": missing fields");
+        }
+
+        double t_on = atof(fields[col_t_on].c_str());
+        double dur = atof(fields[col_dur].c_str());
+        int note = atoi(fields[col_note].c_str());
+        double velocity = col_velocity >= 0 ? atof(fields[col_velocity].c_str()) : 1.0;
+
+        // Same filtering as ScorePlayer.from_csv
+        if (dur <= 0.0 || t_on < 0.0 || note < 0 || note > 127) continue;
+        velocity = std::min(std::max(velocity, 0.0), 1.0);
+        uint8_t midi_velocity = static_cast<uint8_t>(std::max(1.0, std::round(velocity * 127.0)));
+
+        events_.push_back({t_on, static_cast<uint8_t>(note), midi_velocity, true});
+        events_.push_back({t_on + dur, static_cast<uint8_t>(note), 0, false});
+    }
+
+    sortEvents();
+    return true;
+}
+
+bool Score::loadMidi(const uint8_t* data, size_t size, std::string* error) {
+    events_.clear();
+
+    MidiReader reader = {data, size, 0};
+    if (!reader.has(14) || reader.u32() != 0x4D546864 /* MThd */) return fail(error, "not a MIDI file");
+
+    uint32_t header_length = reader.u32();
+    if (header_length < 6 || !reader.has(header_length)) return fail(error, "truncated MIDI header");
+    uint16_t format = reader.u16();
+    uint16_t num_tracks = reader.u16();
+    uint16_t division = reader.u16();
+    reader.pos += header_length - 6;
+
+    if (format > 1) return fail(error, "MIDI format 2 is not supported");
+    if (division == 0) return fail(error, "invalid MIDI time division");
+
+    std::vector<MidiRawEvent> raw;
+    for (uint16_t t = 0; t < num_tracks && reader.has(8); t++) {
+        uint32_t chunk_id = reader.u32();
+        uint32_t chunk_length = reader.u32();
+        if (!reader.has(chunk_length)) return fail(error, "truncated MIDI track");
+
+        size_t end = reader.pos + chunk_length;
+        if (chunk_id != 0x4D54726B /* MTrk */) {
+            reader.pos = end;   // Unknown chunk
+            t--;
+            continue;
+        }
+        if (!parseTrack(reader, end, raw, error)) return false;
+    }
+
+    // Merge tracks by tick (stable: keeps each track's order at equal ticks)
+    std::stable_sort(raw.begin(), raw.end(), [](const MidiRawEvent& a, const MidiRawEvent& b) {
+        return a.tick < b.tick;
+    });
+
+    // Ticks → seconds through the tempo map (SMPTE division has a fixed rate)
+    bool smpte = (division & 0x8000) != 0;
+    double smpte_ticks_per_second = smpte
+        ? -static_cast<int8_t>(division >> 8) * static_cast<double>(division & 0xFF) : 0.0;
+    double seconds = 0.0;
+    uint64_t last_tick = 0;
+    uint32_t tempo_us = MIDI_DEFAULT_TEMPO_US;
+
+    for (const MidiRawEvent& event : raw) {
+        double ticks = static_cast<double>(event.tick - last_tick);
+        seconds += smpte ? ticks / smpte_ticks_per_second : ticks * tempo_us * 1e-6 / division;
+        last_tick = event.tick;
+
+        if (event.is_tempo) {
+            if (event.tempo_us > 0) tempo_us = event.tempo_us;
+        } else {
+            events_.push_back({seconds, event.note, event.velocity, event.note_on});
+        }
+    }
+
+    sortEvents();
+    return true;
+}
+
+void Score::sortEvents() {
+    // Note offs first at equal times, so a retriggered note is not cut
+    std::stable_sort(events_.begin(), events_.end(), [](const ScoreEvent& a, const ScoreEvent& b) {
+        if (a.time != b.time) return a.time < b.time;
+        return !a.note_on && b.note_on;
+    });
+}
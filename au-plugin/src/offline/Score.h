@@ -0,0 +1,76 @@
+/**
+ * @file Score.h
+ * @brief Note scores for offline rendering (CSV and Standard MIDI Files)
+ *
+ * Loads a score into a flat, time-sorted list of note on/off events in
+ * seconds. Two formats are understood:
+ * - CSV as used by the Python experiments (score.csv):
+ *   t_on,dur,node,note,velocity with velocity 0.0-1.0 (node is ignored;
+ *   the engine allocates voices itself)
+ * - Standard MIDI Files, format 0 or 1, all tracks and channels merged,
+ *   tempo changes honored
+ */
+
+#ifndef SCORE_H
+#define SCORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One note event
+ */
+struct ScoreEvent {
+    double time;            ///< Seconds from score start
+    uint8_t note;           ///< MIDI note number
+    uint8_t velocity;       ///< MIDI velocity (note on), 0 for note off
+    bool note_on;           ///< Note on (true) or note off (false)
+};
+
+class Score {
+public:
+    /**
+     * @brief Load a score file (MIDI if it starts with "MThd", else CSV)
+     * @param path File path
+     * @param error Receives a description on failure (may be nullptr)
+     * @return True on success
+     */
+    bool loadFile(const char* path, std::string* error);
+
+    /**
+     * @brief Parse CSV score text (header row required)
+     * @param in Input stream
+     * @param error Receives a description on failure (may be nullptr)
+     * @return True on success
+     */
+    bool loadCsv(std::istream& in, std::string* error);
+
+    /**
+     * @brief Parse a Standard MIDI File image
+     * @param data File contents
+     * @param size Bytes in data
+     * @param error Receives a description on failure (may be nullptr)
+     * @return True on success
+     */
+    bool loadMidi(const uint8_t* data, size_t size, std::string* error);
+
+    /**
+     * @brief Get events, sorted by time (note offs before note ons at equal times)
+     */
+    const std::vector<ScoreEvent>& getEvents() const { return events_; }
+
+    /**
+     * @brief Time of the last event in seconds (0 if empty)
+     */
+    double getDuration() const { return events_.empty() ? 0.0 : events_.back().time; }
+
+private:
+    std::vector<ScoreEvent> events_;
+
+    void sortEvents();
+};
+
+#endif // SCORE_H
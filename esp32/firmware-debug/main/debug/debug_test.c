@@ -297,7 +297,41 @@ bool debug_test_2_4_network_stats(debug_test_context_t* ctx) {
     // Log statistics
     debug_monitor_network_stats(ctx, 5000, 1000);
 
-    ESP_LOGI(TAG, "  ✓ PASSED: Network stats logged");
+    // Measure round trips to every peer
+    ESP_LOGI(TAG, "  Pinging %d peers (%d rounds, %d ms apart)...",
+             ctx->network->num_peers, DEBUG_PING_ROUNDS, DEBUG_PING_INTERVAL_MS);
+
+    for (int round = 0; round < DEBUG_PING_ROUNDS; round++) {
+        esp_now_ping_peers(ctx->network);
+        vTaskDelay(pdMS_TO_TICKS(DEBUG_PING_INTERVAL_MS));
+    }
+
+    int answering = 0;
+    for (int i = 0; i < ctx->network->num_peers; i++) {
+        uint8_t node_id = ctx->network->peers[i].node_id;
+        peer_rtt_t rtt;
+        if (!esp_now_get_peer_rtt(ctx->network, node_id, &rtt)) continue;
+
+        ESP_LOGI(TAG, "  Node %d: rtt p50=%uus p90=%uus p99=%uus last=%uus "
+                      "loss=%.1f%% (%u/%u echoed, %u late)",
+                 node_id,
+                 (unsigned)esp_now_rtt_percentile(&rtt, 50),
+                 (unsigned)esp_now_rtt_percentile(&rtt, 90),
+                 (unsigned)esp_now_rtt_percentile(&rtt, 99),
+                 (unsigned)rtt.last_rtt_us,
+                 esp_now_rtt_loss_rate(&rtt) * 100.0f,
+                 (unsigned)rtt.echoes, (unsigned)rtt.pings_sent,
+                 (unsigned)rtt.late_echoes);
+
+        if (rtt.echoes > 0) answering++;
+    }
+
+    if (answering == 0) {
+        ESP_LOGE(TAG, "  ✗ FAILED: No peer answered a ping");
+        return false;
+    }
+
+    ESP_LOGI(TAG, "  ✓ PASSED: %d peers measured", answering);
     return true;
 }
 
@@ -622,10 +656,12 @@ void debug_monitor_network_stats(debug_test_context_t* ctx,
 
     uint32_t elapsed = 0;
     while (elapsed < duration_ms) {
-        ESP_LOGI(TAG, "[NET STATS] Peers=%d TX=%d RX=%d",
+        uint32_t tx, rx, lost;
+        esp_now_get_stats(ctx->network, &tx, &rx, &lost);
+        ESP_LOGI(TAG, "[NET STATS] Peers=%d TX=%u RX=%u failed=%u latency=%.2fms",
                  ctx->network->num_peers,
-                 ctx->network->tx_count,
-                 ctx->network->rx_count);
+                 (unsigned)tx, (unsigned)rx, (unsigned)lost,
+                 esp_now_get_avg_latency(ctx->network));
 
         vTaskDelay(pdMS_TO_TICKS(interval_ms));
         elapsed += interval_ms;
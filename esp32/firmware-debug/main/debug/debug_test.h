@@ -37,6 +37,14 @@ extern "C" {
 #define DEBUG_AUTO_RUN_TESTS 1  // Auto-run tests on boot
 #endif
 
+#ifndef DEBUG_PING_ROUNDS
+#define DEBUG_PING_ROUNDS 50  // Test 2.4 pings per peer
+#endif
+
+#ifndef DEBUG_PING_INTERVAL_MS
+#define DEBUG_PING_INTERVAL_MS 100
+#endif
+
 #ifndef DEBUG_VERBOSE_LOGGING
 #define DEBUG_VERBOSE_LOGGING 1  // Enable verbose debug logs
 #endif
@@ -180,6 +188,9 @@ bool debug_test_2_3_bidirectional(debug_test_context_t* ctx, uint8_t target_node
 /**
  * @brief Test 2.4: Network statistics
  *
+ * Logs TX/RX counters, then pings every peer DEBUG_PING_ROUNDS times and
+ * reports RTT p50/p90/p99 and loss per peer. Passes if any peer echoed.
+ *
  * @param ctx Test context
  * @return true if passed
  */
@@ -30,6 +30,78 @@ static uint32_t g_tx_count = 0;
 static uint32_t g_rx_count = 0;
 static uint32_t g_tx_fail_count = 0;
 
+// ============================================================================
+// Peer Lookup
+// ============================================================================
+
+static peer_info_t* peer_by_id(esp_now_manager_t* mgr, uint8_t node_id) {
+    for (int i = 0; i < mgr->num_peers; i++) {
+        if (mgr->peers[i].node_id == node_id) return &mgr->peers[i];
+    }
+    return NULL;
+}
+
+// ============================================================================
+// Link Measurement
+// ============================================================================
+
+static void rtt_clear_slot(peer_rtt_t* rtt, uint8_t slot) {
+    uint8_t sample = rtt->samples[slot];
+    if (sample < RTT_HISTOGRAM_BINS) {
+        rtt->bins[sample]--;
+        rtt->echoed--;
+    } else if (sample == PING_SAMPLE_LOST) {
+        rtt->lost--;
+    }
+    rtt->samples[slot] = PING_SAMPLE_EMPTY;
+}
+
+/**
+ * @brief Answer a PING addressed to us (WiFi task)
+ */
+static void handle_ping(esp_now_manager_t* mgr, const msg_ping_t* ping) {
+    if (ping->header.dest_id != mgr->my_node_id && ping->header.dest_id != 0xFF) return;
+
+    network_message_t echo;
+    size_t len = protocol_create_echo(&echo, mgr->my_node_id, ping);
+    esp_now_send_message(mgr, ping->header.source_id, &echo, len);
+}
+
+/**
+ * @brief Record the ECHO of one of our PINGs (WiFi task)
+ */
+static void handle_echo(esp_now_manager_t* mgr, peer_info_t* peer, const msg_ping_t* echo) {
+    if (echo->header.dest_id != mgr->my_node_id) return;
+
+    int64_t rtt_us = esp_timer_get_time() - echo->sent_us;
+    if (rtt_us < 0) return;
+
+    uint32_t bin = (uint32_t)(rtt_us / RTT_BIN_US);
+    if (bin >= RTT_HISTOGRAM_BINS) bin = RTT_HISTOGRAM_BINS - 1;
+
+    peer_rtt_t* rtt = &peer->rtt;
+    uint8_t slot = echo->ping_seq % PING_WINDOW;
+
+    portENTER_CRITICAL(&mgr->rtt_lock);
+    if (echo->ping_seq == (uint16_t)(rtt->next_seq - 1) &&
+        rtt->samples[slot] == PING_SAMPLE_PENDING) {
+        rtt->samples[slot] = (uint8_t)bin;
+        rtt->bins[bin]++;
+        rtt->echoed++;
+        rtt->echoes++;
+        rtt->last_rtt_us = (uint32_t)rtt_us;
+
+        // One-way estimate, smoothed over ~8 echoes
+        float one_way_ms = (float)rtt_us / 2000.0f;
+        peer->latency_ms = (peer->latency_ms > 0.0f)
+                               ? peer->latency_ms + (one_way_ms - peer->latency_ms) / 8.0f
+                               : one_way_ms;
+    } else {
+        rtt->late_echoes++;
+    }
+    portEXIT_CRITICAL(&mgr->rtt_lock);
+}
+
 // ============================================================================
 // Static Callbacks
 // ============================================================================
@@ -46,15 +118,32 @@ static void esp_now_recv_cb(const esp_now_recv_info_t* recv_info, const uint8_t*
         return;
     }
 
+    // Trust the radio's source address over the payload's
+    if (msg.header.type == MSG_HELLO) {
+        memcpy(msg.hello.mac_address, recv_info->src_addr, 6);
+    }
+
     // Update peer statistics
+    peer_info_t* peer = NULL;
     for (int i = 0; i < g_manager->num_peers; i++) {
         if (mac_equal(g_manager->peers[i].mac_address, recv_info->src_addr)) {
-            g_manager->peers[i].packets_received++;
-            g_manager->peers[i].last_seen_ms = esp_timer_get_time() / 1000;
+            peer = &g_manager->peers[i];
+            peer->packets_received++;
+            peer->last_seen_ms = esp_timer_get_time() / 1000;
             break;
         }
     }
 
+    // Link measurement is handled here, below the application
+    if (msg.header.type == MSG_PING) {
+        handle_ping(g_manager, &msg.ping);
+        return;
+    }
+    if (msg.header.type == MSG_ECHO) {
+        if (peer) handle_echo(g_manager, peer, &msg.ping);
+        return;
+    }
+
     // Call user callback
     if (g_manager->on_message_received) {
         g_manager->on_message_received(&msg);
@@ -102,6 +191,7 @@ bool esp_now_manager_init(esp_now_manager_t* mgr, uint8_t my_node_id) {
 
     memset(mgr, 0, sizeof(esp_now_manager_t));
     mgr->my_node_id = my_node_id;
+    portMUX_INITIALIZE(&mgr->rtt_lock);
     g_manager = mgr;
 
     ESP_LOGI(TAG, "Initializing ESP-NOW for node %d", my_node_id);
@@ -295,6 +385,8 @@ bool esp_now_add_peer(esp_now_manager_t* mgr,
     peer->packets_received = 0;
     peer->packets_lost = 0;
     peer->latency_ms = 0.0f;
+    memset(&peer->rtt, 0, sizeof(peer->rtt));
+    memset(peer->rtt.samples, PING_SAMPLE_EMPTY, sizeof(peer->rtt.samples));
 
     mgr->num_peers++;
 
@@ -435,6 +527,83 @@ float esp_now_get_avg_latency(const esp_now_manager_t* mgr) {
     return (count > 0) ? (sum / count) : 0.0f;
 }
 
+bool esp_now_send_ping(esp_now_manager_t* mgr, uint8_t node_id) {
+    if (!mgr || !mgr->initialized) return false;
+
+    peer_info_t* peer = peer_by_id(mgr, node_id);
+    if (!peer || !peer->active) return false;
+
+    peer_rtt_t* rtt = &peer->rtt;
+
+    portENTER_CRITICAL(&mgr->rtt_lock);
+    uint16_t seq = rtt->next_seq++;
+
+    // The previous ping had its chance
+    uint8_t prev = (uint16_t)(seq - 1) % PING_WINDOW;
+    if (rtt->samples[prev] == PING_SAMPLE_PENDING) {
+        rtt->samples[prev] = PING_SAMPLE_LOST;
+        rtt->lost++;
+    }
+
+    uint8_t slot = seq % PING_WINDOW;
+    rtt_clear_slot(rtt, slot);
+    rtt->samples[slot] = PING_SAMPLE_PENDING;
+    rtt->pings_sent++;
+    portEXIT_CRITICAL(&mgr->rtt_lock);
+
+    network_message_t ping;
+    size_t len = protocol_create_ping(&ping, mgr->my_node_id, node_id, seq);
+    return esp_now_send_message(mgr, node_id, &ping, len);
+}
+
+uint8_t esp_now_ping_peers(esp_now_manager_t* mgr) {
+    if (!mgr) return 0;
+
+    uint8_t sent = 0;
+    for (int i = 0; i < mgr->num_peers; i++) {
+        if (mgr->peers[i].active && esp_now_send_ping(mgr, mgr->peers[i].node_id)) {
+            sent++;
+        }
+    }
+
+    return sent;
+}
+
+bool esp_now_get_peer_rtt(esp_now_manager_t* mgr, uint8_t node_id, peer_rtt_t* rtt) {
+    if (!mgr || !rtt) return false;
+
+    peer_info_t* peer = peer_by_id(mgr, node_id);
+    if (!peer) return false;
+
+    portENTER_CRITICAL(&mgr->rtt_lock);
+    *rtt = peer->rtt;
+    portEXIT_CRITICAL(&mgr->rtt_lock);
+    return true;
+}
+
+uint32_t esp_now_rtt_percentile(const peer_rtt_t* rtt, uint8_t percentile) {
+    if (!rtt || rtt->echoed == 0) return 0;
+
+    // Smallest bin with at least percentile% of the echoes at or below it
+    uint32_t target = ((uint32_t)rtt->echoed * percentile + 99) / 100;
+    if (target == 0) target = 1;
+
+    uint32_t count = 0;
+    for (uint32_t bin = 0; bin < RTT_HISTOGRAM_BINS; bin++) {
+        count += rtt->bins[bin];
+        if (count >= target) return (bin + 1) * RTT_BIN_US;
+    }
+
+    return RTT_HISTOGRAM_BINS * RTT_BIN_US;
+}
+
+float esp_now_rtt_loss_rate(const peer_rtt_t* rtt) {
+    if (!rtt) return 0.0f;
+
+    uint32_t settled = rtt->echoed + rtt->lost;
+    return (settled > 0) ? (float)rtt->lost / (float)settled : 0.0f;
+}
+
 uint8_t esp_now_check_stale_peers(esp_now_manager_t* mgr, uint32_t timeout_ms) {
     if (!mgr) return 0;
 
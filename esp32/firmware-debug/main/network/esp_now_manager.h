@@ -6,7 +6,7 @@
  * - Auto-discovery via broadcast
  * - Peer management (up to 20 peers)
  * - Message routing
- * - Latency monitoring
+ * - Latency monitoring (PING/ECHO round trips, per-peer RTT histogram)
  * - Packet loss detection
  *
  * Design:
@@ -20,6 +20,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "freertos/FreeRTOS.h"
 #include "esp_now.h"
 #include "protocol.h"
 
@@ -35,10 +36,37 @@ extern "C" {
 #define BROADCAST_MAC {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}
 #define MAX_SEND_RETRIES 3
 
+// Link measurement (PING/ECHO)
+#define PING_WINDOW 64             // Recent pings per peer in RTT and loss stats
+#define RTT_HISTOGRAM_BINS 24
+#define RTT_BIN_US 500             // Bin width; the last bin is open-ended (≥ 11.5 ms)
+
+#define PING_SAMPLE_EMPTY 0xFF     // Window slot not used yet
+#define PING_SAMPLE_PENDING 0xFE   // Waiting for the echo
+#define PING_SAMPLE_LOST 0xFD      // No echo before the next ping
+
 // ============================================================================
 // Type Definitions
 // ============================================================================
 
+/**
+ * @brief Rolling RTT and loss over a peer's last PING_WINDOW pings
+ *
+ * One ping is outstanding at a time: sending the next one counts an
+ * unanswered ping as lost.
+ */
+typedef struct {
+    uint8_t samples[PING_WINDOW];      ///< Histogram bin per ping, or PING_SAMPLE_*
+    uint8_t bins[RTT_HISTOGRAM_BINS];  ///< RTT histogram of the window's echoes
+    uint8_t echoed;                    ///< Echoed pings in the window
+    uint8_t lost;                      ///< Lost pings in the window
+    uint16_t next_seq;                 ///< Sequence of the next ping
+    uint32_t pings_sent;               ///< Since boot
+    uint32_t echoes;                   ///< Since boot
+    uint32_t late_echoes;              ///< Echoes for pings already counted lost
+    uint32_t last_rtt_us;              ///< Most recent RTT
+} peer_rtt_t;
+
 /**
  * @brief Peer information
  */
@@ -50,7 +78,8 @@ typedef struct {
     uint32_t packets_sent;      ///< TX packet count
     uint32_t packets_received;  ///< RX packet count
     uint32_t packets_lost;      ///< Lost packet count
-    float latency_ms;           ///< Estimated latency
+    float latency_ms;           ///< One-way latency estimate (smoothed RTT / 2)
+    peer_rtt_t rtt;             ///< PING/ECHO statistics (guarded by rtt_lock)
 } peer_info_t;
 
 /**
@@ -66,6 +95,8 @@ typedef struct {
 
     uint16_t tx_sequence;       ///< TX sequence counter
 
+    portMUX_TYPE rtt_lock;      ///< Guards peers[].rtt (pinger task vs. WiFi task)
+
     // Callbacks
     void (*on_message_received)(const network_message_t* msg);
     void (*on_peer_discovered)(uint8_t node_id, const uint8_t* mac);
@@ -245,6 +276,60 @@ void esp_now_get_stats(const esp_now_manager_t* mgr,
  */
 float esp_now_get_avg_latency(const esp_now_manager_t* mgr);
 
+/**
+ * @brief Send a PING to one peer
+ *
+ * The peer's manager answers with an ECHO (no application code
+ * involved); its arrival updates the peer's RTT histogram and
+ * latency_ms. An earlier ping still unanswered is counted lost.
+ *
+ * @param mgr Pointer to manager structure
+ * @param node_id Peer to measure
+ * @return true if queued
+ */
+bool esp_now_send_ping(esp_now_manager_t* mgr, uint8_t node_id);
+
+/**
+ * @brief PING every active peer
+ *
+ * Call at a fixed interval longer than the worst expected RTT (the hub
+ * uses its heartbeat interval).
+ *
+ * @param mgr Pointer to manager structure
+ * @return Number of pings queued
+ */
+uint8_t esp_now_ping_peers(esp_now_manager_t* mgr);
+
+/**
+ * @brief Copy a peer's RTT statistics
+ *
+ * @param mgr Pointer to manager structure
+ * @param node_id Peer
+ * @param rtt Output statistics
+ * @return true if the peer exists
+ */
+bool esp_now_get_peer_rtt(esp_now_manager_t* mgr, uint8_t node_id, peer_rtt_t* rtt);
+
+/**
+ * @brief RTT percentile over the ping window
+ *
+ * Resolution is RTT_BIN_US; the upper edge of the bin is returned, so
+ * the value is never below the true percentile.
+ *
+ * @param rtt Statistics (from esp_now_get_peer_rtt)
+ * @param percentile 1-100
+ * @return RTT in µs, or 0 if no echoes in the window
+ */
+uint32_t esp_now_rtt_percentile(const peer_rtt_t* rtt, uint8_t percentile);
+
+/**
+ * @brief Fraction of answered-or-lost pings in the window that were lost
+ *
+ * @param rtt Statistics (from esp_now_get_peer_rtt)
+ * @return Loss rate (0-1)
+ */
+float esp_now_rtt_loss_rate(const peer_rtt_t* rtt);
+
 /**
  * @brief Check for stale peers (no recent activity)
  *
@@ -116,6 +116,31 @@ size_t protocol_create_heartbeat(network_message_t* msg,
     return sizeof(msg_heartbeat_t);
 }
 
+size_t protocol_create_ping(network_message_t* msg,
+                            uint8_t source_id,
+                            uint8_t dest_id,
+                            uint16_t ping_seq) {
+    memset(msg, 0, sizeof(network_message_t));
+
+    protocol_init_header(&msg->ping.header, MSG_PING, source_id, dest_id);
+    msg->ping.ping_seq = ping_seq;
+    msg->ping.sent_us = esp_timer_get_time();
+
+    return sizeof(msg_ping_t);
+}
+
+size_t protocol_create_echo(network_message_t* msg,
+                            uint8_t source_id,
+                            const msg_ping_t* ping) {
+    memset(msg, 0, sizeof(network_message_t));
+
+    protocol_init_header(&msg->ping.header, MSG_ECHO, source_id, ping->header.source_id);
+    msg->ping.ping_seq = ping->ping_seq;
+    msg->ping.sent_us = ping->sent_us;
+
+    return sizeof(msg_ping_t);
+}
+
 // ============================================================================
 // Configuration Message Creators
 // ============================================================================
@@ -278,6 +303,12 @@ bool protocol_parse_message(const uint8_t* data,
             memcpy(&msg->heartbeat, data, sizeof(msg_heartbeat_t));
             break;
 
+        case MSG_PING:
+        case MSG_ECHO:
+            if (len < sizeof(msg_ping_t)) return false;
+            memcpy(&msg->ping, data, sizeof(msg_ping_t));
+            break;
+
         default:
             // Unknown message type
             return false;
@@ -12,6 +12,7 @@
  * - Discovery: HELLO, OFFER, JOIN
  * - Configuration: CFG_BEGIN, CFG_CHUNK, CFG_END, CFG_ACK
  * - Runtime: POKE, START, STOP
+ * - Link measurement: PING, ECHO (answered by esp_now_manager)
  */
 
 #ifndef PROTOCOL_H
@@ -58,6 +59,8 @@ typedef enum {
     MSG_POKE = 0x30,        ///< Excitation event
     MSG_STATE = 0x31,       ///< State broadcast (optional)
     MSG_HEARTBEAT = 0x32,   ///< Keep-alive
+    MSG_PING = 0x36,        ///< RTT probe (hub → node)
+    MSG_ECHO = 0x37,        ///< PING returned unchanged (node → hub)
 
     // Debug/monitoring
     MSG_DEBUG = 0xF0,       ///< Debug message
@@ -189,6 +192,18 @@ typedef struct __attribute__((packed)) {
     uint8_t cpu_usage;      ///< CPU usage %
 } msg_heartbeat_t;
 
+/**
+ * @brief PING / ECHO message (link RTT and loss)
+ *
+ * The receiver returns the PING as an ECHO with the same ping_seq and
+ * sent_us; the sender's RTT is its clock at reception minus sent_us.
+ */
+typedef struct __attribute__((packed)) {
+    message_header_t header;
+    uint16_t ping_seq;      ///< Per-peer ping sequence
+    int64_t sent_us;        ///< Pinger's esp_timer clock at send
+} msg_ping_t;
+
 /**
  * @brief Generic message union
  */
@@ -206,6 +221,7 @@ typedef union {
     msg_poke_t poke;
     msg_state_t state;
     msg_heartbeat_t heartbeat;
+    msg_ping_t ping;
     uint8_t raw[MAX_PACKET_SIZE];
 } network_message_t;
 
@@ -291,6 +307,32 @@ size_t protocol_create_heartbeat(network_message_t* msg,
                                  uint32_t uptime_ms,
                                  uint8_t cpu_usage);
 
+/**
+ * @brief Create PING message (stamped with esp_timer_get_time())
+ *
+ * @param msg Pointer to message buffer
+ * @param source_id Source node ID
+ * @param dest_id Node to measure
+ * @param ping_seq Per-peer ping sequence
+ * @return Message size (bytes)
+ */
+size_t protocol_create_ping(network_message_t* msg,
+                            uint8_t source_id,
+                            uint8_t dest_id,
+                            uint16_t ping_seq);
+
+/**
+ * @brief Create the ECHO answering a PING
+ *
+ * @param msg Pointer to message buffer
+ * @param source_id Source node ID (the echoing node)
+ * @param ping PING being answered
+ * @return Message size (bytes)
+ */
+size_t protocol_create_echo(network_message_t* msg,
+                            uint8_t source_id,
+                            const msg_ping_t* ping);
+
 /**
  * @brief Create OFFER message
  *
@@ -8,6 +8,13 @@
  * - 4-channel output (quad/TDM mode)
  * - DMA buffers for low-latency
  *
+ * Pipeline: audio_task renders into two ping-pong buffers; an I2S output
+ * task on the same core writes each filled buffer to the driver, blocking
+ * until DMA frees a descriptor. Synthesis of buffer n+1 therefore overlaps
+ * the DMA transfer of buffer n. Underruns are counted from the driver's
+ * TX queue overflow events (the DMA sent every descriptor and found none
+ * refilled), rather than only being hidden by tx_desc_auto_clear.
+ *
  * Channel mapping:
  * - Channel 0: Mode 0 output
  * - Channel 1: Mode 1 output
@@ -26,8 +33,10 @@
 #include "driver/i2s.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 
 // ============================================================================
 // Configuration
@@ -43,11 +52,33 @@
 #define I2S_WS_PIN      26  // Word select (LRCK)
 #define I2S_DATA_PIN    27  // Data out
 
-// Buffer configuration
-#define DMA_BUF_COUNT   4
-#define DMA_BUF_LEN     480  // 10ms @ 48kHz per channel (1920 samples total for 4 channels)
+// Buffer configuration (one DMA descriptor per render buffer)
+#ifdef CONFIG_MODAL_AUDIO_DMA_BUFFERS
+#define DMA_BUF_COUNT   CONFIG_MODAL_AUDIO_DMA_BUFFERS
+#else
+#define DMA_BUF_COUNT   3
+#endif
+#define DMA_BUF_LEN     AUDIO_BUFFER_SAMPLES  // Frames per descriptor (2.5ms @ 48kHz by default)
 #define NUM_CHANNELS    4    // 4 channels (one per mode)
 
+// Render pipeline
+#define PIPELINE_BUFFERS        2     // Ping-pong render buffers
+#define I2S_EVENT_QUEUE_SIZE    8     // Driver events (underruns) between polls
+#define I2S_OUTPUT_TASK_STACK   3072
+
+// Duration of one buffer (µs)
+#define BUFFER_PERIOD_US ((uint32_t)((uint64_t)AUDIO_BUFFER_SAMPLES * 1000000 / SAMPLE_RATE))
+
+// ============================================================================
+// Pipeline State
+// ============================================================================
+
+static int16_t s_buffers[PIPELINE_BUFFERS][AUDIO_BUFFER_SIZE];
+static QueueHandle_t s_free_buffers;    // Buffer indices ready for rendering
+static QueueHandle_t s_ready_buffers;   // Buffer indices ready for I2S
+static QueueHandle_t s_i2s_events;      // Driver event queue
+static volatile audio_pipeline_stats_t s_stats;
+
 // ============================================================================
 // I2S Initialization
 // ============================================================================
@@ -85,7 +116,7 @@ void audio_i2s_init(void) {
     };
 
     // Install and configure I2S driver
-    esp_err_t err = i2s_driver_install(I2S_NUM, &i2s_config, 0, NULL);
+    esp_err_t err = i2s_driver_install(I2S_NUM, &i2s_config, I2S_EVENT_QUEUE_SIZE, &s_i2s_events);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to install I2S driver: %s", esp_err_to_name(err));
         return;
@@ -97,12 +128,26 @@ void audio_i2s_init(void) {
         return;
     }
 
+    // Ping-pong hand-over between the render and output tasks
+    s_free_buffers = xQueueCreate(PIPELINE_BUFFERS, sizeof(uint8_t));
+    s_ready_buffers = xQueueCreate(PIPELINE_BUFFERS, sizeof(uint8_t));
+    if (s_free_buffers == NULL || s_ready_buffers == NULL) {
+        ESP_LOGE(TAG, "Failed to create audio pipeline queues");
+        return;
+    }
+    for (uint8_t i = 0; i < PIPELINE_BUFFERS; i++) {
+        xQueueSend(s_free_buffers, &i, 0);
+    }
+
     ESP_LOGI(TAG, "I2S driver initialized successfully");
     ESP_LOGI(TAG, "  Sample rate: %d Hz", SAMPLE_RATE);
     ESP_LOGI(TAG, "  Bits per sample: 16");
     ESP_LOGI(TAG, "  Channels: %d (quad/TDM mode)", NUM_CHANNELS);
     ESP_LOGI(TAG, "  DMA buffers: %d x %d samples (%d per channel)",
              DMA_BUF_COUNT, DMA_BUF_LEN * NUM_CHANNELS, DMA_BUF_LEN);
+    ESP_LOGI(TAG, "  Render buffers: %d x %u us, latency ~%u us",
+             PIPELINE_BUFFERS, (unsigned)BUFFER_PERIOD_US,
+             (unsigned)((DMA_BUF_COUNT + PIPELINE_BUFFERS) * BUFFER_PERIOD_US));
     ESP_LOGI(TAG, "  Mode 0 → Channel 0, Mode 1 → Channel 1");
     ESP_LOGI(TAG, "  Mode 2 → Channel 2, Mode 3 → Channel 3");
 }
@@ -123,6 +168,55 @@ size_t audio_i2s_write(const int16_t* buffer, size_t size) {
     return bytes_written;
 }
 
+// ============================================================================
+// Pipeline
+// ============================================================================
+
+/**
+ * @brief Count underruns reported by the driver since the last poll
+ */
+static void poll_i2s_events(void) {
+    i2s_event_t event;
+    while (s_i2s_events && xQueueReceive(s_i2s_events, &event, 0) == pdTRUE) {
+        if (event.type == I2S_EVENT_TX_Q_OVF) {
+            s_stats.underruns++;
+        }
+    }
+}
+
+/**
+ * @brief I2S output task: feeds filled buffers to the driver
+ *
+ * Blocks in i2s_write() while the DMA is full, so it wakes once per
+ * period; the free buffer goes straight back to the render task.
+ */
+static void i2s_output_task(void* pvParameters) {
+    (void)pvParameters;
+
+    while (1) {
+        uint8_t index;
+        xQueueReceive(s_ready_buffers, &index, portMAX_DELAY);
+
+        size_t bytes_written = audio_i2s_write(s_buffers[index], sizeof(s_buffers[index]));
+        xQueueSend(s_free_buffers, &index, portMAX_DELAY);
+
+        if (bytes_written == 0) {
+            ESP_LOGW(TAG, "I2S write failed, retrying...");
+            vTaskDelay(pdMS_TO_TICKS(1));
+        }
+
+        poll_i2s_events();
+    }
+}
+
+void audio_i2s_get_stats(audio_pipeline_stats_t* stats) {
+    stats->buffers_rendered = s_stats.buffers_rendered;
+    stats->underruns = s_stats.underruns;
+    stats->late_buffers = s_stats.late_buffers;
+    stats->max_render_us = s_stats.max_render_us;
+    stats->render_busy_us = s_stats.render_busy_us;
+}
+
 // ============================================================================
 // Audio Task
 // ============================================================================
@@ -133,22 +227,33 @@ void audio_task(void* pvParameters) {
     ESP_LOGI(TAG, "Audio task started on core %d", xPortGetCoreID());
     ESP_LOGI(TAG, "Generating 48kHz audio");
 
+    if (s_free_buffers == NULL || s_ready_buffers == NULL) {
+        ESP_LOGE(TAG, "Audio pipeline not initialized");
+        vTaskDelete(NULL);
+        return;
+    }
+
     // Wait a bit for system to stabilize
     vTaskDelay(pdMS_TO_TICKS(100));
 
+    // Output task preempts rendering as soon as a DMA descriptor frees up
+    xTaskCreatePinnedToCore(i2s_output_task, "i2s_out", I2S_OUTPUT_TASK_STACK, NULL,
+                            uxTaskPriorityGet(NULL) + 1, NULL, xPortGetCoreID());
+
     while (1) {
-        // Generate one buffer of audio (480 samples = 10ms)
-        int16_t* audio_buffer = audio_synth_generate_buffer(synth);
+        // Next free ping-pong buffer (blocks while both are queued for I2S)
+        uint8_t index;
+        xQueueReceive(s_free_buffers, &index, portMAX_DELAY);
 
-        // Write to I2S (this blocks until DMA buffer is available)
-        size_t bytes_written = audio_i2s_write(audio_buffer, AUDIO_BUFFER_SIZE * sizeof(int16_t));
+        int64_t start_us = esp_timer_get_time();
+        audio_synth_generate_buffer(synth, s_buffers[index]);
+        uint32_t render_us = (uint32_t)(esp_timer_get_time() - start_us);
 
-        if (bytes_written == 0) {
-            ESP_LOGW(TAG, "I2S write failed, retrying...");
-            vTaskDelay(pdMS_TO_TICKS(1));
-        }
+        s_stats.buffers_rendered++;
+        s_stats.render_busy_us += render_us;
+        if (render_us > s_stats.max_render_us) s_stats.max_render_us = render_us;
+        if (render_us > BUFFER_PERIOD_US) s_stats.late_buffers++;
 
-        // No explicit delay needed - i2s_write blocks until buffer ready
-        // This gives us precise 48kHz timing
+        xQueueSend(s_ready_buffers, &index, portMAX_DELAY);
     }
 }
@@ -10,9 +10,15 @@
  *
  * Output format: 4-channel interleaved TDM
  * [ch0, ch1, ch2, ch3, ch0, ch1, ch2, ch3, ...]
+ *
+ * The fixed-point path (CONFIG_MODAL_AUDIO_FIXED_POINT) does the float
+ * work (gains, ω/fs) once per mode per buffer; the modal snapshot only
+ * changes at the control rate. Per sample it costs one Q31 smoothing
+ * step, one Q15 table lookup and one 32-bit multiply.
  */
 
 #include "audio_synth.h"
+#include "sine_kernel.h"
 #include <math.h>
 #include <string.h>
 
@@ -26,28 +32,20 @@
 
 #define SMOOTH_ALPHA 0.12f  // Smoothing factor (matches Python SMOOTH)
 #define MAX_AMPLITUDE_SCALE 0.7f  // Headroom (matches Python MAX_AMPLITUDE)
+#define SMOOTH_ALPHA_Q15 ((int32_t)(SMOOTH_ALPHA * 32768.0f + 0.5f))
 
 // ============================================================================
 // Fast Math Helpers
 // ============================================================================
 
 /**
- * @brief Fast sine approximation using Taylor series
+ * @brief Fast sine via the wavetable kernel
  *
- * Accurate enough for audio (error < 0.1%)
- * Much faster than sinf() on ESP32
+ * Radians are wrapped into accumulator units (no normalization loop),
+ * then looked up in the interpolated sine table (error < 1e-5).
  */
 float fast_sin(float x) {
-    // Normalize to [-π, π]
-    while (x > M_PI) x -= 2.0f * M_PI;
-    while (x < -M_PI) x += 2.0f * M_PI;
-
-    // Taylor series: sin(x) ≈ x - x³/6 + x⁵/120
-    float x2 = x * x;
-    float x3 = x * x2;
-    float x5 = x3 * x2;
-
-    return x - (x3 / 6.0f) + (x5 / 120.0f);
+    return sine_from_phase(sine_phase_from_radians(x));
 }
 
 /**
@@ -64,10 +62,12 @@ float envelope_hann(float t) {
 // ============================================================================
 
 void audio_synth_init(audio_synth_t* synth,
-                     const modal_node_t* node) {
+                     modal_snapshot_exchange_t* state) {
     memset(synth, 0, sizeof(audio_synth_t));
 
-    synth->node = node;
+    sine_table_init();
+
+    synth->state = state;
     synth->params.sample_rate = SAMPLE_RATE;
     synth->params.master_gain = 1.0f;
     synth->params.muted = false;
@@ -86,36 +86,23 @@ void audio_synth_init(audio_synth_t* synth,
 // Audio Generation
 // ============================================================================
 
-int16_t* audio_synth_generate_buffer(audio_synth_t* synth) {
-    if (!synth->initialized || !synth->node) {
-        // Return silence
-        memset(synth->buffer, 0, sizeof(synth->buffer));
-        return synth->buffer;
-    }
-
-    if (synth->params.muted) {
-        // Muted: return silence
-        memset(synth->buffer, 0, sizeof(synth->buffer));
-        return synth->buffer;
-    }
+#ifndef CONFIG_MODAL_AUDIO_FIXED_POINT
 
-    const modal_node_t* node = synth->node;
+static void generate_float(audio_synth_t* synth, const modal_snapshot_t* snapshot, int16_t* out) {
 
     // Generate 4-channel interleaved audio
     // Each mode k drives channel k
     for (int sample_idx = 0; sample_idx < AUDIO_BUFFER_SAMPLES; sample_idx++) {
         for (int k = 0; k < MAX_MODES; k++) {
             // Skip inactive modes
-            if (!node->modes[k].params.active) {
-                synth->buffer[sample_idx * NUM_AUDIO_CHANNELS + k] = 0;
+            const mode_snapshot_t* mode = &snapshot->modes[k];
+            if (!mode->active) {
+                out[sample_idx * NUM_AUDIO_CHANNELS + k] = 0;
                 continue;
             }
 
-            // Get mode amplitude (|a_k|)
-            float amplitude_raw = cabsf(node->modes[k].a);
-
-            // Apply mode weight
-            amplitude_raw *= node->modes[k].weight;
+            // Mode amplitude (|a_k| · weight, from the snapshot)
+            float amplitude_raw = mode->amplitude;
 
             // Smooth amplitude to avoid clicks
             synth->amplitude_smooth[k] +=
@@ -132,37 +119,103 @@ int16_t* audio_synth_generate_buffer(audio_synth_t* synth) {
                 amplitude = MAX_AMPLITUDE_SCALE;
             }
 
-            // Get mode frequency (omega[k] in rad/s)
-            float omega = node->modes[k].params.omega;
-            float freq_hz = omega / (2.0f * M_PI);
-
-            // Phase increment
-            float phase_inc = 2.0f * M_PI * freq_hz / synth->params.sample_rate;
+            // Phase increment from omega[k] (rad/s), in accumulator units
+            float omega = mode->omega;
+            uint32_t phase_inc = sine_phase_from_radians(omega / synth->params.sample_rate);
 
-            // Get phase from accumulator
+            // Accumulator phase plus arg(a_k) for phase coherence
             uint32_t phase_acc = synth->params.phase_accumulator[k];
-            float phase = (phase_acc / 4294967296.0f) * 2.0f * M_PI;
+            uint32_t phase = phase_acc + sine_phase_from_radians(mode->phase);
 
-            // Get phase from complex amplitude (use arg(a_k) for phase coherence)
-            float mode_phase = cargf(node->modes[k].a);
-            phase += mode_phase;
-
-            // Generate sample with fast sine
-            float sample_f = amplitude * fast_sin(phase);
+            // Generate sample from the sine table (accumulator indexed)
+            float sample_f = amplitude * sine_from_phase(phase);
 
             // Convert to 16-bit PCM
             int16_t sample_i16 = (int16_t)(sample_f * 32767.0f);
 
             // Write to interleaved buffer: [ch0, ch1, ch2, ch3, ch0, ch1, ...]
-            synth->buffer[sample_idx * NUM_AUDIO_CHANNELS + k] = sample_i16;
+            out[sample_idx * NUM_AUDIO_CHANNELS + k] = sample_i16;
 
             // Advance phase accumulator
-            phase_acc += (uint32_t)(phase_inc * 4294967296.0f / (2.0f * M_PI));
+            phase_acc += phase_inc;
             synth->params.phase_accumulator[k] = phase_acc;
         }
     }
+}
+
+#else
+
+/**
+ * @brief Integer renderer: one channel per pass, stride NUM_AUDIO_CHANNELS
+ */
+static void generate_q15(audio_synth_t* synth, const modal_snapshot_t* snapshot, int16_t* out) {
+
+    for (int k = 0; k < MAX_MODES; k++) {
+        const mode_snapshot_t* mode = &snapshot->modes[k];
+        int16_t* dst = out + k;
+
+        if (!mode->active) {
+            for (int n = 0; n < AUDIO_BUFFER_SAMPLES; n++) {
+                dst[n * NUM_AUDIO_CHANNELS] = 0;
+            }
+            continue;
+        }
 
-    return synth->buffer;
+        // Same gains and clip as the float path
+        float target = mode->amplitude *
+                       synth->params.mode_gains[k] *
+                       synth->params.master_gain *
+                       MAX_AMPLITUDE_SCALE;
+        if (target > MAX_AMPLITUDE_SCALE) {
+            target = MAX_AMPLITUDE_SCALE;
+        }
+
+        int32_t target_q31 = (int32_t)(target * 2147483648.0f);
+        uint32_t phase_inc = sine_phase_from_radians(mode->omega / synth->params.sample_rate);
+        uint32_t phase_offset = sine_phase_from_radians(mode->phase);
+
+        int32_t smooth = synth->amplitude_q31[k];
+        uint32_t phase = synth->params.phase_accumulator[k];
+
+        for (int n = 0; n < AUDIO_BUFFER_SAMPLES; n++) {
+            smooth += (int32_t)(((int64_t)(target_q31 - smooth) * SMOOTH_ALPHA_Q15) >> 15);
+
+            // Q15 × Q15 with |amplitude| ≤ 0.7: no overflow, no clip needed
+            int32_t amplitude_q15 = smooth >> 16;
+            int32_t sine_q15 = sine_q15_from_phase(phase + phase_offset);
+            dst[n * NUM_AUDIO_CHANNELS] = (int16_t)((amplitude_q15 * sine_q15) >> 15);
+
+            phase += phase_inc;
+        }
+
+        synth->amplitude_q31[k] = smooth;
+        synth->params.phase_accumulator[k] = phase;
+    }
+}
+
+#endif
+
+void audio_synth_generate_buffer(audio_synth_t* synth, int16_t* out) {
+    if (!synth->initialized || !synth->state) {
+        // Return silence
+        memset(out, 0, AUDIO_BUFFER_SIZE * sizeof(int16_t));
+        return;
+    }
+
+    if (synth->params.muted) {
+        // Muted: return silence
+        memset(out, 0, AUDIO_BUFFER_SIZE * sizeof(int16_t));
+        return;
+    }
+
+    // One snapshot per buffer: all channels see the same control step
+    const modal_snapshot_t* snapshot = modal_snapshot_read(synth->state);
+
+#ifdef CONFIG_MODAL_AUDIO_FIXED_POINT
+    generate_q15(synth, snapshot, out);
+#else
+    generate_float(synth, snapshot, out);
+#endif
 }
 
 // ============================================================================
@@ -5,7 +5,7 @@
  * Audio-first design:
  * - Runs independently at 48kHz regardless of network
  * - Modal state directly drives audio output
- * - I2S DMA output for low-latency
+ * - I2S DMA output for low-latency, fed from ping-pong render buffers
  * - 4-channel output (one channel per mode)
  *
  * Channel mapping:
@@ -15,15 +15,24 @@
  * - Channel 3: Mode 3 direct output
  *
  * Each mode synthesizes its own sinusoid at its frequency (omega[k]),
- * with amplitude envelope from the mode's complex amplitude |a_k|.
+ * with amplitude envelope from the mode's complex amplitude |a_k|. Mode
+ * state comes from the control task's latest modal_snapshot_t, read once
+ * per buffer (never from the node being integrated on the other core).
+ *
+ * CONFIG_MODAL_AUDIO_FIXED_POINT selects an integer renderer: mode state
+ * is turned once per buffer into a Q31 amplitude target, phase offset and
+ * phase increment, and the per-sample loop runs on the Q15 sine table.
  */
 
 #ifndef AUDIO_SYNTH_H
 #define AUDIO_SYNTH_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include <stdbool.h>
+#include "sdkconfig.h"
 #include "modal_node.h"
+#include "modal_snapshot.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -34,7 +43,14 @@ extern "C" {
 // ============================================================================
 
 #define SAMPLE_RATE 48000
-#define AUDIO_BUFFER_SAMPLES 480  // 10ms buffer @ 48kHz
+
+// Frames per render buffer and DMA descriptor (Kconfig, default 2.5ms @ 48kHz)
+#ifdef CONFIG_MODAL_AUDIO_PERIOD_SAMPLES
+#define AUDIO_BUFFER_SAMPLES CONFIG_MODAL_AUDIO_PERIOD_SAMPLES
+#else
+#define AUDIO_BUFFER_SAMPLES 120
+#endif
+
 #define NUM_AUDIO_CHANNELS 4      // 4 channels (one per mode)
 #define AUDIO_BUFFER_SIZE (AUDIO_BUFFER_SAMPLES * NUM_AUDIO_CHANNELS)  // Total buffer size
 #define BITS_PER_SAMPLE 16
@@ -59,9 +75,11 @@ typedef struct {
  */
 typedef struct {
     audio_synth_params_t params;
-    int16_t buffer[AUDIO_BUFFER_SIZE];  ///< DMA buffer (4-channel interleaved)
-    const modal_node_t* node;           ///< Reference to modal node state
+    modal_snapshot_exchange_t* state;   ///< Mode state published by the control task
     float amplitude_smooth[MAX_MODES];  ///< Smoothed amplitudes per mode
+#ifdef CONFIG_MODAL_AUDIO_FIXED_POINT
+    int32_t amplitude_q31[MAX_MODES];   ///< Smoothed amplitudes per mode (Q31)
+#endif
     bool initialized;
 } audio_synth_t;
 
@@ -73,23 +91,24 @@ typedef struct {
  * @brief Initialize audio synthesis engine
  *
  * @param synth Pointer to synthesis state
- * @param node Pointer to modal node (state source)
+ * @param state Snapshot exchange the control task publishes into (the
+ *              synth is its only reader)
  *
  * Note: Frequencies are taken from mode parameters (omega[k])
  */
 void audio_synth_init(audio_synth_t* synth,
-                     const modal_node_t* node);
+                     modal_snapshot_exchange_t* state);
 
 /**
  * @brief Generate one buffer of audio samples
  *
- * Reads current modal state and generates audio samples.
- * Called by I2S DMA interrupt or audio task.
+ * Reads the latest modal snapshot and generates AUDIO_BUFFER_SAMPLES frames.
+ * Called by the audio task into whichever ping-pong buffer is free.
  *
  * @param synth Pointer to synthesis state
- * @return Pointer to audio buffer (ready for I2S write)
+ * @param out Output buffer (AUDIO_BUFFER_SIZE samples, 4-channel interleaved)
  */
-int16_t* audio_synth_generate_buffer(audio_synth_t* synth);
+void audio_synth_generate_buffer(audio_synth_t* synth, int16_t* out);
 
 /**
  * @brief Set per-mode gain
@@ -127,6 +146,17 @@ void audio_synth_reset_phase(audio_synth_t* synth);
 // I2S Driver Interface
 // ============================================================================
 
+/**
+ * @brief Audio pipeline counters (since boot, wrap)
+ */
+typedef struct {
+    uint32_t buffers_rendered;  ///< Buffers synthesized
+    uint32_t underruns;         ///< DMA ran out of data (I2S TX queue overflow)
+    uint32_t late_buffers;      ///< Renders that took longer than one period
+    uint32_t max_render_us;     ///< Longest render so far (µs)
+    uint32_t render_busy_us;    ///< Total render time (µs, for load)
+} audio_pipeline_stats_t;
+
 /**
  * @brief Initialize I2S driver for PCM5102A DAC
  *
@@ -134,7 +164,7 @@ void audio_synth_reset_phase(audio_synth_t* synth);
  * - 48kHz sample rate
  * - 16-bit samples
  * - Mono or stereo output
- * - DMA buffers
+ * - CONFIG_MODAL_AUDIO_DMA_BUFFERS DMA buffers of AUDIO_BUFFER_SAMPLES frames
  */
 void audio_i2s_init(void);
 
@@ -150,13 +180,24 @@ size_t audio_i2s_write(const int16_t* buffer, size_t size);
 /**
  * @brief Audio task (FreeRTOS)
  *
- * Continuously generates audio and writes to I2S.
- * Runs at high priority on dedicated core.
+ * Renders into two ping-pong buffers and hands each filled one to an I2S
+ * output task it starts on the same core, one priority higher. While
+ * that task blocks in i2s_write() until DMA frees a descriptor, this one
+ * synthesizes the next buffer, so render jitter is absorbed by a whole
+ * period instead of reaching the DAC. Output latency is about
+ * (DMA buffers + 2) × AUDIO_BUFFER_SAMPLES frames.
  *
  * @param pvParameters Task parameters (audio_synth_t*)
  */
 void audio_task(void* pvParameters);
 
+/**
+ * @brief Read audio pipeline counters (any task)
+ *
+ * @param stats Output counters
+ */
+void audio_i2s_get_stats(audio_pipeline_stats_t* stats);
+
 // ============================================================================
 // Synthesis Helpers
 // ============================================================================
@@ -164,7 +205,9 @@ void audio_task(void* pvParameters);
 /**
  * @brief Fast sine approximation
  *
- * Uses lookup table or fast polynomial for low-latency synthesis.
+ * Wraps any phase into accumulator units and uses the wavetable kernel
+ * (sine_kernel.h). Renderers index the kernel with their accumulators
+ * directly; this is for callers holding radians.
  *
  * @param phase Phase in radians
  * @return Sine value [-1, 1]
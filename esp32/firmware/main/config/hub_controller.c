@@ -9,6 +9,7 @@
 
 #include "hub_controller.h"
 #include "session_config.h"
+#include "session_cache.h"
 #include "driver/uart.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
@@ -27,6 +28,10 @@
 #define MIDI_UART_NUM UART_NUM_1
 #define MIDI_RX_PIN 16
 #define MIDI_BUF_SIZE 256
+#define MIDI_UART_QUEUE_DEPTH 16
+#define MIDI_RX_FULL_THRESHOLD 1    // Interrupt per byte (one every 320 µs at most)
+#define MIDI_RX_TIMEOUT_SYMBOLS 2   // Backstop for bytes left in the FIFO
+#define MIDI_READ_CHUNK 64
 
 // ============================================================================
 // Initialization
@@ -42,11 +47,21 @@ void hub_controller_init(hub_controller_t* hub,
     hub->network = network;
     hub->use_default_config = use_defaults;
     hub->state = HUB_STATE_IDLE;
+    protocol_create_poke_batch(&hub->poke_batch, hub_node_id);
+    portMUX_INITIALIZE(&hub->cfg_lock);
+    portMUX_INITIALIZE(&hub->discovery_lock);
 
     // Initialize session manager
     session_manager_init(&hub->session, hub_node_id);
     hub->session.is_controller = true;
 
+    // The session before this boot, for a warm restart
+    if (session_cache_info(&hub->warm_crc, &hub->warm_nodes)) {
+        ESP_LOGI(TAG, "Cached session: %d nodes, crc=0x%08X", hub->warm_nodes, (unsigned)hub->warm_crc);
+    } else {
+        hub->warm_nodes = 0;
+    }
+
     ESP_LOGI(TAG, "Hub controller initialized (node_id=%d, use_defaults=%d)",
              hub_node_id, use_defaults);
 }
@@ -67,8 +82,11 @@ bool hub_midi_init(hub_controller_t* hub) {
         .source_clk = UART_SCLK_APB,
     };
 
-    // Install UART driver
-    esp_err_t err = uart_driver_install(MIDI_UART_NUM, MIDI_BUF_SIZE * 2, 0, 0, NULL, 0);
+    midi_parser_init(&hub->midi.parser);
+
+    // Install UART driver with an event queue
+    esp_err_t err = uart_driver_install(MIDI_UART_NUM, MIDI_BUF_SIZE * 2, 0,
+                                        MIDI_UART_QUEUE_DEPTH, &hub->midi.uart_events, 0);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to install UART driver: %s", esp_err_to_name(err));
         return false;
@@ -87,43 +105,102 @@ bool hub_midi_init(hub_controller_t* hub) {
         return false;
     }
 
+    // Default thresholds batch up to ~120 bytes before interrupting
+    err = uart_set_rx_full_threshold(MIDI_UART_NUM, MIDI_RX_FULL_THRESHOLD);
+    if (err == ESP_OK) {
+        err = uart_set_rx_timeout(MIDI_UART_NUM, MIDI_RX_TIMEOUT_SYMBOLS);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set UART RX thresholds: %s", esp_err_to_name(err));
+        return false;
+    }
+
     hub->midi.initialized = true;
     ESP_LOGI(TAG, "MIDI input initialized at 31250 baud");
 
     return true;
 }
 
-void hub_midi_process(hub_controller_t* hub) {
-    if (!hub->midi.initialized) return;
-
-    uint8_t data[3];
-    int len = uart_read_bytes(MIDI_UART_NUM, data, sizeof(data), 0);
+bool hub_midi_wait(hub_controller_t* hub, uint32_t timeout_ms) {
+    if (!hub->midi.initialized) {
+        vTaskDelay(pdMS_TO_TICKS(timeout_ms));
+        return false;
+    }
 
-    if (len < 3) return;  // MIDI messages are 3 bytes
+    uart_event_t event;
+    if (xQueueReceive(hub->midi.uart_events, &event, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+        return false;
+    }
 
-    // Parse MIDI message
-    uint8_t status = data[0];
-    uint8_t cmd = status & 0xF0;
-    uint8_t channel = (status & 0x0F) + 1;  // Convert to 1-indexed
+    switch (event.type) {
+        case UART_DATA:
+        case UART_BUFFER_FULL:  // Driver stopped reading; draining resumes it
+            return true;
+
+        case UART_FIFO_OVF:
+            // Bytes were lost: drop the rest rather than misparse it
+            ESP_LOGW(TAG, "MIDI RX FIFO overflow");
+            uart_flush_input(MIDI_UART_NUM);
+            xQueueReset(hub->midi.uart_events);
+            midi_parser_reset(&hub->midi.parser);
+            hub->midi.uart_overflows++;
+            return false;
+
+        default:
+            return false;
+    }
+}
 
-    if (cmd == 0x90) {  // Note On
-        uint8_t note = data[1];
-        uint8_t velocity = data[2];
+static void handle_midi_event(hub_controller_t* hub, const midi_event_t* event) {
+    uint8_t cmd = event->status & 0xF0;
+    uint8_t channel = (event->status & 0x0F) + 1;  // Convert to 1-indexed
 
-        if (velocity > 0) {
-            hub_midi_note_on(hub, note, velocity, channel);
+    if (cmd == MIDI_STATUS_NOTE_ON) {
+        if (event->data2 > 0) {
+            hub_midi_note_on(hub, event->data1, event->data2, channel);
         } else {
-            hub_midi_note_off(hub, note, channel);
+            hub_midi_note_off(hub, event->data1, channel);
+        }
+    } else if (cmd == MIDI_STATUS_NOTE_OFF) {
+        hub_midi_note_off(hub, event->data1, channel);
+    } else {
+        return;
+    }
+
+    int64_t latency_us = esp_timer_get_time() - event->timestamp_us;
+    if (latency_us > hub->midi.max_latency_us) {
+        hub->midi.max_latency_us = latency_us;
+    }
+}
+
+void hub_midi_process(hub_controller_t* hub) {
+    if (!hub->midi.initialized) return;
+
+    // Everything already received (e.g. all notes of a chord) goes out
+    // in one poke batch
+    uint8_t data[MIDI_READ_CHUNK];
+    int len;
+    while ((len = uart_read_bytes(MIDI_UART_NUM, data, sizeof(data), 0)) > 0) {
+        int64_t now_us = esp_timer_get_time();
+        for (int i = 0; i < len; i++) {
+            midi_parser_feed(&hub->midi.parser, data[i], now_us);
+        }
+
+        midi_event_t event;
+        while (midi_parser_pop(&hub->midi.parser, &event)) {
+            handle_midi_event(hub, &event);
         }
-    } else if (cmd == 0x80) {  // Note Off
-        uint8_t note = data[1];
-        hub_midi_note_off(hub, note, channel);
     }
+
+    hub_flush_pokes(hub);
 }
 
 void hub_midi_note_on(hub_controller_t* hub, uint8_t note, uint8_t velocity, uint8_t channel) {
     // Create MIDI note
     midi_note_t* midi_note = &hub->midi.active_notes[note];
+    if (!midi_note->active) {
+        hub->midi.num_active++;  // A retrigger is still one active note
+    }
     midi_note->note = note;
     midi_note->velocity = velocity;
     midi_note->freq_hz = midi_to_freq(note);
@@ -131,8 +208,6 @@ void hub_midi_note_on(hub_controller_t* hub, uint8_t note, uint8_t velocity, uin
     midi_note->target_node = hub_note_to_node(note, hub->num_registered);
     midi_note->active = true;
 
-    hub->midi.num_active++;
-
     ESP_LOGI(TAG, "[MIDI] Note ON: ch=%d note=%d vel=%d freq=%.1f Hz → node %d",
              channel, note, velocity, midi_note->freq_hz, midi_note->target_node);
 
@@ -162,32 +237,205 @@ void hub_start_discovery(hub_controller_t* hub, uint32_t timeout_ms) {
     // Send HELLO broadcast
     network_message_t msg;
     protocol_create_hello(&msg, hub->hub_node_id, "Hub");
+    msg.hello.capabilities |= HELLO_CAP_HUB;
     esp_now_broadcast_message(hub->network, &msg, sizeof(msg_hello_t));
 
-    // Discovery continues in background via hub_handle_hello()
+    // Answers are collected by hub_handle_hello() until hub_finish_discovery()
+}
+
+bool hub_discovery_complete(const hub_controller_t* hub) {
+    if (hub->warm_nodes == 0 || hub->num_discovered < hub->warm_nodes) return false;
+
+    for (int i = 0; i < hub->num_discovered; i++) {
+        if (hub->discovered[i].config_crc != hub->warm_crc) return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Registered node for a node ID (nodes[] is indexed by ID)
+ */
+static registered_node_t* node_by_id(hub_controller_t* hub, uint8_t node_id) {
+    if (node_id >= hub->num_registered || hub->nodes[node_id].node_id != node_id) return NULL;
+    return &hub->nodes[node_id];
+}
+
+static registered_node_t* node_by_mac(hub_controller_t* hub, const uint8_t* mac) {
+    for (int i = 0; i < hub->num_registered; i++) {
+        if (memcmp(hub->nodes[i].mac_address, mac, 6) == 0) return &hub->nodes[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Broadcast the ID assignments of nodes[first..] (as many OFFERs as needed)
+ */
+static void send_offers(hub_controller_t* hub, uint8_t first) {
+    network_message_t offer;
+    protocol_create_offer(&offer, hub->hub_node_id, "default_session", 0, hub->num_registered);
+
+    for (int i = first; i < hub->num_registered; i++) {
+        protocol_offer_add(&offer, hub->nodes[i].mac_address, hub->nodes[i].node_id);
+
+        if (offer.offer.count == OFFER_MAX_ASSIGNMENTS || i == hub->num_registered - 1) {
+            esp_now_broadcast_message(hub->network, &offer, protocol_offer_size(&offer.offer));
+            offer.offer.count = 0;
+        }
+    }
+}
+
+uint8_t hub_finish_discovery(hub_controller_t* hub) {
+    static discovered_node_t found[MAX_REGISTERED_NODES];  // Discovery task only
+
+    portENTER_CRITICAL(&hub->discovery_lock);
+    uint8_t num_found = hub->num_discovered;
+    memcpy(found, hub->discovered, num_found * sizeof(discovered_node_t));
+    hub->num_discovered = 0;
+    portEXIT_CRITICAL(&hub->discovery_lock);
+
+    // MAC order: the same nodes get the same IDs whatever order they answered in
+    for (int i = 1; i < num_found; i++) {
+        discovered_node_t entry = found[i];
+        int j = i - 1;
+        while (j >= 0 && memcmp(found[j].mac_address, entry.mac_address, 6) > 0) {
+            found[j + 1] = found[j];
+            j--;
+        }
+        found[j + 1] = entry;
+    }
+
+    // One pass: registry slot, node ID and ESP-NOW peer per node
+    uint8_t first = hub->num_registered;
+    for (int i = 0; i < num_found; i++) {
+        uint8_t node_id = hub->num_registered;
+        if (!hub_register_node(hub, node_id, found[i].mac_address)) break;
+
+        // A cached config only counts if it was applied under this ID
+        hub->nodes[node_id].cached_crc =
+            (found[i].hello_id == node_id) ? found[i].config_crc : 0;
+    }
+
+    if (hub->num_registered == first) {
+        ESP_LOGW(TAG, "Discovery found no new nodes");
+        return 0;
+    }
+
+    send_offers(hub, first);
+
+    ESP_LOGI(TAG, "Registered %d discovered nodes (IDs %d-%d)",
+             hub->num_registered - first, first, hub->num_registered - 1);
+
+    return hub->num_registered - first;
 }
 
 void hub_handle_hello(hub_controller_t* hub, const msg_hello_t* msg) {
-    ESP_LOGI(TAG, "Received HELLO from node %d (%s)",
-             msg->header.source_id, msg->name);
+    if (msg->capabilities & HELLO_CAP_HUB) return;  // Another hub's discovery
 
-    // Auto-assign node ID based on order received
-    uint8_t node_id = hub->num_registered;
+    ESP_LOGI(TAG, "Received HELLO from node %d (%s), config crc=0x%08X",
+             msg->header.source_id, msg->name, (unsigned)msg->config_crc);
 
-    if (hub_register_node(hub, node_id, msg->mac_address)) {
-        // Send OFFER
+    // Announced again after a reboot, or answering a later discovery
+    registered_node_t* node = node_by_mac(hub, msg->mac_address);
+    if (node) {
+        node->cached_crc = (msg->header.source_id == node->node_id) ? msg->config_crc : 0;
+
+        // Its ID again, in case it was lost with the node's NVS
         network_message_t offer;
-        offer.offer.header.type = MSG_OFFER;
-        offer.offer.header.source_id = hub->hub_node_id;
-        offer.offer.header.dest_id = node_id;
-        strncpy(offer.offer.session_id, "default_session", sizeof(offer.offer.session_id));
-        offer.offer.config_size = 0;  // Will send in config phase
-        offer.offer.num_nodes = hub->num_registered;
+        protocol_create_offer(&offer, hub->hub_node_id, "default_session", 0, hub->num_registered);
+        protocol_offer_add(&offer, node->mac_address, node->node_id);
+        esp_now_broadcast_message(hub->network, &offer, protocol_offer_size(&offer.offer));
+
+        // Back from a reboot with the running session's configuration
+        if (node->running && node->cached_crc == hub->cfg_checksum) {
+            network_message_t start;
+            protocol_create_start(&start, hub->hub_node_id, (uint32_t)(esp_timer_get_time() / 1000));
+            esp_now_send_message(hub->network, node->node_id, &start, sizeof(msg_start_t));
+            ESP_LOGI(TAG, "Node %d rejoined with the session config, restarted", node->node_id);
+        } else if (node->running) {
+            ESP_LOGW(TAG, "Node %d rejoined without the session config (crc=0x%08X)",
+                     node->node_id, (unsigned)msg->config_crc);
+        }
+        return;
+    }
 
-        esp_now_send_message(hub->network, node_id, &offer, sizeof(msg_offer_t));
+    // Collected until discovery finishes (boot announcements included)
+    if (hub->state == HUB_STATE_IDLE || hub->state == HUB_STATE_DISCOVERING) {
+        portENTER_CRITICAL(&hub->discovery_lock);
+        int i = 0;
+        while (i < hub->num_discovered &&
+               memcmp(hub->discovered[i].mac_address, msg->mac_address, 6) != 0) {
+            i++;
+        }
+        if (i < MAX_REGISTERED_NODES) {
+            discovered_node_t* entry = &hub->discovered[i];
+            memcpy(entry->mac_address, msg->mac_address, 6);
+            entry->hello_id = msg->header.source_id;
+            entry->config_crc = msg->config_crc;
+            if (i == hub->num_discovered) hub->num_discovered++;
+        }
+        portEXIT_CRITICAL(&hub->discovery_lock);
+        return;
+    }
 
-        ESP_LOGI(TAG, "Sent OFFER to node %d", node_id);
+    // Late joiner: next free ID right away
+    uint8_t node_id = hub->num_registered;
+    if (hub_register_node(hub, node_id, msg->mac_address)) {
+        hub->nodes[node_id].cached_crc = (msg->header.source_id == node_id) ? msg->config_crc : 0;
+        send_offers(hub, node_id);
+        ESP_LOGI(TAG, "Late node registered as %d", node_id);
+    }
+}
+
+void hub_handle_heartbeat(hub_controller_t* hub, const msg_heartbeat_t* msg) {
+    registered_node_t* node = node_by_id(hub, msg->header.source_id);
+    if (!node) return;
+
+    // Hub time, as compared against by the stale-node check
+    node->last_heartbeat_ms = esp_timer_get_time() / 1000;
+
+    if (msg->audio_underruns != node->audio_underruns) {
+        ESP_LOGW(TAG, "Node %d audio underruns: %u (+%u)", node->node_id,
+                 msg->audio_underruns,
+                 (uint16_t)(msg->audio_underruns - node->audio_underruns));
+    }
+    if (msg->control_overruns != node->control_overruns) {
+        ESP_LOGW(TAG, "Node %d control overruns: %u (+%u), max step %u us", node->node_id,
+                 msg->control_overruns,
+                 (uint16_t)(msg->control_overruns - node->control_overruns),
+                 msg->control_max_us);
+    }
+
+    node->audio_underruns = msg->audio_underruns;
+    node->audio_late_buffers = msg->audio_late_buffers;
+    node->cpu_usage = msg->cpu_usage;
+    node->control_load = msg->control_load;
+    node->network_load = msg->network_load;
+    node->audio_load = msg->audio_load;
+    node->control_max_us = msg->control_max_us;
+    node->control_overruns = msg->control_overruns;
+    node->audio_max_render_us = msg->audio_max_render_us;
+    node->poke_queue_hwm = msg->poke_queue_hwm;
+    node->poke_drops = msg->poke_drops;
+    node->pokes_received = msg->pokes_received;
+}
+
+void hub_handle_cfg_ack(hub_controller_t* hub, const msg_cfg_ack_t* msg) {
+    if (msg->checksum != hub->cfg_checksum) {
+        ESP_LOGD(TAG, "Ignoring CFG_ACK from node %d for old transfer", msg->header.source_id);
+        return;
     }
+
+    registered_node_t* node = node_by_id(hub, msg->header.source_id);
+    if (!node) return;
+
+    portENTER_CRITICAL(&hub->cfg_lock);
+    memcpy(node->cfg_bitmap, msg->chunk_bitmap, sizeof(node->cfg_bitmap));
+    node->cfg_status = msg->status;
+    portEXIT_CRITICAL(&hub->cfg_lock);
+
+    ESP_LOGD(TAG, "CFG_ACK from node %d: status=%d (%d chunks)",
+             node->node_id, msg->status, msg->chunks_received);
 }
 
 bool hub_register_node(hub_controller_t* hub, uint8_t node_id, const uint8_t* mac) {
@@ -203,9 +451,29 @@ bool hub_register_node(hub_controller_t* hub, uint8_t node_id, const uint8_t* ma
     node->configured = false;
     node->running = false;
     node->last_heartbeat_ms = esp_timer_get_time() / 1000;
+    node->audio_underruns = 0;
+    node->audio_late_buffers = 0;
+    node->cpu_usage = 0;
+    node->control_load = 0;
+    node->network_load = 0;
+    node->audio_load = 0;
+    node->control_max_us = 0;
+    node->control_overruns = 0;
+    node->audio_max_render_us = 0;
+    node->poke_queue_hwm = 0;
+    node->poke_drops = 0;
+    node->pokes_received = 0;
+    node->cached_crc = 0;
 
     hub->num_registered++;
 
+    // Unicasts to the node get link-layer ACKs, and PINGs can be measured.
+    // Past the ESP-NOW peer limit, frames for the node go out as
+    // broadcasts carrying its ID (relays forward those too).
+    if (hub->network->num_peers < MAX_PEERS) {
+        esp_now_register_peer(hub->network, node_id, mac);
+    }
+
     ESP_LOGI(TAG, "Registered node %d (total: %d)", node_id, hub->num_registered);
 
     return true;
@@ -219,24 +487,85 @@ uint8_t hub_get_num_registered(const hub_controller_t* hub) {
 // Configuration Distribution
 // ============================================================================
 
+/**
+ * @brief Resize a preset to num_nodes (extra nodes copy its last node)
+ *
+ * @return true if the size changed and the topology must be regenerated
+ */
+static bool fit_preset(session_config_t* config, uint8_t num_nodes) {
+    uint8_t preset_nodes = config->num_nodes;
+    if (num_nodes == preset_nodes) return false;
+
+    for (uint8_t i = preset_nodes; i < num_nodes; i++) {
+        config->nodes[i] = config->nodes[preset_nodes - 1];
+        config->nodes[i].node_id = i;
+    }
+    config->num_nodes = num_nodes;
+    return true;
+}
+
 bool hub_send_default_config(hub_controller_t* hub) {
     ESP_LOGI(TAG, "Sending default configuration to %d nodes", hub->num_registered);
 
-    // Generate default ring topology
-    session_manager_t session_mgr;
-    session_manager_init(&session_mgr, hub->hub_node_id);
+    static session_config_t config;  // 5 KB: keep off the task stack
+    memset(&config, 0, sizeof(config));
+    uint8_t num_nodes = hub->num_registered;
+
+#if defined(CONFIG_MODAL_HUB_PRESET_RING)
+    preset_ring_16_resonator(&config);
+    if (fit_preset(&config, num_nodes)) topology_generate_ring(&config, num_nodes);
+#elif defined(CONFIG_MODAL_HUB_PRESET_SMALL_WORLD)
+    preset_small_world_8_oscillator(&config);
+    if (fit_preset(&config, num_nodes)) topology_generate_small_world(&config, num_nodes, 0.0f);
+#elif defined(CONFIG_MODAL_HUB_PRESET_CLUSTERS)
+    preset_clusters_16(&config);
+    if (fit_preset(&config, num_nodes)) {
+        topology_generate_clusters(&config, num_nodes, (num_nodes >= 16) ? num_nodes / 8 : 1);
+    }
+#elif defined(CONFIG_MODAL_HUB_PRESET_HUB_SPOKE)
+    preset_hub_spoke_16(&config);
+    if (fit_preset(&config, num_nodes)) topology_generate_hub_spoke(&config, num_nodes, 0);
+#else
+    if (num_nodes <= 16) {
+        // Ring, trimmed to the nodes that joined
+        preset_ring_16_resonator(&config);
+        if (fit_preset(&config, num_nodes)) topology_generate_ring(&config, num_nodes);
+    } else {
+        // Clusters of 8, one radio group each
+        preset_clusters_64(&config);
+        topology_generate_clusters(&config, num_nodes, num_nodes / 8);
+    }
+#endif
 
-    // Use preset ring configuration
-    preset_ring_16_resonator(&session_mgr);
+    // Send this configuration to all nodes
+    return hub_send_config(hub, &config);
+}
 
-    // Update to match actual number of registered nodes
-    if (hub->num_registered < 16) {
-        session_mgr.config.num_nodes = hub->num_registered;
-        topology_generate_ring(&session_mgr.config, hub->num_registered);
+/**
+ * @brief Broadcast one frame, keeping at most CFG_TX_WINDOW queued
+ */
+static void send_cfg_frame(hub_controller_t* hub, const network_message_t* msg, size_t len) {
+    while (esp_now_tx_pending(hub->network) >= CFG_TX_WINDOW) {
+        vTaskDelay(1);
     }
+    esp_now_broadcast_message(hub->network, msg, len);
+    hub->cfg_frames_sent++;
+}
 
-    // Send this configuration to all nodes
-    return hub_send_config(hub, &session_mgr.config);
+/**
+ * @brief Whether every registered node has answered this round
+ */
+static bool all_cfg_acks_in(hub_controller_t* hub) {
+    bool done = true;
+    portENTER_CRITICAL(&hub->cfg_lock);
+    for (int i = 0; i < hub->num_registered; i++) {
+        if (hub->nodes[i].cfg_status == CFG_STATUS_PENDING) {
+            done = false;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&hub->cfg_lock);
+    return done;
 }
 
 bool hub_send_config(hub_controller_t* hub, const session_config_t* config) {
@@ -244,12 +573,9 @@ bool hub_send_config(hub_controller_t* hub, const session_config_t* config) {
 
     ESP_LOGI(TAG, "Sending configuration to %d nodes", hub->num_registered);
 
-    // Serialize configuration to binary
-    uint8_t config_buffer[4096];  // Max config size
-    session_manager_t temp_mgr;
-    memcpy(&temp_mgr.config, config, sizeof(session_config_t));
-
-    size_t config_size = session_serialize_config_binary(&temp_mgr,
+    // Serialize configuration to the compact binary format
+    static uint8_t config_buffer[SESSION_BLOB_MAX_SIZE];  // 5 KB: keep off the task stack
+    size_t config_size = session_serialize_config_binary(config,
                                                          config_buffer,
                                                          sizeof(config_buffer));
 
@@ -258,64 +584,144 @@ bool hub_send_config(hub_controller_t* hub, const session_config_t* config) {
         return false;
     }
 
-    ESP_LOGI(TAG, "Configuration size: %d bytes", config_size);
-
-    // Calculate number of chunks (200 bytes per chunk)
-    const uint8_t chunk_size = 200;
-    uint8_t num_chunks = (config_size + chunk_size - 1) / chunk_size;
-
-    ESP_LOGI(TAG, "Splitting into %d chunks", num_chunks);
+    uint8_t num_chunks = (config_size + CFG_CHUNK_DATA_SIZE - 1) / CFG_CHUNK_DATA_SIZE;
+    if (num_chunks > CFG_MAX_CHUNKS) {
+        ESP_LOGE(TAG, "Configuration too large (%u bytes)", (unsigned)config_size);
+        return false;
+    }
 
-    // Calculate checksum
     uint32_t checksum = protocol_crc32(config_buffer, config_size);
+    ESP_LOGI(TAG, "Configuration: %u bytes, %d chunks, crc=0x%08X",
+             (unsigned)config_size, num_chunks, checksum);
 
-    // Send CFG_BEGIN to all nodes
-    network_message_t msg;
-    protocol_create_cfg_begin(&msg, hub->hub_node_id, config_size, num_chunks, checksum);
-    esp_now_broadcast_message(&hub->network, &msg, sizeof(msg_cfg_begin_t));
+    hub->state = HUB_STATE_CONFIGURING;
+    hub->cfg_frames_sent = 0;
 
-    ESP_LOGI(TAG, "Sent CFG_BEGIN (size=%d, chunks=%d, crc=0x%08X)",
-             config_size, num_chunks, checksum);
+    // Every chunk is wanted in the first round
+    uint8_t wanted[CFG_CHUNK_BITMAP_BYTES] = {0};
+    for (uint8_t i = 0; i < num_chunks; i++) {
+        wanted[i / 8] |= 1 << (i % 8);
+    }
 
-    // Small delay between messages
-    vTaskDelay(pdMS_TO_TICKS(50));
+    // Nodes that already hold this configuration need no transfer
+    int holding = 0;
+    portENTER_CRITICAL(&hub->cfg_lock);
+    hub->cfg_checksum = checksum;
+    for (int i = 0; i < hub->num_registered; i++) {
+        bool cached = (hub->nodes[i].cached_crc == checksum);
+        hub->nodes[i].cfg_status = cached ? CFG_STATUS_OK : CFG_STATUS_PENDING;
+        hub->nodes[i].configured = cached;
+        if (cached) holding++;
+    }
+    portEXIT_CRITICAL(&hub->cfg_lock);
 
-    // Send chunks
-    for (uint8_t i = 0; i < num_chunks; i++) {
-        size_t offset = i * chunk_size;
-        size_t this_chunk_size = (offset + chunk_size > config_size) ?
-                                 (config_size - offset) : chunk_size;
+    if (holding == hub->num_registered) {
+        hub->state = HUB_STATE_READY;
+        ESP_LOGI(TAG, "All %d nodes hold configuration 0x%08X, transfer skipped",
+                 holding, (unsigned)checksum);
+        return true;
+    }
+    if (holding > 0) {
+        ESP_LOGI(TAG, "%d/%d nodes hold configuration 0x%08X already",
+                 holding, hub->num_registered, (unsigned)checksum);
+    }
 
-        protocol_create_cfg_chunk(&msg, hub->hub_node_id, i,
-                                 config_buffer + offset, this_chunk_size);
+    network_message_t msg;
+    int round;
+
+    for (round = 0; round < CFG_MAX_ROUNDS; round++) {
+        // Sent every round: cheap, and idempotent on nodes already receiving
+        size_t len = protocol_create_cfg_begin(&msg, hub->hub_node_id, config_size,
+                                               num_chunks, checksum);
+        send_cfg_frame(hub, &msg, len);
+
+        uint8_t chunks_this_round = 0;
+        for (uint8_t i = 0; i < num_chunks; i++) {
+            if (!(wanted[i / 8] & (1 << (i % 8)))) continue;
+
+            size_t offset = (size_t)i * CFG_CHUNK_DATA_SIZE;
+            size_t this_chunk_size = (offset + CFG_CHUNK_DATA_SIZE > config_size) ?
+                                     (config_size - offset) : CFG_CHUNK_DATA_SIZE;
+
+            len = protocol_create_cfg_chunk(&msg, hub->hub_node_id, i,
+                                            config_buffer + offset, this_chunk_size);
+            send_cfg_frame(hub, &msg, len);
+            chunks_this_round++;
+        }
 
-        size_t msg_size = sizeof(message_header_t) + 2 + this_chunk_size;
-        esp_now_broadcast_message(&hub->network, &msg, msg_size);
+        len = protocol_create_cfg_end(&msg, hub->hub_node_id, checksum);
+        send_cfg_frame(hub, &msg, len);
 
-        ESP_LOGD(TAG, "Sent chunk %d/%d (%d bytes)", i + 1, num_chunks, this_chunk_size);
+        ESP_LOGI(TAG, "Round %d: sent %d/%d chunks", round + 1, chunks_this_round, num_chunks);
 
-        // Small delay to avoid overwhelming nodes
-        vTaskDelay(pdMS_TO_TICKS(20));
-    }
+        // Collect this round's answers
+        TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(CFG_ACK_TIMEOUT_MS);
+        while (!all_cfg_acks_in(hub) && (int32_t)(deadline - xTaskGetTickCount()) > 0) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
 
-    // Send CFG_END
-    protocol_create_cfg_end(&msg, hub->hub_node_id, checksum);
-    esp_now_broadcast_message(&hub->network, &msg, sizeof(msg_cfg_end_t));
+        // Next round resends the union of every node's missing chunks.
+        // OK and REJECTED are final; everyone else answers again.
+        memset(wanted, 0, sizeof(wanted));
+
+        portENTER_CRITICAL(&hub->cfg_lock);
+        for (int n = 0; n < hub->num_registered; n++) {
+            registered_node_t* node = &hub->nodes[n];
+
+            switch (node->cfg_status) {
+                case CFG_STATUS_OK:
+                    node->configured = true;
+                    node->cached_crc = checksum;
+                    continue;
+
+                case CFG_STATUS_REJECTED:
+                    continue;
+
+                case CFG_STATUS_PENDING:
+                    // CFG_END or the ACK was lost: the next CFG_END asks again
+                    break;
+
+                default:
+                    // MISSING, CHECKSUM (bitmap cleared), NO_TRANSFER (empty)
+                    for (int b = 0; b < CFG_CHUNK_BITMAP_BYTES; b++) {
+                        wanted[b] |= (uint8_t)~node->cfg_bitmap[b];
+                    }
+                    break;
+            }
+            node->cfg_status = CFG_STATUS_PENDING;
+        }
+        portEXIT_CRITICAL(&hub->cfg_lock);
 
-    ESP_LOGI(TAG, "Sent CFG_END");
+        // Only chunks that exist
+        for (uint8_t i = num_chunks; i < CFG_MAX_CHUNKS; i++) {
+            wanted[i / 8] &= ~(1 << (i % 8));
+        }
 
-    // Wait for acknowledgments (simplified - just wait a bit)
-    vTaskDelay(pdMS_TO_TICKS(200));
+        if (all_cfg_acks_in(hub)) break;
+    }
 
-    // Mark all nodes as configured
+    int failed = 0;
     for (int i = 0; i < hub->num_registered; i++) {
-        hub->nodes[i].configured = true;
+        if (!hub->nodes[i].configured) {
+            failed++;
+            ESP_LOGW(TAG, "Node %d not configured (status=%d)",
+                     hub->nodes[i].node_id, hub->nodes[i].cfg_status);
+        }
     }
 
     hub->state = HUB_STATE_READY;
-    ESP_LOGI(TAG, "Configuration distribution complete");
+    ESP_LOGI(TAG, "Configuration distribution complete: %d/%d nodes, %d round(s), %u frames",
+             hub->num_registered - failed, hub->num_registered,
+             round < CFG_MAX_ROUNDS ? round + 1 : CFG_MAX_ROUNDS,
+             (unsigned)hub->cfg_frames_sent);
+
+    // Every node holds it now: the next boot can wait for exactly these
+    if (failed == 0 && session_cache_store(config_buffer, config_size, checksum)) {
+        hub->warm_crc = checksum;
+        hub->warm_nodes = hub->num_registered;
+    }
 
-    return true;
+    return failed == 0;
 }
 
 // ============================================================================
@@ -330,14 +736,13 @@ bool hub_start_session(hub_controller_t* hub) {
 
     ESP_LOGI(TAG, "Starting session on %d nodes", hub->num_registered);
 
-    // Send START message to all nodes
+    // One broadcast for every node (relays carry it further)
     network_message_t msg;
     uint32_t start_time = esp_timer_get_time() / 1000;
     protocol_create_start(&msg, hub->hub_node_id, start_time);
+    esp_now_broadcast_message(hub->network, &msg, sizeof(msg_start_t));
 
     for (int i = 0; i < hub->num_registered; i++) {
-        esp_now_send_message(hub->network, hub->nodes[i].node_id,
-                           &msg, sizeof(msg_start_t));
         hub->nodes[i].running = true;
     }
 
@@ -355,10 +760,9 @@ void hub_stop_session(hub_controller_t* hub) {
     // Send STOP message
     network_message_t msg;
     protocol_create_stop(&msg, hub->hub_node_id);
+    esp_now_broadcast_message(hub->network, &msg, sizeof(msg_stop_t));
 
     for (int i = 0; i < hub->num_registered; i++) {
-        esp_now_send_message(hub->network, hub->nodes[i].node_id,
-                           &msg, sizeof(msg_stop_t));
         hub->nodes[i].running = false;
     }
 
@@ -376,27 +780,50 @@ void hub_send_midi_poke(hub_controller_t* hub, const midi_note_t* note) {
         return;
     }
 
-    // Create poke message
-    network_message_t msg;
     float strength = note->velocity / 127.0f;
     float phase_hint = -1.0f;  // Random phase
 
     // Mode weights (match Python's default mapping)
     float mode_weights[4] = {1.0f, 0.8f, 0.3f, 0.5f};
 
-    protocol_create_poke(&msg, hub->hub_node_id, note->target_node,
-                        strength, phase_hint, mode_weights);
+    if (!protocol_poke_batch_add(&hub->poke_batch, note->target_node,
+                                 strength, phase_hint, mode_weights)) {
+        hub_flush_pokes(hub);
+        protocol_poke_batch_add(&hub->poke_batch, note->target_node,
+                                strength, phase_hint, mode_weights);
+    }
+
+    ESP_LOGD(TAG, "Queued poke to node %d (strength=%.2f)", note->target_node, strength);
+}
+
+void hub_flush_pokes(hub_controller_t* hub) {
+    msg_poke_batch_t* batch = &hub->poke_batch.poke_batch;
+    if (batch->count == 0) return;
+
+    uint8_t count = batch->count;
 
-    // Send poke
-    bool sent = esp_now_send_message(hub->network, note->target_node,
-                                     &msg, sizeof(msg_poke_t));
+    // Stamped now, not when the batch was started: frames sent since then
+    // took later sequences, and receivers' duplicate filters expect hub
+    // frames in sequence order
+    protocol_init_header(&batch->header, MSG_POKE_BATCH, hub->hub_node_id, 0xFF);
+
+    // Every synchronized node applies the batch at the same hub time
+    batch->apply_at_us = (POKE_LATENCY_US > 0)
+                             ? (uint32_t)(esp_timer_get_time() + POKE_LATENCY_US)
+                             : POKE_APPLY_NOW;
+
+    bool sent = esp_now_broadcast_message(hub->network, &hub->poke_batch,
+                                          protocol_poke_batch_size(batch)) > 0;
 
     if (sent) {
-        hub->pokes_sent++;
-        ESP_LOGD(TAG, "Sent poke to node %d (strength=%.2f)", note->target_node, strength);
+        hub->pokes_sent += count;
+        hub->poke_frames_sent++;
+        ESP_LOGD(TAG, "Sent poke batch (%d pokes)", count);
     } else {
-        ESP_LOGW(TAG, "Failed to send poke to node %d", note->target_node);
+        ESP_LOGW(TAG, "Failed to send poke batch (%d pokes)", count);
     }
+
+    protocol_create_poke_batch(&hub->poke_batch, hub->hub_node_id);
 }
 
 void hub_process_drive_notes(hub_controller_t* hub) {
@@ -407,6 +834,8 @@ void hub_process_drive_notes(hub_controller_t* hub) {
             hub_send_midi_poke(hub, note);
         }
     }
+
+    hub_flush_pokes(hub);
 }
 
 // ============================================================================
@@ -423,12 +852,55 @@ void hub_print_status(const hub_controller_t* hub) {
     ESP_LOGI(TAG, "State: %d", hub->state);
     ESP_LOGI(TAG, "Registered nodes: %d", hub->num_registered);
     ESP_LOGI(TAG, "Active MIDI notes: %d", hub->midi.num_active);
-    ESP_LOGI(TAG, "Pokes sent: %u", (unsigned)hub->pokes_sent);
+    ESP_LOGI(TAG, "MIDI events: %u (%u dropped, %u SysEx skipped, %u overflows), max latency %lld us",
+             (unsigned)hub->midi.parser.events_parsed, (unsigned)hub->midi.parser.events_dropped,
+             (unsigned)hub->midi.parser.sysex_skipped, (unsigned)hub->midi.uart_overflows,
+             (long long)hub->midi.max_latency_us);
+    ESP_LOGI(TAG, "Pokes sent: %u (%u frames)",
+             (unsigned)hub->pokes_sent, (unsigned)hub->poke_frames_sent);
     ESP_LOGI(TAG, "Discovery attempts: %u", (unsigned)hub->discovery_attempts);
+    ESP_LOGI(TAG, "Radio: %u peers, %u duplicates dropped, %u frames for others",
+             (unsigned)hub->network->num_peers, (unsigned)hub->network->rx_duplicates,
+             (unsigned)hub->network->rx_not_for_us);
+
+    const registered_node_t* busiest = NULL;
+    uint32_t total_overruns = 0;
+    uint32_t total_underruns = 0;
+    uint32_t total_poke_drops = 0;
+    uint8_t num_loaded = 0;
 
     for (int i = 0; i < hub->num_registered; i++) {
-        registered_node_t* node = (registered_node_t*)&hub->nodes[i];
-        ESP_LOGI(TAG, "  Node %d: registered=%d configured=%d running=%d",
-                 node->node_id, node->registered, node->configured, node->running);
+        const registered_node_t* node = &hub->nodes[i];
+        ESP_LOGI(TAG, "  Node %d: registered=%d configured=%d running=%d underruns=%u late=%u",
+                 node->node_id, node->registered, node->configured, node->running,
+                 node->audio_underruns, node->audio_late_buffers);
+        ESP_LOGI(TAG, "    cpu=%u%% (control %u%%, network %u%%, audio %u%%) "
+                 "control max=%u us overruns=%u render max=%u us poke hwm=%u drops=%u received=%u",
+                 node->cpu_usage, node->control_load, node->network_load, node->audio_load,
+                 node->control_max_us, node->control_overruns, node->audio_max_render_us,
+                 node->poke_queue_hwm, node->poke_drops, node->pokes_received);
+
+        peer_rtt_t rtt;
+        if (esp_now_get_peer_rtt(hub->network, node->node_id, &rtt) && rtt.pings_sent > 0) {
+            ESP_LOGI(TAG, "    rtt p50=%u p90=%u p99=%u us (last %u us), loss %.1f%% of %u pings",
+                     (unsigned)esp_now_rtt_percentile(&rtt, 50),
+                     (unsigned)esp_now_rtt_percentile(&rtt, 90),
+                     (unsigned)esp_now_rtt_percentile(&rtt, 99),
+                     (unsigned)rtt.last_rtt_us,
+                     esp_now_rtt_loss_rate(&rtt) * 100.0f, (unsigned)(rtt.echoed + rtt.lost));
+        }
+
+        if (!busiest || node->cpu_usage > busiest->cpu_usage) busiest = node;
+        if (node->cpu_usage >= NODE_CPU_WARN_PERCENT) num_loaded++;
+        total_overruns += node->control_overruns;
+        total_underruns += node->audio_underruns;
+        total_poke_drops += node->poke_drops;
+    }
+
+    if (busiest) {
+        ESP_LOGI(TAG, "Network: busiest node %d at %u%%, %u node(s) >= %d%%, "
+                 "%u control overruns, %u audio underruns, %u poke drops",
+                 busiest->node_id, busiest->cpu_usage, num_loaded, NODE_CPU_WARN_PERCENT,
+                 (unsigned)total_overruns, (unsigned)total_underruns, (unsigned)total_poke_drops);
     }
 }
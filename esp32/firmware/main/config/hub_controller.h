@@ -17,10 +17,14 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
 #include "modal_node.h"
 #include "protocol.h"
 #include "esp_now_manager.h"
 #include "session_config.h"
+#include "midi_parser.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -30,13 +34,23 @@ extern "C" {
 // Constants
 // ============================================================================
 
-#define MAX_REGISTERED_NODES 16
+#define MAX_REGISTERED_NODES MAX_NODES_IN_SESSION
 #define MIDI_BAUD_RATE 31250
 
 // MIDI channel assignments (1-indexed like Python)
 #define MIDI_CHANNEL_TRIGGER 1  // Short poke events
 #define MIDI_CHANNEL_DRIVE 2    // Sustained pokes
 
+#define POKE_LATENCY_US ((int64_t)CONFIG_MODAL_POKE_LATENCY_MS * 1000)  // Send → apply
+
+// Configuration transfer (broadcast once, selective repeat)
+#define CFG_TX_WINDOW 4           // Chunks queued ahead of the radio
+#define CFG_ACK_TIMEOUT_MS 300    // Wait for CFG_ACKs after each CFG_END
+#define CFG_MAX_ROUNDS 5          // Initial stream + repair rounds
+#define CFG_STATUS_PENDING 0xFF   // No CFG_ACK yet this round
+
+#define NODE_CPU_WARN_PERCENT 80  // Heartbeat load flagged in status
+
 // ============================================================================
 // MIDI Note Tracking
 // ============================================================================
@@ -60,6 +74,10 @@ typedef struct {
     midi_note_t active_notes[128];  ///< Active notes (indexed by MIDI note)
     uint8_t num_active;             ///< Number of active notes
     bool initialized;               ///< UART initialized
+    QueueHandle_t uart_events;      ///< UART driver event queue
+    midi_parser_t parser;           ///< Byte stream → events
+    uint32_t uart_overflows;        ///< RX FIFO overflows (bytes lost)
+    int64_t max_latency_us;         ///< Longest byte arrival → poke queued
 } midi_input_t;
 
 // ============================================================================
@@ -76,8 +94,32 @@ typedef struct {
     bool configured;            ///< Configuration sent
     bool running;               ///< Session started
     uint32_t last_heartbeat_ms; ///< Last heartbeat timestamp
+    uint16_t audio_underruns;   ///< I2S underruns reported in the last heartbeat
+    uint16_t audio_late_buffers; ///< Late renders reported in the last heartbeat
+    uint8_t cpu_usage;          ///< Busiest core's load % (last heartbeat)
+    uint8_t control_load;       ///< Control task busy %
+    uint8_t network_load;       ///< Message handling busy %
+    uint8_t audio_load;         ///< Audio render busy %
+    uint16_t control_max_us;    ///< Longest control step since boot
+    uint16_t control_overruns;  ///< Control steps over their period (wraps)
+    uint16_t audio_max_render_us; ///< Longest render since boot
+    uint8_t poke_queue_hwm;     ///< Most pokes waiting at one control tick
+    uint16_t poke_drops;        ///< Pokes lost to a full queue (wraps)
+    uint16_t pokes_received;    ///< Pokes the node's control task took (wraps)
+    uint32_t cached_crc;        ///< Session config the node holds (HELLO, CFG_ACK OK; 0 = none)
+    uint8_t cfg_status;         ///< Last CFG_ACK status (CFG_STATUS_*) this round
+    uint8_t cfg_bitmap[CFG_CHUNK_BITMAP_BYTES]; ///< Chunks the node holds
 } registered_node_t;
 
+/**
+ * @brief Node heard during discovery, not registered yet
+ */
+typedef struct {
+    uint8_t mac_address[6];     ///< MAC address
+    uint8_t hello_id;           ///< Node ID it announced (assigned in an earlier session)
+    uint32_t config_crc;        ///< Session config it holds (0 = none)
+} discovered_node_t;
+
 /**
  * @brief Hub state machine
  */
@@ -102,9 +144,14 @@ typedef struct {
     hub_state_t state;                          ///< Current state
 
     // Node registry
-    registered_node_t nodes[MAX_REGISTERED_NODES];
+    registered_node_t nodes[MAX_REGISTERED_NODES];  ///< Indexed by node ID
     uint8_t num_registered;                     ///< Number of registered nodes
 
+    // HELLOs collected until hub_finish_discovery() (Wi-Fi task appends)
+    portMUX_TYPE discovery_lock;                ///< Guards discovered[]
+    discovered_node_t discovered[MAX_REGISTERED_NODES];
+    uint8_t num_discovered;
+
     // MIDI input
     midi_input_t midi;
 
@@ -115,8 +162,21 @@ typedef struct {
     session_manager_t session;
     bool use_default_config;                    ///< Use defaults if no config provided
 
+    // Pokes collected until hub_flush_pokes() (one broadcast frame)
+    network_message_t poke_batch;
+
+    // Configuration transfer in progress (CFG_ACKs arrive on the Wi-Fi task)
+    portMUX_TYPE cfg_lock;                      ///< Guards nodes[].cfg_*
+    uint32_t cfg_checksum;                      ///< CRC of the current transfer
+
+    // Last session distributed before this boot (NVS cache; 0 nodes = none)
+    uint32_t warm_crc;                          ///< Its configuration CRC
+    uint8_t warm_nodes;                         ///< Its node count
+
     // Statistics
     uint32_t pokes_sent;
+    uint32_t poke_frames_sent;
+    uint32_t cfg_frames_sent;                   ///< CFG_* frames in the last transfer
     uint32_t discovery_attempts;
 } hub_controller_t;
 
@@ -150,15 +210,31 @@ void hub_controller_init(hub_controller_t* hub,
  * - GPIO 16 (RX)
  * - 6N138 optocoupler isolation
  *
+ * The RX interrupt fires for every received byte, so the UART event
+ * queue wakes the MIDI task within one byte time of a note arriving.
+ *
  * @param hub Pointer to hub controller
  * @return true if successful
  */
 bool hub_midi_init(hub_controller_t* hub);
 
 /**
- * @brief Process MIDI input (call from task loop)
+ * @brief Block until MIDI bytes arrive or the timeout expires
  *
- * Reads UART buffer and processes MIDI messages.
+ * Waits on the UART event queue. An RX FIFO overflow (bytes lost)
+ * flushes the input and resets the parser.
+ *
+ * @param hub Pointer to hub controller
+ * @param timeout_ms Longest wait (milliseconds)
+ * @return true if hub_midi_process() has data to read
+ */
+bool hub_midi_wait(hub_controller_t* hub, uint32_t timeout_ms);
+
+/**
+ * @brief Process MIDI input (call after hub_midi_wait())
+ *
+ * Reads everything the UART holds, feeds it byte by byte to the parser
+ * and handles the resulting note events, then flushes the poke batch.
  *
  * @param hub Pointer to hub controller
  */
@@ -190,21 +266,69 @@ void hub_midi_note_off(hub_controller_t* hub, uint8_t note, uint8_t channel);
 /**
  * @brief Start node discovery
  *
- * Broadcasts HELLO messages and waits for responses.
+ * Broadcasts HELLO. Nodes that answer (or announced themselves at boot)
+ * are collected, not registered, until hub_finish_discovery().
  *
  * @param hub Pointer to hub controller
  * @param timeout_ms Discovery timeout (milliseconds)
  */
 void hub_start_discovery(hub_controller_t* hub, uint32_t timeout_ms);
 
+/**
+ * @brief Check whether discovery can end before its timeout
+ *
+ * True once every node of the cached session has answered and reports
+ * the cached configuration (a warm restart).
+ *
+ * @param hub Pointer to hub controller
+ * @return true if nothing is left to wait for
+ */
+bool hub_discovery_complete(const hub_controller_t* hub);
+
+/**
+ * @brief Register every node collected by discovery
+ *
+ * Node IDs follow MAC order (after the nodes already registered), so the
+ * same set of nodes gets the same IDs every boot. Peers are added in one
+ * pass, then the assignments go out as broadcast OFFERs.
+ *
+ * @param hub Pointer to hub controller
+ * @return Number of nodes registered
+ */
+uint8_t hub_finish_discovery(hub_controller_t* hub);
+
 /**
  * @brief Handle HELLO message from node
  *
+ * Until discovery finishes, new nodes are only collected. Later ones are
+ * registered on arrival with the next free ID. A node already registered
+ * (same MAC) is sent its assignment again; one that rebooted into the
+ * running session is restarted right away.
+ *
  * @param hub Pointer to hub controller
  * @param msg HELLO message
  */
 void hub_handle_hello(hub_controller_t* hub, const msg_hello_t* msg);
 
+/**
+ * @brief Record a node's health and task timing from its HEARTBEAT
+ *
+ * Logs a warning when the node reports new audio underruns or control
+ * step overruns.
+ *
+ * @param hub Pointer to hub controller
+ * @param msg HEARTBEAT message
+ */
+void hub_handle_heartbeat(hub_controller_t* hub, const msg_heartbeat_t* msg);
+
+/**
+ * @brief Record a node's CFG_ACK for the transfer in progress
+ *
+ * @param hub Pointer to hub controller
+ * @param msg CFG_ACK message
+ */
+void hub_handle_cfg_ack(hub_controller_t* hub, const msg_cfg_ack_t* msg);
+
 /**
  * @brief Register a node
  *
@@ -240,9 +364,19 @@ bool hub_send_default_config(hub_controller_t* hub);
 /**
  * @brief Send custom configuration to all nodes
  *
+ * Broadcasts the chunks once to every node, keeping CFG_TX_WINDOW frames
+ * queued ahead of the radio, then ends with CFG_END. Each node answers
+ * with the bitmap of chunks it holds; the next round rebroadcasts only
+ * the chunks some node is missing. Repeats for up to CFG_MAX_ROUNDS.
+ *
+ * Nodes whose HELLO reported this configuration's CRC count as
+ * configured without a transfer; if that is all of them, nothing is
+ * sent. A fully acknowledged configuration is cached in NVS for the
+ * next boot's discovery.
+ *
  * @param hub Pointer to hub controller
  * @param config Session configuration
- * @return true if successful
+ * @return true if every registered node acknowledged the configuration
  */
 bool hub_send_config(hub_controller_t* hub, const session_config_t* config);
 
@@ -270,16 +404,29 @@ void hub_stop_session(hub_controller_t* hub);
 // ============================================================================
 
 /**
- * @brief Send poke to target node based on MIDI note
+ * @brief Queue poke to target node based on MIDI note
  *
  * Channel 1: Short trigger poke (10ms envelope)
  * Channel 2: Sustained poke (sent every 100ms while note held)
  *
+ * The poke is added to the pending POKE_BATCH, which is sent when full
+ * or on hub_flush_pokes().
+ *
  * @param hub Pointer to hub controller
  * @param note MIDI note
  */
 void hub_send_midi_poke(hub_controller_t* hub, const midi_note_t* note);
 
+/**
+ * @brief Broadcast the pending POKE_BATCH (no-op when empty)
+ *
+ * hub_midi_process() and hub_process_drive_notes() flush before
+ * returning, so pokes never wait longer than one call.
+ *
+ * @param hub Pointer to hub controller
+ */
+void hub_flush_pokes(hub_controller_t* hub);
+
 /**
  * @brief Process active drive notes (channel 2)
  *
@@ -306,6 +453,9 @@ uint8_t hub_note_to_node(uint8_t note, uint8_t num_nodes);
 /**
  * @brief Print hub status
  *
+ * Includes each node's last heartbeat telemetry and the network-wide
+ * worst case (busiest node, total overruns and underruns).
+ *
  * @param hub Pointer to hub controller
  */
 void hub_print_status(const hub_controller_t* hub);
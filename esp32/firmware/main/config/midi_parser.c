@@ -0,0 +1,113 @@
+/**
+ * @file midi_parser.c
+ * @brief Byte-at-a-time MIDI stream parser with a timestamped event queue
+ */
+
+#include "midi_parser.h"
+#include <string.h>
+
+// Data bytes following a channel status (0x80-0xEF)
+static uint8_t channel_data_length(uint8_t status) {
+    uint8_t cmd = status & 0xF0;
+    return (cmd == 0xC0 || cmd == 0xD0) ? 1 : 2;  // Program change, channel pressure
+}
+
+// Data bytes following a system common status (0xF1-0xF6)
+static uint8_t common_data_length(uint8_t status) {
+    switch (status) {
+        case 0xF1: return 1;  // MTC quarter frame
+        case 0xF2: return 2;  // Song position
+        case 0xF3: return 1;  // Song select
+        default:   return 0;  // Tune request, undefined
+    }
+}
+
+void midi_parser_init(midi_parser_t* parser) {
+    memset(parser, 0, sizeof(midi_parser_t));
+}
+
+void midi_parser_reset(midi_parser_t* parser) {
+    parser->running_status = 0;
+    parser->data_count = 0;
+    parser->skip_count = 0;
+    parser->in_sysex = false;
+    parser->message_started = false;
+}
+
+static void push_event(midi_parser_t* parser) {
+    uint8_t next = (parser->head + 1) & (MIDI_EVENT_QUEUE_SIZE - 1);
+    if (next == parser->tail) {
+        parser->events_dropped++;
+        return;
+    }
+
+    midi_event_t* event = &parser->events[parser->head];
+    event->timestamp_us = parser->message_us;
+    event->status = parser->running_status;
+    event->data1 = parser->data[0];
+    event->data2 = (parser->data_count > 1) ? parser->data[1] : 0;
+
+    parser->head = next;
+    parser->events_parsed++;
+}
+
+void midi_parser_feed(midi_parser_t* parser, uint8_t byte, int64_t timestamp_us) {
+    // Real-time: single byte, allowed anywhere, changes nothing
+    if (byte >= MIDI_STATUS_REALTIME) return;
+
+    if (byte & 0x80) {
+        // Any other status byte ends SysEx and abandons a partial message
+        parser->in_sysex = false;
+        parser->data_count = 0;
+        parser->skip_count = 0;
+        parser->message_us = timestamp_us;
+        parser->message_started = true;
+
+        if (byte < MIDI_STATUS_SYSEX) {
+            parser->running_status = byte;
+        } else {
+            parser->running_status = 0;
+            if (byte == MIDI_STATUS_SYSEX) {
+                parser->in_sysex = true;
+                parser->sysex_skipped++;
+            } else {
+                parser->skip_count = common_data_length(byte);
+            }
+        }
+        return;
+    }
+
+    // Data byte
+    if (parser->in_sysex) return;
+
+    if (parser->skip_count > 0) {
+        parser->skip_count--;
+        return;
+    }
+
+    if (parser->running_status == 0) {
+        parser->stray_bytes++;
+        return;
+    }
+
+    // Under running status the first data byte starts the message
+    if (!parser->message_started) {
+        parser->message_us = timestamp_us;
+        parser->message_started = true;
+    }
+
+    parser->data[parser->data_count++] = byte;
+    if (parser->data_count == channel_data_length(parser->running_status)) {
+        push_event(parser);
+        parser->data_count = 0;
+        parser->message_started = false;
+    }
+}
+
+bool midi_parser_pop(midi_parser_t* parser, midi_event_t* event) {
+    if (parser->tail == parser->head) return false;
+
+    *event = parser->events[parser->tail];
+    parser->tail = (parser->tail + 1) & (MIDI_EVENT_QUEUE_SIZE - 1);
+    return true;
+}
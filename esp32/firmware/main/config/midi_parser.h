@@ -0,0 +1,121 @@
+/**
+ * @file midi_parser.h
+ * @brief Byte-at-a-time MIDI stream parser with a timestamped event queue
+ *
+ * Bytes are fed as the UART delivers them, in any grouping. Channel
+ * messages complete into midi_event_t entries in a ring buffer that the
+ * hub drains after each read. Handles the parts of the byte stream a
+ * fixed 3-byte read cannot:
+ * - Running status: data bytes without a status byte reuse the last
+ *   channel status (keyboards send chords this way)
+ * - Real-time bytes (0xF8-0xFF, e.g. clock, active sensing) may appear
+ *   anywhere, even mid-message, and are skipped without disturbing it
+ * - SysEx (0xF0 ... 0xF7) and system common data are skipped; both
+ *   cancel running status, as the MIDI spec requires
+ */
+
+#ifndef MIDI_PARSER_H
+#define MIDI_PARSER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define MIDI_EVENT_QUEUE_SIZE 64  // Power of 2
+
+#define MIDI_STATUS_NOTE_OFF 0x80
+#define MIDI_STATUS_NOTE_ON 0x90
+#define MIDI_STATUS_SYSEX 0xF0
+#define MIDI_STATUS_SYSEX_END 0xF7
+#define MIDI_STATUS_REALTIME 0xF8  // 0xF8-0xFF
+
+// ============================================================================
+// Type Definitions
+// ============================================================================
+
+/**
+ * @brief One complete channel message
+ */
+typedef struct {
+    int64_t timestamp_us;  ///< Arrival of the message's first byte
+    uint8_t status;        ///< Command | channel (0x80-0xEF)
+    uint8_t data1;         ///< First data byte (note, controller, ...)
+    uint8_t data2;         ///< Second data byte (0 for 1-byte messages)
+} midi_event_t;
+
+/**
+ * @brief Parser state and event queue
+ */
+typedef struct {
+    // Message assembly
+    uint8_t running_status;  ///< Current channel status (0 = none)
+    uint8_t data[2];         ///< Data bytes collected so far
+    uint8_t data_count;      ///< Bytes in data[]
+    uint8_t skip_count;      ///< System common data bytes left to skip
+    bool in_sysex;           ///< Inside SysEx until a status byte
+    int64_t message_us;      ///< Timestamp of the message in progress
+    bool message_started;    ///< message_us is set
+
+    // Event ring (single producer and consumer: the MIDI task)
+    midi_event_t events[MIDI_EVENT_QUEUE_SIZE];
+    uint8_t head;            ///< Next write
+    uint8_t tail;            ///< Next read
+
+    // Statistics
+    uint32_t events_parsed;  ///< Channel messages completed
+    uint32_t events_dropped; ///< Lost to a full queue
+    uint32_t sysex_skipped;  ///< SysEx messages skipped
+    uint32_t stray_bytes;    ///< Data bytes with no status to apply to
+} midi_parser_t;
+
+// ============================================================================
+// API
+// ============================================================================
+
+/**
+ * @brief Initialize parser with an empty queue
+ *
+ * @param parser Parser to initialize
+ */
+void midi_parser_init(midi_parser_t* parser);
+
+/**
+ * @brief Drop any partial message and running status (queue is kept)
+ *
+ * Call after bytes were lost (UART FIFO overflow), so the next data
+ * bytes are not misread as part of an older message.
+ *
+ * @param parser Parser
+ */
+void midi_parser_reset(midi_parser_t* parser);
+
+/**
+ * @brief Feed one received byte
+ *
+ * @param parser Parser
+ * @param byte Byte from the MIDI stream
+ * @param timestamp_us Time the byte was received
+ */
+void midi_parser_feed(midi_parser_t* parser, uint8_t byte, int64_t timestamp_us);
+
+/**
+ * @brief Take the oldest complete event
+ *
+ * @param parser Parser
+ * @param event Output event
+ * @return true if an event was returned
+ */
+bool midi_parser_pop(midi_parser_t* parser, midi_event_t* event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MIDI_PARSER_H
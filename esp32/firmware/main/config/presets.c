@@ -53,8 +53,7 @@ static void get_default_modes(float omega[4], float gamma[4], float weight[4]) {
 // Ring Topology (16 nodes)
 // ============================================================================
 
-void preset_ring_16_resonator(session_manager_t* mgr) {
-    session_config_t* config = &mgr->config;
+void preset_ring_16_resonator(session_config_t* config) {
 
     strncpy(config->session_id, "ring_16_resonator", MAX_SESSION_ID_LEN);
     config->topology = TOPOLOGY_RING;
@@ -95,8 +94,7 @@ void preset_ring_16_resonator(session_manager_t* mgr) {
 // Small-World Topology (8 nodes)
 // ============================================================================
 
-void preset_small_world_8_oscillator(session_manager_t* mgr) {
-    session_config_t* config = &mgr->config;
+void preset_small_world_8_oscillator(session_config_t* config) {
 
     strncpy(config->session_id, "small_world_8", MAX_SESSION_ID_LEN);
     config->topology = TOPOLOGY_SMALL_WORLD;
@@ -135,8 +133,7 @@ void preset_small_world_8_oscillator(session_manager_t* mgr) {
 // Cluster Topology (16 nodes, 2 clusters)
 // ============================================================================
 
-void preset_clusters_16(session_manager_t* mgr) {
-    session_config_t* config = &mgr->config;
+void preset_clusters_16(session_config_t* config) {
 
     strncpy(config->session_id, "clusters_16", MAX_SESSION_ID_LEN);
     config->topology = TOPOLOGY_CLUSTERS;
@@ -165,7 +162,7 @@ void preset_clusters_16(session_manager_t* mgr) {
 
         // Intra-cluster connections (strong)
         node->num_neighbors = 3;
-        node->neighbors[0] = cluster_start + ((i - 1) % 8);  // Left in cluster
+        node->neighbors[0] = cluster_start + ((i + 7) % 8);  // Left in cluster
         node->neighbors[1] = cluster_start + ((i + 1) % 8);  // Right in cluster
 
         // Inter-cluster bridge (weak, only from node 3 and 11)
@@ -179,15 +176,50 @@ void preset_clusters_16(session_manager_t* mgr) {
 
         node->carrier_freq_hz = 440.0f + cluster * 220.0f;  // Cluster frequency offset
         node->audio_gain = 0.7f;
+        node->group = cluster;
+        node->relay = false;
     }
 }
 
+// ============================================================================
+// Cluster Topology (64 nodes, 8 clusters)
+// ============================================================================
+
+void preset_clusters_64(session_config_t* config) {
+
+    strncpy(config->session_id, "clusters_64", MAX_SESSION_ID_LEN);
+    config->global_coupling = 0.25f;
+    config->control_rate_hz = 500;
+
+    // Default modes
+    float omega[4], gamma[4], weight[4];
+    get_default_modes(omega, gamma, weight);
+
+    for (uint8_t i = 0; i < 64; i++) {
+        node_config_t* node = &config->nodes[i];
+
+        node->node_id = i;
+        node->personality = PERSONALITY_RESONATOR;
+
+        memcpy(node->omega, omega, sizeof(omega));
+        memcpy(node->gamma, gamma, sizeof(gamma));
+        memcpy(node->weight, weight, sizeof(weight));
+
+        node->coupling_strength = config->global_coupling;
+        node->carrier_freq_hz = 440.0f;
+        node->audio_gain = 0.7f;
+        node->relay = false;
+    }
+
+    // Rings of 8 bridged in a chain; one radio group per cluster
+    topology_generate_clusters(config, 64, 8);
+}
+
 // ============================================================================
 // Hub-Spoke Topology (16 nodes, hub = node 0)
 // ============================================================================
 
-static void preset_hub_spoke_16(session_manager_t* mgr) {
-    session_config_t* config = &mgr->config;
+void preset_hub_spoke_16(session_config_t* config) {
 
     strncpy(config->session_id, "hub_spoke_16", MAX_SESSION_ID_LEN);
     config->topology = TOPOLOGY_HUB_SPOKE;
@@ -207,8 +239,8 @@ static void preset_hub_spoke_16(session_manager_t* mgr) {
     memcpy(hub->gamma, gamma, sizeof(gamma));
     memcpy(hub->weight, weight, sizeof(weight));
 
-    // Hub connects to all spokes
-    hub->num_neighbors = config->num_nodes - 1;
+    // Hub connects to as many spokes as it has neighbor slots
+    hub->num_neighbors = (config->num_nodes - 1 > MAX_NEIGHBORS) ? MAX_NEIGHBORS : config->num_nodes - 1;
     for (uint8_t i = 0; i < hub->num_neighbors; i++) {
         hub->neighbors[i] = i + 1;
     }
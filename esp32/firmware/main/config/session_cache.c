@@ -0,0 +1,135 @@
+/**
+ * @file session_cache.c
+ * @brief Last accepted session configuration, persisted in NVS
+ */
+
+#include "session_cache.h"
+#include "session_config.h"
+#include "protocol.h"
+#include "nvs.h"
+#include "esp_log.h"
+
+#define TAG "SESSION_CACHE"
+
+#define KEY_BLOB "blob"
+#define KEY_CRC "crc"
+#define KEY_NODES "nodes"
+#define KEY_NODE_ID "node_id"
+
+bool session_cache_load(uint8_t* data, size_t max_len, size_t* len, uint32_t* crc) {
+    if (!data || !len || !crc) return false;
+
+    nvs_handle_t handle;
+    if (nvs_open(SESSION_CACHE_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) return false;
+
+    size_t blob_len = max_len;
+    uint32_t stored_crc = 0;
+    bool ok = nvs_get_u32(handle, KEY_CRC, &stored_crc) == ESP_OK &&
+              nvs_get_blob(handle, KEY_BLOB, data, &blob_len) == ESP_OK;
+    nvs_close(handle);
+
+    if (!ok) return false;
+
+    if (protocol_crc32(data, blob_len) != stored_crc) {
+        ESP_LOGW(TAG, "Cached session fails its CRC, ignoring");
+        return false;
+    }
+
+    *len = blob_len;
+    *crc = stored_crc;
+    return true;
+}
+
+bool session_cache_info(uint32_t* crc, uint8_t* num_nodes) {
+    if (!crc || !num_nodes) return false;
+
+    nvs_handle_t handle;
+    if (nvs_open(SESSION_CACHE_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) return false;
+
+    bool ok = nvs_get_u32(handle, KEY_CRC, crc) == ESP_OK &&
+              nvs_get_u8(handle, KEY_NODES, num_nodes) == ESP_OK;
+    nvs_close(handle);
+
+    return ok;
+}
+
+bool session_cache_store(const uint8_t* data, size_t len, uint32_t crc) {
+    if (!data || len < sizeof(session_blob_header_t)) return false;
+
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(SESSION_CACHE_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "nvs_open failed: %s", esp_err_to_name(err));
+        return false;
+    }
+
+    // Flash wears: only rewrite for a different session
+    uint32_t cached_crc;
+    if (nvs_get_u32(handle, KEY_CRC, &cached_crc) == ESP_OK && cached_crc == crc) {
+        nvs_close(handle);
+        return true;
+    }
+
+    const session_blob_header_t* header = (const session_blob_header_t*)data;
+    err = nvs_set_blob(handle, KEY_BLOB, data, len);
+    if (err == ESP_OK) err = nvs_set_u32(handle, KEY_CRC, crc);
+    if (err == ESP_OK) err = nvs_set_u8(handle, KEY_NODES, header->num_nodes);
+    if (err == ESP_OK) err = nvs_commit(handle);
+    nvs_close(handle);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to cache session: %s", esp_err_to_name(err));
+        return false;
+    }
+
+    ESP_LOGI(TAG, "Cached session: %u bytes, crc=0x%08X", (unsigned)len, (unsigned)crc);
+    return true;
+}
+
+bool session_cache_node_id(uint8_t* node_id) {
+    if (!node_id) return false;
+
+    nvs_handle_t handle;
+    if (nvs_open(SESSION_CACHE_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) return false;
+
+    bool ok = nvs_get_u8(handle, KEY_NODE_ID, node_id) == ESP_OK;
+    nvs_close(handle);
+
+    return ok;
+}
+
+bool session_cache_store_node_id(uint8_t node_id) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(SESSION_CACHE_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "nvs_open failed: %s", esp_err_to_name(err));
+        return false;
+    }
+
+    uint8_t cached_id;
+    if (nvs_get_u8(handle, KEY_NODE_ID, &cached_id) == ESP_OK && cached_id == node_id) {
+        nvs_close(handle);
+        return true;
+    }
+
+    err = nvs_set_u8(handle, KEY_NODE_ID, node_id);
+    if (err == ESP_OK) err = nvs_commit(handle);
+    nvs_close(handle);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to cache node ID: %s", esp_err_to_name(err));
+        return false;
+    }
+
+    ESP_LOGI(TAG, "Cached node ID %d", node_id);
+    return true;
+}
+
+void session_cache_clear(void) {
+    nvs_handle_t handle;
+    if (nvs_open(SESSION_CACHE_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) return;
+
+    nvs_erase_all(handle);
+    nvs_commit(handle);
+    nvs_close(handle);
+}
@@ -0,0 +1,97 @@
+/**
+ * @file session_cache.h
+ * @brief Last accepted session configuration, persisted in NVS
+ *
+ * Nodes keep the compact blob they last applied and its transfer CRC,
+ * apply it at boot and advertise the CRC in their HELLO; the hub skips
+ * the transfer to nodes that already hold the configuration it is about
+ * to send. The hub caches the same record for its last distributed
+ * session, which tells discovery how many nodes to wait for.
+ *
+ * Nodes also keep the node ID the hub assigned them, so the cached
+ * configuration is applied under the same ID after a reboot.
+ *
+ * NVS writes stall flash access on both cores for several ms: store
+ * from a task outside the audio path, not from the Wi-Fi callback.
+ */
+
+#ifndef SESSION_CACHE_H
+#define SESSION_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define SESSION_CACHE_NAMESPACE "session"
+
+// ============================================================================
+// API
+// ============================================================================
+
+/**
+ * @brief Load the cached blob (requires nvs_flash_init())
+ *
+ * The blob is checked against its stored CRC, so a torn write reads as
+ * no cache.
+ *
+ * @param data Output buffer
+ * @param max_len Buffer size (SESSION_BLOB_MAX_SIZE)
+ * @param len Output: blob length
+ * @param crc Output: CRC32 of the blob (the CFG_BEGIN checksum)
+ * @return true if a valid blob was loaded
+ */
+bool session_cache_load(uint8_t* data, size_t max_len, size_t* len, uint32_t* crc);
+
+/**
+ * @brief Cached CRC and node count, without reading the blob
+ *
+ * @param crc Output: CRC32 of the cached blob
+ * @param num_nodes Output: nodes in the cached session
+ * @return true if a cache exists
+ */
+bool session_cache_info(uint32_t* crc, uint8_t* num_nodes);
+
+/**
+ * @brief Replace the cache (no-op if crc is already cached)
+ *
+ * @param data Compact session blob
+ * @param len Blob length
+ * @param crc CRC32 of the blob
+ * @return true if the cache holds this blob afterwards
+ */
+bool session_cache_store(const uint8_t* data, size_t len, uint32_t crc);
+
+/**
+ * @brief Node ID assigned by the hub in an earlier session
+ *
+ * @param node_id Output: cached node ID
+ * @return true if one is cached
+ */
+bool session_cache_node_id(uint8_t* node_id);
+
+/**
+ * @brief Remember the assigned node ID (no-op if unchanged)
+ *
+ * @param node_id Node ID
+ * @return true if the cache holds this ID afterwards
+ */
+bool session_cache_store_node_id(uint8_t node_id);
+
+/**
+ * @brief Forget the cached session (and node ID)
+ */
+void session_cache_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SESSION_CACHE_H
@@ -1,12 +1,13 @@
 /**
  * @file session_config.c
- * @brief Session configuration management (stub implementation)
+ * @brief Session configuration management
  *
- * TODO: Full implementation in Phase 3
- * This stub provides basic initialization
+ * Compact binary serialization and per-node apply; JSON loading and
+ * session timing are still stubs (TODO: Phase 3).
  */
 
 #include "session_config.h"
+#include "protocol.h"
 #include <string.h>
 
 // ============================================================================
@@ -23,7 +24,7 @@ void session_manager_init(session_manager_t* mgr, uint8_t my_node_id) {
 }
 
 // ============================================================================
-// Configuration Loading (Stubs)
+// Configuration Loading
 // ============================================================================
 
 bool session_load_config_json(session_manager_t* mgr, const char* json_str) {
@@ -31,70 +32,369 @@ bool session_load_config_json(session_manager_t* mgr, const char* json_str) {
     return false;
 }
 
+// ============================================================================
+// Compact Binary Format
+// ============================================================================
+
+#define FIELD_PERSONALITY 0x01
+#define FIELD_COUPLING 0x02
+#define FIELD_CARRIER 0x04
+#define FIELD_GAIN 0x08
+#define FIELD_GROUP 0x10  // group u8, relay u8
+#define FIELD_ALL 0x1F
+
+#define MODE_PARAMS 3  // omega, gamma, weight
+#define MODE_MASK_ALL ((1u << (MODE_PARAMS * MAX_MODES)) - 1)
+
+_Static_assert(SESSION_BLOB_MAX_SIZE <= CFG_MAX_CHUNKS * CFG_CHUNK_DATA_SIZE,
+               "A full session must fit one CFG transfer");
+
+// Mode parameter by index (param * MAX_MODES + mode)
+static float* mode_param(node_config_t* node, uint8_t index) {
+    uint8_t mode = index % MAX_MODES;
+    switch (index / MAX_MODES) {
+        case 0:  return &node->omega[mode];
+        case 1:  return &node->gamma[mode];
+        default: return &node->weight[mode];
+    }
+}
+
+static bool same_float(float a, float b) {
+    return memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+/**
+ * @brief Most common value of one float field across nodes
+ */
+static float common_float(const session_config_t* config, float (*get)(const node_config_t*, uint8_t),
+                          uint8_t index) {
+    float best = get(&config->nodes[0], index);
+    uint8_t best_count = 0;
+
+    for (uint8_t i = 0; i < config->num_nodes; i++) {
+        float value = get(&config->nodes[i], index);
+        uint8_t count = 0;
+        for (uint8_t j = 0; j < config->num_nodes; j++) {
+            if (same_float(get(&config->nodes[j], index), value)) count++;
+        }
+        if (count > best_count) {
+            best = value;
+            best_count = count;
+        }
+    }
+
+    return best;
+}
+
+static float get_mode_param(const node_config_t* node, uint8_t index) {
+    return *mode_param((node_config_t*)node, index);
+}
+
+static float get_scalar(const node_config_t* node, uint8_t field) {
+    switch (field) {
+        case FIELD_COUPLING: return node->coupling_strength;
+        case FIELD_CARRIER:  return node->carrier_freq_hz;
+        default:             return node->audio_gain;
+    }
+}
+
+static bool same_group(const node_config_t* a, const node_config_t* b) {
+    return a->group == b->group && a->relay == b->relay;
+}
+
+static float* scalar_field(node_config_t* node, uint8_t field) {
+    switch (field) {
+        case FIELD_COUPLING: return &node->coupling_strength;
+        case FIELD_CARRIER:  return &node->carrier_freq_hz;
+        default:             return &node->audio_gain;
+    }
+}
+
+/**
+ * @brief Shared defaults: per field, the value most nodes use
+ */
+static void build_defaults(const session_config_t* config, node_config_t* defaults) {
+    memset(defaults, 0, sizeof(node_config_t));
+
+    uint8_t oscillators = 0;
+    for (uint8_t i = 0; i < config->num_nodes; i++) {
+        if (config->nodes[i].personality == PERSONALITY_SELF_OSCILLATOR) oscillators++;
+    }
+    defaults->personality = (oscillators * 2 > config->num_nodes) ?
+                            PERSONALITY_SELF_OSCILLATOR : PERSONALITY_RESONATOR;
+
+    for (uint8_t field = FIELD_COUPLING; field <= FIELD_GAIN; field <<= 1) {
+        *scalar_field(defaults, field) = common_float(config, get_scalar, field);
+    }
+    for (uint8_t index = 0; index < MODE_PARAMS * MAX_MODES; index++) {
+        *mode_param(defaults, index) = common_float(config, get_mode_param, index);
+    }
+
+    // Group and relay travel together
+    uint8_t best_count = 0;
+    for (uint8_t i = 0; i < config->num_nodes; i++) {
+        uint8_t count = 0;
+        for (uint8_t j = 0; j < config->num_nodes; j++) {
+            if (same_group(&config->nodes[i], &config->nodes[j])) count++;
+        }
+        if (count > best_count) {
+            defaults->group = config->nodes[i].group;
+            defaults->relay = config->nodes[i].relay;
+            best_count = count;
+        }
+    }
+}
+
+/**
+ * @brief Write a node's differences from the defaults
+ *
+ * @return Bytes written (at most SESSION_SECTION_MAX_SIZE), or 0 if out of space
+ */
+static size_t write_section(const node_config_t* node, const node_config_t* defaults,
+                            uint8_t* out, size_t space) {
+    if (space < SESSION_SECTION_MAX_SIZE) return 0;
+
+    uint8_t fields = 0;
+    if (node->personality != defaults->personality) fields |= FIELD_PERSONALITY;
+    for (uint8_t field = FIELD_COUPLING; field <= FIELD_GAIN; field <<= 1) {
+        if (!same_float(get_scalar(node, field), get_scalar(defaults, field))) fields |= field;
+    }
+    if (!same_group(node, defaults)) fields |= FIELD_GROUP;
+
+    uint16_t modes = 0;
+    for (uint8_t index = 0; index < MODE_PARAMS * MAX_MODES; index++) {
+        if (!same_float(get_mode_param(node, index), get_mode_param(defaults, index))) {
+            modes |= 1u << index;
+        }
+    }
+
+    size_t pos = 0;
+    out[pos++] = fields;
+    memcpy(out + pos, &modes, 2);
+    pos += 2;
+
+    if (fields & FIELD_PERSONALITY) out[pos++] = (uint8_t)node->personality;
+    for (uint8_t field = FIELD_COUPLING; field <= FIELD_GAIN; field <<= 1) {
+        if (!(fields & field)) continue;
+        float value = get_scalar(node, field);
+        memcpy(out + pos, &value, 4);
+        pos += 4;
+    }
+    if (fields & FIELD_GROUP) {
+        out[pos++] = node->group;
+        out[pos++] = node->relay ? 1 : 0;
+    }
+    for (uint8_t index = 0; index < MODE_PARAMS * MAX_MODES; index++) {
+        if (!(modes & (1u << index))) continue;
+        float value = get_mode_param(node, index);
+        memcpy(out + pos, &value, 4);
+        pos += 4;
+    }
+
+    uint8_t num_neighbors = (node->num_neighbors > MAX_NEIGHBORS) ? MAX_NEIGHBORS : node->num_neighbors;
+    out[pos++] = num_neighbors;
+    memcpy(out + pos, node->neighbors, num_neighbors);
+    pos += num_neighbors;
+
+    return pos;
+}
+
+/**
+ * @brief Apply one section on top of node
+ *
+ * @return Bytes consumed, or 0 if the section is malformed or runs past len
+ */
+static size_t read_section(const uint8_t* data, size_t len, node_config_t* node) {
+    if (len < 3) return 0;
+
+    uint8_t fields = data[0];
+    uint16_t modes;
+    memcpy(&modes, data + 1, 2);
+    if ((fields & ~FIELD_ALL) || (modes & ~MODE_MASK_ALL)) return 0;
+
+    size_t pos = 3;
+    if (fields & FIELD_PERSONALITY) {
+        if (pos >= len || data[pos] > PERSONALITY_SELF_OSCILLATOR) return 0;
+        node->personality = (node_personality_t)data[pos++];
+    }
+    for (uint8_t field = FIELD_COUPLING; field <= FIELD_GAIN; field <<= 1) {
+        if (!(fields & field)) continue;
+        if (pos + 4 > len) return 0;
+        memcpy(scalar_field(node, field), data + pos, 4);
+        pos += 4;
+    }
+    if (fields & FIELD_GROUP) {
+        if (pos + 2 > len || data[pos + 1] > 1) return 0;
+        node->group = data[pos];
+        node->relay = data[pos + 1] != 0;
+        pos += 2;
+    }
+    for (uint8_t index = 0; index < MODE_PARAMS * MAX_MODES; index++) {
+        if (!(modes & (1u << index))) continue;
+        if (pos + 4 > len) return 0;
+        memcpy(mode_param(node, index), data + pos, 4);
+        pos += 4;
+    }
+
+    if (pos >= len || data[pos] > MAX_NEIGHBORS) return 0;
+    uint8_t num_neighbors = data[pos++];
+    if (pos + num_neighbors > len) return 0;
+    memcpy(node->neighbors, data + pos, num_neighbors);
+    node->num_neighbors = num_neighbors;
+    pos += num_neighbors;
+
+    return pos;
+}
+
+static size_t defaults_offset(const session_blob_header_t* header) {
+    return sizeof(session_blob_header_t) + header->id_len;
+}
+
 bool session_load_config_binary(session_manager_t* mgr,
                                const uint8_t* data,
                                size_t len) {
     if (!mgr || !data) return false;
+    if (len < sizeof(session_blob_header_t) || len > SESSION_BLOB_MAX_SIZE) return false;
 
-    // Binary format is just a direct memory copy of session_config_t
-    // This is simple but not portable across architectures
-    if (len != sizeof(session_config_t)) {
+    const session_blob_header_t* header = (const session_blob_header_t*)data;
+    if (header->magic != SESSION_BLOB_MAGIC || header->version != SESSION_BLOB_VERSION) {
         return false;
     }
+    if (header->num_nodes > MAX_NODES_IN_SESSION || header->id_len >= MAX_SESSION_ID_LEN) {
+        return false;
+    }
+
+    // Defaults must be complete
+    node_config_t scratch;
+    size_t pos = defaults_offset(header);
+    if (pos + 3 > len || data[pos] != FIELD_ALL) return false;
+    uint16_t modes;
+    memcpy(&modes, data + pos + 1, 2);
+    if (modes != MODE_MASK_ALL) return false;
+
+    size_t consumed = read_section(data + pos, len - pos, &scratch);
+    if (consumed == 0) return false;
+    pos += consumed;
+
+    // Every indexed section must decode inside the blob
+    size_t index = pos;
+    if (index + (size_t)header->num_nodes * SESSION_INDEX_ENTRY_SIZE > len) return false;
+
+    uint16_t my_section = 0;
+    for (uint8_t i = 0; i < header->num_nodes; i++) {
+        const uint8_t* entry = data + index + i * SESSION_INDEX_ENTRY_SIZE;
+        uint16_t offset;
+        memcpy(&offset, entry + 1, 2);
+        if (offset >= len || read_section(data + offset, len - offset, &scratch) == 0) {
+            return false;
+        }
+        if (entry[0] == mgr->my_node_id) my_section = offset;
+    }
+    if (my_section == 0) return false;  // Offset 0 is the header
 
-    memcpy(&mgr->config, data, sizeof(session_config_t));
+    mgr->blob = data;
+    mgr->blob_len = (uint16_t)len;
+    mgr->my_section = my_section;
     mgr->state = SESSION_STATE_READY;
 
     return true;
 }
 
-size_t session_serialize_config_binary(const session_manager_t* mgr,
+size_t session_serialize_config_binary(const session_config_t* config,
                                        uint8_t* data,
                                        size_t max_len) {
-    if (!mgr || !data) return 0;
-
-    size_t required_size = sizeof(session_config_t);
-    if (max_len < required_size) {
-        return 0;
+    if (!config || !data || config->num_nodes > MAX_NODES_IN_SESSION) return 0;
+
+    size_t id_len = strnlen(config->session_id, MAX_SESSION_ID_LEN - 1);
+    size_t pos = sizeof(session_blob_header_t) + id_len;
+    if (max_len < pos) return 0;
+
+    session_blob_header_t header = {
+        .magic = SESSION_BLOB_MAGIC,
+        .version = SESSION_BLOB_VERSION,
+        .num_nodes = config->num_nodes,
+        .topology = (uint8_t)config->topology,
+        .auto_restart = config->auto_restart ? 1 : 0,
+        .control_rate_hz = config->control_rate_hz,
+        .max_duration_ms = config->max_duration_ms,
+        .global_coupling = config->global_coupling,
+        .id_len = (uint8_t)id_len
+    };
+    memcpy(data, &header, sizeof(header));
+    memcpy(data + sizeof(header), config->session_id, id_len);
+
+    // Defaults: every field, no neighbors
+    node_config_t defaults;
+    build_defaults(config, &defaults);
+    node_config_t empty;
+    memset(&empty, 0, sizeof(empty));
+    empty.personality = (defaults.personality == PERSONALITY_RESONATOR) ?
+                        PERSONALITY_SELF_OSCILLATOR : PERSONALITY_RESONATOR;
+    for (uint8_t field = FIELD_COUPLING; field <= FIELD_GAIN; field <<= 1) {
+        *scalar_field(&empty, field) = get_scalar(&defaults, field) + 1.0f;
+    }
+    for (uint8_t index = 0; index < MODE_PARAMS * MAX_MODES; index++) {
+        *mode_param(&empty, index) = get_mode_param(&defaults, index) + 1.0f;
+    }
+    empty.relay = !defaults.relay;
+    size_t written = write_section(&defaults, &empty, data + pos, max_len - pos);
+    if (written == 0) return 0;
+    pos += written;
+
+    size_t index = pos;
+    pos += (size_t)config->num_nodes * SESSION_INDEX_ENTRY_SIZE;
+    if (pos > max_len) return 0;
+
+    for (uint8_t i = 0; i < config->num_nodes; i++) {
+        uint8_t* entry = data + index + i * SESSION_INDEX_ENTRY_SIZE;
+        uint16_t offset = (uint16_t)pos;
+        entry[0] = config->nodes[i].node_id;
+        memcpy(entry + 1, &offset, 2);
+
+        written = write_section(&config->nodes[i], &defaults, data + pos, max_len - pos);
+        if (written == 0) return 0;
+        pos += written;
     }
 
-    memcpy(data, &mgr->config, required_size);
-    return required_size;
+    return pos;
 }
 
-const node_config_t* session_get_my_config(const session_manager_t* mgr) {
-    if (!mgr || mgr->state < SESSION_STATE_READY) {
-        return NULL;
+bool session_get_my_config(const session_manager_t* mgr, node_config_t* config) {
+    if (!mgr || !config || !mgr->blob || mgr->state < SESSION_STATE_READY) {
+        return false;
     }
 
-    // Find node config matching our node ID
-    for (uint8_t i = 0; i < mgr->config.num_nodes; i++) {
-        if (mgr->config.nodes[i].node_id == mgr->my_node_id) {
-            return &mgr->config.nodes[i];
-        }
-    }
+    const session_blob_header_t* header = (const session_blob_header_t*)mgr->blob;
+    size_t pos = defaults_offset(header);
 
-    return NULL;
+    // Defaults first, then this node's differences (both validated at load)
+    memset(config, 0, sizeof(node_config_t));
+    read_section(mgr->blob + pos, mgr->blob_len - pos, config);
+    read_section(mgr->blob + mgr->my_section, mgr->blob_len - mgr->my_section, config);
+    config->node_id = mgr->my_node_id;
+
+    return true;
 }
 
 bool session_apply_to_node(const session_manager_t* mgr, modal_node_t* node) {
     if (!mgr || !node) return false;
 
-    const node_config_t* config = session_get_my_config(mgr);
-    if (!config) return false;
+    node_config_t config;
+    if (!session_get_my_config(mgr, &config)) return false;
 
     // Apply mode parameters
     for (int i = 0; i < MAX_MODES; i++) {
-        node->modes[i].omega = config->omega[i];
-        node->modes[i].gamma = config->gamma[i];
-        node->modes[i].weight = config->weight[i];
+        node->modes[i].params.omega = config.omega[i];
+        node->modes[i].params.gamma = config.gamma[i];
+        node->modes[i].params.weight = config.weight[i];
     }
 
     // Apply personality
-    node->personality = config->personality;
+    node->personality = config.personality;
 
-    // Apply coupling strength (stored in node for network use)
-    // Note: neighbors are managed by the network layer, not modal_node
+    // Apply coupling: the control task sums these neighbors' MSG_STATE
+    modal_node_set_neighbors(node, config.neighbors, config.num_neighbors);
+    node->coupling_strength = config.coupling_strength;
 
     return true;
 }
@@ -185,10 +485,12 @@ void topology_generate_clusters(session_config_t* config,
     for (uint8_t i = 0; i < num_nodes; i++) {
         node_config_t* node = &config->nodes[i];
 
+        // The last cluster takes the remainder
         uint8_t cluster = i / cluster_size;
+        if (cluster >= num_clusters) cluster = num_clusters - 1;
+        node->group = cluster % MAX_GROUPS;
         uint8_t cluster_start = cluster * cluster_size;
-        uint8_t cluster_end = (cluster + 1) * cluster_size;
-        if (cluster_end > num_nodes) cluster_end = num_nodes;
+        uint8_t cluster_end = (cluster == num_clusters - 1) ? num_nodes : (cluster + 1) * cluster_size;
 
         // Intra-cluster connections (ring within cluster)
         node->num_neighbors = 0;
@@ -239,19 +541,3 @@ void topology_generate_hub_spoke(session_config_t* config,
         }
     }
 }
-
-// ============================================================================
-// Presets (Stubs)
-// ============================================================================
-
-void preset_ring_16_resonator(session_manager_t* mgr) {
-    // TODO: Implement in Phase 3
-}
-
-void preset_small_world_8_oscillator(session_manager_t* mgr) {
-    // TODO: Implement in Phase 3
-}
-
-void preset_clusters_16(session_manager_t* mgr) {
-    // TODO: Implement in Phase 3
-}
@@ -8,6 +8,22 @@
  * - JSON or compact binary format
  * - Distributed via ESP-NOW
  *
+ * Compact binary format (version 2, little-endian, unaligned):
+ *   session_blob_header_t
+ *   session_id              id_len bytes, no terminator
+ *   defaults section        every field; the value most nodes use
+ *   index                   num_nodes x {node_id u8, section offset u16}
+ *   node sections           only the fields that differ from the defaults
+ *
+ * A section is: field mask u8, mode mask u16 (bit param * MAX_MODES + mode;
+ * params omega, gamma, weight), the present values (personality u8, then
+ * f32 coupling, carrier, gain, then group u8 and relay u8, then mode
+ * params in mask-bit order), then
+ * num_neighbors u8 and the neighbor IDs. Values are exact, so a node
+ * decodes the same node_config_t the hub built. Each node looks itself up
+ * in the index and decodes only its own section, in place in the receive
+ * buffer.
+ *
  * Session lifecycle:
  * 1. Discovery (HELLO/OFFER/JOIN)
  * 2. Configuration (CFG_BEGIN/CHUNK/END)
@@ -21,6 +37,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "modal_node.h"
 
 #ifdef __cplusplus
@@ -33,7 +50,17 @@ extern "C" {
 
 #define MAX_SESSION_ID_LEN 32
 #define MAX_TOPOLOGY_NAME_LEN 16
-#define MAX_NODES_IN_SESSION 16
+#define MAX_NODES_IN_SESSION 64    // Neighbor cache slots; blob stays within CFG_MAX_CHUNKS
+
+#define SESSION_BLOB_MAGIC 0x4353      // "SC"
+#define SESSION_BLOB_VERSION 2       // 2: group/relay field
+
+// Worst case: every field differs from the defaults, full neighbor list
+#define SESSION_SECTION_MAX_SIZE (1 + 2 + 1 + 3 * 4 + 2 + 3 * MAX_MODES * 4 + 1 + MAX_NEIGHBORS)
+#define SESSION_INDEX_ENTRY_SIZE 3
+#define SESSION_BLOB_MAX_SIZE (sizeof(session_blob_header_t) + MAX_SESSION_ID_LEN + \
+                               (MAX_NODES_IN_SESSION + 1) * SESSION_SECTION_MAX_SIZE + \
+                               MAX_NODES_IN_SESSION * SESSION_INDEX_ENTRY_SIZE)
 
 // ============================================================================
 // Topology Types
@@ -67,6 +94,8 @@ typedef struct {
     uint8_t neighbors[MAX_NEIGHBORS];   ///< Neighbor IDs
     uint8_t num_neighbors;              ///< Number of neighbors
     float coupling_strength;            ///< Coupling coefficient
+    uint8_t group;                      ///< Radio group (GROUP_NONE = none)
+    bool relay;                         ///< Re-broadcast hub and group traffic
 
     // Audio
     float carrier_freq_hz;              ///< Base frequency
@@ -92,6 +121,21 @@ typedef struct {
     bool auto_restart;                  ///< Restart on completion
 } session_config_t;
 
+/**
+ * @brief Fixed header of the compact binary format
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t magic;             ///< SESSION_BLOB_MAGIC
+    uint8_t version;            ///< SESSION_BLOB_VERSION
+    uint8_t num_nodes;          ///< Index entries
+    uint8_t topology;           ///< topology_type_t
+    uint8_t auto_restart;       ///< 0 or 1
+    uint16_t control_rate_hz;   ///< Control loop rate
+    uint32_t max_duration_ms;   ///< Max session time (0 = unlimited)
+    float global_coupling;      ///< Default coupling strength
+    uint8_t id_len;             ///< session_id bytes following the header
+} session_blob_header_t;
+
 /**
  * @brief Session state machine
  */
@@ -108,7 +152,9 @@ typedef enum {
  * @brief Session manager
  */
 typedef struct {
-    session_config_t config;    ///< Current configuration
+    const uint8_t* blob;        ///< Loaded compact config (caller's buffer)
+    uint16_t blob_len;          ///< Bytes at blob
+    uint16_t my_section;        ///< Offset of this node's section in blob
     session_state_t state;      ///< Current state
     uint8_t my_node_id;         ///< This node's ID
     uint32_t session_start_ms;  ///< Session start time
@@ -139,38 +185,45 @@ bool session_load_config_json(session_manager_t* mgr, const char* json_str);
 /**
  * @brief Load configuration from binary blob
  *
+ * Validates the whole blob and finds this node's section. Nothing is
+ * copied: data must stay valid (and unchanged) while the configuration
+ * is used.
+ *
  * @param mgr Pointer to session manager
- * @param data Binary configuration data
+ * @param data Compact binary configuration
  * @param len Data length
- * @return true if successful, false on error
+ * @return true if valid and it has a section for this node
  */
 bool session_load_config_binary(session_manager_t* mgr,
                                const uint8_t* data,
                                size_t len);
 
 /**
- * @brief Serialize configuration to binary blob
+ * @brief Serialize configuration to the compact binary format
  *
- * @param mgr Pointer to session manager
- * @param data Output buffer
+ * @param config Session configuration (nodes[0 .. num_nodes))
+ * @param data Output buffer (SESSION_BLOB_MAX_SIZE always suffices)
  * @param max_len Maximum buffer size
  * @return Size of serialized data, or 0 on error
  */
-size_t session_serialize_config_binary(const session_manager_t* mgr,
+size_t session_serialize_config_binary(const session_config_t* config,
                                        uint8_t* data,
                                        size_t max_len);
 
 /**
- * @brief Get configuration for this node
+ * @brief Decode this node's configuration from the loaded blob
  *
  * @param mgr Pointer to session manager
- * @return Pointer to node configuration, or NULL if not found
+ * @param config Output: defaults with this node's section applied
+ * @return true if a configuration is loaded
  */
-const node_config_t* session_get_my_config(const session_manager_t* mgr);
+bool session_get_my_config(const session_manager_t* mgr, node_config_t* config);
 
 /**
  * @brief Apply configuration to modal node
  *
+ * Decodes only this node's section of the loaded blob.
+ *
  * @param mgr Pointer to session manager
  * @param node Pointer to modal node
  * @return true if successful, false on error
@@ -234,6 +287,9 @@ void topology_generate_small_world(session_config_t* config,
 /**
  * @brief Generate cluster topology
  *
+ * Each cluster is also a radio group (cluster % MAX_GROUPS), so the hub
+ * can address one cluster with a single broadcast.
+ *
  * @param config Pointer to session config
  * @param num_nodes Number of nodes
  * @param num_clusters Number of clusters
@@ -260,23 +316,42 @@ void topology_generate_hub_spoke(session_config_t* config,
 /**
  * @brief Load preset: 16-node ring resonator
  *
- * @param mgr Pointer to session manager
+ * @param config Pointer to session config
  */
-void preset_ring_16_resonator(session_manager_t* mgr);
+void preset_ring_16_resonator(session_config_t* config);
 
 /**
  * @brief Load preset: 8-node small-world oscillator
  *
- * @param mgr Pointer to session manager
+ * @param config Pointer to session config
  */
-void preset_small_world_8_oscillator(session_manager_t* mgr);
+void preset_small_world_8_oscillator(session_config_t* config);
 
 /**
  * @brief Load preset: 16-node cluster network
  *
- * @param mgr Pointer to session manager
+ * @param config Pointer to session config
+ */
+void preset_clusters_16(session_config_t* config);
+
+/**
+ * @brief Load preset: 64-node cluster network (8 clusters of 8)
+ *
+ * No relays: when clusters sit out of the hub's range, set relay on a
+ * node the hub and those clusters both reach.
+ *
+ * @param config Pointer to session config
+ */
+void preset_clusters_64(session_config_t* config);
+
+/**
+ * @brief Load preset: 16-node hub-and-spoke (hub = node 0)
+ *
+ * The hub node is coupled to the first MAX_NEIGHBORS spokes.
+ *
+ * @param config Pointer to session config
  */
-void preset_clusters_16(session_manager_t* mgr);
+void preset_hub_spoke_16(session_config_t* config);
 
 #ifdef __cplusplus
 }
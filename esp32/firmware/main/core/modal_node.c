@@ -6,6 +6,7 @@
  * Based on Python implementation in src/network.py but adapted for:
  * - 4 modes (not 2)
  * - Event-based coupling (pokes)
+ * - Continuous neighbor coupling on mode 0 (MSG_STATE broadcasts)
  * - Exact exponential integration (not Euler)
  * - No continuous state sync
  *
@@ -122,6 +123,10 @@ void modal_node_set_neighbors(modal_node_t* node,
     memcpy(node->neighbor_ids, neighbor_ids, node->num_neighbors);
 }
 
+void modal_node_set_coupling_input(modal_node_t* node, float complex input) {
+    node->coupling_input = input;
+}
+
 void modal_node_step(modal_node_t* node) {
     if (!node->running) return;
 
@@ -173,6 +178,11 @@ void modal_node_step(modal_node_t* node) {
             excitation_term = strength * envelope * cexp_i(phase);
         }
 
+        // Neighbor coupling drives the fundamental only
+        if (k == 0) {
+            excitation_term += node->coupling_input;
+        }
+
         // Total derivative
         mode->a_dot = linear_term + excitation_term;
 
@@ -211,6 +221,22 @@ void modal_node_apply_poke(modal_node_t* node, const poke_event_t* poke) {
     }
 }
 
+void modal_node_merge_poke(poke_event_t* merged, const poke_event_t* poke) {
+    float total = merged->strength + poke->strength;
+    if (total <= 0.0f) return;
+
+    for (int k = 0; k < MAX_MODES; k++) {
+        merged->mode_weights[k] = (merged->strength * merged->mode_weights[k] +
+                                   poke->strength * poke->mode_weights[k]) / total;
+    }
+
+    if (poke->strength > merged->strength) {
+        merged->phase_hint = poke->phase_hint;
+        merged->source_node_id = poke->source_node_id;
+    }
+    merged->strength = total;
+}
+
 float modal_node_get_amplitude(const modal_node_t* node) {
     // Combine all mode amplitudes with weights
     float total = 0.0f;
@@ -256,5 +282,6 @@ void modal_node_reset(modal_node_t* node) {
         node->modes[k].a_dot = 0.0f;
     }
     node->excitation.active = false;
+    node->coupling_input = 0.0f;
     node->step_count = 0;
 }
@@ -86,6 +86,7 @@ typedef struct {
     float coupling_strength;            ///< Global coupling coefficient
     uint8_t num_neighbors;              ///< Number of connected neighbors
     uint8_t neighbor_ids[MAX_NEIGHBORS];///< Neighbor node IDs
+    float complex coupling_input;       ///< Neighbor drive on mode 0 (per step)
 
     float carrier_freq_hz;              ///< Base audio frequency (Hz)
     float audio_gain;                   ///< Master output gain [0,1]
@@ -140,6 +141,16 @@ void modal_node_set_neighbors(modal_node_t* node,
                               uint8_t* neighbor_ids,
                               uint8_t num_neighbors);
 
+/**
+ * @brief Set the neighbor coupling input for the next steps
+ *
+ * Added to mode 0's derivative as κ·Σ(a_j − a_0); see neighbor_cache.h.
+ *
+ * @param node Node to update
+ * @param input Coupling term (0 to decouple)
+ */
+void modal_node_set_coupling_input(modal_node_t* node, float complex input);
+
 /**
  * @brief Simulate one timestep (call at CONTROL_RATE_HZ)
  *
@@ -161,6 +172,19 @@ void modal_node_step(modal_node_t* node);
  */
 void modal_node_apply_poke(modal_node_t* node, const poke_event_t* poke);
 
+/**
+ * @brief Fold a poke into another one bound for the same node
+ *
+ * Strengths add and mode weights are strength-weighted, so every mode
+ * gets the same total kick (strength × weight) as applying both would.
+ * The phase hint of the larger contribution wins. Used to turn a burst
+ * of pokes arriving within one control step into a single excitation.
+ *
+ * @param merged Accumulated poke (updated in place)
+ * @param poke Poke to fold in
+ */
+void modal_node_merge_poke(poke_event_t* merged, const poke_event_t* poke);
+
 /**
  * @brief Get current audio amplitude (for synthesis)
  *
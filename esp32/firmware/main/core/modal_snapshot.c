@@ -0,0 +1,54 @@
+/**
+ * @file modal_snapshot.c
+ * @brief Triple-buffered modal state snapshot
+ *
+ * The exchange on publish is acq_rel: release makes the filled back
+ * buffer visible to the reader, acquire makes sure the buffer handed
+ * back was fully read before it is overwritten. The reader's exchange
+ * mirrors that.
+ */
+
+#include "modal_snapshot.h"
+#include <math.h>
+#include <string.h>
+
+#define SNAPSHOT_INDEX_MASK 0x3u
+
+void modal_snapshot_init(modal_snapshot_exchange_t* exchange) {
+    memset(exchange->buffers, 0, sizeof(exchange->buffers));
+    exchange->front = 0;
+    exchange->back = 1;
+    atomic_init(&exchange->middle, 2u);
+}
+
+void modal_snapshot_capture(const modal_node_t* node, modal_snapshot_t* snapshot) {
+    for (int k = 0; k < MAX_MODES; k++) {
+        const mode_state_t* mode = &node->modes[k];
+        mode_snapshot_t* out = &snapshot->modes[k];
+
+        out->active = mode->params.active;
+        out->omega = mode->params.omega;
+        out->amplitude = cabsf(mode->a) * mode->params.weight;
+        out->phase = cargf(mode->a);
+    }
+    snapshot->step_count = node->step_count;
+}
+
+void modal_snapshot_publish(modal_snapshot_exchange_t* exchange, const modal_node_t* node) {
+    modal_snapshot_capture(node, &exchange->buffers[exchange->back]);
+
+    unsigned previous = atomic_exchange_explicit(&exchange->middle,
+                                                 exchange->back | MODAL_SNAPSHOT_FRESH,
+                                                 memory_order_acq_rel);
+    exchange->back = (uint8_t)(previous & SNAPSHOT_INDEX_MASK);
+}
+
+const modal_snapshot_t* modal_snapshot_read(modal_snapshot_exchange_t* exchange) {
+    if (atomic_load_explicit(&exchange->middle, memory_order_relaxed) & MODAL_SNAPSHOT_FRESH) {
+        unsigned previous = atomic_exchange_explicit(&exchange->middle,
+                                                     exchange->front,
+                                                     memory_order_acq_rel);
+        exchange->front = (uint8_t)(previous & SNAPSHOT_INDEX_MASK);
+    }
+    return &exchange->buffers[exchange->front];
+}
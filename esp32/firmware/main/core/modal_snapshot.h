@@ -0,0 +1,106 @@
+/**
+ * @file modal_snapshot.h
+ * @brief Lock-free hand-off of per-mode state from control to audio task
+ *
+ * The control task owns modal_node_t and steps it on core 0; the audio
+ * task renders on core 1. Instead of reading the node directly (and
+ * seeing half-written complex amplitudes), the audio task reads a compact
+ * snapshot published once per control step through a triple buffer:
+ *
+ * - The writer fills its private back buffer, then swaps it with the
+ *   shared middle buffer and marks it fresh (one atomic exchange)
+ * - The reader swaps its front buffer with the middle one only when it
+ *   is fresh, then reads front at leisure
+ *
+ * Neither side waits or retries, and each buffer is only ever touched by
+ * one task at a time. The reader always gets the latest complete step.
+ */
+
+#ifndef MODAL_SNAPSHOT_H
+#define MODAL_SNAPSHOT_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "modal_node.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Type Definitions
+// ============================================================================
+
+/**
+ * @brief What the renderer needs from one mode
+ */
+typedef struct {
+    float amplitude;  ///< |a_k| · weight_k
+    float phase;      ///< arg(a_k) (radians)
+    float omega;      ///< Angular frequency (rad/s)
+    bool active;      ///< Mode enabled flag
+} mode_snapshot_t;
+
+/**
+ * @brief Per-mode state after one control step
+ */
+typedef struct {
+    mode_snapshot_t modes[MAX_MODES];
+    uint32_t step_count;  ///< Control steps at publish time
+} modal_snapshot_t;
+
+/**
+ * @brief Triple buffer shared by one writer and one reader task
+ */
+typedef struct {
+    modal_snapshot_t buffers[3];
+    atomic_uint middle;  ///< Shared buffer index | MODAL_SNAPSHOT_FRESH
+    uint8_t back;        ///< Writer-owned index
+    uint8_t front;       ///< Reader-owned index
+} modal_snapshot_exchange_t;
+
+#define MODAL_SNAPSHOT_FRESH 0x4u
+
+// ============================================================================
+// API
+// ============================================================================
+
+/**
+ * @brief Initialize the exchange with silent, inactive modes
+ *
+ * @param exchange Exchange to initialize (before either task starts)
+ */
+void modal_snapshot_init(modal_snapshot_exchange_t* exchange);
+
+/**
+ * @brief Capture a node into a snapshot
+ *
+ * @param node Source node
+ * @param snapshot Destination snapshot
+ */
+void modal_snapshot_capture(const modal_node_t* node, modal_snapshot_t* snapshot);
+
+/**
+ * @brief Capture and publish a node (writer task only)
+ *
+ * @param exchange Shared exchange
+ * @param node Node to publish
+ */
+void modal_snapshot_publish(modal_snapshot_exchange_t* exchange, const modal_node_t* node);
+
+/**
+ * @brief Latest published snapshot (reader task only)
+ *
+ * The returned snapshot stays valid and unchanged until the next call.
+ *
+ * @param exchange Shared exchange
+ * @return Most recent complete snapshot
+ */
+const modal_snapshot_t* modal_snapshot_read(modal_snapshot_exchange_t* exchange);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MODAL_SNAPSHOT_H
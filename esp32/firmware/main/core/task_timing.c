@@ -0,0 +1,36 @@
+/**
+ * @file task_timing.c
+ * @brief Per-task busy time, worst case and deadline overruns
+ */
+
+#include "task_timing.h"
+#include <string.h>
+
+void task_timing_init(task_timing_t* timing, uint32_t budget_us) {
+    memset(timing, 0, sizeof(task_timing_t));
+    timing->budget_us = budget_us;
+}
+
+void task_timing_record(task_timing_t* timing, int64_t start_us, int64_t end_us) {
+    uint32_t run_us = (end_us > start_us) ? (uint32_t)(end_us - start_us) : 0;
+
+    timing->busy_us += run_us;
+    timing->runs++;
+    if (run_us > timing->max_us) timing->max_us = run_us;
+    if (timing->budget_us > 0 && run_us > timing->budget_us) timing->overruns++;
+}
+
+uint8_t task_load_sample(task_load_meter_t* meter, uint32_t busy_us, int64_t now_us) {
+    uint8_t percent = 0;
+
+    if (meter->last_at_us > 0 && now_us > meter->last_at_us) {
+        uint32_t busy = busy_us - meter->last_busy_us;  // Wraps correctly
+        int64_t window_us = now_us - meter->last_at_us;
+        int64_t load = ((int64_t)busy * 100 + window_us / 2) / window_us;
+        percent = (load > 100) ? 100 : (uint8_t)load;
+    }
+
+    meter->last_busy_us = busy_us;
+    meter->last_at_us = now_us;
+    return percent;
+}
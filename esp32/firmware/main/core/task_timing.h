@@ -0,0 +1,83 @@
+/**
+ * @file task_timing.h
+ * @brief Per-task busy time, worst case and deadline overruns
+ *
+ * Each task brackets its work with esp_timer timestamps and records the
+ * interval; a reporter turns the busy-time counter into a load
+ * percentage over its own sampling window. Independent of FreeRTOS
+ * run-time stats, so it works with the default sdkconfig.
+ *
+ * Counters are 32-bit (single writer, word-sized reads are atomic on the
+ * ESP32) and wrap; busy_us wraps after ~71 minutes, which load deltas
+ * over a heartbeat interval tolerate.
+ */
+
+#ifndef TASK_TIMING_H
+#define TASK_TIMING_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Type Definitions
+// ============================================================================
+
+/**
+ * @brief Accounting for one task's work (written by that task only)
+ */
+typedef struct {
+    uint32_t budget_us;          ///< Deadline per run (0 = none)
+    volatile uint32_t busy_us;   ///< Total time in recorded runs (wraps)
+    volatile uint32_t runs;      ///< Runs recorded
+    volatile uint32_t max_us;    ///< Longest run since boot
+    volatile uint32_t overruns;  ///< Runs longer than budget_us
+} task_timing_t;
+
+/**
+ * @brief Reporter-side state for turning busy time into load
+ */
+typedef struct {
+    uint32_t last_busy_us;  ///< busy_us at the previous sample
+    int64_t last_at_us;     ///< Time of the previous sample (0 = none)
+} task_load_meter_t;
+
+// ============================================================================
+// API
+// ============================================================================
+
+/**
+ * @brief Initialize accounting
+ *
+ * @param timing Task accounting
+ * @param budget_us Deadline per run (0 = no overrun counting)
+ */
+void task_timing_init(task_timing_t* timing, uint32_t budget_us);
+
+/**
+ * @brief Record one run (owning task)
+ *
+ * @param timing Task accounting
+ * @param start_us esp_timer time the work started
+ * @param end_us esp_timer time the work ended
+ */
+void task_timing_record(task_timing_t* timing, int64_t start_us, int64_t end_us);
+
+/**
+ * @brief Load since the previous sample
+ *
+ * @param meter Reporter state (zero-initialize before first use)
+ * @param busy_us Current busy-time counter (task_timing_t.busy_us or any
+ *                other wrapping µs total)
+ * @param now_us Current esp_timer time
+ * @return Percentage of the window spent busy (0-100; 0 on first sample)
+ */
+uint8_t task_load_sample(task_load_meter_t* meter, uint32_t busy_us, int64_t now_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TASK_TIMING_H
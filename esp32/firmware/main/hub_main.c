@@ -15,7 +15,9 @@
 #include "freertos/queue.h"
 #include "esp_log.h"
 #include "esp_system.h"
+#include "esp_timer.h"
 #include "nvs_flash.h"
+#include "sdkconfig.h"
 
 #include "network/protocol.h"
 #include "network/esp_now_manager.h"
@@ -27,7 +29,7 @@
 
 #define TAG "HUB_MAIN"
 
-#define HUB_NODE_ID 0
+#define HUB_NODE_ID NODE_ID_HUB
 
 #define MIDI_TASK_PRIORITY 4
 #define DISCOVERY_TASK_PRIORITY 3
@@ -42,6 +44,16 @@
 #define DISCOVERY_TASK_CORE 0
 #define HEARTBEAT_TASK_CORE 0
 
+// Heartbeats double as clock beacons; node health is checked every 5 s
+#define HEARTBEAT_INTERVAL_MS CONFIG_MODAL_CLOCK_SYNC_INTERVAL_MS
+#define HEALTH_CHECK_BEATS ((5000 + HEARTBEAT_INTERVAL_MS - 1) / HEARTBEAT_INTERVAL_MS)
+
+#define DRIVE_INTERVAL_MS 100  // Sustained pokes for held channel 2 notes
+
+// Discovery
+#define DISCOVERY_TIMEOUT_MS 5000
+#define DISCOVERY_POLL_MS 10
+
 // ============================================================================
 // Global State
 // ============================================================================
@@ -63,17 +75,11 @@ static void on_network_message_received(const network_message_t* msg) {
             break;
 
         case MSG_HEARTBEAT:
-            // Update last heartbeat time for node
-            for (int i = 0; i < g_hub.num_registered; i++) {
-                if (g_hub.nodes[i].node_id == msg->header.source_id) {
-                    g_hub.nodes[i].last_heartbeat_ms = msg->heartbeat.uptime_ms;
-                    break;
-                }
-            }
+            hub_handle_heartbeat(&g_hub, &msg->heartbeat);
             break;
 
         case MSG_CFG_ACK:
-            ESP_LOGI(TAG, "Node %d acknowledged configuration", msg->header.source_id);
+            hub_handle_cfg_ack(&g_hub, &msg->cfg_ack);
             break;
 
         case MSG_CFG_NACK:
@@ -110,17 +116,21 @@ static void midi_task(void* pvParameters) {
     TickType_t last_drive_time = xTaskGetTickCount();
 
     while (1) {
-        // Process MIDI input
-        hub_midi_process(&g_hub);
+        // Sleep until UART bytes arrive or the next drive update is due
+        TickType_t elapsed = xTaskGetTickCount() - last_drive_time;
+        TickType_t interval = pdMS_TO_TICKS(DRIVE_INTERVAL_MS);
+        uint32_t wait_ms = (elapsed < interval) ? (interval - elapsed) * portTICK_PERIOD_MS : 0;
+
+        if (hub_midi_wait(&g_hub, wait_ms)) {
+            hub_midi_process(&g_hub);
+        }
 
         // Process drive notes (channel 2) every 100ms
         TickType_t now = xTaskGetTickCount();
-        if ((now - last_drive_time) >= pdMS_TO_TICKS(100)) {
+        if ((now - last_drive_time) >= interval) {
             hub_process_drive_notes(&g_hub);
             last_drive_time = now;
         }
-
-        vTaskDelay(pdMS_TO_TICKS(1));  // 1ms MIDI polling
     }
 }
 
@@ -131,16 +141,25 @@ static void midi_task(void* pvParameters) {
 static void discovery_task(void* pvParameters) {
     ESP_LOGI(TAG, "Discovery task started on core %d", xPortGetCoreID());
 
-    // Wait for network to initialize
-    vTaskDelay(pdMS_TO_TICKS(2000));
+    // Wait for network to initialize (nodes with a cached session
+    // announce themselves at boot, no need to give them a head start)
+    if (g_hub.warm_nodes == 0) {
+        vTaskDelay(pdMS_TO_TICKS(2000));
+    }
 
     ESP_LOGI(TAG, "Starting node discovery...");
 
-    // Start discovery (5 second timeout)
-    hub_start_discovery(&g_hub, 5000);
+    hub_start_discovery(&g_hub, DISCOVERY_TIMEOUT_MS);
+
+    // Wait for nodes to respond, or until every node of the cached
+    // session is back holding its configuration
+    int64_t deadline_us = esp_timer_get_time() + (int64_t)DISCOVERY_TIMEOUT_MS * 1000;
+    while (!hub_discovery_complete(&g_hub) && esp_timer_get_time() < deadline_us) {
+        vTaskDelay(pdMS_TO_TICKS(DISCOVERY_POLL_MS));
+    }
 
-    // Wait for nodes to respond
-    vTaskDelay(pdMS_TO_TICKS(5000));
+    // Register everyone heard in one pass and broadcast their IDs
+    hub_finish_discovery(&g_hub);
 
     ESP_LOGI(TAG, "Discovery complete: %d nodes found", hub_get_num_registered(&g_hub));
 
@@ -153,9 +172,7 @@ static void discovery_task(void* pvParameters) {
         hub_send_default_config(&g_hub);
     }
 
-    // Wait a bit for config to propagate
-    vTaskDelay(pdMS_TO_TICKS(1000));
-
+    // hub_send_config() returns once every node has acknowledged
     // Start session
     hub_start_session(&g_hub);
 
@@ -175,16 +192,25 @@ static void discovery_task(void* pvParameters) {
 static void heartbeat_task(void* pvParameters) {
     ESP_LOGI(TAG, "Heartbeat task started on core %d", xPortGetCoreID());
 
+    uint32_t beats = 0;
+
     while (1) {
-        // Send heartbeat every 5 seconds
-        vTaskDelay(pdMS_TO_TICKS(5000));
+        vTaskDelay(pdMS_TO_TICKS(HEARTBEAT_INTERVAL_MS));
 
+        // The hub's clock is the shared timebase for scheduled pokes
         network_message_t heartbeat;
         uint32_t uptime_ms = esp_log_timestamp();
         protocol_create_heartbeat(&heartbeat, g_hub.hub_node_id, uptime_ms, 0);
+        heartbeat.heartbeat.flags |= HEARTBEAT_FLAG_TIME_REFERENCE;
 
         esp_now_broadcast_message(&g_network, &heartbeat, sizeof(msg_heartbeat_t));
 
+        // One RTT probe per node per beat (answered by the nodes' managers)
+        esp_now_ping_peers(&g_network);
+
+        if (++beats < HEALTH_CHECK_BEATS) continue;
+        beats = 0;
+
         // Check for stale nodes (no heartbeat in 10s)
         for (int i = 0; i < g_hub.num_registered; i++) {
             if (g_hub.nodes[i].running) {
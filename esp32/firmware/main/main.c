@@ -20,13 +20,19 @@
 #include "freertos/queue.h"
 #include "esp_log.h"
 #include "esp_system.h"
+#include "esp_timer.h"
 #include "nvs_flash.h"
 
 #include "core/modal_node.h"
+#include "core/modal_snapshot.h"
+#include "core/task_timing.h"
 #include "audio/audio_synth.h"
 #include "network/protocol.h"
 #include "network/esp_now_manager.h"
+#include "network/neighbor_cache.h"
+#include "network/clock_sync.h"
 #include "config/session_config.h"
+#include "config/session_cache.h"
 
 // ============================================================================
 // Constants
@@ -42,6 +48,31 @@
 #define CONTROL_TASK_STACK_SIZE 4096
 #define NETWORK_TASK_STACK_SIZE 4096
 
+#define NODE_HEARTBEAT_INTERVAL_MS 5000
+
+#define MY_NODE_ID 0                  // Until the hub assigns one (then kept in NVS)
+#define NODE_ID_NONE 0xFF
+
+#define POKE_QUEUE_LENGTH 16
+#define POKE_SCHEDULE_SLOTS 16        // Scheduled pokes held by the control task
+#define POKE_MAX_LEAD_US 1000000      // Further ahead than this: clock is off, apply now
+#define CONTROL_PERIOD_US (1000000 / CONTROL_RATE_HZ)
+
+// Neighbor coupling (CONFIG_MODAL_STATE_RATE_HZ 0 = no state broadcasts)
+#if CONFIG_MODAL_STATE_RATE_HZ > 0
+#define STATE_BROADCAST_INTERVAL (CONTROL_RATE_HZ / CONFIG_MODAL_STATE_RATE_HZ)  // Control ticks
+#else
+#define STATE_BROADCAST_INTERVAL 0
+#endif
+#define STATE_TIMEOUT_US ((int64_t)CONFIG_MODAL_STATE_TIMEOUT_MS * 1000)
+
+// Fixed repeater: relays whatever the session config says
+#ifdef CONFIG_MODAL_NODE_RELAY
+#define NODE_ALWAYS_RELAY true
+#else
+#define NODE_ALWAYS_RELAY false
+#endif
+
 // Pin to Core assignments
 #define AUDIO_TASK_CORE 1
 #define CONTROL_TASK_CORE 0
@@ -52,28 +83,63 @@
 // ============================================================================
 
 static modal_node_t g_node;
+static modal_snapshot_exchange_t g_node_state;  // control_task → audio_task
 static audio_synth_t g_audio;
 static esp_now_manager_t g_network;
+static TaskHandle_t g_network_task;
+static uint8_t g_node_id = MY_NODE_ID;  // Assigned by the hub's OFFER
+static volatile uint8_t g_store_node_id = NODE_ID_NONE;  // For the network task to persist
 static session_manager_t g_session;
+static neighbor_cache_t g_neighbors;  // network_task → control_task
+static clock_sync_t g_clock;          // Hub-referenced shared timebase
+static task_timing_t g_control_timing;  // Control steps (budget: one period)
+static task_timing_t g_network_timing;  // Received-message handling
 
-static QueueHandle_t g_poke_queue;  // Queue for poke events
+/**
+ * @brief Poke plus the local time to apply it (0 = on arrival)
+ */
+typedef struct {
+    poke_event_t poke;
+    int64_t due_us;
+} scheduled_poke_t;
+
+static QueueHandle_t g_poke_queue;  // Queue for poke events (scheduled_poke_t)
+
+// Poke delivery counters (since boot); each field has a single writer task
+static volatile struct {
+    uint32_t received;   // Pokes drained by the control task
+    uint32_t merged;     // Pokes folded into another in the same tick
+    uint32_t dropped;    // Pokes lost to a full queue (network task)
+    uint32_t max_depth;  // Most pokes waiting at one control tick
+    uint32_t scheduled;  // Pokes held for a later tick
+    uint32_t late;       // Scheduled pokes that arrived after their tick
+} g_poke_stats;
+
+// Compact configurations: one is applied (g_session points into it),
+// the other receives the next transfer
+static uint8_t g_config_blobs[2][SESSION_BLOB_MAX_SIZE];
 
 // Configuration reception state
 static struct {
-    uint8_t buffer[4096];        // Configuration buffer
+    uint8_t* buffer;             // Receive buffer (the blob not applied)
+    const uint8_t* applied;      // Applied configuration (NULL = none)
+    uint16_t applied_size;       // Bytes at applied
     uint16_t total_size;         // Expected total size
     uint8_t num_chunks;          // Expected number of chunks
     uint8_t chunks_received;     // Chunks received so far
     uint32_t expected_checksum;  // Expected CRC32
+    uint32_t applied_checksum;   // CRC32 of the last configuration applied
     bool receiving;              // Currently receiving config
-    uint8_t chunk_bitmap[32];    // Bitmap of received chunks (max 256 chunks)
-} g_config_rx;
+    uint8_t chunk_bitmap[CFG_CHUNK_BITMAP_BYTES]; // Bitmap of received chunks
+    uint8_t crc_chunks;          // Leading chunks folded into crc
+    uint32_t crc;                // CRC32 of buffer[0 .. crc_chunks chunks)
+    uint32_t cache_checksum;     // Applied config for the network task to cache (0 = none)
+} g_config_rx = { .buffer = g_config_blobs[0] };
 
 // ============================================================================
 // Configuration (TODO: load from NVS or external config)
 // ============================================================================
 
-#define MY_NODE_ID 0  // Change per node
 #define DEFAULT_CARRIER_FREQ 440.0f
 
 // ============================================================================
@@ -84,73 +150,278 @@ static struct {
  * @brief Control task: Modal integration at control rate
  *
  * This task runs the modal resonator dynamics at 200-1000 Hz.
- * It's independent of network and audio tasks.
+ * It's independent of network and audio tasks, and publishes the mode
+ * state for the audio task after every step. While running it also
+ * broadcasts mode 0 for the neighbors' coupling every
+ * STATE_BROADCAST_INTERVAL steps (the send only enqueues).
+ *
+ * Scheduled pokes wait in a small local list until the tick nearest
+ * their due time, so synchronized nodes apply them together.
  */
 static void control_task(void* pvParameters) {
     ESP_LOGI(TAG, "Control task started on core %d", xPortGetCoreID());
 
     TickType_t last_wake = xTaskGetTickCount();
     const TickType_t period = pdMS_TO_TICKS(1000 / CONTROL_RATE_HZ);
+    uint32_t ticks_since_state = 0;
+
+    scheduled_poke_t pending[POKE_SCHEDULE_SLOTS];
+    uint8_t num_pending = 0;
 
     while (1) {
-        // Check for poke events
-        poke_event_t poke;
-        if (xQueueReceive(g_poke_queue, &poke, 0) == pdTRUE) {
-            modal_node_apply_poke(&g_node, &poke);
-            ESP_LOGD(TAG, "Applied poke from node %d (strength=%.2f)",
-                     poke.source_node_id, poke.strength);
+        int64_t now_us = esp_timer_get_time();
+        // A poke due before the middle of the next period lands on this tick
+        int64_t horizon_us = now_us + CONTROL_PERIOD_US / 2;
+
+        // Every poke due this tick is applied as one excitation, so a
+        // burst lands together instead of one poke per tick
+        poke_event_t merged;
+        uint32_t due = 0;
+
+        for (uint8_t i = 0; i < num_pending; ) {
+            if (pending[i].due_us <= horizon_us) {
+                if (due++ == 0) merged = pending[i].poke;
+                else modal_node_merge_poke(&merged, &pending[i].poke);
+                pending[i] = pending[--num_pending];
+            } else {
+                i++;
+            }
+        }
+
+        UBaseType_t depth = uxQueueMessagesWaiting(g_poke_queue);
+        if (depth > g_poke_stats.max_depth) {
+            g_poke_stats.max_depth = depth;
+        }
+
+        // Bounded so a flooding sender cannot starve the step
+        uint32_t drained = 0;
+        scheduled_poke_t incoming;
+        while (drained < POKE_QUEUE_LENGTH &&
+               xQueueReceive(g_poke_queue, &incoming, 0) == pdTRUE) {
+            drained++;
+
+            // Held for its tick (applied early only if the list is full)
+            if (incoming.due_us > horizon_us && num_pending < POKE_SCHEDULE_SLOTS) {
+                pending[num_pending++] = incoming;
+                g_poke_stats.scheduled++;
+                continue;
+            }
+            if (incoming.due_us != 0 && incoming.due_us < now_us - CONTROL_PERIOD_US) {
+                g_poke_stats.late++;
+            }
+
+            if (due++ == 0) merged = incoming.poke;
+            else modal_node_merge_poke(&merged, &incoming.poke);
         }
+        g_poke_stats.received += drained;
 
-        // Simulate one timestep
+        if (due > 0) {
+            modal_node_apply_poke(&g_node, &merged);
+            g_poke_stats.merged += due - 1;
+            ESP_LOGD(TAG, "Applied %u poke(s) (strength=%.2f)",
+                     (unsigned)due, merged.strength);
+        }
+
+        // Simulate one timestep, driven by the neighbors' latest states
         if (g_node.running) {
+            modal_node_set_coupling_input(&g_node,
+                neighbor_cache_coupling(&g_neighbors, &g_node, now_us, STATE_TIMEOUT_US));
             modal_node_step(&g_node);
+
+            if (STATE_BROADCAST_INTERVAL > 0 && ++ticks_since_state >= STATE_BROADCAST_INTERVAL) {
+                ticks_since_state = 0;
+
+                float complex a0 = modal_node_get_mode0(&g_node);
+                network_message_t state;
+                size_t len = protocol_create_state_compact(&state, g_node_id,
+                                                           crealf(a0), cimagf(a0));
+                esp_now_broadcast_message(&g_network, &state, len);
+            }
         }
 
+        // Published even when stopped so parameter changes still reach audio
+        modal_snapshot_publish(&g_node_state, &g_node);
+
+        task_timing_record(&g_control_timing, now_us, esp_timer_get_time());
+
         // Wait until next control period
         vTaskDelayUntil(&last_wake, period);
     }
 }
 
 /**
- * @brief Network callback: Handle received messages
+ * @brief Hand a received poke to the control task
+ *
+ * @param poke Decoded poke
+ * @param apply_at_us Shared due time from the message, or POKE_APPLY_NOW
  */
-static void on_network_message_received(const network_message_t* msg) {
-    ESP_LOGD(TAG, "Received message type 0x%02X from node %d",
-             msg->header.type, msg->header.source_id);
+static void queue_poke(const poke_event_t* poke, uint32_t apply_at_us) {
+    scheduled_poke_t item = {.poke = *poke, .due_us = 0};
+
+    // Unsynchronized nodes, and implausible times, apply on arrival
+    if (apply_at_us != POKE_APPLY_NOW && clock_sync_is_synced(&g_clock)) {
+        int64_t now_us = esp_timer_get_time();
+        int64_t due_us = clock_sync_wire_to_local(&g_clock, apply_at_us, now_us);
+        if (due_us - now_us <= POKE_MAX_LEAD_US) {
+            item.due_us = due_us;
+        }
+    }
 
-    switch (msg->header.type) {
-        case MSG_HELLO: {
-            // Hub is discovering - respond with our HELLO
-            ESP_LOGI(TAG, "Received HELLO from hub, responding");
+    if (xQueueSend(g_poke_queue, &item, 0) != pdTRUE) {
+        g_poke_stats.dropped++;
+        ESP_LOGW(TAG, "Poke queue full, dropped event");
+    }
+}
 
-            network_message_t response;
-            char node_name[16];
-            snprintf(node_name, sizeof(node_name), "Node_%03d", MY_NODE_ID);
-            protocol_create_hello(&response, MY_NODE_ID, node_name);
+/**
+ * @brief Fold newly contiguous chunks into the running config CRC
+ *
+ * Called as chunks arrive, so each byte is checksummed once during
+ * reception and CFG_END only compares. Chunks that arrive ahead of a
+ * gap are folded in once the gap is filled.
+ */
+static void extend_config_crc(void) {
+    while (g_config_rx.crc_chunks < g_config_rx.num_chunks) {
+        uint8_t idx = g_config_rx.crc_chunks;
+        if (!(g_config_rx.chunk_bitmap[idx / 8] & (1 << (idx % 8)))) break;
 
-            // Copy our MAC address
-            memcpy(response.hello.mac_address, g_network.my_mac, 6);
+        size_t offset = (size_t)idx * CFG_CHUNK_DATA_SIZE;
+        size_t len = g_config_rx.total_size - offset;
+        if (len > CFG_CHUNK_DATA_SIZE) len = CFG_CHUNK_DATA_SIZE;
 
-            // Send response (use broadcast since hub may not be registered yet)
-            esp_now_broadcast_message(&g_network, &response, sizeof(msg_hello_t));
+        g_config_rx.crc = protocol_crc32_update(g_config_rx.crc, g_config_rx.buffer + offset, len);
+        g_config_rx.crc_chunks++;
+    }
+}
 
-            ESP_LOGI(TAG, "Sent HELLO response");
-            break;
+/**
+ * @brief Answer a CFG_END with our chunk bitmap
+ *
+ * @param hub_id Hub that sent the CFG_END
+ * @param status CFG_STATUS_*
+ * @param checksum Transfer being acknowledged
+ */
+static void send_cfg_ack(uint8_t hub_id, uint8_t status, uint32_t checksum) {
+    network_message_t ack;
+    size_t len = protocol_create_cfg_ack(&ack, g_node_id, hub_id, status, checksum,
+                                         g_config_rx.chunk_bitmap, g_config_rx.chunks_received);
+    esp_now_send_message(&g_network, hub_id, &ack, len);
+}
+
+/**
+ * @brief Announce this node (with the CRC of the configuration it holds)
+ */
+static void send_hello(void) {
+    network_message_t hello;
+    char node_name[16];
+    snprintf(node_name, sizeof(node_name), "Node_%03d", g_node_id);
+    protocol_create_hello(&hello, g_node_id, node_name);
+
+    // Copy our MAC address
+    memcpy(hello.hello.mac_address, g_network.my_mac, 6);
+
+    // A matching CRC lets the hub skip our configuration transfer
+    hello.hello.config_crc = g_config_rx.applied_checksum;
+
+    // Broadcast, since the hub may not be registered yet; addressed to
+    // the hub so other nodes drop it and relays carry it upstream
+    hello.hello.header.dest_id = NODE_ID_HUB;
+    esp_now_broadcast_message(&g_network, &hello, sizeof(msg_hello_t));
+}
+
+/**
+ * @brief Take this node's radio group and relay role from the applied config
+ *
+ * A fixed repeater (CONFIG_MODAL_NODE_RELAY) relays from startup, so
+ * HELLOs of nodes beyond it reach the hub before any config exists.
+ */
+static void apply_network_role(void) {
+    node_config_t config;
+    if (session_get_my_config(&g_session, &config)) {
+        esp_now_set_group(&g_network, config.group, config.relay || NODE_ALWAYS_RELAY);
+    } else if (NODE_ALWAYS_RELAY) {
+        esp_now_set_group(&g_network, g_network.my_group, true);
+    }
+}
+
+/**
+ * @brief Make the receive buffer the applied configuration
+ *
+ * g_session already points into it; the previously applied blob's
+ * buffer receives the next transfer.
+ */
+static void adopt_received_config(uint16_t size, uint32_t checksum) {
+    uint8_t* received = g_config_rx.buffer;
+    g_config_rx.buffer = (received == g_config_blobs[0]) ? g_config_blobs[1] : g_config_blobs[0];
+    g_config_rx.applied = received;
+    g_config_rx.applied_size = size;
+    g_config_rx.applied_checksum = checksum;
+}
+
+/**
+ * @brief Take the node ID the hub assigned (Wi-Fi task)
+ *
+ * A configuration already applied is applied again under the new ID
+ * (the blob has every node's section), so the CRC we report stays
+ * truthful. A transfer in progress does not touch the applied blob.
+ */
+static void adopt_node_id(uint8_t node_id) {
+    if (node_id == g_node_id) return;
+
+    ESP_LOGI(TAG, "Node ID %d -> %d", g_node_id, node_id);
+    g_node_id = node_id;
+    g_network.my_node_id = node_id;
+    g_session.my_node_id = node_id;
+    g_node.node_id = node_id;
+
+    if (g_config_rx.applied_checksum != 0) {
+        bool reapplied = session_load_config_binary(&g_session, g_config_rx.applied, g_config_rx.applied_size) &&
+                         session_apply_to_node(&g_session, &g_node);
+        if (reapplied) {
+            apply_network_role();
+        } else {
+            ESP_LOGW(TAG, "Applied configuration has no section for node %d", node_id);
+            g_config_rx.applied_checksum = 0;
         }
+    }
+
+    // Persisted by the network task (NVS writes stall flash)
+    g_store_node_id = node_id;
+    if (g_network_task) xTaskNotifyGive(g_network_task);
+}
+
+/**
+ * @brief Handle one received message
+ */
+static void handle_network_message(const network_message_t* msg) {
+    ESP_LOGD(TAG, "Received message type 0x%02X from node %d",
+             msg->header.type, msg->header.source_id);
+
+    switch (msg->header.type) {
+        case MSG_HELLO:
+            // Only the hub's discovery is answered: answering other nodes'
+            // HELLOs would have every node echo every other one
+            if (!(msg->hello.capabilities & HELLO_CAP_HUB)) break;
+
+            ESP_LOGI(TAG, "Received HELLO from hub, responding");
+            send_hello();
+            break;
 
         case MSG_OFFER: {
-            // Hub is offering configuration
-            ESP_LOGI(TAG, "Received OFFER from hub (session: %s)", msg->offer.session_id);
+            // One broadcast carries the IDs of many nodes: find ours
+            uint8_t assigned_id = protocol_offer_find(&msg->offer, g_network.my_mac);
+            if (assigned_id == NODE_ID_NONE) break;
+
+            ESP_LOGI(TAG, "Received OFFER from hub (session: %s, node ID %d)",
+                     msg->offer.session_id, assigned_id);
+            adopt_node_id(assigned_id);
 
             // Accept the offer with JOIN
             network_message_t join;
-            join.join.header.type = MSG_JOIN;
-            join.join.header.source_id = MY_NODE_ID;
+            size_t join_len = protocol_create_join(&join, g_node_id, g_node_id, g_network.my_mac);
             join.join.header.dest_id = msg->header.source_id;
-            join.join.requested_node_id = MY_NODE_ID;
-            memcpy(join.join.mac_address, g_network.my_mac, 6);
 
-            esp_now_send_message(&g_network, msg->header.source_id, &join, sizeof(msg_join_t));
+            esp_now_send_message(&g_network, msg->header.source_id, &join, join_len);
 
             ESP_LOGI(TAG, "Sent JOIN to hub");
             break;
@@ -165,12 +436,43 @@ static void on_network_message_received(const network_message_t* msg) {
             };
             memcpy(poke.mode_weights, msg->poke.mode_weights, sizeof(poke.mode_weights));
 
-            if (xQueueSend(g_poke_queue, &poke, 0) != pdTRUE) {
-                ESP_LOGW(TAG, "Poke queue full, dropped event");
+            queue_poke(&poke, msg->poke.apply_at_us);
+            break;
+        }
+
+        case MSG_POKE_BATCH: {
+            // Keep only the entries addressed to this node
+            const msg_poke_batch_t* batch = &msg->poke_batch;
+            for (uint8_t i = 0; i < batch->count; i++) {
+                const poke_entry_t* entry = &batch->entries[i];
+                if (!protocol_addressed_to(entry->target_id, g_node_id, g_network.my_group)) continue;
+
+                poke_event_t poke = {.source_node_id = msg->header.source_id};
+                protocol_poke_entry_decode(entry, &poke.strength, &poke.phase_hint,
+                                           poke.mode_weights);
+
+                queue_poke(&poke, batch->apply_at_us);
             }
             break;
         }
 
+        case MSG_HEARTBEAT:
+            // The hub's heartbeats carry the shared timebase
+            if (msg->heartbeat.flags & HEARTBEAT_FLAG_TIME_REFERENCE) {
+                clock_sync_update(&g_clock, msg->heartbeat.reference_time_us,
+                                  esp_timer_get_time());
+            }
+            break;
+
+        case MSG_STATE:
+            // Neighbor state for coupling (the control task picks its neighbors)
+            if (msg->header.source_id != g_node_id) {
+                neighbor_cache_update(&g_neighbors, msg->header.source_id,
+                                      msg->state.mode0_real, msg->state.mode0_imag,
+                                      esp_timer_get_time());
+            }
+            break;
+
         case MSG_START:
             ESP_LOGI(TAG, "Session starting");
             session_start(&g_session);
@@ -189,16 +491,37 @@ static void on_network_message_received(const network_message_t* msg) {
             break;
 
         case MSG_CFG_BEGIN: {
+            const msg_cfg_begin_t* begin = &msg->cfg_begin;
+
+            // Repeated by the hub each repair round: keep what we have
+            if (g_config_rx.receiving && begin->checksum == g_config_rx.expected_checksum &&
+                begin->total_size == g_config_rx.total_size) {
+                break;
+            }
+            if (!g_config_rx.receiving && begin->checksum == g_config_rx.applied_checksum) {
+                break;
+            }
+
             ESP_LOGI(TAG, "CFG_BEGIN: size=%d chunks=%d crc=0x%08X",
-                     msg->cfg_begin.total_size,
-                     msg->cfg_begin.num_chunks,
-                     msg->cfg_begin.checksum);
-
-            // Reset reception state
-            memset(&g_config_rx, 0, sizeof(g_config_rx));
-            g_config_rx.total_size = msg->cfg_begin.total_size;
-            g_config_rx.num_chunks = msg->cfg_begin.num_chunks;
-            g_config_rx.expected_checksum = msg->cfg_begin.checksum;
+                     begin->total_size, begin->num_chunks, begin->checksum);
+
+            if (begin->total_size > SESSION_BLOB_MAX_SIZE ||
+                begin->num_chunks > CFG_MAX_CHUNKS ||
+                begin->num_chunks != (begin->total_size + CFG_CHUNK_DATA_SIZE - 1) / CFG_CHUNK_DATA_SIZE) {
+                ESP_LOGE(TAG, "Invalid transfer (size=%d chunks=%d)",
+                         begin->total_size, begin->num_chunks);
+                break;
+            }
+
+            // Reset reception state; the applied blob and its CRC stay
+            // until this transfer is accepted
+            memset(g_config_rx.chunk_bitmap, 0, sizeof(g_config_rx.chunk_bitmap));
+            g_config_rx.chunks_received = 0;
+            g_config_rx.crc_chunks = 0;
+            g_config_rx.crc = 0;
+            g_config_rx.total_size = begin->total_size;
+            g_config_rx.num_chunks = begin->num_chunks;
+            g_config_rx.expected_checksum = begin->checksum;
             g_config_rx.receiving = true;
 
             ESP_LOGI(TAG, "Ready to receive configuration");
@@ -207,7 +530,7 @@ static void on_network_message_received(const network_message_t* msg) {
 
         case MSG_CFG_CHUNK: {
             if (!g_config_rx.receiving) {
-                ESP_LOGW(TAG, "Received chunk without CFG_BEGIN");
+                ESP_LOGD(TAG, "Received chunk without CFG_BEGIN");
                 break;
             }
 
@@ -216,6 +539,11 @@ static void on_network_message_received(const network_message_t* msg) {
 
             ESP_LOGD(TAG, "CFG_CHUNK: idx=%d size=%d", chunk_idx, chunk_size);
 
+            if (chunk_idx >= g_config_rx.num_chunks) {
+                ESP_LOGE(TAG, "Chunk %d out of range (%d chunks)", chunk_idx, g_config_rx.num_chunks);
+                break;
+            }
+
             // Check if chunk already received (using bitmap)
             uint8_t byte_idx = chunk_idx / 8;
             uint8_t bit_idx = chunk_idx % 8;
@@ -226,70 +554,77 @@ static void on_network_message_received(const network_message_t* msg) {
             }
 
             // Copy chunk data
-            size_t offset = chunk_idx * 200;  // 200 bytes per chunk
-            if (offset + chunk_size <= sizeof(g_config_rx.buffer)) {
+            size_t offset = (size_t)chunk_idx * CFG_CHUNK_DATA_SIZE;
+            if (offset + chunk_size <= g_config_rx.total_size) {
                 memcpy(g_config_rx.buffer + offset, msg->cfg_chunk.data, chunk_size);
 
                 // Mark chunk as received
                 g_config_rx.chunk_bitmap[byte_idx] |= (1 << bit_idx);
                 g_config_rx.chunks_received++;
+                extend_config_crc();
 
                 ESP_LOGD(TAG, "Chunk %d received (%d/%d)",
                          chunk_idx, g_config_rx.chunks_received, g_config_rx.num_chunks);
             } else {
-                ESP_LOGE(TAG, "Chunk %d exceeds buffer size", chunk_idx);
+                ESP_LOGE(TAG, "Chunk %d exceeds transfer size", chunk_idx);
             }
             break;
         }
 
         case MSG_CFG_END: {
-            if (!g_config_rx.receiving) {
-                ESP_LOGW(TAG, "Received CFG_END without CFG_BEGIN");
+            uint8_t hub_id = msg->header.source_id;
+            uint32_t checksum = msg->cfg_end.checksum;
+
+            if (!g_config_rx.receiving || checksum != g_config_rx.expected_checksum) {
+                // Already applied (our ACK was lost, or another node is
+                // being repaired), or we missed this transfer's CFG_BEGIN
+                bool applied = (checksum == g_config_rx.applied_checksum);
+                if (!applied) {
+                    ESP_LOGW(TAG, "CFG_END for unknown transfer 0x%08X", checksum);
+                }
+                send_cfg_ack(hub_id, applied ? CFG_STATUS_OK : CFG_STATUS_NO_TRANSFER, checksum);
                 break;
             }
 
             ESP_LOGI(TAG, "CFG_END: received %d/%d chunks",
                      g_config_rx.chunks_received, g_config_rx.num_chunks);
 
-            // Verify all chunks received
+            // Report what we hold; the hub resends only the rest and ends again
             if (g_config_rx.chunks_received != g_config_rx.num_chunks) {
-                ESP_LOGE(TAG, "Missing chunks: %d/%d",
-                         g_config_rx.chunks_received, g_config_rx.num_chunks);
-                g_config_rx.receiving = false;
-
-                // Send NACK
-                network_message_t ack;
-                protocol_create_cfg_ack(&ack, MY_NODE_ID, msg->header.source_id, 1);
-                esp_now_send_message(&g_network, msg->header.source_id, &ack, sizeof(msg_cfg_ack_t));
+                send_cfg_ack(hub_id, CFG_STATUS_MISSING, checksum);
                 break;
             }
 
             // Verify checksum
-            uint32_t actual_checksum = protocol_crc32(g_config_rx.buffer, g_config_rx.total_size);
+            uint32_t actual_checksum = g_config_rx.crc;  // All chunks folded in by now
             if (actual_checksum != g_config_rx.expected_checksum) {
                 ESP_LOGE(TAG, "Checksum mismatch: expected 0x%08X, got 0x%08X",
                          g_config_rx.expected_checksum, actual_checksum);
-                g_config_rx.receiving = false;
 
-                // Send NACK
-                network_message_t ack;
-                protocol_create_cfg_ack(&ack, MY_NODE_ID, msg->header.source_id, 2);
-                esp_now_send_message(&g_network, msg->header.source_id, &ack, sizeof(msg_cfg_ack_t));
+                // No way to tell which chunk is bad: ask for all of them
+                memset(g_config_rx.chunk_bitmap, 0, sizeof(g_config_rx.chunk_bitmap));
+                g_config_rx.chunks_received = 0;
+                g_config_rx.crc_chunks = 0;
+                g_config_rx.crc = 0;
+                send_cfg_ack(hub_id, CFG_STATUS_CHECKSUM, checksum);
                 break;
             }
 
             // Load configuration
+            uint8_t status = CFG_STATUS_REJECTED;
             if (session_load_config_binary(&g_session, g_config_rx.buffer, g_config_rx.total_size)) {
                 ESP_LOGI(TAG, "Configuration loaded successfully");
 
                 // Apply to node
                 if (session_apply_to_node(&g_session, &g_node)) {
                     ESP_LOGI(TAG, "Configuration applied to modal node");
+                    adopt_received_config(g_config_rx.total_size, checksum);
+                    apply_network_role();
+                    status = CFG_STATUS_OK;
 
-                    // Send ACK
-                    network_message_t ack;
-                    protocol_create_cfg_ack(&ack, MY_NODE_ID, msg->header.source_id, 0);
-                    esp_now_send_message(&g_network, msg->header.source_id, &ack, sizeof(msg_cfg_ack_t));
+                    // Persisted by the network task (NVS writes stall flash)
+                    g_config_rx.cache_checksum = checksum;
+                    if (g_network_task) xTaskNotifyGive(g_network_task);
                 } else {
                     ESP_LOGE(TAG, "Failed to apply configuration");
                 }
@@ -297,7 +632,17 @@ static void on_network_message_received(const network_message_t* msg) {
                 ESP_LOGE(TAG, "Failed to load configuration");
             }
 
+            // Rejected: keep the session on the applied blob, since the
+            // next transfer overwrites this one
+            if (status != CFG_STATUS_OK && g_session.blob == g_config_rx.buffer) {
+                if (!g_config_rx.applied ||
+                    !session_load_config_binary(&g_session, g_config_rx.applied, g_config_rx.applied_size)) {
+                    g_session.blob = NULL;
+                }
+            }
+
             g_config_rx.receiving = false;
+            send_cfg_ack(hub_id, status, checksum);
             break;
         }
 
@@ -307,6 +652,80 @@ static void on_network_message_received(const network_message_t* msg) {
     }
 }
 
+/**
+ * @brief Network callback: handle a received message, timed as network load
+ */
+static void on_network_message_received(const network_message_t* msg) {
+    int64_t start_us = esp_timer_get_time();
+    handle_network_message(msg);
+    task_timing_record(&g_network_timing, start_us, esp_timer_get_time());
+}
+
+static uint16_t saturate_u16(uint32_t value) {
+    return (value > UINT16_MAX) ? UINT16_MAX : (uint16_t)value;
+}
+
+/**
+ * @brief Fill the heartbeat's health and task timing fields
+ *
+ * Loads cover the time since the previous heartbeat. Control and
+ * network share core 0, audio has core 1 to itself, so the busier of
+ * the two sums is reported as cpu_usage.
+ */
+static void fill_heartbeat_telemetry(msg_heartbeat_t* hb) {
+    static task_load_meter_t control_meter, network_meter, audio_meter;
+    int64_t now_us = esp_timer_get_time();
+
+    audio_pipeline_stats_t audio_stats;
+    audio_i2s_get_stats(&audio_stats);
+
+    hb->audio_underruns = (uint16_t)audio_stats.underruns;
+    hb->audio_late_buffers = (uint16_t)audio_stats.late_buffers;
+    hb->audio_max_render_us = saturate_u16(audio_stats.max_render_us);
+
+    hb->control_load = task_load_sample(&control_meter, g_control_timing.busy_us, now_us);
+    hb->network_load = task_load_sample(&network_meter, g_network_timing.busy_us, now_us);
+    hb->audio_load = task_load_sample(&audio_meter, audio_stats.render_busy_us, now_us);
+
+    uint32_t core0_load = hb->control_load + hb->network_load;
+    if (core0_load > 100) core0_load = 100;
+    hb->cpu_usage = (core0_load > hb->audio_load) ? (uint8_t)core0_load : hb->audio_load;
+
+    hb->control_max_us = saturate_u16(g_control_timing.max_us);
+    hb->control_overruns = (uint16_t)g_control_timing.overruns;
+    hb->poke_queue_hwm = (uint8_t)g_poke_stats.max_depth;
+    hb->poke_drops = (uint16_t)g_poke_stats.dropped;
+    hb->pokes_received = (uint16_t)g_poke_stats.received;
+}
+
+/**
+ * @brief Store a newly assigned node ID and the configuration just
+ *        applied in NVS (network task)
+ *
+ * A later accepted transfer hands the applied buffer back for receiving,
+ * so the blob is checked against the applied CRC before it is stored.
+ */
+static void cache_applied_config(void) {
+    uint8_t node_id = g_store_node_id;
+    if (node_id != NODE_ID_NONE) {
+        g_store_node_id = NODE_ID_NONE;
+        session_cache_store_node_id(node_id);
+    }
+
+    uint32_t checksum = g_config_rx.cache_checksum;
+    if (checksum == 0) return;
+    g_config_rx.cache_checksum = 0;
+
+    const uint8_t* blob = g_config_rx.applied;
+    uint16_t len = g_config_rx.applied_size;
+    if (!blob || protocol_crc32(blob, len) != checksum) {
+        ESP_LOGW(TAG, "Configuration changed before caching, skipped");
+        return;
+    }
+
+    session_cache_store(blob, len, checksum);
+}
+
 /**
  * @brief Network task: ESP-NOW message handling
  */
@@ -314,12 +733,15 @@ static void network_task(void* pvParameters) {
     ESP_LOGI(TAG, "Network task started on core %d", xPortGetCoreID());
 
     // Initialize ESP-NOW manager
-    if (!esp_now_manager_init(&g_network, MY_NODE_ID)) {
+    if (!esp_now_manager_init(&g_network, g_node_id)) {
         ESP_LOGE(TAG, "Failed to initialize ESP-NOW");
         vTaskDelete(NULL);
         return;
     }
 
+    // A warm-started configuration's group (init cleared the manager)
+    apply_network_role();
+
     // Register message callback
     esp_now_register_message_callback(&g_network, on_network_message_received);
 
@@ -327,20 +749,47 @@ static void network_task(void* pvParameters) {
     esp_now_start_discovery(&g_network);
     ESP_LOGI(TAG, "ESP-NOW discovery started");
 
+    // Announce ourselves: a hub that booted first registers us without
+    // waiting for its next discovery round
+    send_hello();
+
     // Heartbeat loop
+    TickType_t last_heartbeat = xTaskGetTickCount();
     while (1) {
-        // Send heartbeat every 5 seconds
-        vTaskDelay(pdMS_TO_TICKS(5000));
+        // Send heartbeat every 5 seconds; woken early to cache a new config
+        TickType_t elapsed = xTaskGetTickCount() - last_heartbeat;
+        TickType_t interval = pdMS_TO_TICKS(NODE_HEARTBEAT_INTERVAL_MS);
+        if (elapsed < interval) {
+            if (ulTaskNotifyTake(pdTRUE, interval - elapsed)) cache_applied_config();
+            continue;
+        }
+        last_heartbeat += interval;
 
         network_message_t heartbeat;
-        heartbeat.heartbeat.header.type = MSG_HEARTBEAT;
-        heartbeat.heartbeat.header.source_id = MY_NODE_ID;
-        heartbeat.heartbeat.header.dest_id = 0xFF; // Broadcast
-        heartbeat.heartbeat.uptime_ms = esp_log_timestamp();
-        heartbeat.heartbeat.cpu_usage = 0; // TODO: Calculate actual CPU usage
+        protocol_create_heartbeat(&heartbeat, g_node_id, esp_log_timestamp(), 0);
+        fill_heartbeat_telemetry(&heartbeat.heartbeat);
+        heartbeat.heartbeat.header.dest_id = NODE_ID_HUB;  // Relays carry it upstream
 
         esp_now_broadcast_message(&g_network, &heartbeat, sizeof(msg_heartbeat_t));
 
+        ESP_LOGI(TAG, "Load: control %u%%, network %u%%, audio %u%%; "
+                 "control max %u us, %u overruns",
+                 heartbeat.heartbeat.control_load, heartbeat.heartbeat.network_load,
+                 heartbeat.heartbeat.audio_load, (unsigned)g_control_timing.max_us,
+                 (unsigned)g_control_timing.overruns);
+
+        ESP_LOGI(TAG, "Pokes: %u received, %u merged, %u dropped, max depth %u, "
+                 "%u scheduled, %u late",
+                 (unsigned)g_poke_stats.received, (unsigned)g_poke_stats.merged,
+                 (unsigned)g_poke_stats.dropped, (unsigned)g_poke_stats.max_depth,
+                 (unsigned)g_poke_stats.scheduled, (unsigned)g_poke_stats.late);
+        ESP_LOGI(TAG, "Clock: %s, skew %.1f ppm, last residual %d us, %u beacons, %u rejected",
+                 clock_sync_is_synced(&g_clock) ? "synced" : "free-running",
+                 g_clock.skew * 1e6f, (int)g_clock.last_residual_us,
+                 (unsigned)g_clock.beacons, (unsigned)g_clock.rejected);
+        ESP_LOGI(TAG, "Neighbor states: %u received, %u stale skips",
+                 (unsigned)g_neighbors.updates, (unsigned)g_neighbors.stale_skips);
+
         // Check for stale peers
         esp_now_check_stale_peers(&g_network, 10000); // 10s timeout
     }
@@ -354,8 +803,6 @@ static void network_task(void* pvParameters) {
  * @brief Initialize all subsystems
  */
 static void system_init(void) {
-    ESP_LOGI(TAG, "Initializing modal resonator node %d", MY_NODE_ID);
-
     // Initialize NVS (for WiFi/ESP-NOW)
     esp_err_t ret = nvs_flash_init();
     if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
@@ -364,15 +811,24 @@ static void system_init(void) {
     }
     ESP_ERROR_CHECK(ret);
 
+    // The ID the hub gave us last time (MY_NODE_ID before the first OFFER)
+    uint8_t cached_id;
+    if (session_cache_node_id(&cached_id)) g_node_id = cached_id;
+    ESP_LOGI(TAG, "Initializing modal resonator node %d", g_node_id);
+
     // Create poke event queue
-    g_poke_queue = xQueueCreate(16, sizeof(poke_event_t));
+    g_poke_queue = xQueueCreate(POKE_QUEUE_LENGTH, sizeof(scheduled_poke_t));
     if (g_poke_queue == NULL) {
         ESP_LOGE(TAG, "Failed to create poke queue");
         abort();
     }
 
     // Initialize modal node
-    modal_node_init(&g_node, MY_NODE_ID, PERSONALITY_RESONATOR);
+    modal_node_init(&g_node, g_node_id, PERSONALITY_RESONATOR);
+    neighbor_cache_init(&g_neighbors);
+    clock_sync_init(&g_clock);
+    task_timing_init(&g_control_timing, CONTROL_PERIOD_US);
+    task_timing_init(&g_network_timing, 0);
 
     // Configure 4 modes (default preset)
     modal_node_set_mode(&g_node, 0, freq_to_omega(440.0f), 0.5f, 1.0f);  // Mode 0: carrier
@@ -382,15 +838,26 @@ static void system_init(void) {
 
     g_node.audio_gain = 0.7f;
 
-    // Initialize audio synthesis (frequencies come from mode parameters)
-    audio_synth_init(&g_audio, &g_node);
-    audio_i2s_init();
-
     // Initialize session manager
-    session_manager_init(&g_session, MY_NODE_ID);
+    session_manager_init(&g_session, g_node_id);
+
+    // Warm start: apply the last accepted session right away; its CRC in
+    // our HELLO lets the hub skip the transfer
+    size_t cached_len;
+    uint32_t cached_crc;
+    if (session_cache_load(g_config_rx.buffer, SESSION_BLOB_MAX_SIZE, &cached_len, &cached_crc) &&
+        session_load_config_binary(&g_session, g_config_rx.buffer, cached_len) &&
+        session_apply_to_node(&g_session, &g_node)) {
+        adopt_received_config((uint16_t)cached_len, cached_crc);
+        ESP_LOGI(TAG, "Cached session applied (%u bytes, crc=0x%08X)",
+                 (unsigned)cached_len, (unsigned)cached_crc);
+    }
 
-    // Load default preset (TODO: load from config)
-    // preset_ring_16_resonator(&g_session);
+    // Audio reads the node through snapshots (frequencies come from mode parameters)
+    modal_snapshot_init(&g_node_state);
+    modal_snapshot_publish(&g_node_state, &g_node);
+    audio_synth_init(&g_audio, &g_node_state);
+    audio_i2s_init();
 
     ESP_LOGI(TAG, "System initialization complete");
 }
@@ -401,7 +868,6 @@ static void system_init(void) {
 
 void app_main(void) {
     ESP_LOGI(TAG, "=== ESP32 Modal Resonator Node ===");
-    ESP_LOGI(TAG, "Node ID: %d", MY_NODE_ID);
     ESP_LOGI(TAG, "Firmware Version: 1.0");
 
     // Initialize system
@@ -439,7 +905,7 @@ void app_main(void) {
         NETWORK_TASK_STACK_SIZE,
         NULL,
         NETWORK_TASK_PRIORITY,
-        NULL,
+        &g_network_task,
         NETWORK_TASK_CORE
     );
 
@@ -0,0 +1,120 @@
+/**
+ * @file clock_sync.c
+ * @brief Offset/drift estimation from reference beacons
+ */
+
+#include "clock_sync.h"
+#include <string.h>
+
+void clock_sync_init(clock_sync_t* sync) {
+    memset(sync, 0, sizeof(clock_sync_t));
+    portMUX_INITIALIZE(&sync->lock);
+}
+
+static int64_t model_offset(const clock_sync_t* sync, int64_t local_us) {
+    return sync->anchor_offset_us +
+           (int64_t)(sync->skew * (float)(local_us - sync->anchor_local_us));
+}
+
+static void restart(clock_sync_t* sync) {
+    sync->count = 0;
+    sync->next = 0;
+    sync->outliers = 0;
+    sync->resyncs++;
+}
+
+// Least-squares line through (local, offset), relative to the newest sample
+static void fit(clock_sync_t* sync) {
+    uint8_t newest = (sync->next + CLOCK_SYNC_SAMPLES - 1) % CLOCK_SYNC_SAMPLES;
+    int64_t base_local = sync->local_us[newest];
+    int64_t base_offset = sync->offset_us[newest];
+
+    float mean_x = 0.0f, mean_y = 0.0f;
+    for (uint8_t i = 0; i < sync->count; i++) {
+        mean_x += (float)(sync->local_us[i] - base_local);
+        mean_y += (float)(sync->offset_us[i] - base_offset);
+    }
+    mean_x /= sync->count;
+    mean_y /= sync->count;
+
+    float sxx = 0.0f, sxy = 0.0f;
+    for (uint8_t i = 0; i < sync->count; i++) {
+        float dx = (float)(sync->local_us[i] - base_local) - mean_x;
+        float dy = (float)(sync->offset_us[i] - base_offset) - mean_y;
+        sxx += dx * dx;
+        sxy += dx * dy;
+    }
+
+    portENTER_CRITICAL(&sync->lock);
+    sync->anchor_local_us = base_local + (int64_t)mean_x;
+    sync->anchor_offset_us = base_offset + (int64_t)mean_y;
+    sync->skew = (sync->count >= 2 && sxx > 0.0f) ? sxy / sxx : 0.0f;
+    sync->synced = true;
+    portEXIT_CRITICAL(&sync->lock);
+}
+
+void clock_sync_update(clock_sync_t* sync, int64_t reference_us, int64_t local_us) {
+    int64_t offset_us = reference_us - local_us;
+
+    if (sync->count > 0) {
+        uint8_t newest = (sync->next + CLOCK_SYNC_SAMPLES - 1) % CLOCK_SYNC_SAMPLES;
+        int64_t last_reference = sync->local_us[newest] + sync->offset_us[newest];
+
+        if (reference_us <= last_reference) {
+            // Reference restarted (or a duplicate): start over
+            restart(sync);
+        } else {
+            int64_t residual = offset_us - model_offset(sync, local_us);
+            sync->last_residual_us = (int32_t)residual;
+
+            if (sync->count >= 2 &&
+                (residual > CLOCK_SYNC_OUTLIER_US || residual < -CLOCK_SYNC_OUTLIER_US)) {
+                sync->rejected++;
+                if (++sync->outliers < CLOCK_SYNC_MAX_OUTLIERS) return;
+                restart(sync);
+            }
+        }
+    }
+
+    sync->outliers = 0;
+    sync->local_us[sync->next] = local_us;
+    sync->offset_us[sync->next] = offset_us;
+    sync->next = (sync->next + 1) % CLOCK_SYNC_SAMPLES;
+    if (sync->count < CLOCK_SYNC_SAMPLES) sync->count++;
+    sync->beacons++;
+
+    fit(sync);
+}
+
+bool clock_sync_is_synced(clock_sync_t* sync) {
+    portENTER_CRITICAL(&sync->lock);
+    bool synced = sync->synced;
+    portEXIT_CRITICAL(&sync->lock);
+    return synced;
+}
+
+int64_t clock_sync_to_shared(clock_sync_t* sync, int64_t local_us) {
+    portENTER_CRITICAL(&sync->lock);
+    int64_t shared_us = sync->synced ? local_us + model_offset(sync, local_us) : local_us;
+    portEXIT_CRITICAL(&sync->lock);
+    return shared_us;
+}
+
+int64_t clock_sync_to_local(clock_sync_t* sync, int64_t shared_us) {
+    portENTER_CRITICAL(&sync->lock);
+    // Offset evaluated at the estimate itself; skew is small enough
+    // that one correction step is exact to well under 1 µs
+    int64_t local_us = shared_us;
+    if (sync->synced) {
+        local_us = shared_us - sync->anchor_offset_us;
+        local_us = shared_us - model_offset(sync, local_us);
+    }
+    portEXIT_CRITICAL(&sync->lock);
+    return local_us;
+}
+
+int64_t clock_sync_wire_to_local(clock_sync_t* sync, uint32_t shared_us32, int64_t now_local_us) {
+    int64_t now_shared = clock_sync_to_shared(sync, now_local_us);
+    int32_t delta = (int32_t)(shared_us32 - (uint32_t)now_shared);
+    return clock_sync_to_local(sync, now_shared + delta);
+}
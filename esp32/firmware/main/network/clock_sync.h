@@ -0,0 +1,130 @@
+/**
+ * @file clock_sync.h
+ * @brief Hub-referenced shared timebase for scheduled events
+ *
+ * The hub's esp_timer clock is the shared timebase. Its heartbeats carry
+ * that clock (HEARTBEAT_FLAG_TIME_REFERENCE); each node pairs the value
+ * with its own clock at reception and fits offset and drift over the
+ * last CLOCK_SYNC_SAMPLES beacons by least squares.
+ *
+ * A beacon is one broadcast frame heard by every node at the same
+ * instant, so the hub's send latency shifts all nodes equally and only
+ * receive-side jitter separates them. Samples far off the current fit
+ * are treated as delayed frames and dropped; several in a row (or the
+ * reference clock going backwards) mean the hub restarted, and the fit
+ * starts over.
+ */
+
+#ifndef CLOCK_SYNC_H
+#define CLOCK_SYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define CLOCK_SYNC_SAMPLES 8             // Beacons in the drift fit
+#define CLOCK_SYNC_OUTLIER_US 2000       // Residual beyond this is a delayed frame
+#define CLOCK_SYNC_MAX_OUTLIERS 3        // Consecutive outliers before re-sync
+
+// ============================================================================
+// Type Definitions
+// ============================================================================
+
+/**
+ * @brief Offset/drift estimate, shared by the network (writer) and
+ *        control (reader) tasks
+ */
+typedef struct {
+    // Sample window (network task only)
+    int64_t local_us[CLOCK_SYNC_SAMPLES];   ///< Local clock at reception
+    int64_t offset_us[CLOCK_SYNC_SAMPLES];  ///< Reference − local
+    uint8_t count;                          ///< Valid samples
+    uint8_t next;                           ///< Ring write index
+    uint8_t outliers;                       ///< Consecutive rejected samples
+
+    // Fitted model: shared = local + offset + skew · (local − anchor)
+    portMUX_TYPE lock;       ///< Guards the model fields
+    int64_t anchor_local_us; ///< Mean local time of the window
+    int64_t anchor_offset_us;///< Offset at the anchor
+    float skew;              ///< Reference rate − 1 (drift, ~1e-5)
+    bool synced;             ///< Model valid (≥ 1 sample)
+
+    // Diagnostics
+    int32_t last_residual_us;///< Last sample vs. the model before it
+    uint32_t beacons;        ///< Samples accepted
+    uint32_t rejected;       ///< Samples dropped as outliers
+    uint32_t resyncs;        ///< Fits restarted
+} clock_sync_t;
+
+// ============================================================================
+// API
+// ============================================================================
+
+/**
+ * @brief Initialize an unsynchronized clock
+ *
+ * @param sync Clock to initialize
+ */
+void clock_sync_init(clock_sync_t* sync);
+
+/**
+ * @brief Add a reference beacon (network task)
+ *
+ * @param sync Shared clock
+ * @param reference_us Reference clock carried by the beacon
+ * @param local_us Local clock at reception (esp_timer_get_time)
+ */
+void clock_sync_update(clock_sync_t* sync, int64_t reference_us, int64_t local_us);
+
+/**
+ * @brief Whether the shared timebase is known
+ *
+ * @param sync Shared clock
+ * @return true once a beacon has been accepted
+ */
+bool clock_sync_is_synced(clock_sync_t* sync);
+
+/**
+ * @brief Convert local time to shared time
+ *
+ * @param sync Shared clock
+ * @param local_us Local time (µs)
+ * @return Shared time (µs); local_us unchanged if not synced
+ */
+int64_t clock_sync_to_shared(clock_sync_t* sync, int64_t local_us);
+
+/**
+ * @brief Convert shared time to local time
+ *
+ * @param sync Shared clock
+ * @param shared_us Shared time (µs)
+ * @return Local time (µs); shared_us unchanged if not synced
+ */
+int64_t clock_sync_to_local(clock_sync_t* sync, int64_t shared_us);
+
+/**
+ * @brief Local time of a 32-bit shared timestamp
+ *
+ * Wire timestamps carry the low 32 bits of shared µs; the full value is
+ * the one closest to now (±35 minutes).
+ *
+ * @param sync Shared clock
+ * @param shared_us32 Low 32 bits of a shared time
+ * @param now_local_us Current local time
+ * @return Local time (µs)
+ */
+int64_t clock_sync_wire_to_local(clock_sync_t* sync, uint32_t shared_us32, int64_t now_local_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLOCK_SYNC_H
@@ -7,6 +7,12 @@
  * - Message routing with retries
  * - Statistics tracking
  * - Configuration chunking support
+ *
+ * Sending: callers only enqueue. esp_now_tx_task takes one frame at a
+ * time, resolves the MAC through peer_index, calls esp_now_send() and
+ * waits for esp_now_send_cb to give tx_done before the next frame, so
+ * retries and radio back-pressure cost the sender task, not the MIDI or
+ * control path.
  */
 
 #include "esp_now_manager.h"
@@ -15,6 +21,8 @@
 #include "esp_now.h"
 #include "esp_timer.h"
 #include "nvs_flash.h"
+#include <stddef.h>
+#include <stdio.h>
 #include <string.h>
 
 #define TAG "ESP_NOW_MGR"
@@ -30,6 +38,145 @@ static uint32_t g_tx_count = 0;
 static uint32_t g_rx_count = 0;
 static uint32_t g_tx_fail_count = 0;
 
+static peer_info_t* peer_by_id(esp_now_manager_t* mgr, uint8_t node_id) {
+    uint8_t index = mgr->peer_index[node_id];
+    return (index == PEER_INDEX_NONE) ? NULL : &mgr->peers[index];
+}
+
+// ============================================================================
+// Link Measurement
+// ============================================================================
+
+static void rtt_clear_slot(peer_rtt_t* rtt, uint8_t slot) {
+    uint8_t sample = rtt->samples[slot];
+    if (sample < RTT_HISTOGRAM_BINS) {
+        rtt->bins[sample]--;
+        rtt->echoed--;
+    } else if (sample == PING_SAMPLE_LOST) {
+        rtt->lost--;
+    }
+    rtt->samples[slot] = PING_SAMPLE_EMPTY;
+}
+
+/**
+ * @brief Answer a PING addressed to us (WiFi task)
+ */
+static void handle_ping(esp_now_manager_t* mgr, const msg_ping_t* ping) {
+    if (ping->header.dest_id != mgr->my_node_id && ping->header.dest_id != 0xFF) return;
+
+    network_message_t echo;
+    size_t len = protocol_create_echo(&echo, mgr->my_node_id, ping);
+    esp_now_send_message(mgr, ping->header.source_id, &echo, len);
+}
+
+/**
+ * @brief Record the ECHO of one of our PINGs (WiFi task)
+ */
+static void handle_echo(esp_now_manager_t* mgr, peer_info_t* peer, const msg_ping_t* echo) {
+    if (echo->header.dest_id != mgr->my_node_id) return;
+
+    int64_t rtt_us = esp_timer_get_time() - echo->sent_us;
+    if (rtt_us < 0) return;
+
+    uint32_t bin = (uint32_t)(rtt_us / RTT_BIN_US);
+    if (bin >= RTT_HISTOGRAM_BINS) bin = RTT_HISTOGRAM_BINS - 1;
+
+    peer_rtt_t* rtt = &peer->rtt;
+    uint8_t slot = echo->ping_seq % PING_WINDOW;
+
+    portENTER_CRITICAL(&mgr->rtt_lock);
+    if (echo->ping_seq == (uint16_t)(rtt->next_seq - 1) &&
+        rtt->samples[slot] == PING_SAMPLE_PENDING) {
+        rtt->samples[slot] = (uint8_t)bin;
+        rtt->bins[bin]++;
+        rtt->echoed++;
+        rtt->echoes++;
+        rtt->last_rtt_us = (uint32_t)rtt_us;
+
+        // One-way estimate, smoothed over ~8 echoes
+        float one_way_ms = (float)rtt_us / 2000.0f;
+        peer->latency_ms = (peer->latency_ms > 0.0f)
+                               ? peer->latency_ms + (one_way_ms - peer->latency_ms) / 8.0f
+                               : one_way_ms;
+    } else {
+        rtt->late_echoes++;
+    }
+    portEXIT_CRITICAL(&mgr->rtt_lock);
+}
+
+// ============================================================================
+// Duplicate Suppression & Relaying
+// ============================================================================
+
+/**
+ * @brief Record (source, sequence); true if it was seen before (WiFi task)
+ *
+ * A source silent for RX_DEDUP_RESET_MS, or jumping back past the
+ * window, has restarted its sequence (rebooted) and starts over.
+ */
+static bool rx_seen_before(esp_now_manager_t* mgr, const message_header_t* header, uint32_t now_ms) {
+    rx_dedup_t* seen = &mgr->rx_seen[header->source_id];
+    bool restart = (seen->window == 0) || (now_ms - seen->last_ms > RX_DEDUP_RESET_MS);
+    seen->last_ms = now_ms;
+
+    int16_t ahead = (int16_t)(header->sequence - seen->newest);
+    if (!restart && ahead > 0) {
+        seen->window = (ahead >= RX_DEDUP_WINDOW) ? 1 : (seen->window << ahead) | 1;
+        seen->newest = header->sequence;
+        return false;
+    }
+    if (restart || -ahead >= RX_DEDUP_WINDOW) {
+        seen->newest = header->sequence;
+        seen->window = 1;
+        return false;
+    }
+
+    uint32_t bit = 1u << -ahead;
+    if (seen->window & bit) return true;
+    seen->window |= bit;
+    return false;
+}
+
+/**
+ * @brief Whether a relay forwards this frame
+ *
+ * Downstream: every hub frame not addressed to the relay itself (any
+ * group or node may sit beyond it). Upstream: node frames for the hub.
+ * Node-to-node traffic stays local.
+ */
+static bool relay_should_forward(const esp_now_manager_t* mgr, const network_message_t* msg) {
+    uint8_t dest = msg->header.dest_id;
+
+    if (msg->header.type == MSG_HELLO && (msg->hello.capabilities & HELLO_CAP_RELAYED)) {
+        return false;  // One hop for discovery (HELLOs bypass duplicate suppression)
+    }
+
+    if (msg->header.source_id == NODE_ID_HUB) {
+        return dest != mgr->my_node_id;
+    }
+
+    return dest == NODE_ID_HUB;
+}
+
+static void relay_frame(esp_now_manager_t* mgr, const network_message_t* msg,
+                        const uint8_t* data, int len) {
+    esp_now_tx_request_t req;
+    req.dest_id = NODE_ID_BROADCAST;
+    req.len = (uint8_t)len;
+    memcpy(req.data, data, len);
+
+    // The receiver cannot take the sender's MAC from the radio any more
+    if (msg->header.type == MSG_HELLO) {
+        req.data[offsetof(msg_hello_t, capabilities)] |= HELLO_CAP_RELAYED;
+    }
+
+    if (xQueueSend(mgr->tx_queue, &req, 0) == pdTRUE) {
+        mgr->relayed++;
+    } else {
+        mgr->tx_queue_full++;
+    }
+}
+
 // ============================================================================
 // Static Callbacks
 // ============================================================================
@@ -46,13 +193,52 @@ static void esp_now_recv_cb(const esp_now_recv_info_t* recv_info, const uint8_t*
         return;
     }
 
-    // Update peer statistics
-    for (int i = 0; i < g_manager->num_peers; i++) {
-        if (mac_equal(g_manager->peers[i].mac_address, recv_info->src_addr)) {
-            g_manager->peers[i].packets_received++;
-            g_manager->peers[i].last_seen_ms = esp_timer_get_time() / 1000;
-            break;
-        }
+    // Our own frame, re-broadcast by a relay
+    if (msg.header.source_id == g_manager->my_node_id && msg.header.source_id != 0) {
+        return;
+    }
+
+    // Copies arriving directly and through a relay, or resent after a
+    // lost send-complete (HELLOs come from nodes that may share an ID)
+    uint32_t now_ms = esp_timer_get_time() / 1000;
+    if (msg.header.type != MSG_HELLO && rx_seen_before(g_manager, &msg.header, now_ms)) {
+        g_manager->rx_duplicates++;
+        return;
+    }
+
+    if (g_manager->relay && len <= MAX_PACKET_SIZE && relay_should_forward(g_manager, &msg)) {
+        relay_frame(g_manager, &msg, data, len);
+    }
+
+    if (!protocol_addressed_to(msg.header.dest_id, g_manager->my_node_id, g_manager->my_group)) {
+        g_manager->rx_not_for_us++;
+        return;
+    }
+
+    // Trust the radio's source address over the payload's (a relayed
+    // HELLO's radio address is the relay's)
+    if (msg.header.type == MSG_HELLO && !(msg.hello.capabilities & HELLO_CAP_RELAYED)) {
+        memcpy(msg.hello.mac_address, recv_info->src_addr, 6);
+    }
+
+    // Update peer statistics (source ID lookup, MAC must match)
+    peer_info_t* peer = peer_by_id(g_manager, msg.header.source_id);
+    if (peer && !mac_equal(peer->mac_address, recv_info->src_addr)) {
+        peer = NULL;
+    }
+    if (peer) {
+        peer->packets_received++;
+        peer->last_seen_ms = now_ms;
+    }
+
+    // Link measurement is handled here, below the application
+    if (msg.header.type == MSG_PING) {
+        handle_ping(g_manager, &msg.ping);
+        return;
+    }
+    if (msg.header.type == MSG_ECHO) {
+        if (peer) handle_echo(g_manager, peer, &msg.ping);
+        return;
     }
 
     // Call user callback
@@ -64,31 +250,95 @@ static void esp_now_recv_cb(const esp_now_recv_info_t* recv_info, const uint8_t*
              msg.header.type, msg.header.source_id, len);
 }
 
+/**
+ * @brief Send-complete callback (WiFi task): hand the status to the sender
+ */
 static void esp_now_send_cb(const uint8_t* mac_addr, esp_now_send_status_t status) {
-    if (status == ESP_NOW_SEND_SUCCESS) {
-        g_tx_count++;
-
-        // Update peer statistics
-        if (g_manager) {
-            for (int i = 0; i < g_manager->num_peers; i++) {
-                if (mac_equal(g_manager->peers[i].mac_address, mac_addr)) {
-                    g_manager->peers[i].packets_sent++;
-                    break;
-                }
-            }
+    if (!g_manager) return;
+
+    g_manager->tx_inflight_ok = (status == ESP_NOW_SEND_SUCCESS);
+    xSemaphoreGive(g_manager->tx_done);
+}
+
+// ============================================================================
+// Sender Task
+// ============================================================================
+
+/**
+ * @brief Transmit one frame, waiting for its completion
+ *
+ * Retries when the driver refuses the frame (its queue is full) or a
+ * unicast frame is not acknowledged. Broadcasts are never acknowledged,
+ * so their completion only paces the queue.
+ */
+static bool transmit(esp_now_manager_t* mgr, const esp_now_tx_request_t* req) {
+    uint8_t dest_mac[6];
+    uint8_t index = (req->dest_id == 0xFF) ? PEER_INDEX_NONE : mgr->peer_index[req->dest_id];
+    if (index != PEER_INDEX_NONE && !mgr->peers[index].active) {
+        index = PEER_INDEX_NONE;
+    }
+
+    if (index == PEER_INDEX_NONE) {
+        if (req->dest_id != 0xFF) {
+            ESP_LOGD(TAG, "Peer %d not found, using broadcast", req->dest_id);
         }
+        memset(dest_mac, 0xFF, 6);
     } else {
-        g_tx_fail_count++;
-        ESP_LOGW(TAG, "TX failed to " MACSTR, MAC2STR(mac_addr));
-
-        // Update peer lost packets
-        if (g_manager) {
-            for (int i = 0; i < g_manager->num_peers; i++) {
-                if (mac_equal(g_manager->peers[i].mac_address, mac_addr)) {
-                    g_manager->peers[i].packets_lost++;
-                    break;
-                }
+        memcpy(dest_mac, mgr->peers[index].mac_address, 6);
+    }
+
+    for (int attempt = 0; attempt < MAX_SEND_RETRIES; attempt++) {
+        if (attempt > 0) {
+            mgr->tx_retries++;
+        }
+
+        // Drop a completion that arrived after an earlier timeout
+        xSemaphoreTake(mgr->tx_done, 0);
+        mgr->tx_inflight_peer = index;
+
+        esp_err_t err = esp_now_send(dest_mac, req->data, req->len);
+        if (err != ESP_OK) {
+            ESP_LOGD(TAG, "TX busy (attempt %d/%d): %s",
+                     attempt + 1, MAX_SEND_RETRIES, esp_err_to_name(err));
+            vTaskDelay(1);
+            continue;
+        }
+
+        if (xSemaphoreTake(mgr->tx_done, pdMS_TO_TICKS(ESP_NOW_TX_TIMEOUT_MS)) != pdTRUE) {
+            ESP_LOGW(TAG, "TX to node %d: no send-complete", req->dest_id);
+            continue;
+        }
+
+        if (mgr->tx_inflight_ok || index == PEER_INDEX_NONE) {
+            ESP_LOGD(TAG, "TX: type=0x%02X to=%d len=%d",
+                     req->data[0], req->dest_id, req->len);
+            if (index != PEER_INDEX_NONE) {
+                mgr->peers[index].packets_sent++;
             }
+            return true;
+        }
+    }
+
+    if (index != PEER_INDEX_NONE) {
+        mgr->peers[index].packets_lost++;
+    }
+    ESP_LOGW(TAG, "TX failed to node %d after %d attempts", req->dest_id, MAX_SEND_RETRIES);
+    return false;
+}
+
+static void esp_now_tx_task(void* pvParameters) {
+    esp_now_manager_t* mgr = (esp_now_manager_t*)pvParameters;
+    esp_now_tx_request_t req;
+
+    while (1) {
+        if (xQueueReceive(mgr->tx_queue, &req, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        if (transmit(mgr, &req)) {
+            g_tx_count++;
+        } else {
+            g_tx_fail_count++;
         }
     }
 }
@@ -102,6 +352,10 @@ bool esp_now_manager_init(esp_now_manager_t* mgr, uint8_t my_node_id) {
 
     memset(mgr, 0, sizeof(esp_now_manager_t));
     mgr->my_node_id = my_node_id;
+    memset(mgr->peer_index, PEER_INDEX_NONE, sizeof(mgr->peer_index));
+    mgr->tx_inflight_peer = PEER_INDEX_NONE;
+    mgr->my_group = GROUP_NONE;
+    portMUX_INITIALIZE(&mgr->rtt_lock);
     g_manager = mgr;
 
     ESP_LOGI(TAG, "Initializing ESP-NOW for node %d", my_node_id);
@@ -156,6 +410,21 @@ bool esp_now_manager_init(esp_now_manager_t* mgr, uint8_t my_node_id) {
         return false;
     }
 
+    // Sender task owns the radio from here on
+    mgr->tx_queue = xQueueCreate(ESP_NOW_TX_QUEUE_LENGTH, sizeof(esp_now_tx_request_t));
+    mgr->tx_done = xSemaphoreCreateBinary();
+    if (!mgr->tx_queue || !mgr->tx_done) {
+        ESP_LOGE(TAG, "Failed to create TX queue");
+        return false;
+    }
+
+    if (xTaskCreatePinnedToCore(esp_now_tx_task, "espnow_tx", ESP_NOW_TX_TASK_STACK,
+                                mgr, ESP_NOW_TX_TASK_PRIORITY, &mgr->tx_task,
+                                ESP_NOW_TX_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start TX task");
+        return false;
+    }
+
     mgr->initialized = true;
     ESP_LOGI(TAG, "ESP-NOW initialized successfully");
 
@@ -165,6 +434,11 @@ bool esp_now_manager_init(esp_now_manager_t* mgr, uint8_t my_node_id) {
 void esp_now_manager_deinit(esp_now_manager_t* mgr) {
     if (!mgr || !mgr->initialized) return;
 
+    mgr->initialized = false;
+    vTaskDelete(mgr->tx_task);
+    vQueueDelete(mgr->tx_queue);
+    vSemaphoreDelete(mgr->tx_done);
+
     esp_now_deinit();
     esp_wifi_stop();
     esp_wifi_deinit();
@@ -184,54 +458,22 @@ bool esp_now_send_message(esp_now_manager_t* mgr,
                          const network_message_t* msg,
                          size_t len) {
     if (!mgr || !mgr->initialized) return false;
-
-    // Find destination MAC address
-    uint8_t dest_mac[6];
-    if (dest_id == 0xFF) {
-        // Broadcast
-        memset(dest_mac, 0xFF, 6);
-    } else {
-        // Find peer by node ID
-        bool found = false;
-        for (int i = 0; i < mgr->num_peers; i++) {
-            if (mgr->peers[i].node_id == dest_id && mgr->peers[i].active) {
-                memcpy(dest_mac, mgr->peers[i].mac_address, 6);
-                found = true;
-                break;
-            }
-        }
-
-        if (!found) {
-            ESP_LOGD(TAG, "Peer %d not found, using broadcast", dest_id);
-            memset(dest_mac, 0xFF, 6);
-        }
-    }
-
-    // Send with retries
-    int retries = MAX_SEND_RETRIES;
-    esp_err_t err;
-
-    while (retries > 0) {
-        err = esp_now_send(dest_mac, (const uint8_t*)msg, len);
-
-        if (err == ESP_OK) {
-            ESP_LOGD(TAG, "TX: type=0x%02X to=%d len=%zu",
-                     msg->header.type, dest_id, len);
-            return true;
-        }
-
-        ESP_LOGW(TAG, "TX failed (attempt %d/%d): %s",
-                 MAX_SEND_RETRIES - retries + 1, MAX_SEND_RETRIES,
-                 esp_err_to_name(err));
-
-        retries--;
-        if (retries > 0) {
-            vTaskDelay(pdMS_TO_TICKS(10));  // Wait before retry
-        }
+    if (len == 0 || len > MAX_PACKET_SIZE) return false;
+
+    esp_now_tx_request_t req;
+    req.dest_id = dest_id;
+    req.len = (uint8_t)len;
+    memcpy(req.data, msg, len);
+
+    // Never wait: a full queue means the radio is far behind anyway
+    if (xQueueSend(mgr->tx_queue, &req, 0) != pdTRUE) {
+        mgr->tx_queue_full++;
+        ESP_LOGW(TAG, "TX queue full, dropped type=0x%02X to=%d",
+                 msg->header.type, dest_id);
+        return false;
     }
 
-    ESP_LOGE(TAG, "TX failed to node %d after %d retries", dest_id, MAX_SEND_RETRIES);
-    return false;
+    return true;
 }
 
 uint8_t esp_now_broadcast_message(esp_now_manager_t* mgr,
@@ -243,6 +485,20 @@ uint8_t esp_now_broadcast_message(esp_now_manager_t* mgr,
     return 1;  // Broadcast counts as 1 send
 }
 
+void esp_now_set_group(esp_now_manager_t* mgr, uint8_t group, bool relay) {
+    if (!mgr) return;
+
+    mgr->my_group = group;
+    mgr->relay = relay;
+
+    ESP_LOGI(TAG, "Group %d%s", group, mgr->relay ? ", relaying" : "");
+}
+
+uint32_t esp_now_tx_pending(const esp_now_manager_t* mgr) {
+    if (!mgr || !mgr->initialized) return 0;
+    return (uint32_t)uxQueueMessagesWaiting(mgr->tx_queue);
+}
+
 // ============================================================================
 // Callback Registration
 // ============================================================================
@@ -265,19 +521,18 @@ void esp_now_register_discovery_callback(esp_now_manager_t* mgr,
 // Peer Management
 // ============================================================================
 
-bool esp_now_add_peer(esp_now_manager_t* mgr,
+bool esp_now_register_peer(esp_now_manager_t* mgr,
                      uint8_t node_id,
                      const uint8_t* mac) {
     if (!mgr || !mgr->initialized) return false;
 
     // Check if already exists
-    for (int i = 0; i < mgr->num_peers; i++) {
-        if (mgr->peers[i].node_id == node_id) {
-            ESP_LOGD(TAG, "Peer %d already exists, updating MAC", node_id);
-            memcpy(mgr->peers[i].mac_address, mac, 6);
-            mgr->peers[i].active = true;
-            return true;
-        }
+    peer_info_t* existing = peer_by_id(mgr, node_id);
+    if (existing) {
+        ESP_LOGD(TAG, "Peer %d already exists, updating MAC", node_id);
+        memcpy(existing->mac_address, mac, 6);
+        existing->active = true;
+        return true;
     }
 
     // Add new peer
@@ -295,7 +550,10 @@ bool esp_now_add_peer(esp_now_manager_t* mgr,
     peer->packets_received = 0;
     peer->packets_lost = 0;
     peer->latency_ms = 0.0f;
+    memset(&peer->rtt, 0, sizeof(peer->rtt));
+    memset(peer->rtt.samples, PING_SAMPLE_EMPTY, sizeof(peer->rtt.samples));
 
+    mgr->peer_index[node_id] = mgr->num_peers;
     mgr->num_peers++;
 
     // Add to ESP-NOW peer list
@@ -325,33 +583,29 @@ bool esp_now_add_peer(esp_now_manager_t* mgr,
 bool esp_now_remove_peer(esp_now_manager_t* mgr, uint8_t node_id) {
     if (!mgr) return false;
 
-    for (int i = 0; i < mgr->num_peers; i++) {
-        if (mgr->peers[i].node_id == node_id) {
-            // Remove from ESP-NOW
-            esp_now_del_peer(mgr->peers[i].mac_address);
+    peer_info_t* peer = peer_by_id(mgr, node_id);
+    if (!peer) return false;
 
-            // Mark as inactive (don't shift array to preserve indices)
-            mgr->peers[i].active = false;
+    // Remove from ESP-NOW
+    esp_now_del_peer(peer->mac_address);
 
-            ESP_LOGI(TAG, "Removed peer: node_id=%d", node_id);
-            return true;
-        }
-    }
+    // Mark as inactive (don't shift array to preserve indices)
+    peer->active = false;
 
-    return false;
+    ESP_LOGI(TAG, "Removed peer: node_id=%d", node_id);
+    return true;
 }
 
-const peer_info_t* esp_now_get_peer(const esp_now_manager_t* mgr,
+const peer_info_t* esp_now_find_peer(const esp_now_manager_t* mgr,
                                    uint8_t node_id) {
     if (!mgr) return NULL;
 
-    for (int i = 0; i < mgr->num_peers; i++) {
-        if (mgr->peers[i].node_id == node_id && mgr->peers[i].active) {
-            return &mgr->peers[i];
-        }
+    uint8_t index = mgr->peer_index[node_id];
+    if (index == PEER_INDEX_NONE || !mgr->peers[index].active) {
+        return NULL;
     }
 
-    return NULL;
+    return &mgr->peers[index];
 }
 
 uint8_t esp_now_get_all_peers(const esp_now_manager_t* mgr,
@@ -371,7 +625,7 @@ uint8_t esp_now_get_all_peers(const esp_now_manager_t* mgr,
 }
 
 bool esp_now_is_peer_active(const esp_now_manager_t* mgr, uint8_t node_id) {
-    return esp_now_get_peer(mgr, node_id) != NULL;
+    return esp_now_find_peer(mgr, node_id) != NULL;
 }
 
 // ============================================================================
@@ -403,7 +657,7 @@ void esp_now_handle_hello(esp_now_manager_t* mgr, const msg_hello_t* msg) {
     ESP_LOGI(TAG, "HELLO from node %d (%s)", node_id, msg->name);
 
     // Add as peer
-    esp_now_add_peer(mgr, node_id, mac);
+    esp_now_register_peer(mgr, node_id, mac);
 }
 
 // ============================================================================
@@ -435,6 +689,83 @@ float esp_now_get_avg_latency(const esp_now_manager_t* mgr) {
     return (count > 0) ? (sum / count) : 0.0f;
 }
 
+bool esp_now_send_ping(esp_now_manager_t* mgr, uint8_t node_id) {
+    if (!mgr || !mgr->initialized) return false;
+
+    peer_info_t* peer = peer_by_id(mgr, node_id);
+    if (!peer || !peer->active) return false;
+
+    peer_rtt_t* rtt = &peer->rtt;
+
+    portENTER_CRITICAL(&mgr->rtt_lock);
+    uint16_t seq = rtt->next_seq++;
+
+    // The previous ping had its chance
+    uint8_t prev = (uint16_t)(seq - 1) % PING_WINDOW;
+    if (rtt->samples[prev] == PING_SAMPLE_PENDING) {
+        rtt->samples[prev] = PING_SAMPLE_LOST;
+        rtt->lost++;
+    }
+
+    uint8_t slot = seq % PING_WINDOW;
+    rtt_clear_slot(rtt, slot);
+    rtt->samples[slot] = PING_SAMPLE_PENDING;
+    rtt->pings_sent++;
+    portEXIT_CRITICAL(&mgr->rtt_lock);
+
+    network_message_t ping;
+    size_t len = protocol_create_ping(&ping, mgr->my_node_id, node_id, seq);
+    return esp_now_send_message(mgr, node_id, &ping, len);
+}
+
+uint8_t esp_now_ping_peers(esp_now_manager_t* mgr) {
+    if (!mgr) return 0;
+
+    uint8_t sent = 0;
+    for (int i = 0; i < mgr->num_peers; i++) {
+        if (mgr->peers[i].active && esp_now_send_ping(mgr, mgr->peers[i].node_id)) {
+            sent++;
+        }
+    }
+
+    return sent;
+}
+
+bool esp_now_get_peer_rtt(esp_now_manager_t* mgr, uint8_t node_id, peer_rtt_t* rtt) {
+    if (!mgr || !rtt) return false;
+
+    peer_info_t* peer = peer_by_id(mgr, node_id);
+    if (!peer) return false;
+
+    portENTER_CRITICAL(&mgr->rtt_lock);
+    *rtt = peer->rtt;
+    portEXIT_CRITICAL(&mgr->rtt_lock);
+    return true;
+}
+
+uint32_t esp_now_rtt_percentile(const peer_rtt_t* rtt, uint8_t percentile) {
+    if (!rtt || rtt->echoed == 0) return 0;
+
+    // Smallest bin with at least percentile% of the echoes at or below it
+    uint32_t target = ((uint32_t)rtt->echoed * percentile + 99) / 100;
+    if (target == 0) target = 1;
+
+    uint32_t count = 0;
+    for (uint32_t bin = 0; bin < RTT_HISTOGRAM_BINS; bin++) {
+        count += rtt->bins[bin];
+        if (count >= target) return (bin + 1) * RTT_BIN_US;
+    }
+
+    return RTT_HISTOGRAM_BINS * RTT_BIN_US;
+}
+
+float esp_now_rtt_loss_rate(const peer_rtt_t* rtt) {
+    if (!rtt) return 0.0f;
+
+    uint32_t settled = rtt->echoed + rtt->lost;
+    return (settled > 0) ? (float)rtt->lost / (float)settled : 0.0f;
+}
+
 uint8_t esp_now_check_stale_peers(esp_now_manager_t* mgr, uint32_t timeout_ms) {
     if (!mgr) return 0;
 
@@ -484,6 +815,10 @@ void esp_now_print_stats(const esp_now_manager_t* mgr) {
     ESP_LOGI(TAG, "TX: %u packets", (unsigned)g_tx_count);
     ESP_LOGI(TAG, "RX: %u packets", (unsigned)g_rx_count);
     ESP_LOGI(TAG, "TX failed: %u packets", (unsigned)g_tx_fail_count);
+    if (mgr) {
+        ESP_LOGI(TAG, "TX queue full: %u, retries: %u",
+                 (unsigned)mgr->tx_queue_full, (unsigned)mgr->tx_retries);
+    }
     ESP_LOGI(TAG, "Peers: %d active", mgr ? mgr->num_peers : 0);
 
     if (mgr) {
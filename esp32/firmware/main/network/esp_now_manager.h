@@ -6,13 +6,15 @@
  * - Auto-discovery via broadcast
  * - Peer management (up to 20 peers)
  * - Message routing
- * - Latency monitoring
+ * - Latency monitoring (PING/ECHO round trips, per-peer RTT histogram)
  * - Packet loss detection
  *
  * Design:
  * - Event-based, not continuous sync
  * - Small packets (<250 bytes)
  * - Fire-and-forget or ACK modes
+ * - Sends are queued and never block the caller: a sender task owns the
+ *   radio, one frame in flight, paced by the send-complete callback
  */
 
 #ifndef ESP_NOW_MANAGER_H
@@ -20,6 +22,10 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include "esp_now.h"
 #include "protocol.h"
 
@@ -35,10 +41,49 @@ extern "C" {
 #define BROADCAST_MAC {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}
 #define MAX_SEND_RETRIES 3
 
+#define PEER_INDEX_NONE 0xFF       // peer_index entry for unknown node IDs
+
+#define ESP_NOW_TX_QUEUE_LENGTH 16 // Frames waiting for the radio
+#define ESP_NOW_TX_TASK_PRIORITY 6 // Above MIDI/control, below WiFi
+#define ESP_NOW_TX_TASK_STACK 3072
+#define ESP_NOW_TX_TASK_CORE 0
+#define ESP_NOW_TX_TIMEOUT_MS 20   // Give up waiting for send-complete
+
+// Link measurement (PING/ECHO)
+#define PING_WINDOW 64             // Recent pings per peer in RTT and loss stats
+#define RTT_HISTOGRAM_BINS 24
+#define RTT_BIN_US 500             // Bin width; the last bin is open-ended (≥ 11.5 ms)
+
+#define PING_SAMPLE_EMPTY 0xFF     // Window slot not used yet
+#define PING_SAMPLE_PENDING 0xFE   // Waiting for the echo
+#define PING_SAMPLE_LOST 0xFD      // No echo before the next ping
+
+// Duplicate suppression (relayed copies, retried sends)
+#define RX_DEDUP_WINDOW 32         // Sequences remembered behind each source's newest
+#define RX_DEDUP_RESET_MS 1000     // Silence after which a source may restart its sequence
+
 // ============================================================================
 // Type Definitions
 // ============================================================================
 
+/**
+ * @brief Rolling RTT and loss over a peer's last PING_WINDOW pings
+ *
+ * One ping is outstanding at a time: sending the next one counts an
+ * unanswered ping as lost.
+ */
+typedef struct {
+    uint8_t samples[PING_WINDOW];      ///< Histogram bin per ping, or PING_SAMPLE_*
+    uint8_t bins[RTT_HISTOGRAM_BINS];  ///< RTT histogram of the window's echoes
+    uint8_t echoed;                    ///< Echoed pings in the window
+    uint8_t lost;                      ///< Lost pings in the window
+    uint16_t next_seq;                 ///< Sequence of the next ping
+    uint32_t pings_sent;               ///< Since boot
+    uint32_t echoes;                   ///< Since boot
+    uint32_t late_echoes;              ///< Echoes for pings already counted lost
+    uint32_t last_rtt_us;              ///< Most recent RTT
+} peer_rtt_t;
+
 /**
  * @brief Peer information
  */
@@ -50,9 +95,28 @@ typedef struct {
     uint32_t packets_sent;      ///< TX packet count
     uint32_t packets_received;  ///< RX packet count
     uint32_t packets_lost;      ///< Lost packet count
-    float latency_ms;           ///< Estimated latency
+    float latency_ms;           ///< One-way latency estimate (smoothed RTT / 2)
+    peer_rtt_t rtt;             ///< PING/ECHO statistics (guarded by rtt_lock)
 } peer_info_t;
 
+/**
+ * @brief Sequences recently seen from one source ID
+ */
+typedef struct {
+    uint16_t newest;            ///< Highest sequence seen
+    uint32_t window;            ///< Bit n: sequence newest - n seen (0 = no frame yet)
+    uint32_t last_ms;           ///< Arrival of the source's last frame
+} rx_dedup_t;
+
+/**
+ * @brief One queued frame
+ */
+typedef struct {
+    uint8_t dest_id;                ///< Destination node ID (0xFF = broadcast)
+    uint8_t len;                    ///< Frame length (bytes)
+    uint8_t data[MAX_PACKET_SIZE];  ///< Encoded message
+} esp_now_tx_request_t;
+
 /**
  * @brief ESP-NOW manager state
  */
@@ -63,9 +127,29 @@ typedef struct {
 
     peer_info_t peers[MAX_PEERS];
     uint8_t num_peers;
+    uint8_t peer_index[256];    ///< node_id → index into peers (PEER_INDEX_NONE if unknown)
 
     uint16_t tx_sequence;       ///< TX sequence counter
 
+    // Asynchronous TX (owned by the sender task)
+    QueueHandle_t tx_queue;             ///< Pending esp_now_tx_request_t
+    SemaphoreHandle_t tx_done;          ///< Given by the send-complete callback
+    TaskHandle_t tx_task;               ///< Sender task
+    volatile uint8_t tx_inflight_peer;  ///< Peer index of the frame in flight
+    volatile bool tx_inflight_ok;       ///< Status of the last completed frame
+    uint32_t tx_queue_full;             ///< Frames dropped at enqueue
+    uint32_t tx_retries;                ///< Resends after busy radio or no ACK
+
+    portMUX_TYPE rtt_lock;      ///< Guards peers[].rtt (pinger task vs. WiFi task)
+
+    // Group addressing and relaying (see esp_now_set_group())
+    uint8_t my_group;           ///< Broadcast group (GROUP_NONE = none)
+    bool relay;                 ///< Re-broadcast hub <-> node traffic
+    rx_dedup_t rx_seen[256];    ///< Per source ID (WiFi task only)
+    uint32_t rx_duplicates;     ///< Frames dropped as already seen
+    uint32_t rx_not_for_us;     ///< Frames addressed to other nodes or groups
+    uint32_t relayed;           ///< Frames re-broadcast as relay
+
     // Callbacks
     void (*on_message_received)(const network_message_t* msg);
     void (*on_peer_discovered)(uint8_t node_id, const uint8_t* mac);
@@ -95,13 +179,32 @@ bool esp_now_manager_init(esp_now_manager_t* mgr, uint8_t my_node_id);
 void esp_now_manager_deinit(esp_now_manager_t* mgr);
 
 /**
- * @brief Send message to specific peer
+ * @brief Set this node's broadcast group and relay role
+ *
+ * Frames addressed to GROUP_ADDR(group) are delivered from then on. A
+ * relay also re-broadcasts, once each, hub frames for anyone but itself
+ * and node frames for the hub, so clusters out of the hub's range are
+ * reached through it. HELLOs cross one relay at most.
+ *
+ * @param mgr Pointer to manager structure
+ * @param group Broadcast group (GROUP_NONE = none)
+ * @param relay Act as relay
+ */
+void esp_now_set_group(esp_now_manager_t* mgr, uint8_t group, bool relay);
+
+/**
+ * @brief Queue message for a specific peer
+ *
+ * Copies the message into the TX queue and returns immediately; the
+ * sender task transmits it, retrying up to MAX_SEND_RETRIES times when
+ * the radio is busy or a unicast frame is not acknowledged. Safe to
+ * call from any task (not from ISRs).
  *
  * @param mgr Pointer to manager structure
  * @param dest_id Destination node ID (0xFF = broadcast)
  * @param msg Message to send
  * @param len Message length
- * @return true if sent successfully, false on error
+ * @return true if queued, false if the queue is full or len is invalid
  */
 bool esp_now_send_message(esp_now_manager_t* mgr,
                          uint8_t dest_id,
@@ -109,17 +212,28 @@ bool esp_now_send_message(esp_now_manager_t* mgr,
                          size_t len);
 
 /**
- * @brief Broadcast message to all peers
+ * @brief Queue message for broadcast to all peers
  *
  * @param mgr Pointer to manager structure
  * @param msg Message to send
  * @param len Message length
- * @return Number of successful sends
+ * @return 1 if queued, 0 if the queue is full
  */
 uint8_t esp_now_broadcast_message(esp_now_manager_t* mgr,
                                  const network_message_t* msg,
                                  size_t len);
 
+/**
+ * @brief Frames queued and not yet handed to the radio
+ *
+ * Lets bulk senders keep a few frames ahead of the radio without
+ * filling the queue that runtime traffic shares.
+ *
+ * @param mgr Pointer to manager structure
+ * @return TX queue depth
+ */
+uint32_t esp_now_tx_pending(const esp_now_manager_t* mgr);
+
 /**
  * @brief Register message callback
  *
@@ -150,7 +264,7 @@ void esp_now_register_discovery_callback(esp_now_manager_t* mgr,
  * @param mac MAC address
  * @return true if added successfully, false on error
  */
-bool esp_now_add_peer(esp_now_manager_t* mgr,
+bool esp_now_register_peer(esp_now_manager_t* mgr,
                      uint8_t node_id,
                      const uint8_t* mac);
 
@@ -164,13 +278,13 @@ bool esp_now_add_peer(esp_now_manager_t* mgr,
 bool esp_now_remove_peer(esp_now_manager_t* mgr, uint8_t node_id);
 
 /**
- * @brief Get peer info by node ID
+ * @brief Get peer info by node ID (O(1) via peer_index)
  *
  * @param mgr Pointer to manager structure
  * @param node_id Node ID
  * @return Pointer to peer info, or NULL if not found
  */
-const peer_info_t* esp_now_get_peer(const esp_now_manager_t* mgr,
+const peer_info_t* esp_now_find_peer(const esp_now_manager_t* mgr,
                                    uint8_t node_id);
 
 /**
@@ -245,6 +359,60 @@ void esp_now_get_stats(const esp_now_manager_t* mgr,
  */
 float esp_now_get_avg_latency(const esp_now_manager_t* mgr);
 
+/**
+ * @brief Send a PING to one peer
+ *
+ * The peer's manager answers with an ECHO (no application code
+ * involved); its arrival updates the peer's RTT histogram and
+ * latency_ms. An earlier ping still unanswered is counted lost.
+ *
+ * @param mgr Pointer to manager structure
+ * @param node_id Peer to measure
+ * @return true if queued
+ */
+bool esp_now_send_ping(esp_now_manager_t* mgr, uint8_t node_id);
+
+/**
+ * @brief PING every active peer
+ *
+ * Call at a fixed interval longer than the worst expected RTT (the hub
+ * uses its heartbeat interval).
+ *
+ * @param mgr Pointer to manager structure
+ * @return Number of pings queued
+ */
+uint8_t esp_now_ping_peers(esp_now_manager_t* mgr);
+
+/**
+ * @brief Copy a peer's RTT statistics
+ *
+ * @param mgr Pointer to manager structure
+ * @param node_id Peer
+ * @param rtt Output statistics
+ * @return true if the peer exists
+ */
+bool esp_now_get_peer_rtt(esp_now_manager_t* mgr, uint8_t node_id, peer_rtt_t* rtt);
+
+/**
+ * @brief RTT percentile over the ping window
+ *
+ * Resolution is RTT_BIN_US; the upper edge of the bin is returned, so
+ * the value is never below the true percentile.
+ *
+ * @param rtt Statistics (from esp_now_get_peer_rtt)
+ * @param percentile 1-100
+ * @return RTT in µs, or 0 if no echoes in the window
+ */
+uint32_t esp_now_rtt_percentile(const peer_rtt_t* rtt, uint8_t percentile);
+
+/**
+ * @brief Fraction of answered-or-lost pings in the window that were lost
+ *
+ * @param rtt Statistics (from esp_now_get_peer_rtt)
+ * @return Loss rate (0-1)
+ */
+float esp_now_rtt_loss_rate(const peer_rtt_t* rtt);
+
 /**
  * @brief Check for stale peers (no recent activity)
  *
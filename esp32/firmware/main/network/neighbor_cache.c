@@ -0,0 +1,74 @@
+/**
+ * @file neighbor_cache.c
+ * @brief Neighbor state cache and coupling term
+ */
+
+#include "neighbor_cache.h"
+#include <string.h>
+
+void neighbor_cache_init(neighbor_cache_t* cache) {
+    memset(cache, 0, sizeof(neighbor_cache_t));
+    portMUX_INITIALIZE(&cache->lock);
+}
+
+void neighbor_cache_update(neighbor_cache_t* cache,
+                           uint8_t node_id,
+                           float mode0_real,
+                           float mode0_imag,
+                           int64_t now_us) {
+    if (node_id >= NEIGHBOR_CACHE_SLOTS) return;
+
+    neighbor_entry_t entry = {
+        .a0 = mode0_real + I * mode0_imag,
+        .received_us = now_us,
+        .valid = true
+    };
+
+    portENTER_CRITICAL(&cache->lock);
+    cache->entries[node_id] = entry;
+    cache->updates++;
+    portEXIT_CRITICAL(&cache->lock);
+}
+
+float complex neighbor_cache_coupling(neighbor_cache_t* cache,
+                                      const modal_node_t* node,
+                                      int64_t now_us,
+                                      int64_t timeout_us) {
+    const mode_state_t* mode = &node->modes[0];
+    if (!mode->params.active || node->num_neighbors == 0) return 0.0f;
+
+    // Copy the neighbor entries out, then do the math without the lock
+    neighbor_entry_t neighbors[MAX_NEIGHBORS];
+    uint8_t count = 0;
+
+    portENTER_CRITICAL(&cache->lock);
+    for (uint8_t i = 0; i < node->num_neighbors; i++) {
+        uint8_t id = node->neighbor_ids[i];
+        if (id < NEIGHBOR_CACHE_SLOTS && id != node->node_id) {
+            neighbors[count++] = cache->entries[id];
+        }
+    }
+    portEXIT_CRITICAL(&cache->lock);
+
+    const float complex lambda = -mode->params.gamma + I * mode->params.omega;
+    float complex sum = 0.0f;
+    uint8_t fresh = 0;
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (!neighbors[i].valid) continue;
+
+        int64_t age_us = now_us - neighbors[i].received_us;
+        if (age_us > timeout_us) {
+            cache->stale_skips++;
+            continue;
+        }
+
+        // Advance the neighbor to now with our own propagator
+        float age_s = (float)(age_us < 0 ? 0 : age_us) * 1e-6f;
+        sum += neighbors[i].a0 * cexpf(lambda * age_s);
+        fresh++;
+    }
+
+    // Diffusive: Σ (â_j − a_0) = Σ â_j − n·a_0
+    return node->coupling_strength * (sum - (float)fresh * mode->a);
+}
@@ -0,0 +1,103 @@
+/**
+ * @file neighbor_cache.h
+ * @brief Latest mode-0 state heard from each neighbor, for coupling
+ *
+ * The network task stores every MSG_STATE it receives; the control task
+ * turns the entries for its node's neighbor_ids into the diffusive
+ * coupling input κ·Σ_j (â_j − a_0), matching TopologyEngine in the AU.
+ *
+ * States arrive at a fraction of the control rate, so each one is
+ * advanced to "now" with the receiver's own mode-0 propagator
+ * exp((−γ + iω)·age) before use: neighbors tuned near our frequency keep
+ * their phase relationship between broadcasts. Entries older than the
+ * timeout are left out of the sum, so a silent or lost neighbor fades
+ * out of the coupling instead of holding a frozen value.
+ */
+
+#ifndef NEIGHBOR_CACHE_H
+#define NEIGHBOR_CACHE_H
+
+#include <complex.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "modal_node.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define NEIGHBOR_CACHE_SLOTS 64  // Node IDs tracked (indexed directly)
+
+// ============================================================================
+// Type Definitions
+// ============================================================================
+
+/**
+ * @brief Last state received from one node
+ */
+typedef struct {
+    float complex a0;     ///< Mode-0 amplitude at reception
+    int64_t received_us;  ///< esp_timer time of reception
+    bool valid;           ///< Slot has been written
+} neighbor_entry_t;
+
+/**
+ * @brief Cache shared by the network (writer) and control (reader) tasks
+ */
+typedef struct {
+    neighbor_entry_t entries[NEIGHBOR_CACHE_SLOTS];
+    portMUX_TYPE lock;     ///< Guards entries (held for a copy only)
+    uint32_t updates;      ///< States stored
+    uint32_t stale_skips;  ///< Neighbor terms left out as too old
+} neighbor_cache_t;
+
+// ============================================================================
+// API
+// ============================================================================
+
+/**
+ * @brief Initialize an empty cache
+ *
+ * @param cache Cache to initialize
+ */
+void neighbor_cache_init(neighbor_cache_t* cache);
+
+/**
+ * @brief Store a received state (network task)
+ *
+ * @param cache Shared cache
+ * @param node_id Sender node ID (ignored if out of range)
+ * @param mode0_real Re(a_0)
+ * @param mode0_imag Im(a_0)
+ * @param now_us Reception time (esp_timer_get_time)
+ */
+void neighbor_cache_update(neighbor_cache_t* cache,
+                           uint8_t node_id,
+                           float mode0_real,
+                           float mode0_imag,
+                           int64_t now_us);
+
+/**
+ * @brief Diffusive coupling input for a node's mode 0 (control task)
+ *
+ * @param cache Shared cache
+ * @param node Receiving node (neighbor_ids, coupling_strength, mode 0)
+ * @param now_us Current time (esp_timer_get_time)
+ * @param timeout_us Entries older than this are skipped
+ * @return κ·Σ_j (â_j − a_0) over fresh neighbors (0 if none)
+ */
+float complex neighbor_cache_coupling(neighbor_cache_t* cache,
+                                      const modal_node_t* node,
+                                      int64_t now_us,
+                                      int64_t timeout_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NEIGHBOR_CACHE_H
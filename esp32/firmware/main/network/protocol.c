@@ -7,20 +7,44 @@
  */
 
 #include "protocol.h"
+#include <math.h>
+#include <stdatomic.h>
+#include <stddef.h>
 #include <string.h>
 #include <time.h>
 #include "esp_timer.h"
+#ifdef ESP_PLATFORM
+#include "esp_rom_crc.h"
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
 
 // ============================================================================
 // Global State
 // ============================================================================
 
-static uint16_t g_sequence_counter = 0;
+static atomic_uint g_sequence_counter = 0;  // Receivers drop repeated (source, sequence)
+
+_Static_assert(sizeof(msg_poke_batch_t) <= MAX_PACKET_SIZE, "POKE_BATCH must fit one ESP-NOW frame");
+_Static_assert(sizeof(msg_cfg_chunk_t) <= MAX_PACKET_SIZE, "CFG_CHUNK must fit one ESP-NOW frame");
+_Static_assert(sizeof(msg_offer_t) <= MAX_PACKET_SIZE, "OFFER must fit one ESP-NOW frame");
 
 // ============================================================================
 // Header Initialization
 // ============================================================================
 
+static uint16_t next_sequence(void) {
+    // Unique per frame even with several tasks sending
+    return (uint16_t)atomic_fetch_add_explicit(&g_sequence_counter, 1, memory_order_relaxed);
+}
+
+bool protocol_addressed_to(uint8_t dest_id, uint8_t node_id, uint8_t group) {
+    return dest_id == NODE_ID_BROADCAST || dest_id == node_id ||
+           (group < MAX_GROUPS && dest_id == GROUP_ADDR(group));
+}
+
 void protocol_init_header(message_header_t* header,
                          message_type_t type,
                          uint8_t source_id,
@@ -31,7 +55,7 @@ void protocol_init_header(message_header_t* header,
     header->type = type;
     header->source_id = source_id;
     header->dest_id = dest_id;
-    header->sequence = g_sequence_counter++;
+    header->sequence = next_sequence();
     header->timestamp_ms = (uint16_t)(esp_timer_get_time() / 1000);
 }
 
@@ -49,8 +73,8 @@ size_t protocol_create_hello(network_message_t* msg,
     // Get MAC address (placeholder - filled by network layer)
     memset(msg->hello.mac_address, 0, 6);
 
-    // Capabilities (future use)
-    msg->hello.capabilities = 0x01; // Basic capability flag
+    // Capabilities (the hub adds HELLO_CAP_HUB)
+    msg->hello.capabilities = HELLO_CAP_BASIC;
 
     // Node name
     strncpy(msg->hello.name, name, sizeof(msg->hello.name) - 1);
@@ -84,6 +108,205 @@ size_t protocol_create_poke(network_message_t* msg,
     return sizeof(msg_poke_t);
 }
 
+size_t protocol_create_poke_batch(network_message_t* msg, uint8_t source_id) {
+    memset(msg, 0, sizeof(network_message_t));
+
+    protocol_init_header(&msg->poke_batch.header, MSG_POKE_BATCH, source_id, 0xFF);
+    msg->poke_batch.count = 0;
+
+    return protocol_poke_batch_size(&msg->poke_batch);
+}
+
+static uint8_t quantize_unit(float x) {
+    if (!(x > 0.0f)) return 0;
+    if (x >= 1.0f) return 255;
+    return (uint8_t)(x * 255.0f + 0.5f);
+}
+
+bool protocol_poke_batch_add(network_message_t* msg,
+                             uint8_t target_id,
+                             float strength,
+                             float phase_hint,
+                             const float* mode_weights) {
+    msg_poke_batch_t* batch = &msg->poke_batch;
+    if (batch->count >= POKE_BATCH_MAX_ENTRIES) return false;
+
+    poke_entry_t* entry = &batch->entries[batch->count++];
+    entry->target_id = target_id;
+    entry->strength = quantize_unit(strength);
+
+    if (phase_hint < 0.0f) {
+        entry->flags = POKE_ENTRY_RANDOM_PHASE;
+        entry->phase = 0;
+    } else {
+        // uint8 wrap keeps any phase in [0, 2π)
+        entry->flags = 0;
+        entry->phase = (uint8_t)(uint32_t)(phase_hint * (256.0f / (2.0f * (float)M_PI)) + 0.5f);
+    }
+
+    for (int k = 0; k < 4; k++) {
+        entry->mode_weights[k] = mode_weights ? quantize_unit(mode_weights[k]) : 255;
+    }
+
+    return true;
+}
+
+size_t protocol_poke_batch_size(const msg_poke_batch_t* batch) {
+    return offsetof(msg_poke_batch_t, entries) + batch->count * sizeof(poke_entry_t);
+}
+
+void protocol_poke_entry_decode(const poke_entry_t* entry,
+                                float* strength,
+                                float* phase_hint,
+                                float* mode_weights) {
+    *strength = entry->strength * (1.0f / 255.0f);
+    *phase_hint = (entry->flags & POKE_ENTRY_RANDOM_PHASE)
+                      ? -1.0f
+                      : entry->phase * (2.0f * (float)M_PI / 256.0f);
+
+    for (int k = 0; k < 4; k++) {
+        mode_weights[k] = entry->mode_weights[k] * (1.0f / 255.0f);
+    }
+}
+
+// ============================================================================
+// Compact Encoding
+// ============================================================================
+
+static uint16_t quantize_phase16(float phase) {
+    // uint16 wrap keeps any phase in [0, 2π)
+    return (uint16_t)(int32_t)(phase * (65536.0f / (2.0f * (float)M_PI)) + 0.5f);
+}
+
+static float dequantize_phase16(uint16_t q) {
+    return q * (2.0f * (float)M_PI / 65536.0f);
+}
+
+static size_t put_u16(uint8_t* out, uint16_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    return 2;
+}
+
+static uint16_t get_u16(const uint8_t* in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+/**
+ * @brief Compact header; returns its length (5-7 bytes)
+ */
+static size_t put_compact_header(uint8_t* out, message_type_t type,
+                                 uint8_t source_id, uint8_t dest_id) {
+    size_t n = 0;
+    out[n++] = PROTOCOL_COMPACT_MARKER;
+    out[n++] = (uint8_t)type;
+    out[n++] = source_id;
+    out[n++] = dest_id;
+
+    // LEB128: 7 bits per byte, high bit set while more follow
+    uint16_t sequence = next_sequence();
+    while (sequence >= 0x80) {
+        out[n++] = (uint8_t)(sequence | 0x80);
+        sequence >>= 7;
+    }
+    out[n++] = (uint8_t)sequence;
+    return n;
+}
+
+size_t protocol_create_poke_compact(network_message_t* msg,
+                                    uint8_t source_id,
+                                    uint8_t dest_id,
+                                    float strength,
+                                    float phase_hint,
+                                    const float* mode_weights) {
+    uint8_t* out = msg->raw;
+    size_t n = put_compact_header(out, MSG_POKE_COMPACT, source_id, dest_id);
+
+    out[n++] = quantize_unit(strength);
+    out[n++] = (phase_hint < 0.0f) ? POKE_ENTRY_RANDOM_PHASE : 0;
+    n += put_u16(out + n, (phase_hint < 0.0f) ? 0 : quantize_phase16(phase_hint));
+    for (int k = 0; k < 4; k++) {
+        out[n++] = mode_weights ? quantize_unit(mode_weights[k]) : 255;
+    }
+
+    return n;
+}
+
+size_t protocol_create_state_compact(network_message_t* msg,
+                                     uint8_t source_id,
+                                     float mode0_real,
+                                     float mode0_imag) {
+    uint8_t* out = msg->raw;
+    size_t n = put_compact_header(out, MSG_STATE_COMPACT, source_id, 0xFF);
+
+    float amplitude = sqrtf(mode0_real * mode0_real + mode0_imag * mode0_imag);
+    float scaled = amplitude * COMPACT_AMPLITUDE_SCALE + 0.5f;
+    n += put_u16(out + n, (scaled >= 65535.0f) ? 65535 : (uint16_t)scaled);
+    n += put_u16(out + n, quantize_phase16(atan2f(mode0_imag, mode0_real)));
+
+    return n;
+}
+
+/**
+ * @brief Expand a compact frame into the regular message structures
+ */
+static bool parse_compact(const uint8_t* data, size_t len, network_message_t* msg) {
+    if (len < 5) return false;
+
+    message_type_t type = (message_type_t)data[1];
+    uint8_t source_id = data[2];
+    uint8_t dest_id = data[3];
+
+    // Sequence varint (at most 3 bytes for 16 bits)
+    size_t n = 4;
+    uint32_t sequence = 0;
+    for (int shift = 0; ; shift += 7) {
+        if (n >= len || shift > 14) return false;
+        uint8_t byte = data[n++];
+        sequence |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) break;
+    }
+
+    memset(msg, 0, sizeof(network_message_t));
+
+    switch (type) {
+        case MSG_POKE_COMPACT: {
+            if (len < n + COMPACT_POKE_PAYLOAD) return false;
+            const uint8_t* p = data + n;
+            msg->poke.strength = p[0] * (1.0f / 255.0f);
+            msg->poke.phase_hint = (p[1] & POKE_ENTRY_RANDOM_PHASE)
+                                       ? -1.0f
+                                       : dequantize_phase16(get_u16(p + 2));
+            for (int k = 0; k < 4; k++) {
+                msg->poke.mode_weights[k] = p[4 + k] * (1.0f / 255.0f);
+            }
+            msg->header.type = MSG_POKE;
+            break;
+        }
+
+        case MSG_STATE_COMPACT: {
+            if (len < n + COMPACT_STATE_PAYLOAD) return false;
+            const uint8_t* p = data + n;
+            float amplitude = get_u16(p) * (1.0f / COMPACT_AMPLITUDE_SCALE);
+            float phase = dequantize_phase16(get_u16(p + 2));
+            msg->state.amplitude = amplitude;
+            msg->state.mode0_real = amplitude * cosf(phase);
+            msg->state.mode0_imag = amplitude * sinf(phase);
+            msg->header.type = MSG_STATE;
+            break;
+        }
+
+        default:
+            return false;
+    }
+
+    msg->header.version = PROTOCOL_VERSION;
+    msg->header.source_id = source_id;
+    msg->header.dest_id = dest_id;
+    msg->header.sequence = (uint16_t)sequence;
+    return true;
+}
+
 size_t protocol_create_start(network_message_t* msg,
                              uint8_t source_id,
                              uint32_t start_time_ms) {
@@ -112,10 +335,36 @@ size_t protocol_create_heartbeat(network_message_t* msg,
     protocol_init_header(&msg->heartbeat.header, MSG_HEARTBEAT, source_id, 0xFF);
     msg->heartbeat.uptime_ms = uptime_ms;
     msg->heartbeat.cpu_usage = cpu_usage;
+    msg->heartbeat.reference_time_us = esp_timer_get_time();
 
     return sizeof(msg_heartbeat_t);
 }
 
+size_t protocol_create_ping(network_message_t* msg,
+                            uint8_t source_id,
+                            uint8_t dest_id,
+                            uint16_t ping_seq) {
+    memset(msg, 0, sizeof(network_message_t));
+
+    protocol_init_header(&msg->ping.header, MSG_PING, source_id, dest_id);
+    msg->ping.ping_seq = ping_seq;
+    msg->ping.sent_us = esp_timer_get_time();
+
+    return sizeof(msg_ping_t);
+}
+
+size_t protocol_create_echo(network_message_t* msg,
+                            uint8_t source_id,
+                            const msg_ping_t* ping) {
+    memset(msg, 0, sizeof(network_message_t));
+
+    protocol_init_header(&msg->ping.header, MSG_ECHO, source_id, ping->header.source_id);
+    msg->ping.ping_seq = ping->ping_seq;
+    msg->ping.sent_us = ping->sent_us;
+
+    return sizeof(msg_ping_t);
+}
+
 // ============================================================================
 // Configuration Message Creators
 // ============================================================================
@@ -128,11 +377,35 @@ size_t protocol_create_offer(network_message_t* msg,
     memset(msg, 0, sizeof(network_message_t));
 
     protocol_init_header(&msg->offer.header, MSG_OFFER, source_id, 0xFF);
-    strncpy(msg->offer.session_id, session_id, 32);
+    strncpy(msg->offer.session_id, session_id, sizeof(msg->offer.session_id) - 1);
     msg->offer.config_size = config_size;
     msg->offer.num_nodes = num_nodes;
+    msg->offer.count = 0;
+
+    return protocol_offer_size(&msg->offer);
+}
+
+bool protocol_offer_add(network_message_t* msg, const uint8_t* mac, uint8_t node_id) {
+    msg_offer_t* offer = &msg->offer;
+    if (offer->count >= OFFER_MAX_ASSIGNMENTS) return false;
+
+    offer_assignment_t* entry = &offer->assignments[offer->count++];
+    memcpy(entry->mac_address, mac, 6);
+    entry->node_id = node_id;
+    return true;
+}
 
-    return sizeof(msg_offer_t);
+size_t protocol_offer_size(const msg_offer_t* offer) {
+    return offsetof(msg_offer_t, assignments) + offer->count * sizeof(offer_assignment_t);
+}
+
+uint8_t protocol_offer_find(const msg_offer_t* offer, const uint8_t* mac) {
+    for (uint8_t i = 0; i < offer->count; i++) {
+        if (memcmp(offer->assignments[i].mac_address, mac, 6) == 0) {
+            return offer->assignments[i].node_id;
+        }
+    }
+    return 0xFF;
 }
 
 size_t protocol_create_join(network_message_t* msg,
@@ -173,9 +446,10 @@ size_t protocol_create_cfg_chunk(network_message_t* msg,
     protocol_init_header(&msg->cfg_chunk.header, MSG_CFG_CHUNK, source_id, 0xFF);
     msg->cfg_chunk.chunk_idx = chunk_idx;
     msg->cfg_chunk.chunk_size = data_size;
+    msg->cfg_chunk.data_crc = protocol_crc32(data, data_size);
     memcpy(msg->cfg_chunk.data, data, data_size);
 
-    return sizeof(message_header_t) + 2 + data_size;  // header + idx + size + data
+    return offsetof(msg_cfg_chunk_t, data) + data_size;
 }
 
 size_t protocol_create_cfg_end(network_message_t* msg,
@@ -192,11 +466,19 @@ size_t protocol_create_cfg_end(network_message_t* msg,
 size_t protocol_create_cfg_ack(network_message_t* msg,
                                uint8_t source_id,
                                uint8_t dest_id,
-                               uint8_t status) {
+                               uint8_t status,
+                               uint32_t checksum,
+                               const uint8_t* chunk_bitmap,
+                               uint8_t chunks_received) {
     memset(msg, 0, sizeof(network_message_t));
 
     protocol_init_header(&msg->cfg_ack.header, MSG_CFG_ACK, source_id, dest_id);
     msg->cfg_ack.status = status;
+    msg->cfg_ack.checksum = checksum;
+    msg->cfg_ack.chunks_received = chunks_received;
+    if (chunk_bitmap) {
+        memcpy(msg->cfg_ack.chunk_bitmap, chunk_bitmap, CFG_CHUNK_BITMAP_BYTES);
+    }
 
     return sizeof(msg_cfg_ack_t);
 }
@@ -208,6 +490,10 @@ size_t protocol_create_cfg_ack(network_message_t* msg,
 bool protocol_parse_message(const uint8_t* data,
                            size_t len,
                            network_message_t* msg) {
+    if (len > 0 && data[0] == PROTOCOL_COMPACT_MARKER) {
+        return parse_compact(data, len, msg);
+    }
+
     // Minimum size check
     if (len < sizeof(message_header_t)) {
         return false;
@@ -229,8 +515,11 @@ bool protocol_parse_message(const uint8_t* data,
             break;
 
         case MSG_OFFER:
-            if (len < sizeof(msg_offer_t)) return false;
-            memcpy(&msg->offer, data, sizeof(msg_offer_t));
+            // Variable length: count assignments follow the header
+            if (len < offsetof(msg_offer_t, assignments)) return false;
+            if (data[offsetof(msg_offer_t, count)] > OFFER_MAX_ASSIGNMENTS) return false;
+            if (len < protocol_offer_size((const msg_offer_t*)data)) return false;
+            memcpy(&msg->offer, data, protocol_offer_size((const msg_offer_t*)data));
             break;
 
         case MSG_JOIN:
@@ -243,10 +532,15 @@ bool protocol_parse_message(const uint8_t* data,
             memcpy(&msg->cfg_begin, data, sizeof(msg_cfg_begin_t));
             break;
 
-        case MSG_CFG_CHUNK:
-            if (len < sizeof(msg_cfg_chunk_t)) return false;
-            memcpy(&msg->cfg_chunk, data, sizeof(msg_cfg_chunk_t));
+        case MSG_CFG_CHUNK: {
+            // Variable length: only chunk_size data bytes are sent
+            if (len < offsetof(msg_cfg_chunk_t, data)) return false;
+            uint8_t chunk_size = data[offsetof(msg_cfg_chunk_t, chunk_size)];
+            size_t chunk_len = offsetof(msg_cfg_chunk_t, data) + chunk_size;
+            if (chunk_size > CFG_CHUNK_DATA_SIZE || len < chunk_len) return false;
+            memcpy(&msg->cfg_chunk, data, chunk_len);
             break;
+        }
 
         case MSG_CFG_END:
             if (len < sizeof(msg_cfg_end_t)) return false;
@@ -263,6 +557,14 @@ bool protocol_parse_message(const uint8_t* data,
             memcpy(&msg->poke, data, sizeof(msg_poke_t));
             break;
 
+        case MSG_POKE_BATCH:
+            // Variable length: count entries follow the header
+            if (len < offsetof(msg_poke_batch_t, entries)) return false;
+            if (data[offsetof(msg_poke_batch_t, count)] > POKE_BATCH_MAX_ENTRIES) return false;
+            if (len < protocol_poke_batch_size((const msg_poke_batch_t*)data)) return false;
+            memcpy(&msg->poke_batch, data, protocol_poke_batch_size((const msg_poke_batch_t*)data));
+            break;
+
         case MSG_START:
             if (len < sizeof(msg_start_t)) return false;
             memcpy(&msg->start, data, sizeof(msg_start_t));
@@ -273,24 +575,36 @@ bool protocol_parse_message(const uint8_t* data,
             memcpy(&msg->stop, data, sizeof(msg_stop_t));
             break;
 
+        case MSG_STATE:
+            if (len < sizeof(msg_state_t)) return false;
+            memcpy(&msg->state, data, sizeof(msg_state_t));
+            break;
+
         case MSG_HEARTBEAT:
             if (len < sizeof(msg_heartbeat_t)) return false;
             memcpy(&msg->heartbeat, data, sizeof(msg_heartbeat_t));
             break;
 
+        case MSG_PING:
+        case MSG_ECHO:
+            if (len < sizeof(msg_ping_t)) return false;
+            memcpy(&msg->ping, data, sizeof(msg_ping_t));
+            break;
+
         default:
             // Unknown message type
             return false;
     }
 
-    return true;
+    return protocol_validate_checksum(msg);
 }
 
 // ============================================================================
 // CRC32 Checksum (for configuration validation)
 // ============================================================================
 
-// Simple CRC32 implementation
+#ifndef ESP_PLATFORM
+// Host builds: reflected CRC-32 (IEEE 802.3), one table lookup per byte
 static const uint32_t crc32_table[256] = {
     0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F,
     0xE963A535, 0x9E6495A3, 0x0EDB8832, 0x79DCB8A4, 0xE0D5E91E, 0x97D2D988,
@@ -336,20 +650,35 @@ static const uint32_t crc32_table[256] = {
     0x54DE5729, 0x23D967BF, 0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94,
     0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
 };
-
-uint32_t protocol_crc32(const uint8_t* data, size_t len) {
-    uint32_t crc = 0xFFFFFFFF;
-
+#endif
+
+uint32_t protocol_crc32_update(uint32_t crc, const uint8_t* data, size_t len) {
+#ifdef ESP_PLATFORM
+    // ROM routine (same polynomial and convention): no flash-resident
+    // table, so no cache misses while a config buffer is checked
+    return esp_rom_crc32_le(crc, data, (uint32_t)len);
+#else
+    crc = ~crc;
     for (size_t i = 0; i < len; i++) {
         uint8_t index = (crc ^ data[i]) & 0xFF;
         crc = (crc >> 8) ^ crc32_table[index];
     }
-
     return ~crc;
+#endif
+}
+
+uint32_t protocol_crc32(const uint8_t* data, size_t len) {
+    return protocol_crc32_update(0, data, len);
 }
 
 bool protocol_validate_checksum(const network_message_t* msg) {
-    // For now, checksums only used in configuration messages
-    // TODO: Implement when config transfer is added
-    return true;
+    switch (msg->header.type) {
+        case MSG_CFG_CHUNK:
+            return msg->cfg_chunk.chunk_size <= CFG_CHUNK_DATA_SIZE &&
+                   protocol_crc32(msg->cfg_chunk.data, msg->cfg_chunk.chunk_size) ==
+                       msg->cfg_chunk.data_crc;
+
+        default:
+            return true;
+    }
 }
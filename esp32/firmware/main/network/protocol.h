@@ -11,13 +11,33 @@
  * Message types:
  * - Discovery: HELLO, OFFER, JOIN
  * - Configuration: CFG_BEGIN, CFG_CHUNK, CFG_END, CFG_ACK
- * - Runtime: POKE, START, STOP
+ * - Runtime: POKE, POKE_BATCH, START, STOP
+ * - Link measurement: PING, ECHO (answered by esp_now_manager)
+ *
+ * Timing: the hub's heartbeat carries its clock as the shared timebase
+ * (see clock_sync.h). POKE and POKE_BATCH may carry the shared time at
+ * which to apply them, so every node acts on the same control tick.
+ *
+ * Compact encoding (POKE_COMPACT, STATE_COMPACT) for high-rate traffic:
+ *   [marker][type][source][dest][sequence varint][payload]
+ * The marker byte (PROTOCOL_COMPACT_MARKER) can never be a regular
+ * header's version byte. Payload fields are 8/16-bit quantized and
+ * little-endian. protocol_parse_message() expands compact frames into
+ * the regular msg_poke_t / msg_state_t, so handlers see MSG_POKE and
+ * MSG_STATE either way (with timestamp_ms = 0).
+ *
+ * Addressing (source_id / dest_id): node IDs 0-0xBF, group addresses
+ * GROUP_ADDR(g) for every node in broadcast group g (set by the session
+ * config), NODE_ID_HUB for the hub and NODE_ID_BROADCAST for everyone.
+ * Frames for a node without an ESP-NOW peer entry go out as broadcasts
+ * and receivers drop what is not addressed to them.
  */
 
 #ifndef PROTOCOL_H
 #define PROTOCOL_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include <stdbool.h>
 
 #ifdef __cplusplus
@@ -32,6 +52,42 @@ extern "C" {
 #define MAX_CONFIG_SIZE 2048       // Max configuration blob size
 #define PROTOCOL_VERSION 1
 
+#define CFG_CHUNK_DATA_SIZE 236    // MAX_PACKET_SIZE - 8 header - idx - size - CRC
+#define CFG_MAX_CHUNKS 32          // 7.5 KB per transfer
+#define CFG_CHUNK_BITMAP_BYTES (CFG_MAX_CHUNKS / 8)
+
+// CFG_ACK status codes
+#define CFG_STATUS_OK 0            // Configuration loaded and applied
+#define CFG_STATUS_MISSING 1       // Chunks missing (see chunk_bitmap)
+#define CFG_STATUS_CHECKSUM 2      // All chunks in, CRC wrong (buffer discarded)
+#define CFG_STATUS_REJECTED 3      // Loaded but invalid / not applicable
+#define CFG_STATUS_NO_TRANSFER 4   // CFG_END without matching CFG_BEGIN
+
+#define POKE_BATCH_MAX_ENTRIES 29  // (MAX_PACKET_SIZE - 8 header - 4 time - 1 count) / 8 per entry
+#define OFFER_MAX_ASSIGNMENTS 29   // (MAX_PACKET_SIZE - 8 header - 32 id - 2 size - 1 nodes - 1 count) / 7
+#define POKE_ENTRY_RANDOM_PHASE 0x01
+#define POKE_APPLY_NOW 0            // apply_at_us: apply on arrival
+
+#define HEARTBEAT_FLAG_TIME_REFERENCE 0x01  // reference_time_us is the shared timebase
+
+// Addresses
+#define NODE_ID_BROADCAST 0xFF      // Every node
+#define NODE_ID_HUB 0xFE            // The hub (outside the node ID range)
+#define GROUP_ADDR_BASE 0xC0        // GROUP_ADDR(g): every node in group g
+#define MAX_GROUPS 32
+#define GROUP_ADDR(g) ((uint8_t)(GROUP_ADDR_BASE + (g)))
+#define GROUP_NONE 0xFF             // Node in no group
+
+#define HELLO_CAP_BASIC 0x01        // Every sender
+#define HELLO_CAP_RELAYED 0x40      // Re-broadcast by a relay (mac_address is the sender's)
+#define HELLO_CAP_HUB 0x80          // Hub discovery request (nodes answer only these)
+
+#define PROTOCOL_COMPACT_MARKER (0xC0 | PROTOCOL_VERSION)
+#define COMPACT_HEADER_MAX 7           // marker, type, source, dest, 3-byte varint
+#define COMPACT_POKE_PAYLOAD 8         // strength, flags, phase (16), 4 weights
+#define COMPACT_STATE_PAYLOAD 4        // amplitude (16), phase (16)
+#define COMPACT_AMPLITUDE_SCALE 4096.0f // Q4.12: |a_0| in [0, 16)
+
 // ============================================================================
 // Message Types
 // ============================================================================
@@ -58,6 +114,11 @@ typedef enum {
     MSG_POKE = 0x30,        ///< Excitation event
     MSG_STATE = 0x31,       ///< State broadcast (optional)
     MSG_HEARTBEAT = 0x32,   ///< Keep-alive
+    MSG_POKE_BATCH = 0x33,  ///< Several pokes in one broadcast frame
+    MSG_POKE_COMPACT = 0x34,  ///< Quantized POKE (compact encoding)
+    MSG_STATE_COMPACT = 0x35, ///< Quantized STATE (compact encoding)
+    MSG_PING = 0x36,        ///< RTT probe (hub → node)
+    MSG_ECHO = 0x37,        ///< PING returned unchanged (node → hub)
 
     // Debug/monitoring
     MSG_DEBUG = 0xF0,       ///< Debug message
@@ -86,18 +147,32 @@ typedef struct __attribute__((packed)) {
 typedef struct __attribute__((packed)) {
     message_header_t header;
     uint8_t mac_address[6]; ///< Node MAC address
-    uint8_t capabilities;   ///< Capability flags
+    uint8_t capabilities;   ///< HELLO_CAP_* flags
     char name[16];          ///< Human-readable name
+    uint32_t config_crc;    ///< CRC of the node's cached session config (0 = none)
 } msg_hello_t;
 
+/**
+ * @brief Node ID assigned to a MAC address (inside an OFFER)
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t mac_address[6]; ///< Node MAC address
+    uint8_t node_id;        ///< Node ID to use from now on
+} offer_assignment_t;
+
 /**
  * @brief OFFER message (controller → nodes)
+ *
+ * Broadcast after discovery with the node IDs for every discovered MAC;
+ * variable length, larger sessions take several frames.
  */
 typedef struct __attribute__((packed)) {
     message_header_t header;
     char session_id[32];    ///< Session identifier
     uint16_t config_size;   ///< Configuration size (bytes)
     uint8_t num_nodes;      ///< Expected number of nodes
+    uint8_t count;          ///< Assignments in this frame
+    offer_assignment_t assignments[OFFER_MAX_ASSIGNMENTS];
 } msg_offer_t;
 
 /**
@@ -126,7 +201,8 @@ typedef struct __attribute__((packed)) {
     message_header_t header;
     uint8_t chunk_idx;          ///< Chunk index
     uint8_t chunk_size;         ///< Data size in this chunk
-    uint8_t data[200];          ///< Configuration data
+    uint32_t data_crc;          ///< CRC32 of data[0..chunk_size)
+    uint8_t data[CFG_CHUNK_DATA_SIZE]; ///< Configuration data (chunk_size valid)
 } msg_cfg_chunk_t;
 
 /**
@@ -138,11 +214,17 @@ typedef struct __attribute__((packed)) {
 } msg_cfg_end_t;
 
 /**
- * @brief CFG_ACK message (acknowledgment)
+ * @brief CFG_ACK message (node → hub, answers each CFG_END)
+ *
+ * With CFG_STATUS_MISSING the bitmap says which chunks arrived, so the
+ * hub resends only the others.
  */
 typedef struct __attribute__((packed)) {
     message_header_t header;
-    uint8_t status;         ///< 0 = OK, else error code
+    uint8_t status;             ///< CFG_STATUS_*
+    uint32_t checksum;          ///< Transfer being acknowledged (CFG_BEGIN CRC)
+    uint8_t chunks_received;    ///< Chunks held so far
+    uint8_t chunk_bitmap[CFG_CHUNK_BITMAP_BYTES]; ///< Bit i = chunk i held
 } msg_cfg_ack_t;
 
 /**
@@ -168,8 +250,34 @@ typedef struct __attribute__((packed)) {
     float strength;             ///< Excitation strength [0,1]
     float phase_hint;           ///< Phase hint (radians, or -1)
     float mode_weights[4];      ///< Per-mode weights
+    uint32_t apply_at_us;       ///< Shared time to apply (low 32 bits), or POKE_APPLY_NOW
 } msg_poke_t;
 
+/**
+ * @brief One poke inside a POKE_BATCH (quantized to 8 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t target_id;          ///< Node the poke is for (0xFF = every node)
+    uint8_t strength;           ///< Strength × 255
+    uint8_t phase;              ///< Phase hint × 256/2π (ignored if random)
+    uint8_t flags;              ///< POKE_ENTRY_RANDOM_PHASE
+    uint8_t mode_weights[4];    ///< Per-mode weights × 255
+} poke_entry_t;
+
+/**
+ * @brief POKE_BATCH message (hub → all nodes)
+ *
+ * Broadcast carrying pokes for many nodes; each node applies only the
+ * entries addressed to it. A chord or a round of drive notes costs one
+ * frame instead of one unicast per note.
+ */
+typedef struct __attribute__((packed)) {
+    message_header_t header;
+    uint32_t apply_at_us;                           ///< Shared time for every entry, or POKE_APPLY_NOW
+    uint8_t count;                                  ///< Valid entries
+    poke_entry_t entries[POKE_BATCH_MAX_ENTRIES];
+} msg_poke_batch_t;
+
 /**
  * @brief STATE message (optional state broadcast)
  */
@@ -182,13 +290,43 @@ typedef struct __attribute__((packed)) {
 
 /**
  * @brief HEARTBEAT message (keep-alive)
+ *
+ * Loads cover the interval since the sender's previous heartbeat; the
+ * telemetry fields are 0 in the hub's heartbeats.
  */
 typedef struct __attribute__((packed)) {
     message_header_t header;
     uint32_t uptime_ms;     ///< Node uptime
-    uint8_t cpu_usage;      ///< CPU usage %
+    uint8_t cpu_usage;      ///< Busiest core's load % (control + network, or audio)
+    uint16_t audio_underruns;     ///< I2S DMA underruns since boot (wraps)
+    uint16_t audio_late_buffers;  ///< Renders longer than one buffer period (wraps)
+    uint8_t flags;                ///< HEARTBEAT_FLAG_*
+    int64_t reference_time_us;    ///< Sender's esp_timer clock at send
+
+    // Task timing
+    uint8_t control_load;         ///< Control task busy %
+    uint8_t network_load;         ///< Message handling busy %
+    uint8_t audio_load;           ///< Audio render busy %
+    uint16_t control_max_us;      ///< Longest control step since boot (saturates)
+    uint16_t control_overruns;    ///< Steps longer than the control period (wraps)
+    uint16_t audio_max_render_us; ///< Longest render since boot (saturates)
+    uint8_t poke_queue_hwm;       ///< Most pokes waiting at one control tick
+    uint16_t poke_drops;          ///< Pokes lost to a full queue (wraps)
+    uint16_t pokes_received;      ///< Pokes taken by the control task (wraps)
 } msg_heartbeat_t;
 
+/**
+ * @brief PING / ECHO message (link RTT and loss)
+ *
+ * The receiver returns the PING as an ECHO with the same ping_seq and
+ * sent_us; the sender's RTT is its clock at reception minus sent_us.
+ */
+typedef struct __attribute__((packed)) {
+    message_header_t header;
+    uint16_t ping_seq;      ///< Per-peer ping sequence
+    int64_t sent_us;        ///< Pinger's esp_timer clock at send
+} msg_ping_t;
+
 /**
  * @brief Generic message union
  */
@@ -204,8 +342,10 @@ typedef union {
     msg_start_t start;
     msg_stop_t stop;
     msg_poke_t poke;
+    msg_poke_batch_t poke_batch;
     msg_state_t state;
     msg_heartbeat_t heartbeat;
+    msg_ping_t ping;
     uint8_t raw[MAX_PACKET_SIZE];
 } network_message_t;
 
@@ -213,6 +353,16 @@ typedef union {
 // Protocol API
 // ============================================================================
 
+/**
+ * @brief Whether a frame addressed to dest_id is for this node
+ *
+ * @param dest_id Header destination
+ * @param node_id This node's ID
+ * @param group This node's group (GROUP_NONE = none)
+ * @return true for our ID, our group's address or broadcast
+ */
+bool protocol_addressed_to(uint8_t dest_id, uint8_t node_id, uint8_t group);
+
 /**
  * @brief Initialize message header
  *
@@ -256,6 +406,91 @@ size_t protocol_create_poke(network_message_t* msg,
                            float phase_hint,
                            const float* mode_weights);
 
+/**
+ * @brief Start an empty POKE_BATCH message
+ *
+ * @param msg Pointer to message buffer
+ * @param source_id Source node ID
+ * @return Message size (bytes, grows with each entry)
+ */
+size_t protocol_create_poke_batch(network_message_t* msg, uint8_t source_id);
+
+/**
+ * @brief Append a poke to a POKE_BATCH message
+ *
+ * Strength and weights are clamped to [0,1] and quantized to 8 bits.
+ *
+ * @param msg Batch started with protocol_create_poke_batch()
+ * @param target_id Destination node ID (0xFF = every node)
+ * @param strength Excitation strength
+ * @param phase_hint Phase hint (or -1 for random)
+ * @param mode_weights Mode weights array (NULL = all 1)
+ * @return true if added, false if the batch is full
+ */
+bool protocol_poke_batch_add(network_message_t* msg,
+                             uint8_t target_id,
+                             float strength,
+                             float phase_hint,
+                             const float* mode_weights);
+
+/**
+ * @brief Size of a POKE_BATCH message on the wire
+ *
+ * @param batch Batch message
+ * @return Message size (bytes)
+ */
+size_t protocol_poke_batch_size(const msg_poke_batch_t* batch);
+
+/**
+ * @brief Expand a batch entry
+ *
+ * @param entry Entry to decode
+ * @param strength Output strength [0,1]
+ * @param phase_hint Output phase hint (radians, or -1 for random)
+ * @param mode_weights Output mode weights (4 floats)
+ */
+void protocol_poke_entry_decode(const poke_entry_t* entry,
+                                float* strength,
+                                float* phase_hint,
+                                float* mode_weights);
+
+/**
+ * @brief Create compact POKE message (13-15 bytes instead of 32)
+ *
+ * Strength and weights are quantized to 8 bits, phase to 16 bits.
+ *
+ * @param msg Pointer to message buffer (encoded into msg->raw)
+ * @param source_id Source node ID
+ * @param dest_id Destination node ID
+ * @param strength Excitation strength [0,1]
+ * @param phase_hint Phase hint (or -1)
+ * @param mode_weights Mode weights array (NULL = all 1)
+ * @return Message size (bytes)
+ */
+size_t protocol_create_poke_compact(network_message_t* msg,
+                                    uint8_t source_id,
+                                    uint8_t dest_id,
+                                    float strength,
+                                    float phase_hint,
+                                    const float* mode_weights);
+
+/**
+ * @brief Create compact STATE message (9-11 bytes instead of 20)
+ *
+ * Mode 0 is sent as 16-bit amplitude (COMPACT_AMPLITUDE_SCALE, clamped)
+ * and 16-bit phase, which is enough to rebuild Re/Im for coupling.
+ *
+ * @param msg Pointer to message buffer (encoded into msg->raw)
+ * @param source_id Source node ID
+ * @param mode0_real Re(a_0)
+ * @param mode0_imag Im(a_0)
+ * @return Message size (bytes)
+ */
+size_t protocol_create_state_compact(network_message_t* msg,
+                                     uint8_t source_id,
+                                     float mode0_real,
+                                     float mode0_imag);
+
 /**
  * @brief Create START message
  *
@@ -291,6 +526,32 @@ size_t protocol_create_heartbeat(network_message_t* msg,
                                  uint32_t uptime_ms,
                                  uint8_t cpu_usage);
 
+/**
+ * @brief Create PING message (stamped with esp_timer_get_time())
+ *
+ * @param msg Pointer to message buffer
+ * @param source_id Source node ID
+ * @param dest_id Node to measure
+ * @param ping_seq Per-peer ping sequence
+ * @return Message size (bytes)
+ */
+size_t protocol_create_ping(network_message_t* msg,
+                            uint8_t source_id,
+                            uint8_t dest_id,
+                            uint16_t ping_seq);
+
+/**
+ * @brief Create the ECHO answering a PING
+ *
+ * @param msg Pointer to message buffer
+ * @param source_id Source node ID (the echoing node)
+ * @param ping PING being answered
+ * @return Message size (bytes)
+ */
+size_t protocol_create_echo(network_message_t* msg,
+                            uint8_t source_id,
+                            const msg_ping_t* ping);
+
 /**
  * @brief Create OFFER message
  *
@@ -307,6 +568,33 @@ size_t protocol_create_offer(network_message_t* msg,
                              uint16_t config_size,
                              uint8_t num_nodes);
 
+/**
+ * @brief Append a node ID assignment to an OFFER message
+ *
+ * @param msg Offer started with protocol_create_offer()
+ * @param mac Node MAC address
+ * @param node_id Node ID assigned to it
+ * @return true if added, false if the frame is full
+ */
+bool protocol_offer_add(network_message_t* msg, const uint8_t* mac, uint8_t node_id);
+
+/**
+ * @brief Size of an OFFER message on the wire
+ *
+ * @param offer Offer message
+ * @return Message size (bytes)
+ */
+size_t protocol_offer_size(const msg_offer_t* offer);
+
+/**
+ * @brief Node ID an OFFER assigns to a MAC address
+ *
+ * @param offer Offer message
+ * @param mac MAC address to look up
+ * @return Assigned node ID, or 0xFF if the frame has none for it
+ */
+uint8_t protocol_offer_find(const msg_offer_t* offer, const uint8_t* mac);
+
 /**
  * @brief Create JOIN message
  *
@@ -371,13 +659,19 @@ size_t protocol_create_cfg_end(network_message_t* msg,
  * @param msg Pointer to message buffer
  * @param source_id Source node ID
  * @param dest_id Destination node ID
- * @param status Status code (0 = OK)
+ * @param status Status code (CFG_STATUS_*)
+ * @param checksum CRC of the transfer being acknowledged
+ * @param chunk_bitmap Received chunks (CFG_CHUNK_BITMAP_BYTES, NULL = none)
+ * @param chunks_received Number of chunks held
  * @return Message size (bytes)
  */
 size_t protocol_create_cfg_ack(network_message_t* msg,
                                uint8_t source_id,
                                uint8_t dest_id,
-                               uint8_t status);
+                               uint8_t status,
+                               uint32_t checksum,
+                               const uint8_t* chunk_bitmap,
+                               uint8_t chunks_received);
 
 /**
  * @brief Parse received message
@@ -394,6 +688,10 @@ bool protocol_parse_message(const uint8_t* data,
 /**
  * @brief Validate message checksum
  *
+ * CFG_CHUNK carries a CRC of its data; other types rely on the 802.11
+ * frame check and always pass. protocol_parse_message() calls this, so
+ * a corrupt chunk is dropped and later reported missing.
+ *
  * @param msg Message to validate
  * @return true if valid, false otherwise
  */
@@ -408,6 +706,20 @@ bool protocol_validate_checksum(const network_message_t* msg);
  */
 uint32_t protocol_crc32(const uint8_t* data, size_t len);
 
+/**
+ * @brief Extend a CRC32 over more data
+ *
+ * protocol_crc32_update(protocol_crc32(a), b) == protocol_crc32(a ‖ b),
+ * and protocol_crc32_update(0, ...) starts a new CRC (zlib convention).
+ * Uses the ROM routine on ESP32 targets.
+ *
+ * @param crc CRC32 of the data so far (0 for none)
+ * @param data Next data
+ * @param len Data length
+ * @return CRC32 including data
+ */
+uint32_t protocol_crc32_update(uint32_t crc, const uint8_t* data, size_t len);
+
 #ifdef __cplusplus
 }
 #endif
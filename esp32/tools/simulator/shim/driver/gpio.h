@@ -0,0 +1,15 @@
+/**
+ * @file gpio.h
+ * @brief GPIO numbers (pins are not simulated)
+ */
+
+#ifndef DRIVER_GPIO_H
+#define DRIVER_GPIO_H
+
+#include "esp_err.h"
+
+typedef int gpio_num_t;
+
+#define GPIO_NUM_NC (-1)
+
+#endif // DRIVER_GPIO_H
@@ -0,0 +1,128 @@
+/**
+ * @file i2s.h
+ * @brief Legacy I2S driver on the simulator (DMA descriptor model)
+ *
+ * The DMA plays one descriptor per period at the configured sample rate
+ * and recycles it; i2s_write() blocks while every descriptor is full.
+ * A period with nothing written plays silence and posts
+ * I2S_EVENT_TX_Q_OVF. Playback starts with the first write.
+ */
+
+#ifndef DRIVER_I2S_H
+#define DRIVER_I2S_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    I2S_NUM_0 = 0,
+    I2S_NUM_1,
+    I2S_NUM_MAX
+} i2s_port_t;
+
+typedef enum {
+    I2S_MODE_MASTER = 1 << 0,
+    I2S_MODE_SLAVE = 1 << 1,
+    I2S_MODE_TX = 1 << 2,
+    I2S_MODE_RX = 1 << 3
+} i2s_mode_t;
+
+typedef enum {
+    I2S_BITS_PER_SAMPLE_16BIT = 16,
+    I2S_BITS_PER_SAMPLE_24BIT = 24,
+    I2S_BITS_PER_SAMPLE_32BIT = 32
+} i2s_bits_per_sample_t;
+
+typedef enum {
+    I2S_CHANNEL_FMT_RIGHT_LEFT,
+    I2S_CHANNEL_FMT_ALL_RIGHT,
+    I2S_CHANNEL_FMT_ALL_LEFT,
+    I2S_CHANNEL_FMT_ONLY_RIGHT,
+    I2S_CHANNEL_FMT_ONLY_LEFT,
+    I2S_CHANNEL_FMT_MULTIPLE
+} i2s_channel_fmt_t;
+
+typedef enum {
+    I2S_COMM_FORMAT_STAND_I2S = 0x01,
+    I2S_COMM_FORMAT_STAND_MSB = 0x02
+} i2s_comm_format_t;
+
+typedef enum {
+    I2S_MCLK_MULTIPLE_128 = 128,
+    I2S_MCLK_MULTIPLE_256 = 256,
+    I2S_MCLK_MULTIPLE_384 = 384
+} i2s_mclk_multiple_t;
+
+typedef enum {
+    I2S_SLOT_MODE_MONO = 1,
+    I2S_SLOT_MODE_STEREO = 2,
+    I2S_SLOT_MODE_QUAD = 4
+} i2s_slot_mode_t;
+
+#define I2S_PIN_NO_CHANGE (-1)
+#define ESP_INTR_FLAG_LEVEL1 (1 << 1)
+
+typedef struct {
+    int sample_bits;
+    int slot_bits;
+    i2s_slot_mode_t slot_mode;  ///< Channels per frame
+} i2s_bits_cfg_t;
+
+typedef struct {
+    int mode;
+    int sample_rate;
+    i2s_bits_per_sample_t bits_per_sample;
+    i2s_channel_fmt_t channel_format;
+    int communication_format;
+    int intr_alloc_flags;
+    int dma_buf_count;     ///< Descriptors
+    int dma_buf_len;       ///< Samples per descriptor (all channels)
+    bool use_apll;
+    bool tx_desc_auto_clear;
+    int fixed_mclk;
+    i2s_mclk_multiple_t mclk_multiple;
+    i2s_bits_cfg_t bits_cfg;
+} i2s_config_t;
+
+typedef struct {
+    int mck_io_num;
+    int bck_io_num;
+    int ws_io_num;
+    int data_out_num;
+    int data_in_num;
+} i2s_pin_config_t;
+
+typedef enum {
+    I2S_EVENT_DMA_ERROR,
+    I2S_EVENT_TX_DONE,
+    I2S_EVENT_RX_DONE,
+    I2S_EVENT_TX_Q_OVF,
+    I2S_EVENT_RX_Q_OVF,
+    I2S_EVENT_MAX
+} i2s_event_type_t;
+
+typedef struct {
+    i2s_event_type_t type;
+    size_t size;
+} i2s_event_t;
+
+esp_err_t i2s_driver_install(i2s_port_t i2s_num, const i2s_config_t* i2s_config,
+                             int queue_num, void* i2s_queue);
+esp_err_t i2s_driver_uninstall(i2s_port_t i2s_num);
+esp_err_t i2s_set_pin(i2s_port_t i2s_num, const i2s_pin_config_t* pin);
+esp_err_t i2s_write(i2s_port_t i2s_num, const void* src, size_t size,
+                    size_t* bytes_written, TickType_t ticks_to_wait);
+esp_err_t i2s_zero_dma_buffer(i2s_port_t i2s_num);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DRIVER_I2S_H
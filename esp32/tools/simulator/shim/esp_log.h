@@ -0,0 +1,53 @@
+/**
+ * @file esp_log.h
+ * @brief ESP_LOGx on the simulator: prefixed with virtual time and device
+ *
+ * Formats are checked like the IDF's (printf attribute). Messages below
+ * the level set with sim_set_log_level() are not formatted.
+ */
+
+#ifndef ESP_LOG_H
+#define ESP_LOG_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+extern esp_log_level_t sim_log_threshold;
+
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+/**
+ * @brief Milliseconds since this device booted
+ */
+uint32_t esp_log_timestamp(void);
+
+#define ESP_LOG_LEVEL(level, tag, format, ...) do {                         \
+        if ((level) <= sim_log_threshold) {                                 \
+            esp_log_write(level, tag, format, ##__VA_ARGS__);               \
+        }                                                                   \
+    } while (0)
+
+#define ESP_LOGE(tag, format, ...) ESP_LOG_LEVEL(ESP_LOG_ERROR, tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) ESP_LOG_LEVEL(ESP_LOG_WARN, tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ESP_LOG_LEVEL(ESP_LOG_INFO, tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) ESP_LOG_LEVEL(ESP_LOG_DEBUG, tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) ESP_LOG_LEVEL(ESP_LOG_VERBOSE, tag, format, ##__VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ESP_LOG_H
@@ -0,0 +1,66 @@
+/**
+ * @file esp_now.h
+ * @brief ESP-NOW over the simulated radio channel
+ *
+ * Same calls and callback contexts as the IDF: send-complete and
+ * receive callbacks run in the device's Wi-Fi task, unicast frames are
+ * retried by the MAC and only reported SUCCESS once acknowledged.
+ */
+
+#ifndef ESP_NOW_H
+#define ESP_NOW_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_wifi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_NOW_ETH_ALEN 6
+#define ESP_NOW_KEY_LEN 16
+#define ESP_NOW_MAX_TOTAL_PEER_NUM 20
+#define ESP_NOW_MAX_DATA_LEN 250
+
+typedef enum {
+    ESP_NOW_SEND_SUCCESS = 0,
+    ESP_NOW_SEND_FAIL
+} esp_now_send_status_t;
+
+typedef struct {
+    uint8_t peer_addr[ESP_NOW_ETH_ALEN];
+    uint8_t lmk[ESP_NOW_KEY_LEN];
+    uint8_t channel;
+    wifi_interface_t ifidx;
+    bool encrypt;
+    void* priv;
+} esp_now_peer_info_t;
+
+typedef struct {
+    uint8_t* src_addr;
+    uint8_t* des_addr;
+    wifi_pkt_rx_ctrl_t* rx_ctrl;
+} esp_now_recv_info_t;
+
+typedef void (*esp_now_recv_cb_t)(const esp_now_recv_info_t* esp_now_info,
+                                  const uint8_t* data, int data_len);
+typedef void (*esp_now_send_cb_t)(const uint8_t* mac_addr, esp_now_send_status_t status);
+
+esp_err_t esp_now_init(void);
+esp_err_t esp_now_deinit(void);
+esp_err_t esp_now_register_recv_cb(esp_now_recv_cb_t cb);
+esp_err_t esp_now_register_send_cb(esp_now_send_cb_t cb);
+esp_err_t esp_now_send(const uint8_t* peer_addr, const uint8_t* data, size_t len);
+esp_err_t esp_now_add_peer(const esp_now_peer_info_t* peer);
+esp_err_t esp_now_del_peer(const uint8_t* peer_addr);
+esp_err_t esp_now_get_peer(const uint8_t* peer_addr, esp_now_peer_info_t* peer);
+bool esp_now_is_peer_exist(const uint8_t* peer_addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ESP_NOW_H
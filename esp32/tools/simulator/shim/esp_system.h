@@ -0,0 +1,25 @@
+/**
+ * @file esp_system.h
+ * @brief System control on the simulator
+ */
+
+#ifndef ESP_SYSTEM_H
+#define ESP_SYSTEM_H
+
+#include <stdlib.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Halt this device (its tasks stop, its radio goes quiet)
+ */
+void esp_restart(void) __attribute__((noreturn));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ESP_SYSTEM_H
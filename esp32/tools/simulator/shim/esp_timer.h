@@ -0,0 +1,24 @@
+/**
+ * @file esp_timer.h
+ * @brief Device clock on the simulator
+ */
+
+#ifndef ESP_TIMER_H
+#define ESP_TIMER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Microseconds since this device booted (its own drifting clock)
+ */
+int64_t esp_timer_get_time(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ESP_TIMER_H
@@ -0,0 +1,67 @@
+/**
+ * @file FreeRTOS.h
+ * @brief FreeRTOS types and port macros on the simulator
+ *
+ * Tasks are cooperative coroutines on one host thread scheduled in
+ * virtual time (src/sim_sched.c), so critical sections need no lock.
+ * They are still tracked: blocking inside one aborts the simulation.
+ */
+
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE  ((BaseType_t)1)
+#define pdPASS  (pdTRUE)
+#define pdFAIL  (pdFALSE)
+#define errQUEUE_EMPTY ((BaseType_t)0)
+#define errQUEUE_FULL  ((BaseType_t)0)
+
+#define configTICK_RATE_HZ CONFIG_FREERTOS_HZ
+#define configMAX_PRIORITIES 25
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(xTimeInMs) \
+    ((TickType_t)(((uint64_t)(xTimeInMs) * (uint64_t)configTICK_RATE_HZ) / 1000U))
+
+#define tskNO_AFFINITY ((BaseType_t)0x7FFFFFFF)
+
+typedef struct {
+    uint32_t owner;
+    uint32_t count;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED { .owner = 0, .count = 0 }
+#define portMUX_INITIALIZE(mux) do { (mux)->owner = 0; (mux)->count = 0; } while (0)
+
+void vPortEnterCritical(portMUX_TYPE* mux);
+void vPortExitCritical(portMUX_TYPE* mux);
+
+#define portENTER_CRITICAL(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) vPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux) vPortExitCritical(mux)
+#define portYIELD_FROM_ISR(x) ((void)(x))
+
+/**
+ * @brief Core the calling task is pinned to
+ */
+BaseType_t xPortGetCoreID(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FREERTOS_H
@@ -0,0 +1,41 @@
+/**
+ * @file queue.h
+ * @brief FreeRTOS queues on the simulator (copy semantics, FIFO waiters)
+ */
+
+#ifndef FREERTOS_QUEUE_H
+#define FREERTOS_QUEUE_H
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct QueueDefinition;
+typedef struct QueueDefinition* QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize);
+void vQueueDelete(QueueHandle_t xQueue);
+BaseType_t xQueueReset(QueueHandle_t xQueue);
+
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void* pvItemToQueue, TickType_t xTicksToWait);
+BaseType_t xQueueSendToFront(QueueHandle_t xQueue, const void* pvItemToQueue, TickType_t xTicksToWait);
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void* const pvBuffer, TickType_t xTicksToWait);
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void* const pvBuffer, TickType_t xTicksToWait);
+BaseType_t xQueueSendFromISR(QueueHandle_t xQueue, const void* pvItemToQueue,
+                             BaseType_t* pxHigherPriorityTaskWoken);
+BaseType_t xQueueReceiveFromISR(QueueHandle_t xQueue, void* const pvBuffer,
+                                BaseType_t* pxHigherPriorityTaskWoken);
+
+#define xQueueSendToBack(xQueue, pvItemToQueue, xTicksToWait) \
+    xQueueSend((xQueue), (pvItemToQueue), (xTicksToWait))
+
+UBaseType_t uxQueueMessagesWaiting(const QueueHandle_t xQueue);
+UBaseType_t uxQueueSpacesAvailable(const QueueHandle_t xQueue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FREERTOS_QUEUE_H
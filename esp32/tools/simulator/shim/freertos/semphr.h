@@ -0,0 +1,32 @@
+/**
+ * @file semphr.h
+ * @brief FreeRTOS semaphores on the simulator (queues of zero-size items)
+ */
+
+#ifndef FREERTOS_SEMPHR_H
+#define FREERTOS_SEMPHR_H
+
+#include "queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount);
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+
+#define xSemaphoreTake(xSemaphore, xBlockTime) xQueueReceive((xSemaphore), NULL, (xBlockTime))
+#define xSemaphoreGive(xSemaphore) xQueueSend((xSemaphore), NULL, 0)
+#define xSemaphoreGiveFromISR(xSemaphore, pxHigherPriorityTaskWoken) \
+    xQueueSendFromISR((xSemaphore), NULL, (pxHigherPriorityTaskWoken))
+#define vSemaphoreDelete(xSemaphore) vQueueDelete(xSemaphore)
+#define uxSemaphoreGetCount(xSemaphore) uxQueueMessagesWaiting(xSemaphore)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FREERTOS_SEMPHR_H
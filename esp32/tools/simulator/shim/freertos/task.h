@@ -0,0 +1,51 @@
+/**
+ * @file task.h
+ * @brief FreeRTOS task API on the simulator
+ */
+
+#ifndef FREERTOS_TASK_H
+#define FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct tskTaskControlBlock;
+typedef struct tskTaskControlBlock* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pvTaskCode, const char* const pcName,
+                                   const uint32_t usStackDepth, void* const pvParameters,
+                                   UBaseType_t uxPriority, TaskHandle_t* const pvCreatedTask,
+                                   const BaseType_t xCoreID);
+
+static inline BaseType_t xTaskCreate(TaskFunction_t pvTaskCode, const char* const pcName,
+                                     const uint32_t usStackDepth, void* const pvParameters,
+                                     UBaseType_t uxPriority, TaskHandle_t* const pvCreatedTask) {
+    return xTaskCreatePinnedToCore(pvTaskCode, pcName, usStackDepth, pvParameters,
+                                   uxPriority, pvCreatedTask, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete);
+void vTaskDelay(const TickType_t xTicksToDelay);
+BaseType_t xTaskDelayUntil(TickType_t* const pxPreviousWakeTime, const TickType_t xTimeIncrement);
+#define vTaskDelayUntil(pxPreviousWakeTime, xTimeIncrement) \
+    ((void)xTaskDelayUntil((pxPreviousWakeTime), (xTimeIncrement)))
+
+TickType_t xTaskGetTickCount(void);
+TickType_t xTaskGetTickCountFromISR(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+UBaseType_t uxTaskPriorityGet(const TaskHandle_t xTask);
+void taskYIELD(void);
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait);
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify);
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t* pxHigherPriorityTaskWoken);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FREERTOS_TASK_H
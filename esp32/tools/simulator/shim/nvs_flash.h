@@ -0,0 +1,22 @@
+/**
+ * @file nvs_flash.h
+ * @brief NVS partition init on the simulator
+ */
+
+#ifndef NVS_FLASH_H
+#define NVS_FLASH_H
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t nvs_flash_init(void);
+esp_err_t nvs_flash_erase(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NVS_FLASH_H
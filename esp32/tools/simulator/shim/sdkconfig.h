@@ -0,0 +1,48 @@
+/**
+ * @file sdkconfig.h
+ * @brief Simulator build configuration (Kconfig.projbuild defaults)
+ *
+ * Stands in for the file idf.py generates. Values follow
+ * firmware/main/Kconfig.projbuild and firmware/sdkconfig.defaults;
+ * override any of them with -D on the CMake command line.
+ */
+
+#ifndef SDKCONFIG_H
+#define SDKCONFIG_H
+
+// FreeRTOS / system (sdkconfig.defaults)
+#define CONFIG_FREERTOS_HZ 1000
+#define CONFIG_LOG_DEFAULT_LEVEL 3
+
+// Modal Node (Kconfig.projbuild)
+#define CONFIG_MODAL_NODE_ID 0
+#define CONFIG_MODAL_DEFAULT_CARRIER_FREQ 440
+#define CONFIG_MODAL_USE_DEFAULT_CONFIG 1
+
+#ifndef CONFIG_MODAL_AUDIO_PERIOD_SAMPLES
+#define CONFIG_MODAL_AUDIO_PERIOD_SAMPLES 120
+#endif
+
+#ifndef CONFIG_MODAL_AUDIO_DMA_BUFFERS
+#define CONFIG_MODAL_AUDIO_DMA_BUFFERS 3
+#endif
+
+// CONFIG_MODAL_AUDIO_FIXED_POINT: define to 1 to build the Q15 renderer
+
+#ifndef CONFIG_MODAL_STATE_RATE_HZ
+#define CONFIG_MODAL_STATE_RATE_HZ 50
+#endif
+
+#ifndef CONFIG_MODAL_STATE_TIMEOUT_MS
+#define CONFIG_MODAL_STATE_TIMEOUT_MS 100
+#endif
+
+#ifndef CONFIG_MODAL_CLOCK_SYNC_INTERVAL_MS
+#define CONFIG_MODAL_CLOCK_SYNC_INTERVAL_MS 1000
+#endif
+
+#ifndef CONFIG_MODAL_POKE_LATENCY_MS
+#define CONFIG_MODAL_POKE_LATENCY_MS 10
+#endif
+
+#endif // SDKCONFIG_H
@@ -0,0 +1,214 @@
+/**
+ * @file sim.h
+ * @brief Host-side multi-node simulator for the ESP32 firmware
+ *
+ * Runs unmodified firmware (main.c or hub_main.c plus everything under
+ * firmware/main) for many devices in one process. Each device is its own
+ * copy of a firmware module, so its statics are its own; its FreeRTOS
+ * tasks are coroutines scheduled in virtual time, and ESP-NOW frames
+ * cross a modeled shared channel (airtime, contention, latency, loss).
+ *
+ * Deterministic: a run depends only on the configuration, the seed and
+ * the calls made through this API. Virtual time does not advance while
+ * firmware code executes; host CPU time is recorded per task instead
+ * (sim_task_stats()).
+ *
+ * All functions are called from the tool's thread, outside sim_run_until()
+ * or from callbacks it makes.
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define SIM_MAX_DEVICES 128
+
+// ============================================================================
+// Type Definitions
+// ============================================================================
+
+/**
+ * @brief Simulation parameters (sim_config_default() for the defaults)
+ */
+typedef struct {
+    uint64_t seed;          ///< Drives loss, jitter and contention
+    double loss;            ///< Per-receiver frame loss probability (every link)
+    uint32_t latency_us;    ///< End of airtime to the receive callback
+    uint32_t jitter_us;     ///< Extra receive latency, uniform in [0, jitter_us)
+    double phy_rate_mbps;   ///< ESP-NOW PHY rate (the IDF default is 1 Mbps)
+    uint8_t mac_retries;    ///< Unicast retransmissions before SEND_FAIL
+    bool audio;             ///< false: tasks named "audio" are not started
+    int log_level;          ///< esp_log_level_t: 1 error ... 5 verbose
+} sim_config_t;
+
+/**
+ * @brief One transmission on the channel, as passed to the frame tap
+ */
+typedef struct {
+    int device;              ///< Sender
+    const uint8_t* dest_mac; ///< FF:FF:FF:FF:FF:FF for broadcasts
+    const uint8_t* data;     ///< ESP-NOW payload
+    size_t len;
+    bool broadcast;
+    int64_t queued_us;       ///< Handed to the driver
+    int64_t start_us;        ///< First bit on air (after contention)
+    int64_t end_us;          ///< Last retry finished (send callback due)
+    uint32_t airtime_us;     ///< Channel time used, retries included
+    uint8_t attempts;
+    bool acked;              ///< Unicast only
+    uint16_t receivers;      ///< Devices it reached (before their RX queues)
+} sim_frame_t;
+
+typedef void (*sim_frame_tap_t)(void* ctx, const sim_frame_t* frame);
+
+/**
+ * @brief Audio as the DMA plays it
+ *
+ * Called once per DMA descriptor. samples is NULL for a period played as
+ * silence because nothing was written (an underrun).
+ */
+typedef void (*sim_audio_tap_t)(void* ctx, int device, int64_t start_us,
+                                const int16_t* samples, size_t frames, int channels);
+
+/**
+ * @brief Channel totals since sim_init()
+ */
+typedef struct {
+    uint64_t frames;            ///< Transmissions handed to the channel
+    uint64_t broadcasts;
+    uint64_t bytes;             ///< Payload bytes
+    uint64_t retries;           ///< Unicast retransmissions
+    uint64_t unicast_failed;    ///< Unicasts never acknowledged
+    uint64_t delivered;         ///< Frame copies that reached a device
+    uint64_t lost;              ///< Frame copies lost on a link
+    uint64_t rx_overflow;       ///< Copies dropped by a full Wi-Fi RX queue
+    uint64_t rx_not_listening;  ///< Copies for devices without ESP-NOW up
+    int64_t airtime_us;         ///< Channel busy time
+    int64_t max_wait_us;        ///< Longest wait for the channel
+} sim_radio_stats_t;
+
+/**
+ * @brief Host CPU time of every task with one name, across devices
+ */
+typedef struct {
+    char name[16];
+    uint32_t tasks;     ///< Instances
+    uint64_t runs;      ///< Times scheduled
+    uint64_t cpu_ns;    ///< Host time spent running
+} sim_task_stats_t;
+
+// ============================================================================
+// Setup & Running
+// ============================================================================
+
+void sim_config_default(sim_config_t* config);
+
+/**
+ * @brief Start an empty simulation (time 0)
+ *
+ * @return false if the module staging directory cannot be created
+ */
+bool sim_init(const sim_config_t* config);
+
+/**
+ * @brief Unload every device
+ */
+void sim_shutdown(void);
+
+/**
+ * @brief Load a firmware module for a new device
+ *
+ * @param module_path Shared object exporting app_main()
+ * @param name Label in logs ("hub", "n07", ...)
+ * @param boot_us Virtual time at which app_main() starts
+ * @param drift_ppm Crystal error of the device clock
+ * @return Device index, or -1 (error printed)
+ */
+int sim_add_device(const char* module_path, const char* name, int64_t boot_us, double drift_ppm);
+
+int sim_num_devices(void);
+const char* sim_device_name(int device);
+void sim_device_mac(int device, uint8_t mac[6]);
+
+/**
+ * @brief Device with this station MAC, or -1
+ */
+int sim_device_by_mac(const uint8_t mac[6]);
+
+/**
+ * @brief Run every device until virtual time t_us
+ */
+void sim_run_until(int64_t t_us);
+
+/**
+ * @brief Current virtual time (µs)
+ */
+int64_t sim_now(void);
+
+/**
+ * @brief Call fn(arg) at virtual time at_us, outside any device
+ */
+void sim_at(int64_t at_us, void (*fn)(void* arg), void* arg);
+
+/**
+ * @brief Next value of the simulation's random stream
+ */
+uint32_t sim_random(void);
+
+// ============================================================================
+// Radio
+// ============================================================================
+
+/**
+ * @brief Loss probability of one direction of a link (1.0 = out of range)
+ */
+void sim_set_link_loss(int from, int to, double loss);
+
+void sim_set_frame_tap(sim_frame_tap_t tap, void* ctx);
+
+const sim_radio_stats_t* sim_radio_stats(void);
+
+// ============================================================================
+// Peripherals
+// ============================================================================
+
+/**
+ * @brief Feed bytes to a device's UART RX line
+ *
+ * They start arriving now, or after bytes still on the line.
+ *
+ * @return Virtual time at which the last byte is received (-1 on error)
+ */
+int64_t sim_uart_inject(int device, int port, const uint8_t* data, size_t len);
+
+void sim_set_audio_tap(sim_audio_tap_t tap, void* ctx);
+
+// ============================================================================
+// Diagnostics
+// ============================================================================
+
+void sim_set_log_level(int level);
+
+/**
+ * @brief Per-task-name host CPU profile, busiest first
+ *
+ * @return Entries written
+ */
+size_t sim_task_stats(sim_task_stats_t* out, size_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_H
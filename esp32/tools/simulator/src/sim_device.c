@@ -0,0 +1,224 @@
+/**
+ * @file sim_device.c
+ * @brief Simulation setup, firmware module loading and device lookup
+ *
+ * dlopen() returns the same handle for a path already loaded, so each
+ * device gets a private copy of its module: the copy is opened with
+ * RTLD_LOCAL and unlinked right away. Every device then has its own
+ * statics (the firmware keeps its state in file-scope globals), while
+ * the FreeRTOS/IDF symbols resolve to this executable.
+ */
+
+#include "sim_internal.h"
+
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// ============================================================================
+// State
+// ============================================================================
+
+sim_world_t sim_world;
+
+#define SIM_MAIN_TASK_PRIORITY 1   // app_main runs in the IDF's main task
+
+static const uint8_t s_mac_prefix[3] = {0x24, 0x0A, 0xC4};  // Espressif OUI
+
+// ============================================================================
+// Random
+// ============================================================================
+
+/**
+ * @brief splitmix64: small, fast, and the same stream on every host
+ */
+static uint64_t next_random(void) {
+    uint64_t z = (sim_world.rng += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+uint32_t sim_random(void) {
+    return (uint32_t)(next_random() >> 32);
+}
+
+double sim_random_unit(void) {
+    return (double)(next_random() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// ============================================================================
+// Setup
+// ============================================================================
+
+void sim_config_default(sim_config_t* config) {
+    memset(config, 0, sizeof(*config));
+    config->seed = 1;
+    config->loss = 0.0;
+    config->latency_us = 100;
+    config->jitter_us = 50;
+    config->phy_rate_mbps = 1.0;
+    config->mac_retries = 5;
+    config->audio = true;
+    config->log_level = 2;  // ESP_LOG_WARN
+}
+
+bool sim_init(const sim_config_t* config) {
+    memset(&sim_world, 0, sizeof(sim_world));
+    sim_world.config = *config;
+    sim_world.rng = config->seed;
+    srand((unsigned)config->seed);  // The firmware draws mode phases from rand()
+
+    for (int i = 0; i < SIM_MAX_DEVICES; i++) {
+        for (int j = 0; j < SIM_MAX_DEVICES; j++) sim_world.link_loss[i][j] = -1.0f;
+    }
+
+    const char* tmp = getenv("TMPDIR");
+    snprintf(sim_world.stage_dir, sizeof(sim_world.stage_dir), "%s/modal_sim.XXXXXX",
+             (tmp && strlen(tmp) < 40) ? tmp : "/tmp");
+    if (!mkdtemp(sim_world.stage_dir)) {
+        perror("modal_sim: mkdtemp");
+        return false;
+    }
+
+    sim_set_log_level(config->log_level);
+    sim_sched_init();
+    return true;
+}
+
+void sim_shutdown(void) {
+    sim_sched_shutdown();
+
+    for (int i = 0; i < sim_world.num_devices; i++) {
+        sim_device_t* device = sim_world.devices[i];
+        sim_periph_free(device);
+        if (device->module) dlclose(device->module);
+        free(device);
+    }
+    rmdir(sim_world.stage_dir);
+    sim_world.num_devices = 0;
+}
+
+// ============================================================================
+// Module Loading
+// ============================================================================
+
+static bool copy_file(const char* from, const char* to) {
+    int in = open(from, O_RDONLY);
+    if (in < 0) return false;
+    int out = open(to, O_WRONLY | O_CREAT | O_TRUNC, 0700);
+    if (out < 0) {
+        close(in);
+        return false;
+    }
+
+    char buf[64 * 1024];
+    ssize_t n;
+    bool ok = true;
+    while ((n = read(in, buf, sizeof(buf))) > 0) {
+        if (write(out, buf, (size_t)n) != n) {
+            ok = false;
+            break;
+        }
+    }
+    ok = ok && n == 0;
+    close(in);
+    return close(out) == 0 && ok;
+}
+
+static void* load_module_copy(const char* module_path, int index) {
+    char path[128];
+    snprintf(path, sizeof(path), "%s/dev%03d.so", sim_world.stage_dir, index);
+
+    if (!copy_file(module_path, path)) {
+        fprintf(stderr, "modal_sim: cannot copy %s\n", module_path);
+        return NULL;
+    }
+    void* module = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    unlink(path);
+    if (!module) fprintf(stderr, "modal_sim: %s\n", dlerror());
+    return module;
+}
+
+// ============================================================================
+// Devices
+// ============================================================================
+
+static void main_task(void* arg) {
+    sim_device_t* device = (sim_device_t*)arg;
+    device->app_main();
+    vTaskDelete(NULL);
+}
+
+static void device_boot(void* arg) {
+    sim_device_t* device = (sim_device_t*)arg;
+    device->booted = true;
+    sim_task_create(device, main_task, "main", device, SIM_MAIN_TASK_PRIORITY, 0);
+}
+
+int sim_add_device(const char* module_path, const char* name, int64_t boot_us, double drift_ppm) {
+    if (sim_world.num_devices >= SIM_MAX_DEVICES) {
+        fprintf(stderr, "modal_sim: more than %d devices\n", SIM_MAX_DEVICES);
+        return -1;
+    }
+
+    int index = sim_world.num_devices;
+    sim_device_t* device = calloc(1, sizeof(sim_device_t));
+    if (!device) return -1;
+
+    device->module = load_module_copy(module_path, index);
+    if (!device->module) {
+        free(device);
+        return -1;
+    }
+    *(void**)&device->app_main = dlsym(device->module, "app_main");
+    if (!device->app_main) {
+        fprintf(stderr, "modal_sim: %s has no app_main\n", module_path);
+        dlclose(device->module);
+        free(device);
+        return -1;
+    }
+
+    device->index = index;
+    snprintf(device->name, sizeof(device->name), "%s", name);
+    device->boot_us = boot_us;
+    device->drift = drift_ppm * 1e-6;
+    memcpy(device->mac, s_mac_prefix, sizeof(s_mac_prefix));
+    device->mac[3] = 0x00;
+    device->mac[4] = (uint8_t)(index >> 8);
+    device->mac[5] = (uint8_t)index;
+
+    sim_radio_reset(device);
+    sim_periph_reset(device);
+
+    sim_world.devices[index] = device;
+    sim_world.num_devices++;
+    sim_schedule(boot_us, device, device_boot, device);
+    return index;
+}
+
+int sim_num_devices(void) {
+    return sim_world.num_devices;
+}
+
+const char* sim_device_name(int device) {
+    return (device >= 0 && device < sim_world.num_devices) ? sim_world.devices[device]->name : "?";
+}
+
+void sim_device_mac(int device, uint8_t mac[6]) {
+    if (device >= 0 && device < sim_world.num_devices) {
+        memcpy(mac, sim_world.devices[device]->mac, 6);
+    } else {
+        memset(mac, 0, 6);
+    }
+}
+
+int sim_device_by_mac(const uint8_t mac[6]) {
+    // MACs encode the index (see sim_add_device)
+    if (memcmp(mac, s_mac_prefix, sizeof(s_mac_prefix)) != 0 || mac[3] != 0x00) return -1;
+    int index = (mac[4] << 8) | mac[5];
+    return (index < sim_world.num_devices) ? index : -1;
+}
@@ -0,0 +1,263 @@
+/**
+ * @file sim_internal.h
+ * @brief Device, task and event structures shared by the simulator sources
+ */
+
+#ifndef SIM_INTERNAL_H
+#define SIM_INTERNAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <ucontext.h>
+
+#include "sim.h"
+#include "esp_now.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define SIM_TICK_US (1000000 / configTICK_RATE_HZ)
+#define SIM_FOREVER INT64_MAX
+
+#define SIM_TASK_STACK_SIZE (256 * 1024)  // Host stacks (firmware sizes are for Xtensa)
+#define SIM_SPIN_LIMIT 50000000u          // Clock reads without blocking: task is spinning
+
+#define SIM_ISR_PRIORITY 100              // Callbacks run before tasks due at the same time
+
+#define SIM_NVS_MAX_HANDLES 8
+#define SIM_UART_PORTS 3
+#define SIM_WIFI_TASK_PRIORITY 23         // As the IDF's Wi-Fi task
+#define SIM_WIFI_RX_QUEUE 32              // Dynamic RX buffers (sdkconfig.defaults)
+#define SIM_WIFI_TX_QUEUE 8               // Frames in the driver before ESP_ERR_ESPNOW_NO_MEM
+
+// ============================================================================
+// Tasks & Waiting
+// ============================================================================
+
+typedef struct sim_device sim_device_t;
+typedef struct tskTaskControlBlock sim_task_t;
+
+/**
+ * @brief Tasks blocked on one object, highest priority first
+ */
+typedef struct {
+    sim_task_t* head;
+} sim_wait_list_t;
+
+typedef enum {
+    SIM_TASK_READY,
+    SIM_TASK_BLOCKED,
+    SIM_TASK_DELETED
+} sim_task_state_t;
+
+struct tskTaskControlBlock {
+    ucontext_t context;
+    void* stack;
+    sim_device_t* device;
+    char name[16];
+    UBaseType_t priority;
+    BaseType_t core;
+    TaskFunction_t function;
+    void* arg;
+
+    sim_task_state_t state;
+    uint32_t generation;       ///< Bumped on every wake: stale timeouts are ignored
+    sim_wait_list_t* waiting;  ///< List the task is blocked on
+    sim_task_t* wait_next;
+    bool woken;                ///< Woken by the object (not by its timeout)
+    int critical;              ///< portENTER_CRITICAL nesting
+
+    uint32_t notify_count;
+    sim_wait_list_t notify_wait;
+
+    uint32_t spin;             ///< Clock reads since the task last blocked
+    uint64_t runs;
+    uint64_t cpu_ns;
+
+    sim_task_t* next;          ///< All tasks of the simulation
+};
+
+/**
+ * @brief Calling task (NULL in callback context)
+ */
+sim_task_t* sim_current_task(void);
+
+/**
+ * @brief Device whose code is running (task or callback)
+ */
+sim_device_t* sim_current_device(void);
+
+/**
+ * @brief Block the calling task on list until woken or deadline_us (virtual)
+ *
+ * @return true when woken through sim_wake_one()
+ */
+bool sim_block(sim_wait_list_t* list, int64_t deadline_us);
+
+/**
+ * @brief Make the first waiter ready; false if there was none
+ */
+bool sim_wake_one(sim_wait_list_t* list);
+
+/**
+ * @brief Virtual time at which a wait of ticks (device ticks) ends
+ */
+int64_t sim_ticks_deadline(TickType_t ticks);
+
+/**
+ * @brief Create a task on a device (from any context)
+ */
+sim_task_t* sim_task_create(sim_device_t* device, TaskFunction_t function, const char* name,
+                            void* arg, UBaseType_t priority, BaseType_t core);
+
+/**
+ * @brief Delete every task of a device
+ */
+void sim_device_kill_tasks(sim_device_t* device);
+
+__attribute__((noreturn, format(printf, 1, 2)))
+void sim_fatal(const char* format, ...);
+
+// ============================================================================
+// Events
+// ============================================================================
+
+typedef void (*sim_event_fn_t)(void* arg);
+
+/**
+ * @brief Run fn(arg) at at_us in callback context on device (NULL = none)
+ */
+void sim_schedule(int64_t at_us, sim_device_t* device, sim_event_fn_t fn, void* arg);
+
+// ============================================================================
+// Devices
+// ============================================================================
+
+typedef struct sim_nvs_entry {
+    char namespace_name[16];
+    char key[16];
+    int type;
+    size_t len;
+    uint8_t* data;
+    struct sim_nvs_entry* next;
+} sim_nvs_entry_t;
+
+typedef struct {
+    bool open;
+    bool writable;
+    char namespace_name[16];
+} sim_nvs_handle_t;
+
+typedef struct {
+    bool installed;
+    int baud_rate;
+    uint8_t* ring;
+    size_t ring_size;
+    size_t ring_head;
+    size_t ring_count;
+    QueueHandle_t events;
+    int64_t line_free_us;      ///< When injected bytes stop arriving
+} sim_uart_t;
+
+typedef struct {
+    bool installed;
+    QueueHandle_t events;
+    QueueHandle_t free_desc;   ///< One token per free DMA descriptor
+    int desc_count;
+    size_t desc_bytes;
+    int channels;
+    uint32_t period_us;
+    uint8_t* desc;             ///< desc_count descriptors
+    int fill_index;            ///< Descriptor being written (-1 = none)
+    size_t fill_bytes;
+    int filled[16];            ///< Descriptors written, in play order
+    int filled_count;
+    int playing;               ///< Descriptor on air (-1 = silence)
+    bool running;
+} sim_i2s_t;
+
+typedef struct {
+    bool wifi_init;
+    bool wifi_started;
+    bool espnow_init;
+    esp_now_recv_cb_t recv_cb;
+    esp_now_send_cb_t send_cb;
+    uint8_t peers[ESP_NOW_MAX_TOTAL_PEER_NUM][ESP_NOW_ETH_ALEN];
+    int num_peers;
+    QueueHandle_t wifi_events; ///< Wi-Fi task inbox (receptions, send completions)
+    TaskHandle_t wifi_task;
+    uint32_t tx_in_driver;     ///< Sent, send callback not yet run
+    int64_t rx_free_us;        ///< Receptions are handed over in order
+    int64_t tx_start_us;       ///< Latest frame's first bit on air (contention)
+} sim_radio_t;
+
+struct sim_device {
+    int index;
+    char name[16];
+    void* module;
+    void (*app_main)(void);
+    int64_t boot_us;
+    double drift;              ///< Clock rate error (ppm × 1e-6)
+    bool booted;
+    bool halted;
+    uint8_t mac[6];
+
+    sim_radio_t radio;
+    sim_nvs_entry_t* nvs;
+    sim_nvs_handle_t nvs_handles[SIM_NVS_MAX_HANDLES];
+    bool nvs_init;
+    sim_uart_t uart[SIM_UART_PORTS];
+    sim_i2s_t i2s;
+};
+
+/**
+ * @brief Simulation-wide state
+ */
+typedef struct {
+    sim_config_t config;
+    sim_device_t* devices[SIM_MAX_DEVICES];
+    int num_devices;
+    uint64_t rng;
+    char stage_dir[64];
+    sim_frame_tap_t frame_tap;
+    void* frame_tap_ctx;
+    sim_audio_tap_t audio_tap;
+    void* audio_tap_ctx;
+    sim_radio_stats_t radio_stats;
+    float link_loss[SIM_MAX_DEVICES][SIM_MAX_DEVICES];  ///< < 0: the default loss
+    int64_t channel_free_us;
+} sim_world_t;
+
+extern sim_world_t sim_world;
+
+/**
+ * @brief Device clock for a virtual time (its esp_timer_get_time())
+ */
+int64_t sim_device_local_us(const sim_device_t* device, int64_t global_us);
+
+/**
+ * @brief Virtual time at which the device clock reads local_us
+ */
+int64_t sim_device_global_us(const sim_device_t* device, int64_t local_us);
+
+/**
+ * @brief Uniform in [0, 1)
+ */
+double sim_random_unit(void);
+
+// ============================================================================
+// Subsystem Hooks
+// ============================================================================
+
+void sim_sched_init(void);
+void sim_sched_shutdown(void);
+
+void sim_radio_reset(sim_device_t* device);
+void sim_periph_reset(sim_device_t* device);
+void sim_periph_free(sim_device_t* device);
+
+#endif // SIM_INTERNAL_H
@@ -0,0 +1,622 @@
+/**
+ * @file sim_periph.c
+ * @brief NVS, UART, I2S, logging and system calls of a simulated device
+ *
+ * NVS is a per-device key list in memory. The UART delivers injected
+ * bytes at the line rate into a ring buffer and posts driver events. The
+ * I2S model paces the firmware's audio pipeline: descriptors are played
+ * one period each, freed descriptors unblock i2s_write(), and periods
+ * with nothing written become TX_Q_OVF events (what the firmware counts
+ * as underruns).
+ */
+
+#include "sim_internal.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "driver/i2s.h"
+#include "driver/uart.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define NVS_KEY_MAX 15           // NVS_KEY_NAME_MAX_SIZE - 1
+#define NVS_TYPE_U8 1
+#define NVS_TYPE_U32 4
+#define NVS_TYPE_BLOB 0x42
+
+#define UART_BITS_PER_BYTE 10    // Start, 8 data, stop
+#define I2S_MAX_DESC 16
+
+static sim_device_t* this_device(const char* call) {
+    sim_device_t* device = sim_current_device();
+    if (!device) sim_fatal("%s called outside any device", call);
+    return device;
+}
+
+// ============================================================================
+// Logging & Errors
+// ============================================================================
+
+esp_log_level_t sim_log_threshold = ESP_LOG_WARN;
+
+void sim_set_log_level(int level) {
+    sim_log_threshold = (esp_log_level_t)level;
+}
+
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...) {
+    static const char letters[] = "NEWIDV";
+    sim_device_t* device = sim_current_device();
+    va_list args;
+
+    fprintf(stderr, "[%10.6f] %-4s %c %s: ", (double)sim_now() / 1e6,
+            device ? device->name : "-", letters[level <= ESP_LOG_VERBOSE ? level : 0], tag);
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+const char* esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_NVS_NOT_INITIALIZED: return "ESP_ERR_NVS_NOT_INITIALIZED";
+        case ESP_ERR_NVS_NOT_FOUND: return "ESP_ERR_NVS_NOT_FOUND";
+        case ESP_ERR_NVS_TYPE_MISMATCH: return "ESP_ERR_NVS_TYPE_MISMATCH";
+        case ESP_ERR_NVS_READ_ONLY: return "ESP_ERR_NVS_READ_ONLY";
+        case ESP_ERR_NVS_INVALID_NAME: return "ESP_ERR_NVS_INVALID_NAME";
+        case ESP_ERR_NVS_INVALID_HANDLE: return "ESP_ERR_NVS_INVALID_HANDLE";
+        case ESP_ERR_NVS_INVALID_LENGTH: return "ESP_ERR_NVS_INVALID_LENGTH";
+        case ESP_ERR_WIFI_NOT_INIT: return "ESP_ERR_WIFI_NOT_INIT";
+        case ESP_ERR_WIFI_NOT_STARTED: return "ESP_ERR_WIFI_NOT_STARTED";
+        case ESP_ERR_ESPNOW_NOT_INIT: return "ESP_ERR_ESPNOW_NOT_INIT";
+        case ESP_ERR_ESPNOW_ARG: return "ESP_ERR_ESPNOW_ARG";
+        case ESP_ERR_ESPNOW_NO_MEM: return "ESP_ERR_ESPNOW_NO_MEM";
+        case ESP_ERR_ESPNOW_FULL: return "ESP_ERR_ESPNOW_FULL";
+        case ESP_ERR_ESPNOW_NOT_FOUND: return "ESP_ERR_ESPNOW_NOT_FOUND";
+        case ESP_ERR_ESPNOW_INTERNAL: return "ESP_ERR_ESPNOW_INTERNAL";
+        case ESP_ERR_ESPNOW_EXIST: return "ESP_ERR_ESPNOW_EXIST";
+        default: return "UNKNOWN ERROR";
+    }
+}
+
+void _esp_error_check_failed(esp_err_t rc, const char* file, int line,
+                             const char* function, const char* expression) {
+    sim_fatal("ESP_ERROR_CHECK failed: %s (0x%x) at %s:%d in %s(): %s",
+              esp_err_to_name(rc), rc, file, line, function, expression);
+}
+
+void esp_restart(void) {
+    sim_device_t* device = this_device("esp_restart");
+    ESP_LOGW("SIM", "esp_restart(): device halted");
+    device->halted = true;
+    device->radio.wifi_started = false;
+    sim_device_kill_tasks(device);
+    sim_fatal("esp_restart returned");
+}
+
+// ============================================================================
+// NVS
+// ============================================================================
+
+esp_err_t nvs_flash_init(void) {
+    this_device("nvs_flash_init")->nvs_init = true;
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void) {
+    sim_device_t* device = this_device("nvs_flash_erase");
+    sim_nvs_entry_t* entry = device->nvs;
+    while (entry) {
+        sim_nvs_entry_t* next = entry->next;
+        free(entry->data);
+        free(entry);
+        entry = next;
+    }
+    device->nvs = NULL;
+    device->nvs_init = false;
+    return ESP_OK;
+}
+
+static sim_nvs_handle_t* nvs_handle_get(sim_device_t* device, nvs_handle_t handle) {
+    if (handle == 0 || handle > SIM_NVS_MAX_HANDLES) return NULL;
+    sim_nvs_handle_t* h = &device->nvs_handles[handle - 1];
+    return h->open ? h : NULL;
+}
+
+static sim_nvs_entry_t* nvs_find(sim_device_t* device, const char* ns, const char* key) {
+    for (sim_nvs_entry_t* entry = device->nvs; entry; entry = entry->next) {
+        if (strcmp(entry->namespace_name, ns) == 0 && (!key || strcmp(entry->key, key) == 0)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+esp_err_t nvs_open(const char* namespace_name, nvs_open_mode_t open_mode, nvs_handle_t* out_handle) {
+    sim_device_t* device = this_device("nvs_open");
+    if (!device->nvs_init) return ESP_ERR_NVS_NOT_INITIALIZED;
+    if (!namespace_name || strlen(namespace_name) > NVS_KEY_MAX) return ESP_ERR_NVS_INVALID_NAME;
+
+    // Read-only opens need the namespace to exist, as on flash
+    if (open_mode == NVS_READONLY && !nvs_find(device, namespace_name, NULL)) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+
+    for (int i = 0; i < SIM_NVS_MAX_HANDLES; i++) {
+        sim_nvs_handle_t* h = &device->nvs_handles[i];
+        if (h->open) continue;
+        h->open = true;
+        h->writable = (open_mode == NVS_READWRITE);
+        snprintf(h->namespace_name, sizeof(h->namespace_name), "%s", namespace_name);
+        *out_handle = (nvs_handle_t)(i + 1);
+        return ESP_OK;
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+void nvs_close(nvs_handle_t handle) {
+    sim_nvs_handle_t* h = nvs_handle_get(this_device("nvs_close"), handle);
+    if (h) h->open = false;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+    return nvs_handle_get(this_device("nvs_commit"), handle) ? ESP_OK : ESP_ERR_NVS_INVALID_HANDLE;
+}
+
+static esp_err_t nvs_set(nvs_handle_t handle, const char* key, int type, const void* value, size_t len) {
+    sim_device_t* device = this_device("nvs_set");
+    sim_nvs_handle_t* h = nvs_handle_get(device, handle);
+    if (!h) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (!h->writable) return ESP_ERR_NVS_READ_ONLY;
+    if (!key || strlen(key) > NVS_KEY_MAX) return ESP_ERR_NVS_INVALID_NAME;
+
+    uint8_t* data = malloc(len ? len : 1);
+    if (!data) return ESP_ERR_NO_MEM;
+    memcpy(data, value, len);
+
+    sim_nvs_entry_t* entry = nvs_find(device, h->namespace_name, key);
+    if (!entry) {
+        entry = calloc(1, sizeof(sim_nvs_entry_t));
+        if (!entry) {
+            free(data);
+            return ESP_ERR_NO_MEM;
+        }
+        snprintf(entry->namespace_name, sizeof(entry->namespace_name), "%s", h->namespace_name);
+        snprintf(entry->key, sizeof(entry->key), "%s", key);
+        entry->next = device->nvs;
+        device->nvs = entry;
+    }
+    free(entry->data);
+    entry->type = type;
+    entry->data = data;
+    entry->len = len;
+    return ESP_OK;
+}
+
+static esp_err_t nvs_get(nvs_handle_t handle, const char* key, int type, sim_nvs_entry_t** out) {
+    sim_device_t* device = this_device("nvs_get");
+    sim_nvs_handle_t* h = nvs_handle_get(device, handle);
+    if (!h) return ESP_ERR_NVS_INVALID_HANDLE;
+
+    sim_nvs_entry_t* entry = nvs_find(device, h->namespace_name, key);
+    if (!entry) return ESP_ERR_NVS_NOT_FOUND;
+    if (entry->type != type) return ESP_ERR_NVS_TYPE_MISMATCH;
+    *out = entry;
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char* key) {
+    sim_device_t* device = this_device("nvs_erase_key");
+    sim_nvs_handle_t* h = nvs_handle_get(device, handle);
+    if (!h) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (!h->writable) return ESP_ERR_NVS_READ_ONLY;
+
+    for (sim_nvs_entry_t** link = &device->nvs; *link; link = &(*link)->next) {
+        sim_nvs_entry_t* entry = *link;
+        if (strcmp(entry->namespace_name, h->namespace_name) == 0 && strcmp(entry->key, key) == 0) {
+            *link = entry->next;
+            free(entry->data);
+            free(entry);
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_erase_all(nvs_handle_t handle) {
+    sim_device_t* device = this_device("nvs_erase_all");
+    sim_nvs_handle_t* h = nvs_handle_get(device, handle);
+    if (!h) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (!h->writable) return ESP_ERR_NVS_READ_ONLY;
+
+    sim_nvs_entry_t** link = &device->nvs;
+    while (*link) {
+        sim_nvs_entry_t* entry = *link;
+        if (strcmp(entry->namespace_name, h->namespace_name) == 0) {
+            *link = entry->next;
+            free(entry->data);
+            free(entry);
+        } else {
+            link = &entry->next;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char* key, uint8_t value) {
+    return nvs_set(handle, key, NVS_TYPE_U8, &value, sizeof(value));
+}
+
+esp_err_t nvs_set_u32(nvs_handle_t handle, const char* key, uint32_t value) {
+    return nvs_set(handle, key, NVS_TYPE_U32, &value, sizeof(value));
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char* key, const void* value, size_t length) {
+    return nvs_set(handle, key, NVS_TYPE_BLOB, value, length);
+}
+
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char* key, uint8_t* out_value) {
+    sim_nvs_entry_t* entry;
+    esp_err_t err = nvs_get(handle, key, NVS_TYPE_U8, &entry);
+    if (err == ESP_OK) memcpy(out_value, entry->data, sizeof(*out_value));
+    return err;
+}
+
+esp_err_t nvs_get_u32(nvs_handle_t handle, const char* key, uint32_t* out_value) {
+    sim_nvs_entry_t* entry;
+    esp_err_t err = nvs_get(handle, key, NVS_TYPE_U32, &entry);
+    if (err == ESP_OK) memcpy(out_value, entry->data, sizeof(*out_value));
+    return err;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char* key, void* out_value, size_t* length) {
+    sim_nvs_entry_t* entry;
+    esp_err_t err = nvs_get(handle, key, NVS_TYPE_BLOB, &entry);
+    if (err != ESP_OK) return err;
+
+    // NULL buffer queries the size
+    if (out_value) {
+        if (*length < entry->len) return ESP_ERR_NVS_INVALID_LENGTH;
+        memcpy(out_value, entry->data, entry->len);
+    }
+    *length = entry->len;
+    return ESP_OK;
+}
+
+// ============================================================================
+// UART
+// ============================================================================
+
+static sim_uart_t* uart_get(uart_port_t uart_num, const char* call) {
+    if (uart_num < 0 || uart_num >= SIM_UART_PORTS) return NULL;
+    return &this_device(call)->uart[uart_num];
+}
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size,
+                              int queue_size, QueueHandle_t* uart_queue, int intr_alloc_flags) {
+    (void)tx_buffer_size;
+    (void)intr_alloc_flags;
+    sim_uart_t* uart = uart_get(uart_num, "uart_driver_install");
+    if (!uart || rx_buffer_size <= 0) return ESP_ERR_INVALID_ARG;
+    if (uart->installed) return ESP_FAIL;
+
+    uart->ring = calloc(1, (size_t)rx_buffer_size);
+    if (!uart->ring) return ESP_ERR_NO_MEM;
+    uart->ring_size = (size_t)rx_buffer_size;
+    uart->ring_head = 0;
+    uart->ring_count = 0;
+    uart->baud_rate = 115200;
+
+    if (queue_size > 0 && uart_queue) {
+        uart->events = xQueueCreate((UBaseType_t)queue_size, sizeof(uart_event_t));
+        *uart_queue = uart->events;
+    }
+    uart->installed = true;
+    return ESP_OK;
+}
+
+esp_err_t uart_driver_delete(uart_port_t uart_num) {
+    sim_uart_t* uart = uart_get(uart_num, "uart_driver_delete");
+    if (!uart || !uart->installed) return ESP_ERR_INVALID_STATE;
+
+    free(uart->ring);
+    uart->ring = NULL;
+    if (uart->events) vQueueDelete(uart->events);
+    uart->events = NULL;
+    uart->installed = false;
+    return ESP_OK;
+}
+
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t* uart_config) {
+    sim_uart_t* uart = uart_get(uart_num, "uart_param_config");
+    if (!uart || !uart_config || uart_config->baud_rate <= 0) return ESP_ERR_INVALID_ARG;
+    uart->baud_rate = uart_config->baud_rate;
+    return ESP_OK;
+}
+
+esp_err_t uart_set_pin(uart_port_t uart_num, int tx_io_num, int rx_io_num,
+                       int rts_io_num, int cts_io_num) {
+    (void)tx_io_num;
+    (void)rx_io_num;
+    (void)rts_io_num;
+    (void)cts_io_num;
+    return uart_get(uart_num, "uart_set_pin") ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t uart_set_rx_full_threshold(uart_port_t uart_num, int threshold) {
+    if (threshold <= 0) return ESP_ERR_INVALID_ARG;
+    return uart_get(uart_num, "uart_set_rx_full_threshold") ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t uart_set_rx_timeout(uart_port_t uart_num, const uint8_t tout_thresh) {
+    (void)tout_thresh;
+    return uart_get(uart_num, "uart_set_rx_timeout") ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+int uart_read_bytes(uart_port_t uart_num, void* buf, uint32_t length, TickType_t ticks_to_wait) {
+    sim_uart_t* uart = uart_get(uart_num, "uart_read_bytes");
+    if (!uart || !uart->installed) return -1;
+
+    // Poll tick by tick for the first byte (the firmware reads with 0)
+    int64_t deadline_us = sim_ticks_deadline(ticks_to_wait);
+    while (uart->ring_count == 0 && sim_now() < deadline_us) {
+        vTaskDelay(1);
+    }
+
+    uint8_t* out = (uint8_t*)buf;
+    uint32_t n = 0;
+    while (n < length && uart->ring_count > 0) {
+        out[n++] = uart->ring[uart->ring_head];
+        uart->ring_head = (uart->ring_head + 1) % uart->ring_size;
+        uart->ring_count--;
+    }
+    return (int)n;
+}
+
+esp_err_t uart_get_buffered_data_len(uart_port_t uart_num, size_t* size) {
+    sim_uart_t* uart = uart_get(uart_num, "uart_get_buffered_data_len");
+    if (!uart || !uart->installed) return ESP_FAIL;
+    *size = uart->ring_count;
+    return ESP_OK;
+}
+
+esp_err_t uart_flush_input(uart_port_t uart_num) {
+    sim_uart_t* uart = uart_get(uart_num, "uart_flush_input");
+    if (!uart || !uart->installed) return ESP_FAIL;
+    uart->ring_head = 0;
+    uart->ring_count = 0;
+    return ESP_OK;
+}
+
+typedef struct {
+    sim_device_t* device;
+    int port;
+    uint8_t byte;
+} uart_byte_t;
+
+static void uart_byte_arrives(void* arg) {
+    uart_byte_t* arrival = (uart_byte_t*)arg;
+    sim_uart_t* uart = &arrival->device->uart[arrival->port];
+
+    if (uart->installed && !arrival->device->halted) {
+        uart_event_t event = {.type = UART_DATA, .size = 1, .timeout_flag = false};
+        if (uart->ring_count < uart->ring_size) {
+            uart->ring[(uart->ring_head + uart->ring_count) % uart->ring_size] = arrival->byte;
+            uart->ring_count++;
+        } else {
+            event.type = UART_BUFFER_FULL;
+        }
+        // RX threshold of one byte: an interrupt, hence an event, per byte
+        if (uart->events) xQueueSendFromISR(uart->events, &event, NULL);
+    }
+    free(arrival);
+}
+
+int64_t sim_uart_inject(int device, int port, const uint8_t* data, size_t len) {
+    if (device < 0 || device >= sim_world.num_devices || port < 0 || port >= SIM_UART_PORTS) return -1;
+    sim_device_t* target = sim_world.devices[device];
+    sim_uart_t* uart = &target->uart[port];
+
+    int baud = (uart->baud_rate > 0) ? uart->baud_rate : 115200;
+    int64_t byte_us = ((int64_t)UART_BITS_PER_BYTE * 1000000 + baud - 1) / baud;
+    int64_t at_us = (uart->line_free_us > sim_now()) ? uart->line_free_us : sim_now();
+
+    for (size_t i = 0; i < len; i++) {
+        uart_byte_t* arrival = malloc(sizeof(uart_byte_t));
+        if (!arrival) sim_fatal("out of memory (UART)");
+        arrival->device = target;
+        arrival->port = port;
+        arrival->byte = data[i];
+
+        at_us += byte_us;  // Received once its stop bit is in
+        sim_schedule(at_us, target, uart_byte_arrives, arrival);
+    }
+    uart->line_free_us = at_us;
+    return at_us;
+}
+
+// ============================================================================
+// I2S
+// ============================================================================
+
+static void i2s_period(void* arg);
+
+esp_err_t i2s_driver_install(i2s_port_t i2s_num, const i2s_config_t* i2s_config,
+                             int queue_num, void* i2s_queue) {
+    sim_device_t* device = this_device("i2s_driver_install");
+    sim_i2s_t* i2s = &device->i2s;
+
+    if (i2s_num != I2S_NUM_0 || !i2s_config) return ESP_ERR_INVALID_ARG;
+    if (i2s->installed) return ESP_ERR_INVALID_STATE;
+    if (i2s_config->dma_buf_count < 2 || i2s_config->dma_buf_count > I2S_MAX_DESC ||
+        i2s_config->dma_buf_len <= 0 || i2s_config->sample_rate <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int channels = (i2s_config->channel_format == I2S_CHANNEL_FMT_MULTIPLE)
+                       ? (int)i2s_config->bits_cfg.slot_mode : 2;
+    if (channels <= 0) channels = 2;
+    size_t sample_bytes = (size_t)i2s_config->bits_per_sample / 8;
+
+    i2s->desc_count = i2s_config->dma_buf_count;
+    i2s->desc_bytes = (size_t)i2s_config->dma_buf_len * sample_bytes;
+    i2s->channels = channels;
+    size_t frames = i2s->desc_bytes / (sample_bytes * (size_t)channels);
+    i2s->period_us = (uint32_t)((uint64_t)frames * 1000000 / (uint64_t)i2s_config->sample_rate);
+
+    i2s->desc = calloc((size_t)i2s->desc_count, i2s->desc_bytes);
+    i2s->free_desc = xQueueCreate((UBaseType_t)i2s->desc_count, sizeof(uint8_t));
+    if (!i2s->desc || !i2s->free_desc) return ESP_ERR_NO_MEM;
+    for (uint8_t i = 0; i < i2s->desc_count; i++) {
+        xQueueSendFromISR(i2s->free_desc, &i, NULL);
+    }
+
+    if (queue_num > 0 && i2s_queue) {
+        i2s->events = xQueueCreate((UBaseType_t)queue_num, sizeof(i2s_event_t));
+        *(QueueHandle_t*)i2s_queue = i2s->events;
+    }
+    i2s->fill_index = -1;
+    i2s->playing = -1;
+    i2s->installed = true;
+    return ESP_OK;
+}
+
+esp_err_t i2s_driver_uninstall(i2s_port_t i2s_num) {
+    (void)i2s_num;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t i2s_set_pin(i2s_port_t i2s_num, const i2s_pin_config_t* pin) {
+    (void)pin;
+    return (i2s_num == I2S_NUM_0) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t i2s_zero_dma_buffer(i2s_port_t i2s_num) {
+    sim_i2s_t* i2s = &this_device("i2s_zero_dma_buffer")->i2s;
+    if (i2s_num != I2S_NUM_0 || !i2s->installed) return ESP_ERR_INVALID_STATE;
+    memset(i2s->desc, 0, (size_t)i2s->desc_count * i2s->desc_bytes);
+    return ESP_OK;
+}
+
+/**
+ * @brief Period boundary: free the descriptor just played, start the next
+ */
+static void i2s_period(void* arg) {
+    sim_device_t* device = (sim_device_t*)arg;
+    sim_i2s_t* i2s = &device->i2s;
+    if (device->halted) return;
+
+    if (i2s->playing >= 0) {
+        uint8_t token = (uint8_t)i2s->playing;
+        xQueueSendFromISR(i2s->free_desc, &token, NULL);
+        i2s->playing = -1;
+    }
+
+    size_t frames = i2s->desc_bytes / (sizeof(int16_t) * (size_t)i2s->channels);
+    if (i2s->filled_count > 0) {
+        i2s->playing = i2s->filled[0];
+        memmove(i2s->filled, i2s->filled + 1, (size_t)(--i2s->filled_count) * sizeof(int));
+        if (sim_world.audio_tap) {
+            const int16_t* samples = (const int16_t*)(i2s->desc + (size_t)i2s->playing * i2s->desc_bytes);
+            sim_world.audio_tap(sim_world.audio_tap_ctx, device->index, sim_now(),
+                                samples, frames, i2s->channels);
+        }
+    } else {
+        i2s_event_t event = {.type = I2S_EVENT_TX_Q_OVF, .size = i2s->desc_bytes};
+        if (i2s->events) xQueueSendFromISR(i2s->events, &event, NULL);
+        if (sim_world.audio_tap) {
+            sim_world.audio_tap(sim_world.audio_tap_ctx, device->index, sim_now(),
+                                NULL, frames, i2s->channels);
+        }
+    }
+
+    // The sample clock comes from the device's crystal
+    int64_t local_us = sim_device_local_us(device, sim_now());
+    sim_schedule(sim_device_global_us(device, local_us + i2s->period_us), device, i2s_period, device);
+}
+
+esp_err_t i2s_write(i2s_port_t i2s_num, const void* src, size_t size,
+                    size_t* bytes_written, TickType_t ticks_to_wait) {
+    sim_device_t* device = this_device("i2s_write");
+    sim_i2s_t* i2s = &device->i2s;
+    const uint8_t* data = (const uint8_t*)src;
+    *bytes_written = 0;
+
+    if (i2s_num != I2S_NUM_0 || !i2s->installed) return ESP_ERR_INVALID_STATE;
+
+    while (*bytes_written < size) {
+        if (i2s->fill_index < 0) {
+            uint8_t token;
+            if (xQueueReceive(i2s->free_desc, &token, ticks_to_wait) != pdTRUE) break;
+            i2s->fill_index = token;
+            i2s->fill_bytes = 0;
+        }
+
+        size_t room = i2s->desc_bytes - i2s->fill_bytes;
+        size_t n = (size - *bytes_written < room) ? size - *bytes_written : room;
+        memcpy(i2s->desc + (size_t)i2s->fill_index * i2s->desc_bytes + i2s->fill_bytes,
+               data + *bytes_written, n);
+        i2s->fill_bytes += n;
+        *bytes_written += n;
+
+        if (i2s->fill_bytes == i2s->desc_bytes) {
+            i2s->filled[i2s->filled_count++] = i2s->fill_index;
+            i2s->fill_index = -1;
+
+            // DMA starts with the first full descriptor
+            if (!i2s->running) {
+                i2s->running = true;
+                sim_schedule(sim_now(), device, i2s_period, device);
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+// ============================================================================
+// Simulator API
+// ============================================================================
+
+void sim_set_audio_tap(sim_audio_tap_t tap, void* ctx) {
+    sim_world.audio_tap = tap;
+    sim_world.audio_tap_ctx = ctx;
+}
+
+void sim_periph_reset(sim_device_t* device) {
+    device->nvs = NULL;
+    memset(device->nvs_handles, 0, sizeof(device->nvs_handles));
+    device->nvs_init = false;
+    memset(device->uart, 0, sizeof(device->uart));
+    memset(&device->i2s, 0, sizeof(device->i2s));
+}
+
+void sim_periph_free(sim_device_t* device) {
+    sim_nvs_entry_t* entry = device->nvs;
+    while (entry) {
+        sim_nvs_entry_t* next = entry->next;
+        free(entry->data);
+        free(entry);
+        entry = next;
+    }
+    device->nvs = NULL;
+    for (int i = 0; i < SIM_UART_PORTS; i++) free(device->uart[i].ring);
+    free(device->i2s.desc);
+}
@@ -0,0 +1,470 @@
+/**
+ * @file sim_radio.c
+ * @brief Wi-Fi/ESP-NOW driver and the shared radio channel
+ *
+ * One channel for every device, used one frame at a time: a frame waits
+ * for the channel to be free, then DIFS plus a random backoff, and holds
+ * it for its airtime (PHY preamble plus the 802.11 action frame around
+ * the payload). Stations waiting for the same idle channel count their
+ * backoffs down together, so with n of them the winner's share of the
+ * slots is about 1/n. Broadcasts reach each other device independently with
+ * the link's loss probability. Unicasts are retried by the MAC until
+ * acknowledged or out of retries, and only then complete.
+ *
+ * Receptions and send completions are handed to the device's Wi-Fi task
+ * (priority 23, like the IDF's), which runs the registered callbacks, so
+ * firmware callbacks see the same context as on hardware.
+ *
+ * Not modeled: collisions (contention is serialized), capture, RSSI.
+ */
+
+#include "sim_internal.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_now.h"
+#include "esp_wifi.h"
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define ESPNOW_FRAME_OVERHEAD 43   // MAC header, action/vendor element, FCS (bytes)
+#define ACK_FRAME_BYTES 14
+
+// 802.11b (DSSS, long preamble) below 6 Mbps, 802.11g OFDM above
+#define DSSS_PREAMBLE_US 192
+#define DSSS_SLOT_US 20
+#define DSSS_SIFS_US 10
+#define DSSS_CW_MIN 31
+#define OFDM_PREAMBLE_US 20
+#define OFDM_SLOT_US 9
+#define OFDM_SIFS_US 16
+#define OFDM_CW_MIN 15
+#define CW_MAX 1023
+
+#define WIFI_EVENT_RX 0
+#define WIFI_EVENT_TX_DONE 1
+
+static const uint8_t BROADCAST_ADDR[ESP_NOW_ETH_ALEN] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+// ============================================================================
+// Types
+// ============================================================================
+
+typedef struct {
+    uint8_t kind;
+    uint8_t status;
+    uint8_t len;
+    uint8_t src[ESP_NOW_ETH_ALEN];
+    uint8_t dst[ESP_NOW_ETH_ALEN];
+    uint8_t data[ESP_NOW_MAX_DATA_LEN];
+} wifi_event_t;
+
+typedef struct {
+    sim_device_t* device;
+    wifi_event_t event;
+} delivery_t;
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static sim_device_t* this_device(void) {
+    sim_device_t* device = sim_current_device();
+    if (!device) sim_fatal("Wi-Fi call outside any device");
+    return device;
+}
+
+static bool mac_equal(const uint8_t* a, const uint8_t* b) {
+    return memcmp(a, b, ESP_NOW_ETH_ALEN) == 0;
+}
+
+static bool listening(const sim_device_t* device) {
+    return device->booted && !device->halted && device->radio.wifi_started &&
+           device->radio.espnow_init;
+}
+
+static bool dsss(void) {
+    return sim_world.config.phy_rate_mbps < 6.0;
+}
+
+static uint32_t airtime_us(size_t bytes) {
+    double bits = (double)bytes * 8.0;
+    uint32_t preamble = dsss() ? DSSS_PREAMBLE_US : OFDM_PREAMBLE_US;
+    return preamble + (uint32_t)ceil(bits / sim_world.config.phy_rate_mbps);
+}
+
+static uint32_t backoff_us(uint32_t cw, uint32_t contenders) {
+    uint32_t slot = dsss() ? DSSS_SLOT_US : OFDM_SLOT_US;
+    uint32_t sifs = dsss() ? DSSS_SIFS_US : OFDM_SIFS_US;
+    uint32_t difs = sifs + 2 * slot;
+    return difs + slot * ((sim_random() % (cw + 1)) / contenders);
+}
+
+/**
+ * @brief Stations (sender included) with a frame not yet on air at t_us
+ */
+static uint32_t contenders_at(const sim_device_t* sender, int64_t t_us) {
+    uint32_t n = 1;
+    for (int i = 0; i < sim_world.num_devices; i++) {
+        const sim_device_t* device = sim_world.devices[i];
+        if (device != sender && device->radio.tx_start_us > t_us) n++;
+    }
+    return n;
+}
+
+static bool link_lost(int from, int to) {
+    float loss = sim_world.link_loss[from][to];
+    double p = (loss >= 0.0f) ? loss : sim_world.config.loss;
+    return p > 0.0 && sim_random_unit() < p;
+}
+
+// ============================================================================
+// Wi-Fi Task
+// ============================================================================
+
+static void wifi_task(void* arg) {
+    sim_device_t* device = (sim_device_t*)arg;
+    sim_radio_t* radio = &device->radio;
+    static wifi_pkt_rx_ctrl_t rx_ctrl = {.rssi = -50, .rate = 0, .channel = 1};
+    wifi_event_t event;
+
+    for (;;) {
+        xQueueReceive(radio->wifi_events, &event, portMAX_DELAY);
+
+        if (event.kind == WIFI_EVENT_TX_DONE) {
+            radio->tx_in_driver--;
+            if (radio->send_cb) {
+                radio->send_cb(event.dst, (esp_now_send_status_t)event.status);
+            }
+            continue;
+        }
+
+        if (radio->espnow_init && radio->recv_cb) {
+            esp_now_recv_info_t info = {
+                .src_addr = event.src,
+                .des_addr = event.dst,
+                .rx_ctrl = &rx_ctrl,
+            };
+            radio->recv_cb(&info, event.data, event.len);
+        }
+    }
+}
+
+static void deliver(void* arg) {
+    delivery_t* delivery = (delivery_t*)arg;
+    sim_device_t* device = delivery->device;
+    sim_radio_stats_t* stats = &sim_world.radio_stats;
+
+    if (delivery->event.kind == WIFI_EVENT_TX_DONE) {
+        if (device->radio.wifi_events) {
+            xQueueSendFromISR(device->radio.wifi_events, &delivery->event, NULL);
+        }
+    } else if (!listening(device)) {
+        stats->rx_not_listening++;
+    } else if (uxQueueMessagesWaiting(device->radio.wifi_events) >= SIM_WIFI_RX_QUEUE) {
+        stats->rx_overflow++;  // RX buffers exhausted (completions have their own room)
+    } else {
+        xQueueSendFromISR(device->radio.wifi_events, &delivery->event, NULL);
+        stats->delivered++;
+    }
+    free(delivery);
+}
+
+static void schedule_rx(const sim_device_t* from, sim_device_t* to, const uint8_t* dst,
+                        const uint8_t* data, size_t len, int64_t end_us) {
+    delivery_t* delivery = malloc(sizeof(delivery_t));
+    if (!delivery) sim_fatal("out of memory (frame)");
+
+    delivery->device = to;
+    delivery->event.kind = WIFI_EVENT_RX;
+    delivery->event.status = 0;
+    delivery->event.len = (uint8_t)len;
+    memcpy(delivery->event.src, from->mac, ESP_NOW_ETH_ALEN);
+    memcpy(delivery->event.dst, dst, ESP_NOW_ETH_ALEN);
+    memcpy(delivery->event.data, data, len);
+
+    // Driver latency; a device hands receptions over in order
+    int64_t at_us = end_us + sim_world.config.latency_us;
+    if (sim_world.config.jitter_us > 0) at_us += sim_random() % sim_world.config.jitter_us;
+    if (at_us < to->radio.rx_free_us) at_us = to->radio.rx_free_us;
+    to->radio.rx_free_us = at_us;
+
+    sim_schedule(at_us, to, deliver, delivery);
+}
+
+static void schedule_tx_done(sim_device_t* device, const uint8_t* dst,
+                             esp_now_send_status_t status, int64_t at_us) {
+    delivery_t* delivery = malloc(sizeof(delivery_t));
+    if (!delivery) sim_fatal("out of memory (frame)");
+
+    delivery->device = device;
+    delivery->event.kind = WIFI_EVENT_TX_DONE;
+    delivery->event.status = (uint8_t)status;
+    delivery->event.len = 0;
+    memcpy(delivery->event.dst, dst, ESP_NOW_ETH_ALEN);
+    sim_schedule(at_us, device, deliver, delivery);
+}
+
+// ============================================================================
+// Channel
+// ============================================================================
+
+static void transmit(sim_device_t* sender, const uint8_t* dst, const uint8_t* data, size_t len) {
+    sim_radio_stats_t* stats = &sim_world.radio_stats;
+    int64_t now_us = sim_now();
+    bool broadcast = mac_equal(dst, BROADCAST_ADDR);
+    uint32_t frame_us = airtime_us(len + ESPNOW_FRAME_OVERHEAD);
+    uint32_t cw = dsss() ? DSSS_CW_MIN : OFDM_CW_MIN;
+
+    int64_t channel_us = (sim_world.channel_free_us > now_us) ? sim_world.channel_free_us : now_us;
+    int64_t start_us = channel_us + backoff_us(cw, contenders_at(sender, now_us));
+    if (start_us - now_us > stats->max_wait_us) stats->max_wait_us = start_us - now_us;
+
+    sim_frame_t frame = {
+        .device = sender->index,
+        .dest_mac = dst,
+        .data = data,
+        .len = len,
+        .broadcast = broadcast,
+        .queued_us = now_us,
+        .start_us = start_us,
+    };
+
+    int64_t end_us = start_us + frame_us;
+    esp_now_send_status_t status = ESP_NOW_SEND_SUCCESS;
+
+    if (broadcast) {
+        frame.attempts = 1;
+        frame.airtime_us = frame_us;
+        for (int i = 0; i < sim_world.num_devices; i++) {
+            sim_device_t* device = sim_world.devices[i];
+            if (device == sender) continue;
+            if (link_lost(sender->index, i)) {
+                stats->lost++;
+                continue;
+            }
+            schedule_rx(sender, device, dst, data, len, end_us);
+            frame.receivers++;
+        }
+    } else {
+        int target = sim_device_by_mac(dst);
+        uint32_t sifs = dsss() ? DSSS_SIFS_US : OFDM_SIFS_US;
+        uint32_t ack_us = sifs + airtime_us(ACK_FRAME_BYTES);
+        status = ESP_NOW_SEND_FAIL;
+
+        for (;;) {
+            frame.attempts++;
+            frame.airtime_us += frame_us;
+            end_us = start_us + frame_us;
+
+            bool received = target >= 0 && listening(sim_world.devices[target]);
+            if (received && link_lost(sender->index, target)) {
+                stats->lost++;
+                received = false;
+            }
+            if (received) {
+                end_us += ack_us;
+                frame.airtime_us += ack_us;
+                frame.acked = true;
+                frame.receivers = 1;
+                status = ESP_NOW_SEND_SUCCESS;
+                schedule_rx(sender, sim_world.devices[target], dst, data, len, end_us);
+                break;
+            }
+            if (frame.attempts > sim_world.config.mac_retries) {
+                stats->unicast_failed++;
+                break;
+            }
+
+            // No ACK: wait it out, then contend again with a doubled window
+            stats->retries++;
+            cw = (cw * 2 + 1 > CW_MAX) ? CW_MAX : cw * 2 + 1;
+            start_us = end_us + ack_us + backoff_us(cw, 1);
+        }
+    }
+
+    frame.end_us = end_us;
+    sim_world.channel_free_us = end_us;
+    sender->radio.tx_start_us = frame.start_us;
+
+    stats->frames++;
+    if (broadcast) stats->broadcasts++;
+    stats->bytes += len;
+    stats->airtime_us += frame.airtime_us;
+
+    if (sim_world.frame_tap) sim_world.frame_tap(sim_world.frame_tap_ctx, &frame);
+
+    schedule_tx_done(sender, dst, status, end_us);
+}
+
+// ============================================================================
+// Wi-Fi API
+// ============================================================================
+
+esp_err_t esp_wifi_init(const wifi_init_config_t* config) {
+    sim_device_t* device = this_device();
+    sim_radio_t* radio = &device->radio;
+    if (!config || config->magic != WIFI_INIT_CONFIG_MAGIC) return ESP_ERR_INVALID_ARG;
+    if (radio->wifi_init) return ESP_OK;
+
+    if (!radio->wifi_events) {
+        radio->wifi_events = xQueueCreate(SIM_WIFI_RX_QUEUE + SIM_WIFI_TX_QUEUE, sizeof(wifi_event_t));
+        radio->wifi_task = sim_task_create(device, wifi_task, "wifi", device,
+                                           SIM_WIFI_TASK_PRIORITY, 0);
+    }
+    radio->wifi_init = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_deinit(void) {
+    sim_radio_t* radio = &this_device()->radio;
+    if (radio->wifi_started) return ESP_ERR_INVALID_STATE;
+    radio->wifi_init = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode) {
+    (void)mode;
+    return this_device()->radio.wifi_init ? ESP_OK : ESP_ERR_WIFI_NOT_INIT;
+}
+
+esp_err_t esp_wifi_start(void) {
+    sim_radio_t* radio = &this_device()->radio;
+    if (!radio->wifi_init) return ESP_ERR_WIFI_NOT_INIT;
+    radio->wifi_started = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_stop(void) {
+    sim_radio_t* radio = &this_device()->radio;
+    if (!radio->wifi_init) return ESP_ERR_WIFI_NOT_INIT;
+    radio->wifi_started = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_mac(wifi_interface_t ifx, uint8_t mac[6]) {
+    sim_device_t* device = this_device();
+    memcpy(mac, device->mac, ESP_NOW_ETH_ALEN);
+    if (ifx == WIFI_IF_AP) mac[5]++;  // As the IDF derives the soft-AP address
+    return ESP_OK;
+}
+
+// ============================================================================
+// ESP-NOW API
+// ============================================================================
+
+esp_err_t esp_now_init(void) {
+    sim_radio_t* radio = &this_device()->radio;
+    if (!radio->wifi_started) return ESP_ERR_WIFI_NOT_STARTED;
+    radio->espnow_init = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_now_deinit(void) {
+    sim_radio_t* radio = &this_device()->radio;
+    radio->espnow_init = false;
+    radio->recv_cb = NULL;
+    radio->send_cb = NULL;
+    radio->num_peers = 0;
+    return ESP_OK;
+}
+
+esp_err_t esp_now_register_recv_cb(esp_now_recv_cb_t cb) {
+    sim_radio_t* radio = &this_device()->radio;
+    if (!radio->espnow_init) return ESP_ERR_ESPNOW_NOT_INIT;
+    radio->recv_cb = cb;
+    return ESP_OK;
+}
+
+esp_err_t esp_now_register_send_cb(esp_now_send_cb_t cb) {
+    sim_radio_t* radio = &this_device()->radio;
+    if (!radio->espnow_init) return ESP_ERR_ESPNOW_NOT_INIT;
+    radio->send_cb = cb;
+    return ESP_OK;
+}
+
+static int find_peer(const sim_radio_t* radio, const uint8_t* mac) {
+    for (int i = 0; i < radio->num_peers; i++) {
+        if (mac_equal(radio->peers[i], mac)) return i;
+    }
+    return -1;
+}
+
+esp_err_t esp_now_add_peer(const esp_now_peer_info_t* peer) {
+    sim_radio_t* radio = &this_device()->radio;
+    if (!radio->espnow_init) return ESP_ERR_ESPNOW_NOT_INIT;
+    if (!peer) return ESP_ERR_ESPNOW_ARG;
+    if (find_peer(radio, peer->peer_addr) >= 0) return ESP_ERR_ESPNOW_EXIST;
+    if (radio->num_peers >= ESP_NOW_MAX_TOTAL_PEER_NUM) return ESP_ERR_ESPNOW_FULL;
+
+    memcpy(radio->peers[radio->num_peers++], peer->peer_addr, ESP_NOW_ETH_ALEN);
+    return ESP_OK;
+}
+
+esp_err_t esp_now_del_peer(const uint8_t* peer_addr) {
+    sim_radio_t* radio = &this_device()->radio;
+    if (!radio->espnow_init) return ESP_ERR_ESPNOW_NOT_INIT;
+
+    int i = find_peer(radio, peer_addr);
+    if (i < 0) return ESP_ERR_ESPNOW_NOT_FOUND;
+    memmove(radio->peers[i], radio->peers[i + 1],
+            (size_t)(radio->num_peers - i - 1) * ESP_NOW_ETH_ALEN);
+    radio->num_peers--;
+    return ESP_OK;
+}
+
+esp_err_t esp_now_get_peer(const uint8_t* peer_addr, esp_now_peer_info_t* peer) {
+    sim_radio_t* radio = &this_device()->radio;
+    if (!radio->espnow_init) return ESP_ERR_ESPNOW_NOT_INIT;
+    if (find_peer(radio, peer_addr) < 0) return ESP_ERR_ESPNOW_NOT_FOUND;
+
+    memset(peer, 0, sizeof(*peer));
+    memcpy(peer->peer_addr, peer_addr, ESP_NOW_ETH_ALEN);
+    peer->ifidx = WIFI_IF_STA;
+    return ESP_OK;
+}
+
+bool esp_now_is_peer_exist(const uint8_t* peer_addr) {
+    return find_peer(&this_device()->radio, peer_addr) >= 0;
+}
+
+esp_err_t esp_now_send(const uint8_t* peer_addr, const uint8_t* data, size_t len) {
+    sim_device_t* device = this_device();
+    sim_radio_t* radio = &device->radio;
+
+    if (!radio->espnow_init) return ESP_ERR_ESPNOW_NOT_INIT;
+    if (!peer_addr || !data || len == 0 || len > ESP_NOW_MAX_DATA_LEN) return ESP_ERR_ESPNOW_ARG;
+    if (find_peer(radio, peer_addr) < 0) return ESP_ERR_ESPNOW_NOT_FOUND;
+    if (!radio->wifi_started) return ESP_ERR_WIFI_NOT_STARTED;
+    if (radio->tx_in_driver >= SIM_WIFI_TX_QUEUE) return ESP_ERR_ESPNOW_NO_MEM;
+
+    radio->tx_in_driver++;
+    transmit(device, peer_addr, data, len);
+    return ESP_OK;
+}
+
+// ============================================================================
+// Simulator API
+// ============================================================================
+
+void sim_radio_reset(sim_device_t* device) {
+    memset(&device->radio, 0, sizeof(device->radio));
+}
+
+void sim_set_link_loss(int from, int to, double loss) {
+    if (from < 0 || to < 0 || from >= SIM_MAX_DEVICES || to >= SIM_MAX_DEVICES) return;
+    sim_world.link_loss[from][to] = (float)loss;
+}
+
+void sim_set_frame_tap(sim_frame_tap_t tap, void* ctx) {
+    sim_world.frame_tap = tap;
+    sim_world.frame_tap_ctx = ctx;
+}
+
+const sim_radio_stats_t* sim_radio_stats(void) {
+    return &sim_world.radio_stats;
+}
@@ -0,0 +1,794 @@
+/**
+ * @file sim_sched.c
+ * @brief Virtual-time scheduler: FreeRTOS tasks, queues and notifications
+ *
+ * Every task is a ucontext coroutine with its own host stack. One event
+ * heap orders everything by (time, priority, insertion): task wake-ups,
+ * block timeouts and callbacks (radio, DMA, UART). A task runs until it
+ * blocks; virtual time only moves between events, so a run is fully
+ * determined by its inputs.
+ *
+ * FreeRTOS semantics kept: waiters are served highest priority first,
+ * waking a higher-priority task of the same device switches to it at
+ * once (deferred to the end of a critical section), delays end on tick
+ * boundaries of the device's own drifting clock.
+ */
+
+#include "sim_internal.h"
+
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+
+// ============================================================================
+// Scheduler State
+// ============================================================================
+
+typedef struct {
+    int64_t at_us;
+    int32_t priority;
+    uint64_t seq;
+    sim_task_t* task;          ///< Task to resume (NULL: callback)
+    uint32_t generation;       ///< task->generation when queued
+    sim_device_t* device;      ///< Callback context
+    sim_event_fn_t fn;
+    void* arg;
+} sim_event_t;
+
+static struct {
+    int64_t now_us;
+    sim_event_t* heap;
+    size_t count;
+    size_t capacity;
+    uint64_t seq;
+
+    sim_task_t* current;
+    sim_device_t* device;
+    ucontext_t scheduler;
+    bool yield_pending;
+
+    sim_task_t* tasks;         ///< Creation order
+    sim_task_t* tasks_tail;
+    sim_task_t* zombie;        ///< Deleted itself: stack freed once switched away
+} s;
+
+static size_t s_page_size;
+static void* s_signal_stack;
+
+struct QueueDefinition {
+    uint8_t* storage;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t count;
+    UBaseType_t head;
+    sim_wait_list_t senders;
+    sim_wait_list_t receivers;
+};
+
+// ============================================================================
+// Event Heap
+// ============================================================================
+
+static bool event_before(const sim_event_t* a, const sim_event_t* b) {
+    if (a->at_us != b->at_us) return a->at_us < b->at_us;
+    if (a->priority != b->priority) return a->priority > b->priority;
+    return a->seq < b->seq;
+}
+
+static void heap_push(sim_event_t event) {
+    if (s.count == s.capacity) {
+        s.capacity = s.capacity ? s.capacity * 2 : 1024;
+        s.heap = realloc(s.heap, s.capacity * sizeof(sim_event_t));
+        if (!s.heap) sim_fatal("out of memory (event heap)");
+    }
+
+    event.seq = s.seq++;
+    size_t i = s.count++;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!event_before(&event, &s.heap[parent])) break;
+        s.heap[i] = s.heap[parent];
+        i = parent;
+    }
+    s.heap[i] = event;
+}
+
+static sim_event_t heap_pop(void) {
+    sim_event_t top = s.heap[0];
+    sim_event_t last = s.heap[--s.count];
+
+    size_t i = 0;
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= s.count) break;
+        if (child + 1 < s.count && event_before(&s.heap[child + 1], &s.heap[child])) child++;
+        if (!event_before(&s.heap[child], &last)) break;
+        s.heap[i] = s.heap[child];
+        i = child;
+    }
+    if (s.count > 0) s.heap[i] = last;
+    return top;
+}
+
+void sim_schedule(int64_t at_us, sim_device_t* device, sim_event_fn_t fn, void* arg) {
+    sim_event_t event = {
+        .at_us = (at_us > s.now_us) ? at_us : s.now_us,
+        .priority = SIM_ISR_PRIORITY,
+        .device = device,
+        .fn = fn,
+        .arg = arg,
+    };
+    heap_push(event);
+}
+
+static void schedule_task(sim_task_t* task, int64_t at_us) {
+    sim_event_t event = {
+        .at_us = at_us,
+        .priority = (int32_t)task->priority,
+        .task = task,
+        .generation = task->generation,
+    };
+    heap_push(event);
+}
+
+// ============================================================================
+// Diagnostics
+// ============================================================================
+
+void sim_fatal(const char* format, ...) {
+    va_list args;
+    fprintf(stderr, "[%10.6f] ", (double)s.now_us / 1e6);
+    if (s.device) fprintf(stderr, "%s", s.device->name);
+    if (s.current) fprintf(stderr, "/%s", s.current->name);
+    fprintf(stderr, " FATAL: ");
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+    exit(EXIT_FAILURE);
+}
+
+static void on_segv(int sig, siginfo_t* info, void* context) {
+    (void)context;
+    char message[160];
+    int len = snprintf(message, sizeof(message), "[%10.6f] %s/%s: signal %d at %p%s\n",
+                       (double)s.now_us / 1e6, s.device ? s.device->name : "-",
+                       s.current ? s.current->name : "-", sig, info->si_addr,
+                       s.current ? " (task stack overflow?)" : "");
+    if (len > 0) {
+        ssize_t written = write(STDERR_FILENO, message, (size_t)len);
+        (void)written;
+    }
+    _exit(128 + sig);
+}
+
+static uint64_t host_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// ============================================================================
+// Context Switching
+// ============================================================================
+
+static void free_stack(sim_task_t* task) {
+    if (task->stack) {
+        munmap(task->stack, SIM_TASK_STACK_SIZE + s_page_size);
+        task->stack = NULL;
+    }
+}
+
+static void resume(sim_task_t* task) {
+    s.current = task;
+    s.device = task->device;
+    task->state = SIM_TASK_READY;
+    task->runs++;
+
+    uint64_t start_ns = host_ns();
+    swapcontext(&s.scheduler, &task->context);
+    task->cpu_ns += host_ns() - start_ns;
+
+    s.current = NULL;
+    s.device = NULL;
+    s.yield_pending = false;
+
+    if (s.zombie) {
+        free_stack(s.zombie);
+        s.zombie = NULL;
+    }
+}
+
+static void switch_out(void) {
+    sim_task_t* task = s.current;
+    task->spin = 0;
+    swapcontext(&task->context, &s.scheduler);
+}
+
+static void make_ready(sim_task_t* task) {
+    task->generation++;
+    task->waiting = NULL;
+    task->state = SIM_TASK_READY;
+    schedule_task(task, s.now_us);
+
+    if (s.current && task->device == s.current->device && task->priority > s.current->priority) {
+        s.yield_pending = true;
+    }
+}
+
+/**
+ * @brief Switch to a higher-priority task of this device made ready
+ */
+static void preempt_check(void) {
+    sim_task_t* task = s.current;
+    if (!task || !s.yield_pending || task->critical > 0) return;
+
+    s.yield_pending = false;
+    make_ready(task);
+    switch_out();
+}
+
+static void task_entry(void) {
+    sim_task_t* task = s.current;
+    task->function(task->arg);
+    sim_fatal("task returned from its function (missing vTaskDelete)");
+}
+
+// ============================================================================
+// Waiting
+// ============================================================================
+
+static void list_insert(sim_wait_list_t* list, sim_task_t* task) {
+    sim_task_t** link = &list->head;
+    while (*link && (*link)->priority >= task->priority) {
+        link = &(*link)->wait_next;
+    }
+    task->wait_next = *link;
+    *link = task;
+}
+
+static void list_remove(sim_wait_list_t* list, sim_task_t* task) {
+    for (sim_task_t** link = &list->head; *link; link = &(*link)->wait_next) {
+        if (*link == task) {
+            *link = task->wait_next;
+            task->wait_next = NULL;
+            return;
+        }
+    }
+}
+
+bool sim_block(sim_wait_list_t* list, int64_t deadline_us) {
+    sim_task_t* task = s.current;
+    if (!task) sim_fatal("blocking call from callback context");
+    if (task->critical > 0) sim_fatal("blocking call inside a critical section");
+    if (deadline_us <= s.now_us) return false;
+
+    task->state = SIM_TASK_BLOCKED;
+    task->woken = false;
+    task->waiting = list;
+    if (list) list_insert(list, task);
+    if (deadline_us != SIM_FOREVER) schedule_task(task, deadline_us);
+
+    switch_out();
+    return task->woken;
+}
+
+bool sim_wake_one(sim_wait_list_t* list) {
+    sim_task_t* task = list->head;
+    if (!task) return false;
+
+    list->head = task->wait_next;
+    task->wait_next = NULL;
+    task->woken = true;
+    make_ready(task);
+    return true;
+}
+
+// ============================================================================
+// Time
+// ============================================================================
+
+int64_t sim_now(void) {
+    return s.now_us;
+}
+
+int64_t sim_device_local_us(const sim_device_t* device, int64_t global_us) {
+    int64_t elapsed = global_us - device->boot_us;
+    if (elapsed <= 0) return 0;
+    return elapsed + (int64_t)((double)elapsed * device->drift);
+}
+
+int64_t sim_device_global_us(const sim_device_t* device, int64_t local_us) {
+    int64_t global_us = device->boot_us + (int64_t)((double)local_us / (1.0 + device->drift));
+    while (sim_device_local_us(device, global_us) < local_us) global_us++;
+    return global_us;
+}
+
+sim_task_t* sim_current_task(void) {
+    return s.current;
+}
+
+sim_device_t* sim_current_device(void) {
+    return s.device;
+}
+
+static sim_device_t* require_device(const char* call) {
+    if (!s.device) sim_fatal("%s called outside any device", call);
+    return s.device;
+}
+
+static int64_t device_now_us(void) {
+    sim_task_t* task = s.current;
+    if (task && ++task->spin > SIM_SPIN_LIMIT) {
+        sim_fatal("task polls the clock without ever blocking");
+    }
+    return sim_device_local_us(require_device("clock read"), s.now_us);
+}
+
+int64_t esp_timer_get_time(void) {
+    return device_now_us();
+}
+
+uint32_t esp_log_timestamp(void) {
+    return (uint32_t)(device_now_us() / 1000);
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(device_now_us() / SIM_TICK_US);
+}
+
+TickType_t xTaskGetTickCountFromISR(void) {
+    return xTaskGetTickCount();
+}
+
+int64_t sim_ticks_deadline(TickType_t ticks) {
+    if (ticks == portMAX_DELAY) return SIM_FOREVER;
+    if (ticks == 0) return s.now_us;
+
+    sim_device_t* device = require_device("timed wait");
+    int64_t tick = sim_device_local_us(device, s.now_us) / SIM_TICK_US;
+    return sim_device_global_us(device, (tick + (int64_t)ticks) * SIM_TICK_US);
+}
+
+// ============================================================================
+// Tasks
+// ============================================================================
+
+sim_task_t* sim_task_create(sim_device_t* device, TaskFunction_t function, const char* name,
+                            void* arg, UBaseType_t priority, BaseType_t core) {
+    sim_task_t* task = calloc(1, sizeof(sim_task_t));
+    if (!task) sim_fatal("out of memory (task)");
+
+    // Guard page below the stack turns an overflow into SIGSEGV
+    uint8_t* stack = mmap(NULL, SIM_TASK_STACK_SIZE + s_page_size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (stack == MAP_FAILED) sim_fatal("cannot map a task stack");
+    mprotect(stack, s_page_size, PROT_NONE);
+
+    task->stack = stack;
+    task->device = device;
+    snprintf(task->name, sizeof(task->name), "%s", name ? name : "");
+    task->priority = priority;
+    task->core = (core == tskNO_AFFINITY) ? 0 : core;
+    task->function = function;
+    task->arg = arg;
+
+    getcontext(&task->context);
+    task->context.uc_stack.ss_sp = stack + s_page_size;
+    task->context.uc_stack.ss_size = SIM_TASK_STACK_SIZE;
+    task->context.uc_link = NULL;
+    makecontext(&task->context, task_entry, 0);
+
+    if (s.tasks_tail) s.tasks_tail->next = task;
+    else s.tasks = task;
+    s.tasks_tail = task;
+
+    make_ready(task);
+    return task;
+}
+
+static void delete_task(sim_task_t* task) {
+    if (task->state == SIM_TASK_DELETED) return;
+
+    if (task->waiting) list_remove(task->waiting, task);
+    task->waiting = NULL;
+    task->state = SIM_TASK_DELETED;
+    task->generation++;
+
+    if (task == s.current) {
+        s.zombie = task;
+        swapcontext(&task->context, &s.scheduler);
+        sim_fatal("deleted task resumed");
+    }
+    free_stack(task);
+}
+
+void sim_device_kill_tasks(sim_device_t* device) {
+    for (sim_task_t* task = s.tasks; task; task = task->next) {
+        if (task->device == device && task != s.current) delete_task(task);
+    }
+    if (s.current && s.current->device == device) delete_task(s.current);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pvTaskCode, const char* const pcName,
+                                   const uint32_t usStackDepth, void* const pvParameters,
+                                   UBaseType_t uxPriority, TaskHandle_t* const pvCreatedTask,
+                                   const BaseType_t xCoreID) {
+    (void)usStackDepth;
+    sim_device_t* device = require_device("xTaskCreatePinnedToCore");
+
+    if (!sim_world.config.audio && pcName && strcmp(pcName, "audio") == 0) {
+        if (pvCreatedTask) *pvCreatedTask = NULL;
+        return pdPASS;
+    }
+
+    sim_task_t* task = sim_task_create(device, pvTaskCode, pcName, pvParameters,
+                                       uxPriority, xCoreID);
+    if (pvCreatedTask) *pvCreatedTask = task;
+
+    preempt_check();
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete) {
+    sim_task_t* task = xTaskToDelete ? xTaskToDelete : s.current;
+    if (!task) sim_fatal("vTaskDelete(NULL) from callback context");
+    delete_task(task);
+}
+
+void vTaskDelay(const TickType_t xTicksToDelay) {
+    if (xTicksToDelay == 0) {
+        taskYIELD();
+        return;
+    }
+    sim_block(NULL, sim_ticks_deadline(xTicksToDelay));
+}
+
+BaseType_t xTaskDelayUntil(TickType_t* const pxPreviousWakeTime, const TickType_t xTimeIncrement) {
+    TickType_t wake = *pxPreviousWakeTime + xTimeIncrement;
+    TickType_t now = xTaskGetTickCount();
+    *pxPreviousWakeTime = wake;
+
+    // Already past (with wrap-around): no delay, as in FreeRTOS
+    if ((int32_t)(wake - now) <= 0) {
+        return pdFALSE;
+    }
+    sim_block(NULL, sim_ticks_deadline(wake - now));
+    return pdTRUE;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return s.current;
+}
+
+UBaseType_t uxTaskPriorityGet(const TaskHandle_t xTask) {
+    sim_task_t* task = xTask ? xTask : s.current;
+    return task ? task->priority : 0;
+}
+
+void taskYIELD(void) {
+    sim_task_t* task = s.current;
+    if (!task) return;
+    make_ready(task);
+    switch_out();
+}
+
+BaseType_t xPortGetCoreID(void) {
+    return s.current ? s.current->core : 0;
+}
+
+void vPortEnterCritical(portMUX_TYPE* mux) {
+    (void)mux;
+    if (s.current) s.current->critical++;
+}
+
+void vPortExitCritical(portMUX_TYPE* mux) {
+    (void)mux;
+    sim_task_t* task = s.current;
+    if (!task) return;
+    if (task->critical == 0) sim_fatal("portEXIT_CRITICAL without portENTER_CRITICAL");
+    if (--task->critical == 0) preempt_check();
+}
+
+// ============================================================================
+// Notifications
+// ============================================================================
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait) {
+    sim_task_t* task = s.current;
+    if (!task) sim_fatal("ulTaskNotifyTake from callback context");
+
+    if (task->notify_count == 0) {
+        sim_block(&task->notify_wait, sim_ticks_deadline(xTicksToWait));
+    }
+
+    uint32_t value = task->notify_count;
+    if (xClearCountOnExit) task->notify_count = 0;
+    else if (value > 0) task->notify_count--;
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify) {
+    if (!xTaskToNotify || xTaskToNotify->state == SIM_TASK_DELETED) return pdPASS;
+
+    xTaskToNotify->notify_count++;
+    sim_wake_one(&xTaskToNotify->notify_wait);
+    preempt_check();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t* pxHigherPriorityTaskWoken) {
+    if (!xTaskToNotify || xTaskToNotify->state == SIM_TASK_DELETED) return;
+
+    xTaskToNotify->notify_count++;
+    if (sim_wake_one(&xTaskToNotify->notify_wait) && pxHigherPriorityTaskWoken) {
+        *pxHigherPriorityTaskWoken = pdTRUE;
+    }
+}
+
+// ============================================================================
+// Queues & Semaphores
+// ============================================================================
+
+static QueueHandle_t queue_create(UBaseType_t length, UBaseType_t item_size, UBaseType_t count) {
+    if (length == 0) return NULL;
+
+    QueueHandle_t queue = calloc(1, sizeof(struct QueueDefinition));
+    if (!queue) return NULL;
+    if (item_size > 0) {
+        queue->storage = calloc(length, item_size);
+        if (!queue->storage) {
+            free(queue);
+            return NULL;
+        }
+    }
+    queue->length = length;
+    queue->item_size = item_size;
+    queue->count = count;
+    return queue;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize) {
+    return queue_create(uxQueueLength, uxItemSize, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return queue_create(1, 0, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount) {
+    return queue_create(uxMaxCount, 0, uxInitialCount);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return queue_create(1, 0, 1);  // No priority inheritance
+}
+
+void vQueueDelete(QueueHandle_t xQueue) {
+    if (!xQueue) return;
+    if (xQueue->senders.head || xQueue->receivers.head) {
+        sim_fatal("vQueueDelete on a queue with blocked tasks");
+    }
+    free(xQueue->storage);
+    free(xQueue);
+}
+
+BaseType_t xQueueReset(QueueHandle_t xQueue) {
+    xQueue->count = 0;
+    xQueue->head = 0;
+    sim_wake_one(&xQueue->senders);
+    preempt_check();
+    return pdPASS;
+}
+
+static bool queue_put(QueueHandle_t queue, const void* item, bool front) {
+    if (queue->count >= queue->length) return false;
+
+    if (queue->item_size > 0) {
+        UBaseType_t slot;
+        if (front) {
+            queue->head = (queue->head + queue->length - 1) % queue->length;
+            slot = queue->head;
+        } else {
+            slot = (queue->head + queue->count) % queue->length;
+        }
+        memcpy(queue->storage + (size_t)slot * queue->item_size, item, queue->item_size);
+    }
+    queue->count++;
+    return true;
+}
+
+static bool queue_get(QueueHandle_t queue, void* item, bool remove) {
+    if (queue->count == 0) return false;
+
+    if (queue->item_size > 0 && item) {
+        memcpy(item, queue->storage + (size_t)queue->head * queue->item_size, queue->item_size);
+    }
+    if (remove) {
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+    }
+    return true;
+}
+
+static BaseType_t queue_send(QueueHandle_t queue, const void* item, TickType_t ticks, bool front) {
+    int64_t deadline_us = SIM_FOREVER;
+    if (ticks != portMAX_DELAY) deadline_us = ticks ? sim_ticks_deadline(ticks) : s.now_us;
+
+    for (;;) {
+        if (queue_put(queue, item, front)) {
+            sim_wake_one(&queue->receivers);
+            preempt_check();
+            return pdTRUE;
+        }
+        if (!sim_block(&queue->senders, deadline_us) && s.now_us >= deadline_us) {
+            return errQUEUE_FULL;
+        }
+    }
+}
+
+static BaseType_t queue_receive(QueueHandle_t queue, void* item, TickType_t ticks, bool remove) {
+    int64_t deadline_us = SIM_FOREVER;
+    if (ticks != portMAX_DELAY) deadline_us = ticks ? sim_ticks_deadline(ticks) : s.now_us;
+
+    for (;;) {
+        if (queue_get(queue, item, remove)) {
+            if (remove) {
+                sim_wake_one(&queue->senders);
+                preempt_check();
+            }
+            return pdTRUE;
+        }
+        if (!sim_block(&queue->receivers, deadline_us) && s.now_us >= deadline_us) {
+            return errQUEUE_EMPTY;
+        }
+    }
+}
+
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void* pvItemToQueue, TickType_t xTicksToWait) {
+    return queue_send(xQueue, pvItemToQueue, xTicksToWait, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t xQueue, const void* pvItemToQueue, TickType_t xTicksToWait) {
+    return queue_send(xQueue, pvItemToQueue, xTicksToWait, true);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void* const pvBuffer, TickType_t xTicksToWait) {
+    return queue_receive(xQueue, pvBuffer, xTicksToWait, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void* const pvBuffer, TickType_t xTicksToWait) {
+    return queue_receive(xQueue, pvBuffer, xTicksToWait, false);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t xQueue, const void* pvItemToQueue,
+                             BaseType_t* pxHigherPriorityTaskWoken) {
+    if (!queue_put(xQueue, pvItemToQueue, false)) return errQUEUE_FULL;
+    if (sim_wake_one(&xQueue->receivers) && pxHigherPriorityTaskWoken) {
+        *pxHigherPriorityTaskWoken = pdTRUE;
+    }
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceiveFromISR(QueueHandle_t xQueue, void* const pvBuffer,
+                                BaseType_t* pxHigherPriorityTaskWoken) {
+    if (!queue_get(xQueue, pvBuffer, true)) return pdFALSE;
+    if (sim_wake_one(&xQueue->senders) && pxHigherPriorityTaskWoken) {
+        *pxHigherPriorityTaskWoken = pdTRUE;
+    }
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(const QueueHandle_t xQueue) {
+    return xQueue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(const QueueHandle_t xQueue) {
+    return xQueue->length - xQueue->count;
+}
+
+// ============================================================================
+// Running
+// ============================================================================
+
+void sim_sched_init(void) {
+    memset(&s, 0, sizeof(s));
+    s_page_size = (size_t)sysconf(_SC_PAGESIZE);
+
+    // Stack overflows fault on a guard page: report them from a stack of our own
+    if (!s_signal_stack) {
+        stack_t alt = {.ss_size = 64 * 1024};
+        s_signal_stack = malloc(alt.ss_size);
+        alt.ss_sp = s_signal_stack;
+        sigaltstack(&alt, NULL);
+
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_sigaction = on_segv;
+        action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+        sigaction(SIGSEGV, &action, NULL);
+        sigaction(SIGBUS, &action, NULL);
+    }
+}
+
+void sim_sched_shutdown(void) {
+    sim_task_t* task = s.tasks;
+    while (task) {
+        sim_task_t* next = task->next;
+        free_stack(task);
+        free(task);
+        task = next;
+    }
+    free(s.heap);
+    memset(&s, 0, sizeof(s));
+}
+
+void sim_run_until(int64_t t_us) {
+    if (s.current) sim_fatal("sim_run_until called from a task");
+
+    while (s.count > 0 && s.heap[0].at_us <= t_us) {
+        sim_event_t event = heap_pop();
+        s.now_us = event.at_us;
+
+        if (event.task) {
+            sim_task_t* task = event.task;
+            if (task->generation != event.generation || task->state == SIM_TASK_DELETED) {
+                continue;  // Woken (or deleted) since this was queued
+            }
+            if (task->state == SIM_TASK_BLOCKED && task->waiting) {
+                list_remove(task->waiting, task);
+                task->waiting = NULL;
+            }
+            resume(task);
+        } else {
+            s.device = event.device;
+            event.fn(event.arg);
+            s.device = NULL;
+        }
+    }
+
+    if (s.now_us < t_us) s.now_us = t_us;
+}
+
+void sim_at(int64_t at_us, void (*fn)(void* arg), void* arg) {
+    sim_schedule(at_us, NULL, fn, arg);
+}
+
+size_t sim_task_stats(sim_task_stats_t* out, size_t max) {
+    size_t used = 0;
+
+    for (sim_task_t* task = s.tasks; task; task = task->next) {
+        size_t i = 0;
+        while (i < used && strcmp(out[i].name, task->name) != 0) i++;
+        if (i == used) {
+            if (used == max) continue;
+            memset(&out[used], 0, sizeof(out[used]));
+            snprintf(out[used].name, sizeof(out[used].name), "%s", task->name);
+            used++;
+        }
+        out[i].tasks++;
+        out[i].runs += task->runs;
+        out[i].cpu_ns += task->cpu_ns;
+    }
+
+    // Busiest first (few entries: insertion sort)
+    for (size_t i = 1; i < used; i++) {
+        sim_task_stats_t entry = out[i];
+        size_t j = i;
+        while (j > 0 && out[j - 1].cpu_ns < entry.cpu_ns) {
+            out[j] = out[j - 1];
+            j--;
+        }
+        out[j] = entry;
+    }
+    return used;
+}
@@ -0,0 +1,659 @@
+/**
+ * @file modal_bench.c
+ * @brief Network benchmark: MIDI file through the hub, per topology preset
+ *
+ * For each hub preset image, boots the hub and N nodes, waits for the
+ * session to start, then plays a MIDI file into the hub's UART and
+ * measures, from the outside:
+ *
+ * - Config transfer: first CFG_BEGIN on air to the last node's CFG_ACK OK
+ * - Airtime and frames per second while the song plays
+ * - MIDI → air: last note-on byte at the hub to its poke frame on air
+ * - Poke → sound: last note-on byte at the hub to the onset in the target
+ *   node's DMA output (the first clear step in its level)
+ *
+ * Runs are deterministic: the same seed and song give the same numbers,
+ * so protocol changes can be compared run against run.
+ *
+ * Usage: modal_bench [--midi FILE] [--presets ring,clusters] [--nodes N] ...
+ */
+
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+#include "protocol.h"
+#include "smf_reader.h"
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define DEFAULT_NODES 16
+#define DEFAULT_PRESETS "ring,small_world,clusters,hub_spoke"
+#define MAX_PRESETS 8
+
+#define BOOT_SPREAD_US 500000       // Nodes power up within 0.5 s of the hub
+#define DRIFT_PPM 20.0
+#define SESSION_TIMEOUT_US 30000000 // Give up on a preset that never starts
+#define LEAD_IN_US 1000000          // Session start to the first MIDI event
+#define TAIL_US 1000000             // Last MIDI event to the end of the run
+
+#define MIDI_UART_PORT 1            // hub_controller's MIDI input
+#define SAMPLE_RATE 48000           // As audio_synth.h
+
+// Onset, once the poke frame is on air: a sample clearly above the node's
+// level over the last periods, or a period that drops further below the
+// one before than any recent period did (a kick against the phase of a
+// self-oscillating node takes energy out). Free decay and growth move a
+// period's peak by well under ONSET_STEP.
+#define ONSET_WINDOW_PERIODS 8      // 20 ms of 2.5 ms periods
+#define ONSET_STEP 0.002f           // Fraction of the level
+#define ONSET_DROP_MARGIN 2.0f      // × the largest recent drop
+#define ONSET_FLOOR 20.0f           // LSBs, for nodes that were silent
+#define ONSET_TIMEOUT_US 250000     // After the poke frame is on air
+
+// --check: a kick in quadrature with a self-oscillating mode shifts its
+// phase, not its level, so a few small-world notes show no onset
+#define CHECK_MIN_SOUNDED 0.9
+
+// Built-in song: eighth notes at 120 BPM, successive notes 7 nodes apart
+#define PATTERN_NOTES 32
+#define PATTERN_DIVISION 480
+#define PATTERN_BASE_NOTE 48
+#define PATTERN_VELOCITY 100
+
+// ============================================================================
+// State
+// ============================================================================
+
+/**
+ * @brief One measured note-on
+ */
+typedef struct {
+    int64_t midi_us;   ///< Last byte received by the hub
+    int device;        ///< Target node (-1: not measured)
+    int64_t air_us;    ///< End of the first poke frame after it (-1 = none)
+    int64_t sound_us;  ///< Onset at the target (-1 = none)
+} probe_t;
+
+typedef struct {
+    float peak[ONSET_WINDOW_PERIODS];  ///< Recent DMA periods
+    int next;
+    int open_probe;    ///< Probe waiting for an onset here (-1 = none)
+} node_audio_t;
+
+typedef struct {
+    double min, p50, p90, p99, max, mean;
+    size_t count;
+} distribution_t;
+
+typedef struct {
+    char preset[24];
+    int nodes;
+    int configured;
+    bool started;
+    int64_t session_start_us;
+    double config_ms;
+    uint32_t config_frames;
+    uint32_t config_bytes;
+    double airtime_pct;
+    double frames_per_sec;
+    double kbytes_per_sec;
+    uint64_t retries;
+    uint64_t lost;
+    size_t notes;
+    size_t unaired;    ///< Notes never followed by a poke frame
+    size_t measured;
+    size_t missed;
+    distribution_t midi_to_air;
+    distribution_t poke_to_sound;
+} result_t;
+
+typedef struct {
+    // Options
+    int num_nodes;
+    sim_config_t config;
+    const smf_song_t* song;
+    bool csv;
+
+    // Current run
+    int device_of_node[256];
+    bool configured[SIM_MAX_DEVICES];
+    int num_configured;
+    int64_t session_start_us;
+    int64_t cfg_begin_us;
+    int64_t cfg_done_us;
+    uint32_t cfg_frames;
+    uint32_t cfg_bytes;
+
+    node_audio_t audio[SIM_MAX_DEVICES];
+    probe_t* probes;
+    size_t num_probes;
+    size_t first_unaired;
+
+    sim_radio_stats_t radio_start;
+    sim_radio_stats_t radio_end;
+} bench_t;
+
+static bench_t g_bench;
+
+// ============================================================================
+// Observation
+// ============================================================================
+
+static bool is_poke(uint8_t type) {
+    return type == MSG_POKE || type == MSG_POKE_BATCH || type == MSG_POKE_COMPACT;
+}
+
+static void on_frame(void* ctx, const sim_frame_t* frame) {
+    bench_t* b = (bench_t*)ctx;
+    if (frame->len < sizeof(message_header_t)) return;
+    uint8_t type = frame->data[1];
+    bool from_hub = (frame->device == 0);
+
+    if (from_hub) {
+        if (type == MSG_CFG_BEGIN || type == MSG_CFG_CHUNK || type == MSG_CFG_END) {
+            if (type == MSG_CFG_BEGIN && b->cfg_begin_us < 0) b->cfg_begin_us = frame->start_us;
+            b->cfg_frames++;
+            b->cfg_bytes += (uint32_t)frame->len;
+        } else if (type == MSG_START && b->session_start_us < 0) {
+            b->session_start_us = frame->start_us;
+        } else if (is_poke(type)) {
+            // Every note heard before this frame was queued rides on it
+            while (b->first_unaired < b->num_probes &&
+                   b->probes[b->first_unaired].midi_us <= frame->queued_us) {
+                b->probes[b->first_unaired++].air_us = frame->end_us;
+            }
+        }
+        return;
+    }
+
+    if (type == MSG_CFG_ACK && frame->len > sizeof(message_header_t) &&
+        frame->data[sizeof(message_header_t)] == CFG_STATUS_OK && !b->configured[frame->device]) {
+        b->configured[frame->device] = true;
+        b->num_configured++;
+        b->device_of_node[frame->data[2]] = frame->device;  // Header source_id
+        if (frame->end_us > b->cfg_done_us) b->cfg_done_us = frame->end_us;
+    }
+}
+
+static void on_audio(void* ctx, int device, int64_t start_us,
+                     const int16_t* samples, size_t frames, int channels) {
+    bench_t* b = (bench_t*)ctx;
+    node_audio_t* audio = &b->audio[device];
+
+    float peak = 0.0f;
+    int64_t onset_us = -1;
+    probe_t* probe = (audio->open_probe >= 0) ? &b->probes[audio->open_probe] : NULL;
+
+    float level = 0.0f;
+    float max_drop = 0.0f;
+    for (int i = 0; i < ONSET_WINDOW_PERIODS; i++) {
+        float p = audio->peak[(audio->next + i) % ONSET_WINDOW_PERIODS];
+        float next = audio->peak[(audio->next + i + 1) % ONSET_WINDOW_PERIODS];
+        if (p > level) level = p;
+        if (i + 1 < ONSET_WINDOW_PERIODS && p - next > max_drop) max_drop = p - next;
+    }
+    float previous = audio->peak[(audio->next + ONSET_WINDOW_PERIODS - 1) % ONSET_WINDOW_PERIODS];
+    float rise = level * (1.0f + ONSET_STEP) + ONSET_FLOOR;
+    float drop = previous * (1.0f - ONSET_STEP) - ONSET_FLOOR - max_drop * ONSET_DROP_MARGIN;
+
+    // The node cannot react before its poke frame is on air
+    int64_t from_us = (probe && probe->air_us >= 0) ? probe->air_us : INT64_MAX;
+
+    for (size_t i = 0; samples && i < frames; i++) {
+        float frame_peak = 0.0f;
+        for (int c = 0; c < channels; c++) {
+            float v = (float)abs(samples[i * (size_t)channels + (size_t)c]);
+            if (v > frame_peak) frame_peak = v;
+        }
+        if (frame_peak > peak) peak = frame_peak;
+
+        int64_t t_us = start_us + (int64_t)i * 1000000 / SAMPLE_RATE;
+        if (onset_us < 0 && t_us >= from_us && frame_peak > rise) {
+            onset_us = t_us;
+        }
+    }
+
+    if (onset_us < 0 && samples && start_us >= from_us && peak < drop) {
+        onset_us = start_us;  // Drop: somewhere in this period
+    }
+
+    if (probe) {
+        if (onset_us >= 0) {
+            probe->sound_us = onset_us;
+            audio->open_probe = -1;
+        } else if (probe->air_us >= 0 && start_us > probe->air_us + ONSET_TIMEOUT_US) {
+            audio->open_probe = -1;  // Missed
+        }
+    }
+
+    audio->peak[audio->next] = peak;
+    audio->next = (audio->next + 1) % ONSET_WINDOW_PERIODS;
+}
+
+// ============================================================================
+// Playback
+// ============================================================================
+
+static void play_event(void* arg) {
+    bench_t* b = &g_bench;
+    const smf_event_t* event = (const smf_event_t*)arg;
+    int64_t received_us = sim_uart_inject(0, MIDI_UART_PORT, event->bytes, event->len);
+
+    bool note_on = (event->bytes[0] & 0xF0) == 0x90 && event->len == 3 && event->bytes[2] > 0;
+    if (!note_on) return;
+
+    probe_t* probe = &b->probes[b->num_probes++];
+    probe->midi_us = received_us;
+    probe->air_us = -1;
+    probe->sound_us = -1;
+    probe->device = -1;
+
+    // Target as hub_note_to_node(): note modulo the registered nodes
+    int target = (b->num_configured > 0) ? b->device_of_node[event->bytes[1] % b->num_configured] : -1;
+    if (target <= 0 || b->audio[target].open_probe >= 0) return;  // Unknown, or still measuring
+
+    probe->device = target;
+    b->audio[target].open_probe = (int)(probe - b->probes);
+}
+
+static void snapshot_start(void* arg) {
+    ((bench_t*)arg)->radio_start = *sim_radio_stats();
+}
+
+static void snapshot_end(void* arg) {
+    ((bench_t*)arg)->radio_end = *sim_radio_stats();
+}
+
+// ============================================================================
+// Statistics
+// ============================================================================
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static distribution_t distribution(double* values, size_t count) {
+    distribution_t d = {0};
+    d.count = count;
+    if (count == 0) return d;
+
+    qsort(values, count, sizeof(double), compare_double);
+    double sum = 0.0;
+    for (size_t i = 0; i < count; i++) sum += values[i];
+
+    // Nearest rank
+    #define RANK(p) values[(size_t)((p) * (double)(count - 1) + 0.5)]
+    d.min = values[0];
+    d.p50 = RANK(0.50);
+    d.p90 = RANK(0.90);
+    d.p99 = RANK(0.99);
+    d.max = values[count - 1];
+    d.mean = sum / (double)count;
+    #undef RANK
+    return d;
+}
+
+// ============================================================================
+// Runs
+// ============================================================================
+
+static void module_path(char* out, size_t size, const char* preset) {
+    if (strcmp(preset, "auto") == 0) {
+        snprintf(out, size, "%s/fw_hub.so", SIM_MODULE_DIR);
+    } else {
+        snprintf(out, size, "%s/fw_hub_%s.so", SIM_MODULE_DIR, preset);
+    }
+}
+
+static bool run_preset(const char* preset, result_t* result) {
+    bench_t* b = &g_bench;
+    const smf_song_t* song = b->song;
+
+    memset(result, 0, sizeof(*result));
+    snprintf(result->preset, sizeof(result->preset), "%s", preset);
+    result->nodes = b->num_nodes;
+
+    // Fresh observation state
+    for (int i = 0; i < 256; i++) b->device_of_node[i] = -1;
+    memset(b->configured, 0, sizeof(b->configured));
+    memset(b->audio, 0, sizeof(b->audio));
+    for (int i = 0; i < SIM_MAX_DEVICES; i++) b->audio[i].open_probe = -1;
+    b->num_configured = 0;
+    b->session_start_us = -1;
+    b->cfg_begin_us = -1;
+    b->cfg_done_us = -1;
+    b->cfg_frames = 0;
+    b->cfg_bytes = 0;
+    b->num_probes = 0;
+    b->first_unaired = 0;
+
+    char hub_module[512];
+    module_path(hub_module, sizeof(hub_module), preset);
+
+    if (!sim_init(&b->config)) return false;
+    sim_set_frame_tap(on_frame, b);
+    sim_set_audio_tap(on_audio, b);
+
+    if (sim_add_device(hub_module, "hub", 0, 0.0) < 0) {
+        sim_shutdown();
+        return false;
+    }
+    for (int i = 0; i < b->num_nodes; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "n%02d", i);
+        int64_t boot_us = sim_random() % BOOT_SPREAD_US;
+        double drift_ppm = DRIFT_PPM * (2.0 * (double)sim_random() / 4294967296.0 - 1.0);
+        if (sim_add_device(SIM_NODE_MODULE, name, boot_us, drift_ppm) < 0) {
+            sim_shutdown();
+            return false;
+        }
+    }
+
+    // Discovery and configuration
+    for (int64_t t_us = 100000; b->session_start_us < 0 && t_us <= SESSION_TIMEOUT_US; t_us += 100000) {
+        sim_run_until(t_us);
+    }
+    result->configured = b->num_configured;
+    result->config_frames = b->cfg_frames;
+    result->config_bytes = b->cfg_bytes;
+    if (b->cfg_begin_us >= 0 && b->cfg_done_us >= 0) {
+        result->config_ms = (double)(b->cfg_done_us - b->cfg_begin_us) / 1000.0;
+    }
+    result->started = (b->session_start_us >= 0);
+    result->session_start_us = b->session_start_us;
+    if (!result->started) {
+        sim_shutdown();
+        return true;
+    }
+
+    // Playback
+    int64_t play_us = b->session_start_us + LEAD_IN_US;
+    int64_t end_us = play_us + song->duration_us + TAIL_US;
+    for (size_t i = 0; i < song->count; i++) {
+        sim_at(play_us + song->events[i].time_us, play_event, &song->events[i]);
+    }
+    sim_at(play_us, snapshot_start, b);
+    sim_at(end_us, snapshot_end, b);
+    sim_run_until(end_us);
+
+    double seconds = (double)(end_us - play_us) / 1e6;
+    const sim_radio_stats_t* s0 = &b->radio_start;
+    const sim_radio_stats_t* s1 = &b->radio_end;
+    result->airtime_pct = 100.0 * (double)(s1->airtime_us - s0->airtime_us) / (seconds * 1e6);
+    result->frames_per_sec = (double)(s1->frames - s0->frames) / seconds;
+    result->kbytes_per_sec = (double)(s1->bytes - s0->bytes) / seconds / 1024.0;
+    result->retries = s1->retries - s0->retries;
+    result->lost = s1->lost - s0->lost;
+
+    double* air = calloc(b->num_probes + 1, sizeof(double));
+    double* sound = calloc(b->num_probes + 1, sizeof(double));
+    size_t num_air = 0;
+    size_t num_sound = 0;
+    for (size_t i = 0; i < b->num_probes; i++) {
+        const probe_t* probe = &b->probes[i];
+        if (probe->air_us >= 0) {
+            air[num_air++] = (double)(probe->air_us - probe->midi_us) / 1000.0;
+        } else {
+            result->unaired++;
+        }
+        if (probe->device < 0) continue;
+        result->measured++;
+        if (probe->sound_us >= 0) {
+            sound[num_sound++] = (double)(probe->sound_us - probe->midi_us) / 1000.0;
+        } else {
+            result->missed++;
+        }
+    }
+    result->notes = b->num_probes;
+    result->midi_to_air = distribution(air, num_air);
+    result->poke_to_sound = distribution(sound, num_sound);
+    free(air);
+    free(sound);
+
+    sim_shutdown();
+    return true;
+}
+
+// ============================================================================
+// Input
+// ============================================================================
+
+static size_t put_varint(uint8_t* out, uint32_t value) {
+    uint8_t tmp[4];
+    size_t n = 0;
+    do {
+        tmp[n++] = value & 0x7F;
+        value >>= 7;
+    } while (value);
+    for (size_t i = 0; i < n; i++) {
+        out[i] = tmp[n - 1 - i] | (i + 1 < n ? 0x80 : 0);
+    }
+    return n;
+}
+
+/**
+ * @brief Built-in song, written as a Standard MIDI File and read back
+ */
+static bool load_pattern(smf_song_t* song) {
+    uint8_t file[64 + PATTERN_NOTES * 16];
+    size_t n = 0;
+
+    static const uint8_t header[] = {'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1,
+                                     PATTERN_DIVISION >> 8, PATTERN_DIVISION & 0xFF};
+    memcpy(file, header, sizeof(header));
+    n = sizeof(header);
+    memcpy(file + n, "MTrk\0\0\0\0", 8);
+    size_t track = n + 8;
+    n = track;
+
+    static const uint8_t tempo[] = {0x00, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20};  // 120 BPM
+    memcpy(file + n, tempo, sizeof(tempo));
+    n += sizeof(tempo);
+
+    for (int k = 0; k < PATTERN_NOTES; k++) {
+        uint8_t note = (uint8_t)(PATTERN_BASE_NOTE + (k * 7) % 16);
+        n += put_varint(file + n, k ? PATTERN_DIVISION / 4 : 0);
+        file[n++] = 0x90;
+        file[n++] = note;
+        file[n++] = PATTERN_VELOCITY;
+        n += put_varint(file + n, PATTERN_DIVISION / 4);  // Sixteenth note
+        file[n++] = 0x80;
+        file[n++] = note;
+        file[n++] = 0;
+    }
+    static const uint8_t end[] = {0x00, 0xFF, 0x2F, 0x00};
+    memcpy(file + n, end, sizeof(end));
+    n += sizeof(end);
+
+    uint32_t track_len = (uint32_t)(n - track);
+    file[track - 4] = (uint8_t)(track_len >> 24);
+    file[track - 3] = (uint8_t)(track_len >> 16);
+    file[track - 2] = (uint8_t)(track_len >> 8);
+    file[track - 1] = (uint8_t)track_len;
+
+    return smf_parse(file, n, song);
+}
+
+// ============================================================================
+// Report
+// ============================================================================
+
+static void print_distribution(const char* label, const distribution_t* d) {
+    if (d->count == 0) {
+        printf("  %-20s -\n", label);
+        return;
+    }
+    printf("  %-20s n=%-4zu min %6.2f  p50 %6.2f  p90 %6.2f  p99 %6.2f  max %6.2f  mean %6.2f ms\n",
+           label, d->count, d->min, d->p50, d->p90, d->p99, d->max, d->mean);
+}
+
+static void print_result(const result_t* r) {
+    printf("\n== %s (%d nodes)\n", r->preset, r->nodes);
+    printf("  Configured:          %d / %d nodes\n", r->configured, r->nodes);
+    if (!r->started) {
+        printf("  Session never started\n");
+        return;
+    }
+    printf("  Session start:       %.1f ms\n", (double)r->session_start_us / 1000.0);
+    printf("  Config transfer:     %.1f ms, %u frames, %.1f KB\n",
+           r->config_ms, r->config_frames, r->config_bytes / 1024.0);
+    printf("  Playback radio:      %.1f frames/s, %.2f KB/s, airtime %.1f%%, %llu retries, %llu lost\n",
+           r->frames_per_sec, r->kbytes_per_sec, r->airtime_pct,
+           (unsigned long long)r->retries, (unsigned long long)r->lost);
+    printf("  Notes:               %zu played, %zu never on air, %zu measured, %zu without onset\n",
+           r->notes, r->unaired, r->measured, r->missed);
+    print_distribution("MIDI -> air:", &r->midi_to_air);
+    print_distribution("Poke -> sound:", &r->poke_to_sound);
+}
+
+static void print_summary(const result_t* results, size_t count) {
+    printf("\nPreset       Nodes  Config ms  Cfg frames  Frames/s  Airtime  Air p50  Sound p50  Sound p99  Missed\n");
+    for (size_t i = 0; i < count; i++) {
+        const result_t* r = &results[i];
+        printf("%-12s %5d  %9.1f  %10u  %8.1f  %6.1f%%  %7.2f  %9.2f  %9.2f  %6zu\n",
+               r->preset, r->nodes, r->config_ms, r->config_frames, r->frames_per_sec,
+               r->airtime_pct, r->midi_to_air.p50, r->poke_to_sound.p50, r->poke_to_sound.p99,
+               r->missed);
+    }
+}
+
+static void print_csv(const result_t* results, size_t count) {
+    printf("preset,nodes,configured,config_ms,config_frames,config_bytes,frames_per_sec,"
+           "kbytes_per_sec,airtime_pct,retries,lost,notes,unaired,measured,missed,"
+           "air_p50_ms,air_p99_ms,sound_min_ms,sound_p50_ms,sound_p90_ms,sound_p99_ms,sound_max_ms\n");
+    for (size_t i = 0; i < count; i++) {
+        const result_t* r = &results[i];
+        printf("%s,%d,%d,%.3f,%u,%u,%.2f,%.3f,%.2f,%llu,%llu,%zu,%zu,%zu,%zu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+               r->preset, r->nodes, r->configured, r->config_ms, r->config_frames, r->config_bytes,
+               r->frames_per_sec, r->kbytes_per_sec, r->airtime_pct,
+               (unsigned long long)r->retries, (unsigned long long)r->lost,
+               r->notes, r->unaired, r->measured, r->missed,
+               r->midi_to_air.p50, r->midi_to_air.p99,
+               r->poke_to_sound.min, r->poke_to_sound.p50, r->poke_to_sound.p90,
+               r->poke_to_sound.p99, r->poke_to_sound.max);
+    }
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --midi FILE        Standard MIDI File to play (default: built-in pattern)\n"
+            "  --presets LIST     Hub presets, comma separated (default %s; also auto)\n"
+            "  --nodes N          Nodes besides the hub (default %d)\n"
+            "  --loss P           Frame loss probability per link\n"
+            "  --latency-us U     Receive latency after airtime\n"
+            "  --jitter-us U      Extra random receive latency\n"
+            "  --phy-mbps R       ESP-NOW PHY rate\n"
+            "  --seed S           Random seed\n"
+            "  --log-level L      Firmware log level (1 error ... 5 verbose)\n"
+            "  --csv              One CSV line per preset instead of the report\n"
+            "  --check            Exit with 1 unless every preset configured and played every note\n",
+            argv0, DEFAULT_PRESETS, DEFAULT_NODES);
+}
+
+int main(int argc, char** argv) {
+    static const struct option options[] = {
+        {"midi", required_argument, NULL, 'f'},
+        {"presets", required_argument, NULL, 'P'},
+        {"nodes", required_argument, NULL, 'n'},
+        {"loss", required_argument, NULL, 'l'},
+        {"latency-us", required_argument, NULL, 'L'},
+        {"jitter-us", required_argument, NULL, 'j'},
+        {"phy-mbps", required_argument, NULL, 'p'},
+        {"seed", required_argument, NULL, 's'},
+        {"log-level", required_argument, NULL, 'v'},
+        {"csv", no_argument, NULL, 'C'},
+        {"check", no_argument, NULL, 'c'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0},
+    };
+
+    bench_t* b = &g_bench;
+    sim_config_default(&b->config);
+    b->config.log_level = 1;  // Errors only: warnings would drown the report
+    b->num_nodes = DEFAULT_NODES;
+    const char* midi_path = NULL;
+    char presets[256] = DEFAULT_PRESETS;
+    bool check = false;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", options, NULL)) != -1) {
+        switch (opt) {
+            case 'f': midi_path = optarg; break;
+            case 'P': snprintf(presets, sizeof(presets), "%s", optarg); break;
+            case 'n': b->num_nodes = atoi(optarg); break;
+            case 'l': b->config.loss = atof(optarg); break;
+            case 'L': b->config.latency_us = (uint32_t)atoi(optarg); break;
+            case 'j': b->config.jitter_us = (uint32_t)atoi(optarg); break;
+            case 'p': b->config.phy_rate_mbps = atof(optarg); break;
+            case 's': b->config.seed = strtoull(optarg, NULL, 0); break;
+            case 'v': b->config.log_level = atoi(optarg); break;
+            case 'C': b->csv = true; break;
+            case 'c': check = true; break;
+            default:
+                usage(argv[0]);
+                return (opt == 'h') ? 0 : 2;
+        }
+    }
+    if (b->num_nodes < 1 || b->num_nodes >= SIM_MAX_DEVICES || b->config.phy_rate_mbps <= 0.0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    smf_song_t song;
+    if (!(midi_path ? smf_load(midi_path, &song) : load_pattern(&song))) return 1;
+    b->song = &song;
+    b->probes = calloc(song.count + 1, sizeof(probe_t));
+    if (!b->probes) return 1;
+
+    if (!b->csv) {
+        printf("Benchmark: hub + %d nodes, %s (%zu events, %.1f s), seed %llu, loss %.3f, %.1f Mbps\n",
+               b->num_nodes, midi_path ? midi_path : "built-in pattern", song.count,
+               (double)song.duration_us / 1e6, (unsigned long long)b->config.seed, b->config.loss,
+               b->config.phy_rate_mbps);
+    }
+
+    result_t results[MAX_PRESETS];
+    size_t num_results = 0;
+    bool ok = true;
+
+    for (char* preset = strtok(presets, ","); preset && num_results < MAX_PRESETS;
+         preset = strtok(NULL, ",")) {
+        result_t* r = &results[num_results];
+        if (!run_preset(preset, r)) {
+            fprintf(stderr, "modal_bench: cannot run preset '%s'\n", preset);
+            ok = false;
+            continue;
+        }
+        num_results++;
+        if (!b->csv) print_result(r);
+
+        if (!r->started || r->configured != b->num_nodes || r->unaired > 0 || r->measured == 0 ||
+            (double)r->poke_to_sound.count < CHECK_MIN_SOUNDED * (double)r->measured) {
+            ok = false;
+        }
+    }
+
+    if (b->csv) {
+        print_csv(results, num_results);
+    } else {
+        print_summary(results, num_results);
+        printf("\n%s\n", ok ? "PASS" : "FAIL");
+    }
+
+    free(b->probes);
+    smf_free(&song);
+    return (check && !ok) ? 1 : 0;
+}
@@ -0,0 +1,458 @@
+/**
+ * @file modal_sim.c
+ * @brief Simulated hub + N node session from the command line
+ *
+ * Boots a hub and N nodes built from the firmware sources, lets the hub
+ * discover and configure them, plays MIDI notes into the hub's UART once
+ * the session runs, and reports what each node did plus radio and CPU
+ * statistics. Nodes are watched from the outside (frames on air, audio
+ * at the DMA), exactly as a test bench would. Pokes the hub addresses
+ * to each node are tallied from its frames and compared with the count
+ * the node's heartbeats report, so a poke taken twice (or lost) shows.
+ *
+ * Usage: modal_sim [--nodes N] [--relays R] [--duration S] [--loss P] [--check] ...
+ */
+
+#include <getopt.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+#include "protocol.h"
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define DEFAULT_NODES 16
+#define DEFAULT_DURATION_S 20.0
+#define DEFAULT_NOTES_PER_SEC 4.0
+
+#define BOOT_SPREAD_US 500000      // Nodes power up within 0.5 s of the hub
+#define DRIFT_PPM 20.0             // Crystal tolerance (± this)
+#define NOTE_LENGTH_US 80000
+#define POKE_SETTLE_US 6000000     // Quiet end: every node heartbeats (5 s) after the last poke
+#define POKE_TAKEN_US 250000       // Last poke on air → taken by every node that got it
+#define MIDI_UART_PORT 1           // hub_controller's MIDI input
+#define MIDI_NOTE_ON 0x90          // Channel 1: trigger notes
+#define MIDI_NOTE_OFF 0x80
+#define DEDUP_WINDOW 32            // RX_DEDUP_WINDOW: receivers take a frame this far back as a restart
+
+#define TASK_STATS_MAX 16
+
+// ============================================================================
+// Observations
+// ============================================================================
+
+typedef struct {
+    int64_t configured_us;   ///< First CFG_ACK OK (-1 = never)
+    int64_t running_us;      ///< First STATE (-1 = never)
+    uint64_t frames_sent;
+    uint64_t audio_periods;
+    uint64_t underruns;      ///< Silent periods after audio started
+    bool audio_started;
+} node_obs_t;
+
+typedef struct {
+    int num_nodes;
+    int num_relays;            ///< First nodes boot the always-relay image
+    double duration_s;
+    double notes_per_sec;
+    bool check;
+
+    node_obs_t obs[SIM_MAX_DEVICES];
+    int64_t session_start_us;  ///< Hub's START (-1 = none)
+    uint64_t pokes_sent;       ///< POKE / POKE_BATCH / POKE_COMPACT frames
+    uint64_t notes_played;
+    uint8_t note;
+
+    // Pokes by node ID: addressed in the hub's frames vs. taken by the node
+    uint32_t pokes_addressed[NODE_ID_BROADCAST + 1];
+    uint16_t pokes_received[NODE_ID_BROADCAST + 1];  ///< Last heartbeat's count
+    int64_t heartbeat_us[NODE_ID_BROADCAST + 1];     ///< Last heartbeat (0 = none)
+    int64_t last_poke_us;
+    uint16_t last_poke_sequence;                     ///< Retries repeat it
+
+    // Hub frames on air in sequence order, as receivers' duplicate filters expect
+    bool hub_sequence_seen;
+    uint16_t hub_sequence;     ///< Newest so far
+    uint32_t hub_frames_late;  ///< A filter window or more behind the newest
+} run_t;
+
+static run_t g_run;
+
+/**
+ * @brief Sequence of a regular or compact frame; false if too short
+ */
+static bool frame_sequence(const sim_frame_t* frame, uint16_t* sequence) {
+    if (frame->data[0] != PROTOCOL_COMPACT_MARKER) {
+        if (frame->len < sizeof(message_header_t)) return false;
+        *sequence = ((const message_header_t*)frame->data)->sequence;
+        return true;
+    }
+
+    // Compact: LEB128 after marker, type, source and destination
+    uint16_t value = 0;
+    for (size_t i = 4, shift = 0; i < frame->len && shift < 16; i++, shift += 7) {
+        value |= (uint16_t)((frame->data[i] & 0x7F) << shift);
+        if (!(frame->data[i] & 0x80)) {
+            *sequence = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Tally the pokes a hub frame addresses to each node
+ *
+ * Relayed copies come from other devices and are not counted, nor are
+ * the hub's retries of a frame (same sequence).
+ */
+static void count_hub_pokes(run_t* run, const sim_frame_t* frame, uint8_t type) {
+    uint16_t sequence;
+    if (!frame_sequence(frame, &sequence)) return;
+    bool retry = run->last_poke_us > 0 && sequence == run->last_poke_sequence;
+    run->last_poke_us = frame->start_us;
+    run->last_poke_sequence = sequence;
+    if (retry) return;
+
+    if (type == MSG_POKE && frame->len >= sizeof(msg_poke_t)) {
+        run->pokes_addressed[((const message_header_t*)frame->data)->dest_id]++;
+    } else if (type == MSG_POKE_BATCH && frame->len >= sizeof(message_header_t) + 5) {
+        const msg_poke_batch_t* batch = (const msg_poke_batch_t*)frame->data;
+        size_t entries = (frame->len - offsetof(msg_poke_batch_t, entries)) / sizeof(poke_entry_t);
+        for (uint8_t i = 0; i < batch->count && i < entries; i++) {
+            run->pokes_addressed[batch->entries[i].target_id]++;
+        }
+    }
+}
+
+/**
+ * @brief Count hub frames so far behind that receivers take them as a restart
+ */
+static void track_hub_sequence(run_t* run, const sim_frame_t* frame) {
+    uint16_t sequence;
+    if (!frame_sequence(frame, &sequence)) return;
+
+    int16_t ahead = (int16_t)(sequence - run->hub_sequence);
+    if (!run->hub_sequence_seen || ahead > 0) {
+        run->hub_sequence = sequence;
+        run->hub_sequence_seen = true;
+    } else if (-ahead >= DEDUP_WINDOW) {
+        run->hub_frames_late++;
+    }
+}
+
+static void on_frame(void* ctx, const sim_frame_t* frame) {
+    run_t* run = (run_t*)ctx;
+    node_obs_t* obs = &run->obs[frame->device];
+    obs->frames_sent++;
+
+    // Regular and compact frames both carry the type in byte 1
+    if (frame->len < 2) return;
+    uint8_t type = frame->data[1];
+    if (frame->device == 0) track_hub_sequence(run, frame);
+
+    switch (type) {
+        case MSG_CFG_ACK:
+            if (frame->len >= sizeof(msg_cfg_ack_t) && frame->data[sizeof(message_header_t)] == CFG_STATUS_OK &&
+                obs->configured_us < 0) {
+                obs->configured_us = frame->start_us;
+            }
+            break;
+
+        case MSG_STATE:
+        case MSG_STATE_COMPACT:
+            if (obs->running_us < 0) obs->running_us = frame->start_us;
+            break;
+
+        case MSG_START:
+            if (frame->device == 0 && run->session_start_us < 0) {
+                run->session_start_us = frame->start_us;
+            }
+            break;
+
+        case MSG_POKE:
+        case MSG_POKE_BATCH:
+        case MSG_POKE_COMPACT:
+            if (frame->device == 0) {
+                run->pokes_sent++;
+                count_hub_pokes(run, frame, type);
+            }
+            break;
+
+        case MSG_HEARTBEAT:
+            // Node heartbeats (relayed copies carry the same figures)
+            if (frame->len >= sizeof(msg_heartbeat_t)) {
+                const msg_heartbeat_t* hb = (const msg_heartbeat_t*)frame->data;
+                if (hb->header.source_id < NODE_ID_HUB) {
+                    run->pokes_received[hb->header.source_id] = hb->pokes_received;
+                    run->heartbeat_us[hb->header.source_id] = frame->start_us;
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void on_audio(void* ctx, int device, int64_t start_us,
+                     const int16_t* samples, size_t frames, int channels) {
+    (void)start_us;
+    (void)frames;
+    (void)channels;
+    node_obs_t* obs = &((run_t*)ctx)->obs[device];
+    obs->audio_periods++;
+    if (samples) {
+        obs->audio_started = true;
+    } else if (obs->audio_started) {
+        obs->underruns++;
+    }
+}
+
+// ============================================================================
+// MIDI Input
+// ============================================================================
+
+static void note_off(void* arg) {
+    uint8_t bytes[3] = {MIDI_NOTE_OFF, (uint8_t)(uintptr_t)arg, 0};
+    sim_uart_inject(0, MIDI_UART_PORT, bytes, sizeof(bytes));
+}
+
+static void midi_tick(void* arg) {
+    run_t* run = (run_t*)arg;
+    int64_t interval_us = (int64_t)(1e6 / run->notes_per_sec);
+
+    // Play once the session runs (with a moment for the first STATEs),
+    // and stop in time for every poke to be in a heartbeat
+    if (run->session_start_us >= 0 && sim_now() > run->session_start_us + 200000 &&
+        sim_now() < (int64_t)(run->duration_s * 1e6) - POKE_SETTLE_US) {
+        uint8_t note = (uint8_t)(48 + run->note);
+        uint8_t velocity = (uint8_t)(64 + sim_random() % 64);
+        uint8_t bytes[3] = {MIDI_NOTE_ON, note, velocity};
+        sim_uart_inject(0, MIDI_UART_PORT, bytes, sizeof(bytes));
+        sim_at(sim_now() + NOTE_LENGTH_US, note_off, (void*)(uintptr_t)note);
+
+        run->note = (uint8_t)((run->note + 7) % 24);  // Circle of fifths over two octaves
+        run->notes_played++;
+    }
+    sim_at(sim_now() + interval_us, midi_tick, run);
+}
+
+// ============================================================================
+// Report
+// ============================================================================
+
+static double ms(int64_t us) {
+    return (double)us / 1000.0;
+}
+
+static bool report(const run_t* run) {
+    int configured = 0;
+    int running = 0;
+    uint64_t underruns = 0;
+    int64_t last_configured_us = -1;
+
+    printf("\nNode   MAC                Configured   Running    Frames    Underruns\n");
+    for (int i = 1; i <= run->num_nodes; i++) {
+        const node_obs_t* obs = &run->obs[i];
+        uint8_t mac[6];
+        sim_device_mac(i, mac);
+
+        char configured_at[16] = "-";
+        char running_at[16] = "-";
+        if (obs->configured_us >= 0) {
+            snprintf(configured_at, sizeof(configured_at), "%.1f ms", ms(obs->configured_us));
+            configured++;
+            if (obs->configured_us > last_configured_us) last_configured_us = obs->configured_us;
+        }
+        if (obs->running_us >= 0) {
+            snprintf(running_at, sizeof(running_at), "%.1f ms", ms(obs->running_us));
+            running++;
+        }
+        underruns += obs->underruns;
+
+        printf("%-6s %02X:%02X:%02X:%02X:%02X:%02X  %-12s %-10s %-9llu %llu\n",
+               sim_device_name(i), mac[0], mac[1], mac[2], mac[3], mac[4], mac[5],
+               configured_at, running_at, (unsigned long long)obs->frames_sent,
+               (unsigned long long)obs->underruns);
+    }
+
+    double seconds = run->duration_s;
+    printf("\nSession\n");
+    printf("  Nodes configured: %d / %d", configured, run->num_nodes);
+    if (last_configured_us >= 0) printf(" (last at %.1f ms)", ms(last_configured_us));
+    printf("\n  Nodes running:    %d / %d\n", running, run->num_nodes);
+    if (run->session_start_us >= 0) printf("  START sent at:    %.1f ms\n", ms(run->session_start_us));
+    printf("  MIDI notes:       %llu (%llu poke frames)\n",
+           (unsigned long long)run->notes_played, (unsigned long long)run->pokes_sent);
+
+    // Every poke must be taken once; with copies lost, at most once.
+    // Nodes judged by a heartbeat sent after the last poke
+    const sim_radio_stats_t* radio = sim_radio_stats();
+    bool all_delivered = radio->lost == 0 && radio->rx_overflow == 0 && radio->rx_not_listening == 0;
+    uint32_t addressed = 0;
+    uint32_t received = 0;
+    int pokes_off = 0;
+    int unjudged = 0;
+    for (int id = 0; id < GROUP_ADDR_BASE; id++) {
+        if (run->heartbeat_us[id] <= run->last_poke_us + POKE_TAKEN_US) {
+            if (run->pokes_addressed[id] > 0) unjudged++;
+            continue;
+        }
+        uint32_t expected = run->pokes_addressed[id] + run->pokes_addressed[NODE_ID_BROADCAST];
+        addressed += expected;
+        received += run->pokes_received[id];
+        if (all_delivered ? run->pokes_received[id] != expected : run->pokes_received[id] > expected) {
+            pokes_off++;
+        }
+    }
+    printf("  Pokes:            %u addressed to nodes, %u taken", (unsigned)addressed, (unsigned)received);
+    if (pokes_off > 0) printf(" (%d node(s) %s)", pokes_off, all_delivered ? "off" : "over");
+    if (unjudged > 0) printf(", %d node(s) unreported", unjudged);
+    printf("\n");
+    printf("  Late hub frames:  %u (%d+ sequences behind)\n", (unsigned)run->hub_frames_late, DEDUP_WINDOW);
+
+    printf("\nRadio\n");
+    printf("  Frames:           %llu (%llu broadcast), %.1f/s\n",
+           (unsigned long long)radio->frames, (unsigned long long)radio->broadcasts,
+           (double)radio->frames / seconds);
+    printf("  Payload:          %.1f KB/s\n", (double)radio->bytes / seconds / 1024.0);
+    printf("  Airtime:          %.1f%% of the channel\n", 100.0 * ms(radio->airtime_us) / (seconds * 1000.0));
+    printf("  Longest wait:     %.2f ms\n", ms(radio->max_wait_us));
+    printf("  Unicast retries:  %llu (%llu failed)\n",
+           (unsigned long long)radio->retries, (unsigned long long)radio->unicast_failed);
+    printf("  Copies:           %llu delivered, %llu lost, %llu RX overflow, %llu not listening\n",
+           (unsigned long long)radio->delivered, (unsigned long long)radio->lost,
+           (unsigned long long)radio->rx_overflow, (unsigned long long)radio->rx_not_listening);
+
+    sim_task_stats_t tasks[TASK_STATS_MAX];
+    size_t num_tasks = sim_task_stats(tasks, TASK_STATS_MAX);
+    uint64_t total_ns = 0;
+    for (size_t i = 0; i < num_tasks; i++) total_ns += tasks[i].cpu_ns;
+
+    printf("\nHost CPU by task (all devices)\n");
+    for (size_t i = 0; i < num_tasks; i++) {
+        printf("  %-12s x%-4u %10llu runs %9.1f ms  %5.1f%%\n", tasks[i].name, tasks[i].tasks,
+               (unsigned long long)tasks[i].runs, (double)tasks[i].cpu_ns / 1e6,
+               total_ns ? 100.0 * (double)tasks[i].cpu_ns / (double)total_ns : 0.0);
+    }
+
+    bool ok = configured == run->num_nodes && running == run->num_nodes && underruns == 0 &&
+              pokes_off == 0 && run->hub_frames_late == 0;
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --nodes N          Nodes besides the hub (default %d)\n"
+            "  --relays R         Of those, the first R always relay\n"
+            "  --duration S       Virtual seconds to run (default %.0f)\n"
+            "  --notes-per-sec R  MIDI notes into the hub (default %.0f, 0 = none)\n"
+            "  --loss P           Frame loss probability per link\n"
+            "  --latency-us U     Receive latency after airtime\n"
+            "  --jitter-us U      Extra random receive latency\n"
+            "  --phy-mbps R       ESP-NOW PHY rate\n"
+            "  --seed S           Random seed\n"
+            "  --no-audio         Do not run the audio tasks\n"
+            "  --log-level L      Firmware log level (1 error ... 5 verbose)\n"
+            "  --check            Exit with 1 unless every node ran cleanly and took\n"
+            "                     each poke once\n",
+            argv0, DEFAULT_NODES, DEFAULT_DURATION_S, DEFAULT_NOTES_PER_SEC);
+}
+
+int main(int argc, char** argv) {
+    static const struct option options[] = {
+        {"nodes", required_argument, NULL, 'n'},
+        {"relays", required_argument, NULL, 'r'},
+        {"duration", required_argument, NULL, 'd'},
+        {"notes-per-sec", required_argument, NULL, 'm'},
+        {"loss", required_argument, NULL, 'l'},
+        {"latency-us", required_argument, NULL, 'L'},
+        {"jitter-us", required_argument, NULL, 'j'},
+        {"phy-mbps", required_argument, NULL, 'p'},
+        {"seed", required_argument, NULL, 's'},
+        {"no-audio", no_argument, NULL, 'A'},
+        {"log-level", required_argument, NULL, 'v'},
+        {"check", no_argument, NULL, 'c'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0},
+    };
+
+    sim_config_t config;
+    sim_config_default(&config);
+    run_t* run = &g_run;
+    run->num_nodes = DEFAULT_NODES;
+    run->duration_s = DEFAULT_DURATION_S;
+    run->notes_per_sec = DEFAULT_NOTES_PER_SEC;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", options, NULL)) != -1) {
+        switch (opt) {
+            case 'n': run->num_nodes = atoi(optarg); break;
+            case 'r': run->num_relays = atoi(optarg); break;
+            case 'd': run->duration_s = atof(optarg); break;
+            case 'm': run->notes_per_sec = atof(optarg); break;
+            case 'l': config.loss = atof(optarg); break;
+            case 'L': config.latency_us = (uint32_t)atoi(optarg); break;
+            case 'j': config.jitter_us = (uint32_t)atoi(optarg); break;
+            case 'p': config.phy_rate_mbps = atof(optarg); break;
+            case 's': config.seed = strtoull(optarg, NULL, 0); break;
+            case 'A': config.audio = false; break;
+            case 'v': config.log_level = atoi(optarg); break;
+            case 'c': run->check = true; break;
+            default:
+                usage(argv[0]);
+                return (opt == 'h') ? 0 : 2;
+        }
+    }
+    if (run->num_nodes < 1 || run->num_nodes >= SIM_MAX_DEVICES ||
+        run->num_relays < 0 || run->num_relays > run->num_nodes || run->duration_s <= 0.0 ||
+        config.phy_rate_mbps <= 0.0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (!sim_init(&config)) return 1;
+
+    for (int i = 0; i < SIM_MAX_DEVICES; i++) {
+        run->obs[i].configured_us = -1;
+        run->obs[i].running_us = -1;
+    }
+    run->session_start_us = -1;
+    sim_set_frame_tap(on_frame, run);
+    sim_set_audio_tap(on_audio, run);
+
+    // Hub first (device 0), then the nodes (relays first) at random times
+    // and crystal errors
+    if (sim_add_device(SIM_HUB_MODULE, "hub", 0, 0.0) < 0) return 1;
+    for (int i = 0; i < run->num_nodes; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "n%02d", i);
+        int64_t boot_us = sim_random() % BOOT_SPREAD_US;
+        double drift_ppm = DRIFT_PPM * (2.0 * (double)sim_random() / 4294967296.0 - 1.0);
+        const char* module = (i < run->num_relays) ? SIM_RELAY_MODULE : SIM_NODE_MODULE;
+        if (sim_add_device(module, name, boot_us, drift_ppm) < 0) return 1;
+    }
+
+    if (run->notes_per_sec > 0.0) sim_at(0, midi_tick, run);
+
+    printf("Simulating hub + %d nodes (%d relays) for %.1f s (seed %llu, loss %.3f, %.1f Mbps)\n",
+           run->num_nodes, run->num_relays, run->duration_s, (unsigned long long)config.seed, config.loss,
+           config.phy_rate_mbps);
+    sim_run_until((int64_t)(run->duration_s * 1e6));
+
+    bool ok = report(run);
+    sim_shutdown();
+    return (run->check && !ok) ? 1 : 0;
+}
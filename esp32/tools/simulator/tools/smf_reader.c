@@ -0,0 +1,297 @@
+/**
+ * @file smf_reader.c
+ * @brief Standard MIDI File reader
+ */
+
+#include "smf_reader.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define SMF_DEFAULT_TEMPO 500000   // µs per quarter note (120 BPM)
+#define SMF_META 0xFF
+#define SMF_META_TEMPO 0x51
+#define SMF_META_END_OF_TRACK 0x2F
+#define SMF_SYSEX 0xF0
+#define SMF_SYSEX_ESCAPE 0xF7
+
+// ============================================================================
+// Reading
+// ============================================================================
+
+typedef enum {
+    RAW_CHANNEL,
+    RAW_TEMPO,
+    RAW_END
+} raw_kind_t;
+
+/**
+ * @brief Event in ticks, before the tempo map is applied
+ */
+typedef struct {
+    uint64_t tick;
+    size_t order;        ///< File order: ties keep it
+    raw_kind_t kind;
+    uint32_t tempo;
+    uint8_t bytes[3];
+    uint8_t len;
+} raw_event_t;
+
+typedef struct {
+    raw_event_t* events;
+    size_t count;
+    size_t capacity;
+} raw_list_t;
+
+static bool fail(const char* what) {
+    fprintf(stderr, "smf: %s\n", what);
+    return false;
+}
+
+static uint32_t be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint16_t be16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static bool read_varint(const uint8_t** p, const uint8_t* end, uint32_t* out) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        if (*p >= end) return false;
+        uint8_t byte = *(*p)++;
+        value = (value << 7) | (byte & 0x7F);
+        if (!(byte & 0x80)) {
+            *out = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool push(raw_list_t* list, const raw_event_t* event) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 256;
+        raw_event_t* events = realloc(list->events, capacity * sizeof(raw_event_t));
+        if (!events) return false;
+        list->events = events;
+        list->capacity = capacity;
+    }
+    list->events[list->count] = *event;
+    list->events[list->count].order = list->count;
+    list->count++;
+    return true;
+}
+
+static int data_bytes(uint8_t status) {
+    switch (status & 0xF0) {
+        case 0xC0:
+        case 0xD0:
+            return 1;
+        default:
+            return 2;
+    }
+}
+
+static bool read_track(const uint8_t* p, const uint8_t* end, raw_list_t* list) {
+    uint64_t tick = 0;
+    uint8_t running = 0;
+
+    while (p < end) {
+        uint32_t delta;
+        if (!read_varint(&p, end, &delta)) return fail("bad delta time");
+        tick += delta;
+        if (p >= end) return fail("truncated track");
+
+        raw_event_t event = {.tick = tick};
+        uint8_t status = *p;
+
+        if (status == SMF_META) {
+            if (end - p < 2) return fail("truncated meta event");
+            uint8_t type = p[1];
+            p += 2;
+            uint32_t len;
+            if (!read_varint(&p, end, &len) || (size_t)(end - p) < len) return fail("bad meta event");
+
+            if (type == SMF_META_TEMPO && len == 3) {
+                event.kind = RAW_TEMPO;
+                event.tempo = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+                if (event.tempo == 0) return fail("zero tempo");
+                if (!push(list, &event)) return fail("out of memory");
+            } else if (type == SMF_META_END_OF_TRACK) {
+                event.kind = RAW_END;
+                if (!push(list, &event)) return fail("out of memory");
+                return true;
+            }
+            p += len;
+            running = 0;
+            continue;
+        }
+
+        if (status == SMF_SYSEX || status == SMF_SYSEX_ESCAPE) {
+            p++;
+            uint32_t len;
+            if (!read_varint(&p, end, &len) || (size_t)(end - p) < len) return fail("bad SysEx event");
+            p += len;
+            running = 0;
+            continue;
+        }
+
+        // Channel message, possibly in running status
+        if (status & 0x80) {
+            if (status >= 0xF0) return fail("unexpected system message");
+            running = status;
+            p++;
+        } else if (!running) {
+            return fail("data byte without status");
+        }
+
+        int n = data_bytes(running);
+        if (end - p < n) return fail("truncated channel message");
+        event.kind = RAW_CHANNEL;
+        event.bytes[0] = running;
+        for (int i = 0; i < n; i++) {
+            if (p[i] & 0x80) return fail("status byte inside a channel message");
+            event.bytes[1 + i] = p[i];
+        }
+        event.len = (uint8_t)(1 + n);
+        p += n;
+        if (!push(list, &event)) return fail("out of memory");
+    }
+
+    return true;  // Missing end-of-track: tolerated
+}
+
+static int compare_raw(const void* a, const void* b) {
+    const raw_event_t* x = (const raw_event_t*)a;
+    const raw_event_t* y = (const raw_event_t*)b;
+    if (x->tick != y->tick) return (x->tick < y->tick) ? -1 : 1;
+    return (x->order < y->order) ? -1 : (x->order > y->order);
+}
+
+// ============================================================================
+// API
+// ============================================================================
+
+bool smf_parse(const uint8_t* data, size_t len, smf_song_t* song) {
+    memset(song, 0, sizeof(*song));
+
+    if (len < 14 || memcmp(data, "MThd", 4) != 0 || be32(data + 4) < 6) {
+        return fail("not a Standard MIDI File");
+    }
+    uint16_t format = be16(data + 8);
+    uint16_t num_tracks = be16(data + 10);
+    uint16_t division = be16(data + 12);
+    if (format > 1) return fail("format 2 (independent tracks) is not supported");
+    if (division == 0) return fail("zero time division");
+
+    // Ticks per quarter note, or SMPTE frames × ticks per frame
+    bool smpte = (division & 0x8000) != 0;
+    double us_per_tick_smpte = 0.0;
+    if (smpte) {
+        int fps = -(int8_t)(division >> 8);
+        int ticks_per_frame = division & 0xFF;
+        if (fps <= 0 || ticks_per_frame == 0) return fail("bad SMPTE division");
+        us_per_tick_smpte = 1e6 / ((fps == 29 ? 29.97 : fps) * ticks_per_frame);
+    }
+
+    raw_list_t list = {0};
+    const uint8_t* p = data + 8 + be32(data + 4);
+    const uint8_t* end = data + len;
+
+    for (uint16_t track = 0; track < num_tracks && p + 8 <= end; track++) {
+        uint32_t chunk_len = be32(p + 4);
+        const uint8_t* chunk = p + 8;
+        if ((size_t)(end - chunk) < chunk_len) {
+            free(list.events);
+            return fail("truncated chunk");
+        }
+        if (memcmp(p, "MTrk", 4) != 0) {
+            track--;  // Unknown chunk: skipped, not a track
+        } else if (!read_track(chunk, chunk + chunk_len, &list)) {
+            free(list.events);
+            return false;
+        }
+        p = chunk + chunk_len;
+    }
+
+    qsort(list.events, list.count, sizeof(raw_event_t), compare_raw);
+
+    size_t channel_events = 0;
+    for (size_t i = 0; i < list.count; i++) {
+        if (list.events[i].kind == RAW_CHANNEL) channel_events++;
+    }
+    song->events = calloc(channel_events ? channel_events : 1, sizeof(smf_event_t));
+    if (!song->events) {
+        free(list.events);
+        return fail("out of memory");
+    }
+
+    // Tempo map: time advances at the tempo in force since the last event
+    uint32_t tempo = SMF_DEFAULT_TEMPO;
+    uint64_t last_tick = 0;
+    double time_us = 0.0;
+
+    for (size_t i = 0; i < list.count; i++) {
+        const raw_event_t* event = &list.events[i];
+        double us_per_tick = smpte ? us_per_tick_smpte : (double)tempo / division;
+        time_us += (double)(event->tick - last_tick) * us_per_tick;
+        last_tick = event->tick;
+
+        if (event->kind == RAW_TEMPO) {
+            tempo = event->tempo;
+        } else if (event->kind == RAW_CHANNEL) {
+            smf_event_t* out = &song->events[song->count++];
+            out->time_us = (int64_t)(time_us + 0.5);
+            memcpy(out->bytes, event->bytes, sizeof(out->bytes));
+            out->len = event->len;
+        }
+        song->duration_us = (int64_t)(time_us + 0.5);
+    }
+
+    free(list.events);
+    return true;
+}
+
+bool smf_load(const char* path, smf_song_t* song) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+
+    uint8_t* data = NULL;
+    size_t len = 0;
+    size_t capacity = 0;
+    size_t n;
+    do {
+        if (len == capacity) {
+            capacity = capacity ? capacity * 2 : 64 * 1024;
+            uint8_t* grown = realloc(data, capacity);
+            if (!grown) {
+                free(data);
+                fclose(file);
+                return fail("out of memory");
+            }
+            data = grown;
+        }
+        n = fread(data + len, 1, capacity - len, file);
+        len += n;
+    } while (n > 0);
+    fclose(file);
+
+    bool ok = smf_parse(data, len, song);
+    free(data);
+    return ok;
+}
+
+void smf_free(smf_song_t* song) {
+    free(song->events);
+    memset(song, 0, sizeof(*song));
+}
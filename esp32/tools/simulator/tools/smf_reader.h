@@ -0,0 +1,55 @@
+/**
+ * @file smf_reader.h
+ * @brief Standard MIDI File (format 0/1) reader for the simulator tools
+ *
+ * Flattens every track into one time-ordered list of channel messages,
+ * with the tempo map applied, ready to be played into a UART.
+ */
+
+#ifndef SMF_READER_H
+#define SMF_READER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================================================
+// Type Definitions
+// ============================================================================
+
+/**
+ * @brief One channel message (note on/off, CC, ...) at its play time
+ */
+typedef struct {
+    int64_t time_us;    ///< From the start of the song
+    uint8_t bytes[3];   ///< Status byte included (no running status)
+    uint8_t len;
+} smf_event_t;
+
+typedef struct {
+    smf_event_t* events;
+    size_t count;
+    int64_t duration_us;  ///< Last event (end-of-track included)
+} smf_song_t;
+
+// ============================================================================
+// API
+// ============================================================================
+
+/**
+ * @brief Parse a MIDI file held in memory
+ *
+ * Meta events other than tempo, and SysEx, are skipped.
+ *
+ * @return false on malformed data (error printed)
+ */
+bool smf_parse(const uint8_t* data, size_t len, smf_song_t* song);
+
+/**
+ * @brief Read and parse a .mid file
+ */
+bool smf_load(const char* path, smf_song_t* song);
+
+void smf_free(smf_song_t* song);
+
+#endif // SMF_READER_H